@@ -4,7 +4,7 @@ BUILD_DIR=build/test
 SRC_DIR=src/cpp/test
 CC=g++
 INCLUDES="-Isrc/cpp/syscommon/include -Ilib/cppunit/cppunit-1.12.1/include"
-CFLAGS="-g -Wall"
+CFLAGS="-g -Wall -std=c++20"
 LDFLAGS="-lpthread -Llib/cppunit/cppunit-1.12.1/linux32 -lcppunit -Ldist -lsyscommond"
 DIST_DIR=dist
 OUTNAME=test
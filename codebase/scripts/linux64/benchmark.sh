@@ -0,0 +1,44 @@
+#!/bin/bash
+
+BUILD_DIR=build/benchmark64
+SRC_DIR=src/cpp/benchmark
+CC=g++
+INCLUDES="-Isrc/cpp/syscommon/include"
+CFLAGS="-O2 -Wall"
+LDFLAGS="-lpthread -Ldist -lsyscommon64"
+DIST_DIR=dist
+OUTNAME=benchmark64
+
+function fail
+{
+	echo
+	echo BUILD FAILED
+	exit
+}
+
+if [ ! -d "$BUILD_DIR" ]; then
+	mkdir -p $BUILD_DIR
+fi
+
+echo Compiling to $BUILD_DIR
+LINKOBJECTS=
+
+for SOURCEFILE in $SRC_DIR/*.cpp
+do
+	BASENAME=`basename $SOURCEFILE`
+	UNITNAME="${BASENAME%%.*}"
+
+	echo [CC] $SOURCEFILE
+	RESULT=`$CC $INCLUDES $CFLAGS -c $SOURCEFILE -o $BUILD_DIR/$UNITNAME.o && echo OK`
+	if [ "$RESULT" != "OK" ]; then
+		fail
+	fi
+
+	LINKOBJECTS="$LINKOBJECTS $BUILD_DIR/$UNITNAME.o"
+done
+
+echo [LD] $DIST_DIR/$OUTNAME
+RESULT=`$CC $LINKOBJECTS -o $DIST_DIR/$OUTNAME $LDFLAGS && echo OK`
+if [ "$RESULT" != "OK" ]; then
+	fail
+fi
@@ -4,7 +4,7 @@ BUILD_DIR=build/test64
 SRC_DIR=src/cpp/test
 CC=g++
 INCLUDES="-Isrc/cpp/syscommon/include -Ilib/cppunit/cppunit-1.12.1/include"
-CFLAGS="-g -Wall"
+CFLAGS="-g -Wall -std=c++20"
 LDFLAGS="-lpthread -Llib/cppunit/cppunit-1.12.1/macosx -lcppunit -Ldist -lsyscommon64d"
 DIST_DIR=dist
 OUTNAME=test64
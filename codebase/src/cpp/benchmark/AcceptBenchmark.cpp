@@ -0,0 +1,183 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "Benchmark.h"
+
+#include <atomic>
+#include <cstdio>
+#include <vector>
+
+#include "syscommon/concurrent/Thread.h"
+#include "syscommon/net/IShardHandler.h"
+#include "syscommon/net/Shard.h"
+#include "syscommon/net/ShardedServer.h"
+#include "syscommon/net/Socket.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+/*
+ * Closes each connection as soon as it has been accepted, so that the benchmark measures the
+ * accepting rather than the serving
+ */
+class ClosingShardHandler : public IShardHandler
+{
+	public:
+		std::atomic<unsigned long> accepted;
+
+	public:
+		ClosingShardHandler() : accepted( 0 )
+		{
+
+		}
+
+		virtual void onAccept( Shard& shard, Socket* socket )
+		{
+			delete socket;
+			++this->accepted;
+		}
+};
+
+/*
+ * Connects to the server and closes the connection again, over and over, like a client
+ * reconnecting after a failover. Connections are reset rather than closed, so that the ports do
+ * not pile up in TIME_WAIT.
+ */
+class Reconnector : public IRunnable
+{
+	private:
+		unsigned short port;
+		unsigned long connections;
+
+	public:
+		volatile unsigned long failed;
+
+	public:
+		Reconnector( unsigned short port, unsigned long connections )
+		{
+			this->port = port;
+			this->connections = connections;
+			this->failed = 0;
+		}
+
+		virtual void run()
+		{
+			SocketOptions options;
+			options.linger = 0;
+			for( unsigned long i = 0 ; i < this->connections ; ++i )
+			{
+				try
+				{
+					Socket socket;
+					socket.setOptions( options );
+					socket.connect( InetSocketAddress(INADDR_LOOPBACK, this->port) );
+					socket.close();
+				}
+				catch( IOException& )
+				{
+					++this->failed;
+				}
+			}
+		}
+};
+
+/*
+ * Reconnects a burst of clients to a server with the given number of acceptors, each listening
+ * on the port through SO_REUSEPORT on a thread of its own, and times how long it takes them all
+ * to be accepted
+ */
+static void runAcceptScenario( int acceptorCount, bool steering )
+{
+	const int clientThreads = 4;
+	const unsigned long perThread = 5000;
+	const unsigned long total = perThread * clientThreads;
+
+	// Spread the acceptors over the cores, doubling up when there are more acceptors than cores
+	std::vector<unsigned int> cores = Platform::getTopology().getOnePerCore();
+	if( cores.empty() )
+		cores.push_back( Platform::getCurrentProcessor() );
+
+	std::vector<unsigned int> processors;
+	for( int i = 0 ; i < acceptorCount ; ++i )
+		processors.push_back( cores[i % cores.size()] );
+
+	ClosingShardHandler handler;
+	ShardedServer server( &handler, processors, ShardedServer::DEFAULT_INBOX_CAPACITY );
+	server.setCpuSteering( steering );
+	server.start( InetSocketAddress(INADDR_LOOPBACK, 0), 4096 );
+
+	std::vector<Reconnector*> reconnectors;
+	std::vector<Thread*> threads;
+	for( int i = 0 ; i < clientThreads ; ++i )
+	{
+		reconnectors.push_back( new Reconnector(server.getLocalPort(), perThread) );
+		threads.push_back( new Thread(reconnectors.back()) );
+	}
+
+	unsigned long start = Platform::getCurrentTimeMilliseconds();
+	for( int i = 0 ; i < clientThreads ; ++i )
+		threads[i]->start();
+
+	unsigned long failed = 0;
+	for( int i = 0 ; i < clientThreads ; ++i )
+	{
+		threads[i]->join();
+		failed += reconnectors[i]->failed;
+	}
+
+	// Connections the acceptors could not take are counted as failures by their shards
+	unsigned long deadline = Platform::getCurrentTimeMilliseconds() + 10000;
+	while( Platform::getCurrentTimeMilliseconds() < deadline )
+	{
+		unsigned long done = handler.accepted + failed;
+		for( size_t i = 0 ; i < server.getShardCount() ; ++i )
+			done += (unsigned long)server.getShard( i ).getFailureCount();
+
+		if( done >= total )
+			break;
+
+		Thread::sleep( 1 );
+	}
+
+	unsigned long elapsed = Platform::getCurrentTimeMilliseconds() - start;
+	bool steered = server.isCpuSteeringActive();
+	server.stop();
+
+	for( int i = 0 ; i < clientThreads ; ++i )
+	{
+		delete threads[i];
+		delete reconnectors[i];
+	}
+
+	char scenario[64];
+	sprintf( scenario,
+	         "accept.%s (%d acceptors, per connection)",
+	         steered ? "steered" : "reuseport",
+	         acceptorCount );
+	reportBenchmark( scenario, handler.accepted, elapsed );
+}
+
+static void runAcceptBenchmark()
+{
+	const int acceptorCounts[] = { 1, 2, 4, 8 };
+	for( int i = 0 ; i < 4 ; ++i )
+		runAcceptScenario( acceptorCounts[i], false );
+
+	runAcceptScenario( 4, true );
+}
+
+BENCHMARK_REGISTRATION( "accept", runAcceptBenchmark );
@@ -0,0 +1,51 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "Benchmark.h"
+
+#include <cstdio>
+
+#ifdef WIN32
+	#pragma warning(disable: 4996)
+#endif
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+BenchmarkRegistration::BenchmarkRegistration( const char* name, BenchmarkFunction function )
+{
+	getBenchmarks()[name] = function;
+}
+
+std::map<std::string,BenchmarkFunction>& getBenchmarks()
+{
+	// Function-local so that registrations in other translation units can run in any order
+	static std::map<std::string,BenchmarkFunction> benchmarks;
+	return benchmarks;
+}
+
+void reportBenchmark( const char* scenario, unsigned long operations, unsigned long elapsedMillis )
+{
+	double nanosPerOperation = 0.0;
+	if( operations > 0 )
+		nanosPerOperation = (elapsedMillis * 1000000.0) / operations;
+
+	printf( "%-48s %12lu ops %8lu ms %14.1f ns/op\n",
+	        scenario,
+	        operations,
+	        elapsedMillis,
+	        nanosPerOperation );
+	fflush( stdout );
+}
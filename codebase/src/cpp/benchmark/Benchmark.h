@@ -0,0 +1,49 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <map>
+#include <string>
+
+#include "syscommon/Platform.h"
+
+/*
+ * A benchmark is a plain function that runs its scenarios and reports each one through
+ * reportBenchmark(). Benchmarks register themselves with the runner by name, in the same way that
+ * CppUnit test suites register themselves with the test runner:
+ *
+ * BENCHMARK_REGISTRATION( "event", runEventBenchmark );
+ */
+typedef void (*BenchmarkFunction)();
+
+class BenchmarkRegistration
+{
+	public:
+		BenchmarkRegistration( const char* name, BenchmarkFunction function );
+};
+
+#define BENCHMARK_REGISTRATION( name, function ) \
+	static BenchmarkRegistration function##Registration( name, function )
+
+/*
+ * Returns all registered benchmarks, keyed by name
+ */
+std::map<std::string,BenchmarkFunction>& getBenchmarks();
+
+/*
+ * Prints the result of a single benchmark scenario
+ */
+void reportBenchmark( const char* scenario, unsigned long operations, unsigned long elapsedMillis );
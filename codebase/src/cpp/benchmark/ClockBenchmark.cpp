@@ -0,0 +1,45 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "Benchmark.h"
+
+#include "syscommon/Platform.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+// Somewhere for the readings to go, so that the calls are not optimised away
+static volatile long long clockSink;
+
+static void runClockBenchmark()
+{
+	const unsigned long iterations = 20000000;
+
+	unsigned long start = Platform::getCurrentTimeMilliseconds();
+	for( unsigned long i = 0 ; i < iterations ; ++i )
+		clockSink = Platform::nanoTime();
+	reportBenchmark( "clock.nanoTime", iterations, Platform::getCurrentTimeMilliseconds() - start );
+
+	start = Platform::getCurrentTimeMilliseconds();
+	for( unsigned long i = 0 ; i < iterations ; ++i )
+		clockSink = Platform::getCurrentTimeMilliseconds();
+	reportBenchmark( "clock.getCurrentTimeMilliseconds",
+	                 iterations,
+	                 Platform::getCurrentTimeMilliseconds() - start );
+}
+
+BENCHMARK_REGISTRATION( "clock", runClockBenchmark );
@@ -0,0 +1,148 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "Benchmark.h"
+
+#include <cstdio>
+#include <vector>
+#include "syscommon/Platform.h"
+#include "syscommon/net/DatagramPacket.h"
+#include "syscommon/net/MulticastSocket.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+/*
+ * Sends datagrams over loopback and receives them again on the same thread, a round of
+ * batchSize at a time so that none are dropped, moving them one per call with batchSize of 1
+ * and with the batch calls otherwise
+ */
+static void runDatagramScenario( const char* scenario, int batchSize )
+{
+	const unsigned long total = 1000000;
+	const int payloadSize = 64;
+
+	MulticastSocket sender( InetSocketAddress(INADDR_LOOPBACK, 3140) );
+	MulticastSocket receiver( InetSocketAddress(INADDR_LOOPBACK, 3141) );
+
+	std::vector<char> sendBuffer( payloadSize, 'x' );
+	std::vector<char> receiveBuffer( batchSize * payloadSize );
+	std::vector<DatagramPacket> sendPackets;
+	std::vector<DatagramPacket> receivePackets;
+	for( int i = 0 ; i < batchSize ; ++i )
+	{
+		sendPackets.push_back( DatagramPacket(&sendBuffer[0], 0, payloadSize, INADDR_LOOPBACK, 3141) );
+		receivePackets.push_back( DatagramPacket(&receiveBuffer[i * payloadSize], payloadSize) );
+	}
+
+	unsigned long start = Platform::getCurrentTimeMilliseconds();
+	for( unsigned long moved = 0 ; moved < total ; moved += batchSize )
+	{
+		if( batchSize == 1 )
+		{
+			sender.send( sendPackets[0] );
+			receiver.receive( receivePackets[0] );
+		}
+		else
+		{
+			sender.sendBatch( &sendPackets[0], batchSize );
+			for( int received = 0 ; received < batchSize ; )
+				received += receiver.receiveBatch( &receivePackets[received], batchSize - received, 1000 );
+		}
+	}
+
+	reportBenchmark( scenario, total, Platform::getCurrentTimeMilliseconds() - start );
+	sender.close();
+	receiver.close();
+}
+
+/*
+ * Sends runs of MTU-sized datagrams over loopback, either as a batch of separate datagrams or,
+ * with offload, as one segmented buffer that the receiver takes back coalesced
+ */
+static void runSegmentedScenario( const char* scenario, bool offload )
+{
+	const unsigned long total = 200000;
+	const int segmentSize = 1400;
+	const int segments = 40;
+
+	MulticastSocket sender( InetSocketAddress(INADDR_LOOPBACK, 3142) );
+	MulticastSocket receiver( InetSocketAddress(INADDR_LOOPBACK, 3143) );
+	if( offload )
+	{
+		try
+		{
+			receiver.setReceiveOffload( true );
+		}
+		catch( SocketException& )
+		{
+			printf( "%s: receive offload is not supported, skipping\n", scenario );
+			return;
+		}
+	}
+
+	std::vector<char> sendBuffer( segmentSize * segments, 'x' );
+	std::vector<char> receiveBuffer( 65536 * segments );
+	std::vector<DatagramPacket> sendPackets;
+	std::vector<DatagramPacket> receivePackets;
+	for( int i = 0 ; i < segments ; ++i )
+	{
+		sendPackets.push_back(
+			DatagramPacket(&sendBuffer[i * segmentSize], 0, segmentSize, INADDR_LOOPBACK, 3143) );
+		receivePackets.push_back( DatagramPacket(&receiveBuffer[i * 65536], 65536) );
+	}
+
+	DatagramPacket segmented( &sendBuffer[0], 0, segmentSize * segments, INADDR_LOOPBACK, 3143 );
+	segmented.setSegmentSize( segmentSize );
+
+	unsigned long start = Platform::getCurrentTimeMilliseconds();
+	for( unsigned long moved = 0 ; moved < total ; moved += segments )
+	{
+		if( offload )
+			sender.send( segmented );
+		else
+			sender.sendBatch( &sendPackets[0], segments );
+
+		// Coalesced receives hold several segments each
+		for( int bytes = 0 ; bytes < segmentSize * segments ; )
+		{
+			int received = receiver.receiveBatch( &receivePackets[0], segments, 1000 );
+			for( int i = 0 ; i < received ; ++i )
+				bytes += receivePackets[i].getLength();
+		}
+	}
+
+	reportBenchmark( scenario, total, Platform::getCurrentTimeMilliseconds() - start );
+	sender.close();
+	receiver.close();
+}
+
+/*
+ * Moves small datagrams through a pair of sockets one per system call, and in batches through
+ * recvmmsg() and sendmmsg(). Then moves MTU-sized datagrams in batches, and as segmented buffers
+ * through UDP segmentation and receive offload.
+ */
+static void runDatagramBenchmark()
+{
+	runDatagramScenario( "datagram.single", 1 );
+	runDatagramScenario( "datagram.batch.32", 32 );
+	runDatagramScenario( "datagram.batch.64", 64 );
+	runSegmentedScenario( "datagram.mtu.batch", false );
+	runSegmentedScenario( "datagram.mtu.offload", true );
+}
+
+BENCHMARK_REGISTRATION( "datagram", runDatagramBenchmark );
@@ -0,0 +1,138 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "Benchmark.h"
+
+#include <atomic>
+#include <cstdio>
+#include <vector>
+
+#include "syscommon/concurrent/Event.h"
+#include "syscommon/concurrent/Thread.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+/*
+ * Waits for each round's start event, and signals the done event once every waiter has seen it.
+ *
+ * Rounds alternate between two start events so that the runner can clear next round's event
+ * while this round's is still signaled.
+ */
+class BroadcastWaiter : public IRunnable
+{
+	private:
+		Event** startEvents;
+		Event* doneEvent;
+		std::atomic<int>* remaining;
+		int rounds;
+
+	public:
+		BroadcastWaiter( Event** startEvents, Event* doneEvent, std::atomic<int>* remaining, int rounds )
+		{
+			this->startEvents = startEvents;
+			this->doneEvent = doneEvent;
+			this->remaining = remaining;
+			this->rounds = rounds;
+		}
+
+		virtual void run()
+		{
+			for( int round = 0 ; round < this->rounds ; ++round )
+			{
+				this->startEvents[round % 2]->waitFor();
+				if( this->remaining->fetch_sub(1) == 1 )
+					this->doneEvent->signal();
+			}
+		}
+};
+
+/*
+ * Cost of signal/wait/clear with nobody waiting
+ */
+static void runUncontended()
+{
+	const unsigned long iterations = 2000000;
+	Event event( false, TEXT("Uncontended") );
+
+	unsigned long start = Platform::getCurrentTimeMilliseconds();
+	for( unsigned long i = 0 ; i < iterations ; ++i )
+	{
+		event.signal();
+		event.waitFor();
+		event.clear();
+	}
+	unsigned long elapsed = Platform::getCurrentTimeMilliseconds() - start;
+
+	reportBenchmark( "event.uncontended (signal+wait+clear)", iterations, elapsed );
+}
+
+/*
+ * Time for one signal to wake a group of blocked waiters and for all of them to respond
+ */
+static void runBroadcast( int waiterCount, int rounds )
+{
+	Event first( false, TEXT("StartA") );
+	Event second( false, TEXT("StartB") );
+	Event* startEvents[2] = { &first, &second };
+	Event doneEvent( false, TEXT("Done") );
+	std::atomic<int> remaining( 0 );
+
+	std::vector<BroadcastWaiter*> waiters;
+	std::vector<Thread*> threads;
+	for( int i = 0 ; i < waiterCount ; ++i )
+	{
+		waiters.push_back( new BroadcastWaiter(startEvents, &doneEvent, &remaining, rounds) );
+		threads.push_back( new Thread(waiters.back()) );
+		threads.back()->start();
+	}
+
+	// Give the waiters a chance to block before timing starts
+	Thread::sleep( 100 );
+
+	unsigned long start = Platform::getCurrentTimeMilliseconds();
+	for( int round = 0 ; round < rounds ; ++round )
+	{
+		remaining.store( waiterCount );
+		doneEvent.clear();
+		startEvents[(round + 1) % 2]->clear();
+		startEvents[round % 2]->signal();
+		doneEvent.waitFor();
+	}
+	unsigned long elapsed = Platform::getCurrentTimeMilliseconds() - start;
+
+	for( int i = 0 ; i < waiterCount ; ++i )
+	{
+		threads[i]->join();
+		delete threads[i];
+		delete waiters[i];
+	}
+
+	char scenario[64];
+	sprintf( scenario, "event.broadcast (%d waiters, per round)", waiterCount );
+	reportBenchmark( scenario, (unsigned long)rounds, elapsed );
+}
+
+static void runEventBenchmark()
+{
+	runUncontended();
+	runBroadcast( 1, 20000 );
+	runBroadcast( 8, 10000 );
+	runBroadcast( 64, 2000 );
+}
+
+BENCHMARK_REGISTRATION( "event", runEventBenchmark );
@@ -0,0 +1,115 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "Benchmark.h"
+
+#include <cstdio>
+#include <vector>
+
+#include "syscommon/concurrent/Lock.h"
+#include "syscommon/concurrent/Thread.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+/*
+ * Repeatedly takes the lock to do a trivially small amount of work, so that the benchmark
+ * measures the lock rather than the work
+ */
+class LockHammer : public IRunnable
+{
+	private:
+		Lock* lock;
+		volatile unsigned long* counter;
+		unsigned long iterations;
+
+	public:
+		LockHammer( Lock* lock, volatile unsigned long* counter, unsigned long iterations )
+		{
+			this->lock = lock;
+			this->counter = counter;
+			this->iterations = iterations;
+		}
+
+		virtual void run()
+		{
+			for( unsigned long i = 0 ; i < this->iterations ; ++i )
+			{
+				LockGuard guard( *this->lock );
+				*this->counter = *this->counter + 1;
+			}
+		}
+};
+
+static const char* getPolicyName( LockPolicy policy )
+{
+	switch( policy )
+	{
+		case LP_RECURSIVE: return "recursive";
+		case LP_PLAIN:     return "plain";
+		case LP_ADAPTIVE:  return "adaptive";
+		case LP_QUEUED:    return "queued";
+		default:           return "unknown";
+	}
+}
+
+static void runContention( LockPolicy policy, int threadCount, unsigned long totalIterations )
+{
+	Lock lock( policy );
+	volatile unsigned long counter = 0;
+	unsigned long perThread = totalIterations / threadCount;
+
+	std::vector<LockHammer*> hammers;
+	std::vector<Thread*> threads;
+	for( int i = 0 ; i < threadCount ; ++i )
+	{
+		hammers.push_back( new LockHammer(&lock, &counter, perThread) );
+		threads.push_back( new Thread(hammers.back()) );
+	}
+
+	unsigned long start = Platform::getCurrentTimeMilliseconds();
+	for( int i = 0 ; i < threadCount ; ++i )
+		threads[i]->start();
+
+	for( int i = 0 ; i < threadCount ; ++i )
+		threads[i]->join();
+	unsigned long elapsed = Platform::getCurrentTimeMilliseconds() - start;
+
+	for( int i = 0 ; i < threadCount ; ++i )
+	{
+		delete threads[i];
+		delete hammers[i];
+	}
+
+	char scenario[64];
+	sprintf( scenario, "lock.%s (%d threads, per acquire)", getPolicyName(policy), threadCount );
+	reportBenchmark( scenario, perThread * threadCount, elapsed );
+}
+
+static void runLockBenchmark()
+{
+	const LockPolicy policies[] = { LP_RECURSIVE, LP_PLAIN, LP_ADAPTIVE, LP_QUEUED };
+	const int threadCounts[] = { 1, 2, 4, 8, 16 };
+
+	for( int t = 0 ; t < 5 ; ++t )
+	{
+		for( int p = 0 ; p < 4 ; ++p )
+			runContention( policies[p], threadCounts[t], 2000000 );
+	}
+}
+
+BENCHMARK_REGISTRATION( "lock", runLockBenchmark );
@@ -0,0 +1,107 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "Benchmark.h"
+
+#include "syscommon/Platform.h"
+#include "syscommon/concurrent/Pipeline.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+struct BenchmarkSlot
+{
+	long long value;
+	long long decoded;
+};
+
+class DecodeHandler : public IEventHandler<BenchmarkSlot>
+{
+	public:
+		virtual void onEvent( BenchmarkSlot& event, long long sequence, bool endOfBatch )
+		{
+			event.decoded = event.value * 3 + sequence;
+		}
+};
+
+class SumHandler : public IEventHandler<BenchmarkSlot>
+{
+	public:
+		long long sum;
+
+		SumHandler() : sum( 0 ) {}
+
+		virtual void onEvent( BenchmarkSlot& event, long long sequence, bool endOfBatch )
+		{
+			this->sum += event.decoded;
+		}
+};
+
+/*
+ * Publishes slots one at a time through the given pipeline, and reports the time it takes for
+ * every stage to process them all
+ */
+static void runPipelineScenario( const char* scenario,
+                                 Pipeline<BenchmarkSlot>& pipeline,
+                                 long long count,
+                                 size_t batchSize )
+{
+	pipeline.start();
+
+	unsigned long start = Platform::getCurrentTimeMilliseconds();
+	for( long long published = 0 ; published < count ; published += batchSize )
+	{
+		long long last = pipeline.next( batchSize );
+		for( long long sequence = last - (long long)batchSize + 1 ; sequence <= last ; ++sequence )
+			pipeline.get( sequence ).value = sequence;
+
+		pipeline.publish( last );
+	}
+
+	pipeline.stop();
+	reportBenchmark( scenario, (unsigned long)count, Platform::getCurrentTimeMilliseconds() - start );
+}
+
+/*
+ * Runs a decode stage, then two stages in parallel that both depend on it, through the pipeline
+ */
+static void runPipelineBenchmark()
+{
+	const long long count = 4000000;
+
+	DecodeHandler decode;
+	SumHandler journal;
+	SumHandler business;
+
+	{
+		Pipeline<BenchmarkSlot> pipeline( 4096, WP_YIELD );
+		size_t decodeStage = pipeline.addStage( TEXT("decode"), &decode );
+		pipeline.addStage( TEXT("journal"), &journal, decodeStage );
+		pipeline.addStage( TEXT("business"), &business, decodeStage );
+		runPipelineScenario( "pipeline.diamond.single", pipeline, count, 1 );
+	}
+
+	{
+		Pipeline<BenchmarkSlot> pipeline( 4096, WP_YIELD );
+		size_t decodeStage = pipeline.addStage( TEXT("decode"), &decode );
+		pipeline.addStage( TEXT("journal"), &journal, decodeStage );
+		pipeline.addStage( TEXT("business"), &business, decodeStage );
+		runPipelineScenario( "pipeline.diamond.batch", pipeline, count, 64 );
+	}
+}
+
+BENCHMARK_REGISTRATION( "pipeline", runPipelineBenchmark );
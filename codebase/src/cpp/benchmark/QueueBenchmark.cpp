@@ -0,0 +1,111 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "Benchmark.h"
+
+#include <limits.h>
+#include <vector>
+#include "syscommon/Platform.h"
+#include "syscommon/concurrent/BlockingQueue.h"
+#include "syscommon/concurrent/Thread.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+class QueueProducer : public IRunnable
+{
+	private:
+		BlockingQueue<unsigned long>* queue;
+		unsigned long count;
+
+	public:
+		QueueProducer( BlockingQueue<unsigned long>* queue, unsigned long count )
+		{
+			this->queue = queue;
+			this->count = count;
+		}
+
+		virtual void run()
+		{
+			for( unsigned long i = 0 ; i < this->count ; ++i )
+				this->queue->put( i );
+		}
+};
+
+/*
+ * Runs several producers against a single consumer until every element has been received, and
+ * reports the elapsed time
+ */
+static void runQueueScenario( const char* scenario, bool drain )
+{
+	BlockingQueue<unsigned long> queue( 1024 );
+	std::vector<unsigned long> batch;
+	batch.reserve( 256 );
+
+	const unsigned int producerCount = 4;
+	const unsigned long perProducer = 250000;
+
+	std::vector<QueueProducer*> producers;
+	std::vector<Thread*> threads;
+	for( unsigned int i = 0 ; i < producerCount ; ++i )
+	{
+		producers.push_back( new QueueProducer(&queue, perProducer) );
+		threads.push_back( new Thread(producers[i]) );
+	}
+
+	unsigned long start = Platform::getCurrentTimeMilliseconds();
+	for( unsigned int i = 0 ; i < producerCount ; ++i )
+		threads[i]->start();
+
+	unsigned long total = producerCount * perProducer;
+	for( unsigned long consumed = 0 ; consumed < total ; )
+	{
+		if( drain )
+		{
+			batch.clear();
+			consumed += queue.drainTo( batch, 256, NATIVE_INFINITE_WAIT );
+		}
+		else
+		{
+			queue.take();
+			++consumed;
+		}
+	}
+
+	for( unsigned int i = 0 ; i < producerCount ; ++i )
+		threads[i]->join();
+	reportBenchmark( scenario, total, Platform::getCurrentTimeMilliseconds() - start );
+
+	for( unsigned int i = 0 ; i < producerCount ; ++i )
+	{
+		delete threads[i];
+		delete producers[i];
+	}
+}
+
+/*
+ * Passes elements from several producers to one consumer, first taking them one at a time and
+ * then draining them in batches. A consumer that drains releases the blocked producers once per
+ * batch rather than once per element.
+ */
+static void runQueueBenchmark()
+{
+	runQueueScenario( "queue.take", false );
+	runQueueScenario( "queue.drainTo", true );
+}
+
+BENCHMARK_REGISTRATION( "queue", runQueueBenchmark );
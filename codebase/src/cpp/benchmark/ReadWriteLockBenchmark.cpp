@@ -0,0 +1,154 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "Benchmark.h"
+
+#include <cstdio>
+#include <map>
+#include <vector>
+
+#include "syscommon/concurrent/Lock.h"
+#include "syscommon/concurrent/ReadWriteLock.h"
+#include "syscommon/concurrent/Thread.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+static const long TABLE_SIZE = 1024;
+
+/*
+ * Looks up and occasionally updates entries of a shared map, 95 reads to every 5 writes, either
+ * under a ReadWriteLock or under a plain Lock for comparison
+ */
+class TableWorker : public IRunnable
+{
+	private:
+		std::map<long,long>* table;
+		ReadWriteLock* readWriteLock;
+		Lock* lock;
+		unsigned long iterations;
+		unsigned int seed;
+
+	public:
+		volatile long checksum;
+
+	public:
+		TableWorker( std::map<long,long>* table,
+		             ReadWriteLock* readWriteLock,
+		             Lock* lock,
+		             unsigned long iterations,
+		             unsigned int seed )
+		{
+			this->table = table;
+			this->readWriteLock = readWriteLock;
+			this->lock = lock;
+			this->iterations = iterations;
+			this->seed = seed;
+			this->checksum = 0;
+		}
+
+		virtual void run()
+		{
+			long sum = 0;
+			for( unsigned long i = 0 ; i < this->iterations ; ++i )
+			{
+				this->seed = this->seed * 1103515245 + 12345;
+				long key = (this->seed >> 8) % TABLE_SIZE;
+				bool write = (this->seed >> 4) % 100 < 5;
+
+				if( this->readWriteLock )
+				{
+					if( write )
+					{
+						WriteLockGuard guard( *this->readWriteLock );
+						(*this->table)[key] = (long)i;
+					}
+					else
+					{
+						ReadLockGuard guard( *this->readWriteLock );
+						sum += this->table->find( key )->second;
+					}
+				}
+				else
+				{
+					LockGuard guard( *this->lock );
+					if( write )
+						(*this->table)[key] = (long)i;
+					else
+						sum += this->table->find( key )->second;
+				}
+			}
+
+			this->checksum = sum;
+		}
+};
+
+static void runMix( bool useReadWriteLock, int threadCount, unsigned long totalIterations )
+{
+	std::map<long,long> table;
+	for( long i = 0 ; i < TABLE_SIZE ; ++i )
+		table[i] = i;
+
+	ReadWriteLock readWriteLock;
+	Lock lock( LP_PLAIN );
+	unsigned long perThread = totalIterations / threadCount;
+
+	std::vector<TableWorker*> workers;
+	std::vector<Thread*> threads;
+	for( int i = 0 ; i < threadCount ; ++i )
+	{
+		workers.push_back( new TableWorker(&table,
+		                                   useReadWriteLock ? &readWriteLock : NULL,
+		                                   &lock,
+		                                   perThread,
+		                                   i + 1) );
+		threads.push_back( new Thread(workers.back()) );
+	}
+
+	unsigned long start = Platform::getCurrentTimeMilliseconds();
+	for( int i = 0 ; i < threadCount ; ++i )
+		threads[i]->start();
+
+	for( int i = 0 ; i < threadCount ; ++i )
+		threads[i]->join();
+	unsigned long elapsed = Platform::getCurrentTimeMilliseconds() - start;
+
+	for( int i = 0 ; i < threadCount ; ++i )
+	{
+		delete threads[i];
+		delete workers[i];
+	}
+
+	char scenario[64];
+	sprintf( scenario,
+	         "rwlock.%s 95/5 (%d threads, per op)",
+	         useReadWriteLock ? "readwrite" : "lock",
+	         threadCount );
+	reportBenchmark( scenario, perThread * threadCount, elapsed );
+}
+
+static void runReadWriteLockBenchmark()
+{
+	const int threadCounts[] = { 1, 2, 4, 8 };
+	for( int t = 0 ; t < 4 ; ++t )
+	{
+		runMix( false, threadCounts[t], 2000000 );
+		runMix( true, threadCounts[t], 2000000 );
+	}
+}
+
+BENCHMARK_REGISTRATION( "rwlock", runReadWriteLockBenchmark );
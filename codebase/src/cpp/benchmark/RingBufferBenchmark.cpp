@@ -0,0 +1,136 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "Benchmark.h"
+
+#include <vector>
+#include "syscommon/Platform.h"
+#include "syscommon/concurrent/SpscRingBuffer.h"
+#include "syscommon/concurrent/MpscRingBuffer.h"
+#include "syscommon/concurrent/Thread.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+template<typename Ring>
+class RingProducer : public IRunnable
+{
+	private:
+		Ring* ring;
+		unsigned long count;
+		size_t batchSize;
+
+	public:
+		RingProducer( Ring* ring, unsigned long count, size_t batchSize )
+		{
+			this->ring = ring;
+			this->count = count;
+			this->batchSize = batchSize;
+		}
+
+		virtual void run()
+		{
+			std::vector<unsigned long> batch( this->batchSize );
+			for( unsigned long i = 0 ; i < this->count ; i += this->batchSize )
+			{
+				if( this->batchSize == 1 )
+				{
+					this->ring->put( i );
+				}
+				else
+				{
+					for( size_t j = 0 ; j < this->batchSize ; ++j )
+						batch[j] = i + j;
+
+					this->ring->put( &batch[0], this->batchSize );
+				}
+			}
+		}
+};
+
+/*
+ * Runs the given number of producers against a single consumer until every element has been
+ * received, and reports the elapsed time
+ */
+template<typename Ring>
+static void runRingScenario( const char* scenario,
+                             unsigned int producerCount,
+                             size_t batchSize,
+                             WaitPolicy policy )
+{
+	const unsigned long perProducer = 4000000 / producerCount;
+
+	Ring ring( 4096, policy );
+	std::vector<RingProducer<Ring>*> producers;
+	std::vector<Thread*> threads;
+	for( unsigned int i = 0 ; i < producerCount ; ++i )
+	{
+		producers.push_back( new RingProducer<Ring>(&ring, perProducer, batchSize) );
+		threads.push_back( new Thread(producers[i]) );
+	}
+
+	std::vector<unsigned long> batch;
+	batch.reserve( 256 );
+
+	unsigned long start = Platform::getCurrentTimeMilliseconds();
+	for( unsigned int i = 0 ; i < producerCount ; ++i )
+		threads[i]->start();
+
+	unsigned long total = producerCount * perProducer;
+	for( unsigned long consumed = 0 ; consumed < total ; )
+	{
+		if( batchSize == 1 )
+		{
+			ring.take();
+			++consumed;
+		}
+		else
+		{
+			batch.clear();
+			consumed += ring.take( batch, 256 );
+		}
+	}
+
+	for( unsigned int i = 0 ; i < producerCount ; ++i )
+		threads[i]->join();
+	reportBenchmark( scenario, total, Platform::getCurrentTimeMilliseconds() - start );
+
+	for( unsigned int i = 0 ; i < producerCount ; ++i )
+	{
+		delete threads[i];
+		delete producers[i];
+	}
+}
+
+/*
+ * Passes elements between threads through the lock-free ring buffers, one at a time and in
+ * batches, for comparison with the queue benchmark
+ */
+static void runRingBufferBenchmark()
+{
+	typedef SpscRingBuffer<unsigned long> Spsc;
+	typedef MpscRingBuffer<unsigned long> Mpsc;
+
+	runRingScenario<Spsc>( "ring.spsc.single.yield", 1, 1, WP_YIELD );
+	runRingScenario<Spsc>( "ring.spsc.batch.yield", 1, 64, WP_YIELD );
+	runRingScenario<Spsc>( "ring.spsc.batch.park", 1, 64, WP_PARK );
+	runRingScenario<Mpsc>( "ring.mpsc.single.yield", 4, 1, WP_YIELD );
+	runRingScenario<Mpsc>( "ring.mpsc.batch.yield", 4, 64, WP_YIELD );
+	runRingScenario<Mpsc>( "ring.mpsc.batch.park", 4, 64, WP_PARK );
+}
+
+BENCHMARK_REGISTRATION( "ringbuffer", runRingBufferBenchmark );
@@ -0,0 +1,70 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "Benchmark.h"
+
+#include <vector>
+#include "syscommon/Platform.h"
+#include "syscommon/concurrent/ScheduledExecutor.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+class NoopRunnable : public IRunnable
+{
+	public:
+		virtual void run() {}
+};
+
+/*
+ * Measures scheduling and cancelling timers while a large number of other timers are pending, as
+ * happens when every connection has its own timeout
+ */
+static void runSchedulerBenchmark()
+{
+	const unsigned long backlog = 200000;
+	const unsigned long iterations = 1000000;
+
+	NoopRunnable task;
+	ScheduledExecutor executor( 2 );
+
+	std::vector<ScheduledFuture*> pending;
+	pending.reserve( backlog );
+
+	unsigned long start = Platform::getCurrentTimeMilliseconds();
+	for( unsigned long i = 0 ; i < backlog ; ++i )
+		pending.push_back( executor.schedule(&task, 60000 + i % 3600000) );
+	reportBenchmark( "scheduler.schedule", backlog, Platform::getCurrentTimeMilliseconds() - start );
+
+	start = Platform::getCurrentTimeMilliseconds();
+	for( unsigned long i = 0 ; i < iterations ; ++i )
+	{
+		ScheduledFuture* timeout = executor.schedule( &task, 30000 );
+		timeout->cancel( false );
+		delete timeout;
+	}
+	reportBenchmark( "scheduler.scheduleAndCancel",
+	                 iterations,
+	                 Platform::getCurrentTimeMilliseconds() - start );
+
+	start = Platform::getCurrentTimeMilliseconds();
+	for( unsigned long i = 0 ; i < backlog ; ++i )
+		delete pending[i];
+	reportBenchmark( "scheduler.cancel", backlog, Platform::getCurrentTimeMilliseconds() - start );
+}
+
+BENCHMARK_REGISTRATION( "scheduler", runSchedulerBenchmark );
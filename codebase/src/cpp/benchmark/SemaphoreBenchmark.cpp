@@ -0,0 +1,115 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "Benchmark.h"
+
+#include "syscommon/concurrent/Semaphore.h"
+#include "syscommon/concurrent/Thread.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+/*
+ * Bounces a single permit back and forth with the runner through a pair of semaphores
+ */
+class PingPongRunnable : public IRunnable
+{
+	private:
+		Semaphore* ping;
+		Semaphore* pong;
+		unsigned long rounds;
+
+	public:
+		PingPongRunnable( Semaphore* ping, Semaphore* pong, unsigned long rounds )
+		{
+			this->ping = ping;
+			this->pong = pong;
+			this->rounds = rounds;
+		}
+
+		virtual void run()
+		{
+			for( unsigned long i = 0 ; i < this->rounds ; ++i )
+			{
+				this->ping->acquire();
+				this->pong->release();
+			}
+		}
+};
+
+/*
+ * Cost of taking and returning a permit that is always available, as on a backpressure path that
+ * is not under pressure
+ */
+static void runUncontended()
+{
+	const unsigned long iterations = 5000000;
+	Semaphore semaphore( 16 );
+
+	unsigned long start = Platform::getCurrentTimeMilliseconds();
+	for( unsigned long i = 0 ; i < iterations ; ++i )
+	{
+		semaphore.acquire();
+		semaphore.release();
+	}
+	unsigned long elapsed = Platform::getCurrentTimeMilliseconds() - start;
+
+	reportBenchmark( "semaphore.uncontended (acquire+release)", iterations, elapsed );
+
+	start = Platform::getCurrentTimeMilliseconds();
+	for( unsigned long i = 0 ; i < iterations ; ++i )
+	{
+		semaphore.acquire( 8 );
+		semaphore.release( 8 );
+	}
+	elapsed = Platform::getCurrentTimeMilliseconds() - start;
+
+	reportBenchmark( "semaphore.uncontended (acquire(8)+release(8))", iterations, elapsed );
+}
+
+/*
+ * Round trip time when every acquire has to block until the other thread releases
+ */
+static void runPingPong()
+{
+	const unsigned long rounds = 100000;
+	Semaphore ping( 0 );
+	Semaphore pong( 0 );
+
+	PingPongRunnable runnable( &ping, &pong, rounds );
+	Thread thread( &runnable );
+	thread.start();
+
+	unsigned long start = Platform::getCurrentTimeMilliseconds();
+	for( unsigned long i = 0 ; i < rounds ; ++i )
+	{
+		ping.release();
+		pong.acquire();
+	}
+	unsigned long elapsed = Platform::getCurrentTimeMilliseconds() - start;
+
+	thread.join();
+	reportBenchmark( "semaphore.pingpong (per round trip)", rounds, elapsed );
+}
+
+static void runSemaphoreBenchmark()
+{
+	runUncontended();
+	runPingPong();
+}
+
+BENCHMARK_REGISTRATION( "semaphore", runSemaphoreBenchmark );
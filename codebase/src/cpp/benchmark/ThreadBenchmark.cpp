@@ -0,0 +1,97 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "Benchmark.h"
+
+#include <cstdio>
+#include <vector>
+
+#include "syscommon/concurrent/Thread.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+/*
+ * Repeatedly looks up the current thread, as the interruptable blocking operations do on entry
+ */
+class CurrentThreadLookup : public IRunnable
+{
+	private:
+		unsigned long iterations;
+
+	public:
+		volatile unsigned long found;
+
+	public:
+		CurrentThreadLookup( unsigned long iterations )
+		{
+			this->iterations = iterations;
+			this->found = 0;
+		}
+
+		virtual void run()
+		{
+			unsigned long count = 0;
+			for( unsigned long i = 0 ; i < this->iterations ; ++i )
+			{
+				if( Thread::currentThread() )
+					++count;
+			}
+
+			this->found = count;
+		}
+};
+
+static void runLookups( int threadCount, unsigned long totalIterations )
+{
+	unsigned long perThread = totalIterations / threadCount;
+
+	std::vector<CurrentThreadLookup*> lookups;
+	std::vector<Thread*> threads;
+	for( int i = 0 ; i < threadCount ; ++i )
+	{
+		lookups.push_back( new CurrentThreadLookup(perThread) );
+		threads.push_back( new Thread(lookups.back()) );
+	}
+
+	unsigned long start = Platform::getCurrentTimeMilliseconds();
+	for( int i = 0 ; i < threadCount ; ++i )
+		threads[i]->start();
+
+	for( int i = 0 ; i < threadCount ; ++i )
+		threads[i]->join();
+	unsigned long elapsed = Platform::getCurrentTimeMilliseconds() - start;
+
+	for( int i = 0 ; i < threadCount ; ++i )
+	{
+		delete threads[i];
+		delete lookups[i];
+	}
+
+	char scenario[64];
+	sprintf( scenario, "thread.currentThread (%d threads)", threadCount );
+	reportBenchmark( scenario, perThread * threadCount, elapsed );
+}
+
+static void runThreadBenchmark()
+{
+	const int threadCounts[] = { 1, 8, 32 };
+	for( int t = 0 ; t < 3 ; ++t )
+		runLookups( threadCounts[t], 20000000 );
+}
+
+BENCHMARK_REGISTRATION( "thread", runThreadBenchmark );
@@ -0,0 +1,62 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+// System Includes
+#include <iostream>
+#include <cstring>
+
+#include "Benchmark.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace std;
+
+/*
+ * Runs the registered benchmarks. With no arguments every benchmark is run, otherwise only those
+ * whose names start with one of the given arguments.
+ */
+int main( int argc, char* argv[] )
+{
+	std::map<std::string,BenchmarkFunction>& benchmarks = getBenchmarks();
+	int run = 0;
+
+	std::map<std::string,BenchmarkFunction>::iterator it = benchmarks.begin();
+	for( ; it != benchmarks.end(); ++it )
+	{
+		bool selected = argc < 2;
+		for( int i = 1 ; i < argc && !selected ; ++i )
+			selected = it->first.compare( 0, strlen(argv[i]), argv[i] ) == 0;
+
+		if( selected )
+		{
+			cout << "[" << it->first << "]" << endl;
+			it->second();
+			cout << endl;
+			++run;
+		}
+	}
+
+	if( run == 0 )
+	{
+		cout << "No benchmarks matched. Available benchmarks:" << endl;
+		for( it = benchmarks.begin(); it != benchmarks.end(); ++it )
+			cout << "  " << it->first << endl;
+
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <stddef.h>
+#include <vector>
+
+namespace syscommon
+{
+	enum CacheType
+	{
+		CT_DATA,
+		CT_INSTRUCTION,
+		CT_UNIFIED
+	};
+
+	/**
+	 * Where a logical processor sits in the machine. Cores and packages are numbered densely from
+	 * zero, so that they can be used as indexes, and do not necessarily match the ids the
+	 * operating system reports.
+	 */
+	struct ProcessorInfo
+	{
+		unsigned int id;
+		unsigned int core;
+		unsigned int package;
+		int node;
+	};
+
+	/**
+	 * One cache, along with the logical processors that share it
+	 */
+	struct CacheInfo
+	{
+		unsigned int level;
+		CacheType type;
+		size_t size;
+		unsigned int lineSize;
+		unsigned int associativity;
+		std::vector<unsigned int> processors;
+	};
+
+	/**
+	 * A description of the processors, cores, packages, NUMA nodes and caches of the machine,
+	 * obtained through Platform::getTopology(). It is intended for sizing thread pools and for
+	 * choosing where to pin threads, so that those decisions follow the host rather than being
+	 * configured for each type of machine.
+	 *
+	 * eg: run one pinned worker per physical core of the first NUMA node
+	 *
+	 * const CpuTopology& topology = Platform::getTopology();
+	 * std::vector<unsigned int> cores = topology.getOnePerCore( topology.getNodes()[0] );
+	 * for( size_t i = 0; i < cores.size(); ++i )
+	 * {
+	 *     ThreadOptions options;
+	 *     options.processors.push_back( cores[i] );
+	 *     workers.push_back( new Thread(worker, TEXT("Worker"), options) );
+	 * }
+	 *
+	 * Only processors that were online when the topology was read are included. Where the
+	 * operating system does not describe a part of the topology, each processor is treated as a
+	 * core of its own on a single package and node, and cache sizes are reported as 0.
+	 */
+	class CpuTopology
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+		public:
+			// Assumed when the operating system does not report a cache line size
+			static const unsigned int DEFAULT_CACHE_LINE_SIZE = 64;
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			// Sorted by processor id
+			std::vector<ProcessorInfo> processors;
+			std::vector<CacheInfo> caches;
+			std::vector<int> nodes;
+			unsigned int coreCount;
+			unsigned int packageCount;
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Creates an empty topology. Topologies are normally obtained through
+			 * Platform::getTopology(), which fills them in.
+			 */
+			CpuTopology();
+			virtual ~CpuTopology();
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Returns the number of logical processors, counting each hardware thread of an SMT
+			 * core separately
+			 */
+			unsigned int getProcessorCount() const;
+
+			/**
+			 * Returns the number of physical cores
+			 */
+			unsigned int getCoreCount() const;
+
+			/**
+			 * Returns the number of physical processor packages (sockets)
+			 */
+			unsigned int getPackageCount() const;
+
+			/**
+			 * Returns the largest number of hardware threads on any one core, which is 1 if SMT
+			 * is not available or is disabled
+			 */
+			unsigned int getThreadsPerCore() const;
+
+			/**
+			 * Returns the NUMA nodes that have processors, in ascending order
+			 */
+			const std::vector<int>& getNodes() const;
+
+			/**
+			 * Returns every logical processor, in ascending order of id
+			 */
+			const std::vector<ProcessorInfo>& getProcessors() const;
+
+			/**
+			 * Returns every cache in the machine. A cache that is shared between several
+			 * processors appears once.
+			 */
+			const std::vector<CacheInfo>& getCaches() const;
+
+			/**
+			 * Returns the size in bytes of the data (or unified) cache at the given level, as
+			 * seen by a single processor, or 0 if there is no such cache
+			 *
+			 * @param level the cache level, 1 for L1, 2 for L2 and so on
+			 */
+			size_t getCacheSize( unsigned int level ) const;
+
+			/**
+			 * Returns the size in bytes of the smallest unit of memory that the caches transfer,
+			 * which is what shared data should be padded to
+			 */
+			unsigned int getCacheLineSize() const;
+
+			/**
+			 * Returns the NUMA node that the given processor belongs to, or -1 if the processor
+			 * is not known
+			 */
+			int getNodeOf( unsigned int processor ) const;
+
+			/**
+			 * Returns the logical processors on the given NUMA node, in ascending order
+			 */
+			std::vector<unsigned int> getNodeProcessors( int node ) const;
+
+			/**
+			 * Returns the logical processors that share a physical core with the given processor,
+			 * including the processor itself
+			 */
+			std::vector<unsigned int> getSiblings( unsigned int processor ) const;
+
+			/**
+			 * Returns one logical processor from each physical core, so that threads pinned to
+			 * them do not compete for the execution units of a core
+			 */
+			std::vector<unsigned int> getOnePerCore() const;
+
+			/**
+			 * Returns one logical processor from each physical core on the given NUMA node
+			 */
+			std::vector<unsigned int> getOnePerCore( int node ) const;
+
+		private:
+			const ProcessorInfo* findProcessor( unsigned int processor ) const;
+			ProcessorInfo* findProcessor( unsigned int processor );
+
+		//----------------------------------------------------------
+		//                     STATIC METHODS
+		//----------------------------------------------------------
+
+		friend class Platform;
+	};
+}
@@ -44,6 +44,13 @@ namespace syscommon
 			virtual ~IllegalArgumentException() noexcept {}
 	};
 
+	class IllegalStateException : public Exception
+	{
+		public:
+			IllegalStateException( const tchar* message ) : Exception( message ) {}
+			virtual ~IllegalStateException() noexcept {}
+	};
+
 	class InterruptedException : public Exception
 	{
 		public:
@@ -51,6 +58,27 @@ namespace syscommon
 			virtual ~InterruptedException() noexcept {}
 	};
 
+	class RejectedExecutionException : public Exception
+	{
+		public:
+			RejectedExecutionException( const tchar* message ) : Exception( message ) {}
+			virtual ~RejectedExecutionException() noexcept {}
+	};
+
+	class CancellationException : public Exception
+	{
+		public:
+			CancellationException( const tchar* message ) : Exception( message ) {}
+			virtual ~CancellationException() noexcept {}
+	};
+
+	class ExecutionException : public Exception
+	{
+		public:
+			ExecutionException( const tchar* message ) : Exception( message ) {}
+			virtual ~ExecutionException() noexcept {}
+	};
+
 	class IOException : public Exception
 	{
 		public:
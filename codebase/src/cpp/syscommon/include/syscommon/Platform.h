@@ -48,37 +48,83 @@
 	#define NATIVE_SOCKET_ERROR			-1
 	#define NATIVE_IP_ADDRESS			u_long
 	#define NATIVE_SOCKET_LEN			int
+	#define NATIVE_SOCKET_SEND_FLAGS	0
+
+	// Files opened for sending over sockets
+	#define NATIVE_FILE					HANDLE
+	#define NATIVE_FILE_UNINIT			INVALID_HANDLE_VALUE
+
+	// Readiness queues. There is no native one, so Selectors fall back to polling.
+	#define NATIVE_POLLER				int
+	#define NATIVE_POLLER_UNINIT		-1
+
+	// Completion rings. Overlapped I/O is not used, so CompletionEngines fall back to blocking
+	// calls.
+	struct WrappedRing
+	{
+		bool initialised;
+	};
+
+	#define NATIVE_RING					WrappedRing
 
 	// Critical Sections
 	#define NATIVE_CRITICALSECTION		CRITICAL_SECTION
 
 	// Conditions
 	#define NATIVE_EVENT				HANDLE
+
+	// Read/Write Locks
+	#define NATIVE_RWLOCK				SRWLOCK
 #else	
 	#include <pthread.h>
 	#include <netinet/in.h>
 	#include <errno.h>
-	#include <semaphore.h>
-	#include <list>
 	#include <sys/select.h>
 
 	// Semaphores
-	#define NATIVE_SEMAPHORE			sem_t*
-
-	// Events
-	struct EventListener
+	struct WrappedSemaphore
 	{
-		pthread_mutex_t mutex;
-		pthread_cond_t condition;
+		bool initialised;
+		int permits;
+
+		// Advanced whenever a sleeping acquirer may need to re-check the permit count. Acquirers
+		// sleep on this word rather than on the permit count, so that thread interrupts can
+		// wake them as well.
+		int sequence;
+		int waiters;
+
+		// Number of releaseSemaphore() calls still touching the semaphore, which
+		// destroySemaphore() waits for along with the waiters
+		int releasers;
 	};
 
+	#define NATIVE_SEMAPHORE			WrappedSemaphore
+
+	// Events
 	struct WrappedEvent
 	{
 		bool initialised;
-		std::list<EventListener*> listenerList;
-		pthread_cond_t noMoreListenersEvent;
-		pthread_mutex_t mutex;
-		bool state;
+
+		// Odd while the event is signaled. The value advances on every signal and clear, so a
+		// waiter that sees it change knows the event was signaled since it started waiting, even
+		// if it has been cleared again since. Waiters block on this word directly.
+		int sequence;
+		int waiters;
+
+		// Number of signalEvent() calls still touching the event, which destroyEvent() waits
+		// for along with the waiters
+		int signalers;
+	};
+
+	// Thread interrupts
+	struct WrappedInterrupt
+	{
+		WrappedEvent event;
+
+		// The word the thread is currently sleeping on, if it is blocked in a semaphore. Guarded
+		// by blockedLock, so that the word cannot go away while an interrupter is waking it.
+		pthread_mutex_t blockedLock;
+		int* blockedOn;
 	};
 
 	// Threads
@@ -99,12 +145,19 @@
 		WrappedThread* nativeThread;
 		void* argument;
 
+		// Applied by the new thread to itself before it runs the argument
+		int niceValue;
+		int numaNode;
+
+		// Set if the thread could not be given its options after it was created, in which case
+		// it exits as soon as it is resumed
+		bool abandoned;
 	};
 
 	#define NATIVE_EVENT				WrappedEvent
 
 	#define NATIVE_THREAD				WrappedThread
-	#define NATIVE_INTERRUPT			WrappedEvent
+	#define NATIVE_INTERRUPT			WrappedInterrupt
 	#define NATIVE_THREAD_PROC			void*
 	#define NATIVE_THREAD_CALL
 	#define NATIVE_INFINITE_WAIT		ULONG_MAX
@@ -116,14 +169,96 @@
 	#define NATIVE_IP_ADDRESS			u_int32_t
 	#define NATIVE_SOCKET_LEN			socklen_t
 
+	// Writing to a connection the other end has closed should fail rather than raise SIGPIPE
+	#ifdef MSG_NOSIGNAL
+	#define NATIVE_SOCKET_SEND_FLAGS	MSG_NOSIGNAL
+	#else
+	#define NATIVE_SOCKET_SEND_FLAGS	0
+	#endif
+
+	// Files opened for sending over sockets
+	#define NATIVE_FILE					int
+	#define NATIVE_FILE_UNINIT			-1
+
+	// Readiness queues (epoll)
+	#define NATIVE_POLLER				int
+	#define NATIVE_POLLER_UNINIT		-1
+
+	// Completion rings (io_uring). The queues are shared with the kernel, so the pointers here
+	// point into memory mapped from the ring's descriptor.
+	struct WrappedRing
+	{
+		int descriptor;
+		unsigned int entries;
+
+		unsigned int* submitHead;
+		unsigned int* submitTail;
+		unsigned int* submitArray;
+		unsigned int submitMask;
+		void* submitEntries;
+
+		unsigned int* completeHead;
+		unsigned int* completeTail;
+		unsigned int completeMask;
+		void* completeEntries;
+
+		void* ringMemory;
+		size_t ringSize;
+		void* entryMemory;
+		size_t entrySize;
+	};
+
+	#define NATIVE_RING					WrappedRing
+
 	// Critical Sections
-	#define NATIVE_CRITICALSECTION		pthread_mutex_t
+	struct WrappedCriticalSection
+	{
+		int policy;
+
+		// LP_RECURSIVE and LP_PLAIN
+		pthread_mutex_t mutex;
+
+		// LP_ADAPTIVE: 0 unlocked, 1 locked, 2 locked with sleepers
+		int state;
+
+		// LP_QUEUED: a ticket lock
+		int nextTicket;
+		int nowServing;
+		int waiters;
+	};
+
+	#define NATIVE_CRITICALSECTION		WrappedCriticalSection
+
+	// Read/Write Locks
+	struct WrappedReadWriteLock
+	{
+		// Number of readers holding the lock, with the top bit set while a writer holds it
+		int state;
+
+		// Sleeping readers and writers park on separate words, so that one side can be woken
+		// without disturbing the other
+		int readersWaiting;
+		int writersWaiting;
+		int readerSequence;
+		int writerSequence;
+	};
+
+	#define NATIVE_RWLOCK				WrappedReadWriteLock
+#endif
+
+// Coroutines. Task and the awaitables built on it are only available to code compiled as C++20,
+// so that the rest of the library still builds with older compilers.
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+	#define SYSCOMMON_HAS_COROUTINES
 #endif
 
 #include <string>
 #include <set>
+#include <vector>
 #include <time.h>
 
+#include "syscommon/CpuTopology.h"
+
 namespace syscommon
 {		
 #ifndef UNICODE  
@@ -162,6 +297,313 @@ namespace syscommon
 		WR_ABANDONED
 	};
 
+	/**
+	 * How a Lock (critical section) behaves when it is contended or re-entered
+	 *
+	 * <ul>
+	 * 	<li>LP_RECURSIVE may be locked again by the thread that holds it</li>
+	 * 	<li>LP_PLAIN is a non-recursive mutex, locking it twice from the same thread deadlocks</li>
+	 * 	<li>LP_ADAPTIVE spins for a short while before putting the thread to sleep, which suits
+	 * 	locks that are only held for a handful of instructions</li>
+	 * 	<li>LP_QUEUED hands the lock over in the order threads asked for it, so that no thread is
+	 * 	starved under heavy contention</li>
+	 * </ul>
+	 *
+	 * Only LP_RECURSIVE allows re-entry.
+	 */
+	enum LockPolicy
+	{
+		LP_RECURSIVE,
+		LP_PLAIN,
+		LP_ADAPTIVE,
+		LP_QUEUED
+	};
+
+	/**
+	 * The scheduling class a Thread runs in
+	 *
+	 * <ul>
+	 * 	<li>SP_DEFAULT leaves the thread in the operating system's normal time sharing class</li>
+	 * 	<li>SP_BATCH is time sharing for CPU bound work that is not sensitive to wake-up
+	 * 	latency</li>
+	 * 	<li>SP_IDLE only runs the thread when nothing else wants the CPU</li>
+	 * 	<li>SP_FIFO is real time, and runs the thread until it blocks or a higher priority real
+	 * 	time thread becomes runnable</li>
+	 * 	<li>SP_ROUND_ROBIN is real time like SP_FIFO, but shares the CPU between threads of equal
+	 * 	priority in time slices</li>
+	 * </ul>
+	 *
+	 * The real time classes usually need elevated privileges. Windows has no scheduling classes
+	 * as such, so there each policy is mapped onto a thread priority.
+	 */
+	enum SchedulingPolicy
+	{
+		SP_DEFAULT,
+		SP_BATCH,
+		SP_IDLE,
+		SP_FIFO,
+		SP_ROUND_ROBIN
+	};
+
+	/**
+	 * Settings that are applied to a Thread when it is created, before it runs any user code.
+	 * The defaults leave every setting up to the operating system.
+	 */
+	struct ThreadOptions
+	{
+		// The processors the thread may run on. Empty to allow all of them.
+		std::vector<unsigned int> processors;
+
+		SchedulingPolicy schedulingPolicy;
+
+		// For SP_FIFO and SP_ROUND_ROBIN, the real time priority (1-99 on Linux). For the other
+		// policies a nice value, where negative values raise the priority and need privileges.
+		int priority;
+
+		// The size of the thread's stack in bytes, or 0 for the system default
+		size_t stackSize;
+
+		// The NUMA node the thread should run on and allocate its memory from, or -1 for no
+		// preference. Only restricts the processors if none were given explicitly.
+		int numaNode;
+
+		ThreadOptions() : schedulingPolicy( SP_DEFAULT ), priority( 0 ), stackSize( 0 ), numaNode( -1 )
+		{
+
+		}
+	};
+
+	/**
+	 * Readiness conditions that can be waited for on a socket, combined as a bit mask
+	 */
+	enum SocketEvent
+	{
+		SE_READ = 0x01,
+		SE_WRITE = 0x02,
+		SE_ERROR = 0x04
+	};
+
+	/**
+	 * Named sets of SocketOptions for the usual kinds of traffic:
+	 * <ul>
+	 * 	<li>TP_DEFAULT leaves every option up to the operating system</li>
+	 * 	<li>TP_LOW_LATENCY is for request/response traffic, where Nagle's algorithm and delayed
+	 * 	acknowledgements each hold small messages back for up to 40ms. It turns both off, and
+	 * 	busy polls the device briefly on receive where the process is allowed to.</li>
+	 * 	<li>TP_BULK_THROUGHPUT is for streaming large amounts of data, where coalescing small
+	 * 	writes helps and the kernel's default buffers limit how much can be in flight. It leaves
+	 * 	Nagle's algorithm on and sizes both buffers at 4MB.</li>
+	 * </ul>
+	 */
+	enum TuningProfile
+	{
+		TP_DEFAULT,
+		TP_LOW_LATENCY,
+		TP_BULK_THROUGHPUT
+	};
+
+	/**
+	 * Settings applied to a Socket, or inherited from a ServerSocket by every Socket it accepts.
+	 * The defaults leave every setting up to the operating system, and each field has a value
+	 * that does the same. Options the platform does not have are skipped, as they tune the
+	 * connection rather than change what it does.
+	 */
+	struct SocketOptions
+	{
+		// 1 to send small writes straight away (TCP_NODELAY), 0 to let Nagle's algorithm
+		// coalesce them, or -1 to leave the default
+		int noDelay;
+
+		// 1 to acknowledge data as soon as it arrives rather than delaying the ACK in the hope
+		// of piggybacking it (TCP_QUICKACK), or -1 to leave the default. The kernel can fall
+		// back to delaying, so Socket turns this on again after each receive.
+		int quickAck;
+
+		// The size of the send and receive buffers in bytes (SO_SNDBUF and SO_RCVBUF), or 0
+		// for the default. Setting a size stops the kernel tuning the buffer itself.
+		int sendBufferSize;
+		int receiveBufferSize;
+
+		// How long a receive may busy poll the network device for data before sleeping, in
+		// microseconds (SO_BUSY_POLL), or 0 for the default. Raising this needs CAP_NET_ADMIN,
+		// and is skipped without it.
+		int busyPoll;
+
+		// How long sent data may go unacknowledged before the connection is dropped, in
+		// milliseconds (TCP_USER_TIMEOUT), or 0 for the default
+		unsigned int userTimeout;
+
+		// 1 to probe an idle connection to find out whether the other end is still there
+		// (SO_KEEPALIVE), 0 not to, or -1 to leave the default. The idle time before the first
+		// probe and the interval between them are in seconds, and the count is how many probes
+		// go unanswered before the connection is dropped. 0 leaves each of them alone.
+		int keepAlive;
+		int keepAliveIdle;
+		int keepAliveInterval;
+		int keepAliveCount;
+
+		// How long close() waits for unsent data to go, in seconds (SO_LINGER). 0 drops the
+		// data and resets the connection. -1 to leave the default, which is to send the data
+		// in the background.
+		int linger;
+
+		SocketOptions() : noDelay( -1 ), quickAck( -1 ), sendBufferSize( 0 ), receiveBufferSize( 0 ),
+		                  busyPoll( 0 ), userTimeout( 0 ), keepAlive( -1 ), keepAliveIdle( 0 ),
+		                  keepAliveInterval( 0 ), keepAliveCount( 0 ), linger( -1 )
+		{
+
+		}
+
+		/**
+		 * Creates the options of the given profile
+		 */
+		explicit SocketOptions( TuningProfile profile );
+	};
+
+	/**
+	 * A socket to wait on with Platform::pollSockets(). The caller fills in the socket and the
+	 * SocketEvents it is interested in, and the poll fills in the ones that were ready. SE_ERROR
+	 * is reported whether it was asked for or not.
+	 */
+	struct SocketPoll
+	{
+		NATIVE_SOCKET socket;
+		int interest;
+		int ready;
+	};
+
+	/**
+	 * A socket that Platform::waitOnPoller() found ready. The context is the one the socket was
+	 * added to the poller with.
+	 */
+	struct PollerEvent
+	{
+		void* context;
+		int ready;
+	};
+
+	/**
+	 * One datagram of a batch sent with Platform::sendDatagrams() or received with
+	 * Platform::receiveDatagrams(). A receive fills in the length, address and port from what
+	 * arrived.
+	 *
+	 * A send with a segment size puts the buffer on the wire as datagrams of that many bytes
+	 * (the last may be shorter). A receive on a socket with receive offload enabled sets it to
+	 * the size of the datagrams that were coalesced into the buffer, or 0 if it holds just one.
+	 */
+	struct DatagramMessage
+	{
+		// The most datagrams that one call takes
+		static const int MAX_BATCH = 64;
+
+		// The most segments that one segmented send may be split into
+		static const int MAX_SEGMENTS = 64;
+
+		char* buffer;
+		int length;
+		NATIVE_IP_ADDRESS address;
+		unsigned short port;
+		int segmentSize;
+	};
+
+	/**
+	 * One piece of a message that is sent with Platform::sendSegments() or received with
+	 * Platform::receiveSegments(), so that a message held in several buffers, such as a header
+	 * and its payload, can be moved without first being copied into one
+	 */
+	struct BufferSegment
+	{
+		// The most segments that one call takes
+		static const int MAX_BATCH = 64;
+
+		char* buffer;
+		int length;
+	};
+
+	/**
+	 * A run of zero-copy sends that the kernel has finished with, read by
+	 * Platform::readZeroCopyCompletions(). Sends are numbered from 0 in the order they were made
+	 * on the socket, and the run covers first to last inclusive. Copied is set if the kernel fell
+	 * back to copying the data, so that the send gained nothing from being zero-copy.
+	 */
+	struct ZeroCopyRange
+	{
+		unsigned int first;
+		unsigned int last;
+		bool copied;
+	};
+
+	enum RingOperationType
+	{
+		RO_ACCEPT,
+		RO_RECEIVE,
+		RO_SEND,
+		RO_READ,
+		RO_READ_FIXED,
+		RO_WRITE_FIXED,
+		RO_RECEIVE_FROM,
+		RO_SEND_TO,
+		RO_PROVIDE_BUFFERS,
+		RO_CANCEL
+	};
+
+	/**
+	 * An operation to queue on a completion ring with Platform::queueRingOperation(). The buffer
+	 * (and the header for RO_RECEIVE_FROM and RO_SEND_TO) must stay valid until the operation
+	 * completes, as the kernel works on them after the call has returned.
+	 */
+	struct RingOperation
+	{
+		// Space needed in the header for the message the kernel is handed
+		static const size_t HEADER_SIZE = 128;
+
+		RingOperationType type;
+		NATIVE_SOCKET socket;
+		void* buffer;
+
+		// For RO_PROVIDE_BUFFERS, the size of each of the count buffers
+		unsigned int length;
+		unsigned int count;
+
+		// The registered buffer for RO_READ_FIXED and RO_WRITE_FIXED, or the buffer group for
+		// RO_PROVIDE_BUFFERS and selectBuffer. bufferId numbers the first provided buffer.
+		unsigned short bufferIndex;
+		unsigned short bufferId;
+		bool selectBuffer;
+		bool multishot;
+
+		// The destination of RO_SEND_TO
+		NATIVE_IP_ADDRESS address;
+		unsigned short port;
+		void* header;
+
+		// Handed back with the completion. For RO_CANCEL, the context of the operation to cancel.
+		void* context;
+
+		RingOperation() : type( RO_RECEIVE ), socket( NATIVE_SOCKET_UNINIT ), buffer( NULL ),
+		                  length( 0 ), count( 0 ), bufferIndex( 0 ), bufferId( 0 ),
+		                  selectBuffer( false ), multishot( false ), address( 0 ), port( 0 ),
+		                  header( NULL ), context( NULL )
+		{
+
+		}
+	};
+
+	/**
+	 * An operation that a completion ring finished. The result is what the equivalent system
+	 * call would have returned, or a negated error code. A multishot operation carries on
+	 * producing completions for as long as more is set.
+	 */
+	struct RingCompletion
+	{
+		void* context;
+		int result;
+		bool more;
+
+		// The provided buffer the data was placed in, or -1
+		int bufferId;
+	};
+
 	/**
 	 * The Platform class encapsulates all system call functionality that is implemented 
 	 * differently across the platforms that SysCommon supports.
@@ -207,23 +649,40 @@ namespace syscommon
 			static bool initialiseSemaphore( NATIVE_SEMAPHORE& nativeSemaphore, 
 											 unsigned int maximumCount, 
 											 const String& name );
-			static bool isSemaphoreInitialised( const NATIVE_SEMAPHORE nativeSemaphore );
+			static bool isSemaphoreInitialised( const NATIVE_SEMAPHORE& nativeSemaphore );
 			static bool destroySemaphore( NATIVE_SEMAPHORE& nativeSemaphore );
+			static bool tryAcquireSemaphore( NATIVE_SEMAPHORE& nativeSemaphore, unsigned int permits );
+			static unsigned int drainSemaphore( NATIVE_SEMAPHORE& nativeSemaphore,
+												unsigned int maxPermits );
 			static WaitResult waitOnSemaphore( NATIVE_SEMAPHORE& nativeSemaphore, 
+											   unsigned int permits,
 											   NATIVE_INTERRUPT& threadInterrupt, 
 											   unsigned long timeout );
-			static bool releaseSemaphore( NATIVE_SEMAPHORE& nativeSemaphore );
+			static bool releaseSemaphore( NATIVE_SEMAPHORE& nativeSemaphore, unsigned int permits );
 	
 			// Critical Sections
 			static void initialiseCriticalSection( NATIVE_CRITICALSECTION& nativeCriticalSection );
+			static void initialiseCriticalSection( NATIVE_CRITICALSECTION& nativeCriticalSection,
+												   LockPolicy policy );
 			static void destroyCriticalSection( NATIVE_CRITICALSECTION& nativeCriticalSection );
 			static void enterCriticalSection( NATIVE_CRITICALSECTION& nativeCriticalSection );
 			static void leaveCriticalSection( NATIVE_CRITICALSECTION& nativeCriticalSection );
 
+			// Read/Write Locks
+			static void initialiseReadWriteLock( NATIVE_RWLOCK& nativeLock );
+			static void destroyReadWriteLock( NATIVE_RWLOCK& nativeLock );
+			static bool acquireReadLock( NATIVE_RWLOCK& nativeLock, unsigned long timeout );
+			static void releaseReadLock( NATIVE_RWLOCK& nativeLock );
+			static bool acquireWriteLock( NATIVE_RWLOCK& nativeLock, unsigned long timeout );
+			static void releaseWriteLock( NATIVE_RWLOCK& nativeLock );
+
 			// Threads
 			static NATIVE_THREAD createUninitialisedThread();
 			static bool initialiseThread( NATIVE_THREAD& nativeThread, 
 										  void* argument );
+			static bool initialiseThread( NATIVE_THREAD& nativeThread,
+										  void* argument,
+										  const ThreadOptions& options );
 			static bool isThreadInitialised( const NATIVE_THREAD& nativeThread );
 			static bool destroyThread( NATIVE_THREAD& nativeThread );
 			static bool resumeThread( NATIVE_THREAD& nativeThread );
@@ -232,6 +691,13 @@ namespace syscommon
 										  unsigned long timeout );
 			static NATIVE_THREAD getCurrentThreadHandle();
 			static bool threadHandlesEqual( NATIVE_THREAD handleOne, NATIVE_THREAD handleTwo );
+			static void yieldThread();
+			static void spinPause();
+			static unsigned int getProcessorCount();
+			static unsigned int getCurrentProcessor();
+
+			// Read from the operating system on the first call, and cached from then on
+			static const CpuTopology& getTopology();
 
 			static NATIVE_INTERRUPT createUninitialisedInterrupt();
 			static bool initialiseThreadInterrupt( NATIVE_INTERRUPT& nativeInterrupt, 
@@ -241,6 +707,7 @@ namespace syscommon
 			static WaitResult performInterruptableSleep( NATIVE_INTERRUPT& threadInterrupt, 
 														 unsigned long timeout );
 			static bool signalInterrupt( NATIVE_INTERRUPT& nativeInterrupt );
+			static bool clearInterrupt( NATIVE_INTERRUPT& nativeInterrupt );
 
 			// Events
 			static NATIVE_EVENT createUninitialisedEvent();
@@ -267,7 +734,133 @@ namespace syscommon
 			static int setNonBlockingMode( NATIVE_SOCKET socket, bool enable );
 			static const int closeSocket( NATIVE_SOCKET socket );
 			static const tchar* describeLastSocketError();
+			static const tchar* describeSocketError( int errorCode );
 			static bool isLastSocketErrorSocketConnecting();
+			static bool isLastSocketErrorWouldBlock();
+			static bool setReusePort( NATIVE_SOCKET socket, bool enable );
+			// Apply every option that is not left to the default, returning false if the
+			// platform refused one, with the error it gave left as the last socket error.
+			// rearmQuickAck() turns TCP_QUICKACK on again after a receive.
+			static bool applySocketOptions( NATIVE_SOCKET socket, const SocketOptions& options );
+			static void rearmQuickAck( NATIVE_SOCKET socket );
+			// Attach a program to the group of sockets sharing the socket's port through
+			// SO_REUSEPORT that gives each connection to the socket at the index of the processor
+			// it arrived on in processors, in the order the sockets were bound, falling back to
+			// spreading them by processor number. Returns false where it cannot be done.
+			static bool setReusePortSteering( NATIVE_SOCKET socket,
+			                                  const std::vector<unsigned int>& processors );
+			static bool setIncomingProcessor( NATIVE_SOCKET socket, int processor );
+			static int getIncomingProcessor( NATIVE_SOCKET socket );
+			static int pollSockets( SocketPoll* sockets, size_t count, unsigned long timeout );
+
+			// Move up to DatagramMessage::MAX_BATCH datagrams with as few system calls as the
+			// platform allows, one where it has recvmmsg() and sendmmsg(). A receive that is asked
+			// to wait only does so for the first datagram, and then takes whatever else has
+			// already arrived. Both return the number of datagrams moved, or -1 if the first
+			// could not be.
+			static int receiveDatagrams( NATIVE_SOCKET socket,
+			                             DatagramMessage* messages,
+			                             int count,
+			                             bool wait );
+			static int sendDatagrams( NATIVE_SOCKET socket, DatagramMessage* messages, int count );
+
+			// Segmented sends are split by the kernel (UDP_SEGMENT) where it can, and otherwise
+			// one segment at a time. Receive offload (UDP_GRO) lets the kernel hand over a run of
+			// datagrams from the same sender in one buffer, and fails where it is not supported.
+			static bool setReceiveOffload( NATIVE_SOCKET socket, bool enable );
+
+			// Gather the segments into one send (sendmsg()), or scatter one receive across them
+			// (readv()), taking up to BufferSegment::MAX_BATCH segments. Both return the number
+			// of bytes moved, or NATIVE_SOCKET_ERROR, as for ::send() and ::recv(). Without them
+			// (Windows) a send takes one call per segment and a receive fills just one.
+			static int sendSegments( NATIVE_SOCKET socket, const BufferSegment* segments, int count );
+			static int receiveSegments( NATIVE_SOCKET socket, BufferSegment* segments, int count );
+
+			// Zero-copy sends (MSG_ZEROCOPY) pin the caller's buffer rather than copying it, and
+			// report when they are done with it through the socket's error queue.
+			// setZeroCopy() fails where the platform has no zero-copy sends. sendZeroCopy()
+			// returns as for ::send(), and sets copied if it had to copy the data instead, in which
+			// case no completion will follow. readZeroCopyCompletions() takes what is waiting
+			// without blocking, returning the number of ranges read.
+			static bool setZeroCopy( NATIVE_SOCKET socket, bool enable );
+			static int sendZeroCopy( NATIVE_SOCKET socket,
+			                         const char* buffer,
+			                         int length,
+			                         bool& copied );
+			static int readZeroCopyCompletions( NATIVE_SOCKET socket,
+			                                    ZeroCopyRange* ranges,
+			                                    int count );
+
+			// Send up to length bytes of a file from the given offset without them passing
+			// through user memory: sendfile(), or splice() where the file is a pipe, which has no
+			// offset. Where the platform has neither the file is read through a buffer. Returns
+			// the number of bytes sent, 0 at the end of the file, or -1 on failure.
+			static long long sendFile( NATIVE_SOCKET socket,
+			                           NATIVE_FILE file,
+			                           long long offset,
+			                           long long length );
+
+			// A pipe that relaySocket() passes data through on its way from one socket to another,
+			// so that it stays in the kernel. createRelay() fails where the platform has no
+			// splice(). relaySocket() returns the number of bytes relayed, 0 once the source has
+			// closed, or -1 on failure.
+			static bool createRelay( NATIVE_FILE& readEnd, NATIVE_FILE& writeEnd );
+			static long long relaySocket( NATIVE_SOCKET from,
+			                              NATIVE_SOCKET to,
+			                              NATIVE_FILE readEnd,
+			                              NATIVE_FILE writeEnd,
+			                              long long length );
+
+			// A socket that becomes readable when it is signaled, so that a thread waiting in
+			// pollSockets() can be woken from another thread. Closed with closeSocket().
+			static NATIVE_SOCKET createWakeupSocket();
+			static void signalWakeupSocket( NATIVE_SOCKET wakeup );
+			static void clearWakeupSocket( NATIVE_SOCKET wakeup );
+
+			// A kernel readiness queue that sockets are added to once, rather than being passed
+			// in on every wait. createPoller() returns NATIVE_POLLER_UNINIT where the platform has
+			// none, in which case callers fall back to pollSockets().
+			static NATIVE_POLLER createPoller();
+			static void closePoller( NATIVE_POLLER poller );
+			static bool addToPoller( NATIVE_POLLER poller,
+			                         NATIVE_SOCKET socket,
+			                         int interest,
+			                         bool edgeTriggered,
+			                         void* context );
+			static bool modifyInPoller( NATIVE_POLLER poller,
+			                            NATIVE_SOCKET socket,
+			                            int interest,
+			                            bool edgeTriggered,
+			                            void* context );
+			static bool removeFromPoller( NATIVE_POLLER poller, NATIVE_SOCKET socket );
+			static int waitOnPoller( NATIVE_POLLER poller,
+			                         PollerEvent* events,
+			                         size_t maxEvents,
+			                         unsigned long timeout );
+
+			// A pair of queues shared with the kernel, through which operations are submitted and
+			// their completions collected in batches. initialiseRing() fails where the platform
+			// has none, in which case callers fall back to blocking calls. Operations queued with
+			// queueRingOperation() are not started until submitRing() is called.
+			static NATIVE_RING createUninitialisedRing();
+			static bool initialiseRing( NATIVE_RING& ring, unsigned int entries );
+			static bool isRingInitialised( const NATIVE_RING& ring );
+			static void destroyRing( NATIVE_RING& ring );
+			static bool registerRingBuffers( NATIVE_RING& ring,
+			                                 char* base,
+			                                 size_t bufferSize,
+			                                 unsigned int count );
+			static bool queueRingOperation( NATIVE_RING& ring, const RingOperation& operation );
+			static int submitRing( NATIVE_RING& ring, bool wait, unsigned long timeout );
+			static size_t reapRing( NATIVE_RING& ring,
+			                        RingCompletion* completions,
+			                        size_t maxCompletions );
+			static void getRingSender( const void* header,
+			                           NATIVE_IP_ADDRESS& address,
+			                           unsigned short& port );
+			static bool getPeerAddress( NATIVE_SOCKET socket,
+			                            NATIVE_IP_ADDRESS& address,
+			                            unsigned short& port );
 			static std::set<NATIVE_IP_ADDRESS> getAvailableNetworkInterfaceAddresses();
 
 			// String helpers
@@ -302,13 +895,26 @@ namespace syscommon
 
 			// Files
 			static bool fileExists( const tchar* fileName );
+
+			// Files opened for reading by sendFile(). openFile() returns NATIVE_FILE_UNINIT if
+			// the file cannot be opened, and getFileSize() returns -1 if the file has no size,
+			// as for a pipe.
+			static NATIVE_FILE openFile( const tchar* fileName );
+			static void closeFile( NATIVE_FILE file );
+			static long long getFileSize( NATIVE_FILE file );
 			static String getCurrentDirectoryString();
 
 			// Time
+			// getCurrentTimeMilliseconds() follows the system clock, which can be stepped. To
+			// measure intervals use nanoTime(), which is monotonic and has an arbitrary origin.
 			static unsigned long getCurrentTimeMilliseconds();
+			static long long nanoTime();
 			static tm* toLocalTime( const time_t& time );
 			static bool getRandomBytes( char* buffer, size_t length );
 
+		private:
+			static CpuTopology discoverTopology();
+
 #ifdef _WIN32
 		// Win32 Specific
 		private:
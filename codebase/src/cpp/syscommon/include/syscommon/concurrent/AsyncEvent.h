@@ -0,0 +1,171 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <utility>
+#include <vector>
+
+#include "syscommon/Platform.h"
+#include "syscommon/concurrent/Lock.h"
+#include "syscommon/concurrent/Thread.h"
+#include "syscommon/net/EventLoop.h"
+
+#ifdef SYSCOMMON_HAS_COROUTINES
+#include <coroutine>
+#endif
+
+namespace syscommon
+{
+	class EventAwaitable;
+
+	/**
+	 * The coroutine counterpart of Event: a manual reset event that coroutines wait for with
+	 * co_await, suspending rather than blocking their loop's thread. It can be signalled from any
+	 * thread, including one that is not running a loop, so that a worker thread can hand a result
+	 * back to a coroutine.
+	 *
+	 * eg:
+	 *
+	 * co_await resultReady.waitAsync();
+	 *
+	 * Once signalled, the event stays signalled, and waitAsync() carries straight on, until it is
+	 * cleared. Each waiting coroutine is resumed on the loop it was waiting on.
+	 *
+	 * A coroutine must not be destroyed while it is waiting on an event, so an event should not
+	 * be left with waiters when their loops are deleted.
+	 */
+	class AsyncEvent
+	{
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			Lock lock;
+			volatile bool signalled;
+			std::vector<std::pair<EventLoop*,IRunnable*> > waiters;
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Creates an event in the given state
+			 */
+			AsyncEvent( bool initialState );
+			virtual ~AsyncEvent();
+
+		private:
+			// Not copyable
+			AsyncEvent( const AsyncEvent& );
+			AsyncEvent& operator=( const AsyncEvent& );
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Signals the event, resuming every coroutine waiting on it. May be called from any
+			 * thread.
+			 */
+			void signal();
+
+			/**
+			 * Returns the event to the unsignalled state
+			 */
+			void clear();
+
+			bool isSignalled() const;
+
+			/**
+			 * Returns the number of coroutines waiting on the event
+			 */
+			size_t getWaiterCount();
+
+#ifdef SYSCOMMON_HAS_COROUTINES
+			/**
+			 * Returns an awaitable that suspends the awaiting coroutine until the event is
+			 * signalled, or carries straight on if it already is
+			 *
+			 * @throws IllegalStateException if there is no loop running on the current thread
+			 */
+			EventAwaitable waitAsync() noexcept( false );
+#endif
+
+		private:
+			/**
+			 * Adds a waiter, to be posted to the given loop once the event is signalled
+			 *
+			 * @return false if the event is already signalled, in which case the waiter is not
+			 *         added
+			 */
+			bool addWaiter( EventLoop* loop, IRunnable* waiter );
+
+		//----------------------------------------------------------
+		//                     STATIC METHODS
+		//----------------------------------------------------------
+
+		friend class EventAwaitable;
+	};
+
+#ifdef SYSCOMMON_HAS_COROUTINES
+	/**
+	 * Returned by AsyncEvent::waitAsync()
+	 */
+	class EventAwaitable : public IRunnable
+	{
+		private:
+			AsyncEvent* event;
+			EventLoop* loop;
+			std::coroutine_handle<> handle;
+
+		public:
+			EventAwaitable( AsyncEvent* event, EventLoop* loop ) :
+				event( event ), loop( loop ), handle()
+			{
+			}
+
+			bool await_ready() noexcept
+			{
+				return this->event->isSignalled();
+			}
+
+			bool await_suspend( std::coroutine_handle<> handle )
+			{
+				// The event may have been signalled since await_ready(), in which case carry on
+				this->handle = handle;
+				return this->event->addWaiter( this->loop, this );
+			}
+
+			void await_resume() noexcept
+			{
+			}
+
+			virtual void run()
+			{
+				this->handle.resume();
+			}
+	};
+
+	inline EventAwaitable AsyncEvent::waitAsync() noexcept( false )
+	{
+		EventLoop* loop = EventLoop::current();
+		if( !loop )
+			throw IllegalStateException( TEXT("There is no event loop running on this thread") );
+
+		return EventAwaitable( this, loop );
+	}
+#endif
+}
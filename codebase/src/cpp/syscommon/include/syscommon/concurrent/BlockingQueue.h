@@ -0,0 +1,351 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <vector>
+
+#include "syscommon/Platform.h"
+#include "syscommon/Exception.h"
+#include "syscommon/concurrent/Lock.h"
+#include "syscommon/concurrent/Semaphore.h"
+
+namespace syscommon
+{
+	/**
+	 * A bounded, first-in-first-out queue that blocks producers while it is full and consumers
+	 * while it is empty. Elements are held by value in a fixed ring buffer that is allocated when
+	 * the queue is created, so putting and taking never allocate.
+	 *
+	 * eg:
+	 *
+	 * BlockingQueue<DatagramPacket*> received( 1024 );
+	 *
+	 * // Producer
+	 * received.put( packet );
+	 *
+	 * // Consumer, handling everything that has arrived for each wakeup
+	 * std::vector<DatagramPacket*> batch;
+	 * while( received.drainTo(batch, 64, NATIVE_INFINITE_WAIT) )
+	 * {
+	 *     ...
+	 *     batch.clear();
+	 * }
+	 *
+	 * Space and elements are counted by a pair of Semaphores, so a thread blocked in put(),
+	 * take(), a timed offer() or poll(), or a blocking drainTo() is woken by Thread::interrupt()
+	 * and throws an InterruptedException, leaving the queue unchanged. The ring buffer itself is
+	 * only locked for as long as it takes to copy the elements in or out.
+	 *
+	 * T must be default constructible and assignable. Taking an element assigns a default
+	 * constructed T over its slot, so that the queue does not keep anything alive that has left it.
+	 */
+	template<typename T>
+	class BlockingQueue
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			std::vector<T> elements;
+			size_t head;
+			size_t count;
+
+			Lock bufferLock;
+			Semaphore spaceAvailable;
+			Semaphore elementsAvailable;
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Creates an empty queue that can hold the given number of elements
+			 *
+			 * @param capacity the maximum number of elements the queue can hold
+			 *
+			 * @throws IllegalArgumentException if the capacity is zero
+			 */
+			BlockingQueue( size_t capacity ) noexcept( false ) :
+				elements( capacity ),
+				head( 0 ),
+				count( 0 ),
+				bufferLock( LP_ADAPTIVE ),
+				spaceAvailable( (unsigned int)capacity ),
+				elementsAvailable( 0 )
+			{
+				if( capacity == 0 )
+					throw IllegalArgumentException( TEXT("Queue capacity must be greater than zero") );
+			}
+
+			virtual ~BlockingQueue()
+			{
+
+			}
+
+		private:
+			// Not copyable
+			BlockingQueue( const BlockingQueue& );
+			BlockingQueue& operator=( const BlockingQueue& );
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Inserts the element at the tail of the queue, waiting for space to become available
+			 * if the queue is full.
+			 *
+			 * @throws InterruptedException if the thread was interrupted while waiting
+			 */
+			void put( const T& element ) noexcept( false )
+			{
+				this->spaceAvailable.acquire();
+				this->insert( element );
+			}
+
+			/**
+			 * Inserts the element at the tail of the queue if there is space for it, without
+			 * waiting.
+			 *
+			 * @return true if the element was added, false if the queue was full
+			 */
+			bool offer( const T& element )
+			{
+				if( !this->spaceAvailable.tryAcquire() )
+					return false;
+
+				this->insert( element );
+				return true;
+			}
+
+			/**
+			 * Inserts the element at the tail of the queue, waiting up to the given time for space
+			 * to become available if the queue is full.
+			 *
+			 * @param element the element to add
+			 * @param timeout the maximum time to wait, in milliseconds
+			 *
+			 * @return true if the element was added, false if the timeout elapsed first
+			 *
+			 * @throws InterruptedException if the thread was interrupted while waiting
+			 */
+			bool offer( const T& element, unsigned long timeout ) noexcept( false )
+			{
+				if( !this->spaceAvailable.tryAcquire(timeout) )
+					return false;
+
+				this->insert( element );
+				return true;
+			}
+
+			/**
+			 * Removes and returns the element at the head of the queue, waiting for one to become
+			 * available if the queue is empty.
+			 *
+			 * @throws InterruptedException if the thread was interrupted while waiting
+			 */
+			T take() noexcept( false )
+			{
+				this->elementsAvailable.acquire();
+
+				T element;
+				this->remove( &element, 1 );
+				return element;
+			}
+
+			/**
+			 * Removes the element at the head of the queue if there is one, without waiting.
+			 *
+			 * @param element receives the removed element
+			 *
+			 * @return true if an element was removed, false if the queue was empty
+			 */
+			bool poll( T& element )
+			{
+				if( !this->elementsAvailable.tryAcquire() )
+					return false;
+
+				this->remove( &element, 1 );
+				return true;
+			}
+
+			/**
+			 * Removes the element at the head of the queue, waiting up to the given time for one
+			 * to become available if the queue is empty.
+			 *
+			 * @param element receives the removed element
+			 * @param timeout the maximum time to wait, in milliseconds
+			 *
+			 * @return true if an element was removed, false if the timeout elapsed first
+			 *
+			 * @throws InterruptedException if the thread was interrupted while waiting
+			 */
+			bool poll( T& element, unsigned long timeout ) noexcept( false )
+			{
+				if( !this->elementsAvailable.tryAcquire(timeout) )
+					return false;
+
+				this->remove( &element, 1 );
+				return true;
+			}
+
+			/**
+			 * Removes up to maxElements elements from the head of the queue without waiting, and
+			 * appends them to the given batch in order. The elements are claimed with a single
+			 * acquisition of the queue's element permits and removed under a single acquisition
+			 * of its lock, and blocked producers are released together.
+			 *
+			 * @param batch the vector to append the removed elements to
+			 * @param maxElements the maximum number of elements to remove
+			 *
+			 * @return the number of elements removed, which is zero if the queue was empty
+			 */
+			size_t drainTo( std::vector<T>& batch, size_t maxElements )
+			{
+				size_t drained = this->claimElements( maxElements );
+
+				this->removeInto( batch, drained );
+				return drained;
+			}
+
+			/**
+			 * Waits up to the given time for the queue to hold at least one element, then removes
+			 * up to maxElements elements from its head and appends them to the given batch in
+			 * order. A consumer that drains a batch for each wakeup is woken far less often than
+			 * one that takes a single element at a time.
+			 *
+			 * @param batch the vector to append the removed elements to
+			 * @param maxElements the maximum number of elements to remove
+			 * @param timeout the maximum time to wait for the first element, in milliseconds
+			 *
+			 * @return the number of elements removed, which is zero if the timeout elapsed first
+			 *
+			 * @throws InterruptedException if the thread was interrupted while waiting
+			 */
+			size_t drainTo( std::vector<T>& batch,
+							size_t maxElements,
+							unsigned long timeout ) noexcept( false )
+			{
+				if( maxElements == 0 || !this->elementsAvailable.tryAcquire(timeout) )
+					return 0;
+
+				size_t drained = 1 + this->claimElements( maxElements - 1 );
+
+				this->removeInto( batch, drained );
+				return drained;
+			}
+
+			/**
+			 * Returns the number of elements in the queue
+			 */
+			size_t size()
+			{
+				LockGuard guard( this->bufferLock );
+				return this->count;
+			}
+
+			/**
+			 * Returns true if the queue holds no elements
+			 */
+			bool isEmpty()
+			{
+				return this->size() == 0;
+			}
+
+			/**
+			 * Returns the number of elements that can be added before the queue is full
+			 */
+			size_t remainingCapacity()
+			{
+				return this->getCapacity() - this->size();
+			}
+
+			/**
+			 * Returns the maximum number of elements the queue can hold
+			 */
+			size_t getCapacity() const
+			{
+				return this->elements.size();
+			}
+
+		private:
+			/**
+			 * Adds an element to the tail of the ring, for which a space permit has already been
+			 * acquired, and releases an element permit for it
+			 */
+			void insert( const T& element )
+			{
+				this->bufferLock.lock();
+				size_t tail = ( this->head + this->count ) % this->elements.size();
+				this->elements[tail] = element;
+				++this->count;
+				this->bufferLock.unlock();
+
+				this->elementsAvailable.release();
+			}
+
+			/**
+			 * Removes elements from the head of the ring, for which element permits have already
+			 * been acquired, and releases their space permits
+			 */
+			void remove( T* out, size_t number )
+			{
+				this->bufferLock.lock();
+				for( size_t i = 0 ; i < number ; ++i )
+				{
+					out[i] = this->elements[this->head];
+					this->elements[this->head] = T();
+					this->head = ( this->head + 1 ) % this->elements.size();
+				}
+				this->count -= number;
+				this->bufferLock.unlock();
+
+				this->spaceAvailable.release( (unsigned int)number );
+			}
+
+			/**
+			 * Acquires element permits for up to maxElements elements without waiting
+			 *
+			 * @return the number of permits acquired
+			 */
+			size_t claimElements( size_t maxElements )
+			{
+				// The queue never holds more elements than its capacity, which fits a permit count
+				if( maxElements > this->elements.size() )
+					maxElements = this->elements.size();
+
+				return this->elementsAvailable.drainPermits( (unsigned int)maxElements );
+			}
+
+			void removeInto( std::vector<T>& batch, size_t number )
+			{
+				if( number == 0 )
+					return;
+
+				size_t first = batch.size();
+				batch.resize( first + number );
+				this->remove( &batch[first], number );
+			}
+
+		//----------------------------------------------------------
+		//                     STATIC METHODS
+		//----------------------------------------------------------
+	};
+}
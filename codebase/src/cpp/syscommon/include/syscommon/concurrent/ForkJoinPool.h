@@ -0,0 +1,299 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development
+ * and Distribution License (the "License"). You may not use this file except in
+ * compliance with the License. You can obtain a copy of the license at
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License
+ * for the specific language governing permissions and limitations under the
+ * License.
+ *
+ * When distributing Covered Code, include this CDDL HEADER in each file and
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields
+ * enclosed by brackets "[]" replaced with your own identifying information:
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <atomic>
+#include <deque>
+#include <vector>
+
+#include "syscommon/Platform.h"
+#include "syscommon/Exception.h"
+#include "syscommon/concurrent/Event.h"
+#include "syscommon/concurrent/ForkJoinTask.h"
+#include "syscommon/concurrent/ForkJoinWorkerThread.h"
+#include "syscommon/concurrent/Lock.h"
+
+namespace syscommon
+{
+	/**
+	 * A work-stealing executor for divide-and-conquer work expressed as ForkJoinTasks.
+	 *
+	 * Each worker keeps the tasks it forks on its own lock-free deque, popping them back off in
+	 * LIFO order so that recently split (and cache-warm) work is processed first. Idle workers
+	 * steal from the opposite end of other workers' deques, which tends to take the largest
+	 * remaining pieces of work. Tasks submitted from outside the pool go on a shared submission
+	 * queue that workers poll when they have nothing else to do.
+	 *
+	 * For loops over an index range, parallelFor() takes care of the splitting:
+	 *
+	 * ForkJoinPool pool;
+	 * pool.parallelFor( 0, packetCount, 64, DecodeRange(packets) );
+	 *
+	 * where DecodeRange is a function object with an operator()( long begin, long end ).
+	 */
+	class ForkJoinPool
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+		private:
+			static unsigned long POOL_ID_COUNTER;
+
+			// Number of fruitless scans a worker makes, yielding in between, before it parks,
+			// whether it is idle or joining a task that another worker is running
+			static const int SPINS_BEFORE_PARK = 64;
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			std::vector<ForkJoinWorkerThread*> workers;
+			volatile bool shuttingDown;
+
+			// External submissions
+			Lock submissionLock;
+			std::deque<ForkJoinTask*> submissionQueue;
+			std::atomic<long> submissionCount;
+
+			// Parking for idle workers. The sequence number changes whenever work is published,
+			// so that a worker about to park can tell whether it has missed something. Workers
+			// parked in awaitJoin() count as idle too, as they can steal any new work.
+			std::atomic<unsigned long> workSequence;
+			std::atomic<unsigned int> idleCount;
+			Lock idleLock;
+			Event workEvent;
+
+			// Threads parked in awaitJoin() until a task is done, guarded by idleLock. Each
+			// parks on an Event of its own that only it clears, so a wakeup meant for one of
+			// them can never be consumed by another.
+			struct JoinWaiter
+			{
+				ForkJoinTask* task;
+				bool stealing;
+				Event* wakeup;
+			};
+
+			std::vector<JoinWaiter*> joinWaiters;
+			std::atomic<unsigned int> joinWaiterCount;
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Creates a pool with one worker per available processor
+			 */
+			ForkJoinPool();
+
+			/**
+			 * Creates a pool with the given number of workers
+			 *
+			 * @param parallelism the number of worker threads, must be greater than zero
+			 */
+			ForkJoinPool( unsigned int parallelism );
+
+			/**
+			 * Stops and joins all workers. Tasks that are still queued are not run.
+			 */
+			virtual ~ForkJoinPool();
+
+		private:
+			void _ForkJoinPool( unsigned int parallelism );
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Arranges for the task to be run asynchronously by the pool. The task must remain
+			 * valid until it has been joined.
+			 *
+			 * @param task the task to run
+			 */
+			void submit( ForkJoinTask* task );
+
+			/**
+			 * Runs the task in the pool and waits for it to finish. If called from one of this
+			 * pool's workers, the task is run directly on the calling worker.
+			 *
+			 * @param task the task to run
+			 *
+			 * @throws ExecutionException if the task threw an exception
+			 */
+			void invoke( ForkJoinTask* task ) noexcept( false );
+
+			/**
+			 * Calls function( rangeBegin, rangeEnd ) for consecutive sub-ranges of [begin, end)
+			 * that are at most grain elements long, running the calls in parallel across the pool's
+			 * workers. Returns once the whole range has been processed.
+			 *
+			 * @param begin the first index of the range
+			 * @param end one past the last index of the range
+			 * @param grain the largest sub-range handed to a single call, values below 1 are
+			 *              treated as 1
+			 * @param function a function object taking ( long begin, long end )
+			 *
+			 * @throws ExecutionException if any call to function threw an exception
+			 */
+			template<typename Function>
+			void parallelFor( long begin, long end, long grain, Function function ) noexcept( false );
+
+			/**
+			 * Returns the number of worker threads in this pool
+			 */
+			unsigned int getParallelism() const;
+
+			/**
+			 * Returns the total number of tasks stolen by this pool's workers
+			 */
+			unsigned long getStealCount() const;
+
+		private:
+			/**
+			 * Finds a task for the given worker: its own deque first, then the other workers'
+			 * deques, then the submission queue.
+			 *
+			 * @return the task to run, or NULL if no work could be found
+			 */
+			ForkJoinTask* scan( ForkJoinWorkerThread* worker );
+
+			ForkJoinTask* pollSubmission();
+
+			/**
+			 * Parks the worker until more work is published. Returns early with a task if one
+			 * turns up while the worker is preparing to park.
+			 */
+			ForkJoinTask* awaitWork( ForkJoinWorkerThread* worker );
+
+			/**
+			 * Wakes parked workers, if there are any, after work has been published
+			 */
+			void signalWork();
+
+			/**
+			 * Keeps the worker busy running other tasks until the given task is done, parking it
+			 * through awaitJoin() whenever it runs out of tasks to help with
+			 */
+			void helpJoin( ForkJoinWorkerThread* worker, ForkJoinTask* task );
+
+			/**
+			 * Blocks until the task is done. A thread that is not one of this pool's workers
+			 * passes a NULL worker. A worker is also woken when more work is published, and
+			 * returns early so that it can help with it.
+			 *
+			 * @return a task that the worker found while preparing to park, or NULL
+			 */
+			ForkJoinTask* awaitJoin( ForkJoinWorkerThread* worker, ForkJoinTask* task );
+
+			/**
+			 * Called after any task run by this pool has finished. The task may already have
+			 * been destroyed by the thread that joined it, so it is only compared, never used.
+			 */
+			void taskCompleted( const ForkJoinTask* task );
+
+			/**
+			 * Worker main loop, called from ForkJoinWorkerThread::run()
+			 */
+			void runWorker( ForkJoinWorkerThread* worker );
+
+		//----------------------------------------------------------
+		//                     STATIC METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Returns the pool that the current thread is a worker of, or NULL if the current thread
+			 * does not belong to a pool
+			 */
+			static ForkJoinPool* getCurrentPool();
+
+			/**
+			 * Returns true if the current thread is a ForkJoinPool worker
+			 */
+			static bool inForkJoinPool();
+
+		friend class ForkJoinTask;
+		friend class ForkJoinWorkerThread;
+	};
+
+	/**
+	 * Task used by ForkJoinPool::parallelFor() to recursively halve an index range
+	 */
+	template<typename Function>
+	class ParallelForTask : public ForkJoinTask
+	{
+		private:
+			long begin;
+			long end;
+			long grain;
+			Function& function;
+
+		public:
+			ParallelForTask( long begin, long end, long grain, Function& function ) :
+				begin( begin ), end( end ), grain( grain ), function( function )
+			{
+
+			}
+
+			virtual void run()
+			{
+				if( this->end - this->begin <= this->grain )
+				{
+					this->function( this->begin, this->end );
+				}
+				else
+				{
+					long middle = this->begin + (this->end - this->begin) / 2;
+					ParallelForTask<Function> left( this->begin, middle, this->grain, this->function );
+					ParallelForTask<Function> right( middle, this->end, this->grain, this->function );
+
+					left.fork();
+					try
+					{
+						right.invoke();
+					}
+					catch( ... )
+					{
+						// The forked half lives on this stack frame, so it must finish before we
+						// unwind. Its own failure (if any) is secondary to the one in flight.
+						try
+						{
+							left.join();
+						}
+						catch( ... )
+						{
+						}
+
+						throw;
+					}
+
+					left.join();
+				}
+			}
+	};
+
+	template<typename Function>
+	void ForkJoinPool::parallelFor( long begin, long end, long grain, Function function )
+	{
+		if( end <= begin )
+			return;
+
+		if( grain < 1 )
+			grain = 1;
+
+		ParallelForTask<Function> root( begin, end, grain, function );
+		this->invoke( &root );
+	}
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development
+ * and Distribution License (the "License"). You may not use this file except in
+ * compliance with the License. You can obtain a copy of the license at
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License
+ * for the specific language governing permissions and limitations under the
+ * License.
+ *
+ * When distributing Covered Code, include this CDDL HEADER in each file and
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields
+ * enclosed by brackets "[]" replaced with your own identifying information:
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <atomic>
+
+#include "syscommon/Platform.h"
+#include "syscommon/Exception.h"
+#include "syscommon/concurrent/Thread.h"
+
+namespace syscommon
+{
+	class ForkJoinPool;
+
+	/**
+	 * A task that runs within a ForkJoinPool. ForkJoinTask is an IRunnable, so the task's work is
+	 * placed in its run() method, which may in turn fork() subtasks and join() them.
+	 *
+	 * eg:
+	 *
+	 * class SumTask : public ForkJoinTask
+	 * {
+	 *     virtual void run()
+	 *     {
+	 *         if( end - begin <= THRESHOLD )
+	 *         {
+	 *             // sum directly
+	 *         }
+	 *         else
+	 *         {
+	 *             SumTask left( begin, middle );
+	 *             SumTask right( middle, end );
+	 *             left.fork();
+	 *             right.invoke();
+	 *             left.join();
+	 *             sum = left.sum + right.sum;
+	 *         }
+	 *     }
+	 * };
+	 *
+	 * A forked task is pushed onto the deque of the worker that forked it, where it is either
+	 * popped again by that worker (LIFO) or stolen by an idle worker (FIFO). A worker that joins a
+	 * task which has not finished yet runs other queued tasks while it waits rather than blocking.
+	 *
+	 * Tasks are one-shot. Forked tasks must remain valid until they have been joined, which makes it
+	 * safe to allocate subtasks on the stack of the parent's run() method.
+	 */
+	class ForkJoinTask : public IRunnable
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+		private:
+			enum TaskStatus { TS_PENDING, TS_COMPLETED, TS_FAILED };
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			std::atomic<int> status;
+			ForkJoinPool* pool;
+			String failure;
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			ForkJoinTask();
+			virtual ~ForkJoinTask();
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Arranges for this task to be run asynchronously in the pool the current thread is a
+			 * worker of. If the current thread is not a ForkJoinPool worker, there is nowhere to
+			 * queue the task, so it is run immediately on the calling thread instead.
+			 */
+			void fork();
+
+			/**
+			 * Returns once this task has finished running. If called from a pool worker, the worker
+			 * executes other queued tasks until this one is done.
+			 *
+			 * @throws ExecutionException if the task's run() method threw an exception
+			 */
+			void join() noexcept( false );
+
+			/**
+			 * Runs this task on the current thread and returns when it is done.
+			 *
+			 * @throws ExecutionException if the task's run() method threw an exception
+			 */
+			void invoke() noexcept( false );
+
+			/**
+			 * Returns true if this task has finished running, either normally or by throwing
+			 */
+			bool isDone() const;
+
+			/**
+			 * Returns true if this task finished by throwing an exception
+			 */
+			bool isCompletedAbnormally() const;
+
+		private:
+			/**
+			 * Runs the task, recording how it terminated and notifying the pool. The task may be
+			 * destroyed by a joining thread as soon as this method has recorded its status.
+			 */
+			void exec();
+
+			void reportFailure() noexcept( false );
+
+		//----------------------------------------------------------
+		//                     STATIC METHODS
+		//----------------------------------------------------------
+
+		friend class ForkJoinPool;
+	};
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development
+ * and Distribution License (the "License"). You may not use this file except in
+ * compliance with the License. You can obtain a copy of the license at
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License
+ * for the specific language governing permissions and limitations under the
+ * License.
+ *
+ * When distributing Covered Code, include this CDDL HEADER in each file and
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields
+ * enclosed by brackets "[]" replaced with your own identifying information:
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <atomic>
+
+#include "syscommon/Platform.h"
+#include "syscommon/concurrent/ForkJoinTask.h"
+#include "syscommon/concurrent/Thread.h"
+#include "syscommon/concurrent/WorkStealingDeque.h"
+
+namespace syscommon
+{
+	class ForkJoinPool;
+
+	/**
+	 * A Thread owned by a ForkJoinPool. Each worker owns a WorkStealingDeque that holds the tasks
+	 * it has forked.
+	 *
+	 * Because workers are ordinary Thread instances, Thread::currentThread() returns the worker
+	 * when called from inside a pool task, and ForkJoinWorkerThread::current() can be used to
+	 * tell whether the calling thread belongs to a pool.
+	 */
+	class ForkJoinWorkerThread : public Thread
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			ForkJoinPool* pool;
+			unsigned int poolIndex;
+			WorkStealingDeque<ForkJoinTask> workQueue;
+
+			unsigned int randomSeed;
+			std::atomic<unsigned long> stealCount;
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Creates a worker for the given pool
+			 *
+			 * @param pool the pool that owns this worker
+			 * @param poolIndex the index of this worker within the pool
+			 * @param name the name of the thread
+			 */
+			ForkJoinWorkerThread( ForkJoinPool* pool, unsigned int poolIndex, const tchar* name );
+			virtual ~ForkJoinWorkerThread();
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Returns the pool this worker belongs to
+			 */
+			ForkJoinPool* getPool() const;
+
+			/**
+			 * Returns the index of this worker within its pool
+			 */
+			unsigned int getPoolIndex() const;
+
+			/**
+			 * Returns the number of tasks this worker has stolen from other workers
+			 */
+			unsigned long getStealCount() const;
+
+			/**
+			 * Runs the pool's worker loop until the pool shuts down
+			 */
+			virtual void run();
+
+		private:
+			/**
+			 * Returns a pseudo-random number used to pick steal victims
+			 */
+			unsigned int nextRandom();
+
+		//----------------------------------------------------------
+		//                     STATIC METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Returns the ForkJoinWorkerThread that is currently executing, or NULL if the current
+			 * thread is not a pool worker
+			 */
+			static ForkJoinWorkerThread* current();
+
+		friend class ForkJoinPool;
+		friend class ForkJoinTask;
+	};
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include "syscommon/Platform.h"
+#include "syscommon/Exception.h"
+#include "syscommon/concurrent/Event.h"
+#include "syscommon/concurrent/Lock.h"
+#include "syscommon/concurrent/Thread.h"
+
+namespace syscommon
+{
+	class ThreadPoolExecutor;
+
+	/**
+	 * A Future represents the pending result of an IRunnable that has been submitted to a
+	 * ThreadPoolExecutor. Methods are provided to check if the task is complete, to wait for its
+	 * completion and to cancel it.
+	 *
+	 * Cancelling a task that is still queued removes it from the executor's work queue so that it
+	 * never runs. Cancelling a task that is already running will, if requested, interrupt the
+	 * worker thread through Thread::interrupt() so that any blocking operation the task is
+	 * performing throws an InterruptedException.
+	 *
+	 * Memory Management: Futures returned by ThreadPoolExecutor::submit() are owned by the caller
+	 * and should be deleted once they are no longer required. Deleting a Future whose task has
+	 * not yet run will cancel it, and deleting a Future whose task is running will block until the
+	 * task has finished. The IRunnable itself remains owned by the caller.
+	 */
+	class Future
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+		private:
+			enum FutureState { FS_PENDING, FS_RUNNING, FS_COMPLETED, FS_FAILED, FS_CANCELLED };
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			IRunnable* task;
+			ThreadPoolExecutor* executor;
+			bool detached;
+
+			volatile FutureState state;
+			Thread* runner;
+			String failure;
+
+			Lock stateLock;
+			Event doneEvent;
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		private:
+			/**
+			 * Futures are only created by a ThreadPoolExecutor
+			 *
+			 * @param task the unit of execution that this future represents
+			 * @param executor the executor the task has been submitted to
+			 * @param detached whether the executor owns (and will delete) this future once the
+			 *                 task has finished
+			 */
+			Future( IRunnable* task, ThreadPoolExecutor* executor, bool detached );
+
+		public:
+			/**
+			 * Cancels the task if it has not yet started, and waits for it to finish if it has.
+			 */
+			virtual ~Future();
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Attempts to cancel execution of this task. The attempt will fail if the task has
+			 * already completed or has already been cancelled. If the task has not started it will
+			 * never run. If the task is running and mayInterruptIfRunning is true, the worker
+			 * thread running the task is interrupted.
+			 *
+			 * @param mayInterruptIfRunning whether the thread executing this task should be
+			 *                              interrupted
+			 *
+			 * @return false if the task could not be cancelled, typically because it has already
+			 *         completed, otherwise true
+			 */
+			bool cancel( bool mayInterruptIfRunning );
+
+			/**
+			 * Returns true if this task was cancelled before it completed normally.
+			 */
+			bool isCancelled() const;
+
+			/**
+			 * Returns true if this task completed. Completion may be due to normal termination,
+			 * an exception, or cancellation.
+			 */
+			bool isDone() const;
+
+			/**
+			 * Waits indefinitely for the task to complete.
+			 *
+			 * @throws CancellationException if the task was cancelled
+			 * @throws ExecutionException if the task terminated by throwing an exception
+			 */
+			void get() noexcept( false );
+
+			/**
+			 * Waits at most the given number of milliseconds for the task to complete.
+			 *
+			 * @param timeout the maximum time, in milliseconds, to wait for the task
+			 *
+			 * @return true if the task completed within the timeout period, otherwise false
+			 *
+			 * @throws CancellationException if the task was cancelled
+			 * @throws ExecutionException if the task terminated by throwing an exception
+			 */
+			bool get( unsigned long timeout ) noexcept( false );
+
+		private:
+			/**
+			 * Moves the future from FS_PENDING to FS_RUNNING on behalf of the given worker.
+			 *
+			 * @return false if the future was cancelled before it could be started
+			 */
+			bool start( Thread* worker );
+
+			/**
+			 * Runs the task on the current thread, recording how it terminated. The future must
+			 * have been started first.
+			 */
+			void execute();
+
+			/**
+			 * Moves the future into a terminal state and releases any waiters
+			 */
+			void finish( FutureState finalState );
+
+		//----------------------------------------------------------
+		//                     STATIC METHODS
+		//----------------------------------------------------------
+
+		friend class ThreadPoolExecutor;
+	};
+}
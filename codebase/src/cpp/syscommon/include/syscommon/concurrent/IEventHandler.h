@@ -0,0 +1,52 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include "syscommon/Platform.h"
+
+namespace syscommon
+{
+	/**
+	 * Receives the events of one stage of a Pipeline. The handler is called on the stage's own
+	 * thread, with the events in sequence order, and is given each event's slot in place rather
+	 * than a copy.
+	 */
+	template<typename T>
+	class IEventHandler
+	{
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			virtual ~IEventHandler() {};
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Called for each event that this handler is responsible for. Changes made to the
+			 * event are visible to the stages that depend on this one.
+			 *
+			 * @param event the slot holding the event
+			 * @param sequence the event's position in the pipeline
+			 * @param endOfBatch true if this is the last event the handler will be given before
+			 *                   it has to wait for more, which makes it a good time to flush
+			 *                   anything that has been buffered
+			 */
+			virtual void onEvent( T& event, long long sequence, bool endOfBatch ) = 0;
+	};
+}
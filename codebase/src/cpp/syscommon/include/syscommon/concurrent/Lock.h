@@ -20,12 +20,23 @@
 namespace syscommon
 {
 	/**
-	 * This class represents a reentrant mutual exclusion Lock.
+	 * This class represents a mutual exclusion Lock.
 	 *
-	 * A ReentrantLock is owned by the thread last successfully locking, but not yet unlocking it. 
-	 * A thread invoking lock will return, successfully acquiring the lock, when the lock is not 
-	 * owned by another thread. The method will return immediately if the current thread already 
-	 * owns the lock.
+	 * A Lock is owned by the thread last successfully locking, but not yet unlocking it. A thread
+	 * invoking lock will return, successfully acquiring the lock, when the lock is not owned by
+	 * another thread.
+	 *
+	 * By default a Lock is reentrant: the method will return immediately if the current thread
+	 * already owns the lock. Locks that are never re-entered can be given a cheaper LockPolicy
+	 * when they are created, see the LockPolicy enumeration for the choices.
+	 *
+	 * Rather than pairing lock() and unlock() calls by hand, a LockGuard can be used to hold the
+	 * lock for the rest of the enclosing scope:
+	 *
+	 * {
+	 *     LockGuard guard( this->stateLock );
+	 *     ...
+	 * }
 	 */
 	class Lock
 	{
@@ -38,14 +49,30 @@ namespace syscommon
 		//----------------------------------------------------------
 		private:
 			NATIVE_CRITICALSECTION mutex;
+			LockPolicy policy;
 
 		//----------------------------------------------------------
 		//                      CONSTRUCTORS
 		//----------------------------------------------------------
 		public:
+			/**
+			 * Creates a reentrant (LP_RECURSIVE) lock
+			 */
 			Lock();
+
+			/**
+			 * Creates a lock with the given policy
+			 *
+			 * @param policy how the lock behaves under contention and whether it is reentrant
+			 */
+			Lock( LockPolicy policy );
 			virtual ~Lock();
 
+		private:
+			// Not copyable
+			Lock( const Lock& );
+			Lock& operator=( const Lock& );
+
 		//----------------------------------------------------------
 		//                    INSTANCE METHODS
 		//----------------------------------------------------------
@@ -63,8 +90,39 @@ namespace syscommon
 			 */
 			void unlock();
 
+			/**
+			 * Returns the policy this lock was created with
+			 */
+			LockPolicy getPolicy() const;
+
 		//----------------------------------------------------------
 		//                     STATIC METHODS
 		//----------------------------------------------------------
 	};
+
+	/**
+	 * Holds a Lock for as long as the guard is in scope. The lock is acquired when the guard is
+	 * created and released when it is destroyed, including when the scope is left by an exception.
+	 */
+	class LockGuard
+	{
+		private:
+			Lock& lock;
+
+		public:
+			LockGuard( Lock& lock ) : lock( lock )
+			{
+				this->lock.lock();
+			}
+
+			~LockGuard()
+			{
+				this->lock.unlock();
+			}
+
+		private:
+			// Not copyable
+			LockGuard( const LockGuard& );
+			LockGuard& operator=( const LockGuard& );
+	};
 }
@@ -0,0 +1,373 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <atomic>
+#include <vector>
+
+#include "syscommon/Platform.h"
+#include "syscommon/Exception.h"
+#include "syscommon/concurrent/WaitStrategy.h"
+
+namespace syscommon
+{
+	/**
+	 * A bounded, lock-free ring buffer for passing elements from any number of producer threads to
+	 * exactly one consumer thread. Use a SpscRingBuffer instead when there is only one producer,
+	 * as it does not need the atomic read-modify-write that producers here use to claim slots.
+	 *
+	 * Each slot carries a sequence number that says whether it is free for the producers' current
+	 * lap around the ring or holds an element for the consumer, after Vyukov's bounded MPMC queue.
+	 * Producers claim slots by moving the shared tail forward with a compare-and-swap, so a
+	 * producer that is descheduled part way through an offer() never stops the others from
+	 * claiming slots, although the consumer cannot see past a claimed slot until it has been
+	 * published. A batch offer() claims all of its slots with a single compare-and-swap.
+	 *
+	 * offer(), poll() and drainTo() never block. put() and take() wait according to the WaitPolicy
+	 * the buffer was created with.
+	 *
+	 * The capacity is rounded up to a power of two. Elements are copied in and out of
+	 * preallocated slots, so T must be default constructible and assignable, and a consumed
+	 * element stays in its slot until the slot is reused.
+	 */
+	template<typename T>
+	class MpscRingBuffer
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+		private:
+			struct Slot
+			{
+				std::atomic<size_t> sequence;
+				T element;
+			};
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			Slot* slots;
+			size_t capacity;
+			size_t mask;
+
+			WaitStrategy notEmpty;
+			WaitStrategy notFull;
+
+			// Claimed by the producers
+			char tailPadding[64];
+			std::atomic<size_t> tail;
+
+			// Written by the consumer only
+			char headPadding[64 - sizeof(std::atomic<size_t>)];
+			std::atomic<size_t> head;
+			char endPadding[64 - sizeof(std::atomic<size_t>)];
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Creates an empty ring buffer
+			 *
+			 * @param capacity the number of elements the buffer can hold, rounded up to a power of
+			 *                 two
+			 * @param policy how put() and take() wait for space or elements
+			 *
+			 * @throws IllegalArgumentException if the capacity is zero
+			 */
+			MpscRingBuffer( size_t capacity, WaitPolicy policy ) noexcept( false ) :
+				notEmpty( policy ),
+				notFull( policy ),
+				tail( 0 ),
+				head( 0 )
+			{
+				if( capacity == 0 )
+					throw IllegalArgumentException( TEXT("Ring buffer capacity must be greater than zero") );
+
+				this->capacity = 1;
+				while( this->capacity < capacity )
+					this->capacity <<= 1;
+
+				this->mask = this->capacity - 1;
+				this->slots = new Slot[this->capacity];
+				for( size_t i = 0 ; i < this->capacity ; ++i )
+					this->slots[i].sequence.store( i, std::memory_order_relaxed );
+			}
+
+			virtual ~MpscRingBuffer()
+			{
+				delete [] this->slots;
+			}
+
+		private:
+			// Not copyable
+			MpscRingBuffer( const MpscRingBuffer& );
+			MpscRingBuffer& operator=( const MpscRingBuffer& );
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Publishes the element if there is space for it, without waiting. May be called by
+			 * any number of producers concurrently.
+			 *
+			 * @return true if the element was published, false if the buffer was full
+			 */
+			bool offer( const T& element )
+			{
+				size_t t = this->tail.load( std::memory_order_relaxed );
+				while( true )
+				{
+					Slot& slot = this->slots[t & this->mask];
+					size_t sequence = slot.sequence.load( std::memory_order_acquire );
+					if( sequence == t )
+					{
+						// Free for this lap, try to claim it
+						if( this->tail.compare_exchange_weak(t,
+						                                     t + 1,
+						                                     std::memory_order_relaxed,
+						                                     std::memory_order_relaxed) )
+						{
+							slot.element = element;
+							slot.sequence.store( t + 1, std::memory_order_release );
+							this->notEmpty.signal();
+							return true;
+						}
+					}
+					else if( (long)(sequence - t) < 0 )
+					{
+						// Still holds the element from the previous lap
+						return false;
+					}
+					else
+					{
+						// Another producer claimed it first
+						t = this->tail.load( std::memory_order_relaxed );
+					}
+				}
+			}
+
+			/**
+			 * Publishes as many of the given elements as there is space for, in order, without
+			 * waiting. The elements occupy consecutive slots, so no other producer's elements are
+			 * interleaved with them. May be called by any number of producers concurrently.
+			 *
+			 * @param elements the elements to publish
+			 * @param count the number of elements
+			 *
+			 * @return the number of elements published, starting from the first
+			 */
+			size_t offer( const T* elements, size_t count )
+			{
+				size_t t = this->tail.load( std::memory_order_relaxed );
+				size_t published = 0;
+				while( true )
+				{
+					// The consumer frees slots in order, so every slot below head + capacity is
+					// free for this lap
+					size_t h = this->head.load( std::memory_order_acquire );
+					if( (long)(t - h) < 0 )
+					{
+						// Our view of the tail is older than the head we just read
+						t = this->tail.load( std::memory_order_relaxed );
+						continue;
+					}
+
+					size_t available = this->capacity - ( t - h );
+					published = count < available ? count : available;
+					if( published == 0 )
+						return 0;
+
+					if( this->tail.compare_exchange_weak(t,
+					                                     t + published,
+					                                     std::memory_order_relaxed,
+					                                     std::memory_order_relaxed) )
+					{
+						break;
+					}
+				}
+
+				for( size_t i = 0 ; i < published ; ++i )
+				{
+					Slot& slot = this->slots[(t + i) & this->mask];
+					slot.element = elements[i];
+					slot.sequence.store( t + i + 1, std::memory_order_release );
+				}
+
+				this->notEmpty.signal();
+				return published;
+			}
+
+			/**
+			 * Publishes the element, waiting for space if the buffer is full. May be called by any
+			 * number of producers concurrently.
+			 */
+			void put( const T& element )
+			{
+				if( this->offer(element) )
+					return;
+
+				WaitStrategy::Waiter waiter( this->notFull );
+				while( !this->offer(element) )
+					waiter.idle();
+			}
+
+			/**
+			 * Publishes all of the given elements in order, waiting for space as often as
+			 * required. If the buffer fills up part way through, the remaining elements may be
+			 * interleaved with those of other producers.
+			 */
+			void put( const T* elements, size_t count )
+			{
+				size_t published = this->offer( elements, count );
+				if( published == count )
+					return;
+
+				WaitStrategy::Waiter waiter( this->notFull );
+				while( published < count )
+				{
+					size_t more = this->offer( elements + published, count - published );
+					if( more == 0 )
+						waiter.idle();
+
+					published += more;
+				}
+			}
+
+			/**
+			 * Consumes the next element if it has been published, without waiting. Must only be
+			 * called by the consumer.
+			 *
+			 * @param element receives the consumed element
+			 *
+			 * @return true if an element was consumed, false if the next slot has not been
+			 *         published yet
+			 */
+			bool poll( T& element )
+			{
+				size_t h = this->head.load( std::memory_order_relaxed );
+				Slot& slot = this->slots[h & this->mask];
+				if( slot.sequence.load(std::memory_order_acquire) != h + 1 )
+					return false;
+
+				element = slot.element;
+				slot.sequence.store( h + this->capacity, std::memory_order_release );
+				this->head.store( h + 1, std::memory_order_release );
+				this->notFull.signal();
+				return true;
+			}
+
+			/**
+			 * Consumes up to maxElements published elements without waiting, and appends them to
+			 * the given batch in order. Must only be called by the consumer.
+			 *
+			 * @return the number of elements consumed, which is zero if the next slot has not been
+			 *         published yet
+			 */
+			size_t drainTo( std::vector<T>& batch, size_t maxElements )
+			{
+				size_t h = this->head.load( std::memory_order_relaxed );
+				size_t consumed = 0;
+				for( ; consumed < maxElements ; ++consumed )
+				{
+					Slot& slot = this->slots[(h + consumed) & this->mask];
+					if( slot.sequence.load(std::memory_order_acquire) != h + consumed + 1 )
+						break;
+
+					batch.push_back( slot.element );
+					slot.sequence.store( h + consumed + this->capacity, std::memory_order_release );
+				}
+
+				if( consumed > 0 )
+				{
+					this->head.store( h + consumed, std::memory_order_release );
+					this->notFull.signal();
+				}
+
+				return consumed;
+			}
+
+			/**
+			 * Consumes the next element, waiting for one to be published if there is none. Must
+			 * only be called by the consumer.
+			 */
+			T take()
+			{
+				T element;
+				if( this->poll(element) )
+					return element;
+
+				WaitStrategy::Waiter waiter( this->notEmpty );
+				while( !this->poll(element) )
+					waiter.idle();
+
+				return element;
+			}
+
+			/**
+			 * Waits for at least one element to be published, then consumes up to maxElements
+			 * elements and appends them to the given batch in order. Must only be called by the
+			 * consumer.
+			 *
+			 * @return the number of elements consumed, which is zero only if maxElements is zero
+			 */
+			size_t take( std::vector<T>& batch, size_t maxElements )
+			{
+				size_t consumed = this->drainTo( batch, maxElements );
+				if( consumed > 0 || maxElements == 0 )
+					return consumed;
+
+				WaitStrategy::Waiter waiter( this->notEmpty );
+				while( (consumed = this->drainTo(batch, maxElements)) == 0 )
+					waiter.idle();
+
+				return consumed;
+			}
+
+			/**
+			 * Returns an estimate of the number of elements in the buffer, including those that
+			 * have been claimed by a producer but not yet published
+			 */
+			size_t size() const
+			{
+				size_t h = this->head.load( std::memory_order_acquire );
+				size_t t = this->tail.load( std::memory_order_acquire );
+				return t > h ? t - h : 0;
+			}
+
+			/**
+			 * Returns true if the buffer appeared empty at the time of the call
+			 */
+			bool isEmpty() const
+			{
+				return this->size() == 0;
+			}
+
+			/**
+			 * Returns the number of elements the buffer can hold
+			 */
+			size_t getCapacity() const
+			{
+				return this->capacity;
+			}
+
+		//----------------------------------------------------------
+		//                     STATIC METHODS
+		//----------------------------------------------------------
+	};
+}
@@ -0,0 +1,624 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <atomic>
+#include <vector>
+
+#include "syscommon/Platform.h"
+#include "syscommon/Exception.h"
+#include "syscommon/concurrent/IEventHandler.h"
+#include "syscommon/concurrent/Sequence.h"
+#include "syscommon/concurrent/Thread.h"
+#include "syscommon/concurrent/WaitStrategy.h"
+#include "syscommon/util/StringUtils.h"
+
+namespace syscommon
+{
+	/**
+	 * A multi-stage processing pipeline over a preallocated ring of slots, in the style of the
+	 * LMAX Disruptor. A single producer claims slots, fills them in place and publishes them, and
+	 * each stage's handlers then process the published slots in order on threads of their own.
+	 * Nothing is allocated and no locks are taken once the pipeline has started: every thread
+	 * only advances its own Sequence, and waits for the Sequences of the stages it depends on.
+	 *
+	 * eg:
+	 *
+	 * struct PacketSlot
+	 * {
+	 *     char data[1500];
+	 *     DatagramPacket packet;
+	 *     PacketSlot() : packet( data, sizeof(data) ) {}
+	 * };
+	 *
+	 * Pipeline<PacketSlot> pipeline( 4096, WP_YIELD );
+	 * size_t decode = pipeline.addStage( TEXT("decode"), &decoder );
+	 * pipeline.addStage( TEXT("journal"), &journaller, decode );
+	 * pipeline.addStage( TEXT("handle"), handlers, std::vector<size_t>(1, decode) );
+	 * pipeline.start();
+	 *
+	 * // Receive thread
+	 * while( running )
+	 * {
+	 *     long long sequence = pipeline.next();
+	 *     socket.receive( pipeline.get(sequence).packet );
+	 *     pipeline.publish( sequence );
+	 * }
+	 *
+	 * A stage with no dependencies processes slots as soon as they are published. Several stages
+	 * that depend on the same stage see every slot in parallel (fan-out), and a stage that depends
+	 * on several stages waits for all of them (fan-in). A stage given several handlers shares its
+	 * slots between them, each handler taking every n'th slot, so that an expensive stage can use
+	 * more than one thread; slots that belong to other handlers are skipped without being touched.
+	 *
+	 * The producer only reuses a slot once every stage that no other stage depends on has
+	 * processed it. Handlers that throw are counted in the stage's statistics and the pipeline
+	 * carries on with the next slot.
+	 *
+	 * The slots are default constructed when the pipeline is created and are never destroyed
+	 * until the pipeline is, so a slot can own buffers that are reused for every event that
+	 * passes through it.
+	 */
+	template<typename T>
+	class Pipeline
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+		public:
+			/**
+			 * A snapshot of one stage's progress, see getStatistics()
+			 */
+			struct StageStatistics
+			{
+				String name;
+				size_t handlerCount;
+
+				// The last slot that every handler in the stage has finished with
+				long long sequence;
+
+				// How many published slots the stage has yet to process. A stage whose lag keeps
+				// growing while the stages it depends on keep up is the bottleneck.
+				long long lag;
+
+				unsigned long long processed;
+				unsigned long long batches;
+				unsigned long long failures;
+
+				// Slots processed per second since the pipeline was started
+				double throughput;
+			};
+
+		private:
+			/**
+			 * Runs one handler of a stage on its own thread
+			 */
+			class Processor : public IRunnable
+			{
+				public:
+					Pipeline<T>* pipeline;
+					IEventHandler<T>* handler;
+					size_t ordinal;
+					size_t handlerCount;
+					std::vector<Sequence*> dependencies;
+					bool gating;
+
+					Sequence sequence;
+
+					// Only written by the processor's own thread
+					std::atomic<unsigned long long> processed;
+					std::atomic<unsigned long long> batches;
+					std::atomic<unsigned long long> failures;
+
+				public:
+					Processor( Pipeline<T>* pipeline,
+					           IEventHandler<T>* handler,
+					           size_t ordinal,
+					           size_t handlerCount ) :
+						processed( 0 ),
+						batches( 0 ),
+						failures( 0 )
+					{
+						this->pipeline = pipeline;
+						this->handler = handler;
+						this->ordinal = ordinal;
+						this->handlerCount = handlerCount;
+						this->gating = false;
+					}
+
+					virtual void run()
+					{
+						long long next = this->sequence.get() + 1;
+						while( true )
+						{
+							long long available = this->pipeline->waitFor( next, this->dependencies );
+							if( available < next )
+								break;
+
+							// The last slot in the batch that belongs to this handler
+							long long last = available;
+							if( this->handlerCount > 1 )
+							{
+								long long count = (long long)this->handlerCount;
+								last -= ( available % count - (long long)this->ordinal + count ) % count;
+							}
+
+							unsigned long long handled = 0;
+							unsigned long long failed = 0;
+							for( long long sequence = next ; sequence <= available ; ++sequence )
+							{
+								if( this->handlerCount > 1 &&
+								    (size_t)(sequence % (long long)this->handlerCount) != this->ordinal )
+								{
+									continue;
+								}
+
+								try
+								{
+									this->handler->onEvent( this->pipeline->get(sequence),
+									                        sequence,
+									                        sequence == last );
+								}
+								catch( ... )
+								{
+									++failed;
+								}
+
+								++handled;
+							}
+
+							this->processed.store( this->processed.load(std::memory_order_relaxed) + handled,
+							                       std::memory_order_relaxed );
+							this->batches.store( this->batches.load(std::memory_order_relaxed) + 1,
+							                     std::memory_order_relaxed );
+							if( failed > 0 )
+							{
+								this->failures.store( this->failures.load(std::memory_order_relaxed) + failed,
+								                      std::memory_order_relaxed );
+							}
+
+							this->sequence.set( available );
+							this->pipeline->advanced.signal();
+							if( this->gating )
+								this->pipeline->released.signal();
+
+							next = available + 1;
+						}
+					}
+			};
+
+			struct Stage
+			{
+				String name;
+				std::vector<size_t> dependencies;
+				std::vector<Processor*> processors;
+			};
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			T* slots;
+			size_t capacity;
+			size_t mask;
+
+			std::vector<Stage*> stages;
+			std::vector<Thread*> threads;
+			std::vector<Sequence*> gatingSequences;
+
+			// Signaled when the cursor or any processor moves on, and when the pipeline halts
+			WaitStrategy advanced;
+
+			// Signaled when a stage that gates the producer moves on
+			WaitStrategy released;
+
+			Sequence cursor;
+			std::atomic<bool> halted;
+			bool started;
+			long long startNanos;
+
+			// Only touched by the producer
+			long long claimed;
+			long long cachedGating;
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Creates a pipeline with no stages
+			 *
+			 * @param capacity the number of slots in the ring, rounded up to a power of two
+			 * @param policy how the stages wait for slots and the producer waits for space
+			 *
+			 * @throws IllegalArgumentException if the capacity is zero
+			 */
+			Pipeline( size_t capacity, WaitPolicy policy ) noexcept( false ) :
+				advanced( policy ),
+				released( policy ),
+				halted( false )
+			{
+				if( capacity == 0 )
+					throw IllegalArgumentException( TEXT("Pipeline capacity must be greater than zero") );
+
+				this->capacity = 1;
+				while( this->capacity < capacity )
+					this->capacity <<= 1;
+
+				this->mask = this->capacity - 1;
+				this->slots = new T[this->capacity];
+				this->started = false;
+				this->startNanos = 0;
+				this->claimed = Sequence::INITIAL_VALUE;
+				this->cachedGating = Sequence::INITIAL_VALUE;
+			}
+
+			/**
+			 * Stops the pipeline, waiting for every published slot to be processed
+			 */
+			virtual ~Pipeline()
+			{
+				this->stop();
+
+				for( size_t i = 0 ; i < this->threads.size() ; ++i )
+					delete this->threads[i];
+
+				for( size_t i = 0 ; i < this->stages.size() ; ++i )
+				{
+					Stage* stage = this->stages[i];
+					for( size_t j = 0 ; j < stage->processors.size() ; ++j )
+						delete stage->processors[j];
+
+					delete stage;
+				}
+
+				delete [] this->slots;
+			}
+
+		private:
+			// Not copyable
+			Pipeline( const Pipeline& );
+			Pipeline& operator=( const Pipeline& );
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Adds a stage that processes slots as soon as the producer publishes them
+			 *
+			 * @return the index of the new stage, for use as a dependency of later stages
+			 *
+			 * @throws IllegalStateException if the pipeline has been started
+			 */
+			size_t addStage( const String& name, IEventHandler<T>* handler ) noexcept( false )
+			{
+				return this->addStage( name,
+				                       std::vector<IEventHandler<T>*>(1, handler),
+				                       std::vector<size_t>() );
+			}
+
+			/**
+			 * Adds a stage that processes each slot once the given stage has processed it
+			 *
+			 * @return the index of the new stage, for use as a dependency of later stages
+			 *
+			 * @throws IllegalArgumentException if there is no stage with the given index
+			 * @throws IllegalStateException if the pipeline has been started
+			 */
+			size_t addStage( const String& name,
+			                 IEventHandler<T>* handler,
+			                 size_t after ) noexcept( false )
+			{
+				return this->addStage( name,
+				                       std::vector<IEventHandler<T>*>(1, handler),
+				                       std::vector<size_t>(1, after) );
+			}
+
+			/**
+			 * Adds a stage whose slots are shared between the given handlers, each running on its
+			 * own thread, and which processes each slot once all of the given stages have
+			 * processed it.
+			 *
+			 * @param name the name of the stage, also used to name its threads
+			 * @param handlers the handlers to share the slots between
+			 * @param after the indices of the stages that must process a slot first, or an empty
+			 *              vector to process slots as soon as they are published
+			 *
+			 * @return the index of the new stage, for use as a dependency of later stages
+			 *
+			 * @throws IllegalArgumentException if there are no handlers, or a dependency does not
+			 *                                  name an earlier stage
+			 * @throws IllegalStateException if the pipeline has been started
+			 */
+			size_t addStage( const String& name,
+			                 const std::vector<IEventHandler<T>*>& handlers,
+			                 const std::vector<size_t>& after ) noexcept( false )
+			{
+				if( this->started )
+					throw IllegalStateException( TEXT("Stages cannot be added once the pipeline has started") );
+
+				if( handlers.empty() )
+					throw IllegalArgumentException( TEXT("A stage needs at least one handler") );
+
+				std::vector<Sequence*> dependencies;
+				for( size_t i = 0 ; i < after.size() ; ++i )
+				{
+					if( after[i] >= this->stages.size() )
+						throw IllegalArgumentException( TEXT("Stage dependency does not name an existing stage") );
+
+					std::vector<Processor*>& upstream = this->stages[after[i]]->processors;
+					for( size_t j = 0 ; j < upstream.size() ; ++j )
+						dependencies.push_back( &upstream[j]->sequence );
+				}
+
+				if( dependencies.empty() )
+					dependencies.push_back( &this->cursor );
+
+				Stage* stage = new Stage();
+				stage->name = name;
+				stage->dependencies = after;
+				for( size_t i = 0 ; i < handlers.size() ; ++i )
+				{
+					Processor* processor = new Processor( this, handlers[i], i, handlers.size() );
+					processor->dependencies = dependencies;
+					stage->processors.push_back( processor );
+				}
+
+				this->stages.push_back( stage );
+				return this->stages.size() - 1;
+			}
+
+			/**
+			 * Starts a thread for every handler of every stage. The producer may claim slots once
+			 * this method returns.
+			 *
+			 * @throws IllegalStateException if the pipeline has already been started, or has no
+			 *                               stages
+			 */
+			void start() noexcept( false )
+			{
+				if( this->started )
+					throw IllegalStateException( TEXT("Pipeline has already been started") );
+
+				if( this->stages.empty() )
+					throw IllegalStateException( TEXT("Pipeline has no stages") );
+
+				// The producer is held back by the stages that nothing else waits for, as every
+				// other stage is necessarily ahead of them
+				std::vector<bool> depended( this->stages.size(), false );
+				for( size_t i = 0 ; i < this->stages.size() ; ++i )
+				{
+					for( size_t j = 0 ; j < this->stages[i]->dependencies.size() ; ++j )
+						depended[this->stages[i]->dependencies[j]] = true;
+				}
+
+				for( size_t i = 0 ; i < this->stages.size() ; ++i )
+				{
+					std::vector<Processor*>& processors = this->stages[i]->processors;
+					for( size_t j = 0 ; j < processors.size() ; ++j )
+					{
+						processors[j]->gating = !depended[i];
+						if( processors[j]->gating )
+							this->gatingSequences.push_back( &processors[j]->sequence );
+					}
+				}
+
+				this->started = true;
+				this->startNanos = Platform::nanoTime();
+
+				for( size_t i = 0 ; i < this->stages.size() ; ++i )
+				{
+					Stage* stage = this->stages[i];
+					for( size_t j = 0 ; j < stage->processors.size() ; ++j )
+					{
+						String threadName = stage->name;
+						if( stage->processors.size() > 1 )
+						{
+							threadName.append( TEXT("-") );
+							threadName.append( StringUtils::longToString((long)j) );
+						}
+
+						Thread* thread = new Thread( stage->processors[j], threadName.c_str() );
+						this->threads.push_back( thread );
+						thread->start();
+					}
+				}
+			}
+
+			/**
+			 * Waits for every published slot to be processed by every stage, then stops the
+			 * stage threads. Does nothing if the pipeline is not running.
+			 */
+			void stop()
+			{
+				if( !this->started || this->halted.load(std::memory_order_acquire) )
+					return;
+
+				WaitStrategy::Waiter waiter( this->released );
+				while( Sequence::minimum(this->gatingSequences, this->claimed) < this->cursor.get() )
+					waiter.idle();
+
+				this->halted.store( true, std::memory_order_release );
+				this->advanced.signal();
+
+				for( size_t i = 0 ; i < this->threads.size() ; ++i )
+					this->threads[i]->join();
+			}
+
+			/**
+			 * Claims the next slot for the producer, waiting until the slot has been processed by
+			 * every stage if the ring is full. Must only be called by the producer.
+			 *
+			 * @return the sequence of the claimed slot, to be passed to get() and publish()
+			 *
+			 * @throws IllegalStateException if the pipeline is not running
+			 */
+			long long next() noexcept( false )
+			{
+				return this->next( 1 );
+			}
+
+			/**
+			 * Claims the next count slots for the producer, waiting for them to be processed by
+			 * every stage if the ring is full. Must only be called by the producer.
+			 *
+			 * @return the sequence of the last claimed slot. The first is count - 1 before it.
+			 *
+			 * @throws IllegalArgumentException if count is zero or larger than the capacity
+			 * @throws IllegalStateException if the pipeline is not running
+			 */
+			long long next( size_t count ) noexcept( false )
+			{
+				if( count == 0 || count > this->capacity )
+					throw IllegalArgumentException( TEXT("Claim must be between one slot and the pipeline capacity") );
+
+				if( !this->started || this->halted.load(std::memory_order_relaxed) )
+					throw IllegalStateException( TEXT("Pipeline is not running") );
+
+				long long nextValue = this->claimed + (long long)count;
+				long long wrapPoint = nextValue - (long long)this->capacity;
+				if( wrapPoint > this->cachedGating )
+				{
+					WaitStrategy::Waiter waiter( this->released );
+					while( (this->cachedGating = Sequence::minimum(this->gatingSequences, nextValue)) < wrapPoint )
+						waiter.idle();
+				}
+
+				this->claimed = nextValue;
+				return nextValue;
+			}
+
+			/**
+			 * Makes every slot up to and including the given sequence visible to the stages. Must
+			 * only be called by the producer, with the sequence returned by the last call to
+			 * next().
+			 */
+			void publish( long long sequence )
+			{
+				this->cursor.set( sequence );
+				this->advanced.signal();
+			}
+
+			/**
+			 * Returns the slot for the given sequence
+			 */
+			T& get( long long sequence )
+			{
+				return this->slots[(size_t)sequence & this->mask];
+			}
+
+			/**
+			 * Returns the sequence of the last published slot
+			 */
+			long long getCursor() const
+			{
+				return this->cursor.get();
+			}
+
+			/**
+			 * Returns the number of slots in the ring
+			 */
+			size_t getCapacity() const
+			{
+				return this->capacity;
+			}
+
+			/**
+			 * Returns the number of stages that have been added
+			 */
+			size_t getStageCount() const
+			{
+				return this->stages.size();
+			}
+
+			/**
+			 * Returns a snapshot of the progress of every stage, in the order the stages were
+			 * added. May be called from any thread while the pipeline is running.
+			 */
+			std::vector<StageStatistics> getStatistics() const
+			{
+				long long cursorValue = this->cursor.get();
+				double elapsedSeconds = 0.0;
+				if( this->started )
+					elapsedSeconds = ( Platform::nanoTime() - this->startNanos ) / 1000000000.0;
+
+				std::vector<StageStatistics> result;
+				for( size_t i = 0 ; i < this->stages.size() ; ++i )
+				{
+					const Stage* stage = this->stages[i];
+
+					StageStatistics statistics;
+					statistics.name = stage->name;
+					statistics.handlerCount = stage->processors.size();
+					statistics.sequence = cursorValue;
+					statistics.processed = 0;
+					statistics.batches = 0;
+					statistics.failures = 0;
+
+					for( size_t j = 0 ; j < stage->processors.size() ; ++j )
+					{
+						const Processor* processor = stage->processors[j];
+						long long sequence = processor->sequence.get();
+						if( sequence < statistics.sequence )
+							statistics.sequence = sequence;
+
+						statistics.processed += processor->processed.load( std::memory_order_relaxed );
+						statistics.batches += processor->batches.load( std::memory_order_relaxed );
+						statistics.failures += processor->failures.load( std::memory_order_relaxed );
+					}
+
+					statistics.lag = cursorValue - statistics.sequence;
+					statistics.throughput = 0.0;
+					if( elapsedSeconds > 0.0 )
+						statistics.throughput = statistics.processed / elapsedSeconds;
+
+					result.push_back( statistics );
+				}
+
+				return result;
+			}
+
+		private:
+			/**
+			 * Waits until every one of the given sequences has reached the given value, or the
+			 * pipeline halts.
+			 *
+			 * @return the smallest of the sequences, which is below the value if the pipeline has
+			 *         halted
+			 */
+			long long waitFor( long long value, const std::vector<Sequence*>& dependencies )
+			{
+				long long available = Sequence::minimum( dependencies, value );
+				if( available >= value )
+					return available;
+
+				WaitStrategy::Waiter waiter( this->advanced );
+				while( true )
+				{
+					available = Sequence::minimum( dependencies, value );
+					if( available >= value || this->halted.load(std::memory_order_acquire) )
+						return available;
+
+					waiter.idle();
+				}
+			}
+
+		//----------------------------------------------------------
+		//                     STATIC METHODS
+		//----------------------------------------------------------
+	};
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include "syscommon/Platform.h"
+
+namespace syscommon
+{
+	/**
+	 * A lock that can be held by any number of readers at once, or by a single writer. This suits
+	 * state that is read far more often than it is changed, as readers do not serialize behind
+	 * one another the way they would with a Lock.
+	 *
+	 * The lock prefers writers: once a writer is waiting, new readers wait behind it, so that a
+	 * steady stream of readers cannot keep a writer out indefinitely. A consequence of this is
+	 * that the lock is not reentrant for either readers or writers. A thread that takes a read
+	 * lock it already holds can deadlock against a waiting writer.
+	 *
+	 * ReadLockGuard and WriteLockGuard hold the lock for the rest of the enclosing scope:
+	 *
+	 * {
+	 *     ReadLockGuard guard( this->routesLock );
+	 *     ...
+	 * }
+	 */
+	class ReadWriteLock
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			NATIVE_RWLOCK nativeLock;
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			ReadWriteLock();
+			virtual ~ReadWriteLock();
+
+		private:
+			// Not copyable
+			ReadWriteLock( const ReadWriteLock& );
+			ReadWriteLock& operator=( const ReadWriteLock& );
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Acquires the lock for reading, blocking while a writer holds the lock or is waiting
+			 * for it
+			 */
+			void readLock();
+
+			/**
+			 * Acquires the lock for reading if that can be done within the given time
+			 *
+			 * @param timeoutMillis the maximum time to wait, zero to return immediately
+			 *
+			 * @return true if the read lock was acquired
+			 */
+			bool tryReadLock( unsigned long timeoutMillis );
+
+			/**
+			 * Releases a read lock held by the current thread
+			 */
+			void readUnlock();
+
+			/**
+			 * Acquires the lock for writing, blocking until no other thread holds it
+			 */
+			void writeLock();
+
+			/**
+			 * Acquires the lock for writing if that can be done within the given time
+			 *
+			 * @param timeoutMillis the maximum time to wait, zero to return immediately
+			 *
+			 * @return true if the write lock was acquired
+			 */
+			bool tryWriteLock( unsigned long timeoutMillis );
+
+			/**
+			 * Releases the write lock held by the current thread
+			 */
+			void writeUnlock();
+
+		//----------------------------------------------------------
+		//                     STATIC METHODS
+		//----------------------------------------------------------
+	};
+
+	/**
+	 * Holds a ReadWriteLock for reading for as long as the guard is in scope
+	 */
+	class ReadLockGuard
+	{
+		private:
+			ReadWriteLock& lock;
+
+		public:
+			ReadLockGuard( ReadWriteLock& lock ) : lock( lock )
+			{
+				this->lock.readLock();
+			}
+
+			~ReadLockGuard()
+			{
+				this->lock.readUnlock();
+			}
+
+		private:
+			// Not copyable
+			ReadLockGuard( const ReadLockGuard& );
+			ReadLockGuard& operator=( const ReadLockGuard& );
+	};
+
+	/**
+	 * Holds a ReadWriteLock for writing for as long as the guard is in scope
+	 */
+	class WriteLockGuard
+	{
+		private:
+			ReadWriteLock& lock;
+
+		public:
+			WriteLockGuard( ReadWriteLock& lock ) : lock( lock )
+			{
+				this->lock.writeLock();
+			}
+
+			~WriteLockGuard()
+			{
+				this->lock.writeUnlock();
+			}
+
+		private:
+			// Not copyable
+			WriteLockGuard( const WriteLockGuard& );
+			WriteLockGuard& operator=( const WriteLockGuard& );
+	};
+}
@@ -0,0 +1,337 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <list>
+#include <vector>
+
+#include "syscommon/Platform.h"
+#include "syscommon/Exception.h"
+#include "syscommon/concurrent/Event.h"
+#include "syscommon/concurrent/Lock.h"
+#include "syscommon/concurrent/ScheduledFuture.h"
+#include "syscommon/concurrent/Thread.h"
+
+namespace syscommon
+{
+	/**
+	 * An executor that runs IRunnable tasks after a delay, or periodically, on a small set of
+	 * pooled worker Threads. It replaces the common pattern of dedicating a thread to each
+	 * heartbeat or timeout that loops around Thread::sleep().
+	 *
+	 * eg:
+	 *
+	 * ScheduledExecutor scheduler( 2 );
+	 * ScheduledFuture* heartbeat = scheduler.scheduleAtFixedRate( heartbeatTask, 0, 1000 );
+	 * ScheduledFuture* timeout = scheduler.schedule( timeoutTask, 30000 );
+	 *
+	 * // The connection responded, so the timeout is no longer needed
+	 * timeout->cancel( false );
+	 *
+	 * delete timeout;
+	 * delete heartbeat;
+	 *
+	 * Pending tasks are kept in a hierarchical timing wheel. Time is divided into ticks of a
+	 * fixed length (one millisecond by default), and the wheel has WHEEL_LEVELS levels of
+	 * WHEEL_SLOTS slots each. A task that is due within WHEEL_SLOTS ticks sits in the bottom level
+	 * in the slot for its tick; tasks further out sit in a slot of a higher level covering a range
+	 * of ticks, and are moved down a level as their range comes round. Scheduling and cancelling
+	 * a task therefore take constant time however many tasks are pending, and a pending task costs
+	 * no more memory than its ScheduledFuture. A task never runs before its delay has elapsed, but
+	 * may run up to one tick later.
+	 *
+	 * There is no separate timer thread. An idle worker keeps the wheel turning while it waits,
+	 * and hands that job to another idle worker when it picks up a task to run.
+	 *
+	 * A periodic task never runs concurrently with itself. If a run of a fixed rate task overruns
+	 * the period, the next run starts as soon as it finishes.
+	 */
+	class ScheduledExecutor : private IRunnable
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+		public:
+			static const unsigned long DEFAULT_TICK_MILLIS = 1;
+
+			static const unsigned int WHEEL_BITS = 8;
+			static const unsigned int WHEEL_SLOTS = 1 << WHEEL_BITS;
+			static const unsigned int WHEEL_LEVELS = 4;
+
+		private:
+			enum ExecutorState { ES_RUNNING, ES_SHUTDOWN, ES_STOPPED };
+
+			static unsigned long EXECUTOR_ID_COUNTER;
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			std::vector<Thread*> workers;
+			volatile ExecutorState state;
+
+			long long epoch;
+			long long tickNanos;
+
+			// The next tick that the wheel has to process
+			long long currentTick;
+			TimerNode wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+			TimerNode readyList;
+			size_t pendingCount;
+			size_t readyCount;
+
+			// Whether an idle worker is currently turning the wheel, and the tick it will wake for
+			bool ticking;
+			long long wakeTick;
+
+			unsigned int activeCount;
+			unsigned int idleCount;
+
+			Lock wheelLock;
+			Event tickEvent;
+			Event workAvailableEvent;
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Creates an executor with the given number of worker threads and a tick length of
+			 * DEFAULT_TICK_MILLIS
+			 *
+			 * @param poolSize the number of worker threads to run tasks on
+			 */
+			ScheduledExecutor( unsigned int poolSize );
+
+			/**
+			 * Creates an executor with the given number of worker threads and tick length. A
+			 * longer tick makes the executor wake less often, at the cost of timing precision.
+			 *
+			 * @param poolSize the number of worker threads to run tasks on
+			 * @param tickMillis the resolution of the timing wheel, in milliseconds
+			 */
+			ScheduledExecutor( unsigned int poolSize, unsigned long tickMillis );
+
+			/**
+			 * Cancels all tasks that have not started yet, waits for running tasks to finish and
+			 * releases the workers
+			 */
+			virtual ~ScheduledExecutor();
+
+		private:
+			void _ScheduledExecutor( unsigned int poolSize, unsigned long tickMillis );
+
+			// Not copyable
+			ScheduledExecutor( const ScheduledExecutor& );
+			ScheduledExecutor& operator=( const ScheduledExecutor& );
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Schedules the given task to run once, after the given delay.
+			 *
+			 * @param task the task to run. The task remains owned by the caller and must stay
+			 *             valid until the returned future is done.
+			 * @param delay the time to wait before running the task, in milliseconds
+			 *
+			 * @return a ScheduledFuture that can be used to wait for or cancel the task. The
+			 *         caller is responsible for deleting it.
+			 *
+			 * @throws RejectedExecutionException if the executor has been shut down
+			 */
+			ScheduledFuture* schedule( IRunnable* task, unsigned long delay ) noexcept( false );
+
+			/**
+			 * Schedules the given task to run first after the given initial delay, and then
+			 * repeatedly every period milliseconds, measured from when the previous run started.
+			 *
+			 * @param task the task to run. The task remains owned by the caller and must stay
+			 *             valid until the returned future is done.
+			 * @param initialDelay the time to wait before the first run, in milliseconds
+			 * @param period the time between the start of successive runs, in milliseconds
+			 *
+			 * @return a ScheduledFuture that can be used to cancel the task. The caller is
+			 *         responsible for deleting it.
+			 *
+			 * @throws IllegalArgumentException if the period is zero
+			 * @throws RejectedExecutionException if the executor has been shut down
+			 */
+			ScheduledFuture* scheduleAtFixedRate( IRunnable* task,
+												  unsigned long initialDelay,
+												  unsigned long period ) noexcept( false );
+
+			/**
+			 * Schedules the given task to run first after the given initial delay, and then
+			 * repeatedly with the given delay between the end of one run and the start of the
+			 * next.
+			 *
+			 * @param task the task to run. The task remains owned by the caller and must stay
+			 *             valid until the returned future is done.
+			 * @param initialDelay the time to wait before the first run, in milliseconds
+			 * @param delay the time between the end of one run and the start of the next, in
+			 *              milliseconds
+			 *
+			 * @return a ScheduledFuture that can be used to cancel the task. The caller is
+			 *         responsible for deleting it.
+			 *
+			 * @throws IllegalArgumentException if the delay is zero
+			 * @throws RejectedExecutionException if the executor has been shut down
+			 */
+			ScheduledFuture* scheduleWithFixedDelay( IRunnable* task,
+													 unsigned long initialDelay,
+													 unsigned long delay ) noexcept( false );
+
+			/**
+			 * Initiates an orderly shutdown. No new tasks will be accepted and periodic tasks are
+			 * cancelled, but tasks that were scheduled to run once still run when their delay
+			 * expires.
+			 */
+			void shutdown();
+
+			/**
+			 * Stops accepting new tasks, cancels all tasks that have not started yet and
+			 * interrupts the tasks that are currently running.
+			 *
+			 * @return the tasks that were cancelled before they could run
+			 */
+			std::list<IRunnable*> shutdownNow();
+
+			/**
+			 * Blocks until all workers have terminated after a shutdown request, or the timeout
+			 * period elapses, whichever happens first.
+			 *
+			 * @param timeout the maximum time to wait, in milliseconds
+			 *
+			 * @return true if the executor terminated, false if the timeout elapsed first
+			 */
+			bool awaitTermination( unsigned long timeout );
+
+			/**
+			 * Returns true if shutdown() or shutdownNow() has been called on this executor
+			 */
+			bool isShutdown() const;
+
+			/**
+			 * Returns the number of worker threads in the pool
+			 */
+			unsigned int getPoolSize() const;
+
+			/**
+			 * Returns the number of workers that are currently running a task
+			 */
+			unsigned int getActiveCount();
+
+			/**
+			 * Returns the number of tasks that are waiting to run, either because their delay has
+			 * not expired yet or because no worker has picked them up
+			 */
+			size_t getQueueSize();
+
+		private:
+			ScheduledFuture* enqueue( IRunnable* task,
+									  unsigned long delay,
+									  long long period ) noexcept( false );
+
+			/**
+			 * Cancels tasks that have not started yet, and wakes the workers so that they notice
+			 * the change in state. Called with the wheel lock held.
+			 *
+			 * @param periodicOnly whether to leave one-shot tasks scheduled
+			 * @param cancelled receives the tasks that were cancelled
+			 */
+			void cancelPending( bool periodicOnly, std::list<IRunnable*>& cancelled );
+
+			/**
+			 * Cancels the given future on behalf of ScheduledFuture::cancel()
+			 */
+			bool cancel( ScheduledFuture* future, bool mayInterruptIfRunning );
+
+			/**
+			 * Waits for the given future to be done.
+			 *
+			 * @param future the future to wait for
+			 * @param waitForRun whether to also wait for a run that is still going after the
+			 *                   future was cancelled
+			 * @param timeout the maximum time to wait, in milliseconds
+			 *
+			 * @return true if the future was done within the timeout period, otherwise false
+			 */
+			bool waitForDone( ScheduledFuture* future, bool waitForRun, unsigned long timeout );
+
+			/**
+			 * Returns the time since the executor's epoch, in nanoseconds
+			 */
+			long long elapsedNanos() const;
+
+			/**
+			 * Links a future into the timing wheel according to its time, and makes sure a worker
+			 * will wake up in time to run it. Called with the wheel lock held.
+			 */
+			void addTimer( ScheduledFuture* future );
+
+			/**
+			 * Links a future into the slot of the timing wheel for its time, without counting it
+			 * or waking anyone. Called with the wheel lock held.
+			 *
+			 * @return the tick at which the future is due
+			 */
+			long long placeTimer( ScheduledFuture* future );
+
+			/**
+			 * Processes every tick up to the current time, moving the tasks that have fallen due
+			 * onto the ready list. Called with the wheel lock held.
+			 */
+			void advance();
+
+			/**
+			 * Moves every task in the given slot down to the level below, or onto the ready list
+			 * if they are in the bottom level. Called with the wheel lock held.
+			 */
+			void cascade( unsigned int level, unsigned int slot );
+
+			/**
+			 * Returns the next tick at which the wheel has any work to do, or LLONG_MAX if it is
+			 * empty. Called with the wheel lock held.
+			 */
+			long long findNextTick() const;
+
+			/**
+			 * Blocks the calling worker until a task can be started, turning the wheel while it
+			 * waits if no other worker is doing so.
+			 *
+			 * @return the started future, or NULL if the worker should terminate
+			 */
+			ScheduledFuture* takeTask( Thread* worker );
+
+			/**
+			 * Runs a started future and then either reschedules it or marks it done
+			 */
+			void execute( ScheduledFuture* future );
+
+			/**
+			 * Worker thread main loop
+			 */
+			virtual void run();
+
+		//----------------------------------------------------------
+		//                     STATIC METHODS
+		//----------------------------------------------------------
+
+		friend class ScheduledFuture;
+	};
+}
@@ -0,0 +1,230 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include "syscommon/Platform.h"
+#include "syscommon/Exception.h"
+#include "syscommon/concurrent/Event.h"
+#include "syscommon/concurrent/Thread.h"
+
+namespace syscommon
+{
+	class ScheduledExecutor;
+
+	/**
+	 * A link in one of a ScheduledExecutor's circular, doubly linked timer lists. Timers are linked
+	 * into the lists directly rather than being held by a container, so that a timer can be
+	 * removed from whichever list it is on in constant time without searching for it.
+	 */
+	class TimerNode
+	{
+		public:
+			TimerNode* previous;
+			TimerNode* next;
+
+		public:
+			TimerNode() : previous( this ), next( this ) {}
+
+		public:
+			bool isEmpty() const
+			{
+				return this->next == this;
+			}
+
+			/**
+			 * Links the given node in at the end of the list that this node heads
+			 */
+			void append( TimerNode* node )
+			{
+				node->previous = this->previous;
+				node->next = this;
+				this->previous->next = node;
+				this->previous = node;
+			}
+
+			/**
+			 * Removes this node from whichever list it is on
+			 */
+			void unlink()
+			{
+				this->previous->next = this->next;
+				this->next->previous = this->previous;
+				this->previous = this;
+				this->next = this;
+			}
+	};
+
+	/**
+	 * A ScheduledFuture represents a task that has been scheduled to run on a ScheduledExecutor,
+	 * either once after a delay, or repeatedly. Methods are provided to cancel the task, check
+	 * whether it is done and wait for it to finish.
+	 *
+	 * Cancelling a task that is waiting for its delay to expire removes it from the executor's
+	 * timing wheel, which takes constant time. Cancelling a task that is running will, if
+	 * requested, interrupt the worker thread through Thread::interrupt() so that any blocking
+	 * operation the task is performing throws an InterruptedException. A periodic task that is
+	 * cancelled while running is not run again.
+	 *
+	 * A periodic task only becomes done when it is cancelled, when one of its runs throws an
+	 * exception, or when its executor is shut down.
+	 *
+	 * Memory Management: ScheduledFutures are owned by the caller and should be deleted once they
+	 * are no longer required. Deleting a ScheduledFuture cancels it, and blocks until the task has
+	 * finished if it is running. The IRunnable itself remains owned by the caller. Every future
+	 * is done once its executor has been destroyed, so a future may outlive its executor.
+	 */
+	class ScheduledFuture : private TimerNode
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+		private:
+			enum FutureState
+			{
+				FS_PENDING,    // Linked into the timing wheel, waiting for its delay to expire
+				FS_QUEUED,     // Linked into the ready list, waiting for a worker
+				FS_RUNNING,
+				FS_COMPLETED,
+				FS_FAILED,
+				FS_CANCELLED
+			};
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			// Everything below is guarded by the executor's wheel lock. Pending timers are kept
+			// as small as possible, as an executor may hold a great many of them.
+			ScheduledExecutor* executor;
+			IRunnable* task;
+
+			// When the task should next run, in nanoseconds from the executor's epoch
+			long long time;
+
+			// Zero for a one-shot task. Positive for a fixed rate, where each run is scheduled
+			// relative to the previous one, and negative for a fixed delay, where each run is
+			// scheduled relative to the end of the previous one.
+			long long period;
+
+			volatile FutureState state;
+			volatile bool running;
+			Thread* runner;
+
+			// Only created once a thread waits on the future, and signaled when it is done and
+			// no longer running
+			Event* doneEvent;
+
+			// Only created if a run of the task throws, and reported by get()
+			String* failure;
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		private:
+			/**
+			 * ScheduledFutures are only created by a ScheduledExecutor
+			 *
+			 * @param task the unit of execution that this future represents
+			 * @param executor the executor the task has been scheduled on
+			 * @param time when the task should first run, in nanoseconds from the executor's epoch
+			 * @param period the repetition period in nanoseconds, see the period member
+			 */
+			ScheduledFuture( IRunnable* task,
+							 ScheduledExecutor* executor,
+							 long long time,
+							 long long period );
+
+			// Not copyable
+			ScheduledFuture( const ScheduledFuture& );
+			ScheduledFuture& operator=( const ScheduledFuture& );
+
+		public:
+			/**
+			 * Cancels the task if it is still scheduled, and waits for it to finish if it is
+			 * running.
+			 */
+			virtual ~ScheduledFuture();
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Attempts to cancel execution of this task. The attempt will fail if the task has
+			 * already completed or has already been cancelled. If the task is waiting to run, it
+			 * never will. If the task is running and mayInterruptIfRunning is true, the worker
+			 * thread running the task is interrupted.
+			 *
+			 * @param mayInterruptIfRunning whether the thread executing this task should be
+			 *                              interrupted
+			 *
+			 * @return false if the task could not be cancelled, typically because it has already
+			 *         completed, otherwise true
+			 */
+			bool cancel( bool mayInterruptIfRunning );
+
+			/**
+			 * Returns true if this task was cancelled before it completed normally.
+			 */
+			bool isCancelled() const;
+
+			/**
+			 * Returns true if this task completed. Completion may be due to normal termination,
+			 * an exception, or cancellation.
+			 */
+			bool isDone() const;
+
+			/**
+			 * Returns true if this task repeats until it is cancelled
+			 */
+			bool isPeriodic() const;
+
+			/**
+			 * Waits indefinitely for the task to complete.
+			 *
+			 * @throws CancellationException if the task was cancelled
+			 * @throws ExecutionException if the task terminated by throwing an exception, with
+			 *         that exception's message
+			 */
+			void get() noexcept( false );
+
+			/**
+			 * Waits at most the given number of milliseconds for the task to complete.
+			 *
+			 * @param timeout the maximum time, in milliseconds, to wait for the task
+			 *
+			 * @return true if the task completed within the timeout period, otherwise false
+			 *
+			 * @throws CancellationException if the task was cancelled
+			 * @throws ExecutionException if the task terminated by throwing an exception, with
+			 *         that exception's message
+			 */
+			bool get( unsigned long timeout ) noexcept( false );
+
+		private:
+			/**
+			 * Signals the done event, if anyone has waited on it. Called with the wheel lock held
+			 * once the future is done and no longer running.
+			 */
+			void signalDone();
+
+		//----------------------------------------------------------
+		//                     STATIC METHODS
+		//----------------------------------------------------------
+
+		friend class ScheduledExecutor;
+	};
+}
@@ -66,6 +66,11 @@ namespace syscommon
 			 * Creates a Semaphore with the given number of permits and the specified name.
 			 */
 			Semaphore( unsigned int permits, const tchar* name );
+
+			/**
+			 * Releases any thread still blocked in acquire(), which returns without a permit,
+			 * and waits for it and any release() in progress to leave the semaphore.
+			 */
 			virtual ~Semaphore();
 
 		private:
@@ -87,6 +92,24 @@ namespace syscommon
 			 */
 			void acquire() noexcept( false );
 
+			/**
+			 * Acquires the given number of permits from this semaphore, blocking until all are
+			 * available, or the thread is interrupted. The permits are taken all at once, so no
+			 * permits are held while waiting.
+			 *
+			 * @throws InterruptedException if the thread was interrupted before the permits could 
+			 * be acquired.
+			 */
+			void acquire( unsigned int permits ) noexcept( false );
+
+			/**
+			 * Acquires a permit from this semaphore only if one is available at the time of the
+			 * call. This never blocks, and does not check the thread's interrupt status.
+			 *
+			 * @return true if a permit was acquired
+			 */
+			bool tryAcquire();
+
 			/**
 			 * Acquires a permit from this semaphore, if one becomes available within the given 
 			 * waiting time and the current thread has not been interrupted.
@@ -99,11 +122,38 @@ namespace syscommon
 			 */
 			bool tryAcquire( unsigned long timeoutMillis ) noexcept( false );
 
+			/**
+			 * Acquires the given number of permits from this semaphore, if they all become
+			 * available within the given waiting time and the current thread has not been
+			 * interrupted.
+			 *
+			 * @return true if the permits were acquired and false if the waiting time elapsed
+			 * before they were acquired, in which case none are held
+			 *
+			 * @throws InterruptedException if the thread was interrupted before the permits could 
+			 * be acquired.
+			 */
+			bool tryAcquire( unsigned int permits, unsigned long timeoutMillis ) noexcept( false );
+
+			/**
+			 * Acquires as many of the permits that are available at the time of the call as it
+			 * can, up to the given number, in a single step. This never blocks, and does not
+			 * check the thread's interrupt status.
+			 *
+			 * @return the number of permits acquired, which is zero if none were available
+			 */
+			unsigned int drainPermits( unsigned int maxPermits );
+
 			/**
 			 * Releases a permit, returning it to the semaphore.
 			 */
 			bool release();
 
+			/**
+			 * Releases the given number of permits, returning them to the semaphore.
+			 */
+			bool release( unsigned int permits );
+
 		private:
 			/**
 			 * Interupt visitor
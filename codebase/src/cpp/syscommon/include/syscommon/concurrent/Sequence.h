@@ -0,0 +1,102 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <atomic>
+#include <vector>
+
+#include "syscommon/Platform.h"
+
+namespace syscommon
+{
+	/**
+	 * A position in a Pipeline's ring, written by exactly one thread and read by others. The value
+	 * sits on a cache line of its own, so that the thread advancing one Sequence does not slow
+	 * down threads that are advancing their neighbours.
+	 *
+	 * A Sequence starts at INITIAL_VALUE, meaning nothing has been published or processed yet.
+	 */
+	class Sequence
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+		public:
+			static const long long INITIAL_VALUE = -1;
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			char leadingPadding[64];
+			std::atomic<long long> value;
+			char trailingPadding[64 - sizeof(std::atomic<long long>)];
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			Sequence() : value( INITIAL_VALUE ) {}
+
+		private:
+			// Not copyable
+			Sequence( const Sequence& );
+			Sequence& operator=( const Sequence& );
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Returns the current value. Everything the writer did before it set the value is
+			 * visible to the caller.
+			 */
+			long long get() const
+			{
+				return this->value.load( std::memory_order_acquire );
+			}
+
+			/**
+			 * Sets the value, publishing everything the calling thread has written before it
+			 */
+			void set( long long value )
+			{
+				this->value.store( value, std::memory_order_release );
+			}
+
+		//----------------------------------------------------------
+		//                     STATIC METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Returns the smallest value of the given sequences, or the given default if there
+			 * are none
+			 */
+			static long long minimum( const std::vector<Sequence*>& sequences, long long defaultValue )
+			{
+				long long result = defaultValue;
+				std::vector<Sequence*>::const_iterator it = sequences.begin();
+				for( ; it != sequences.end() ; ++it )
+				{
+					long long current = (*it)->get();
+					if( current < result )
+						result = current;
+				}
+
+				return result;
+			}
+	};
+}
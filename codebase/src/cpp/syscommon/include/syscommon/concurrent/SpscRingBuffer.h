@@ -0,0 +1,360 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <atomic>
+#include <vector>
+
+#include "syscommon/Platform.h"
+#include "syscommon/Exception.h"
+#include "syscommon/concurrent/WaitStrategy.h"
+
+namespace syscommon
+{
+	/**
+	 * A bounded, wait-free ring buffer for passing elements from exactly one producer thread to
+	 * exactly one consumer thread, such as a socket's receive thread and the thread that processes
+	 * what it receives.
+	 *
+	 * eg:
+	 *
+	 * SpscRingBuffer<DatagramPacket*> received( 4096, WP_PARK );
+	 *
+	 * // Receive thread
+	 * received.put( packet );
+	 *
+	 * // Processing thread
+	 * std::vector<DatagramPacket*> batch;
+	 * while( true )
+	 * {
+	 *     batch.clear();
+	 *     received.take( batch, 64 );
+	 *     ...
+	 * }
+	 *
+	 * The producer and consumer each own one index, which is the only thing the other side ever
+	 * reads, and the two indices are kept on separate cache lines. Each side also keeps a private
+	 * copy of the other's index, and only reads the shared one again when its copy says there is not
+	 * enough space or not enough elements, so a handoff rarely touches a cache line that the other
+	 * thread is writing. Publishing or consuming a batch moves the index once for the whole batch.
+	 *
+	 * offer(), poll() and drainTo() never block. put() and take() wait according to the WaitPolicy
+	 * the buffer was created with.
+	 *
+	 * The capacity is rounded up to a power of two. Elements are copied in and out of
+	 * preallocated slots, so T must be default constructible and assignable, and a consumed
+	 * element stays in its slot until the slot is reused.
+	 */
+	template<typename T>
+	class SpscRingBuffer
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			std::vector<T> slots;
+			size_t mask;
+
+			WaitStrategy notEmpty;
+			WaitStrategy notFull;
+
+			// Written by the consumer only. The consumer's copy of the tail sits on the same line,
+			// as the consumer is the only thread that touches it.
+			char headPadding[64];
+			std::atomic<size_t> head;
+			size_t cachedTail;
+
+			// Written by the producer only
+			char tailPadding[64 - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+			std::atomic<size_t> tail;
+			size_t cachedHead;
+			char endPadding[64 - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Creates an empty ring buffer
+			 *
+			 * @param capacity the number of elements the buffer can hold, rounded up to a power of
+			 *                 two
+			 * @param policy how put() and take() wait for space or elements
+			 *
+			 * @throws IllegalArgumentException if the capacity is zero
+			 */
+			SpscRingBuffer( size_t capacity, WaitPolicy policy ) noexcept( false ) :
+				notEmpty( policy ),
+				notFull( policy ),
+				head( 0 ),
+				cachedTail( 0 ),
+				tail( 0 ),
+				cachedHead( 0 )
+			{
+				if( capacity == 0 )
+					throw IllegalArgumentException( TEXT("Ring buffer capacity must be greater than zero") );
+
+				size_t size = 1;
+				while( size < capacity )
+					size <<= 1;
+
+				this->slots.resize( size );
+				this->mask = size - 1;
+			}
+
+			virtual ~SpscRingBuffer()
+			{
+
+			}
+
+		private:
+			// Not copyable
+			SpscRingBuffer( const SpscRingBuffer& );
+			SpscRingBuffer& operator=( const SpscRingBuffer& );
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Publishes the element if there is space for it, without waiting. Must only be called
+			 * by the producer.
+			 *
+			 * @return true if the element was published, false if the buffer was full
+			 */
+			bool offer( const T& element )
+			{
+				size_t t = this->tail.load( std::memory_order_relaxed );
+				if( this->freeSlots(t, 1) == 0 )
+					return false;
+
+				this->slots[t & this->mask] = element;
+				this->tail.store( t + 1, std::memory_order_release );
+				this->notEmpty.signal();
+				return true;
+			}
+
+			/**
+			 * Publishes as many of the given elements as there is space for, in order, without
+			 * waiting. The consumer sees the elements all at once. Must only be called by the
+			 * producer.
+			 *
+			 * @param elements the elements to publish
+			 * @param count the number of elements
+			 *
+			 * @return the number of elements published, starting from the first
+			 */
+			size_t offer( const T* elements, size_t count )
+			{
+				size_t t = this->tail.load( std::memory_order_relaxed );
+				size_t available = this->freeSlots( t, count );
+				size_t published = count < available ? count : available;
+				if( published == 0 )
+					return 0;
+
+				for( size_t i = 0 ; i < published ; ++i )
+					this->slots[(t + i) & this->mask] = elements[i];
+
+				this->tail.store( t + published, std::memory_order_release );
+				this->notEmpty.signal();
+				return published;
+			}
+
+			/**
+			 * Publishes the element, waiting for space if the buffer is full. Must only be called
+			 * by the producer.
+			 */
+			void put( const T& element )
+			{
+				if( this->offer(element) )
+					return;
+
+				WaitStrategy::Waiter waiter( this->notFull );
+				while( !this->offer(element) )
+					waiter.idle();
+			}
+
+			/**
+			 * Publishes all of the given elements in order, waiting for space as often as
+			 * required. Must only be called by the producer.
+			 */
+			void put( const T* elements, size_t count )
+			{
+				size_t published = this->offer( elements, count );
+				if( published == count )
+					return;
+
+				WaitStrategy::Waiter waiter( this->notFull );
+				while( published < count )
+				{
+					size_t more = this->offer( elements + published, count - published );
+					if( more == 0 )
+						waiter.idle();
+
+					published += more;
+				}
+			}
+
+			/**
+			 * Consumes the next element if there is one, without waiting. Must only be called by
+			 * the consumer.
+			 *
+			 * @param element receives the consumed element
+			 *
+			 * @return true if an element was consumed, false if the buffer was empty
+			 */
+			bool poll( T& element )
+			{
+				size_t h = this->head.load( std::memory_order_relaxed );
+				if( this->usedSlots(h, 1) == 0 )
+					return false;
+
+				element = this->slots[h & this->mask];
+				this->head.store( h + 1, std::memory_order_release );
+				this->notFull.signal();
+				return true;
+			}
+
+			/**
+			 * Consumes up to maxElements elements without waiting, and appends them to the given
+			 * batch in order. The producer sees the space they leave all at once. Must only be
+			 * called by the consumer.
+			 *
+			 * @return the number of elements consumed, which is zero if the buffer was empty
+			 */
+			size_t drainTo( std::vector<T>& batch, size_t maxElements )
+			{
+				size_t h = this->head.load( std::memory_order_relaxed );
+				size_t available = this->usedSlots( h, maxElements );
+				size_t consumed = maxElements < available ? maxElements : available;
+				if( consumed == 0 )
+					return 0;
+
+				for( size_t i = 0 ; i < consumed ; ++i )
+					batch.push_back( this->slots[(h + i) & this->mask] );
+
+				this->head.store( h + consumed, std::memory_order_release );
+				this->notFull.signal();
+				return consumed;
+			}
+
+			/**
+			 * Consumes the next element, waiting for one if the buffer is empty. Must only be
+			 * called by the consumer.
+			 */
+			T take()
+			{
+				T element;
+				if( this->poll(element) )
+					return element;
+
+				WaitStrategy::Waiter waiter( this->notEmpty );
+				while( !this->poll(element) )
+					waiter.idle();
+
+				return element;
+			}
+
+			/**
+			 * Waits for the buffer to hold at least one element, then consumes up to maxElements
+			 * elements and appends them to the given batch in order. Must only be called by the
+			 * consumer.
+			 *
+			 * @return the number of elements consumed, which is zero only if maxElements is zero
+			 */
+			size_t take( std::vector<T>& batch, size_t maxElements )
+			{
+				size_t consumed = this->drainTo( batch, maxElements );
+				if( consumed > 0 || maxElements == 0 )
+					return consumed;
+
+				WaitStrategy::Waiter waiter( this->notEmpty );
+				while( (consumed = this->drainTo(batch, maxElements)) == 0 )
+					waiter.idle();
+
+				return consumed;
+			}
+
+			/**
+			 * Returns the number of elements in the buffer. When called by a thread other than
+			 * the producer or consumer, the value is only an estimate.
+			 */
+			size_t size() const
+			{
+				size_t h = this->head.load( std::memory_order_acquire );
+				size_t t = this->tail.load( std::memory_order_acquire );
+				return t > h ? t - h : 0;
+			}
+
+			/**
+			 * Returns true if the buffer appeared empty at the time of the call
+			 */
+			bool isEmpty() const
+			{
+				return this->size() == 0;
+			}
+
+			/**
+			 * Returns the number of elements the buffer can hold
+			 */
+			size_t getCapacity() const
+			{
+				return this->slots.size();
+			}
+
+		private:
+			/**
+			 * Returns the number of slots the producer may fill from the given tail, only reading
+			 * the consumer's index when the cached copy says there are fewer than wanted
+			 */
+			size_t freeSlots( size_t t, size_t wanted )
+			{
+				size_t capacity = this->slots.size();
+				size_t available = capacity - ( t - this->cachedHead );
+				if( available < wanted )
+				{
+					this->cachedHead = this->head.load( std::memory_order_acquire );
+					available = capacity - ( t - this->cachedHead );
+				}
+
+				return available;
+			}
+
+			/**
+			 * Returns the number of slots the consumer may read from the given head, only reading
+			 * the producer's index when the cached copy says there are fewer than wanted
+			 */
+			size_t usedSlots( size_t h, size_t wanted )
+			{
+				size_t available = this->cachedTail - h;
+				if( available < wanted )
+				{
+					this->cachedTail = this->tail.load( std::memory_order_acquire );
+					available = this->cachedTail - h;
+				}
+
+				return available;
+			}
+
+		//----------------------------------------------------------
+		//                     STATIC METHODS
+		//----------------------------------------------------------
+	};
+}
@@ -0,0 +1,338 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include "syscommon/Platform.h"
+
+#ifdef SYSCOMMON_HAS_COROUTINES
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace syscommon
+{
+	template<typename T> class Task;
+
+	/**
+	 * The part of a Task's promise that does not depend on the type of its result: where to go
+	 * once the task finishes, and the exception it finished with, if any
+	 */
+	class TaskPromiseBase
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Suspends a finished task and hands back to whatever was awaiting it. A task that
+			 * finished before its awaiter had suspended is picked up by Task::Awaiter without
+			 * anything being resumed here, so that a long run of tasks finishing without
+			 * suspending does not grow the stack, whether or not the compiler turns resumes into
+			 * tail calls.
+			 */
+			struct FinalAwaiter
+			{
+				bool await_ready() noexcept
+				{
+					return false;
+				}
+
+				template<typename Promise>
+				void await_suspend( std::coroutine_handle<Promise> handle ) noexcept
+				{
+					// Whichever of us and the awaiter gets here second resumes the awaiting
+					// coroutine, and the awaiter does so by not suspending at all
+					TaskPromiseBase& promise = handle.promise();
+					if( promise.handedOff.exchange(true, std::memory_order_acq_rel) )
+						promise.continuation.resume();
+				}
+
+				void await_resume() noexcept
+				{
+				}
+			};
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		public:
+			std::coroutine_handle<> continuation;
+			std::exception_ptr exception;
+
+			// Set by the first of the task finishing and its awaiter suspending
+			std::atomic<bool> handedOff;
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			TaskPromiseBase() : handedOff( false )
+			{
+			}
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			std::suspend_always initial_suspend() noexcept
+			{
+				return std::suspend_always();
+			}
+
+			FinalAwaiter final_suspend() noexcept
+			{
+				return FinalAwaiter();
+			}
+
+			void unhandled_exception()
+			{
+				this->exception = std::current_exception();
+			}
+
+		protected:
+			void rethrow() noexcept( false )
+			{
+				if( this->exception )
+					std::rethrow_exception( this->exception );
+			}
+	};
+
+	template<typename T>
+	class TaskPromise : public TaskPromiseBase
+	{
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			std::optional<T> value;
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			Task<T> get_return_object();
+
+			void return_value( T value )
+			{
+				this->value = std::move( value );
+			}
+
+			/**
+			 * Returns what the task returned, or throws what it threw
+			 */
+			T getResult() noexcept( false )
+			{
+				this->rethrow();
+				return std::move( *this->value );
+			}
+	};
+
+	template<>
+	class TaskPromise<void> : public TaskPromiseBase
+	{
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			Task<void> get_return_object();
+
+			void return_void()
+			{
+			}
+
+			void getResult() noexcept( false )
+			{
+				this->rethrow();
+			}
+	};
+
+	/**
+	 * A coroutine that produces a T, or nothing for Task<void>. A task does not start when it is
+	 * called; it starts when it is awaited, and the awaiting coroutine carries on once it has
+	 * returned, with its result, or with the exception it threw. Awaiting one task from another
+	 * costs no more than a function call and never blocks a thread.
+	 *
+	 * eg: read a length prefixed message
+	 *
+	 * Task<std::string> readMessage( Socket* socket )
+	 * {
+	 *     unsigned int length = 0;
+	 *     co_await readFully( socket, (char*)&length, sizeof(length) );
+	 *
+	 *     std::string message( length, '\0' );
+	 *     co_await readFully( socket, &message[0], (int)length );
+	 *     co_return message;
+	 * }
+	 *
+	 * A coroutine's locals live in a frame on the heap rather than on a thread's stack, so a
+	 * suspended task costs only the size of that frame, typically a few hundred bytes. Something
+	 * has to resume a task while it waits for I/O or time to pass, which is what an EventLoop is
+	 * for: the outermost task of each session is given to EventLoop::spawn(), and everything it
+	 * awaits runs on the loop's thread.
+	 *
+	 * A Task owns its frame and destroys it when it is deleted, so it must outlive the awaiting
+	 * of it. Tasks can be moved but not copied, and each can only be awaited once.
+	 *
+	 * Only available when compiling as C++20 or later, when SYSCOMMON_HAS_COROUTINES is defined.
+	 */
+	template<typename T>
+	class Task
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+		public:
+			typedef TaskPromise<T> promise_type;
+
+			/**
+			 * Starts the task on behalf of the coroutine awaiting it, and hands its result back
+			 */
+			class Awaiter
+			{
+				private:
+					std::coroutine_handle<promise_type> handle;
+
+				public:
+					Awaiter( std::coroutine_handle<promise_type> handle ) : handle( handle ) {}
+
+					bool await_ready() noexcept
+					{
+						return !this->handle || this->handle.done();
+					}
+
+					bool await_suspend( std::coroutine_handle<> awaiting ) noexcept
+					{
+						// Run the task until it first suspends. If it finished instead, carry
+						// straight on rather than suspending.
+						promise_type& promise = this->handle.promise();
+						promise.continuation = awaiting;
+						this->handle.resume();
+						return !promise.handedOff.exchange( true, std::memory_order_acq_rel );
+					}
+
+					T await_resume() noexcept( false )
+					{
+						return this->handle.promise().getResult();
+					}
+			};
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			std::coroutine_handle<promise_type> handle;
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Creates a task with no coroutine, which cannot be awaited
+			 */
+			Task() : handle()
+			{
+			}
+
+			explicit Task( std::coroutine_handle<promise_type> handle ) : handle( handle )
+			{
+			}
+
+			Task( Task&& other ) noexcept : handle( other.handle )
+			{
+				other.handle = std::coroutine_handle<promise_type>();
+			}
+
+			Task& operator=( Task&& other ) noexcept
+			{
+				if( this != &other )
+				{
+					if( this->handle )
+						this->handle.destroy();
+
+					this->handle = other.handle;
+					other.handle = std::coroutine_handle<promise_type>();
+				}
+
+				return *this;
+			}
+
+			/**
+			 * Destroys the coroutine's frame, along with its locals if it has not finished
+			 */
+			virtual ~Task()
+			{
+				if( this->handle )
+					this->handle.destroy();
+			}
+
+		private:
+			// Not copyable
+			Task( const Task& );
+			Task& operator=( const Task& );
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Returns whether there is a coroutine behind this task
+			 */
+			bool isValid() const
+			{
+				return (bool)this->handle;
+			}
+
+			/**
+			 * Returns whether the coroutine has returned or thrown
+			 */
+			bool isDone() const
+			{
+				return this->handle && this->handle.done();
+			}
+
+			/**
+			 * Runs a task that nothing is awaiting until it first suspends, for whatever drives
+			 * the outermost task of a chain. Must be called at most once, and not on a task that
+			 * is being awaited.
+			 */
+			void start()
+			{
+				if( this->handle && !this->handle.done() )
+					this->handle.resume();
+			}
+
+			Awaiter operator co_await() const noexcept
+			{
+				return Awaiter( this->handle );
+			}
+	};
+
+	template<typename T>
+	Task<T> TaskPromise<T>::get_return_object()
+	{
+		return Task<T>( std::coroutine_handle<TaskPromise<T> >::from_promise(*this) );
+	}
+
+	inline Task<void> TaskPromise<void>::get_return_object()
+	{
+		return Task<void>( std::coroutine_handle<TaskPromise<void> >::from_promise(*this) );
+	}
+}
+
+#endif
@@ -176,7 +176,6 @@ namespace syscommon
 			static NATIVE_THREAD mainThreadHandle;
 			static Lock managementLock;
 			static std::map<unsigned long, Thread*> threadMap;
-			static std::map<NATIVE_THREAD, Thread*> nativeThreadMap;
 
 
 		//----------------------------------------------------------
@@ -192,6 +191,7 @@ namespace syscommon
 
 			IRunnable* runner;
 			String name;
+			ThreadOptions options;
 
 			Event joinEvent;
 
@@ -222,6 +222,17 @@ namespace syscommon
 			 */
 			Thread( IRunnable* runnable, const tchar* name );
 
+			/**
+			 * Constructor for type Thread with provided IRunnable, name and options. The options
+			 * are applied to the new thread of execution when it is started, before the runnable
+			 * is executed.
+			 *
+			 * @param runnable This thread's unit of execution
+			 * @param name The name of the thread
+			 * @param options The affinity, scheduling, stack and NUMA settings for the thread
+			 */
+			Thread( IRunnable* runnable, const tchar* name, const ThreadOptions& options );
+
 			/**
 			 * Default destructor for type Thread
 			 */
@@ -241,6 +252,19 @@ namespace syscommon
 			 */
 			const tchar* getName() const;
 
+			/**
+			 * Returns the options that this thread is, or will be, started with
+			 */
+			const ThreadOptions& getOptions() const;
+
+			/**
+			 * Sets the options that this thread will be started with. This is mainly for
+			 * subclasses of Thread, and has no effect on a thread that has already been started.
+			 *
+			 * @param options The affinity, scheduling, stack and NUMA settings for the thread
+			 */
+			void setOptions( const ThreadOptions& options );
+
 			/**
 			 * Interrupts this thread. Any operations within this thread's unit of execution that
 			 * are blocking will return with a WaitResult of WR_INTERRUPTED and the thread's unit
@@ -299,8 +323,12 @@ namespace syscommon
 
 			/**
 			 * Executes this thread's run method in a new thread of execution.
+			 *
+			 * @throw IllegalStateException if the thread could not be created with its options,
+			 * for example because it asked for a real time scheduling policy without the
+			 * privileges to use one, or for processors that do not exist
 			 */
-			virtual void start();
+			virtual void start() noexcept( false );
 
 		//----------------------------------------------------------
 		//                     STATIC METHODS
@@ -309,10 +337,26 @@ namespace syscommon
 			/**
 			 * Returns the current thread of execution.
 			 *
+			 * The result is cached in thread-local storage, so after the first call on a given
+			 * thread this takes no locks. Threads that were not started through this class (for
+			 * example, ones created by a third party library) are given a Thread instance of their
+			 * own on their first call. It can be interrupted, but not started or joined, and is
+			 * deleted automatically when the thread exits.
+			 *
 			 * @return The currently executing thread.
 			 */
 			static Thread* currentThread();
 
+			/**
+			 * Tests whether the current thread has a pending interrupt and clears it. Blocking
+			 * operations consume the interrupt that wakes them, so this is only needed to discard
+			 * an interrupt that arrived while the thread was not blocked (for example, a worker
+			 * thread that is about to be reused for another task).
+			 *
+			 * @return true if the current thread had a pending interrupt, otherwise false
+			 */
+			static bool interrupted();
+
 			/**
 			 * Suspends this thread for the specified time period.
 			 *
@@ -327,5 +371,11 @@ namespace syscommon
 			
 		private:
 			static String generateAnonymousThreadName();
+
+			/**
+			 * Creates the Thread instance representing a thread that was not started by this
+			 * class. Called from the thread in question.
+			 */
+			static Thread* attachForeignThread();
 	};
 }
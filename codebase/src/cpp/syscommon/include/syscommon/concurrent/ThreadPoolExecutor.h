@@ -0,0 +1,254 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <deque>
+#include <list>
+#include <vector>
+
+#include "syscommon/Platform.h"
+#include "syscommon/Exception.h"
+#include "syscommon/concurrent/Event.h"
+#include "syscommon/concurrent/Future.h"
+#include "syscommon/concurrent/Lock.h"
+#include "syscommon/concurrent/Thread.h"
+
+namespace syscommon
+{
+	/**
+	 * An executor that runs submitted IRunnable tasks on a fixed set of pooled worker Threads.
+	 *
+	 * Tasks are placed on a bounded work queue and taken off it by the first idle worker, so the
+	 * cost of creating a thread is paid once per worker rather than once per task. When the queue
+	 * is full, the executor's RejectionPolicy decides what happens to the next task submitted.
+	 *
+	 * eg:
+	 *
+	 * ThreadPoolExecutor executor( 4, 256, ThreadPoolExecutor::RP_CALLER_RUNS );
+	 * Future* result = executor.submit( myRunnable );
+	 *
+	 * // Do other work, then wait up to a second for the task to finish
+	 * if( !result->get(1000) )
+	 *     result->cancel( true );
+	 *
+	 * delete result;
+	 *
+	 * Worker threads have any pending interrupt cleared before they start a new task, so a task
+	 * that was cancelled through Future::cancel(true) does not leak its interrupt into the next
+	 * task run by the same worker.
+	 */
+	class ThreadPoolExecutor : private IRunnable
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Describes what happens to a task that is submitted while the work queue is full
+			 */
+			enum RejectionPolicy
+			{
+				RP_ABORT,           // Throw a RejectedExecutionException
+				RP_CALLER_RUNS,     // Run the task on the submitting thread
+				RP_DISCARD,         // Silently cancel the new task
+				RP_DISCARD_OLDEST,  // Cancel the oldest queued task and queue the new one
+				RP_BLOCK            // Block the submitting thread until there is room
+			};
+
+			static const size_t DEFAULT_QUEUE_CAPACITY = 1024;
+
+		private:
+			enum PoolState { PS_RUNNING, PS_SHUTDOWN, PS_STOPPED };
+
+			static unsigned long POOL_ID_COUNTER;
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			std::vector<Thread*> workers;
+			std::deque<Future*> workQueue;
+			size_t queueCapacity;
+			RejectionPolicy rejectionPolicy;
+			volatile PoolState state;
+
+			unsigned int activeCount;
+			unsigned int idleCount;
+			unsigned int blockedCount;
+			unsigned long completedCount;
+
+			Lock queueLock;
+			Event workAvailableEvent;
+			Event spaceAvailableEvent;
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Creates an executor with the given number of worker threads, a work queue of
+			 * DEFAULT_QUEUE_CAPACITY and the RP_ABORT rejection policy.
+			 *
+			 * @param poolSize the number of worker threads to run tasks on
+			 */
+			ThreadPoolExecutor( unsigned int poolSize );
+
+			/**
+			 * Creates an executor with the given number of worker threads and work queue capacity,
+			 * using the RP_ABORT rejection policy.
+			 *
+			 * @param poolSize the number of worker threads to run tasks on
+			 * @param queueCapacity the maximum number of tasks that may wait for a worker
+			 */
+			ThreadPoolExecutor( unsigned int poolSize, size_t queueCapacity );
+
+			/**
+			 * Creates an executor with the given number of worker threads, work queue capacity and
+			 * rejection policy.
+			 *
+			 * @param poolSize the number of worker threads to run tasks on
+			 * @param queueCapacity the maximum number of tasks that may wait for a worker
+			 * @param rejectionPolicy what to do with tasks submitted while the queue is full
+			 */
+			ThreadPoolExecutor( unsigned int poolSize,
+								size_t queueCapacity,
+								RejectionPolicy rejectionPolicy );
+
+			/**
+			 * Shuts the executor down, waits for queued tasks to finish and releases the workers
+			 */
+			virtual ~ThreadPoolExecutor();
+
+		private:
+			void _ThreadPoolExecutor( unsigned int poolSize,
+									  size_t queueCapacity,
+									  RejectionPolicy rejectionPolicy );
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Executes the given task at some time in the future, without providing a means to
+			 * track or cancel it.
+			 *
+			 * @param task the task to run. The task remains owned by the caller and must stay
+			 *             valid until it has run.
+			 *
+			 * @throws RejectedExecutionException if the executor has been shut down, or the queue
+			 *         is full and the rejection policy is RP_ABORT
+			 */
+			void execute( IRunnable* task ) noexcept( false );
+
+			/**
+			 * Submits the given task for execution and returns a Future representing it.
+			 *
+			 * @param task the task to run. The task remains owned by the caller and must stay
+			 *             valid until the returned future is done.
+			 *
+			 * @return a Future that can be used to wait for or cancel the task. The caller is
+			 *         responsible for deleting it.
+			 *
+			 * @throws RejectedExecutionException if the executor has been shut down, or the queue
+			 *         is full and the rejection policy is RP_ABORT
+			 */
+			Future* submit( IRunnable* task ) noexcept( false );
+
+			/**
+			 * Initiates an orderly shutdown in which previously submitted tasks are executed, but
+			 * no new tasks will be accepted.
+			 */
+			void shutdown();
+
+			/**
+			 * Stops accepting new tasks, cancels all tasks that are still waiting in the queue and
+			 * interrupts the tasks that are currently running.
+			 *
+			 * @return the tasks that were cancelled before they could run
+			 */
+			std::list<IRunnable*> shutdownNow();
+
+			/**
+			 * Blocks until all workers have terminated after a shutdown request, or the timeout
+			 * period elapses, whichever happens first.
+			 *
+			 * @param timeout the maximum time to wait, in milliseconds
+			 *
+			 * @return true if the executor terminated, false if the timeout elapsed first
+			 */
+			bool awaitTermination( unsigned long timeout );
+
+			/**
+			 * Returns true if shutdown() or shutdownNow() has been called on this executor
+			 */
+			bool isShutdown() const;
+
+			/**
+			 * Returns the number of worker threads in the pool
+			 */
+			unsigned int getPoolSize() const;
+
+			/**
+			 * Returns the number of workers that are currently running a task
+			 */
+			unsigned int getActiveCount();
+
+			/**
+			 * Returns the number of tasks waiting in the work queue
+			 */
+			size_t getQueueSize();
+
+			/**
+			 * Returns the number of tasks that have finished running on the pool's workers
+			 */
+			unsigned long getCompletedTaskCount();
+
+		private:
+			/**
+			 * Queues the future, applying the rejection policy if the queue is full
+			 */
+			void enqueue( Future* future ) noexcept( false );
+
+			/**
+			 * Removes a cancelled future from the work queue. Called by Future::cancel().
+			 */
+			void remove( Future* future );
+
+			/**
+			 * Blocks the calling worker until a task can be started, or the pool is shut down.
+			 *
+			 * @return the started future, or NULL if the worker should terminate
+			 */
+			Future* takeTask( Thread* worker );
+
+			/**
+			 * Cancels a future that was taken off the queue without being run, deleting it if
+			 * the executor owns it
+			 */
+			void discard( Future* future );
+
+			/**
+			 * Worker thread main loop
+			 */
+			virtual void run();
+
+		//----------------------------------------------------------
+		//                     STATIC METHODS
+		//----------------------------------------------------------
+
+		friend class Future;
+	};
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <atomic>
+
+#include "syscommon/Platform.h"
+#include "syscommon/concurrent/Event.h"
+
+namespace syscommon
+{
+	/**
+	 * How a thread waits on a WaitStrategy for the other side of a lock-free structure to make
+	 * progress
+	 *
+	 * <ul>
+	 * 	<li>WP_SPIN busy-waits on the CPU. It reacts the fastest, but burns a whole core while it
+	 * 	waits and should only be used by threads that have a core to themselves</li>
+	 * 	<li>WP_YIELD spins for a short while and then yields the CPU to other threads between
+	 * 	checks</li>
+	 * 	<li>WP_PARK spins, then yields, and then puts the thread to sleep on an Event until it is
+	 * 	signaled, so that an idle thread costs nothing</li>
+	 * </ul>
+	 *
+	 * Only WP_PARK makes signal() do any work.
+	 */
+	enum WaitPolicy
+	{
+		WP_SPIN,
+		WP_YIELD,
+		WP_PARK
+	};
+
+	/**
+	 * The blocking half of a lock-free structure such as a SpscRingBuffer. A thread that cannot
+	 * make progress waits on the strategy through a Waiter, checking its condition again each time
+	 * the Waiter returns from idle(), and the thread that changes the condition calls signal().
+	 *
+	 * eg:
+	 *
+	 * WaitStrategy::Waiter waiter( this->notEmpty );
+	 * while( !this->poll(element) )
+	 *     waiter.idle();
+	 *
+	 * ...
+	 *
+	 * // On the producing thread, after publishing
+	 * this->notEmpty.signal();
+	 *
+	 * A parked Waiter registers itself before it checks its condition for the last time, and
+	 * signal() only touches the Event when a Waiter is registered, so signaling a strategy that
+	 * nobody is parked on costs a memory fence and a load. When several threads park on the same
+	 * strategy, one of them may clear the Event before another has seen it; a parked thread
+	 * therefore never sleeps for longer than MAX_PARK_MILLIS before checking again.
+	 */
+	class WaitStrategy
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+		public:
+			// Number of idle() calls that spin before a WP_YIELD or WP_PARK waiter backs off
+			static const unsigned int SPIN_TRIES = 100;
+
+			// Number of idle() calls that yield before a WP_PARK waiter parks
+			static const unsigned int YIELD_TRIES = 50;
+
+			static const unsigned long MAX_PARK_MILLIS = 10;
+
+			/**
+			 * One thread's wait on a WaitStrategy. A Waiter is created on the stack for each
+			 * wait, and any registration it holds with the strategy is dropped when it goes out of
+			 * scope.
+			 */
+			class Waiter
+			{
+				private:
+					WaitStrategy& strategy;
+					unsigned int attempts;
+					bool registered;
+					unsigned int generation;
+
+				public:
+					Waiter( WaitStrategy& strategy );
+					~Waiter();
+
+				private:
+					// Not copyable
+					Waiter( const Waiter& );
+					Waiter& operator=( const Waiter& );
+
+				public:
+					/**
+					 * Backs off once, according to the strategy's policy, after the condition
+					 * being waited for was found not to hold. The condition should be checked
+					 * again after each call.
+					 */
+					void idle();
+
+				private:
+					void park();
+			};
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			WaitPolicy policy;
+
+			// Number of Waiters that are parked, or about to park
+			std::atomic<unsigned int> parked;
+
+			// Moved on by every signal() that found a parked Waiter
+			std::atomic<unsigned int> generation;
+			Event parkEvent;
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Creates a strategy that waits according to the given policy
+			 */
+			WaitStrategy( WaitPolicy policy );
+			virtual ~WaitStrategy();
+
+		private:
+			// Not copyable
+			WaitStrategy( const WaitStrategy& );
+			WaitStrategy& operator=( const WaitStrategy& );
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Wakes any thread that is parked on this strategy. Must be called after every change
+			 * that a waiting thread may be waiting for.
+			 */
+			void signal()
+			{
+				if( this->policy == WP_PARK )
+					this->signalParked();
+			}
+
+			/**
+			 * Returns the policy this strategy was created with
+			 */
+			WaitPolicy getPolicy() const;
+
+		private:
+			void signalParked();
+
+		//----------------------------------------------------------
+		//                     STATIC METHODS
+		//----------------------------------------------------------
+	};
+}
@@ -0,0 +1,260 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development
+ * and Distribution License (the "License"). You may not use this file except in
+ * compliance with the License. You can obtain a copy of the license at
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License
+ * for the specific language governing permissions and limitations under the
+ * License.
+ *
+ * When distributing Covered Code, include this CDDL HEADER in each file and
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields
+ * enclosed by brackets "[]" replaced with your own identifying information:
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <atomic>
+#include <vector>
+
+#include "syscommon/Platform.h"
+
+namespace syscommon
+{
+	/**
+	 * A lock-free, growable work-stealing deque after Chase and Lev ("Dynamic Circular
+	 * Work-Stealing Deque", SPAA 2005), using the memory orderings given by Le et al. ("Correct and
+	 * Efficient Work-Stealing for Weak Memory Models", PPoPP 2013).
+	 *
+	 * The deque has a single owner thread, which may call push() and take() to work on the bottom
+	 * of the deque in LIFO order. Any number of other threads may call steal() concurrently to
+	 * remove elements from the top of the deque in FIFO order.
+	 *
+	 * When the deque grows, the previous buffer is kept until the deque is destroyed, as a thief
+	 * may still be reading from it. Since buffers double in size, the retained memory is bounded
+	 * by the size of the current buffer.
+	 *
+	 * The deque stores pointers only and never takes ownership of the elements.
+	 */
+	template<typename T>
+	class WorkStealingDeque
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+		public:
+			static const long DEFAULT_CAPACITY = 256;
+
+		private:
+			struct Buffer
+			{
+				long capacity;
+				long mask;
+				std::atomic<T*>* slots;
+
+				Buffer( long capacity ) : capacity( capacity ), mask( capacity - 1 )
+				{
+					this->slots = new std::atomic<T*>[capacity];
+				}
+
+				~Buffer()
+				{
+					delete [] this->slots;
+				}
+
+				T* get( long index ) const
+				{
+					return this->slots[index & this->mask].load( std::memory_order_relaxed );
+				}
+
+				void put( long index, T* element )
+				{
+					this->slots[index & this->mask].store( element, std::memory_order_relaxed );
+				}
+			};
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			// Top and bottom are written by different threads, so keep them on separate cache
+			// lines to avoid the owner and the thieves invalidating each other
+			std::atomic<long> top;
+			char topPadding[64 - sizeof(std::atomic<long>)];
+			std::atomic<long> bottom;
+			char bottomPadding[64 - sizeof(std::atomic<long>)];
+
+			std::atomic<Buffer*> buffer;
+			std::vector<Buffer*> retiredBuffers;
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Creates an empty deque with the DEFAULT_CAPACITY
+			 */
+			WorkStealingDeque() : top( 0 ), bottom( 0 )
+			{
+				this->buffer.store( new Buffer(DEFAULT_CAPACITY), std::memory_order_relaxed );
+			}
+
+			/**
+			 * Creates an empty deque with the given initial capacity, rounded up to a power of two
+			 *
+			 * @param initialCapacity the number of elements the deque can hold before growing
+			 */
+			WorkStealingDeque( long initialCapacity ) : top( 0 ), bottom( 0 )
+			{
+				long capacity = 2;
+				while( capacity < initialCapacity )
+					capacity <<= 1;
+
+				this->buffer.store( new Buffer(capacity), std::memory_order_relaxed );
+			}
+
+			virtual ~WorkStealingDeque()
+			{
+				delete this->buffer.load( std::memory_order_relaxed );
+
+				typename std::vector<Buffer*>::iterator it = this->retiredBuffers.begin();
+				for( ; it != this->retiredBuffers.end(); ++it )
+					delete *it;
+			}
+
+		private:
+			// Not copyable
+			WorkStealingDeque( const WorkStealingDeque& );
+			WorkStealingDeque& operator=( const WorkStealingDeque& );
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Pushes an element onto the bottom of the deque. Must only be called by the owner.
+			 *
+			 * @param element the element to push, must not be NULL
+			 */
+			void push( T* element )
+			{
+				long b = this->bottom.load( std::memory_order_relaxed );
+				long t = this->top.load( std::memory_order_acquire );
+				Buffer* current = this->buffer.load( std::memory_order_relaxed );
+
+				if( b - t > current->capacity - 1 )
+					current = this->grow( current, t, b );
+
+				current->put( b, element );
+				std::atomic_thread_fence( std::memory_order_release );
+				this->bottom.store( b + 1, std::memory_order_relaxed );
+			}
+
+			/**
+			 * Removes the element at the bottom of the deque (the most recently pushed). Must only
+			 * be called by the owner.
+			 *
+			 * @return the element, or NULL if the deque is empty
+			 */
+			T* take()
+			{
+				long b = this->bottom.load( std::memory_order_relaxed ) - 1;
+				Buffer* current = this->buffer.load( std::memory_order_relaxed );
+				this->bottom.store( b, std::memory_order_relaxed );
+				std::atomic_thread_fence( std::memory_order_seq_cst );
+				long t = this->top.load( std::memory_order_relaxed );
+
+				T* element = NULL;
+				if( t <= b )
+				{
+					element = current->get( b );
+					if( t == b )
+					{
+						// Last element, so race any thieves for it
+						if( !this->top.compare_exchange_strong(t,
+						                                       t + 1,
+						                                       std::memory_order_seq_cst,
+						                                       std::memory_order_relaxed) )
+						{
+							element = NULL;
+						}
+
+						this->bottom.store( b + 1, std::memory_order_relaxed );
+					}
+				}
+				else
+				{
+					// Empty
+					this->bottom.store( b + 1, std::memory_order_relaxed );
+				}
+
+				return element;
+			}
+
+			/**
+			 * Removes the element at the top of the deque (the least recently pushed). May be
+			 * called by any thread.
+			 *
+			 * @return the element, or NULL if the deque was empty or another thread won the race
+			 *         for the top element
+			 */
+			T* steal()
+			{
+				long t = this->top.load( std::memory_order_acquire );
+				std::atomic_thread_fence( std::memory_order_seq_cst );
+				long b = this->bottom.load( std::memory_order_acquire );
+
+				T* element = NULL;
+				if( t < b )
+				{
+					Buffer* current = this->buffer.load( std::memory_order_acquire );
+					element = current->get( t );
+					if( !this->top.compare_exchange_strong(t,
+					                                       t + 1,
+					                                       std::memory_order_seq_cst,
+					                                       std::memory_order_relaxed) )
+					{
+						element = NULL;
+					}
+				}
+
+				return element;
+			}
+
+			/**
+			 * Returns an estimate of the number of elements in the deque. The value is exact when
+			 * called by the owner while no thieves are active.
+			 */
+			long size() const
+			{
+				long b = this->bottom.load( std::memory_order_relaxed );
+				long t = this->top.load( std::memory_order_relaxed );
+				return b > t ? b - t : 0;
+			}
+
+			/**
+			 * Returns true if the deque appeared empty at the time of the call
+			 */
+			bool isEmpty() const
+			{
+				return this->size() == 0;
+			}
+
+		private:
+			Buffer* grow( Buffer* current, long t, long b )
+			{
+				Buffer* larger = new Buffer( current->capacity * 2 );
+				for( long i = t ; i < b ; ++i )
+					larger->put( i, current->get(i) );
+
+				this->retiredBuffers.push_back( current );
+				this->buffer.store( larger, std::memory_order_release );
+				return larger;
+			}
+
+		//----------------------------------------------------------
+		//                     STATIC METHODS
+		//----------------------------------------------------------
+	};
+}
@@ -18,6 +18,7 @@
 #include <string>
 
 #include "syscommon/Exception.h"
+#include "syscommon/Platform.h"
 
 namespace syscommon
 {
@@ -92,6 +93,13 @@ namespace syscommon
 			size_t getLength();
 			const char* getData();
 
+			/**
+			 * Returns a segment over the data written so far, which stays valid until the buffer
+			 * is destroyed. Passing it to Socket::sendv() or Socket::sendAll(), along with the
+			 * segments that follow it, sends a framed message without copying it.
+			 */
+			BufferSegment toSegment();
+
 		private:
 			size_t getBytesRemaining();
 			/**
@@ -0,0 +1,189 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <string>
+
+#include "syscommon/Platform.h"
+#include "syscommon/net/DatagramPacket.h"
+#include "syscommon/net/ICompletionHandler.h"
+#include "syscommon/net/MulticastSocket.h"
+#include "syscommon/net/ServerSocket.h"
+#include "syscommon/net/Socket.h"
+
+namespace syscommon
+{
+	class CompletionEngine;
+
+	enum AsyncOperationType
+	{
+		AO_ACCEPT,
+		AO_RECEIVE,
+		AO_SEND,
+		AO_RECEIVE_FROM,
+		AO_SEND_TO
+	};
+
+	/**
+	 * An accept, send or receive started through a CompletionEngine, along with its outcome once
+	 * it has finished.
+	 *
+	 * Operations started with a completion handler belong to the engine, which deletes them once
+	 * the handler has been told about their last result. Operations started without one belong to
+	 * the caller, who waits for them with CompletionEngine::waitFor() and deletes them when they
+	 * are done. An operation must not be deleted while it is still in progress.
+	 */
+	class AsyncOperation
+	{
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			CompletionEngine* engine;
+			AsyncOperationType type;
+			ICompletionHandler* handler;
+			void* attachment;
+
+			Socket* socket;
+			ServerSocket* serverSocket;
+			MulticastSocket* multicastSocket;
+			DatagramPacket* packet;
+
+			char* buffer;
+			int length;
+			int fixedIndex;
+			bool selectBuffer;
+			bool multishot;
+
+			bool done;
+			bool more;
+			bool failed;
+			bool cancelRequested;
+			bool cancelled;
+			int result;
+			std::string error;
+			Socket* accepted;
+			int bufferId;
+
+			// Kept alive here for the kernel while a datagram is in flight
+			unsigned long long header[RingOperation::HEADER_SIZE / sizeof(unsigned long long)];
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		private:
+			AsyncOperation( CompletionEngine* engine,
+			                AsyncOperationType type,
+			                ICompletionHandler* handler,
+			                void* attachment );
+
+		public:
+			/**
+			 * Closes the accepted socket if it was never taken
+			 */
+			virtual ~AsyncOperation();
+
+		private:
+			// Not copyable
+			AsyncOperation( const AsyncOperation& );
+			AsyncOperation& operator=( const AsyncOperation& );
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			CompletionEngine* getEngine() const;
+			AsyncOperationType getType() const;
+			void* getAttachment() const;
+
+			/**
+			 * Returns the socket the operation was started on. Only the one that matches the type
+			 * of the operation is set, the others are NULL.
+			 */
+			Socket* getSocket() const;
+			ServerSocket* getServerSocket() const;
+			MulticastSocket* getMulticastSocket() const;
+
+			/**
+			 * Returns the packet of an AO_RECEIVE_FROM or AO_SEND_TO. A received packet has been
+			 * filled in with its length and sender by the time the operation is done.
+			 */
+			DatagramPacket* getPacket() const;
+
+			/**
+			 * Returns whether the operation has finished for good. A multishot operation is only
+			 * done once it has delivered its last result.
+			 */
+			bool isDone() const;
+
+			/**
+			 * Returns whether a multishot operation will deliver further results
+			 */
+			bool hasMore() const;
+
+			bool isMultishot() const;
+
+			/**
+			 * Returns whether the operation failed, in which case getError() says why
+			 */
+			bool isFailed() const;
+
+			/**
+			 * Returns whether the operation failed because it was cancelled
+			 */
+			bool isCancelled() const;
+
+			/**
+			 * Returns a description of the reason the operation failed, or an empty string
+			 */
+			const char* getError() const;
+
+			/**
+			 * Returns the number of bytes sent or received. A receive that returns 0 found the
+			 * connection closed by the other end.
+			 */
+			int getResult() const;
+
+			/**
+			 * Returns the connection an AO_ACCEPT accepted, or NULL if there is none. The caller
+			 * takes ownership of the socket, which is otherwise closed along with the operation
+			 * (or once the handler returns, for a multishot accept).
+			 */
+			Socket* takeAcceptedSocket();
+
+			/**
+			 * Returns the data a receive was placed in. For a multishot receive, this is one of
+			 * the engine's provided buffers, which is handed back to the engine when the handler
+			 * returns.
+			 */
+			char* getBuffer() const;
+
+			/**
+			 * Returns the provided buffer a multishot receive placed its data in, or -1
+			 */
+			int getBufferId() const;
+
+		private:
+			void fail( const std::string& reason );
+			void fail( const tchar* reason );
+
+		//----------------------------------------------------------
+		//                     STATIC METHODS
+		//----------------------------------------------------------
+
+			friend class CompletionEngine;
+	};
+}
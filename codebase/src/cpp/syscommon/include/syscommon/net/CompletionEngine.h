@@ -0,0 +1,451 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <deque>
+#include <set>
+#include <vector>
+
+#include "syscommon/Platform.h"
+#include "syscommon/Exception.h"
+#include "syscommon/net/AsyncOperation.h"
+#include "syscommon/net/DatagramPacket.h"
+#include "syscommon/net/ICompletionHandler.h"
+#include "syscommon/net/MulticastSocket.h"
+#include "syscommon/net/ServerSocket.h"
+#include "syscommon/net/Socket.h"
+
+namespace syscommon
+{
+	/**
+	 * Starts accepts, sends and receives without waiting for them, and reports them once they have
+	 * finished, after java.nio's asynchronous channels. Where a Selector says when a socket is
+	 * ready and leaves the call to the application, the engine hands the whole operation to the
+	 * kernel, so that a batch of them costs one system call to start and another to collect.
+	 *
+	 * eg: echo every connection without a thread for each
+	 *
+	 * engine.acceptMultishot( &server, &acceptHandler, NULL );
+	 * while( running )
+	 *     engine.poll();
+	 *
+	 * void AcceptHandler::completed( AsyncOperation& operation )
+	 * {
+	 *     Socket* client = operation.takeAcceptedSocket();
+	 *     if( client )
+	 *         engine.receiveMultishot( client, &echoHandler, client );
+	 *     if( !operation.hasMore() )
+	 *         engine.acceptMultishot( &server, this, NULL );
+	 * }
+	 *
+	 * Completions are delivered either to an ICompletionHandler, or, when no handler is given, by
+	 * waiting for the returned AsyncOperation with waitFor(), much like a Future.
+	 *
+	 * Operations are queued when they are started and handed to the kernel by the next submit()
+	 * or poll(), so that a burst of them is submitted together.
+	 *
+	 * On Linux 5.11 and later the engine is built on io_uring. Registered (fixed) buffers save the
+	 * kernel mapping the memory for each operation, multishot accepts keep accepting without
+	 * being started again, and multishot receives take a buffer from a pool provided up front only
+	 * once data has arrived, so that idle connections hold no memory. Multishot accepts need 5.19
+	 * and multishot receives 6.0; on older kernels they fail when they are started.
+	 *
+	 * Everywhere else, isNative() is false and the engine falls back to the sockets' own blocking
+	 * calls, which are made one after another by submit() and reported by poll(). Multishot
+	 * operations then deliver a single result. They can also end early on io_uring, when the
+	 * kernel runs out of provided buffers for example, so either way a multishot operation should
+	 * be started again once hasMore() is false.
+	 *
+	 * Sockets should be left in blocking mode, which io_uring does not need but the fallback does.
+	 * The buffers given to an operation must stay valid until it is done.
+	 *
+	 * An engine belongs to the thread that polls it. The only method that may be called from other
+	 * threads is wakeup().
+	 */
+	class CompletionEngine
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+		public:
+			// The number of operations that can be queued between two submits
+			static const unsigned int DEFAULT_QUEUE_DEPTH = 256;
+
+			// The most completions that one poll() delivers. Any others are delivered by the next.
+			static const size_t MAX_COMPLETIONS = 256;
+
+		private:
+			// The group that provided buffers are registered in
+			static const unsigned short BUFFER_GROUP = 0;
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			NATIVE_RING ring;
+			bool native;
+			bool open;
+
+			// Kept readable in the ring, so that another thread can cut a poll() short
+			NATIVE_SOCKET wakeupSocket;
+			unsigned long long wakeupBuffer;
+
+			// Everything that has been started and not yet delivered its last result
+			std::set<AsyncOperation*> pending;
+
+			// Without a ring, operations waiting to be performed by submit(), and those that
+			// have been and are waiting to be delivered by poll()
+			std::deque<AsyncOperation*> queued;
+			std::deque<AsyncOperation*> finished;
+
+			std::vector<char> fixedBuffers;
+			size_t fixedBufferSize;
+			unsigned int fixedBufferCount;
+			bool fixedRegistered;
+
+			std::vector<char> providedBuffers;
+			size_t providedBufferSize;
+			unsigned int providedBufferCount;
+			std::vector<unsigned short> freeBuffers;
+
+			std::vector<RingCompletion> completions;
+			unsigned long long failureCount;
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Creates an engine that can queue DEFAULT_QUEUE_DEPTH operations between submits
+			 *
+			 * @throws IOException if the engine could not be created
+			 */
+			CompletionEngine() noexcept( false );
+
+			/**
+			 * Creates an engine that can queue the given number of operations between submits.
+			 * Starting more than that submits the queue early.
+			 *
+			 * @throws IllegalArgumentException if the depth is 0
+			 * @throws IOException if the engine could not be created
+			 */
+			CompletionEngine( unsigned int queueDepth ) noexcept( false );
+
+			/**
+			 * Closes the engine, as for close()
+			 */
+			virtual ~CompletionEngine();
+
+		private:
+			void _CompletionEngine( unsigned int queueDepth ) noexcept( false );
+
+			// Not copyable
+			CompletionEngine( const CompletionEngine& );
+			CompletionEngine& operator=( const CompletionEngine& );
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Starts accepting one connection on a bound server socket. The connection is taken
+			 * from the finished operation with takeAcceptedSocket().
+			 *
+			 * @param server the socket to accept on, which remains owned by the caller
+			 * @param handler told when the operation has finished, or NULL to wait for it with
+			 *                waitFor()
+			 * @param attachment an object of the caller's choosing to attach to the operation
+			 *
+			 * @return the operation, which belongs to the engine if a handler was given and to the
+			 *         caller otherwise
+			 *
+			 * @throws SocketException if the socket is closed or not bound
+			 * @throws IllegalArgumentException if the socket is NULL
+			 * @throws IllegalStateException if the engine is closed
+			 * @throws IOException if the operation could not be queued
+			 */
+			AsyncOperation* accept( ServerSocket* server,
+			                        ICompletionHandler* handler,
+			                        void* attachment ) noexcept( false );
+
+			/**
+			 * As accept(), but keeps accepting connections and calling the handler with each of
+			 * them until it is cancelled or hasMore() is false
+			 *
+			 * @throws IllegalArgumentException if the handler is NULL
+			 */
+			AsyncOperation* acceptMultishot( ServerSocket* server,
+			                                 ICompletionHandler* handler,
+			                                 void* attachment ) noexcept( false );
+
+			/**
+			 * Starts receiving up to length bytes from a connected socket into the buffer, as for
+			 * Socket::receive()
+			 *
+			 * @throws SocketException if the socket is closed, not connected or shut down for input
+			 * @throws IllegalArgumentException if the socket or buffer is NULL, or the length is
+			 *                                  negative
+			 */
+			AsyncOperation* receive( Socket* socket,
+			                         char* buffer,
+			                         int length,
+			                         ICompletionHandler* handler,
+			                         void* attachment ) noexcept( false );
+
+			/**
+			 * Keeps receiving from a connected socket, calling the handler each time data
+			 * arrives, until it is cancelled, the connection is closed or hasMore() is false. Each
+			 * result is placed in one of the buffers given to provideBuffers(), which is handed
+			 * back once the handler returns.
+			 *
+			 * @throws IllegalArgumentException if the handler is NULL
+			 * @throws IllegalStateException if no buffers have been provided
+			 */
+			AsyncOperation* receiveMultishot( Socket* socket,
+			                                  ICompletionHandler* handler,
+			                                  void* attachment ) noexcept( false );
+
+			/**
+			 * Starts sending length bytes of the buffer through a connected socket, as for
+			 * Socket::send(). Fewer bytes than were asked for may be sent.
+			 *
+			 * @throws SocketException if the socket is closed, not connected or shut down for
+			 *                         output
+			 * @throws IllegalArgumentException if the socket or buffer is NULL, or the length is
+			 *                                  negative
+			 */
+			AsyncOperation* send( Socket* socket,
+			                      const char* buffer,
+			                      int length,
+			                      ICompletionHandler* handler,
+			                      void* attachment ) noexcept( false );
+
+			/**
+			 * As receive(), into one of the buffers allocated by registerBuffers()
+			 *
+			 * @param index the buffer to receive into
+			 * @param length the most bytes to receive, no more than the size of the buffer
+			 *
+			 * @throws IllegalArgumentException if there is no such buffer, or the length does not
+			 *                                  fit in it
+			 */
+			AsyncOperation* receiveFixed( Socket* socket,
+			                              unsigned int index,
+			                              int length,
+			                              ICompletionHandler* handler,
+			                              void* attachment ) noexcept( false );
+
+			/**
+			 * As send(), from one of the buffers allocated by registerBuffers()
+			 */
+			AsyncOperation* sendFixed( Socket* socket,
+			                           unsigned int index,
+			                           int length,
+			                           ICompletionHandler* handler,
+			                           void* attachment ) noexcept( false );
+
+			/**
+			 * Starts receiving a datagram into the packet, as for MulticastSocket::receive()
+			 *
+			 * @throws SocketException if the socket is closed
+			 * @throws IllegalArgumentException if the socket is NULL
+			 */
+			AsyncOperation* receive( MulticastSocket* socket,
+			                         DatagramPacket& packet,
+			                         ICompletionHandler* handler,
+			                         void* attachment ) noexcept( false );
+
+			/**
+			 * Starts sending the packet to the address in it, as for MulticastSocket::send()
+			 *
+			 * @throws SocketException if the socket is not bound, or the packet has no address
+			 * @throws IllegalArgumentException if the socket is NULL
+			 */
+			AsyncOperation* send( MulticastSocket* socket,
+			                      DatagramPacket& packet,
+			                      ICompletionHandler* handler,
+			                      void* attachment ) noexcept( false );
+
+			/**
+			 * Allocates count buffers of bufferSize bytes for receiveFixed() and sendFixed(), and
+			 * registers them with the kernel so that it need not map them for each operation. If
+			 * they cannot be registered they are still used, only without the saving.
+			 *
+			 * @throws IllegalArgumentException if the size or count is 0
+			 * @throws IllegalStateException if buffers have already been registered
+			 */
+			void registerBuffers( size_t bufferSize, unsigned int count ) noexcept( false );
+
+			/**
+			 * Returns one of the buffers allocated by registerBuffers()
+			 *
+			 * @throws IllegalArgumentException if there is no such buffer
+			 */
+			char* getFixedBuffer( unsigned int index ) noexcept( false );
+			size_t getFixedBufferSize() const;
+			unsigned int getFixedBufferCount() const;
+
+			/**
+			 * Allocates a pool of count buffers of bufferSize bytes for receiveMultishot() to
+			 * receive into. A multishot receive that finds the pool empty ends with an error.
+			 *
+			 * @throws IllegalArgumentException if the size or count is 0, or the count is more
+			 *                                  than 65535
+			 * @throws IllegalStateException if buffers have already been provided
+			 * @throws IOException if the buffers could not be handed to the kernel
+			 */
+			void provideBuffers( size_t bufferSize, unsigned int count ) noexcept( false );
+
+			/**
+			 * Asks for an operation to be cancelled. It is still reported as usual once it has
+			 * stopped, as failed and cancelled unless it managed to finish first.
+			 *
+			 * @return false if the operation is not in progress, or it can no longer be cancelled
+			 */
+			bool cancel( AsyncOperation* operation ) noexcept( false );
+
+			/**
+			 * Hands the operations queued since the last submit to the kernel, or performs them
+			 * if there is no ring
+			 *
+			 * @return the number of operations submitted
+			 *
+			 * @throws IOException if the operations could not be submitted
+			 * @throws IllegalStateException if the engine is closed
+			 */
+			int submit() noexcept( false );
+
+			/**
+			 * Submits any queued operations, then waits until at least one operation finishes or
+			 * wakeup() is called, and delivers the completions to their handlers
+			 *
+			 * @return the number of completions delivered, which may be 0 if the wait was
+			 *         woken or interrupted
+			 *
+			 * @throws IOException if the wait failed
+			 * @throws IllegalStateException if the engine is closed
+			 */
+			int poll() noexcept( false );
+
+			/**
+			 * As poll(), waiting no longer than the given number of milliseconds
+			 */
+			int poll( unsigned long timeout ) noexcept( false );
+
+			/**
+			 * As poll(), without waiting
+			 */
+			int pollNow() noexcept( false );
+
+			/**
+			 * Polls the engine until an operation that was started without a handler is done, or
+			 * the timeout passes. Completions of other operations are delivered along the way.
+			 *
+			 * @return true if the operation is done
+			 *
+			 * @throws IllegalArgumentException if the operation is NULL, has a handler or does not
+			 *                                  belong to the engine
+			 */
+			bool waitFor( AsyncOperation* operation, unsigned long timeout ) noexcept( false );
+
+			/**
+			 * Makes the poll() in progress return straight away, or the next one if there is none
+			 * in progress. May be called from any thread.
+			 */
+			void wakeup();
+
+			/**
+			 * Returns whether operations are handed to io_uring, rather than performed with
+			 * blocking calls
+			 */
+			bool isNative() const;
+
+			/**
+			 * Returns the number of operations that are yet to deliver their last result
+			 */
+			size_t getPendingCount() const;
+
+			/**
+			 * Returns the number of exceptions thrown from completion handlers
+			 */
+			unsigned long long getFailureCount() const;
+
+			/**
+			 * Cancels everything in progress and releases the engine's resources. Handlers are not
+			 * told about the cancelled operations; those that belong to the engine are deleted,
+			 * and those that belong to the caller are marked as done and failed. Has no effect if
+			 * the engine is already closed.
+			 */
+			void close();
+
+			bool isOpen() const;
+
+		private:
+			AsyncOperation* startAccept( ServerSocket* server,
+			                             bool multishot,
+			                             ICompletionHandler* handler,
+			                             void* attachment ) noexcept( false );
+			AsyncOperation* startTransfer( Socket* socket,
+			                               AsyncOperationType type,
+			                               char* buffer,
+			                               int length,
+			                               ICompletionHandler* handler,
+			                               void* attachment ) noexcept( false );
+			AsyncOperation* startDatagram( MulticastSocket* socket,
+			                               AsyncOperationType type,
+			                               DatagramPacket& packet,
+			                               ICompletionHandler* handler,
+			                               void* attachment ) noexcept( false );
+
+			/**
+			 * Queues a new operation, deleting it if that fails
+			 */
+			void start( AsyncOperation* operation ) noexcept( false );
+			RingOperation toRingOperation( AsyncOperation* operation );
+			void queueOperation( const RingOperation& operation ) noexcept( false );
+			void armWakeup() noexcept( false );
+
+			/**
+			 * Performs an operation with a blocking call, for when there is no ring
+			 */
+			void perform( AsyncOperation* operation );
+
+			/**
+			 * Fills in an operation from a completion the ring reported
+			 */
+			bool complete( const RingCompletion& completion );
+
+			/**
+			 * Hands a finished result to the operation's handler, or marks it as done for a
+			 * caller waiting on it
+			 */
+			void deliver( AsyncOperation* operation );
+
+			/**
+			 * Frees whatever the handler left in an operation, before its next result
+			 */
+			void release( AsyncOperation* operation );
+			void recycleBuffer( unsigned short bufferId );
+
+			/**
+			 * Ends an operation that will never be delivered, when the engine closes
+			 */
+			void abandon( AsyncOperation* operation );
+
+			void checkOpen() const noexcept( false );
+			void checkConnected( Socket* socket ) const noexcept( false );
+	};
+}
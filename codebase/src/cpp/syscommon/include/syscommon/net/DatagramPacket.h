@@ -46,6 +46,7 @@ namespace syscommon
 			int offset;
 			int length;
 			int bufferLength;
+			int segmentSize;
 
 		//----------------------------------------------------------
 		//                      CONSTRUCTORS
@@ -156,6 +157,16 @@ namespace syscommon
 			 */
 			void setLength( int length );
 
+			/**
+			 * Sets the size of the datagrams that the data is sent as. A packet with a segment
+			 * size smaller than its length goes out as a run of datagrams of that many bytes, the
+			 * last holding whatever is left, for the cost of sending one (see
+			 * MulticastSocket::send()). 0, the default, sends the data as a single datagram.
+			 *
+			 * @param segmentSize the number of bytes in each datagram, or 0
+			 */
+			void setSegmentSize( int segmentSize );
+
 			/**
 			 * Returns the data buffer. The data received or the data to be sent
 			 * starts from the offset in the buffer, and runs for length long.
@@ -189,6 +200,13 @@ namespace syscommon
 			 */
 			int getBufferLength() const;
 
+			/**
+			 * Returns the size of the datagrams that the data is sent as, or, once received on a
+			 * socket with receive offload enabled, the size of the datagrams that were coalesced
+			 * into it. 0 if the data is a single datagram.
+			 */
+			int getSegmentSize() const;
+
 			/**
 			 * Returns the IP address of the machine to which this datagram is being
 			 * sent or from which the datagram was received.
@@ -0,0 +1,500 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <atomic>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "syscommon/Platform.h"
+#include "syscommon/Exception.h"
+#include "syscommon/concurrent/Lock.h"
+#include "syscommon/concurrent/Thread.h"
+#include "syscommon/net/AsyncOperation.h"
+#include "syscommon/net/CompletionEngine.h"
+#include "syscommon/net/ICompletionHandler.h"
+#include "syscommon/net/ServerSocket.h"
+#include "syscommon/net/Socket.h"
+
+#ifdef SYSCOMMON_HAS_COROUTINES
+#include <coroutine>
+#include "syscommon/concurrent/Task.h"
+#endif
+
+namespace syscommon
+{
+	class TaskRunner;
+	class SocketAwaitable;
+	class SleepAwaitable;
+
+	/**
+	 * Runs coroutines on a single thread, resuming each one when the socket operation, timer or
+	 * event it is waiting for has finished. Sockets are driven through a CompletionEngine, so
+	 * however many coroutines are suspended, the loop makes one system call to start a batch of
+	 * operations and another to collect them, and a suspended coroutine costs only its frame.
+	 *
+	 * eg: an echo server, with a coroutine for each connection
+	 *
+	 * Task<void> echo( Socket* client )
+	 * {
+	 *     char buffer[512];
+	 *     int received;
+	 *     while( (received = co_await client->receiveAsync(buffer, sizeof(buffer))) > 0 )
+	 *         co_await client->sendAsync( buffer, received );
+	 *
+	 *     delete client;
+	 * }
+	 *
+	 * Task<void> serve( ServerSocket* server )
+	 * {
+	 *     while( true )
+	 *         EventLoop::current()->spawn( echo(co_await server->acceptAsync()) );
+	 * }
+	 *
+	 * EventLoop loop;
+	 * loop.spawn( serve(&server) );
+	 *
+	 * Thread thread( &loop );
+	 * thread.start();
+	 *
+	 * The loop runs in run(), normally on a Thread of its own as above, until stop() is called.
+	 * The awaitables (Socket::receiveAsync(), Socket::sendAsync(), ServerSocket::acceptAsync(),
+	 * sleepFor() and AsyncEvent::waitAsync()) work with the loop running on the current thread,
+	 * so coroutines must only await them once the loop has resumed them. A failed send, receive
+	 * or accept throws a SocketException out of the co_await.
+	 *
+	 * The coroutine parts are only available when compiling as C++20, when
+	 * SYSCOMMON_HAS_COROUTINES is defined. Without them, the loop still runs IRunnables that are
+	 * posted or scheduled on it, alongside operations started on its engine.
+	 *
+	 * Everything other than post(), spawn() and stop() must be called on the loop's own thread.
+	 */
+	class EventLoop : public IRunnable
+	{
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			CompletionEngine engine;
+			std::atomic<bool> stopped;
+
+			// Set while the loop is, or is about to be, waiting on its engine, so that post()
+			// knows it has to wake it
+			std::atomic<bool> sleeping;
+
+			// Resumptions due on the loop's thread, run on its next turn
+			std::deque<IRunnable*> ready;
+
+			// Keyed by the Platform::nanoTime() at which each is due
+			std::multimap<long long,IRunnable*> timers;
+
+			// Posted from other threads
+			Lock inboxLock;
+			std::vector<IRunnable*> inbox;
+
+			// Spawned tasks, which belong to the loop, and those that have finished and are
+			// deleted at the end of the turn
+			std::set<IRunnable*> tasks;
+			std::vector<IRunnable*> retired;
+
+			std::atomic<unsigned long long> failureCount;
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Creates a loop whose engine can queue CompletionEngine::DEFAULT_QUEUE_DEPTH
+			 * operations between submits
+			 *
+			 * @throws IOException if the engine could not be created
+			 */
+			EventLoop() noexcept( false );
+
+			/**
+			 * Creates a loop whose engine can queue the given number of operations between
+			 * submits
+			 *
+			 * @throws IllegalArgumentException if the depth is 0
+			 * @throws IOException if the engine could not be created
+			 */
+			EventLoop( unsigned int queueDepth ) noexcept( false );
+
+			/**
+			 * Closes the engine and destroys any spawned tasks that have not finished. The loop
+			 * must not be running.
+			 */
+			virtual ~EventLoop();
+
+		private:
+			// Not copyable
+			EventLoop( const EventLoop& );
+			EventLoop& operator=( const EventLoop& );
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Runs the loop on the calling thread until stop() is called. Returns straight away
+			 * if the loop has already been stopped.
+			 */
+			virtual void run();
+
+			/**
+			 * Makes run() return once it has finished its current turn. May be called from any
+			 * thread, and before the loop has started. A stopped loop cannot be run again.
+			 */
+			void stop();
+
+			bool isStopped() const;
+
+			/**
+			 * Queues a task to run on the loop's thread, waking the loop if it is waiting. May be
+			 * called from any thread. Tasks run in the order they were posted.
+			 *
+			 * @param task the task to run, which remains owned by the caller and must stay valid
+			 *             until it has run
+			 */
+			void post( IRunnable* task );
+
+			/**
+			 * Runs a task on the loop's next turn, without the locking that post() needs
+			 */
+			void defer( IRunnable* task );
+
+			/**
+			 * Runs a task on the loop's thread once the given number of milliseconds have passed
+			 */
+			void schedule( unsigned long delay, IRunnable* task );
+
+			/**
+			 * Returns the engine that the loop polls, for starting operations directly
+			 */
+			CompletionEngine& getEngine();
+
+			/**
+			 * Returns the number of spawned tasks that have not finished
+			 */
+			size_t getTaskCount();
+
+			/**
+			 * Returns the number of exceptions thrown from tasks run by the loop, including
+			 * spawned tasks that ended by throwing
+			 */
+			unsigned long long getFailureCount() const;
+
+#ifdef SYSCOMMON_HAS_COROUTINES
+			/**
+			 * Starts a coroutine on the loop, which deletes it once it finishes. May be called
+			 * from any thread. The coroutine first runs on the loop's next turn.
+			 */
+			void spawn( Task<void> task );
+#endif
+
+		private:
+			/**
+			 * Takes ownership of a spawned task and queues it to start
+			 */
+			void adopt( IRunnable* task );
+
+			/**
+			 * Deletes a spawned task that has finished, once the turn is over
+			 */
+			void retire( IRunnable* task );
+
+			void runTasks( std::vector<IRunnable*>& tasks );
+			void runTask( IRunnable* task );
+
+			/**
+			 * Returns how long the engine can wait before the next timer is due
+			 */
+			unsigned long getWaitTime() const;
+
+		//----------------------------------------------------------
+		//                     STATIC METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Returns the loop running on the calling thread, or NULL if there is none
+			 */
+			static EventLoop* current();
+
+#ifdef SYSCOMMON_HAS_COROUTINES
+			/**
+			 * Returns an awaitable that resumes the awaiting coroutine, on the current thread's
+			 * loop, once the given number of milliseconds have passed
+			 *
+			 * @throws IllegalStateException if there is no loop running on the current thread
+			 */
+			static SleepAwaitable sleepFor( unsigned long milliseconds ) noexcept( false );
+#endif
+
+		private:
+			static EventLoop* requireCurrent() noexcept( false );
+
+			friend class TaskRunner;
+			friend class SocketAwaitable;
+	};
+
+#ifdef SYSCOMMON_HAS_COROUTINES
+	/**
+	 * Owns a spawned task on behalf of its loop, and hands itself back to the loop to be deleted
+	 * once the task has finished
+	 */
+	class TaskRunner : public IRunnable
+	{
+		private:
+			EventLoop* loop;
+			Task<void> driver;
+
+		public:
+			TaskRunner( EventLoop* loop, Task<void> task ) : loop( loop )
+			{
+				this->driver = TaskRunner::drive( this, std::move(task) );
+			}
+
+			virtual void run()
+			{
+				this->driver.start();
+			}
+
+		private:
+			static Task<void> drive( TaskRunner* runner, Task<void> task )
+			{
+				try
+				{
+					co_await task;
+				}
+				catch( ... )
+				{
+					++runner->loop->failureCount;
+				}
+
+				runner->loop->retire( runner );
+			}
+	};
+
+	/**
+	 * What the socket awaitables have in common. Each starts its operation on the loop's engine
+	 * when the coroutine suspends, and resumes the coroutine on the loop's next turn after the
+	 * operation finishes, rather than from within CompletionEngine::poll().
+	 */
+	class SocketAwaitable : public ICompletionHandler, public IRunnable
+	{
+		protected:
+			EventLoop* loop;
+			std::coroutine_handle<> handle;
+			int result;
+			bool failed;
+			std::string error;
+
+		public:
+			SocketAwaitable() noexcept( false ) :
+				loop( EventLoop::requireCurrent() ), handle(), result( 0 ), failed( false )
+			{
+			}
+
+			bool await_ready() noexcept
+			{
+				return false;
+			}
+
+			virtual void completed( AsyncOperation& operation )
+			{
+				this->result = operation.getResult();
+				this->failed = operation.isFailed();
+				if( this->failed )
+					this->error = operation.getError();
+
+				this->loop->defer( this );
+			}
+
+			virtual void run()
+			{
+				this->handle.resume();
+			}
+
+		protected:
+			void checkFailed() noexcept( false )
+			{
+				if( this->failed )
+					throw SocketException( Platform::toPlatformString(this->error.c_str()).c_str() );
+			}
+	};
+
+	/**
+	 * Returned by Socket::receiveAsync(). Awaiting it gives the number of bytes received, which is
+	 * 0 once the other end has closed the connection.
+	 */
+	class ReceiveAwaitable : public SocketAwaitable
+	{
+		private:
+			Socket* socket;
+			char* buffer;
+			int length;
+
+		public:
+			ReceiveAwaitable( Socket* socket, char* buffer, int length ) noexcept( false ) :
+				socket( socket ), buffer( buffer ), length( length )
+			{
+			}
+
+			void await_suspend( std::coroutine_handle<> handle ) noexcept( false )
+			{
+				this->handle = handle;
+				this->loop->getEngine().receive( this->socket, this->buffer, this->length, this, NULL );
+			}
+
+			int await_resume() noexcept( false )
+			{
+				this->checkFailed();
+				return this->result;
+			}
+	};
+
+	/**
+	 * Returned by Socket::sendAsync(). Awaiting it gives the number of bytes sent, which may be
+	 * fewer than were asked for.
+	 */
+	class SendAwaitable : public SocketAwaitable
+	{
+		private:
+			Socket* socket;
+			const char* buffer;
+			int length;
+
+		public:
+			SendAwaitable( Socket* socket, const char* buffer, int length ) noexcept( false ) :
+				socket( socket ), buffer( buffer ), length( length )
+			{
+			}
+
+			void await_suspend( std::coroutine_handle<> handle ) noexcept( false )
+			{
+				this->handle = handle;
+				this->loop->getEngine().send( this->socket, this->buffer, this->length, this, NULL );
+			}
+
+			int await_resume() noexcept( false )
+			{
+				this->checkFailed();
+				return this->result;
+			}
+	};
+
+	/**
+	 * Returned by ServerSocket::acceptAsync(). Awaiting it gives the accepted connection, which
+	 * the awaiting coroutine then owns.
+	 */
+	class AcceptAwaitable : public SocketAwaitable
+	{
+		private:
+			ServerSocket* server;
+			Socket* accepted;
+
+		public:
+			AcceptAwaitable( ServerSocket* server ) noexcept( false ) :
+				server( server ), accepted( NULL )
+			{
+			}
+
+			void await_suspend( std::coroutine_handle<> handle ) noexcept( false )
+			{
+				this->handle = handle;
+				this->loop->getEngine().accept( this->server, this, NULL );
+			}
+
+			virtual void completed( AsyncOperation& operation )
+			{
+				// The socket is closed along with the operation unless it is taken now
+				this->accepted = operation.takeAcceptedSocket();
+				SocketAwaitable::completed( operation );
+			}
+
+			Socket* await_resume() noexcept( false )
+			{
+				this->checkFailed();
+				return this->accepted;
+			}
+	};
+
+	/**
+	 * Returned by EventLoop::sleepFor()
+	 */
+	class SleepAwaitable : public IRunnable
+	{
+		private:
+			EventLoop* loop;
+			unsigned long milliseconds;
+			std::coroutine_handle<> handle;
+
+		public:
+			SleepAwaitable( EventLoop* loop, unsigned long milliseconds ) :
+				loop( loop ), milliseconds( milliseconds ), handle()
+			{
+			}
+
+			bool await_ready() noexcept
+			{
+				return false;
+			}
+
+			void await_suspend( std::coroutine_handle<> handle )
+			{
+				this->handle = handle;
+				this->loop->schedule( this->milliseconds, this );
+			}
+
+			void await_resume() noexcept
+			{
+			}
+
+			virtual void run()
+			{
+				this->handle.resume();
+			}
+	};
+
+	inline void EventLoop::spawn( Task<void> task )
+	{
+		this->adopt( new TaskRunner(this, std::move(task)) );
+	}
+
+	inline SleepAwaitable EventLoop::sleepFor( unsigned long milliseconds ) noexcept( false )
+	{
+		return SleepAwaitable( EventLoop::requireCurrent(), milliseconds );
+	}
+
+	inline ReceiveAwaitable Socket::receiveAsync( char* buffer, int length ) noexcept( false )
+	{
+		return ReceiveAwaitable( this, buffer, length );
+	}
+
+	inline SendAwaitable Socket::sendAsync( const char* buffer, int length ) noexcept( false )
+	{
+		return SendAwaitable( this, buffer, length );
+	}
+
+	inline AcceptAwaitable ServerSocket::acceptAsync() noexcept( false )
+	{
+		return AcceptAwaitable( this );
+	}
+#endif
+}
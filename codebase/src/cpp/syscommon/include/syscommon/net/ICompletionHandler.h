@@ -0,0 +1,52 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include "syscommon/Platform.h"
+
+namespace syscommon
+{
+	class AsyncOperation;
+
+	/**
+	 * Told about operations started through a CompletionEngine as they finish. Every call is made
+	 * from CompletionEngine::poll(), on the thread that polls the engine.
+	 *
+	 * An exception thrown from completed() is counted against the engine and otherwise ignored,
+	 * so that one misbehaving operation cannot stop the completions of the others being delivered.
+	 */
+	class ICompletionHandler
+	{
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			virtual ~ICompletionHandler() {};
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Called when an operation has finished, successfully or not, and for each result of
+			 * a multishot operation. The operation, an accepted socket that has not been taken
+			 * from it and any provided buffer it received into are only valid until this returns.
+			 *
+			 * @param operation the operation that finished
+			 */
+			virtual void completed( AsyncOperation& operation ) = 0;
+	};
+}
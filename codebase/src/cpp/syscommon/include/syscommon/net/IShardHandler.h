@@ -0,0 +1,75 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include "syscommon/Platform.h"
+#include "syscommon/net/Socket.h"
+
+namespace syscommon
+{
+	class Shard;
+
+	/**
+	 * Serves the connections of a ShardedServer. Every method is called on the thread of the shard
+	 * it is given, so state that a handler keeps for each shard is only ever touched by one
+	 * thread and needs no locking. A single handler instance is shared by all of the shards.
+	 *
+	 * An exception thrown from a handler method is counted against the shard and otherwise
+	 * ignored, so that one misbehaving connection cannot stop the shard serving the others.
+	 */
+	class IShardHandler
+	{
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			virtual ~IShardHandler() {};
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Called once on each shard's thread before it accepts any connections
+			 */
+			virtual void onStart( Shard& shard ) {};
+
+			/**
+			 * Called when the shard has accepted a connection. The handler takes ownership of the
+			 * socket, and will usually pass it to Shard::watch() to be told when it has data.
+			 *
+			 * @param shard the shard that the connection belongs to
+			 * @param socket the connected socket, which the handler is responsible for deleting
+			 */
+			virtual void onAccept( Shard& shard, Socket* socket ) = 0;
+
+			/**
+			 * Called when a socket that is being watched by the shard has data to receive, or has
+			 * been closed by the other end, so that a receive() will not block
+			 *
+			 * @param shard the shard that is watching the socket
+			 * @param socket the readable socket
+			 */
+			virtual void onReadable( Shard& shard, Socket* socket ) {};
+
+			/**
+			 * Called once on each shard's thread when the server is stopping, after the shard has
+			 * stopped accepting connections. This is the place to close and delete the sockets
+			 * the handler still owns.
+			 */
+			virtual void onStop( Shard& shard ) {};
+	};
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include "syscommon/Platform.h"
+
+namespace syscommon
+{
+	/**
+	 * Told how a Socket::transferFrom() is getting on, after each piece of it has been sent. Large
+	 * transfers can use this to report progress, and to stop part way so that they can be resumed
+	 * later from where they got to.
+	 */
+	class ITransferListener
+	{
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			virtual ~ITransferListener() {};
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Called from the transferring thread each time more has been sent
+			 *
+			 * @param transferred the number of bytes sent so far by this transfer
+			 * @param expected the number of bytes the transfer is expected to send, or -1 if that
+			 *                 is not known in advance
+			 *
+			 * @return true to carry on, or false to stop the transfer here. A file transfer that
+			 *         was stopped can be resumed by starting another at the offset it began at plus
+			 *         the number of bytes transferred.
+			 */
+			virtual bool transferred( long long transferred, long long expected ) = 0;
+	};
+}
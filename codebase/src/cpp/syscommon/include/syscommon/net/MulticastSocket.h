@@ -23,6 +23,10 @@
 
 namespace syscommon
 {
+	class AsyncOperation;
+	class CompletionEngine;
+	class ICompletionHandler;
+
 	/**
 	 * A MulticastSocket is a UDP Datagram Socket, with capabilities for joining "groups" of other 
 	 * multicast hosts on the internet.
@@ -54,6 +58,8 @@ namespace syscommon
 			NATIVE_SOCKET nativeSocket;
 			Lock stateLock;
 			bool bound;
+			bool blocking;
+			bool receiveOffload;
 
 		//----------------------------------------------------------
 		//                      CONSTRUCTORS
@@ -159,26 +165,161 @@ namespace syscommon
 			 * This method blocks until a datagram is received. The length field of the datagram 
 			 * packet object will contain the length of the received message. If the message is 
 			 * longer than the packet's length, the message is truncated.
+			 *
+			 * In non-blocking mode the method returns straight away, leaving the packet untouched
+			 * if no datagram was waiting.
+			 *
+			 * With receive offload enabled, the packet may hold several datagrams from the same
+			 * sender back to back, each of the packet's segment size apart from the last.
 			 * 
 			 * @param packet the DatagramPacket into which to place the incoming data.
 			 *
+			 * @return true if a datagram was received. Always true in blocking mode.
+			 *
 			 * @throw IOException if the socket was closed before a packet could be received
 			 */
-			void receive( DatagramPacket& packet ) noexcept( false );
+			bool receive( DatagramPacket& packet ) noexcept( false );
 
 			/**
 			 * Sends a datagram packet from this socket. The DatagramPacket includes information 
 			 * indicating the data to be sent, its length, the IP address of the remote host,
 			 * and the port number on the remote host.
+			 *
+			 * A packet with a segment size is sent as a run of datagrams of that size. Where the
+			 * platform has UDP segmentation offload the kernel does the splitting, so that the
+			 * run costs about as much as sending one datagram; elsewhere the segments are sent
+			 * one at a time. A packet may be split into at most DatagramMessage::MAX_SEGMENTS.
 			 * 
 			 * @param packet the DatagramPacket to be sent.
 			 *
+			 * @return true if the packet was sent, or false if the socket is in non-blocking mode
+			 *         and its send buffer is full. Always true in blocking mode.
+			 *
 			 * @throw IOException if an I/O error occurs while sending the packet
+			 * @throw IllegalArgumentException if the segment size is too large, or splits the packet
+			 *                                 into too many segments
+			 */
+			bool send( DatagramPacket& packet ) noexcept( false );
+
+			/**
+			 * Receives up to count datagrams into the given packets, each of which is filled in as
+			 * for receive(). Where the platform has recvmmsg(), each DatagramMessage::MAX_BATCH
+			 * datagrams take a single system call rather than one each.
+			 *
+			 * Only the first datagram is waited for. Once it has arrived, the batch is made up
+			 * of whatever else is already waiting, so a batch is never held back for datagrams
+			 * that have yet to arrive.
+			 *
+			 * @param packets the packets to receive into, in order
+			 * @param count the number of packets
+			 * @param timeout how many milliseconds to wait for the first datagram, 0 not to wait
+			 *                or NATIVE_INFINITE_WAIT to wait for as long as it takes. A
+			 *                non-blocking socket never waits.
+			 *
+			 * @return the number of packets filled in, from the first, which is 0 if nothing
+			 *         arrived in time
+			 *
+			 * @throws SocketException if the socket is closed, or the receive failed
+			 * @throws IllegalArgumentException if the packets are NULL or the count is negative
+			 */
+			int receiveBatch( DatagramPacket* packets, int count, unsigned long timeout )
+				noexcept( false );
+
+			/**
+			 * Sends each of the packets to the address in it, as for send(). Where the platform has
+			 * sendmmsg(), each DatagramMessage::MAX_BATCH packets take a single system call rather
+			 * than one each.
+			 *
+			 * @param packets the packets to send, in order
+			 * @param count the number of packets
+			 *
+			 * @return the number of packets sent, from the first. Fewer than count are sent if the
+			 *         socket is in non-blocking mode and its send buffer fills, or if sending
+			 *         fails part way through, in which case the next send reports the failure.
+			 *
+			 * @throws SocketException if the socket is not bound, a packet has no address, or
+			 *                         the first packet could not be sent
+			 * @throws IllegalArgumentException if the packets are NULL or the count is negative
+			 */
+			int sendBatch( DatagramPacket* packets, int count ) noexcept( false );
+
+			/**
+			 * Sends the same data to each of the given destinations, as for sendBatch(). This
+			 * fans a message out to a list of unicast subscribers for the cost of one system call
+			 * per batch.
+			 *
+			 * @throws SocketException if the socket is not bound, a destination has no address,
+			 *                         or the first datagram could not be sent
+			 * @throws IllegalArgumentException if the buffer or destinations are NULL, or the
+			 *                                  length or count is negative
+			 */
+			int sendBatch( const char* buffer,
+			               int length,
+			               const InetSocketAddress* destinations,
+			               int count ) noexcept( false );
+
+			/**
+			 * Puts the socket into non-blocking mode, in which send() and receive() return
+			 * straight away instead of waiting. Non-blocking sockets are meant to be driven by a
+			 * Selector.
+			 *
+			 * @param block true to make operations block, false to make them return immediately
+			 *
+			 * @throws SocketException if the socket is closed
 			 */
-			void send( DatagramPacket& packet ) noexcept( false );
+			void configureBlocking( bool block ) noexcept( false );
+
+			/**
+			 * Returns whether send() and receive() block
+			 */
+			bool isBlocking() const;
+
+			/**
+			 * Lets the kernel coalesce a run of datagrams from the same sender into one receive
+			 * (UDP_GRO), which then reports the size they were on the packet's segment size.
+			 * Packets should be given buffers large enough for a run, of up to 64KB. Receives
+			 * through a CompletionEngine do not report the segment size, so this is only for
+			 * sockets read with receive() and receiveBatch().
+			 *
+			 * @throws SocketException if the socket is closed, or the platform does not support
+			 *                         receive offload
+			 */
+			void setReceiveOffload( bool enable ) noexcept( false );
+
+			/**
+			 * Returns whether receive offload has been enabled
+			 */
+			bool isReceiveOffload() const;
+
+			/**
+			 * Starts sending the packet through the given engine without waiting for it, as for
+			 * CompletionEngine::send()
+			 */
+			AsyncOperation* sendAsync( CompletionEngine& engine,
+			                           DatagramPacket& packet,
+			                           ICompletionHandler* handler,
+			                           void* attachment ) noexcept( false );
+
+			/**
+			 * Starts receiving a packet through the given engine without waiting for one, as for
+			 * CompletionEngine::receive()
+			 */
+			AsyncOperation* receiveAsync( CompletionEngine& engine,
+			                              DatagramPacket& packet,
+			                              ICompletionHandler* handler,
+			                              void* attachment ) noexcept( false );
 
 		private:
 			bool isCreated();
+
+			/**
+			 * Sends one batch for sendBatch()
+			 *
+			 * @throws SocketException if nothing could be sent and nothing was sent before
+			 */
+			int sendMessages( DatagramMessage* messages, int count, int alreadySent )
+				noexcept( false );
+
 			/**
 			 * @throws IOException
 			 */
@@ -191,5 +332,18 @@ namespace syscommon
 		//----------------------------------------------------------
 		//                     STATIC METHODS
 		//----------------------------------------------------------
+		private:
+			/**
+			 * Fills in a message to send the given packet
+			 *
+			 * @throws SocketException if the packet has no address
+			 * @throws IllegalArgumentException if the segment size is too large, or splits the packet
+			 *                                  into too many segments
+			 */
+			static void toMessage( const DatagramPacket& packet, DatagramMessage& message )
+				noexcept( false );
+
+			friend class Selector;
+			friend class CompletionEngine;
 	};
 }
@@ -0,0 +1,269 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <vector>
+
+#include "syscommon/Platform.h"
+#include "syscommon/Exception.h"
+#include "syscommon/net/MulticastSocket.h"
+#include "syscommon/net/ServerSocket.h"
+#include "syscommon/net/Socket.h"
+
+namespace syscommon
+{
+	class Selector;
+
+	/**
+	 * The registration of a socket with a Selector. The key holds the operations that the
+	 * application is interested in, the operations the socket was found ready for by the last
+	 * select(), and an attachment of the application's choosing, typically its per-connection
+	 * state.
+	 *
+	 * Keys for connected sockets also hold a write queue. write() sends what it can straight away
+	 * and queues the rest, and the selector sends the queue in the background as the socket
+	 * becomes writable. The queue is bounded, and refuses further writes while it is over its
+	 * limit, which is the signal for the application to stop producing for that connection.
+	 * Register interest in OP_WRITE to be told when the queue has drained and it may write again.
+	 *
+	 * A key is valid until it is cancelled or its selector is closed. Cancel the key before
+	 * closing or deleting its socket.
+	 *
+	 * Memory Management: Keys are owned by their Selector. A cancelled key is deleted by the next
+	 * select(), so a key that appears in the selected keys remains usable until then even if it
+	 * is cancelled along the way.
+	 */
+	class SelectionKey
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+		public:
+			// Operations, combined as a bit mask. The values are those of java.nio.
+			static const int OP_READ = 1 << 0;
+			static const int OP_WRITE = 1 << 2;
+			static const int OP_ACCEPT = 1 << 4;
+
+			static const size_t DEFAULT_WRITE_QUEUE_LIMIT = 1024 * 1024;
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			Selector* selector;
+			NATIVE_SOCKET nativeSocket;
+
+			// Exactly one of these is set
+			Socket* socket;
+			ServerSocket* serverSocket;
+			MulticastSocket* multicastSocket;
+
+			int interestOps;
+			int readyOps;
+			bool edgeTriggered;
+			bool valid;
+			void* attachment;
+
+			// Unsent data, from writeOffset to the end
+			std::vector<char> writeQueue;
+			size_t writeOffset;
+			size_t writeQueueLimit;
+
+			// The SocketEvents the poller is currently waiting for, which include SE_WRITE while
+			// the write queue has data whether or not the application is interested in OP_WRITE.
+			// 0 when the socket is not in the poller at all.
+			int registeredEvents;
+			bool registeredEdgeTriggered;
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		private:
+			/**
+			 * Keys are only created by a Selector
+			 */
+			SelectionKey( Selector* selector,
+			              NATIVE_SOCKET nativeSocket,
+			              int interestOps,
+			              void* attachment );
+
+			// Not copyable
+			SelectionKey( const SelectionKey& );
+			SelectionKey& operator=( const SelectionKey& );
+
+		public:
+			virtual ~SelectionKey();
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Returns the selector that this key was created by
+			 */
+			Selector& getSelector() const;
+
+			/**
+			 * Returns the registered socket if it is a Socket, otherwise NULL
+			 */
+			Socket* getSocket() const;
+
+			/**
+			 * Returns the registered socket if it is a ServerSocket, otherwise NULL
+			 */
+			ServerSocket* getServerSocket() const;
+
+			/**
+			 * Returns the registered socket if it is a MulticastSocket, otherwise NULL
+			 */
+			MulticastSocket* getMulticastSocket() const;
+
+			/**
+			 * Returns the operations that the selector is watching the socket for
+			 */
+			int getInterestOps() const;
+
+			/**
+			 * Changes the operations that the selector watches the socket for. Takes effect from
+			 * the next select().
+			 *
+			 * @param ops OP_ACCEPT for a ServerSocket, otherwise any combination of OP_READ and
+			 *            OP_WRITE, or 0 to stop watching the socket for now
+			 *
+			 * @throws IllegalArgumentException if the operations are not supported by the socket
+			 * @throws IllegalStateException if the key has been cancelled
+			 */
+			void setInterestOps( int ops ) noexcept( false );
+
+			/**
+			 * Returns the operations that the last select() found the socket ready for, or 0 if
+			 * it was not selected
+			 */
+			int getReadyOps() const;
+
+			bool isReadable() const;
+			bool isWritable() const;
+			bool isAcceptable() const;
+
+			/**
+			 * Returns whether readiness is reported when it changes rather than for as long as it
+			 * lasts
+			 */
+			bool isEdgeTriggered() const;
+
+			/**
+			 * Chooses between level triggered readiness, the default, where the socket is
+			 * selected for as long as it is ready, and edge triggered readiness, where it is only
+			 * selected when it becomes ready. An edge triggered socket must be read, or written,
+			 * until the operation would block before it will be selected again, which saves the
+			 * selector reporting the same idle connections over and over.
+			 *
+			 * Edge triggering is a saving rather than a guarantee. Where the platform does not
+			 * provide it, keys are level triggered, which selects them at least as often.
+			 *
+			 * @throws IllegalStateException if the key has been cancelled
+			 */
+			void setEdgeTriggered( bool edgeTriggered ) noexcept( false );
+
+			/**
+			 * Returns the attachment given at registration or by attach()
+			 */
+			void* getAttachment() const;
+
+			/**
+			 * Attaches an object of the application's choosing to the key, replacing any previous
+			 * attachment
+			 *
+			 * @return the previous attachment
+			 */
+			void* attach( void* attachment );
+
+			/**
+			 * Returns whether the key is still registered with its selector
+			 */
+			bool isValid() const;
+
+			/**
+			 * Removes the socket from its selector. Data still in the write queue is discarded.
+			 * Has no effect if the key is already cancelled.
+			 */
+			void cancel();
+
+			/**
+			 * Sends the given data on the key's Socket, queueing whatever cannot be sent straight
+			 * away to be sent by the selector once the socket is writable. Data is always sent in
+			 * the order it was written.
+			 *
+			 * A write is refused when data is already queued and adding this data would take the
+			 * queue over its limit. A write to an empty queue is always accepted, however large.
+			 *
+			 * @param buffer the data to send
+			 * @param length the number of bytes to send
+			 *
+			 * @return true if the data was sent or queued, false if the queue is full and nothing
+			 *         was written
+			 *
+			 * @throws IllegalStateException if the key has been cancelled, or is not for a Socket
+			 * @throws SocketException if the data could not be sent
+			 */
+			bool write( const char* buffer, size_t length ) noexcept( false );
+
+			/**
+			 * Sends as much of the write queue as the socket will take without blocking. The
+			 * selector does this itself whenever the socket is writable.
+			 *
+			 * @return true if the queue is now empty
+			 *
+			 * @throws SocketException if the data could not be sent
+			 */
+			bool flush() noexcept( false );
+
+			/**
+			 * Returns the number of bytes waiting in the write queue
+			 */
+			size_t getQueuedBytes() const;
+
+			/**
+			 * Returns the number of queued bytes over which write() refuses more data
+			 */
+			size_t getWriteQueueLimit() const;
+
+			/**
+			 * Sets the number of queued bytes over which write() refuses more data
+			 */
+			void setWriteQueueLimit( size_t limit );
+
+		private:
+			/**
+			 * Returns the SocketEvents that the poller should wait for
+			 */
+			int getPollEvents() const;
+
+			/**
+			 * Works out the ready operations from the SocketEvents the poller reported, sending
+			 * the write queue if the socket is writable
+			 */
+			void setReady( int events );
+
+			void checkValid() const noexcept( false );
+
+		//----------------------------------------------------------
+		//                     STATIC METHODS
+		//----------------------------------------------------------
+
+			friend class Selector;
+	};
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <map>
+#include <vector>
+
+#include "syscommon/Platform.h"
+#include "syscommon/Exception.h"
+#include "syscommon/net/MulticastSocket.h"
+#include "syscommon/net/SelectionKey.h"
+#include "syscommon/net/ServerSocket.h"
+#include "syscommon/net/Socket.h"
+
+namespace syscommon
+{
+	/**
+	 * Multiplexes many non-blocking sockets onto one thread, after java.nio's Selector. Sockets
+	 * are registered with the operations the application is interested in, and select() waits
+	 * until at least one of them is ready, so that a handful of threads can serve any number of
+	 * mostly idle connections.
+	 *
+	 * eg:
+	 *
+	 * server.configureBlocking( false );
+	 * selector.registerSocket( &server, SelectionKey::OP_ACCEPT, NULL );
+	 * while( running )
+	 * {
+	 *     selector.select();
+	 *     const std::vector<SelectionKey*>& keys = selector.getSelectedKeys();
+	 *     for( size_t i = 0; i < keys.size(); ++i )
+	 *     {
+	 *         if( keys[i]->isAcceptable() )
+	 *         {
+	 *             Socket* client = server.accept();
+	 *             client->configureBlocking( false );
+	 *             selector.registerSocket( client, SelectionKey::OP_READ, new Connection(client) );
+	 *         }
+	 *         else if( keys[i]->isReadable() )
+	 *         {
+	 *             // receive() until it returns -1, queue replies with keys[i]->write()
+	 *         }
+	 *     }
+	 * }
+	 *
+	 * On Linux the selector is built on epoll, so a select() costs the same however many sockets
+	 * are registered. Elsewhere every registered socket is polled on each select().
+	 *
+	 * Unlike java.nio, the selected keys are replaced by each select() rather than accumulating
+	 * until the application removes them.
+	 *
+	 * A selector, and its keys, belong to the thread that calls select(). The only method that
+	 * may be called from other threads is wakeup().
+	 */
+	class Selector
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+		public:
+			// The most sockets that one select() can find ready. Any others are found by the next.
+			static const size_t MAX_SELECTED_KEYS = 256;
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			// NATIVE_POLLER_UNINIT if the platform has no readiness queue
+			NATIVE_POLLER poller;
+			NATIVE_SOCKET wakeupSocket;
+			bool open;
+
+			std::map<NATIVE_SOCKET,SelectionKey*> keys;
+			std::vector<SelectionKey*> cancelledKeys;
+			std::vector<SelectionKey*> selectedKeys;
+
+			std::vector<PollerEvent> events;
+			std::vector<SocketPoll> polls;
+			std::vector<SelectionKey*> polledKeys;
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * @throws IOException if the selector could not be created
+			 */
+			Selector() noexcept( false );
+
+			/**
+			 * Closes the selector. The registered sockets are not closed.
+			 */
+			virtual ~Selector();
+
+		private:
+			// Not copyable
+			Selector( const Selector& );
+			Selector& operator=( const Selector& );
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Registers a connected socket with the selector. The socket should be put into
+			 * non-blocking mode first.
+			 *
+			 * @param socket the socket to watch, which remains owned by the caller
+			 * @param ops the operations to watch for, any combination of OP_READ and OP_WRITE
+			 * @param attachment an object of the caller's choosing to attach to the key, or NULL
+			 *
+			 * @return the new key, which is owned by the selector
+			 *
+			 * @throws SocketException if the socket is closed or not connected
+			 * @throws IllegalArgumentException if the operations are not supported, or the socket
+			 *                                  is already registered
+			 * @throws IllegalStateException if the selector is closed
+			 */
+			SelectionKey* registerSocket( Socket* socket, int ops, void* attachment ) noexcept( false );
+
+			/**
+			 * Registers a server socket with the selector, as for registerSocket( Socket* ... ).
+			 * The only operation a server socket supports is OP_ACCEPT.
+			 */
+			SelectionKey* registerSocket( ServerSocket* socket, int ops, void* attachment ) noexcept( false );
+
+			/**
+			 * Registers a multicast socket with the selector, as for registerSocket( Socket* ... ).
+			 * Multicast sockets support OP_READ and OP_WRITE, but have no write queue.
+			 */
+			SelectionKey* registerSocket( MulticastSocket* socket, int ops, void* attachment ) noexcept( false );
+
+			/**
+			 * Waits until at least one registered socket is ready, wakeup() is called or the
+			 * calling thread is signaled
+			 *
+			 * @return the number of selected keys, which may be 0
+			 *
+			 * @throws IOException if the wait failed
+			 * @throws IllegalStateException if the selector is closed
+			 */
+			int select() noexcept( false );
+
+			/**
+			 * As select(), waiting no longer than the given number of milliseconds
+			 */
+			int select( unsigned long timeout ) noexcept( false );
+
+			/**
+			 * As select(), without waiting
+			 */
+			int selectNow() noexcept( false );
+
+			/**
+			 * Returns the keys that the last select() found ready
+			 */
+			const std::vector<SelectionKey*>& getSelectedKeys() const;
+
+			/**
+			 * Returns the number of sockets registered with the selector
+			 */
+			size_t getKeyCount() const;
+
+			/**
+			 * Makes the select() in progress return straight away, or the next one if there is
+			 * none in progress. May be called from any thread.
+			 */
+			void wakeup();
+
+			/**
+			 * Cancels every key and releases the selector's resources. The registered sockets are
+			 * left open. Has no effect if the selector is already closed.
+			 */
+			void close();
+
+			bool isOpen() const;
+
+		private:
+			SelectionKey* registerKey( SelectionKey* key ) noexcept( false );
+
+			/**
+			 * Tells the poller about a change to a key's registered events
+			 */
+			void updateKey( SelectionKey* key );
+
+			void cancelKey( SelectionKey* key );
+
+			int doSelect( unsigned long timeout ) noexcept( false );
+			int selectNative( unsigned long timeout ) noexcept( false );
+			int selectPolled( unsigned long timeout ) noexcept( false );
+
+			void checkOpen() const noexcept( false );
+
+		//----------------------------------------------------------
+		//                     STATIC METHODS
+		//----------------------------------------------------------
+
+			friend class SelectionKey;
+	};
+}
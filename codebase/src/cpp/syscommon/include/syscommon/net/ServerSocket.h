@@ -15,6 +15,8 @@
  * Portions Copyright [yyyy] [name of copyright owner]
  */
 
+#include <vector>
+
 #include "syscommon/Exception.h"
 #include "syscommon/Platform.h"
 #include "syscommon/concurrent/Lock.h"
@@ -23,6 +25,11 @@
 
 namespace syscommon
 {
+	class AsyncOperation;
+	class CompletionEngine;
+	class AcceptAwaitable;
+	class ICompletionHandler;
+
 	/**
 	 * This class implements server sockets. A server socket waits for requests to come in over the 
 	 * network. It performs some operation based on that request, and then possibly returns a 
@@ -42,7 +49,9 @@ namespace syscommon
 		private:
 			NATIVE_SOCKET nativeSocket;
 			bool closed;
+			bool blocking;
 			NATIVE_IP_ADDRESS boundTo;
+			SocketOptions options;
 
 			Lock closeLock;
 
@@ -194,10 +203,113 @@ namespace syscommon
 			 *
 			 * @exception IOException  if an I/O error occurs when waiting for a connection.
 			 *
-			 * @return the new Socket
+			 * @return the new Socket, or NULL if the socket is in non-blocking mode and no
+			 *         connection was waiting
 			 */
 			Socket* accept() noexcept( false );
 
+			/**
+			 * Adjusts this server socket's blocking mode. A non-blocking server socket returns
+			 * NULL from accept() when no connection is waiting, rather than blocking until one
+			 * arrives, so that it can be served by a thread that waits on many sockets at once.
+			 * Server sockets are blocking when they are created.
+			 *
+			 * @param block true to make accept() block, false to make it return immediately
+			 *
+			 * @throws SocketException if the mode could not be changed
+			 */
+			void configureBlocking( bool block ) noexcept( false );
+
+			/**
+			 * Returns whether accept() blocks until a connection arrives
+			 */
+			bool isBlocking() const;
+
+			/**
+			 * Starts accepting a connection through the given engine without waiting for one, as
+			 * for CompletionEngine::accept()
+			 */
+			AsyncOperation* acceptAsync( CompletionEngine& engine,
+			                             ICompletionHandler* handler,
+			                             void* attachment ) noexcept( false );
+
+#ifdef SYSCOMMON_HAS_COROUTINES
+			/**
+			 * Returns an awaitable that accepts a connection through the EventLoop running on the
+			 * current thread. Defined in EventLoop.h.
+			 *
+			 * @throws IllegalStateException if there is no loop running on the current thread
+			 */
+			AcceptAwaitable acceptAsync() noexcept( false );
+#endif
+
+			/**
+			 * Enables or disables SO_REUSEPORT, which lets several server sockets bind to the same
+			 * address and port. The operating system then shares incoming connections out between
+			 * them, so that each can be served by a thread of its own. Must be called before the
+			 * socket is bound.
+			 *
+			 * @param enable whether other sockets may bind to the same port
+			 *
+			 * @throws SocketException if the option is not supported on this platform
+			 */
+			void setReusePort( bool enable ) noexcept( false );
+
+			/**
+			 * Asks the operating system to prefer this socket, among those sharing its port
+			 * through SO_REUSEPORT, for connections whose packets arrive on the given processor
+			 * (SO_INCOMING_CPU). A connection is then accepted by the thread pinned to the
+			 * processor that handles its network traffic. This is only a hint, and is ignored
+			 * where it is not supported.
+			 *
+			 * @param processor the logical processor to steer connections from
+			 */
+			void setIncomingProcessor( int processor ) noexcept( false );
+
+			/**
+			 * Replaces the hint given by setIncomingProcessor() with a rule, for the group of
+			 * sockets sharing this socket's port through SO_REUSEPORT. A connection that arrives
+			 * on one of the given processors goes to the socket at the same index, counting the
+			 * sockets in the order they were bound, and the rest are spread across the group by
+			 * processor number. Call it on any one socket once the whole group is bound.
+			 *
+			 * eg: one acceptor thread per processor, each with a listener of its own
+			 *
+			 * for( size_t i = 0; i < processors.size(); ++i )
+			 * {
+			 *     listeners[i].setReusePort( true );
+			 *     listeners[i].bind( InetSocketAddress(port) );
+			 * }
+			 * listeners[0].setReusePortSteering( processors );
+			 *
+			 * @param processors the processor to steer to each socket in the group
+			 *
+			 * @throws SocketException if the socket is closed or not bound, or the platform
+			 *                         cannot steer connections (it needs Linux's
+			 *                         SO_ATTACH_REUSEPORT_CBPF)
+			 */
+			void setReusePortSteering( const std::vector<unsigned int>& processors )
+				noexcept( false );
+
+			/**
+			 * Sets the options that every Socket accepted from now on starts with, and applies
+			 * them to this socket too. A receive buffer larger than 64KB only has its full effect
+			 * if it is set before the socket is bound, as the window scale it needs is agreed
+			 * while the connection is made.
+			 *
+			 * eg: ServerSocket server;
+			 *     server.setOptions( SocketOptions(TP_LOW_LATENCY) );
+			 *     server.bind( InetSocketAddress(port) );
+			 *
+			 * @throws SocketException if the socket is closed or the platform refuses an option
+			 */
+			void setOptions( const SocketOptions& options ) noexcept( false );
+
+			/**
+			 * Returns the options that accepted sockets start with
+			 */
+			const SocketOptions& getOptions() const;
+
 			/**
 			 * Closes this socket.
 			 *
@@ -228,6 +340,10 @@ namespace syscommon
 			 */
 			NATIVE_SOCKET getImpl() noexcept( false );
 
+			friend class Shard;
+			friend class Selector;
+			friend class CompletionEngine;
+
 		//----------------------------------------------------------
 		//                     STATIC METHODS
 		//----------------------------------------------------------
@@ -0,0 +1,217 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <atomic>
+#include <map>
+#include <vector>
+
+#include "syscommon/Platform.h"
+#include "syscommon/Exception.h"
+#include "syscommon/concurrent/MpscRingBuffer.h"
+#include "syscommon/concurrent/Thread.h"
+#include "syscommon/net/IShardHandler.h"
+#include "syscommon/net/Selector.h"
+#include "syscommon/net/ServerSocket.h"
+#include "syscommon/net/Socket.h"
+
+namespace syscommon
+{
+	class ShardedServer;
+
+	/**
+	 * One shard of a ShardedServer: a thread pinned to a single processor that accepts and serves
+	 * its own share of the server's connections. Nothing that a shard touches while serving a
+	 * connection is shared with any other shard.
+	 *
+	 * The only way in from outside the shard is post(), which queues a task to run on the shard's
+	 * thread through a lock-free multi-producer ring buffer. This is meant for the occasional
+	 * operation that spans shards, such as broadcasting a message to every connection, rather than
+	 * for the regular flow of work.
+	 *
+	 * Everything apart from post() and the statistics must only be called on the shard's own
+	 * thread, that is from within one of the IShardHandler callbacks or a posted task.
+	 */
+	class Shard : private IRunnable
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+		private:
+			/**
+			 * Hands a connection accepted by one shard to another, on servers where the
+			 * platform cannot share a port between several listening sockets
+			 */
+			class Handoff : public IRunnable
+			{
+				public:
+					Shard* shard;
+					Socket* socket;
+
+				public:
+					Handoff( Shard* shard, Socket* socket ) : shard( shard ), socket( socket ) {}
+					virtual void run();
+			};
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			ShardedServer* server;
+			IShardHandler* handler;
+			unsigned int index;
+			unsigned int processor;
+
+			Thread* thread;
+			volatile bool running;
+
+			// NULL if the shard is given its connections by the first shard instead
+			ServerSocket* listener;
+			size_t nextHandoff;
+
+			Selector selector;
+			std::map<Socket*,SelectionKey*> watched;
+
+			MpscRingBuffer<IRunnable*> inbox;
+
+			// Set while the shard is, or is about to be, waiting for its sockets, so that post()
+			// knows it has to wake it
+			std::atomic<bool> sleeping;
+
+			std::atomic<unsigned long long> acceptedCount;
+			std::atomic<unsigned long long> steeredCount;
+			std::atomic<unsigned long long> failureCount;
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		private:
+			/**
+			 * Shards are only created by a ShardedServer
+			 */
+			Shard( ShardedServer* server,
+			       IShardHandler* handler,
+			       unsigned int index,
+			       unsigned int processor,
+			       size_t inboxCapacity ) noexcept( false );
+
+			// Not copyable
+			Shard( const Shard& );
+			Shard& operator=( const Shard& );
+
+		public:
+			virtual ~Shard();
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Returns this shard's position in its server, from 0
+			 */
+			unsigned int getIndex() const;
+
+			/**
+			 * Returns the logical processor that this shard's thread is pinned to
+			 */
+			unsigned int getProcessor() const;
+
+			/**
+			 * Returns the server that this shard belongs to
+			 */
+			ShardedServer& getServer() const;
+
+			/**
+			 * Queues a task to run on this shard's thread, waking the shard if it is waiting for
+			 * its sockets. May be called from any thread, including the shard's own. Tasks run in
+			 * the order that each thread posted them.
+			 *
+			 * @param task the task to run. The task remains owned by the caller, and must stay
+			 *             valid until it has run.
+			 *
+			 * @return false if the shard's inbox is full, in which case the task will not run
+			 */
+			bool post( IRunnable* task );
+
+			/**
+			 * Starts calling the handler's onReadable() whenever the given socket has data to
+			 * receive. The socket remains owned by the handler, which must unwatch() it before
+			 * closing or deleting it. Has no effect if the socket is already watched.
+			 *
+			 * @throws SocketException if the socket is closed or not connected
+			 */
+			void watch( Socket* socket ) noexcept( false );
+
+			/**
+			 * Stops watching the given socket
+			 */
+			void unwatch( Socket* socket );
+
+			/**
+			 * Returns the number of connections this shard has given to its handler
+			 */
+			unsigned long long getAcceptedCount() const;
+
+			/**
+			 * Returns the number of connections this shard accepted whose packets were arriving
+			 * on its own processor, which is how many the operating system steered to it through
+			 * SO_INCOMING_CPU. Always 0 where the platform cannot report this.
+			 */
+			unsigned long long getSteeredCount() const;
+
+			/**
+			 * Returns the number of exceptions thrown by the handler on this shard
+			 */
+			unsigned long long getFailureCount() const;
+
+		private:
+			void start() noexcept( false );
+			void stop();
+			void join();
+
+			/**
+			 * Accepts every connection waiting on the listener
+			 */
+			void acceptConnections();
+
+			/**
+			 * Gives an accepted connection to the handler
+			 */
+			void deliver( Socket* socket );
+
+			/**
+			 * Runs every task in the inbox
+			 */
+			void runTasks( std::vector<IRunnable*>& tasks );
+
+			/**
+			 * Shard thread main loop
+			 */
+			virtual void run();
+
+		//----------------------------------------------------------
+		//                     STATIC METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Returns the shard whose thread is calling, or NULL if the caller is not running on
+			 * a shard
+			 */
+			static Shard* current();
+
+			friend class ShardedServer;
+	};
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <vector>
+
+#include "syscommon/Platform.h"
+#include "syscommon/Exception.h"
+#include "syscommon/net/InetSocketAddress.h"
+#include "syscommon/net/IShardHandler.h"
+#include "syscommon/net/Shard.h"
+
+namespace syscommon
+{
+	/**
+	 * A TCP server that runs one Shard per processor, in the thread-per-core style. Each shard is a
+	 * thread pinned to its processor with a listening socket of its own, all bound to the same port
+	 * with SO_REUSEPORT, so that the operating system shares incoming connections out between
+	 * them. Each listening socket also asks, through SO_INCOMING_CPU, for the connections whose
+	 * packets arrive on its shard's processor. A connection is then served start to finish on one
+	 * processor, with no locks, queues or cache lines shared with the other shards.
+	 *
+	 * eg:
+	 *
+	 * EchoHandler handler;
+	 * ShardedServer server( &handler );
+	 * server.start( InetSocketAddress(8080) );
+	 *
+	 * // ... serve until it is time to shut down
+	 *
+	 * server.stop();
+	 *
+	 * SO_INCOMING_CPU is only a hint, which the operating system can pass over when the shards'
+	 * sockets look equally good. setCpuSteering() attaches a program to the group instead (see
+	 * ServerSocket::setReusePortSteering()), which always gives a connection to the shard on the
+	 * processor it arrived on if there is one.
+	 *
+	 * On platforms without SO_REUSEPORT only the first shard listens, and it passes each accepted
+	 * connection to the shards in turn through their inboxes.
+	 *
+	 * See IShardHandler for how connections are served, and Shard::post() for how shards talk to
+	 * each other.
+	 */
+	class ShardedServer
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+		public:
+			static const size_t DEFAULT_INBOX_CAPACITY = 4096;
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			IShardHandler* handler;
+			std::vector<unsigned int> processors;
+			size_t inboxCapacity;
+
+			std::vector<Shard*> shards;
+			bool reusePort;
+			bool cpuSteering;
+			bool cpuSteeringActive;
+			unsigned short port;
+			bool running;
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Creates a server with one shard for each physical core, as reported by
+			 * Platform::getTopology()
+			 *
+			 * @param handler serves the connections of every shard. Remains owned by the caller.
+			 */
+			ShardedServer( IShardHandler* handler );
+
+			/**
+			 * Creates a server with one shard for each of the given processors
+			 *
+			 * @param handler serves the connections of every shard. Remains owned by the caller.
+			 * @param processors the logical processor to pin each shard to. The same processor
+			 *                   may be given more than once.
+			 * @param inboxCapacity the number of posted tasks each shard can hold
+			 *
+			 * @throws IllegalArgumentException if no processors are given
+			 */
+			ShardedServer( IShardHandler* handler,
+			               const std::vector<unsigned int>& processors,
+			               size_t inboxCapacity ) noexcept( false );
+
+			/**
+			 * Stops the server if it is running
+			 */
+			virtual ~ShardedServer();
+
+		private:
+			// Not copyable
+			ShardedServer( const ShardedServer& );
+			ShardedServer& operator=( const ShardedServer& );
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Binds every shard to the given address and starts the shards' threads. A port of 0
+			 * is allocated by the operating system, and can then be read with getLocalPort().
+			 *
+			 * @param endpoint the address and port to listen on
+			 *
+			 * @throws IOException if the listening sockets could not be bound
+			 * @throws IllegalStateException if the server has already been started
+			 */
+			void start( const InetSocketAddress& endpoint ) noexcept( false );
+
+			/**
+			 * As start( endpoint ), with the given backlog of pending connections for each shard
+			 */
+			void start( const InetSocketAddress& endpoint, int backlog ) noexcept( false );
+
+			/**
+			 * Stops accepting connections, calls the handler's onStop() on every shard and waits
+			 * for the shards' threads to finish. Tasks that were posted before the call still
+			 * run. Has no effect if the server is not running.
+			 */
+			void stop();
+
+			/**
+			 * Returns whether the server has been started and not yet stopped
+			 */
+			bool isRunning() const;
+
+			/**
+			 * Returns the port the server is listening on, or 0 if it has not been started
+			 */
+			unsigned short getLocalPort() const;
+
+			/**
+			 * Returns the number of shards
+			 */
+			size_t getShardCount() const;
+
+			/**
+			 * Returns the shard at the given index. Shards exist from when the server is started
+			 * until it is destroyed.
+			 *
+			 * @throws IllegalArgumentException if there is no such shard
+			 */
+			Shard& getShard( size_t index ) noexcept( false );
+
+			/**
+			 * Asks for each connection to be given to the shard pinned to the processor it
+			 * arrived on, by a program attached to the shards' listening sockets rather than
+			 * through the SO_INCOMING_CPU hint. Where the program cannot be attached the server
+			 * starts with the hint alone. Takes effect the next time the server is started.
+			 *
+			 * @throws IllegalStateException if the server is running
+			 */
+			void setCpuSteering( bool enable ) noexcept( false );
+
+			/**
+			 * Returns whether the server is running with connections steered by the program
+			 * asked for through setCpuSteering()
+			 */
+			bool isCpuSteeringActive() const;
+
+			/**
+			 * Returns whether each shard has a listening socket of its own, or whether the first
+			 * shard accepts every connection and passes them on
+			 */
+			bool isReusePortEnabled() const;
+
+		private:
+			void _ShardedServer( IShardHandler* handler,
+			                     const std::vector<unsigned int>& processors,
+			                     size_t inboxCapacity );
+
+			/**
+			 * Creates the shards, with their listening sockets bound
+			 */
+			void createShards( const InetSocketAddress& endpoint, int backlog ) noexcept( false );
+
+			void destroyShards();
+	};
+}
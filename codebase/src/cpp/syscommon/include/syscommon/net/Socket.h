@@ -15,12 +15,32 @@
  * Portions Copyright [yyyy] [name of copyright owner]
  */
 
+#include <deque>
+#include <map>
 #include "syscommon/Exception.h"
 #include "syscommon/Platform.h"
 #include "syscommon/net/InetSocketAddress.h"
 
 namespace syscommon
 {
+	class AsyncOperation;
+	class CompletionEngine;
+	class ICompletionHandler;
+	class ITransferListener;
+	class ReceiveAwaitable;
+	class SendAwaitable;
+
+	/**
+	 * A buffer given to Socket::sendZeroCopy() that the socket has finished with. Context is
+	 * whatever was passed with the send. Copied is set if the data was copied after all, either
+	 * because the send was too small to be worth pinning or because the kernel chose to.
+	 */
+	struct ZeroCopyCompletion
+	{
+		void* context;
+		bool copied;
+	};
+
 	/**
 	 * This class implements client sockets (also called just "sockets"). A socket is an endpoint 
 	 * for communication between two machines.
@@ -30,6 +50,10 @@ namespace syscommon
 		//----------------------------------------------------------
 		//                    STATIC VARIABLES
 		//----------------------------------------------------------
+		public:
+			// Below this many bytes sendZeroCopy() copies, as pinning the pages and reading the
+			// completion back costs more than the copy saves
+			static const int DEFAULT_ZERO_COPY_THRESHOLD = 65536;
 
 		//----------------------------------------------------------
 		//                   INSTANCE VARIABLES
@@ -40,6 +64,15 @@ namespace syscommon
 			bool closed;
 			bool inputShutdown;
 			bool outputShutdown;
+			bool blocking;
+
+			SocketOptions options;
+
+			bool zeroCopy;
+			int zeroCopyThreshold;
+			unsigned int zeroCopySequence;
+			std::map<unsigned int,void*> zeroCopyPending;
+			std::deque<ZeroCopyCompletion> zeroCopyCompleted;
 
 			NATIVE_IP_ADDRESS remoteAddress;
 			unsigned short remotePort;
@@ -130,7 +163,8 @@ namespace syscommon
 			 * @param buffer The buffer of bytes to send through the socket
 			 * @param length The amount of bytes to send
 			 *
-			 * @return the number of bytes sent by this operation
+			 * @return the number of bytes sent by this operation. In non-blocking mode this may be
+			 *         fewer than were asked for, and is 0 if the send buffer is full.
 			 *
 			 * @throws IOException if an I/O error occurs while attempting to send the data
 			 * through the socket
@@ -143,13 +177,319 @@ namespace syscommon
 			 * @param buffer The buffer of bytes to receive into
 			 * @param length The maximum amount of bytes to receive
 			 *
-			 * @return the number of bytes received by this receive operation
+			 * @return the number of bytes received by this receive operation, 0 if the other end
+			 *         has closed the connection, or -1 if the socket is in non-blocking mode and
+			 *         there is nothing to receive
 			 *
 			 * @throws IOException if an I/O error occurs while attempting to send the data through
 			 * the socket
 			 */
 			int receive( char* buffer, int length ) noexcept( false );
 
+			/**
+			 * Sends the segments, in order, as one stream of bytes, so that a header and its
+			 * payload can leave together without being copied into one buffer first. Where the
+			 * platform gathers (sendmsg()) this is a single system call. Up to
+			 * BufferSegment::MAX_BATCH segments are taken at a time.
+			 *
+			 * eg: send a framed message straight out of its OutputBuffer
+			 *
+			 * BufferSegment segments[2];
+			 * segments[0] = header.toSegment();
+			 * segments[1].buffer = payload;
+			 * segments[1].length = payloadLength;
+			 * socket.sendAll( segments, 2 );
+			 *
+			 * @param segments the buffers to send from
+			 * @param count the number of segments
+			 *
+			 * @return the number of bytes sent, as for send(). This may end part way through a
+			 *         segment.
+			 *
+			 * @throws IOException if an I/O error occurs while attempting to send the data
+			 * through the socket
+			 */
+			int sendv( const BufferSegment* segments, int count ) noexcept( false );
+
+			/**
+			 * Receives into the segments, in order, filling each before moving on to the next.
+			 * Where the platform scatters (readv()) this is a single system call, and elsewhere
+			 * only the first segment with room is received into. Up to BufferSegment::MAX_BATCH
+			 * segments are taken at a time.
+			 *
+			 * @param segments the buffers to receive into
+			 * @param count the number of segments
+			 *
+			 * @return the number of bytes received, as for receive()
+			 *
+			 * @throws IOException if an I/O error occurs while attempting to receive data through
+			 * the socket
+			 */
+			int receivev( BufferSegment* segments, int count ) noexcept( false );
+
+			/**
+			 * Sends all of the buffer, calling send() as many times as it takes. In non-blocking
+			 * mode this waits for room in the send buffer whenever it fills.
+			 *
+			 * @throws IOException if an I/O error occurs before all of the data has been sent
+			 */
+			void sendAll( const char* buffer, int length ) noexcept( false );
+
+			/**
+			 * Sends all of the segments, calling sendv() as many times as it takes. In
+			 * non-blocking mode this waits for room in the send buffer whenever it fills.
+			 *
+			 * @throws IOException if an I/O error occurs before all of the data has been sent
+			 */
+			void sendAll( const BufferSegment* segments, int count ) noexcept( false );
+
+			/**
+			 * Receives until the buffer is full, calling receive() as many times as it takes. In
+			 * non-blocking mode this waits for more data whenever there is none.
+			 *
+			 * @return the number of bytes received, which is less than the length only if the
+			 *         other end closed the connection first
+			 *
+			 * @throws IOException if an I/O error occurs before the buffer has been filled
+			 */
+			int receiveFully( char* buffer, int length ) noexcept( false );
+
+			/**
+			 * Receives until every segment is full, calling receivev() as many times as it takes.
+			 * In non-blocking mode this waits for more data whenever there is none.
+			 *
+			 * @return the number of bytes received, which is less than the segments hold only if
+			 *         the other end closed the connection first
+			 *
+			 * @throws IOException if an I/O error occurs before the segments have been filled
+			 */
+			int receiveFully( BufferSegment* segments, int count ) noexcept( false );
+
+			/**
+			 * Sends up to length bytes of an open file, starting at the given offset, straight
+			 * from the file to the socket without copying them through user memory. Where the
+			 * platform has sendfile() the data stays in the kernel, and a pipe is spliced in
+			 * instead (ignoring the offset). Elsewhere the file is read through a buffer.
+			 *
+			 * This is a single step, which may send less than was asked for. Continue from the
+			 * offset plus the number of bytes sent.
+			 *
+			 * @param file the file to send from, which stays open
+			 * @param offset where in the file to start
+			 * @param length the most bytes to send
+			 *
+			 * @return the number of bytes sent, 0 at the end of the file, or -1 if the socket is
+			 *         in non-blocking mode and its send buffer is full
+			 *
+			 * @throws IOException if the file cannot be read or the socket cannot be sent on
+			 */
+			long long transferFrom( NATIVE_FILE file, long long offset, long long length )
+				noexcept( false );
+
+			/**
+			 * Sends length bytes of an open file, starting at the given offset, as for the single
+			 * step transferFrom() but carrying on until they have all gone. In non-blocking mode
+			 * this waits for room in the send buffer whenever it fills.
+			 *
+			 * @param file the file to send from, which stays open
+			 * @param offset where in the file to start
+			 * @param length the number of bytes to send, or -1 to send the rest of the file
+			 * @param listener told after each step how far the transfer has got, and able to stop
+			 *                 it. May be NULL.
+			 *
+			 * @return the number of bytes sent, which is less than the length if the file ended
+			 *         first or the listener stopped the transfer
+			 *
+			 * @throws IOException if the file cannot be read or the socket cannot be sent on
+			 */
+			long long transferFrom( NATIVE_FILE file,
+			                        long long offset,
+			                        long long length,
+			                        ITransferListener* listener ) noexcept( false );
+
+			/**
+			 * Opens the named file and sends it as for transferFrom() with an open file. A large
+			 * file can be sent in several goes, or a broken transfer resumed on a new connection,
+			 * by starting each at the offset the last one reached.
+			 *
+			 * @throws FileNotFoundException if the file cannot be opened
+			 * @throws IOException if the file cannot be read or the socket cannot be sent on
+			 */
+			long long transferFrom( const tchar* fileName,
+			                        long long offset,
+			                        long long length,
+			                        ITransferListener* listener ) noexcept( false );
+
+			/**
+			 * Relays data received on another socket to this one. Where the platform has splice()
+			 * the data passes through a pipe in the kernel rather than being received into user
+			 * memory and sent on again, which it is elsewhere.
+			 *
+			 * @param source the connected socket to relay from
+			 * @param length the number of bytes to relay, or -1 to relay until the source closes
+			 * @param listener told after each step how far the relay has got, and able to stop
+			 *                 it. May be NULL.
+			 *
+			 * @return the number of bytes relayed, which is less than the length if the source
+			 *         closed first or the listener stopped the relay
+			 *
+			 * @throws IOException if either socket fails
+			 */
+			long long transferFrom( Socket& source, long long length, ITransferListener* listener )
+				noexcept( false );
+
+			/**
+			 * Applies the given options to the socket, replacing any that were applied before.
+			 * Options that are left to the default are not changed. If the socket has not
+			 * connected yet they are applied when it does, before the connection is made, which
+			 * is when buffer sizes need to be set to have their full effect.
+			 *
+			 * eg: Socket socket;
+			 *     socket.setOptions( SocketOptions(TP_LOW_LATENCY) );
+			 *     socket.connect( endpoint );
+			 *
+			 * @throws SocketException if the socket is closed or the platform refuses an option
+			 */
+			void setOptions( const SocketOptions& options ) noexcept( false );
+
+			/**
+			 * Returns the options last given to setOptions(), or inherited from the ServerSocket
+			 * that accepted this socket
+			 */
+			const SocketOptions& getOptions() const;
+
+			/**
+			 * Turns zero-copy sends (MSG_ZEROCOPY) on or off for sendZeroCopy(). Sockets start
+			 * with them off. If the socket has not connected yet they are turned on when it
+			 * does, and connect() fails if the platform does not have them.
+			 *
+			 * @throws SocketException if the socket is closed, or zero-copy sends are being
+			 *                         turned on and the platform does not have them
+			 */
+			void setZeroCopy( bool enable ) noexcept( false );
+
+			/**
+			 * Returns whether sendZeroCopy() sends without copying
+			 */
+			bool isZeroCopy() const;
+
+			/**
+			 * Sets the smallest send that sendZeroCopy() will make without copying. Smaller ones
+			 * are copied as for send(). Defaults to DEFAULT_ZERO_COPY_THRESHOLD.
+			 */
+			void setZeroCopyThreshold( int threshold );
+			int getZeroCopyThreshold() const;
+
+			/**
+			 * Sends the buffer as for send(), but with zero-copy sends turned on and at least
+			 * the threshold to send, the kernel transmits straight out of the buffer instead of
+			 * copying it. The buffer then still belongs to the socket when this returns, and must
+			 * not be changed or freed until pollZeroCopy() hands back its context. Every call
+			 * that sends something is completed exactly once, including those that were copied,
+			 * so the caller can treat all of its buffers the same way.
+			 *
+			 * eg: stream large blocks, reusing each once the kernel is done with it
+			 *
+			 * socket.setZeroCopy( true );
+			 * socket.sendZeroCopy( block->data, block->length, block );
+			 * ...
+			 * ZeroCopyCompletion done[16];
+			 * int count = socket.pollZeroCopy( done, 16, 0 );
+			 * for( int i = 0; i < count; ++i )
+			 *     pool.release( (Block*)done[i].context );
+			 *
+			 * Wait for everything to complete before closing the socket, as completions that
+			 * have not been collected by then are lost with it.
+			 *
+			 * @param buffer the bytes to send
+			 * @param length the number of bytes to send
+			 * @param context handed back with the completion
+			 *
+			 * @return the number of bytes sent, as for send(). Nothing is completed for a call
+			 *         that sends nothing.
+			 *
+			 * @throws IOException if an I/O error occurs while attempting to send the data
+			 */
+			int sendZeroCopy( const char* buffer, int length, void* context ) noexcept( false );
+
+			/**
+			 * Collects the sends that the socket has finished with, oldest first, waiting up to
+			 * the timeout for the first of them if none have finished yet
+			 *
+			 * @param completions filled in with up to count completions
+			 * @param count the most completions to collect
+			 * @param timeout how long to wait in milliseconds, 0 to return straight away or
+			 *                NATIVE_INFINITE_WAIT to wait until one arrives
+			 *
+			 * @return the number of completions collected, which is 0 if none arrived in time
+			 *
+			 * @throws SocketException if the socket is closed or cannot be waited on
+			 */
+			int pollZeroCopy( ZeroCopyCompletion* completions, int count, unsigned long timeout )
+				noexcept( false );
+
+			/**
+			 * Returns the number of zero-copy sends that the socket has not yet finished with
+			 */
+			int getZeroCopyPendingCount() const;
+
+			/**
+			 * Puts the socket into non-blocking mode, in which send() and receive() return
+			 * straight away instead of waiting for buffer space or data. Sockets are blocking when
+			 * they are created or accepted. connect() always waits for the connection to be made,
+			 * whatever the mode, and the mode takes effect once it has.
+			 *
+			 * Non-blocking sockets are meant to be driven by a Selector.
+			 *
+			 * @param block true to make operations block, false to make them return immediately
+			 *
+			 * @throws SocketException if the socket is closed
+			 */
+			void configureBlocking( bool block ) noexcept( false );
+
+			/**
+			 * Returns whether send() and receive() block
+			 */
+			bool isBlocking() const;
+
+			/**
+			 * Starts sending the buffer through the given engine without waiting for it, as for
+			 * CompletionEngine::send()
+			 */
+			AsyncOperation* sendAsync( CompletionEngine& engine,
+			                           const char* buffer,
+			                           int length,
+			                           ICompletionHandler* handler,
+			                           void* attachment ) noexcept( false );
+
+			/**
+			 * Starts receiving into the buffer through the given engine without waiting for it,
+			 * as for CompletionEngine::receive()
+			 */
+			AsyncOperation* receiveAsync( CompletionEngine& engine,
+			                              char* buffer,
+			                              int length,
+			                              ICompletionHandler* handler,
+			                              void* attachment ) noexcept( false );
+
+#ifdef SYSCOMMON_HAS_COROUTINES
+			/**
+			 * Returns an awaitable that sends the buffer through the EventLoop running on the
+			 * current thread, as for CompletionEngine::send(). Defined in EventLoop.h.
+			 *
+			 * @throws IllegalStateException if there is no loop running on the current thread
+			 */
+			SendAwaitable sendAsync( const char* buffer, int length ) noexcept( false );
+
+			/**
+			 * Returns an awaitable that receives into the buffer through the EventLoop running on
+			 * the current thread, as for CompletionEngine::receive(). Defined in EventLoop.h.
+			 *
+			 * @throws IllegalStateException if there is no loop running on the current thread
+			 */
+			ReceiveAwaitable receiveAsync( char* buffer, int length ) noexcept( false );
+#endif
+
 			/**
 			 * Returns the address to which the socket is connected.
 			 * <p>
@@ -229,6 +569,44 @@ namespace syscommon
 
 		private:
 			bool isCreated() const;
+
+			/**
+			 * Checks that the socket is open and its output or input, as the case may be, has not
+			 * been shut down
+			 *
+			 * @throws SocketException if it cannot be used
+			 */
+			void checkUsable( bool output ) const noexcept( false );
+
+			/**
+			 * Moves the whole of the segments for sendAll() or receiveFully(), waiting for the
+			 * socket to become ready between attempts if it is non-blocking
+			 *
+			 * @return the number of bytes moved
+			 */
+			int transferAll( const BufferSegment* segments, int count, bool output )
+				noexcept( false );
+
+			/**
+			 * Waits for a non-blocking socket to have room to send, or something to receive
+			 *
+			 * @throws SocketException if the socket cannot be waited on
+			 */
+			void waitUntilReady( bool output ) noexcept( false );
+
+			/**
+			 * Moves the completions waiting on the socket's error queue onto zeroCopyCompleted
+			 *
+			 * @throws SocketException if the error queue cannot be read
+			 */
+			void collectZeroCopy() noexcept( false );
+
+			/**
+			 * Relays from the source through user memory, for transferFrom() where the platform
+			 * cannot splice
+			 */
+			long long relayBuffered( Socket& source, long long length, ITransferListener* listener )
+				noexcept( false );
 			/**
 			 * @throws SocketException
 			 */
@@ -240,5 +618,17 @@ namespace syscommon
 		public:
 			static Socket* createFromAccept( NATIVE_SOCKET client, 
 			                                 const InetSocketAddress& clientAddress );
+
+			/**
+			 * Creates a Socket for an accepted connection that the given options have already
+			 * been applied to
+			 */
+			static Socket* createFromAccept( NATIVE_SOCKET client,
+			                                 const InetSocketAddress& clientAddress,
+			                                 const SocketOptions& options );
+
+			friend class Shard;
+			friend class Selector;
+			friend class CompletionEngine;
 	};
 }
@@ -0,0 +1,100 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include "syscommon/Platform.h"
+
+namespace syscommon
+{
+	/**
+	 * A point in time, on the monotonic Platform::nanoTime() clock, by which an operation should
+	 * complete. Passing the remaining time on to each blocking call in turn stops an operation that
+	 * blocks several times from overrunning its overall timeout:
+	 *
+	 * Deadline deadline( timeout );
+	 * for( ... )
+	 * {
+	 *     if( !thread->join(deadline.getRemainingMillis()) )
+	 *         return false;
+	 * }
+	 *
+	 * A timeout of NATIVE_INFINITE_WAIT produces a deadline that never expires, so the same code
+	 * handles timed and untimed waits.
+	 */
+	class Deadline
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			bool infinite;
+			long long expiryNanos;
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Creates a deadline the given number of milliseconds from now
+			 *
+			 * @param timeoutMillis the time until the deadline, or NATIVE_INFINITE_WAIT for a
+			 *                      deadline that never expires
+			 */
+			Deadline( unsigned long timeoutMillis );
+			virtual ~Deadline();
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Returns true if this deadline never expires
+			 */
+			bool isInfinite() const;
+
+			/**
+			 * Returns true if the deadline has passed
+			 */
+			bool hasExpired() const;
+
+			/**
+			 * Returns the time left before the deadline in nanoseconds, or zero if it has passed.
+			 * An infinite deadline returns LLONG_MAX.
+			 */
+			long long getRemainingNanos() const;
+
+			/**
+			 * Returns the time left before the deadline in milliseconds, suitable for passing to a
+			 * blocking call. Partial milliseconds are rounded up, so that waiting for the result
+			 * does not return before the deadline. Returns zero if the deadline has passed, and
+			 * NATIVE_INFINITE_WAIT if it never expires.
+			 */
+			unsigned long getRemainingMillis() const;
+
+		//----------------------------------------------------------
+		//                     STATIC METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Creates a deadline the given number of nanoseconds from now
+			 */
+			static Deadline fromNanos( long long timeoutNanos );
+	};
+}
@@ -20,6 +20,7 @@
 
 #include "syscommon/Exception.h"
 #include "syscommon/Platform.h"
+#include "syscommon/concurrent/ReadWriteLock.h"
 #include "syscommon/util/Logger.h"
 
 namespace syscommon
@@ -28,6 +29,10 @@ namespace syscommon
 	 * The Properties class represents a persistent set of properties. The Properties can be saved 
 	 * to a file or loaded from a file. Each key and its corresponding value in the property list 
 	 * is a string.
+	 *
+	 * Properties may be read and modified from multiple threads. Lookups share a ReadWriteLock,
+	 * so readers do not block one another. Note that the value returned by getProperty() points
+	 * into the property list, and is only valid until that property is next set or removed.
 	 */
 	class Properties
 	{
@@ -43,6 +48,7 @@ namespace syscommon
 		//----------------------------------------------------------
 		private:
 			std::map<String,String> properties;
+			mutable ReadWriteLock lock;
 
 		//----------------------------------------------------------
 		//                      CONSTRUCTORS
@@ -59,6 +65,11 @@ namespace syscommon
 			Properties( const Properties& other );
 			virtual ~Properties();
 
+			/**
+			 * Replaces the contents of this Properties instance with a copy of the other's
+			 */
+			Properties& operator=( const Properties& other );
+
 		//----------------------------------------------------------
 		//                    INSTANCE METHODS
 		//----------------------------------------------------------
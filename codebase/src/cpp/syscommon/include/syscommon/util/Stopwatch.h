@@ -0,0 +1,107 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include "syscommon/Platform.h"
+
+namespace syscommon
+{
+	/**
+	 * Measures elapsed time using the monotonic Platform::nanoTime() clock, so measurements are not
+	 * disturbed by changes to the system time.
+	 *
+	 * A Stopwatch accumulates time across start() and stop() pairs until it is reset():
+	 *
+	 * Stopwatch stopwatch = Stopwatch::createStarted();
+	 * handleRequest( request );
+	 * stopwatch.stop();
+	 * logger.debug( "Request took %lld us", stopwatch.getElapsedMicros() );
+	 */
+	class Stopwatch
+	{
+		//----------------------------------------------------------
+		//                    STATIC VARIABLES
+		//----------------------------------------------------------
+
+		//----------------------------------------------------------
+		//                   INSTANCE VARIABLES
+		//----------------------------------------------------------
+		private:
+			bool running;
+			long long startNanos;
+			long long accumulatedNanos;
+
+		//----------------------------------------------------------
+		//                      CONSTRUCTORS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Creates a stopwatch that is stopped, with no elapsed time
+			 */
+			Stopwatch();
+			virtual ~Stopwatch();
+
+		//----------------------------------------------------------
+		//                    INSTANCE METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Starts timing. Has no effect if the stopwatch is already running.
+			 */
+			void start();
+
+			/**
+			 * Stops timing, adding the time since start() to the elapsed time. Has no effect if the
+			 * stopwatch is not running.
+			 */
+			void stop();
+
+			/**
+			 * Stops the stopwatch and sets the elapsed time back to zero
+			 */
+			void reset();
+
+			/**
+			 * Returns true if the stopwatch is currently running
+			 */
+			bool isRunning() const;
+
+			/**
+			 * Returns the elapsed time in nanoseconds, including the current run if the stopwatch
+			 * is running
+			 */
+			long long getElapsedNanos() const;
+
+			/**
+			 * Returns the elapsed time in whole microseconds
+			 */
+			long long getElapsedMicros() const;
+
+			/**
+			 * Returns the elapsed time in whole milliseconds
+			 */
+			long long getElapsedMillis() const;
+
+		//----------------------------------------------------------
+		//                     STATIC METHODS
+		//----------------------------------------------------------
+		public:
+			/**
+			 * Returns a stopwatch that has already been started
+			 */
+			static Stopwatch createStarted();
+	};
+}
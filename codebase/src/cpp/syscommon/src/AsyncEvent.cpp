@@ -0,0 +1,77 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "syscommon/concurrent/AsyncEvent.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+AsyncEvent::AsyncEvent( bool initialState )
+{
+	this->signalled = initialState;
+}
+
+AsyncEvent::~AsyncEvent()
+{
+
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+void AsyncEvent::signal()
+{
+	std::vector<std::pair<EventLoop*,IRunnable*> > woken;
+	{
+		LockGuard guard( this->lock );
+		this->signalled = true;
+		woken.swap( this->waiters );
+	}
+
+	for( size_t i = 0; i < woken.size(); ++i )
+		woken[i].first->post( woken[i].second );
+}
+
+void AsyncEvent::clear()
+{
+	LockGuard guard( this->lock );
+	this->signalled = false;
+}
+
+bool AsyncEvent::isSignalled() const
+{
+	return this->signalled;
+}
+
+size_t AsyncEvent::getWaiterCount()
+{
+	LockGuard guard( this->lock );
+	return this->waiters.size();
+}
+
+bool AsyncEvent::addWaiter( EventLoop* loop, IRunnable* waiter )
+{
+	LockGuard guard( this->lock );
+	if( this->signalled )
+		return false;
+
+	this->waiters.push_back( std::make_pair(loop, waiter) );
+	return true;
+}
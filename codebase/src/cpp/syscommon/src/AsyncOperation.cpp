@@ -0,0 +1,164 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "syscommon/net/AsyncOperation.h"
+
+#include <assert.h>
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+AsyncOperation::AsyncOperation( CompletionEngine* engine,
+                                AsyncOperationType type,
+                                ICompletionHandler* handler,
+                                void* attachment )
+{
+	this->engine = engine;
+	this->type = type;
+	this->handler = handler;
+	this->attachment = attachment;
+	this->socket = NULL;
+	this->serverSocket = NULL;
+	this->multicastSocket = NULL;
+	this->packet = NULL;
+	this->buffer = NULL;
+	this->length = 0;
+	this->fixedIndex = -1;
+	this->selectBuffer = false;
+	this->multishot = false;
+	this->done = false;
+	this->more = false;
+	this->failed = false;
+	this->cancelRequested = false;
+	this->cancelled = false;
+	this->result = 0;
+	this->accepted = NULL;
+	this->bufferId = -1;
+}
+
+AsyncOperation::~AsyncOperation()
+{
+	// The kernel may still be using the buffers of an operation that is in progress
+	assert( this->done );
+	delete this->accepted;
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+CompletionEngine* AsyncOperation::getEngine() const
+{
+	return this->engine;
+}
+
+AsyncOperationType AsyncOperation::getType() const
+{
+	return this->type;
+}
+
+void* AsyncOperation::getAttachment() const
+{
+	return this->attachment;
+}
+
+Socket* AsyncOperation::getSocket() const
+{
+	return this->socket;
+}
+
+ServerSocket* AsyncOperation::getServerSocket() const
+{
+	return this->serverSocket;
+}
+
+MulticastSocket* AsyncOperation::getMulticastSocket() const
+{
+	return this->multicastSocket;
+}
+
+DatagramPacket* AsyncOperation::getPacket() const
+{
+	return this->packet;
+}
+
+bool AsyncOperation::isDone() const
+{
+	return this->done;
+}
+
+bool AsyncOperation::hasMore() const
+{
+	return this->more;
+}
+
+bool AsyncOperation::isMultishot() const
+{
+	return this->multishot;
+}
+
+bool AsyncOperation::isFailed() const
+{
+	return this->failed;
+}
+
+bool AsyncOperation::isCancelled() const
+{
+	return this->cancelled;
+}
+
+const char* AsyncOperation::getError() const
+{
+	return this->error.c_str();
+}
+
+int AsyncOperation::getResult() const
+{
+	return this->result;
+}
+
+Socket* AsyncOperation::takeAcceptedSocket()
+{
+	Socket* socket = this->accepted;
+	this->accepted = NULL;
+	return socket;
+}
+
+char* AsyncOperation::getBuffer() const
+{
+	return this->buffer;
+}
+
+int AsyncOperation::getBufferId() const
+{
+	return this->bufferId;
+}
+
+void AsyncOperation::fail( const std::string& reason )
+{
+	this->failed = true;
+	this->result = 0;
+	this->error = reason;
+	this->cancelled = this->cancelRequested;
+}
+
+void AsyncOperation::fail( const tchar* reason )
+{
+	this->fail( Platform::toAnsiString(reason) );
+}
@@ -0,0 +1,934 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "syscommon/net/CompletionEngine.h"
+
+#include <algorithm>
+#include <limits.h>
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+//----------------------------------------------------------
+//                    STATIC VARIABLES
+//----------------------------------------------------------
+const unsigned int CompletionEngine::DEFAULT_QUEUE_DEPTH;
+const size_t CompletionEngine::MAX_COMPLETIONS;
+const unsigned short CompletionEngine::BUFFER_GROUP;
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+CompletionEngine::CompletionEngine()
+{
+	this->_CompletionEngine( DEFAULT_QUEUE_DEPTH );
+}
+
+CompletionEngine::CompletionEngine( unsigned int queueDepth )
+{
+	if( queueDepth == 0 )
+		throw IllegalArgumentException( TEXT("Queue depth must be at least 1") );
+
+	this->_CompletionEngine( queueDepth );
+}
+
+CompletionEngine::~CompletionEngine()
+{
+	this->close();
+
+	// Left open by close() so that a late wakeup() cannot signal a reused descriptor
+	Platform::closeSocket( this->wakeupSocket );
+
+	// Initialised in _CompletionEngine()
+	Platform::cleanupSocketFramework();
+}
+
+void CompletionEngine::_CompletionEngine( unsigned int queueDepth )
+{
+	// Uninitialised in ~CompletionEngine
+	Platform::initialiseSocketFramework();
+
+	this->wakeupSocket = Platform::createWakeupSocket();
+	if( this->wakeupSocket == NATIVE_SOCKET_UNINIT )
+	{
+		Platform::cleanupSocketFramework();
+		throw IOException( Platform::describeLastSocketError() );
+	}
+
+	// Without a ring every operation is performed with a blocking call instead
+	this->ring = Platform::createUninitialisedRing();
+	this->native = Platform::initialiseRing( this->ring, queueDepth );
+	this->open = true;
+	this->wakeupBuffer = 0;
+	if( this->native )
+		this->armWakeup();
+
+	this->fixedBufferSize = 0;
+	this->fixedBufferCount = 0;
+	this->fixedRegistered = false;
+	this->providedBufferSize = 0;
+	this->providedBufferCount = 0;
+	this->completions.resize( MAX_COMPLETIONS );
+	this->failureCount = 0;
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+AsyncOperation* CompletionEngine::accept( ServerSocket* server,
+                                          ICompletionHandler* handler,
+                                          void* attachment )
+{
+	return this->startAccept( server, false, handler, attachment );
+}
+
+AsyncOperation* CompletionEngine::acceptMultishot( ServerSocket* server,
+                                                   ICompletionHandler* handler,
+                                                   void* attachment )
+{
+	return this->startAccept( server, true, handler, attachment );
+}
+
+AsyncOperation* CompletionEngine::receive( Socket* socket,
+                                           char* buffer,
+                                           int length,
+                                           ICompletionHandler* handler,
+                                           void* attachment )
+{
+	return this->startTransfer( socket, AO_RECEIVE, buffer, length, handler, attachment );
+}
+
+AsyncOperation* CompletionEngine::receiveMultishot( Socket* socket,
+                                                    ICompletionHandler* handler,
+                                                    void* attachment )
+{
+	this->checkOpen();
+	if( !handler )
+		throw IllegalArgumentException( TEXT("Multishot operations need a completion handler") );
+	if( this->providedBufferCount == 0 )
+		throw IllegalStateException( TEXT("No buffers have been provided") );
+
+	this->checkConnected( socket );
+	if( socket->isInputShutdown() )
+		throw SocketException( TEXT("Socket input has been shutdown") );
+
+	AsyncOperation* operation = new AsyncOperation( this, AO_RECEIVE, handler, attachment );
+	operation->socket = socket;
+	operation->selectBuffer = true;
+	operation->multishot = true;
+	this->start( operation );
+	return operation;
+}
+
+AsyncOperation* CompletionEngine::send( Socket* socket,
+                                        const char* buffer,
+                                        int length,
+                                        ICompletionHandler* handler,
+                                        void* attachment )
+{
+	// Sends only ever read from the buffer
+	return this->startTransfer( socket,
+	                            AO_SEND,
+	                            const_cast<char*>(buffer),
+	                            length,
+	                            handler,
+	                            attachment );
+}
+
+AsyncOperation* CompletionEngine::receiveFixed( Socket* socket,
+                                                unsigned int index,
+                                                int length,
+                                                ICompletionHandler* handler,
+                                                void* attachment )
+{
+	char* buffer = this->getFixedBuffer( index );
+	if( length < 0 || (size_t)length > this->fixedBufferSize )
+		throw IllegalArgumentException( TEXT("Length does not fit in the buffer") );
+
+	AsyncOperation* operation =
+		this->startTransfer( socket, AO_RECEIVE, buffer, length, handler, attachment );
+	operation->fixedIndex = (int)index;
+	return operation;
+}
+
+AsyncOperation* CompletionEngine::sendFixed( Socket* socket,
+                                             unsigned int index,
+                                             int length,
+                                             ICompletionHandler* handler,
+                                             void* attachment )
+{
+	char* buffer = this->getFixedBuffer( index );
+	if( length < 0 || (size_t)length > this->fixedBufferSize )
+		throw IllegalArgumentException( TEXT("Length does not fit in the buffer") );
+
+	AsyncOperation* operation =
+		this->startTransfer( socket, AO_SEND, buffer, length, handler, attachment );
+	operation->fixedIndex = (int)index;
+	return operation;
+}
+
+AsyncOperation* CompletionEngine::receive( MulticastSocket* socket,
+                                           DatagramPacket& packet,
+                                           ICompletionHandler* handler,
+                                           void* attachment )
+{
+	return this->startDatagram( socket, AO_RECEIVE_FROM, packet, handler, attachment );
+}
+
+AsyncOperation* CompletionEngine::send( MulticastSocket* socket,
+                                        DatagramPacket& packet,
+                                        ICompletionHandler* handler,
+                                        void* attachment )
+{
+	return this->startDatagram( socket, AO_SEND_TO, packet, handler, attachment );
+}
+
+void CompletionEngine::registerBuffers( size_t bufferSize, unsigned int count )
+{
+	this->checkOpen();
+	if( bufferSize == 0 || count == 0 )
+		throw IllegalArgumentException( TEXT("Buffer size and count must be at least 1") );
+	if( this->fixedBufferCount > 0 )
+		throw IllegalStateException( TEXT("Buffers have already been registered") );
+
+	this->fixedBuffers.resize( bufferSize * count );
+	this->fixedBufferSize = bufferSize;
+	this->fixedBufferCount = count;
+
+	// Registration pins the memory, which can be refused when the locked memory limit is low.
+	// The buffers then work like any other.
+	this->fixedRegistered = this->native &&
+	                        Platform::registerRingBuffers( this->ring,
+	                                                       &this->fixedBuffers[0],
+	                                                       bufferSize,
+	                                                       count );
+}
+
+char* CompletionEngine::getFixedBuffer( unsigned int index )
+{
+	if( index >= this->fixedBufferCount )
+		throw IllegalArgumentException( TEXT("No such registered buffer") );
+
+	return &this->fixedBuffers[index * this->fixedBufferSize];
+}
+
+size_t CompletionEngine::getFixedBufferSize() const
+{
+	return this->fixedBufferSize;
+}
+
+unsigned int CompletionEngine::getFixedBufferCount() const
+{
+	return this->fixedBufferCount;
+}
+
+void CompletionEngine::provideBuffers( size_t bufferSize, unsigned int count )
+{
+	this->checkOpen();
+	if( bufferSize == 0 || count == 0 || count > 65535 )
+		throw IllegalArgumentException( TEXT("Buffer count must be between 1 and 65535") );
+	if( this->providedBufferCount > 0 )
+		throw IllegalStateException( TEXT("Buffers have already been provided") );
+
+	this->providedBuffers.resize( bufferSize * count );
+	this->providedBufferSize = bufferSize;
+	this->providedBufferCount = count;
+
+	if( this->native )
+	{
+		RingOperation operation;
+		operation.type = RO_PROVIDE_BUFFERS;
+		operation.buffer = &this->providedBuffers[0];
+		operation.length = (unsigned int)bufferSize;
+		operation.count = count;
+		operation.bufferIndex = BUFFER_GROUP;
+		operation.bufferId = 0;
+		this->queueOperation( operation );
+		if( Platform::submitRing(this->ring, false, 0) < 0 )
+			throw IOException( Platform::describeLastSocketError() );
+	}
+	else
+	{
+		for( unsigned int i = count; i > 0; --i )
+			this->freeBuffers.push_back( (unsigned short)(i - 1) );
+	}
+}
+
+bool CompletionEngine::cancel( AsyncOperation* operation )
+{
+	this->checkOpen();
+	if( !operation || operation->done || this->pending.count(operation) == 0 )
+		return false;
+
+	if( this->native )
+	{
+		// Submitted straight away, so that the operation cannot finish and its address be
+		// reused by another before the kernel looks for it
+		RingOperation cancellation;
+		cancellation.type = RO_CANCEL;
+		cancellation.context = operation;
+		this->queueOperation( cancellation );
+		if( Platform::submitRing(this->ring, false, 0) < 0 )
+			throw IOException( Platform::describeLastSocketError() );
+
+		operation->cancelRequested = true;
+		return true;
+	}
+
+	// Without a ring, only operations that have not been performed yet can be stopped
+	std::deque<AsyncOperation*>::iterator position =
+		std::find( this->queued.begin(), this->queued.end(), operation );
+	if( position == this->queued.end() )
+		return false;
+
+	this->queued.erase( position );
+	operation->cancelRequested = true;
+	operation->fail( TEXT("Operation cancelled") );
+	this->finished.push_back( operation );
+	return true;
+}
+
+int CompletionEngine::submit()
+{
+	this->checkOpen();
+	if( this->native )
+	{
+		int result = Platform::submitRing( this->ring, false, 0 );
+		if( result < 0 )
+			throw IOException( Platform::describeLastSocketError() );
+
+		return result;
+	}
+
+	int count = 0;
+	while( !this->queued.empty() )
+	{
+		AsyncOperation* operation = this->queued.front();
+		this->queued.pop_front();
+		this->perform( operation );
+		this->finished.push_back( operation );
+		++count;
+	}
+
+	return count;
+}
+
+int CompletionEngine::poll()
+{
+	return this->poll( NATIVE_INFINITE_WAIT );
+}
+
+int CompletionEngine::poll( unsigned long timeout )
+{
+	this->checkOpen();
+	if( !this->native )
+	{
+		// Everything submitted has already been performed, so the only thing worth waiting for
+		// is a wakeup
+		this->submit();
+		if( this->finished.empty() && timeout != 0 )
+		{
+			SocketPoll wakeup;
+			wakeup.socket = this->wakeupSocket;
+			wakeup.interest = SE_READ;
+			wakeup.ready = 0;
+			Platform::pollSockets( &wakeup, 1, timeout );
+			Platform::clearWakeupSocket( this->wakeupSocket );
+		}
+
+		int delivered = 0;
+		while( !this->finished.empty() && delivered < (int)MAX_COMPLETIONS )
+		{
+			AsyncOperation* operation = this->finished.front();
+			this->finished.pop_front();
+			this->deliver( operation );
+			++delivered;
+		}
+
+		return delivered;
+	}
+
+	if( Platform::submitRing(this->ring, timeout != 0, timeout) < 0 )
+		throw IOException( Platform::describeLastSocketError() );
+
+	size_t count = Platform::reapRing( this->ring, &this->completions[0], this->completions.size() );
+	int delivered = 0;
+	for( size_t i = 0; i < count; ++i )
+	{
+		if( this->complete(this->completions[i]) )
+			++delivered;
+	}
+
+	return delivered;
+}
+
+int CompletionEngine::pollNow()
+{
+	return this->poll( 0 );
+}
+
+bool CompletionEngine::waitFor( AsyncOperation* operation, unsigned long timeout )
+{
+	this->checkOpen();
+	if( !operation || operation->engine != this )
+		throw IllegalArgumentException( TEXT("Operation does not belong to this engine") );
+
+	// The engine deletes operations that have a handler, possibly while we are waiting
+	if( operation->handler )
+		throw IllegalArgumentException( TEXT("Operations with a completion handler cannot be waited for") );
+
+	long long start = Platform::nanoTime();
+	while( !operation->done )
+	{
+		unsigned long remaining = NATIVE_INFINITE_WAIT;
+		if( timeout != NATIVE_INFINITE_WAIT )
+		{
+			long long elapsed = (Platform::nanoTime() - start) / 1000000;
+			if( elapsed >= (long long)timeout )
+				return false;
+
+			remaining = timeout - (unsigned long)elapsed;
+		}
+
+		this->poll( remaining );
+	}
+
+	return true;
+}
+
+void CompletionEngine::wakeup()
+{
+	Platform::signalWakeupSocket( this->wakeupSocket );
+}
+
+bool CompletionEngine::isNative() const
+{
+	return this->native;
+}
+
+size_t CompletionEngine::getPendingCount() const
+{
+	return this->pending.size();
+}
+
+unsigned long long CompletionEngine::getFailureCount() const
+{
+	return this->failureCount;
+}
+
+void CompletionEngine::close()
+{
+	if( !this->open )
+		return;
+
+	this->open = false;
+	if( this->native )
+	{
+		std::set<AsyncOperation*>::iterator iterator;
+		for( iterator = this->pending.begin(); iterator != this->pending.end(); ++iterator )
+		{
+			RingOperation cancellation;
+			cancellation.type = RO_CANCEL;
+			cancellation.context = *iterator;
+			try
+			{
+				this->queueOperation( cancellation );
+			}
+			catch( IOException& )
+			{
+				// Whatever cannot be cancelled is stopped when the ring is destroyed
+				break;
+			}
+		}
+
+		// Wait (briefly) for the kernel to let go of the operations' buffers before they are
+		// deleted
+		long long deadline = Platform::nanoTime() + 1000000000LL;
+		while( !this->pending.empty() && Platform::nanoTime() < deadline )
+		{
+			if( Platform::submitRing(this->ring, true, 100) < 0 )
+				break;
+
+			size_t count = Platform::reapRing( this->ring,
+			                                   &this->completions[0],
+			                                   this->completions.size() );
+			for( size_t i = 0; i < count; ++i )
+			{
+				void* context = this->completions[i].context;
+				if( !context || context == &this->wakeupBuffer )
+					continue;
+
+				AsyncOperation* operation = (AsyncOperation*)context;
+
+				int result = this->completions[i].result;
+				if( operation->type == AO_ACCEPT && result >= 0 )
+					Platform::closeSocket( (NATIVE_SOCKET)result );
+
+				if( !this->completions[i].more )
+				{
+					this->pending.erase( operation );
+					this->abandon( operation );
+				}
+			}
+		}
+
+		Platform::destroyRing( this->ring );
+	}
+
+	this->queued.clear();
+	this->finished.clear();
+
+	// Anything left is given up on
+	std::set<AsyncOperation*> remaining;
+	remaining.swap( this->pending );
+	std::set<AsyncOperation*>::iterator iterator;
+	for( iterator = remaining.begin(); iterator != remaining.end(); ++iterator )
+		this->abandon( *iterator );
+}
+
+bool CompletionEngine::isOpen() const
+{
+	return this->open;
+}
+
+AsyncOperation* CompletionEngine::startAccept( ServerSocket* server,
+                                               bool multishot,
+                                               ICompletionHandler* handler,
+                                               void* attachment )
+{
+	this->checkOpen();
+	if( !server )
+		throw IllegalArgumentException( TEXT("Server socket is NULL") );
+	if( multishot && !handler )
+		throw IllegalArgumentException( TEXT("Multishot operations need a completion handler") );
+	if( server->isClosed() )
+		throw SocketException( TEXT("Socket is closed") );
+	if( !server->isBound() )
+		throw SocketException( TEXT("Socket is not bound yet") );
+
+	AsyncOperation* operation = new AsyncOperation( this, AO_ACCEPT, handler, attachment );
+	operation->serverSocket = server;
+	operation->multishot = multishot;
+	this->start( operation );
+	return operation;
+}
+
+AsyncOperation* CompletionEngine::startTransfer( Socket* socket,
+                                                 AsyncOperationType type,
+                                                 char* buffer,
+                                                 int length,
+                                                 ICompletionHandler* handler,
+                                                 void* attachment )
+{
+	this->checkOpen();
+	if( !buffer )
+		throw IllegalArgumentException( TEXT("Buffer is NULL") );
+	if( length < 0 )
+		throw IllegalArgumentException( TEXT("Negative length") );
+
+	this->checkConnected( socket );
+	if( type == AO_RECEIVE && socket->isInputShutdown() )
+		throw SocketException( TEXT("Socket input has been shutdown") );
+	if( type == AO_SEND && socket->isOutputShutdown() )
+		throw SocketException( TEXT("Socket output has been shutdown") );
+
+	AsyncOperation* operation = new AsyncOperation( this, type, handler, attachment );
+	operation->socket = socket;
+	operation->buffer = buffer;
+	operation->length = length;
+	this->start( operation );
+	return operation;
+}
+
+AsyncOperation* CompletionEngine::startDatagram( MulticastSocket* socket,
+                                                 AsyncOperationType type,
+                                                 DatagramPacket& packet,
+                                                 ICompletionHandler* handler,
+                                                 void* attachment )
+{
+	this->checkOpen();
+	if( !socket )
+		throw IllegalArgumentException( TEXT("Socket is NULL") );
+	if( !socket->isCreated() )
+		throw SocketException( TEXT("Socket is closed") );
+	if( type == AO_SEND_TO && !socket->isBound() )
+		throw SocketException( TEXT("Socket is not bound") );
+	if( type == AO_SEND_TO && packet.getAddress() == INADDR_NONE )
+		throw SocketException( TEXT("Destination address in datagram packet is empty") );
+
+	AsyncOperation* operation = new AsyncOperation( this, type, handler, attachment );
+	operation->multicastSocket = socket;
+	operation->packet = &packet;
+	operation->buffer = packet.getData() + packet.getOffset();
+	operation->length = type == AO_SEND_TO ? packet.getLength() : packet.getBufferLength();
+	this->start( operation );
+	return operation;
+}
+
+void CompletionEngine::start( AsyncOperation* operation )
+{
+	if( this->native )
+	{
+		try
+		{
+			this->queueOperation( this->toRingOperation(operation) );
+		}
+		catch( IOException& )
+		{
+			// Never started, so nothing else knows about it
+			operation->done = true;
+			delete operation;
+			throw;
+		}
+	}
+	else
+	{
+		this->queued.push_back( operation );
+	}
+
+	this->pending.insert( operation );
+}
+
+RingOperation CompletionEngine::toRingOperation( AsyncOperation* operation )
+{
+	RingOperation ringOperation;
+	ringOperation.buffer = operation->buffer;
+	ringOperation.length = (unsigned int)operation->length;
+	ringOperation.multishot = operation->multishot;
+	ringOperation.header = operation->header;
+	ringOperation.context = operation;
+
+	switch( operation->type )
+	{
+		case AO_ACCEPT:
+			ringOperation.type = RO_ACCEPT;
+			ringOperation.socket = operation->serverSocket->getImpl();
+			break;
+
+		case AO_RECEIVE:
+		case AO_SEND:
+			ringOperation.socket = operation->socket->nativeSocket;
+			if( operation->fixedIndex >= 0 && this->fixedRegistered )
+			{
+				ringOperation.type = operation->type == AO_RECEIVE ? RO_READ_FIXED : RO_WRITE_FIXED;
+				ringOperation.bufferIndex = (unsigned short)operation->fixedIndex;
+			}
+			else
+			{
+				ringOperation.type = operation->type == AO_RECEIVE ? RO_RECEIVE : RO_SEND;
+			}
+
+			if( operation->selectBuffer )
+			{
+				ringOperation.selectBuffer = true;
+				ringOperation.bufferIndex = BUFFER_GROUP;
+				ringOperation.length = (unsigned int)this->providedBufferSize;
+			}
+			break;
+
+		case AO_RECEIVE_FROM:
+			ringOperation.type = RO_RECEIVE_FROM;
+			ringOperation.socket = operation->multicastSocket->nativeSocket;
+			break;
+
+		case AO_SEND_TO:
+			ringOperation.type = RO_SEND_TO;
+			ringOperation.socket = operation->multicastSocket->nativeSocket;
+			ringOperation.address = operation->packet->getAddress();
+			ringOperation.port = operation->packet->getPort();
+			break;
+	}
+
+	return ringOperation;
+}
+
+void CompletionEngine::queueOperation( const RingOperation& operation )
+{
+	if( Platform::queueRingOperation(this->ring, operation) )
+		return;
+
+	// The submission queue is full, so hand what is in it to the kernel to make room
+	if( Platform::submitRing(this->ring, false, 0) < 0 ||
+	    !Platform::queueRingOperation(this->ring, operation) )
+	{
+		throw IOException( TEXT("Submission queue is full") );
+	}
+}
+
+void CompletionEngine::armWakeup()
+{
+	RingOperation operation;
+	operation.type = RO_READ;
+	operation.socket = this->wakeupSocket;
+	operation.buffer = &this->wakeupBuffer;
+	operation.length = sizeof(this->wakeupBuffer);
+	operation.context = &this->wakeupBuffer;
+	this->queueOperation( operation );
+
+	// Submitted straight away, so that it is in place before anything waits, and is not counted
+	// as one of the caller's operations by submit()
+	if( Platform::submitRing(this->ring, false, 0) < 0 )
+		throw IOException( Platform::describeLastSocketError() );
+}
+
+void CompletionEngine::perform( AsyncOperation* operation )
+{
+	try
+	{
+		switch( operation->type )
+		{
+			case AO_ACCEPT:
+			{
+				// A non-blocking server socket with nothing to accept gives NULL
+				operation->accepted = operation->serverSocket->accept();
+				if( !operation->accepted )
+					operation->fail( TEXT("Resource temporarily unavailable") );
+				break;
+			}
+
+			case AO_RECEIVE:
+			{
+				if( operation->selectBuffer )
+				{
+					if( this->freeBuffers.empty() )
+					{
+						operation->fail( TEXT("No buffer space available") );
+						break;
+					}
+
+					operation->bufferId = this->freeBuffers.back();
+					operation->buffer = &this->providedBuffers[operation->bufferId *
+					                                           this->providedBufferSize];
+					operation->length = (int)this->providedBufferSize;
+					this->freeBuffers.pop_back();
+				}
+
+				int result = operation->socket->receive( operation->buffer, operation->length );
+				if( result < 0 )
+					operation->fail( TEXT("Resource temporarily unavailable") );
+				else
+					operation->result = result;
+				break;
+			}
+
+			case AO_SEND:
+				operation->result = operation->socket->send( operation->buffer, operation->length );
+				break;
+
+			case AO_RECEIVE_FROM:
+				if( operation->multicastSocket->receive(*operation->packet) )
+					operation->result = operation->packet->getLength();
+				else
+					operation->fail( TEXT("Resource temporarily unavailable") );
+				break;
+
+			case AO_SEND_TO:
+				if( operation->multicastSocket->send(*operation->packet) )
+					operation->result = operation->packet->getLength();
+				else
+					operation->fail( TEXT("Resource temporarily unavailable") );
+				break;
+		}
+	}
+	catch( IOException& e )
+	{
+		operation->fail( std::string(e.what()) );
+	}
+}
+
+bool CompletionEngine::complete( const RingCompletion& completion )
+{
+	// Cancellations and buffers handed back to the kernel have no operation of their own
+	if( !completion.context )
+		return false;
+
+	if( completion.context == &this->wakeupBuffer )
+	{
+		// Reading the wakeup consumed it, but drain anything else so one read covers them all
+		Platform::clearWakeupSocket( this->wakeupSocket );
+		if( this->open )
+			this->armWakeup();
+		return false;
+	}
+
+	AsyncOperation* operation = (AsyncOperation*)completion.context;
+
+	operation->more = completion.more;
+	if( completion.result < 0 )
+	{
+		operation->fail( Platform::describeSocketError(-completion.result) );
+		this->deliver( operation );
+		return true;
+	}
+
+	operation->result = completion.result;
+	switch( operation->type )
+	{
+		case AO_ACCEPT:
+		{
+			NATIVE_SOCKET client = (NATIVE_SOCKET)completion.result;
+			NATIVE_IP_ADDRESS address = INADDR_NONE;
+			unsigned short port = 0;
+			Platform::getPeerAddress( client, address, port );
+
+			const SocketOptions& options = operation->serverSocket->getOptions();
+			if( !Platform::applySocketOptions(client, options) )
+			{
+				operation->fail( Platform::describeLastSocketError() );
+				Platform::closeSocket( client );
+				this->deliver( operation );
+				return true;
+			}
+
+			operation->accepted = Socket::createFromAccept( client,
+			                                                InetSocketAddress(address, port),
+			                                                options );
+			operation->result = 0;
+			break;
+		}
+
+		case AO_RECEIVE:
+			if( completion.bufferId >= 0 )
+			{
+				operation->bufferId = completion.bufferId;
+				operation->buffer = &this->providedBuffers[completion.bufferId *
+				                                           this->providedBufferSize];
+			}
+			break;
+
+		case AO_RECEIVE_FROM:
+		{
+			NATIVE_IP_ADDRESS address;
+			unsigned short port;
+			Platform::getRingSender( operation->header, address, port );
+			operation->packet->setLength( completion.result );
+			operation->packet->setAddress( address );
+			operation->packet->setPort( port );
+			operation->packet->setSegmentSize( 0 );
+			break;
+		}
+
+		case AO_SEND:
+		case AO_SEND_TO:
+			break;
+	}
+
+	this->deliver( operation );
+	return true;
+}
+
+void CompletionEngine::deliver( AsyncOperation* operation )
+{
+	if( !operation->more )
+	{
+		operation->done = true;
+		this->pending.erase( operation );
+	}
+
+	// Without a handler, the result stays in the operation for the caller to collect
+	if( !operation->handler )
+		return;
+
+	try
+	{
+		operation->handler->completed( *operation );
+	}
+	catch( ... )
+	{
+		++this->failureCount;
+	}
+
+	this->release( operation );
+	if( operation->done )
+		delete operation;
+}
+
+void CompletionEngine::release( AsyncOperation* operation )
+{
+	delete operation->accepted;
+	operation->accepted = NULL;
+
+	if( operation->bufferId >= 0 )
+	{
+		this->recycleBuffer( (unsigned short)operation->bufferId );
+		operation->bufferId = -1;
+		operation->buffer = NULL;
+	}
+
+	// The next result of a multishot operation starts afresh
+	operation->failed = false;
+	operation->error.clear();
+	operation->result = 0;
+}
+
+void CompletionEngine::recycleBuffer( unsigned short bufferId )
+{
+	if( !this->open )
+		return;
+
+	if( !this->native )
+	{
+		this->freeBuffers.push_back( bufferId );
+		return;
+	}
+
+	RingOperation operation;
+	operation.type = RO_PROVIDE_BUFFERS;
+	operation.buffer = &this->providedBuffers[bufferId * this->providedBufferSize];
+	operation.length = (unsigned int)this->providedBufferSize;
+	operation.count = 1;
+	operation.bufferIndex = BUFFER_GROUP;
+	operation.bufferId = bufferId;
+	try
+	{
+		this->queueOperation( operation );
+	}
+	catch( IOException& )
+	{
+		// The pool is one buffer smaller until the engine is closed
+		++this->failureCount;
+	}
+}
+
+void CompletionEngine::abandon( AsyncOperation* operation )
+{
+	delete operation->accepted;
+	operation->accepted = NULL;
+	operation->bufferId = -1;
+	operation->more = false;
+	operation->done = true;
+	operation->fail( TEXT("Completion engine closed") );
+
+	if( operation->handler )
+		delete operation;
+}
+
+void CompletionEngine::checkOpen() const
+{
+	if( !this->open )
+		throw IllegalStateException( TEXT("Completion engine is closed") );
+}
+
+void CompletionEngine::checkConnected( Socket* socket ) const
+{
+	if( !socket )
+		throw IllegalArgumentException( TEXT("Socket is NULL") );
+	if( socket->isClosed() )
+		throw SocketException( TEXT("Socket is closed") );
+	if( !socket->isConnected() )
+		throw SocketException( TEXT("Socket is not connected") );
+}
@@ -0,0 +1,202 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "syscommon/CpuTopology.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+//----------------------------------------------------------
+//                    STATIC VARIABLES
+//----------------------------------------------------------
+const unsigned int CpuTopology::DEFAULT_CACHE_LINE_SIZE;
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+CpuTopology::CpuTopology()
+{
+	this->coreCount = 0;
+	this->packageCount = 0;
+}
+
+CpuTopology::~CpuTopology()
+{
+
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+unsigned int CpuTopology::getProcessorCount() const
+{
+	return (unsigned int)this->processors.size();
+}
+
+unsigned int CpuTopology::getCoreCount() const
+{
+	return this->coreCount;
+}
+
+unsigned int CpuTopology::getPackageCount() const
+{
+	return this->packageCount;
+}
+
+unsigned int CpuTopology::getThreadsPerCore() const
+{
+	std::vector<unsigned int> threadCounts( this->coreCount, 0 );
+	unsigned int highest = 0;
+	for( size_t i = 0; i < this->processors.size(); ++i )
+	{
+		unsigned int count = ++threadCounts[this->processors[i].core];
+		if( count > highest )
+			highest = count;
+	}
+
+	return highest;
+}
+
+const std::vector<int>& CpuTopology::getNodes() const
+{
+	return this->nodes;
+}
+
+const std::vector<ProcessorInfo>& CpuTopology::getProcessors() const
+{
+	return this->processors;
+}
+
+const std::vector<CacheInfo>& CpuTopology::getCaches() const
+{
+	return this->caches;
+}
+
+size_t CpuTopology::getCacheSize( unsigned int level ) const
+{
+	for( size_t i = 0; i < this->caches.size(); ++i )
+	{
+		const CacheInfo& cache = this->caches[i];
+		if( cache.level == level && cache.type != CT_INSTRUCTION )
+			return cache.size;
+	}
+
+	return 0;
+}
+
+unsigned int CpuTopology::getCacheLineSize() const
+{
+	// The line size is the same throughout the hierarchy on every machine we run on, so take
+	// the first level that reports one
+	for( size_t i = 0; i < this->caches.size(); ++i )
+	{
+		if( this->caches[i].type != CT_INSTRUCTION && this->caches[i].lineSize > 0 )
+			return this->caches[i].lineSize;
+	}
+
+	return DEFAULT_CACHE_LINE_SIZE;
+}
+
+int CpuTopology::getNodeOf( unsigned int processor ) const
+{
+	const ProcessorInfo* info = this->findProcessor( processor );
+	return info ? info->node : -1;
+}
+
+std::vector<unsigned int> CpuTopology::getNodeProcessors( int node ) const
+{
+	std::vector<unsigned int> result;
+	for( size_t i = 0; i < this->processors.size(); ++i )
+	{
+		if( this->processors[i].node == node )
+			result.push_back( this->processors[i].id );
+	}
+
+	return result;
+}
+
+std::vector<unsigned int> CpuTopology::getSiblings( unsigned int processor ) const
+{
+	std::vector<unsigned int> result;
+	const ProcessorInfo* info = this->findProcessor( processor );
+	if( !info )
+		return result;
+
+	for( size_t i = 0; i < this->processors.size(); ++i )
+	{
+		if( this->processors[i].core == info->core )
+			result.push_back( this->processors[i].id );
+	}
+
+	return result;
+}
+
+std::vector<unsigned int> CpuTopology::getOnePerCore() const
+{
+	std::vector<unsigned int> result;
+	std::vector<bool> coreTaken( this->coreCount, false );
+	for( size_t i = 0; i < this->processors.size(); ++i )
+	{
+		const ProcessorInfo& info = this->processors[i];
+		if( !coreTaken[info.core] )
+		{
+			coreTaken[info.core] = true;
+			result.push_back( info.id );
+		}
+	}
+
+	return result;
+}
+
+std::vector<unsigned int> CpuTopology::getOnePerCore( int node ) const
+{
+	std::vector<unsigned int> result;
+	std::vector<unsigned int> all = this->getOnePerCore();
+	for( size_t i = 0; i < all.size(); ++i )
+	{
+		if( this->getNodeOf(all[i]) == node )
+			result.push_back( all[i] );
+	}
+
+	return result;
+}
+
+const ProcessorInfo* CpuTopology::findProcessor( unsigned int processor ) const
+{
+	// Processors are sorted by id, so a binary search will do
+	size_t low = 0;
+	size_t high = this->processors.size();
+	while( low < high )
+	{
+		size_t middle = low + (high - low) / 2;
+		if( this->processors[middle].id < processor )
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	if( low < this->processors.size() && this->processors[low].id == processor )
+		return &this->processors[low];
+	else
+		return NULL;
+}
+
+ProcessorInfo* CpuTopology::findProcessor( unsigned int processor )
+{
+	const CpuTopology* constThis = this;
+	return const_cast<ProcessorInfo*>( constThis->findProcessor(processor) );
+}
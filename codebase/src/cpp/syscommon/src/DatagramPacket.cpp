@@ -74,6 +74,7 @@ void DatagramPacket::_DatagramPacket( char* buffer,
 	this->address = address;
 	this->port = port;
 	this->bufferLength = length;
+	this->segmentSize = 0;
 }
 
 //----------------------------------------------------------
@@ -104,6 +105,11 @@ void DatagramPacket::setLength( int length )
 	this->length = length;
 }
 
+void DatagramPacket::setSegmentSize( int segmentSize )
+{
+	this->segmentSize = segmentSize;
+}
+
 char* DatagramPacket::getData() const
 {
 	return this->buffer;
@@ -124,6 +130,11 @@ int DatagramPacket::getBufferLength() const
 	return this->bufferLength;
 }
 
+int DatagramPacket::getSegmentSize() const
+{
+	return this->segmentSize;
+}
+
 NATIVE_IP_ADDRESS DatagramPacket::getAddress() const
 {
 	return this->address;
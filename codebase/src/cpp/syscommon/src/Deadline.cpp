@@ -0,0 +1,89 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "syscommon/util/Deadline.h"
+
+#include <limits.h>
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+static const unsigned long long MAX_TIMEOUT_MILLIS = LLONG_MAX / 4000000LL;
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+Deadline::Deadline( unsigned long timeoutMillis )
+{
+	// Anything too long to represent in nanoseconds (a few hundred years) is as good as infinite
+	this->infinite = timeoutMillis == NATIVE_INFINITE_WAIT ||
+	                 (unsigned long long)timeoutMillis > MAX_TIMEOUT_MILLIS;
+	this->expiryNanos = 0;
+	if( !this->infinite )
+		this->expiryNanos = Platform::nanoTime() + (long long)timeoutMillis * 1000000LL;
+}
+
+Deadline::~Deadline()
+{
+
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+bool Deadline::isInfinite() const
+{
+	return this->infinite;
+}
+
+bool Deadline::hasExpired() const
+{
+	return this->getRemainingNanos() == 0;
+}
+
+long long Deadline::getRemainingNanos() const
+{
+	if( this->infinite )
+		return LLONG_MAX;
+
+	long long remaining = this->expiryNanos - Platform::nanoTime();
+	return remaining > 0 ? remaining : 0;
+}
+
+unsigned long Deadline::getRemainingMillis() const
+{
+	if( this->infinite )
+		return NATIVE_INFINITE_WAIT;
+
+	long long remaining = (this->getRemainingNanos() + 999999LL) / 1000000LL;
+
+	// Keep a finite deadline from turning into an infinite wait
+	if( (unsigned long long)remaining >= (unsigned long long)NATIVE_INFINITE_WAIT )
+		remaining = (long long)(NATIVE_INFINITE_WAIT - 1);
+
+	return (unsigned long)remaining;
+}
+
+//----------------------------------------------------------
+//                     STATIC METHODS
+//----------------------------------------------------------
+Deadline Deadline::fromNanos( long long timeoutNanos )
+{
+	Deadline deadline( 0 );
+	deadline.expiryNanos += timeoutNanos;
+	return deadline;
+}
@@ -0,0 +1,256 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "syscommon/net/EventLoop.h"
+
+#include <limits.h>
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+//----------------------------------------------------------
+//                    STATIC VARIABLES
+//----------------------------------------------------------
+static thread_local EventLoop* currentLoop = NULL;
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+EventLoop::EventLoop() : stopped( false ), sleeping( false ), failureCount( 0 )
+{
+
+}
+
+EventLoop::EventLoop( unsigned int queueDepth ) : engine( queueDepth ),
+                                                  stopped( false ),
+                                                  sleeping( false ),
+                                                  failureCount( 0 )
+{
+
+}
+
+EventLoop::~EventLoop()
+{
+	// Close the engine first, so that nothing is left writing into the frames of the tasks
+	this->engine.close();
+
+	std::set<IRunnable*>::iterator it;
+	for( it = this->tasks.begin() ; it != this->tasks.end() ; ++it )
+		delete *it;
+
+	for( size_t i = 0; i < this->retired.size(); ++i )
+		delete this->retired[i];
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+void EventLoop::run()
+{
+	currentLoop = this;
+
+	std::vector<IRunnable*> posted;
+	while( !this->stopped )
+	{
+		this->runTasks( posted );
+
+		// Only what is ready now, so that coroutines that keep resuming each other cannot keep
+		// the loop from its engine
+		for( size_t count = this->ready.size(); count > 0; --count )
+		{
+			IRunnable* task = this->ready.front();
+			this->ready.pop_front();
+			this->runTask( task );
+		}
+
+		long long now = Platform::nanoTime();
+		while( !this->timers.empty() && this->timers.begin()->first <= now )
+		{
+			IRunnable* task = this->timers.begin()->second;
+			this->timers.erase( this->timers.begin() );
+			this->runTask( task );
+		}
+
+		for( size_t i = 0; i < this->retired.size(); ++i )
+			delete this->retired[i];
+
+		this->retired.clear();
+
+		unsigned long timeout = this->getWaitTime();
+		if( timeout != 0 )
+		{
+			// Say that we are going to sleep before the last look at the inbox. A post() that
+			// comes after the look will see the flag and wake us.
+			this->sleeping = true;
+
+			LockGuard guard( this->inboxLock );
+			if( !this->inbox.empty() || this->stopped )
+			{
+				this->sleeping = false;
+				timeout = 0;
+			}
+		}
+
+		try
+		{
+			this->engine.poll( timeout );
+		}
+		catch( IOException& )
+		{
+			// The engine itself has failed, so there is no resuming anything more
+			++this->failureCount;
+			break;
+		}
+
+		this->sleeping = false;
+	}
+
+	currentLoop = NULL;
+}
+
+void EventLoop::stop()
+{
+	this->stopped = true;
+	this->engine.wakeup();
+}
+
+bool EventLoop::isStopped() const
+{
+	return this->stopped;
+}
+
+void EventLoop::post( IRunnable* task )
+{
+	{
+		LockGuard guard( this->inboxLock );
+		this->inbox.push_back( task );
+	}
+
+	if( this->sleeping.exchange(false) )
+		this->engine.wakeup();
+}
+
+void EventLoop::defer( IRunnable* task )
+{
+	this->ready.push_back( task );
+}
+
+void EventLoop::schedule( unsigned long delay, IRunnable* task )
+{
+	long long deadline = Platform::nanoTime() + (long long)delay * 1000000LL;
+	this->timers.insert( std::make_pair(deadline, task) );
+}
+
+CompletionEngine& EventLoop::getEngine()
+{
+	return this->engine;
+}
+
+size_t EventLoop::getTaskCount()
+{
+	LockGuard guard( this->inboxLock );
+	return this->tasks.size();
+}
+
+unsigned long long EventLoop::getFailureCount() const
+{
+	return this->failureCount;
+}
+
+void EventLoop::adopt( IRunnable* task )
+{
+	{
+		LockGuard guard( this->inboxLock );
+		this->tasks.insert( task );
+		this->inbox.push_back( task );
+	}
+
+	if( this->sleeping.exchange(false) )
+		this->engine.wakeup();
+}
+
+void EventLoop::retire( IRunnable* task )
+{
+	{
+		LockGuard guard( this->inboxLock );
+		this->tasks.erase( task );
+	}
+
+	// The task is still running, so it can only be deleted once the turn is over
+	this->retired.push_back( task );
+}
+
+void EventLoop::runTasks( std::vector<IRunnable*>& tasks )
+{
+	{
+		LockGuard guard( this->inboxLock );
+		tasks.swap( this->inbox );
+	}
+
+	for( size_t i = 0; i < tasks.size(); ++i )
+		this->runTask( tasks[i] );
+
+	tasks.clear();
+}
+
+void EventLoop::runTask( IRunnable* task )
+{
+	try
+	{
+		task->run();
+	}
+	catch( ... )
+	{
+		++this->failureCount;
+	}
+}
+
+unsigned long EventLoop::getWaitTime() const
+{
+	if( !this->ready.empty() )
+		return 0;
+
+	if( this->timers.empty() )
+		return NATIVE_INFINITE_WAIT;
+
+	long long remaining = this->timers.begin()->first - Platform::nanoTime();
+	if( remaining <= 0 )
+		return 0;
+
+	// Round up, so that the timer is due by the time the wait ends
+	unsigned long long milliseconds = (unsigned long long)(remaining + 999999) / 1000000;
+	if( milliseconds >= (unsigned long long)NATIVE_INFINITE_WAIT )
+		return NATIVE_INFINITE_WAIT - 1;
+	else
+		return (unsigned long)milliseconds;
+}
+
+//----------------------------------------------------------
+//                     STATIC METHODS
+//----------------------------------------------------------
+EventLoop* EventLoop::current()
+{
+	return currentLoop;
+}
+
+EventLoop* EventLoop::requireCurrent()
+{
+	if( !currentLoop )
+		throw IllegalStateException( TEXT("There is no event loop running on this thread") );
+
+	return currentLoop;
+}
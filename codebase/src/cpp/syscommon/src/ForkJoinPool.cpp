@@ -0,0 +1,369 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "syscommon/concurrent/ForkJoinPool.h"
+
+#include <algorithm>
+#include <limits.h>
+#include "syscommon/util/StringUtils.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+//----------------------------------------------------------
+//                    STATIC VARIABLES
+//----------------------------------------------------------
+unsigned long ForkJoinPool::POOL_ID_COUNTER = 0;
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+ForkJoinPool::ForkJoinPool() :
+	submissionCount( 0 ),
+	workSequence( 0 ),
+	idleCount( 0 ),
+	workEvent( false, TEXT("ForkJoinWork") ),
+	joinWaiterCount( 0 )
+{
+	this->_ForkJoinPool( Platform::getProcessorCount() );
+}
+
+ForkJoinPool::ForkJoinPool( unsigned int parallelism ) :
+	submissionCount( 0 ),
+	workSequence( 0 ),
+	idleCount( 0 ),
+	workEvent( false, TEXT("ForkJoinWork") ),
+	joinWaiterCount( 0 )
+{
+	this->_ForkJoinPool( parallelism );
+}
+
+ForkJoinPool::~ForkJoinPool()
+{
+	this->idleLock.lock();
+	this->shuttingDown = true;
+	this->workEvent.signal();
+	this->idleLock.unlock();
+
+	std::vector<ForkJoinWorkerThread*>::iterator it = this->workers.begin();
+	for( ; it != this->workers.end(); ++it )
+		(*it)->join();
+
+	for( it = this->workers.begin(); it != this->workers.end(); ++it )
+		delete *it;
+
+	this->workers.clear();
+}
+
+void ForkJoinPool::_ForkJoinPool( unsigned int parallelism )
+{
+	if( parallelism == 0 )
+		throw IllegalArgumentException( TEXT("Parallelism must be greater than zero") );
+
+	this->shuttingDown = false;
+
+	String namePrefix = TEXT("ForkJoinPool-");
+	namePrefix.append( StringUtils::longToString(POOL_ID_COUNTER++) );
+	namePrefix.append( TEXT("-Worker-") );
+
+	for( unsigned int i = 0 ; i < parallelism ; ++i )
+	{
+		String workerName = namePrefix + StringUtils::longToString( i );
+		this->workers.push_back( new ForkJoinWorkerThread(this, i, workerName.c_str()) );
+	}
+
+	// Workers steal from each other through the vector, so it must be complete before any start
+	std::vector<ForkJoinWorkerThread*>::iterator it = this->workers.begin();
+	for( ; it != this->workers.end(); ++it )
+		(*it)->start();
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+void ForkJoinPool::submit( ForkJoinTask* task )
+{
+	task->pool = this;
+
+	ForkJoinWorkerThread* worker = ForkJoinWorkerThread::current();
+	if( worker && worker->getPool() == this )
+	{
+		worker->workQueue.push( task );
+	}
+	else
+	{
+		this->submissionLock.lock();
+		this->submissionQueue.push_back( task );
+		this->submissionCount.fetch_add( 1, std::memory_order_seq_cst );
+		this->submissionLock.unlock();
+	}
+
+	this->signalWork();
+}
+
+void ForkJoinPool::invoke( ForkJoinTask* task )
+{
+	ForkJoinWorkerThread* worker = ForkJoinWorkerThread::current();
+	if( worker && worker->getPool() == this )
+	{
+		task->pool = this;
+		task->invoke();
+	}
+	else
+	{
+		this->submit( task );
+		task->join();
+	}
+}
+
+unsigned int ForkJoinPool::getParallelism() const
+{
+	return (unsigned int)this->workers.size();
+}
+
+unsigned long ForkJoinPool::getStealCount() const
+{
+	unsigned long total = 0;
+
+	std::vector<ForkJoinWorkerThread*>::const_iterator it = this->workers.begin();
+	for( ; it != this->workers.end(); ++it )
+		total += (*it)->getStealCount();
+
+	return total;
+}
+
+ForkJoinTask* ForkJoinPool::scan( ForkJoinWorkerThread* worker )
+{
+	// Our own work first, newest first
+	ForkJoinTask* task = worker->workQueue.take();
+	if( task )
+		return task;
+
+	// Then try to steal the oldest task of another worker, starting at a random victim so that
+	// thieves spread themselves out
+	size_t workerCount = this->workers.size();
+	size_t start = worker->nextRandom() % workerCount;
+	for( size_t i = 0 ; i < workerCount ; ++i )
+	{
+		ForkJoinWorkerThread* victim = this->workers[(start + i) % workerCount];
+		if( victim == worker )
+			continue;
+
+		task = victim->workQueue.steal();
+		if( task )
+		{
+			worker->stealCount.fetch_add( 1, std::memory_order_relaxed );
+			return task;
+		}
+	}
+
+	// Finally, anything submitted from outside the pool
+	return this->pollSubmission();
+}
+
+ForkJoinTask* ForkJoinPool::pollSubmission()
+{
+	ForkJoinTask* task = NULL;
+
+	if( this->submissionCount.load(std::memory_order_seq_cst) > 0 )
+	{
+		this->submissionLock.lock();
+		if( !this->submissionQueue.empty() )
+		{
+			task = this->submissionQueue.front();
+			this->submissionQueue.pop_front();
+			this->submissionCount.fetch_sub( 1, std::memory_order_seq_cst );
+		}
+		this->submissionLock.unlock();
+	}
+
+	return task;
+}
+
+ForkJoinTask* ForkJoinPool::awaitWork( ForkJoinWorkerThread* worker )
+{
+	// Announce that we are going idle before the final scan. Anyone publishing work after that
+	// scan will either see us in the idle count, or we will see their sequence change.
+	this->idleCount.fetch_add( 1, std::memory_order_seq_cst );
+	unsigned long sequence = this->workSequence.load( std::memory_order_seq_cst );
+
+	ForkJoinTask* task = this->scan( worker );
+	if( !task )
+	{
+		bool park = false;
+
+		this->idleLock.lock();
+		if( !this->shuttingDown &&
+			this->workSequence.load(std::memory_order_seq_cst) == sequence )
+		{
+			this->workEvent.clear();
+			park = true;
+		}
+		this->idleLock.unlock();
+
+		if( park )
+			this->workEvent.waitFor();
+	}
+
+	this->idleCount.fetch_sub( 1, std::memory_order_seq_cst );
+	return task;
+}
+
+void ForkJoinPool::signalWork()
+{
+	this->workSequence.fetch_add( 1, std::memory_order_seq_cst );
+	if( this->idleCount.load(std::memory_order_seq_cst) > 0 )
+	{
+		this->idleLock.lock();
+		this->workEvent.signal();
+
+		// Workers parked while joining can help with the new work as well
+		std::vector<JoinWaiter*>::iterator it = this->joinWaiters.begin();
+		for( ; it != this->joinWaiters.end(); ++it )
+		{
+			if( (*it)->stealing )
+				(*it)->wakeup->signal();
+		}
+
+		this->idleLock.unlock();
+	}
+}
+
+void ForkJoinPool::helpJoin( ForkJoinWorkerThread* worker, ForkJoinTask* task )
+{
+	int fruitlessScans = 0;
+	while( !task->isDone() )
+	{
+		ForkJoinTask* other = this->scan( worker );
+		if( !other )
+		{
+			if( ++fruitlessScans < SPINS_BEFORE_PARK )
+			{
+				Platform::yieldThread();
+				continue;
+			}
+
+			// Nothing is left to help with, so the task is running on another worker and may
+			// take a while. Park until it is done or there is something new to steal.
+			other = this->awaitJoin( worker, task );
+		}
+
+		if( other )
+			other->exec();
+
+		fruitlessScans = 0;
+	}
+}
+
+ForkJoinTask* ForkJoinPool::awaitJoin( ForkJoinWorkerThread* worker, ForkJoinTask* task )
+{
+	ForkJoinTask* found = NULL;
+
+	Event wakeup( false, TEXT("ForkJoinJoin") );
+	JoinWaiter waiter;
+	waiter.task = task;
+	waiter.stealing = worker != NULL;
+	waiter.wakeup = &wakeup;
+
+	// Register before the final checks. Anyone completing the task or publishing work after
+	// them will find us in the list, and their signal stays on our event until we clear it.
+	this->idleLock.lock();
+	this->joinWaiters.push_back( &waiter );
+	this->joinWaiterCount.fetch_add( 1, std::memory_order_seq_cst );
+	if( worker )
+		this->idleCount.fetch_add( 1, std::memory_order_seq_cst );
+	this->idleLock.unlock();
+
+	unsigned long sequence = this->workSequence.load( std::memory_order_seq_cst );
+	if( worker )
+		found = this->scan( worker );
+
+	// Only we clear our event, and only before looking at what we are waiting for
+	while( !found &&
+		   !task->isDone() &&
+		   (!worker || this->workSequence.load(std::memory_order_seq_cst) == sequence) )
+	{
+		wakeup.waitFor();
+		wakeup.clear();
+	}
+
+	// Nobody signals the event once we are out of the list, so it can go with this frame
+	this->idleLock.lock();
+	this->joinWaiters.erase( std::find(this->joinWaiters.begin(), this->joinWaiters.end(), &waiter) );
+	this->joinWaiterCount.fetch_sub( 1, std::memory_order_seq_cst );
+	if( worker )
+		this->idleCount.fetch_sub( 1, std::memory_order_seq_cst );
+	this->idleLock.unlock();
+
+	return found;
+}
+
+void ForkJoinPool::taskCompleted( const ForkJoinTask* task )
+{
+	if( this->joinWaiterCount.load(std::memory_order_seq_cst) > 0 )
+	{
+		this->idleLock.lock();
+		std::vector<JoinWaiter*>::iterator it = this->joinWaiters.begin();
+		for( ; it != this->joinWaiters.end(); ++it )
+		{
+			if( (*it)->task == task )
+				(*it)->wakeup->signal();
+		}
+		this->idleLock.unlock();
+	}
+}
+
+void ForkJoinPool::runWorker( ForkJoinWorkerThread* worker )
+{
+	int idleScans = 0;
+
+	while( !this->shuttingDown )
+	{
+		ForkJoinTask* task = this->scan( worker );
+		if( !task )
+		{
+			if( idleScans < SPINS_BEFORE_PARK )
+			{
+				++idleScans;
+				Platform::yieldThread();
+				continue;
+			}
+
+			task = this->awaitWork( worker );
+		}
+
+		if( task )
+		{
+			idleScans = 0;
+			task->exec();
+		}
+	}
+}
+
+//----------------------------------------------------------
+//                     STATIC METHODS
+//----------------------------------------------------------
+ForkJoinPool* ForkJoinPool::getCurrentPool()
+{
+	ForkJoinWorkerThread* worker = ForkJoinWorkerThread::current();
+	return worker ? worker->getPool() : NULL;
+}
+
+bool ForkJoinPool::inForkJoinPool()
+{
+	return ForkJoinWorkerThread::current() != NULL;
+}
@@ -0,0 +1,122 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "syscommon/concurrent/ForkJoinTask.h"
+
+#include "syscommon/concurrent/ForkJoinPool.h"
+#include "syscommon/concurrent/ForkJoinWorkerThread.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+ForkJoinTask::ForkJoinTask() : status( TS_PENDING )
+{
+	this->pool = NULL;
+}
+
+ForkJoinTask::~ForkJoinTask()
+{
+
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+void ForkJoinTask::fork()
+{
+	ForkJoinWorkerThread* worker = ForkJoinWorkerThread::current();
+	if( worker )
+	{
+		this->pool = worker->getPool();
+		worker->workQueue.push( this );
+		this->pool->signalWork();
+	}
+	else
+	{
+		// Not inside a pool, so there is no deque to place the task on
+		this->exec();
+	}
+}
+
+void ForkJoinTask::join()
+{
+	if( !this->isDone() )
+	{
+		ForkJoinWorkerThread* worker = ForkJoinWorkerThread::current();
+		if( worker && worker->getPool() == this->pool )
+			this->pool->helpJoin( worker, this );
+		else if( this->pool )
+			this->pool->awaitJoin( NULL, this );
+		else
+			this->exec();
+	}
+
+	this->reportFailure();
+}
+
+void ForkJoinTask::invoke()
+{
+	this->exec();
+	this->reportFailure();
+}
+
+bool ForkJoinTask::isDone() const
+{
+	return this->status.load( std::memory_order_acquire ) != TS_PENDING;
+}
+
+bool ForkJoinTask::isCompletedAbnormally() const
+{
+	return this->status.load( std::memory_order_acquire ) == TS_FAILED;
+}
+
+void ForkJoinTask::exec()
+{
+	// Once the status is published the joining thread may destroy this task, so take what we
+	// need from it first
+	ForkJoinPool* owningPool = this->pool;
+	int finalStatus = TS_COMPLETED;
+
+	try
+	{
+		this->run();
+	}
+	catch( std::exception& e )
+	{
+		this->failure = Platform::toPlatformString( e.what() );
+		finalStatus = TS_FAILED;
+	}
+	catch( ... )
+	{
+		this->failure = TEXT("Task threw an unknown exception");
+		finalStatus = TS_FAILED;
+	}
+
+	this->status.store( finalStatus, std::memory_order_seq_cst );
+
+	if( owningPool )
+		owningPool->taskCompleted( this );
+}
+
+void ForkJoinTask::reportFailure()
+{
+	if( this->status.load(std::memory_order_acquire) == TS_FAILED )
+		throw ExecutionException( this->failure.c_str() );
+}
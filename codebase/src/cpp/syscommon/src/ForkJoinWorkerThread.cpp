@@ -0,0 +1,88 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "syscommon/concurrent/ForkJoinWorkerThread.h"
+
+#include "syscommon/concurrent/ForkJoinPool.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+ForkJoinWorkerThread::ForkJoinWorkerThread( ForkJoinPool* pool,
+											unsigned int poolIndex,
+											const tchar* name ) :
+	Thread( NULL, name ), stealCount( 0 )
+{
+	this->pool = pool;
+	this->poolIndex = poolIndex;
+
+	// Any non-zero seed will do, it only has to differ between workers
+	this->randomSeed = (poolIndex + 1) * 2654435761U;
+	if( this->randomSeed == 0 )
+		this->randomSeed = 1;
+}
+
+ForkJoinWorkerThread::~ForkJoinWorkerThread()
+{
+
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+ForkJoinPool* ForkJoinWorkerThread::getPool() const
+{
+	return this->pool;
+}
+
+unsigned int ForkJoinWorkerThread::getPoolIndex() const
+{
+	return this->poolIndex;
+}
+
+unsigned long ForkJoinWorkerThread::getStealCount() const
+{
+	return this->stealCount.load( std::memory_order_relaxed );
+}
+
+void ForkJoinWorkerThread::run()
+{
+	this->pool->runWorker( this );
+}
+
+unsigned int ForkJoinWorkerThread::nextRandom()
+{
+	// xorshift32
+	unsigned int x = this->randomSeed;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	this->randomSeed = x;
+
+	return x;
+}
+
+//----------------------------------------------------------
+//                     STATIC METHODS
+//----------------------------------------------------------
+ForkJoinWorkerThread* ForkJoinWorkerThread::current()
+{
+	return dynamic_cast<ForkJoinWorkerThread*>( Thread::currentThread() );
+}
@@ -0,0 +1,175 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "syscommon/concurrent/Future.h"
+
+#include <limits.h>
+#include "syscommon/concurrent/ThreadPoolExecutor.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+Future::Future( IRunnable* task, ThreadPoolExecutor* executor, bool detached ) :
+	doneEvent( false, TEXT("FutureDone") )
+{
+	this->task = task;
+	this->executor = executor;
+	this->detached = detached;
+	this->state = FS_PENDING;
+	this->runner = NULL;
+}
+
+Future::~Future()
+{
+	// Make sure the executor no longer holds a reference to us, then wait out a running task
+	this->cancel( false );
+	this->doneEvent.waitFor();
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+bool Future::cancel( bool mayInterruptIfRunning )
+{
+	bool cancelled = false;
+	bool wasPending = false;
+
+	this->stateLock.lock();
+	if( this->state == FS_PENDING )
+	{
+		wasPending = true;
+		cancelled = true;
+		this->state = FS_CANCELLED;
+	}
+	else if( this->state == FS_RUNNING )
+	{
+		// The worker takes the state lock before leaving FS_RUNNING, so the runner is guaranteed
+		// to still be executing this task while we hold it
+		cancelled = true;
+		this->state = FS_CANCELLED;
+		if( mayInterruptIfRunning && this->runner )
+			this->runner->interrupt();
+	}
+	this->stateLock.unlock();
+
+	if( wasPending )
+	{
+		// Pull the task off the work queue so it never runs, and release any waiters
+		if( this->executor )
+			this->executor->remove( this );
+
+		this->doneEvent.signal();
+	}
+
+	return cancelled;
+}
+
+bool Future::isCancelled() const
+{
+	return this->state == FS_CANCELLED;
+}
+
+bool Future::isDone() const
+{
+	FutureState currentState = this->state;
+	return currentState != FS_PENDING && currentState != FS_RUNNING;
+}
+
+void Future::get()
+{
+	this->get( NATIVE_INFINITE_WAIT );
+}
+
+bool Future::get( unsigned long timeout )
+{
+	// A cancelled task that is still running has not signaled the done event, but there is
+	// nothing for the caller to wait for
+	if( this->state != FS_CANCELLED )
+	{
+		WaitResult result = this->doneEvent.waitFor( timeout );
+		if( result != WR_SUCCEEDED && this->state != FS_CANCELLED )
+			return false;
+	}
+
+	this->stateLock.lock();
+	FutureState finalState = this->state;
+	String failureMessage = this->failure;
+	this->stateLock.unlock();
+
+	if( finalState == FS_CANCELLED )
+		throw CancellationException( TEXT("Task was cancelled") );
+	else if( finalState == FS_FAILED )
+		throw ExecutionException( failureMessage.c_str() );
+
+	return true;
+}
+
+bool Future::start( Thread* worker )
+{
+	bool started = false;
+
+	this->stateLock.lock();
+	if( this->state == FS_PENDING )
+	{
+		this->state = FS_RUNNING;
+		this->runner = worker;
+		started = true;
+	}
+	this->stateLock.unlock();
+
+	return started;
+}
+
+void Future::execute()
+{
+	FutureState finalState = FS_COMPLETED;
+
+	try
+	{
+		if( this->task )
+			this->task->run();
+	}
+	catch( std::exception& e )
+	{
+		this->failure = Platform::toPlatformString( e.what() );
+		finalState = FS_FAILED;
+	}
+	catch( ... )
+	{
+		this->failure = TEXT("Task threw an unknown exception");
+		finalState = FS_FAILED;
+	}
+
+	this->finish( finalState );
+}
+
+void Future::finish( FutureState finalState )
+{
+	this->stateLock.lock();
+	// A task cancelled while running stays cancelled
+	if( this->state == FS_RUNNING )
+		this->state = finalState;
+	this->runner = NULL;
+	this->stateLock.unlock();
+
+	// Signaling must be the last thing we do, as a waiter may delete the future as soon as it
+	// has been released
+	this->doneEvent.signal();
+}
@@ -25,9 +25,16 @@ using namespace syscommon;
 //----------------------------------------------------------
 Lock::Lock()
 {
+	this->policy = LP_RECURSIVE;
 	Platform::initialiseCriticalSection( mutex );
 }
 
+Lock::Lock( LockPolicy policy )
+{
+	this->policy = policy;
+	Platform::initialiseCriticalSection( mutex, policy );
+}
+
 Lock::~Lock()
 {
 	Platform::destroyCriticalSection( mutex );
@@ -45,3 +52,8 @@ void Lock::unlock()
 {
 	Platform::leaveCriticalSection( mutex );
 }
+
+LockPolicy Lock::getPolicy() const
+{
+	return this->policy;
+}
@@ -29,7 +29,7 @@ using namespace syscommon;
 //----------------------------------------------------------
 //                      CONSTRUCTORS
 //----------------------------------------------------------
-Logger::Logger()
+Logger::Logger() : lock( LP_PLAIN )
 {
 	this->file = NULL;
 	this->level = LL_INFO;
@@ -16,6 +16,8 @@
 
 #include <assert.h>
 #include <cstring>
+#include <limits.h>
+#include "syscommon/net/CompletionEngine.h"
 
 #ifdef DEBUG
 #include "debug.h"
@@ -54,6 +56,8 @@ void MulticastSocket::_MulticastSocket( const InetSocketAddress& bindAddress )
 	// Uninitialised in ~MulticastSocket
 	Platform::initialiseSocketFramework();
 	bound = false;
+	this->blocking = true;
+	this->receiveOffload = false;
 	this->nativeSocket = NATIVE_SOCKET_UNINIT;
 
 	// Create the socket and bind it to the appropriate address
@@ -164,7 +168,7 @@ bool MulticastSocket::isBound() const
 	return this->bound;
 }
 
-void MulticastSocket::receive( DatagramPacket& packet )
+bool MulticastSocket::receive( DatagramPacket& packet )
 {
 	if( !isCreated() )
 		throw SocketException( TEXT("Socket is closed") );
@@ -172,6 +176,11 @@ void MulticastSocket::receive( DatagramPacket& packet )
 	char* data = packet.getData();
 	assert( data );
 
+	// The segment size of a coalesced receive comes back in a control message, which only
+	// the batch receive asks for
+	if( this->receiveOffload )
+		return this->receiveBatch( &packet, 1, NATIVE_INFINITE_WAIT ) == 1;
+
 	// Calculate the pointer within the data buffer that we should receive into
 	size_t offset = packet.getOffset();
 	int readLength = packet.getBufferLength();
@@ -196,6 +205,12 @@ void MulticastSocket::receive( DatagramPacket& packet )
 		// Update the packet with the sender's information
 		packet.setAddress( ntohl(from.sin_addr.s_addr) );
 		packet.setPort( ntohs(from.sin_port) );
+		packet.setSegmentSize( 0 );
+		return true;
+	}
+	else if( !this->blocking && Platform::isLastSocketErrorWouldBlock() )
+	{
+		return false;
 	}
 	else
 	{
@@ -203,7 +218,7 @@ void MulticastSocket::receive( DatagramPacket& packet )
 	}
 }
 
-void MulticastSocket::send( DatagramPacket& packet )
+bool MulticastSocket::send( DatagramPacket& packet )
 {
 	if( !isBound() )
 		throw SocketException( TEXT("Socket is not bound") );
@@ -214,6 +229,13 @@ void MulticastSocket::send( DatagramPacket& packet )
 	char* data = packet.getData();
 	assert( data );
 
+	if( packet.getSegmentSize() > 0 )
+	{
+		DatagramMessage message;
+		toMessage( packet, message );
+		return this->sendMessages( &message, 1, 0 ) == 1;
+	}
+
 	// Calculate the pointer within the data buffer that we should send from
 	size_t offset = packet.getOffset();
 	int sendLength = packet.getLength();
@@ -240,7 +262,205 @@ void MulticastSocket::send( DatagramPacket& packet )
 	//int sendResult = ::send( nativeSocket, sendPos, sendLength, 0 );
 
 	if( sendResult < 0 )
+	{
+		if( !this->blocking && Platform::isLastSocketErrorWouldBlock() )
+			return false;
+
+		throw SocketException( Platform::describeLastSocketError() );
+	}
+
+	return true;
+}
+
+void MulticastSocket::configureBlocking( bool block )
+{
+	if( !isCreated() )
+		throw SocketException( TEXT("Socket is closed") );
+
+	if( Platform::setNonBlockingMode(this->nativeSocket, !block) == NATIVE_SOCKET_ERROR )
 		throw SocketException( Platform::describeLastSocketError() );
+
+	this->blocking = block;
+}
+
+bool MulticastSocket::isBlocking() const
+{
+	return this->blocking;
+}
+
+void MulticastSocket::setReceiveOffload( bool enable )
+{
+	if( !isCreated() )
+		throw SocketException( TEXT("Socket is closed") );
+
+	if( !Platform::setReceiveOffload(this->nativeSocket, enable) )
+		throw SocketException( TEXT("Receive offload is not supported on this platform") );
+
+	this->receiveOffload = enable;
+}
+
+bool MulticastSocket::isReceiveOffload() const
+{
+	return this->receiveOffload;
+}
+
+AsyncOperation* MulticastSocket::sendAsync( CompletionEngine& engine,
+                                            DatagramPacket& packet,
+                                            ICompletionHandler* handler,
+                                            void* attachment )
+{
+	return engine.send( this, packet, handler, attachment );
+}
+
+AsyncOperation* MulticastSocket::receiveAsync( CompletionEngine& engine,
+                                               DatagramPacket& packet,
+                                               ICompletionHandler* handler,
+                                               void* attachment )
+{
+	return engine.receive( this, packet, handler, attachment );
+}
+
+int MulticastSocket::receiveBatch( DatagramPacket* packets, int count, unsigned long timeout )
+{
+	if( !packets || count < 0 )
+		throw IllegalArgumentException( TEXT("Packets cannot be NULL and count cannot be negative") );
+
+	if( !isCreated() )
+		throw SocketException( TEXT("Socket is closed") );
+
+	// The socket does the waiting for an infinite timeout. Otherwise wait here, so that the
+	// receive itself need not.
+	bool wait = this->blocking;
+	if( wait && timeout != NATIVE_INFINITE_WAIT && count > 0 )
+	{
+		SocketPoll readable;
+		readable.socket = this->nativeSocket;
+		readable.interest = SE_READ;
+		readable.ready = 0;
+		if( Platform::pollSockets(&readable, 1, timeout) < 0 )
+			throw SocketException( Platform::describeLastSocketError() );
+		if( !readable.ready )
+			return 0;
+
+		wait = false;
+	}
+
+	DatagramMessage messages[DatagramMessage::MAX_BATCH];
+	int received = 0;
+	while( received < count )
+	{
+		int batchSize = count - received;
+		if( batchSize > DatagramMessage::MAX_BATCH )
+			batchSize = DatagramMessage::MAX_BATCH;
+
+		for( int i = 0; i < batchSize; ++i )
+		{
+			DatagramPacket& packet = packets[received + i];
+			assert( packet.getData() );
+			messages[i].buffer = packet.getData() + packet.getOffset();
+			messages[i].length = packet.getBufferLength();
+		}
+
+		int result = Platform::receiveDatagrams( this->nativeSocket,
+		                                         messages,
+		                                         batchSize,
+		                                         wait && received == 0 );
+		if( result < 0 )
+		{
+			// Report what was received, and leave the failure to the next receive
+			if( received > 0 )
+				break;
+
+			throw SocketException( Platform::describeLastSocketError() );
+		}
+
+		for( int i = 0; i < result; ++i )
+		{
+			DatagramPacket& packet = packets[received + i];
+			packet.setLength( messages[i].length );
+			packet.setAddress( messages[i].address );
+			packet.setPort( messages[i].port );
+			packet.setSegmentSize( messages[i].segmentSize );
+		}
+
+		received += result;
+		if( result < batchSize )
+			break;
+	}
+
+	return received;
+}
+
+int MulticastSocket::sendBatch( DatagramPacket* packets, int count )
+{
+	if( !packets || count < 0 )
+		throw IllegalArgumentException( TEXT("Packets cannot be NULL and count cannot be negative") );
+
+	if( !isBound() )
+		throw SocketException( TEXT("Socket is not bound") );
+
+	DatagramMessage messages[DatagramMessage::MAX_BATCH];
+	int sent = 0;
+	while( sent < count )
+	{
+		int batchSize = count - sent;
+		if( batchSize > DatagramMessage::MAX_BATCH )
+			batchSize = DatagramMessage::MAX_BATCH;
+
+		for( int i = 0; i < batchSize; ++i )
+			toMessage( packets[sent + i], messages[i] );
+
+		int result = this->sendMessages( messages, batchSize, sent );
+		sent += result;
+		if( result < batchSize )
+			break;
+	}
+
+	return sent;
+}
+
+int MulticastSocket::sendBatch( const char* buffer,
+                                int length,
+                                const InetSocketAddress* destinations,
+                                int count )
+{
+	if( !buffer || !destinations || length < 0 || count < 0 )
+	{
+		throw IllegalArgumentException(
+			TEXT("Buffer and destinations cannot be NULL, and length and count cannot be negative") );
+	}
+
+	if( !isBound() )
+		throw SocketException( TEXT("Socket is not bound") );
+
+	DatagramMessage messages[DatagramMessage::MAX_BATCH];
+	int sent = 0;
+	while( sent < count )
+	{
+		int batchSize = count - sent;
+		if( batchSize > DatagramMessage::MAX_BATCH )
+			batchSize = DatagramMessage::MAX_BATCH;
+
+		for( int i = 0; i < batchSize; ++i )
+		{
+			const InetSocketAddress& destination = destinations[sent + i];
+			if( destination.getAddress() == INADDR_NONE )
+				throw SocketException( TEXT("Destination address is empty") );
+
+			messages[i].buffer = const_cast<char*>( buffer );
+			messages[i].length = length;
+			messages[i].address = destination.getAddress();
+			messages[i].port = destination.getPort();
+			messages[i].segmentSize = 0;
+		}
+
+		int result = this->sendMessages( messages, batchSize, sent );
+		sent += result;
+		if( result < batchSize )
+			break;
+	}
+
+	return sent;
 }
 
 bool MulticastSocket::isCreated()
@@ -301,3 +521,42 @@ void MulticastSocket::bind( const InetSocketAddress& bindAddress )
 	if( !bound )
 		throw SocketException( Platform::describeLastSocketError() );
 }
+
+int MulticastSocket::sendMessages( DatagramMessage* messages, int count, int alreadySent )
+{
+	int result = Platform::sendDatagrams( this->nativeSocket, messages, count );
+	if( result < 0 )
+	{
+		// Report what was sent, and leave the failure to the next send
+		if( alreadySent > 0 )
+			return 0;
+
+		throw SocketException( Platform::describeLastSocketError() );
+	}
+
+	return result;
+}
+
+//----------------------------------------------------------
+//                     STATIC METHODS
+//----------------------------------------------------------
+void MulticastSocket::toMessage( const DatagramPacket& packet, DatagramMessage& message )
+{
+	if( packet.getAddress() == INADDR_NONE )
+		throw SocketException( TEXT("Destination address in datagram packet is empty") );
+
+	int segmentSize = packet.getSegmentSize();
+	if( segmentSize > 0 )
+	{
+		int segments = (packet.getLength() + segmentSize - 1) / segmentSize;
+		if( segments > DatagramMessage::MAX_SEGMENTS || segmentSize > USHRT_MAX )
+			throw IllegalArgumentException( TEXT("Packet segment size is out of range") );
+	}
+
+	assert( packet.getData() );
+	message.buffer = packet.getData() + packet.getOffset();
+	message.length = packet.getLength();
+	message.address = packet.getAddress();
+	message.port = packet.getPort();
+	message.segmentSize = segmentSize;
+}
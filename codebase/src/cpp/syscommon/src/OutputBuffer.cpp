@@ -114,6 +114,14 @@ const char* OutputBuffer::getData()
 	return this->data;
 }
 
+BufferSegment OutputBuffer::toSegment()
+{
+	BufferSegment segment;
+	segment.buffer = this->data;
+	segment.length = (int)this->writeMarker;
+	return segment;
+}
+
 size_t OutputBuffer::getBytesRemaining()
 {
 	return this->dataLength - writeMarker;
@@ -20,6 +20,28 @@
 
 using namespace syscommon;
 
+const size_t RingOperation::HEADER_SIZE;
+const int DatagramMessage::MAX_BATCH;
+const int DatagramMessage::MAX_SEGMENTS;
+const int BufferSegment::MAX_BATCH;
+
+SocketOptions::SocketOptions( TuningProfile profile )
+{
+	*this = SocketOptions();
+	if( profile == TP_LOW_LATENCY )
+	{
+		this->noDelay = 1;
+		this->quickAck = 1;
+		this->busyPoll = 50;
+	}
+	else if( profile == TP_BULK_THROUGHPUT )
+	{
+		this->noDelay = 0;
+		this->sendBufferSize = 4 * 1024 * 1024;
+		this->receiveBufferSize = 4 * 1024 * 1024;
+	}
+}
+
 #ifdef _WIN32
 
 #ifdef DEBUG
@@ -58,17 +80,19 @@ bool Platform::initialiseSemaphore( NATIVE_SEMAPHORE& nativeSemaphore,
 	bool result = false;
 	if ( !Platform::isSemaphoreInitialised(nativeSemaphore) )
 	{
+		// Anonymous, so that semaphores in different processes can't collide, and with no
+		// practical upper limit on permits, to match the POSIX implementation
 		nativeSemaphore = ::CreateSemaphore( NULL, 
 											 maximumCount, 
-											 maximumCount, 
-											 name.c_str() );
+											 MAXLONG, 
+											 NULL );
 		result = Platform::isSemaphoreInitialised(nativeSemaphore);
 	}
 
 	return result;
 }
 
-bool Platform::isSemaphoreInitialised( const NATIVE_SEMAPHORE nativeSemaphore )
+bool Platform::isSemaphoreInitialised( const NATIVE_SEMAPHORE& nativeSemaphore )
 {
 	return nativeSemaphore != INVALID_HANDLE_VALUE;
 }
@@ -89,7 +113,36 @@ bool Platform::destroySemaphore( NATIVE_SEMAPHORE& nativeSemaphore )
 	return result;
 }
 
+bool Platform::tryAcquireSemaphore( NATIVE_SEMAPHORE& nativeSemaphore, unsigned int permits )
+{
+	assert( Platform::isSemaphoreInitialised(nativeSemaphore) );
+
+	// Windows semaphores can only be waited on one permit at a time, so take them individually
+	// and hand back any we got if we can't get them all
+	unsigned int acquired = 0;
+	while( acquired < permits && ::WaitForSingleObject(nativeSemaphore, 0) == WAIT_OBJECT_0 )
+		++acquired;
+
+	if( acquired < permits && acquired > 0 )
+		::ReleaseSemaphore( nativeSemaphore, acquired, NULL );
+
+	return acquired == permits;
+}
+
+unsigned int Platform::drainSemaphore( NATIVE_SEMAPHORE& nativeSemaphore, unsigned int maxPermits )
+{
+	assert( Platform::isSemaphoreInitialised(nativeSemaphore) );
+
+	// As above, one permit at a time
+	unsigned int acquired = 0;
+	while( acquired < maxPermits && ::WaitForSingleObject(nativeSemaphore, 0) == WAIT_OBJECT_0 )
+		++acquired;
+
+	return acquired;
+}
+
 WaitResult Platform::waitOnSemaphore( NATIVE_SEMAPHORE& nativeSemaphore, 
+									  unsigned int permits,
 									  NATIVE_INTERRUPT& threadInterrupt, 
 									  DWORD timeout )
 {
@@ -100,19 +153,41 @@ WaitResult Platform::waitOnSemaphore( NATIVE_SEMAPHORE& nativeSemaphore,
 	if ( Platform::isSemaphoreInitialised(nativeSemaphore) &&
 		 Platform::isThreadInterruptInitialised(threadInterrupt) )
 	{
-		result = Platform::waitOnInterruptableHandle( nativeSemaphore, threadInterrupt, timeout );
+		// As with tryAcquireSemaphore(), permits are taken one at a time and handed back if the
+		// wait times out or is interrupted part way through
+		DWORD start = ::GetTickCount();
+		unsigned int acquired = 0;
+		result = WR_SUCCEEDED;
+		while( acquired < permits && result == WR_SUCCEEDED )
+		{
+			DWORD remaining = timeout;
+			if( timeout != INFINITE )
+			{
+				DWORD elapsed = ::GetTickCount() - start;
+				remaining = elapsed < timeout ? timeout - elapsed : 0;
+			}
+
+			result = Platform::waitOnInterruptableHandle( nativeSemaphore, 
+														  threadInterrupt, 
+														  remaining );
+			if( result == WR_SUCCEEDED )
+				++acquired;
+		}
+
+		if( result != WR_SUCCEEDED && acquired > 0 )
+			::ReleaseSemaphore( nativeSemaphore, acquired, NULL );
 	}
 
 	return result;
 }
 
-bool Platform::releaseSemaphore( NATIVE_SEMAPHORE& nativeSemaphore )
+bool Platform::releaseSemaphore( NATIVE_SEMAPHORE& nativeSemaphore, unsigned int permits )
 {
 	assert( Platform::isSemaphoreInitialised(nativeSemaphore) );
 
 	bool result = false;
 	if ( Platform::isSemaphoreInitialised(nativeSemaphore) )
-		result = ::ReleaseSemaphore( nativeSemaphore, 1, NULL ) != FALSE;
+		result = ::ReleaseSemaphore( nativeSemaphore, permits, NULL ) != FALSE;
 	
 	return result;
 }
@@ -122,6 +197,18 @@ void Platform::initialiseCriticalSection( NATIVE_CRITICALSECTION& nativeCritical
 	::InitializeCriticalSection( &nativeCriticalSection );
 }
 
+void Platform::initialiseCriticalSection( NATIVE_CRITICALSECTION& nativeCriticalSection,
+										  LockPolicy policy )
+{
+	// Critical sections are always recursive, and Windows hands them over without any ordering
+	// guarantee, so LP_PLAIN and LP_QUEUED get a standard critical section. LP_ADAPTIVE maps
+	// directly onto a critical section with a spin count.
+	if( policy == LP_ADAPTIVE )
+		::InitializeCriticalSectionAndSpinCount( &nativeCriticalSection, 4000 );
+	else
+		::InitializeCriticalSection( &nativeCriticalSection );
+}
+
 void Platform::destroyCriticalSection( NATIVE_CRITICALSECTION& nativeCriticalSection )
 {
 	::DeleteCriticalSection( &nativeCriticalSection );
@@ -137,13 +224,133 @@ void Platform::leaveCriticalSection( NATIVE_CRITICALSECTION& nativeCriticalSecti
 	::LeaveCriticalSection( &nativeCriticalSection );
 }
 
+void Platform::initialiseReadWriteLock( NATIVE_RWLOCK& nativeLock )
+{
+	::InitializeSRWLock( &nativeLock );
+}
+
+void Platform::destroyReadWriteLock( NATIVE_RWLOCK& nativeLock )
+{
+	// Slim reader/writer locks have no resources to free
+}
+
+bool Platform::acquireReadLock( NATIVE_RWLOCK& nativeLock, unsigned long timeout )
+{
+	if( timeout == INFINITE )
+	{
+		::AcquireSRWLockShared( &nativeLock );
+		return true;
+	}
+
+	// Slim reader/writer locks can't be waited on with a timeout, so poll until the deadline
+	DWORD start = ::GetTickCount();
+	while( !::TryAcquireSRWLockShared(&nativeLock) )
+	{
+		if( ::GetTickCount() - start >= timeout )
+			return false;
+
+		::Sleep( 1 );
+	}
+
+	return true;
+}
+
+void Platform::releaseReadLock( NATIVE_RWLOCK& nativeLock )
+{
+	::ReleaseSRWLockShared( &nativeLock );
+}
+
+bool Platform::acquireWriteLock( NATIVE_RWLOCK& nativeLock, unsigned long timeout )
+{
+	if( timeout == INFINITE )
+	{
+		::AcquireSRWLockExclusive( &nativeLock );
+		return true;
+	}
+
+	DWORD start = ::GetTickCount();
+	while( !::TryAcquireSRWLockExclusive(&nativeLock) )
+	{
+		if( ::GetTickCount() - start >= timeout )
+			return false;
+
+		::Sleep( 1 );
+	}
+
+	return true;
+}
+
+void Platform::releaseWriteLock( NATIVE_RWLOCK& nativeLock )
+{
+	::ReleaseSRWLockExclusive( &nativeLock );
+}
+
 NATIVE_THREAD Platform::createUninitialisedThread()
 {
 	return INVALID_HANDLE_VALUE;
 }
 
+/**
+ * Applies the affinity and priority parts of the given options to a suspended thread. Windows has
+ * no scheduling classes, so each policy is mapped onto the closest thread priority.
+ */
+static bool applyThreadOptions( HANDLE thread, const ThreadOptions& options )
+{
+	DWORD_PTR affinityMask = 0;
+	for( size_t i = 0; i < options.processors.size(); ++i )
+	{
+		if( options.processors[i] >= sizeof(DWORD_PTR) * 8 )
+			return false;
+
+		affinityMask |= (DWORD_PTR)1 << options.processors[i];
+	}
+
+	// Memory is allocated from the node of the processor a thread runs on, so keeping the thread
+	// on the node's processors is all there is to a node preference
+	ULONGLONG nodeMask = 0;
+	if( affinityMask == 0 && options.numaNode >= 0 && options.numaNode <= 0xFF &&
+		::GetNumaNodeProcessorMask((UCHAR)options.numaNode, &nodeMask) )
+	{
+		affinityMask = (DWORD_PTR)nodeMask;
+	}
+
+	if( affinityMask != 0 && ::SetThreadAffinityMask(thread, affinityMask) == 0 )
+		return false;
+
+	int priority = THREAD_PRIORITY_NORMAL;
+	switch( options.schedulingPolicy )
+	{
+		case SP_BATCH:
+			priority = THREAD_PRIORITY_BELOW_NORMAL;
+			break;
+		case SP_IDLE:
+			priority = THREAD_PRIORITY_IDLE;
+			break;
+		case SP_FIFO:
+		case SP_ROUND_ROBIN:
+			priority = THREAD_PRIORITY_TIME_CRITICAL;
+			break;
+		default:
+			// A nice value, so lower is more important
+			if( options.priority < 0 )
+				priority = THREAD_PRIORITY_ABOVE_NORMAL;
+			else if( options.priority > 0 )
+				priority = THREAD_PRIORITY_BELOW_NORMAL;
+			break;
+	}
+
+	return priority == THREAD_PRIORITY_NORMAL || ::SetThreadPriority( thread, priority ) != FALSE;
+}
+
 bool Platform::initialiseThread( NATIVE_THREAD& nativeThread, 
 								 void* thisPointer )
+{
+	return Platform::initialiseThread( nativeThread, thisPointer, ThreadOptions() );
+}
+
+bool Platform::initialiseThread( NATIVE_THREAD& nativeThread,
+								 void* thisPointer,
+								 const ThreadOptions& options )
 {
 	assert( !Platform::isThreadInitialised(nativeThread) );
 	assert( thisPointer );
@@ -151,12 +358,17 @@ bool Platform::initialiseThread( NATIVE_THREAD& nativeThread,
 	bool result = false;
 	if ( !Platform::isThreadInitialised(nativeThread) && thisPointer )
 	{
+		// Only reserve the requested stack, so that the pages are committed as they are used
+		DWORD creationFlags = CREATE_SUSPENDED;
+		if( options.stackSize > 0 )
+			creationFlags |= STACK_SIZE_PARAM_IS_A_RESERVATION;
+
 		DWORD nativeThreadID = 0;
 		nativeThread = ::CreateThread( NULL, 
-									   NULL, 
+									   options.stackSize, 
 									   Platform::threadEntry,
 									   thisPointer, 
-									   CREATE_SUSPENDED, 
+									   creationFlags, 
 									   &nativeThreadID );
 		result = nativeThread != INVALID_HANDLE_VALUE;
 
@@ -166,6 +378,14 @@ bool Platform::initialiseThread( NATIVE_THREAD& nativeThread,
 		{
 			std::map<DWORD,HANDLE>& threadIdToHandleMap = ::getThreadIdToHandleMap();
 			threadIdToHandleMap[nativeThreadID] = nativeThread;
+
+			// The thread has not run yet, so it can be discarded if it cannot be set up
+			if( !applyThreadOptions(nativeThread, options) )
+			{
+				::TerminateThread( nativeThread, 0 );
+				Platform::destroyThread( nativeThread );
+				result = false;
+			}
 		}
 	}
 
@@ -247,6 +467,144 @@ bool Platform::threadHandlesEqual( NATIVE_THREAD handleOne, NATIVE_THREAD handle
 	return handleOne == handleTwo;
 }
 
+void Platform::yieldThread()
+{
+	::SwitchToThread();
+}
+
+void Platform::spinPause()
+{
+	YieldProcessor();
+}
+
+unsigned int Platform::getProcessorCount()
+{
+	SYSTEM_INFO systemInfo;
+	::GetSystemInfo( &systemInfo );
+
+	return systemInfo.dwNumberOfProcessors > 0 ? systemInfo.dwNumberOfProcessors : 1;
+}
+
+unsigned int Platform::getCurrentProcessor()
+{
+	return ::GetCurrentProcessorNumber();
+}
+
+const CpuTopology& Platform::getTopology()
+{
+	// Initialised on first use, which the compiler makes safe to race on
+	static CpuTopology topology = Platform::discoverTopology();
+	return topology;
+}
+
+/**
+ * Adds the processors set in the given mask to the list, in ascending order
+ */
+static void appendMaskProcessors( ULONG_PTR mask, std::vector<unsigned int>& processors )
+{
+	for( unsigned int bit = 0; bit < sizeof(ULONG_PTR) * 8; ++bit )
+	{
+		if( mask & ((ULONG_PTR)1 << bit) )
+			processors.push_back( bit );
+	}
+}
+
+CpuTopology Platform::discoverTopology()
+{
+	// Only the processor group that the process started in is described, which is every
+	// processor on machines with no more than 64
+	CpuTopology topology;
+
+	DWORD length = 0;
+	::GetLogicalProcessorInformation( NULL, &length );
+	std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> entries( length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION) );
+	if( entries.empty() || !::GetLogicalProcessorInformation(&entries[0], &length) )
+		entries.clear();
+
+	// Processors that are not described any further are each a core of their own
+	std::map<unsigned int,ProcessorInfo> processors;
+	for( size_t i = 0; i < entries.size(); ++i )
+	{
+		if( entries[i].Relationship != RelationProcessorCore )
+			continue;
+
+		std::vector<unsigned int> coreProcessors;
+		appendMaskProcessors( entries[i].ProcessorMask, coreProcessors );
+		for( size_t j = 0; j < coreProcessors.size(); ++j )
+		{
+			ProcessorInfo info;
+			info.id = coreProcessors[j];
+			info.core = topology.coreCount;
+			info.package = 0;
+			info.node = 0;
+			processors[info.id] = info;
+		}
+
+		++topology.coreCount;
+	}
+
+	if( processors.empty() )
+	{
+		for( unsigned int id = 0; id < Platform::getProcessorCount(); ++id )
+		{
+			ProcessorInfo info;
+			info.id = id;
+			info.core = id;
+			info.package = 0;
+			info.node = 0;
+			processors[id] = info;
+		}
+
+		topology.coreCount = (unsigned int)processors.size();
+	}
+
+	for( size_t i = 0; i < entries.size(); ++i )
+	{
+		const SYSTEM_LOGICAL_PROCESSOR_INFORMATION& entry = entries[i];
+		std::vector<unsigned int> members;
+		appendMaskProcessors( entry.ProcessorMask, members );
+
+		if( entry.Relationship == RelationProcessorPackage )
+		{
+			for( size_t j = 0; j < members.size(); ++j )
+				processors[members[j]].package = topology.packageCount;
+
+			++topology.packageCount;
+		}
+		else if( entry.Relationship == RelationNumaNode )
+		{
+			for( size_t j = 0; j < members.size(); ++j )
+				processors[members[j]].node = (int)entry.NumaNode.NodeNumber;
+		}
+		else if( entry.Relationship == RelationCache && entry.Cache.Type != CacheTrace )
+		{
+			CacheInfo cache;
+			cache.level = entry.Cache.Level;
+			cache.type = entry.Cache.Type == CacheData ? CT_DATA :
+			             entry.Cache.Type == CacheInstruction ? CT_INSTRUCTION : CT_UNIFIED;
+			cache.size = entry.Cache.Size;
+			cache.lineSize = entry.Cache.LineSize;
+			cache.associativity = entry.Cache.Associativity;
+			cache.processors = members;
+			topology.caches.push_back( cache );
+		}
+	}
+
+	if( topology.packageCount == 0 )
+		topology.packageCount = 1;
+
+	std::set<int> nodes;
+	std::map<unsigned int,ProcessorInfo>::iterator it;
+	for( it = processors.begin(); it != processors.end(); ++it )
+	{
+		topology.processors.push_back( it->second );
+		nodes.insert( it->second.node );
+	}
+
+	topology.nodes.assign( nodes.begin(), nodes.end() );
+	return topology;
+}
+
 NATIVE_INTERRUPT Platform::createUninitialisedInterrupt()
 {
 	return INVALID_HANDLE_VALUE;
@@ -312,6 +670,18 @@ bool Platform::signalInterrupt( NATIVE_INTERRUPT& nativeInterrupt )
 	return result;
 }
 
+bool Platform::clearInterrupt( NATIVE_INTERRUPT& nativeInterrupt )
+{
+	assert( Platform::isThreadInterruptInitialised(nativeInterrupt) );
+
+	// The interrupt is an auto-reset event, so a zero length wait consumes any pending signal
+	bool wasSignaled = false;
+	if ( Platform::isThreadInterruptInitialised(nativeInterrupt) )
+		wasSignaled = ::WaitForSingleObject( nativeInterrupt, 0 ) == WAIT_OBJECT_0;
+
+	return wasSignaled;
+}
+
 NATIVE_EVENT Platform::createUninitialisedEvent()
 {
 	return INVALID_HANDLE_VALUE;
@@ -498,11 +868,15 @@ const int Platform::closeSocket( NATIVE_SOCKET socket )
 }
 
 const tchar* Platform::describeLastSocketError()
+{
+	return Platform::describeSocketError( ::WSAGetLastError() );
+}
+
+const tchar* Platform::describeSocketError( int errorCode )
 {
 	const tchar* error = TEXT("Unknown Error");
-	int lastError = ::WSAGetLastError();
 
-	switch( lastError )
+	switch( errorCode )
 	{
 		case WSAEACCES:
 			error = TEXT("Permission denied");
@@ -715,119 +1089,606 @@ bool Platform::isLastSocketErrorSocketConnecting()
 	return lastError == WSAEWOULDBLOCK;
 }
 
-std::set<NATIVE_IP_ADDRESS> Platform::getAvailableNetworkInterfaceAddresses()
+bool Platform::isLastSocketErrorWouldBlock()
 {
-	std::set<NATIVE_IP_ADDRESS> addresses;
-	addresses.insert( INADDR_LOOPBACK );
+	return ::WSAGetLastError() == WSAEWOULDBLOCK;
+}
 
-	// Allocate heap memory to hold the adapter information
-	ULONG structSize = sizeof(IP_ADAPTER_INFO);
-	PIP_ADAPTER_INFO adapterInfo = (IP_ADAPTER_INFO*)::HeapAlloc( ::GetProcessHeap(), 
-																	0, 
-																	structSize );
+bool Platform::setReusePort( NATIVE_SOCKET socket, bool enable )
+{
+	// SO_REUSEADDR on Windows lets sockets steal each other's port rather than sharing out the
+	// connections, so there is nothing equivalent
+	return !enable;
+}
 
-	// Check to see whether there's enough space in the initial allocated buffer
-	if( ::GetAdaptersInfo( adapterInfo, &structSize ) == ERROR_BUFFER_OVERFLOW )
+bool Platform::applySocketOptions( NATIVE_SOCKET socket, const SocketOptions& options )
+{
+	// WinSock 1.1 has no quick acknowledgement, busy polling or user timeout, and sets the
+	// keepalive timings only through WSAIoctl()
+	BOOL flag;
+	if( options.noDelay >= 0 )
 	{
-		// Reallocate with the new size given by the initial call to GetAdaptersInfo
-		::HeapFree( ::GetProcessHeap(), 0, adapterInfo );
-		adapterInfo = (IP_ADAPTER_INFO*)::HeapAlloc( ::GetProcessHeap(), 0, structSize );
+		flag = options.noDelay ? TRUE : FALSE;
+		if( ::setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, (char*)&flag, sizeof(flag)) != 0 )
+			return false;
 	}
 
-	// Retrieve the list of adapters from the OS 
-	if( ::GetAdaptersInfo(adapterInfo, &structSize) == NO_ERROR )
+	if( options.sendBufferSize > 0 &&
+	    ::setsockopt(socket,
+	                 SOL_SOCKET,
+	                 SO_SNDBUF,
+	                 (char*)&options.sendBufferSize,
+	                 sizeof(options.sendBufferSize)) != 0 )
+		return false;
+
+	if( options.receiveBufferSize > 0 &&
+	    ::setsockopt(socket,
+	                 SOL_SOCKET,
+	                 SO_RCVBUF,
+	                 (char*)&options.receiveBufferSize,
+	                 sizeof(options.receiveBufferSize)) != 0 )
+		return false;
+
+	if( options.keepAlive >= 0 )
 	{
-		// Iterate through all network adapters
-		PIP_ADAPTER_INFO currentIface = adapterInfo;
-		while( currentIface )
-		{
-			// If the current adapter is an ethernet adapter, add it to the set of interfaces
-			if( currentIface->Type == MIB_IF_TYPE_ETHERNET || 
-				currentIface->Type == IF_TYPE_IEEE80211 )
-			{
-				syscommon::String platformHostName = 
-					Platform::toPlatformString( currentIface->IpAddressList.IpAddress.String );
-				NATIVE_IP_ADDRESS address = Platform::lookupHost( platformHostName.c_str() );
-				if( address != INADDR_NONE )
-					addresses.insert( address );
-			}
-
-			// Move to the next adapter
-			currentIface = currentIface->Next;
-		}
+		flag = options.keepAlive ? TRUE : FALSE;
+		if( ::setsockopt(socket, SOL_SOCKET, SO_KEEPALIVE, (char*)&flag, sizeof(flag)) != 0 )
+			return false;
 	}
 
-	// Free any allocated heap memory
-	if( adapterInfo )
-		::HeapFree( ::GetProcessHeap(), 0, adapterInfo );
+	if( options.linger >= 0 )
+	{
+		linger lingerOption;
+		lingerOption.l_onoff = 1;
+		lingerOption.l_linger = (u_short)options.linger;
+		if( ::setsockopt(socket, SOL_SOCKET, SO_LINGER, (char*)&lingerOption, sizeof(lingerOption)) != 0 )
+			return false;
+	}
 
-	return addresses;
+	return true;
 }
 
-int Platform::toAnsiChars( const wchar_t* string, 
-						   int stringLength, 
-						   char* outBuffer, 
-						   int outBufferSize )
+void Platform::rearmQuickAck( NATIVE_SOCKET socket )
 {
-	int result = ::WideCharToMultiByte( CP_ACP, 
-										NULL, 
-										string, 
-										stringLength, 
-										outBuffer, 
-										outBufferSize, 
-										NULL, 
-										NULL );
-	return result;
+
 }
 
-std::string Platform::toAnsiString( const char* string )
+bool Platform::setReusePortSteering( NATIVE_SOCKET socket,
+                                     const std::vector<unsigned int>& processors )
 {
-	return std::string( string );
+	return false;
 }
 
-std::string Platform::toAnsiString( const char* string, int length )
+bool Platform::setIncomingProcessor( NATIVE_SOCKET socket, int processor )
 {
-	return std::string( string, length );
+	return false;
 }
 
-std::string Platform::toAnsiString( const wchar_t* string )
+int Platform::getIncomingProcessor( NATIVE_SOCKET socket )
 {
-	return toAnsiString( string, (int)::wcslen(string) );
+	return -1;
 }
 
-std::string Platform::toAnsiString( const wchar_t* string, int length )
+int Platform::pollSockets( SocketPoll* sockets, size_t count, unsigned long timeout )
 {
-	std::string result;
-
-	int ansiLength = Platform::toAnsiChars( string, length, NULL, 0 );
-	if ( ansiLength > 0 )
+	// Built on select(), which WinSock limits to FD_SETSIZE sockets of each kind
+	fd_set readSet;
+	fd_set writeSet;
+	fd_set errorSet;
+	FD_ZERO( &readSet );
+	FD_ZERO( &writeSet );
+	FD_ZERO( &errorSet );
+	for( size_t i = 0; i < count; ++i )
 	{
-		char* ansiChars = new char[ ansiLength ];
-		Platform::toAnsiChars( string, length, ansiChars, ansiLength );
-		result = std::string( ansiChars, ansiLength );
+		if( sockets[i].interest & SE_READ )
+			FD_SET( sockets[i].socket, &readSet );
+		if( sockets[i].interest & SE_WRITE )
+			FD_SET( sockets[i].socket, &writeSet );
 
-		delete[] ansiChars;
-	}	
+		FD_SET( sockets[i].socket, &errorSet );
+	}
 
-	return result;
-}
+	timeval waitTime;
+	waitTime.tv_sec = (long)(timeout / 1000);
+	waitTime.tv_usec = (long)(timeout % 1000) * 1000;
+
+	int result = ::select( 0,
+						   &readSet,
+						   &writeSet,
+						   &errorSet,
+						   timeout == NATIVE_INFINITE_WAIT ? NULL : &waitTime );
+
+	for( size_t i = 0; i < count; ++i )
+	{
+		int ready = 0;
+		if( result > 0 && FD_ISSET(sockets[i].socket, &readSet) )
+			ready |= SE_READ;
+		if( result > 0 && FD_ISSET(sockets[i].socket, &writeSet) )
+			ready |= SE_WRITE;
+		if( result > 0 && FD_ISSET(sockets[i].socket, &errorSet) )
+			ready |= SE_ERROR;
+
+		sockets[i].ready = ready;
+	}
 
-int Platform::toUnicodeChars( const char* string, 
-							  int stringLength, 
-							  wchar_t* outBuffer, 
-							  int outBufferSize )
-{
-	int result = ::MultiByteToWideChar( CP_ACP, 0, string, stringLength, outBuffer, outBufferSize );
 	return result;
 }
 
-std::wstring Platform::toUnicodeString( const char* string )
+int Platform::receiveDatagrams( NATIVE_SOCKET socket,
+                                DatagramMessage* messages,
+                                int count,
+                                bool wait )
 {
-	return Platform::toUnicodeString( string, (int)strlen(string) );
-}
+	// One datagram per call, taking the ones after the first only if they have already arrived
+	int received = 0;
+	while( received < count )
+	{
+		if( received > 0 || !wait )
+		{
+			SocketPoll readable;
+			readable.socket = socket;
+			readable.interest = SE_READ;
+			readable.ready = 0;
+			if( Platform::pollSockets(&readable, 1, 0) <= 0 || !(readable.ready & SE_READ) )
+				break;
+		}
 
-std::wstring Platform::toUnicodeString( const char* string, int length )
-{
+		DatagramMessage& message = messages[received];
+		sockaddr_in from;
+		NATIVE_SOCKET_LEN fromSize = sizeof( from );
+		int result = ::recvfrom( socket,
+		                         message.buffer,
+		                         message.length,
+		                         0,
+		                         (sockaddr*)&from,
+		                         &fromSize );
+		if( result < 0 )
+		{
+			if( received == 0 && !Platform::isLastSocketErrorWouldBlock() )
+				return -1;
+
+			break;
+		}
+
+		message.length = result;
+		message.address = ntohl( from.sin_addr.s_addr );
+		message.port = ntohs( from.sin_port );
+		message.segmentSize = 0;
+		++received;
+	}
+
+	return received;
+}
+
+int Platform::sendDatagrams( NATIVE_SOCKET socket, DatagramMessage* messages, int count )
+{
+	int sent = 0;
+	while( sent < count )
+	{
+		const DatagramMessage& message = messages[sent];
+		sockaddr_in to;
+		::memset( &to, 0, sizeof(to) );
+		to.sin_family = AF_INET;
+		to.sin_addr.s_addr = htonl( message.address );
+		to.sin_port = htons( message.port );
+
+		// Without offload each segment goes out on its own, and the message only counts as sent
+		// once all of them have
+		int segmentSize = message.segmentSize > 0 ? message.segmentSize : message.length;
+		int offset = 0;
+		bool failed = false;
+		do
+		{
+			int segmentLength = message.length - offset;
+			if( segmentLength > segmentSize )
+				segmentLength = segmentSize;
+
+			if( ::sendto(socket,
+			             message.buffer + offset,
+			             segmentLength,
+			             0,
+			             (sockaddr*)&to,
+			             (int)sizeof(to)) < 0 )
+			{
+				failed = true;
+				break;
+			}
+
+			offset += segmentLength;
+		}
+		while( offset < message.length );
+
+		if( failed )
+		{
+			if( sent == 0 && !Platform::isLastSocketErrorWouldBlock() )
+				return -1;
+
+			break;
+		}
+
+		++sent;
+	}
+
+	return sent;
+}
+
+bool Platform::setReceiveOffload( NATIVE_SOCKET socket, bool enable )
+{
+	return !enable;
+}
+
+int Platform::sendSegments( NATIVE_SOCKET socket, const BufferSegment* segments, int count )
+{
+	// WinSock 1.1 has no gathering send, so each segment goes on its own, stopping at the first
+	// that is only partly taken
+	if( count > BufferSegment::MAX_BATCH )
+		count = BufferSegment::MAX_BATCH;
+
+	int sent = 0;
+	for( int i = 0; i < count; ++i )
+	{
+		int result = ::send( socket, segments[i].buffer, segments[i].length, 0 );
+		if( result == SOCKET_ERROR )
+			return sent > 0 ? sent : NATIVE_SOCKET_ERROR;
+
+		sent += result;
+		if( result < segments[i].length )
+			break;
+	}
+
+	return sent;
+}
+
+int Platform::receiveSegments( NATIVE_SOCKET socket, BufferSegment* segments, int count )
+{
+	// Nor a scattering receive, so this fills the first segment with room and leaves the rest
+	// to the next call
+	if( count > BufferSegment::MAX_BATCH )
+		count = BufferSegment::MAX_BATCH;
+
+	for( int i = 0; i < count; ++i )
+	{
+		if( segments[i].length > 0 )
+			return ::recv( socket, segments[i].buffer, segments[i].length, 0 );
+	}
+
+	return 0;
+}
+
+bool Platform::setZeroCopy( NATIVE_SOCKET socket, bool enable )
+{
+	return !enable;
+}
+
+int Platform::sendZeroCopy( NATIVE_SOCKET socket, const char* buffer, int length, bool& copied )
+{
+	copied = true;
+	return ::send( socket, buffer, length, 0 );
+}
+
+int Platform::readZeroCopyCompletions( NATIVE_SOCKET socket, ZeroCopyRange* ranges, int count )
+{
+	return 0;
+}
+
+long long Platform::sendFile( NATIVE_SOCKET socket,
+                              NATIVE_FILE file,
+                              long long offset,
+                              long long length )
+{
+	// TransmitFile() needs WinSock 2, so the file is read through a buffer. A pipe ignores the
+	// offset and cannot be read again, so all that is read goes out before returning.
+	char buffer[65536];
+	DWORD toRead = length < (long long)sizeof(buffer) ? (DWORD)length : (DWORD)sizeof(buffer);
+	OVERLAPPED position;
+	::memset( &position, 0, sizeof(position) );
+	position.Offset = (DWORD)offset;
+	position.OffsetHigh = (DWORD)(offset >> 32);
+
+	DWORD bytesRead = 0;
+	if( !::ReadFile(file, buffer, toRead, &bytesRead, &position) )
+	{
+		DWORD error = ::GetLastError();
+		return error == ERROR_HANDLE_EOF || error == ERROR_BROKEN_PIPE ? 0 : -1;
+	}
+
+	int sent = 0;
+	while( sent < (int)bytesRead )
+	{
+		int result = ::send( socket, buffer + sent, (int)bytesRead - sent, 0 );
+		if( result == SOCKET_ERROR )
+		{
+			if( !Platform::isLastSocketErrorWouldBlock() )
+				return sent > 0 ? sent : -1;
+
+			SocketPoll writable;
+			writable.socket = socket;
+			writable.interest = SE_WRITE;
+			writable.ready = 0;
+			Platform::pollSockets( &writable, 1, NATIVE_INFINITE_WAIT );
+			continue;
+		}
+
+		sent += result;
+	}
+
+	return sent;
+}
+
+bool Platform::createRelay( NATIVE_FILE& readEnd, NATIVE_FILE& writeEnd )
+{
+	return false;
+}
+
+long long Platform::relaySocket( NATIVE_SOCKET from,
+                                 NATIVE_SOCKET to,
+                                 NATIVE_FILE readEnd,
+                                 NATIVE_FILE writeEnd,
+                                 long long length )
+{
+	return -1;
+}
+
+NATIVE_SOCKET Platform::createWakeupSocket()
+{
+	// A loopback datagram socket connected to itself, so that anything sent on it can be read
+	// back from it
+	NATIVE_SOCKET wakeup = ::socket( AF_INET, SOCK_DGRAM, 0 );
+	if( wakeup == NATIVE_SOCKET_UNINIT )
+		return wakeup;
+
+	sockaddr_in address;
+	::memset( &address, 0, sizeof(address) );
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+	NATIVE_SOCKET_LEN length = sizeof( address );
+
+	if( ::bind(wakeup, (sockaddr*)&address, length) != 0 ||
+		::getsockname(wakeup, (sockaddr*)&address, &length) != 0 ||
+		::connect(wakeup, (sockaddr*)&address, length) != 0 ||
+		Platform::setNonBlockingMode(wakeup, true) != 0 )
+	{
+		Platform::closeSocket( wakeup );
+		return NATIVE_SOCKET_UNINIT;
+	}
+
+	return wakeup;
+}
+
+void Platform::signalWakeupSocket( NATIVE_SOCKET wakeup )
+{
+	char signal = 0;
+	::send( wakeup, &signal, 1, 0 );
+}
+
+void Platform::clearWakeupSocket( NATIVE_SOCKET wakeup )
+{
+	char buffer[64];
+	while( ::recv(wakeup, buffer, sizeof(buffer), 0) > 0 )
+		;
+}
+
+NATIVE_POLLER Platform::createPoller()
+{
+	// I/O completion ports report completed operations rather than readiness, so they do not
+	// fit here. Selectors poll their sockets instead.
+	return NATIVE_POLLER_UNINIT;
+}
+
+void Platform::closePoller( NATIVE_POLLER poller )
+{
+
+}
+
+bool Platform::addToPoller( NATIVE_POLLER poller,
+                            NATIVE_SOCKET socket,
+                            int interest,
+                            bool edgeTriggered,
+                            void* context )
+{
+	return false;
+}
+
+bool Platform::modifyInPoller( NATIVE_POLLER poller,
+                               NATIVE_SOCKET socket,
+                               int interest,
+                               bool edgeTriggered,
+                               void* context )
+{
+	return false;
+}
+
+bool Platform::removeFromPoller( NATIVE_POLLER poller, NATIVE_SOCKET socket )
+{
+	return false;
+}
+
+int Platform::waitOnPoller( NATIVE_POLLER poller,
+                            PollerEvent* events,
+                            size_t maxEvents,
+                            unsigned long timeout )
+{
+	return -1;
+}
+
+NATIVE_RING Platform::createUninitialisedRing()
+{
+	NATIVE_RING ring;
+	ring.initialised = false;
+	return ring;
+}
+
+bool Platform::initialiseRing( NATIVE_RING& ring, unsigned int entries )
+{
+	// Registered I/O and completion ports work quite differently, so CompletionEngines make
+	// blocking calls instead
+	return false;
+}
+
+bool Platform::isRingInitialised( const NATIVE_RING& ring )
+{
+	return ring.initialised;
+}
+
+void Platform::destroyRing( NATIVE_RING& ring )
+{
+
+}
+
+bool Platform::registerRingBuffers( NATIVE_RING& ring,
+                                    char* base,
+                                    size_t bufferSize,
+                                    unsigned int count )
+{
+	return false;
+}
+
+bool Platform::queueRingOperation( NATIVE_RING& ring, const RingOperation& operation )
+{
+	return false;
+}
+
+int Platform::submitRing( NATIVE_RING& ring, bool wait, unsigned long timeout )
+{
+	return -1;
+}
+
+size_t Platform::reapRing( NATIVE_RING& ring, RingCompletion* completions, size_t maxCompletions )
+{
+	return 0;
+}
+
+void Platform::getRingSender( const void* header, NATIVE_IP_ADDRESS& address, unsigned short& port )
+{
+	address = 0;
+	port = 0;
+}
+
+bool Platform::getPeerAddress( NATIVE_SOCKET socket, NATIVE_IP_ADDRESS& address, unsigned short& port )
+{
+	sockaddr_in peer;
+	NATIVE_SOCKET_LEN length = sizeof(peer);
+	if( ::getpeername(socket, (sockaddr*)&peer, &length) != 0 || peer.sin_family != AF_INET )
+		return false;
+
+	address = ntohl( peer.sin_addr.s_addr );
+	port = ntohs( peer.sin_port );
+	return true;
+}
+
+std::set<NATIVE_IP_ADDRESS> Platform::getAvailableNetworkInterfaceAddresses()
+{
+	std::set<NATIVE_IP_ADDRESS> addresses;
+	addresses.insert( INADDR_LOOPBACK );
+
+	// Allocate heap memory to hold the adapter information
+	ULONG structSize = sizeof(IP_ADAPTER_INFO);
+	PIP_ADAPTER_INFO adapterInfo = (IP_ADAPTER_INFO*)::HeapAlloc( ::GetProcessHeap(), 
+																	0, 
+																	structSize );
+
+	// Check to see whether there's enough space in the initial allocated buffer
+	if( ::GetAdaptersInfo( adapterInfo, &structSize ) == ERROR_BUFFER_OVERFLOW )
+	{
+		// Reallocate with the new size given by the initial call to GetAdaptersInfo
+		::HeapFree( ::GetProcessHeap(), 0, adapterInfo );
+		adapterInfo = (IP_ADAPTER_INFO*)::HeapAlloc( ::GetProcessHeap(), 0, structSize );
+	}
+
+	// Retrieve the list of adapters from the OS 
+	if( ::GetAdaptersInfo(adapterInfo, &structSize) == NO_ERROR )
+	{
+		// Iterate through all network adapters
+		PIP_ADAPTER_INFO currentIface = adapterInfo;
+		while( currentIface )
+		{
+			// If the current adapter is an ethernet adapter, add it to the set of interfaces
+			if( currentIface->Type == MIB_IF_TYPE_ETHERNET || 
+				currentIface->Type == IF_TYPE_IEEE80211 )
+			{
+				syscommon::String platformHostName = 
+					Platform::toPlatformString( currentIface->IpAddressList.IpAddress.String );
+				NATIVE_IP_ADDRESS address = Platform::lookupHost( platformHostName.c_str() );
+				if( address != INADDR_NONE )
+					addresses.insert( address );
+			}
+
+			// Move to the next adapter
+			currentIface = currentIface->Next;
+		}
+	}
+
+	// Free any allocated heap memory
+	if( adapterInfo )
+		::HeapFree( ::GetProcessHeap(), 0, adapterInfo );
+
+	return addresses;
+}
+
+int Platform::toAnsiChars( const wchar_t* string, 
+						   int stringLength, 
+						   char* outBuffer, 
+						   int outBufferSize )
+{
+	int result = ::WideCharToMultiByte( CP_ACP, 
+										NULL, 
+										string, 
+										stringLength, 
+										outBuffer, 
+										outBufferSize, 
+										NULL, 
+										NULL );
+	return result;
+}
+
+std::string Platform::toAnsiString( const char* string )
+{
+	return std::string( string );
+}
+
+std::string Platform::toAnsiString( const char* string, int length )
+{
+	return std::string( string, length );
+}
+
+std::string Platform::toAnsiString( const wchar_t* string )
+{
+	return toAnsiString( string, (int)::wcslen(string) );
+}
+
+std::string Platform::toAnsiString( const wchar_t* string, int length )
+{
+	std::string result;
+
+	int ansiLength = Platform::toAnsiChars( string, length, NULL, 0 );
+	if ( ansiLength > 0 )
+	{
+		char* ansiChars = new char[ ansiLength ];
+		Platform::toAnsiChars( string, length, ansiChars, ansiLength );
+		result = std::string( ansiChars, ansiLength );
+
+		delete[] ansiChars;
+	}	
+
+	return result;
+}
+
+int Platform::toUnicodeChars( const char* string, 
+							  int stringLength, 
+							  wchar_t* outBuffer, 
+							  int outBufferSize )
+{
+	int result = ::MultiByteToWideChar( CP_ACP, 0, string, stringLength, outBuffer, outBufferSize );
+	return result;
+}
+
+std::wstring Platform::toUnicodeString( const char* string )
+{
+	return Platform::toUnicodeString( string, (int)strlen(string) );
+}
+
+std::wstring Platform::toUnicodeString( const char* string, int length )
+{
 	std::wstring result;
 	
 	int unicodeLength = Platform::toUnicodeChars( string, length, NULL, 0 );
@@ -913,7 +1774,32 @@ bool Platform::fileExists( const tchar* fileName )
 	return fileAttributes != INVALID_FILE_ATTRIBUTES;
 }
 
-String Platform::getCurrentDirectoryString()
+NATIVE_FILE Platform::openFile( const tchar* fileName )
+{
+	return ::CreateFile( fileName,
+	                     GENERIC_READ,
+	                     FILE_SHARE_READ,
+	                     NULL,
+	                     OPEN_EXISTING,
+	                     FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+	                     NULL );
+}
+
+void Platform::closeFile( NATIVE_FILE file )
+{
+	::CloseHandle( file );
+}
+
+long long Platform::getFileSize( NATIVE_FILE file )
+{
+	LARGE_INTEGER size;
+	if( ::GetFileType(file) != FILE_TYPE_DISK || !::GetFileSizeEx(file, &size) )
+		return -1;
+
+	return size.QuadPart;
+}
+
+String Platform::getCurrentDirectoryString()
 {
 	tchar path[MAX_PATH + 1];
 	::GetCurrentDirectory( MAX_PATH + 1, path );
@@ -941,6 +1827,26 @@ unsigned long Platform::getCurrentTimeMilliseconds()
 	return time;
 }
 
+long long Platform::nanoTime()
+{
+	// QueryPerformanceCounter is monotonic, and already reads the TSC where that is reliable
+	static LONGLONG frequency = 0;
+	if( frequency == 0 )
+	{
+		LARGE_INTEGER queried;
+		::QueryPerformanceFrequency( &queried );
+		frequency = queried.QuadPart;
+	}
+
+	LARGE_INTEGER now;
+	::QueryPerformanceCounter( &now );
+
+	// Split the conversion so that the multiplication cannot overflow
+	LONGLONG seconds = now.QuadPart / frequency;
+	LONGLONG remainder = now.QuadPart % frequency;
+	return seconds * 1000000000LL + (remainder * 1000000000LL) / frequency;
+}
+
 tm* Platform::toLocalTime( const time_t& time )
 {
 #pragma warning( push )
@@ -1027,707 +1933,3079 @@ WaitResult Platform::waitOnInterruptableHandle( HANDLE interruptableHandle,
 		waitHandles[0] = interruptHandle;
 		waitHandles[1] = interruptableHandle;
 
-		DWORD nativeWaitResult = ::WaitForMultipleObjects( 2, waitHandles, FALSE, timeout );
-		result = translateWaitResult( nativeWaitResult, true );
+		DWORD nativeWaitResult = ::WaitForMultipleObjects( 2, waitHandles, FALSE, timeout );
+		result = translateWaitResult( nativeWaitResult, true );
+
+		if( result == WR_INTERRUPTED )
+			::ResetEvent( interruptHandle );
+	}
+
+	return result;
+}
+
+#else
+
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <cstdio>
+#include <cstring>
+#include <sched.h>
+#include <stdint.h>
+#include <algorithm>
+#include <map>
+
+#include <poll.h>
+#include <sys/uio.h>
+#include <netinet/tcp.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <linux/io_uring.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/sendfile.h>
+#include <netinet/udp.h>
+#include <linux/errqueue.h>
+#include <linux/filter.h>
+
+// Older C libraries do not know about UDP segmentation offload, which the kernel has had since
+// 4.18 (sending) and 5.0 (receiving)
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+// Likewise programs that steer SO_REUSEPORT connections, which arrived in 4.5
+#ifndef SO_ATTACH_REUSEPORT_CBPF
+#define SO_ATTACH_REUSEPORT_CBPF 51
+#endif
+
+// Likewise zero-copy sends, which arrived in 4.14
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+#define SO_EE_ORIGIN_ZEROCOPY 5
+#endif
+#ifndef SO_EE_CODE_ZEROCOPY_COPIED
+#define SO_EE_CODE_ZEROCOPY_COPIED 1
+#endif
+#endif
+
+#if defined(SYSCOMMON_USE_TSC) && defined(__x86_64__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+const tchar* Platform::DIRECTORY_SEPARATOR = TEXT("/");
+const tchar* Platform::PATH_SEPARATOR = TEXT(":");
+
+//----------------------------------------------------------
+//                     WORD WAITING
+//----------------------------------------------------------
+// Blocking primitives are built on a single int word that threads can sleep on until its value
+// changes. On Linux this maps directly onto the futex system call. Elsewhere, sleeping threads are
+// parked in a small table of mutex/condition pairs, hashed by the address of the word.
+//
+// Callers must change the word before waking it. A waiter only sleeps if the word still holds the
+// value it expects, so a change made before the waiter goes to sleep is never missed.
+
+/**
+ * Fills in an absolute CLOCK_MONOTONIC deadline that is the given number of milliseconds from now
+ */
+static void computeDeadline( unsigned long timeout, timespec& deadline )
+{
+	::clock_gettime( CLOCK_MONOTONIC, &deadline );
+	deadline.tv_sec += timeout / 1000;
+	deadline.tv_nsec += (long)(timeout % 1000) * 1000000L;
+	if( deadline.tv_nsec >= 1000000000L )
+	{
+		deadline.tv_sec += 1;
+		deadline.tv_nsec -= 1000000000L;
+	}
+}
+
+#ifdef __linux__
+/**
+ * Sleeps while the word holds the expected value, until woken or until the deadline passes. A NULL
+ * deadline waits indefinitely. Returns false if the deadline passed, true otherwise (which
+ * includes spurious wakeups, so callers must re-check the word).
+ */
+static bool waitOnWord( int* word, int expected, const timespec* deadline, unsigned int mask );
+
+static bool waitOnWord( int* word, int expected, const timespec* deadline )
+{
+	return waitOnWord( word, expected, deadline, FUTEX_BITSET_MATCH_ANY );
+}
+
+/**
+ * As waitOnWord() above, but the sleeper can only be woken by a wakeWord() call whose mask shares
+ * a bit with the given mask. This lets a waker pick out particular sleepers.
+ */
+static bool waitOnWord( int* word, int expected, const timespec* deadline, unsigned int mask )
+{
+	// FUTEX_WAIT_BITSET takes an absolute CLOCK_MONOTONIC timeout, unlike plain FUTEX_WAIT
+	long result = ::syscall( SYS_futex,
+							 word,
+							 FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG,
+							 expected,
+							 deadline,
+							 NULL,
+							 mask );
+
+	return !(result == -1 && errno == ETIMEDOUT);
+}
+
+/**
+ * Wakes up to count threads sleeping on the word
+ */
+static void wakeWord( int* word, int count )
+{
+	::syscall( SYS_futex, word, FUTEX_WAKE | FUTEX_PRIVATE_FLAG, count, NULL, NULL, 0 );
+}
+
+/**
+ * Wakes up to count threads sleeping on the word with a mask that shares a bit with this one
+ */
+static void wakeWord( int* word, int count, unsigned int mask )
+{
+	::syscall( SYS_futex, word, FUTEX_WAKE_BITSET | FUTEX_PRIVATE_FLAG, count, NULL, NULL, mask );
+}
+#else
+struct ParkingBucket
+{
+	pthread_mutex_t mutex;
+	pthread_cond_t condition;
+};
+
+static const int PARKING_BUCKET_COUNT = 64;
+
+static ParkingBucket* createParkingLot()
+{
+	// Time the condition variables out against the monotonic clock, so that deadlines are not
+	// affected by changes to the wall clock. macOS has no pthread_condattr_setclock(), and uses a
+	// relative wait in waitOnWord() instead.
+	pthread_condattr_t attributes;
+	::pthread_condattr_init( &attributes );
+#ifndef __APPLE__
+	::pthread_condattr_setclock( &attributes, CLOCK_MONOTONIC );
+#endif
+
+	ParkingBucket* buckets = new ParkingBucket[PARKING_BUCKET_COUNT];
+	for( int i = 0 ; i < PARKING_BUCKET_COUNT ; ++i )
+	{
+		::pthread_mutex_init( &buckets[i].mutex, NULL );
+		::pthread_cond_init( &buckets[i].condition, &attributes );
+	}
+
+	::pthread_condattr_destroy( &attributes );
+	return buckets;
+}
+
+static ParkingBucket& getParkingBucket( const int* word )
+{
+	// Never freed, as threads may still be parked while static destructors run
+	static ParkingBucket* parkingLot = createParkingLot();
+	return parkingLot[((uintptr_t)word / sizeof(int)) % PARKING_BUCKET_COUNT];
+}
+
+static bool waitOnWord( int* word, int expected, const timespec* deadline )
+{
+	ParkingBucket& bucket = getParkingBucket( word );
+	bool woken = true;
+
+	::pthread_mutex_lock( &bucket.mutex );
+	if( __atomic_load_n(word, __ATOMIC_SEQ_CST) == expected )
+	{
+		if( deadline )
+		{
+#ifdef __APPLE__
+			timespec now;
+			::clock_gettime( CLOCK_MONOTONIC, &now );
+			long long remaining = (deadline->tv_sec - now.tv_sec) * 1000000000LL +
+								  (deadline->tv_nsec - now.tv_nsec);
+			if( remaining > 0 )
+			{
+				timespec relative;
+				relative.tv_sec = (time_t)(remaining / 1000000000LL);
+				relative.tv_nsec = (long)(remaining % 1000000000LL);
+				woken = ::pthread_cond_timedwait_relative_np( &bucket.condition,
+															  &bucket.mutex,
+															  &relative ) != ETIMEDOUT;
+			}
+			else
+			{
+				woken = false;
+			}
+#else
+			woken = ::pthread_cond_timedwait( &bucket.condition,
+											  &bucket.mutex,
+											  deadline ) != ETIMEDOUT;
+#endif
+		}
+		else
+		{
+			::pthread_cond_wait( &bucket.condition, &bucket.mutex );
+		}
+	}
+	::pthread_mutex_unlock( &bucket.mutex );
+
+	return woken;
+}
+
+static void wakeWord( int* word, int count )
+{
+	// Other words may share the bucket, so everyone has to be woken to re-check
+	ParkingBucket& bucket = getParkingBucket( word );
+	::pthread_mutex_lock( &bucket.mutex );
+	::pthread_cond_broadcast( &bucket.condition );
+	::pthread_mutex_unlock( &bucket.mutex );
+}
+
+// Masks are only an optimisation, so without them everyone is woken
+static bool waitOnWord( int* word, int expected, const timespec* deadline, unsigned int mask )
+{
+	return waitOnWord( word, expected, deadline );
+}
+
+static void wakeWord( int* word, int count, unsigned int mask )
+{
+	wakeWord( word, count );
+}
+#endif
+
+/**
+ * Advances an event sequence word, wrapping rather than overflowing. Wrapping keeps the parity
+ * intact as the range of an int is even.
+ */
+static int nextSequence( int sequence )
+{
+	return (int)((unsigned int)sequence + 1U);
+}
+
+/**
+ * Moves an event sequence word from signaled (odd) to cleared (even). Returns true if the word was
+ * signaled.
+ */
+static bool resetSequence( int* word )
+{
+	int sequence = __atomic_load_n( word, __ATOMIC_RELAXED );
+	while( sequence & 1 )
+	{
+		if( __atomic_compare_exchange_n(word,
+										&sequence,
+										nextSequence(sequence),
+										true,
+										__ATOMIC_SEQ_CST,
+										__ATOMIC_RELAXED) )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//----------------------------------------------------------
+//                    SPINNING LOCKS
+//----------------------------------------------------------
+// Upper bound on the number of pause instructions an LP_ADAPTIVE or LP_QUEUED lock spins for
+// before it puts the thread to sleep. A few microseconds on current hardware.
+static const int LOCK_SPIN_LIMIT = 200;
+
+/**
+ * Spinning only helps if the lock holder can be running at the same time
+ */
+static bool shouldSpin()
+{
+	static bool multiprocessor = Platform::getProcessorCount() > 1;
+	return multiprocessor;
+}
+
+/**
+ * LP_ADAPTIVE lock, after "Futexes Are Tricky" (Drepper), with a bounded spin before sleeping
+ */
+static void enterAdaptiveLock( int& state )
+{
+	int expected = 0;
+	if( __atomic_compare_exchange_n(&state, &expected, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED) )
+		return;
+
+	if( shouldSpin() )
+	{
+		for( int spin = 0 ; spin < LOCK_SPIN_LIMIT ; ++spin )
+		{
+			Platform::spinPause();
+
+			expected = 0;
+			if( __atomic_load_n(&state, __ATOMIC_RELAXED) == 0 &&
+				__atomic_compare_exchange_n(&state,
+											&expected,
+											1,
+											false,
+											__ATOMIC_ACQUIRE,
+											__ATOMIC_RELAXED) )
+			{
+				return;
+			}
+		}
+	}
+
+	// Mark the lock as having sleepers, so that the holder knows to wake someone. We may then
+	// take the lock in the contended state even if there is nobody left asleep, which just costs
+	// an unnecessary wake.
+	while( __atomic_exchange_n(&state, 2, __ATOMIC_ACQUIRE) != 0 )
+		waitOnWord( &state, 2, NULL );
+}
+
+static void leaveAdaptiveLock( int& state )
+{
+	if( __atomic_exchange_n(&state, 0, __ATOMIC_RELEASE) == 2 )
+		wakeWord( &state, 1 );
+}
+
+/**
+ * Sleepers on a ticket lock are split into 32 channels by ticket number, so that handing the lock
+ * on only disturbs one thread in 32
+ */
+static unsigned int getTicketMask( int ticket )
+{
+	return 1U << ((unsigned int)ticket & 31U);
+}
+
+/**
+ * LP_QUEUED lock. Each thread takes a ticket and waits for its number to come up. Only the thread
+ * that is next in line spins, everyone else sleeps straight away.
+ */
+static void enterTicketLock( WrappedCriticalSection& lock )
+{
+	int ticket = __atomic_fetch_add( &lock.nextTicket, 1, __ATOMIC_RELAXED );
+	int serving = __atomic_load_n( &lock.nowServing, __ATOMIC_ACQUIRE );
+	if( serving == ticket )
+		return;
+
+	if( shouldSpin() && (unsigned int)ticket - (unsigned int)serving == 1U )
+	{
+		for( int spin = 0 ; spin < LOCK_SPIN_LIMIT ; ++spin )
+		{
+			Platform::spinPause();
+			if( __atomic_load_n(&lock.nowServing, __ATOMIC_ACQUIRE) == ticket )
+				return;
+		}
+	}
+
+	__atomic_add_fetch( &lock.waiters, 1, __ATOMIC_SEQ_CST );
+	serving = __atomic_load_n( &lock.nowServing, __ATOMIC_SEQ_CST );
+	while( serving != ticket )
+	{
+		waitOnWord( &lock.nowServing, serving, NULL, getTicketMask(ticket) );
+		serving = __atomic_load_n( &lock.nowServing, __ATOMIC_SEQ_CST );
+	}
+	__atomic_sub_fetch( &lock.waiters, 1, __ATOMIC_RELAXED );
+
+	// Acquire ordering for the critical section
+	__atomic_thread_fence( __ATOMIC_ACQUIRE );
+}
+
+static void leaveTicketLock( WrappedCriticalSection& lock )
+{
+	int serving = __atomic_add_fetch( &lock.nowServing, 1, __ATOMIC_SEQ_CST );
+
+	// Only wake the sleepers whose ticket could be the one now being served
+	if( __atomic_load_n(&lock.waiters, __ATOMIC_SEQ_CST) > 0 )
+		wakeWord( &lock.nowServing, INT_MAX, getTicketMask(serving) );
+}
+
+//----------------------------------------------------------
+//                   READ/WRITE LOCKS
+//----------------------------------------------------------
+static const int RWLOCK_WRITER = INT_MIN;
+
+/**
+ * Takes a read lock if there is no writer holding the lock or waiting for it. Waiting writers
+ * are given preference so that a steady stream of readers cannot starve them.
+ */
+static bool tryEnterReadLock( WrappedReadWriteLock& lock )
+{
+	int state = __atomic_load_n( &lock.state, __ATOMIC_SEQ_CST );
+	while( (state & RWLOCK_WRITER) == 0 && __atomic_load_n(&lock.writersWaiting, __ATOMIC_SEQ_CST) == 0 )
+	{
+		if( __atomic_compare_exchange_n(&lock.state,
+										&state,
+										state + 1,
+										true,
+										__ATOMIC_SEQ_CST,
+										__ATOMIC_SEQ_CST) )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool tryEnterWriteLock( WrappedReadWriteLock& lock )
+{
+	int expected = 0;
+	return __atomic_compare_exchange_n( &lock.state,
+										&expected,
+										RWLOCK_WRITER,
+										false,
+										__ATOMIC_SEQ_CST,
+										__ATOMIC_RELAXED );
+}
+
+/**
+ * Moves a sequence word on and wakes everyone sleeping on it
+ */
+static void wakeSleepers( int& sequence )
+{
+	__atomic_add_fetch( &sequence, 1, __ATOMIC_SEQ_CST );
+	wakeWord( &sequence, INT_MAX );
+}
+
+//----------------------------------------------------------
+//                PROCESSORS AND THREAD OPTIONS
+//----------------------------------------------------------
+/**
+ * Reads the first line of a small file, such as one of the attributes under /sys, without its
+ * line ending
+ *
+ * @return false if the file could not be read
+ */
+static bool readFirstLine( const char* path, char* buffer, size_t length )
+{
+	FILE* file = ::fopen( path, "r" );
+	if( !file )
+		return false;
+
+	bool result = ::fgets( buffer, (int)length, file ) != NULL;
+	::fclose( file );
+
+	if( result )
+		buffer[::strcspn(buffer, "\n")] = '\0';
+
+	return result;
+}
+
+/**
+ * Reads a file under /sys that holds a single number
+ *
+ * @return the number, or defaultValue if the file could not be read
+ */
+static long readNumber( const char* path, long defaultValue )
+{
+	char buffer[64];
+	if( !readFirstLine(path, buffer, sizeof(buffer)) )
+		return defaultValue;
+
+	char* end = NULL;
+	long value = ::strtol( buffer, &end, 10 );
+	return end != buffer ? value : defaultValue;
+}
+
+/**
+ * Reads a size in the format the kernel uses for caches (eg: "48K" or "32M")
+ *
+ * @return the size in bytes, or 0 if the file could not be read
+ */
+static size_t readSize( const char* path )
+{
+	char buffer[64];
+	if( !readFirstLine(path, buffer, sizeof(buffer)) )
+		return 0;
+
+	char* suffix = NULL;
+	size_t size = (size_t)::strtoul( buffer, &suffix, 10 );
+	switch( *suffix )
+	{
+		case 'K':
+			return size * 1024;
+		case 'M':
+			return size * 1024 * 1024;
+		case 'G':
+			return size * 1024 * 1024 * 1024;
+		default:
+			return size;
+	}
+}
+
+/**
+ * Reads a list of processors in the format the kernel uses under /sys (eg: "0-3,8,10-11")
+ *
+ * @return false if the file could not be read
+ */
+static bool readProcessorList( const char* path, std::vector<unsigned int>& processors )
+{
+	char buffer[4096];
+	bool result = readFirstLine( path, buffer, sizeof(buffer) );
+
+	char* position = buffer;
+	while( result && *position >= '0' && *position <= '9' )
+	{
+		unsigned long first = ::strtoul( position, &position, 10 );
+		unsigned long last = first;
+		if( *position == '-' )
+			last = ::strtoul( position + 1, &position, 10 );
+
+		for( unsigned long processor = first; processor <= last; ++processor )
+			processors.push_back( (unsigned int)processor );
+
+		if( *position == ',' )
+			++position;
+	}
+
+	return result;
+}
+
+static bool isRealTimePolicy( SchedulingPolicy policy )
+{
+	return policy == SP_FIFO || policy == SP_ROUND_ROBIN;
+}
+
+/**
+ * Sets the stack size and processor affinity of a thread that is about to be created. The
+ * scheduling policy is left to setThreadScheduling(), as glibc rejects SCHED_BATCH and SCHED_IDLE
+ * in thread attributes.
+ *
+ * @return false if the options cannot be honoured on this platform
+ */
+static bool setThreadAttributes( pthread_attr_t& attributes, const ThreadOptions& options )
+{
+	bool result = true;
+	if( options.stackSize > 0 )
+	{
+		// The stack has to be at least the system minimum, and a whole number of pages
+		size_t pageSize = (size_t)::sysconf( _SC_PAGESIZE );
+		size_t stackSize = options.stackSize;
+		if( stackSize < (size_t)PTHREAD_STACK_MIN )
+			stackSize = (size_t)PTHREAD_STACK_MIN;
+
+		stackSize = (stackSize + pageSize - 1) / pageSize * pageSize;
+		result = ::pthread_attr_setstacksize( &attributes, stackSize ) == 0;
+	}
+
+	// Restrict the thread to its NUMA node, unless it was given processors of its own. A node
+	// that does not exist is only a preference that cannot be met, so it is ignored.
+	std::vector<unsigned int> processors = options.processors;
+	if( processors.empty() && options.numaNode >= 0 )
+		processors = Platform::getTopology().getNodeProcessors( options.numaNode );
+
+	if( result && !processors.empty() )
+	{
+#ifdef __linux__
+		unsigned int highest = 0;
+		for( size_t i = 0; i < processors.size(); ++i )
+		{
+			if( processors[i] > highest )
+				highest = processors[i];
+		}
+
+		cpu_set_t* processorSet = CPU_ALLOC( highest + 1 );
+		size_t setSize = CPU_ALLOC_SIZE( highest + 1 );
+		CPU_ZERO_S( setSize, processorSet );
+		for( size_t i = 0; i < processors.size(); ++i )
+			CPU_SET_S( processors[i], setSize, processorSet );
+
+		result = ::pthread_attr_setaffinity_np( &attributes, setSize, processorSet ) == 0;
+		CPU_FREE( processorSet );
+#else
+		result = false;
+#endif
+	}
+
+	return result;
+}
+
+/**
+ * Moves a created thread into the scheduling class its options ask for
+ *
+ * @return false if the policy is not supported, or the caller lacks the privileges for it
+ */
+static bool setThreadScheduling( pthread_t thread, const ThreadOptions& options )
+{
+	struct sched_param parameters;
+	::memset( &parameters, 0, sizeof(parameters) );
+
+	int policy = SCHED_OTHER;
+	switch( options.schedulingPolicy )
+	{
+#ifdef __linux__
+		case SP_BATCH:
+			policy = SCHED_BATCH;
+			break;
+		case SP_IDLE:
+			policy = SCHED_IDLE;
+			break;
+#endif
+		case SP_FIFO:
+			policy = SCHED_FIFO;
+			parameters.sched_priority = options.priority;
+			break;
+		case SP_ROUND_ROBIN:
+			policy = SCHED_RR;
+			parameters.sched_priority = options.priority;
+			break;
+		case SP_DEFAULT:
+			break;
+		default:
+			return false;
+	}
+
+	return ::pthread_setschedparam( thread, policy, &parameters ) == 0;
+}
+
+/**
+ * Applies the options that a thread can only set for itself. Both are preferences, so a thread
+ * that cannot have them still runs.
+ */
+static void applyThreadPreferences( int niceValue, int numaNode )
+{
+#ifdef __linux__
+	// Linux keeps a nice value for each thread rather than one for the whole process
+	if( niceValue != 0 )
+		::setpriority( PRIO_PROCESS, (id_t)::syscall(SYS_gettid), niceValue );
+
+	// Called directly, as set_mempolicy() is part of libnuma rather than the C library. The
+	// mode is MPOL_PREFERRED from <numaif.h>.
+	if( numaNode >= 0 )
+	{
+		const int preferredMode = 1;
+		const size_t bitsPerWord = sizeof(unsigned long) * 8;
+		std::vector<unsigned long> nodeMask( numaNode / bitsPerWord + 1, 0 );
+		nodeMask[numaNode / bitsPerWord] = 1UL << (numaNode % bitsPerWord);
+
+		::syscall( SYS_set_mempolicy, preferredMode, &nodeMask[0], nodeMask.size() * bitsPerWord + 1 );
+	}
+#endif
+}
+
+//----------------------------------------------------------
+//                     STATIC METHODS
+//----------------------------------------------------------
+NATIVE_SEMAPHORE Platform::createUninitialisedSemaphore()
+{
+	NATIVE_SEMAPHORE semaphore;
+	semaphore.initialised = false;
+	semaphore.permits = 0;
+	semaphore.sequence = 0;
+	semaphore.waiters = 0;
+	semaphore.releasers = 0;
+	return semaphore;
+}
+
+bool Platform::initialiseSemaphore( NATIVE_SEMAPHORE& nativeSemaphore, 
+								    unsigned int maximumCount, 
+									const String &name )
+{
+	assert( !Platform::isSemaphoreInitialised(nativeSemaphore) );
+
+	bool result = false;
+	if ( !Platform::isSemaphoreInitialised(nativeSemaphore) )
+	{
+		// An anonymous, in-process semaphore. The name is only used on Windows.
+		nativeSemaphore.permits = (int)maximumCount;
+		nativeSemaphore.sequence = 0;
+		nativeSemaphore.waiters = 0;
+		nativeSemaphore.releasers = 0;
+		__atomic_store_n( &nativeSemaphore.initialised, true, __ATOMIC_RELEASE );
+		result = true;
+	}
+
+	return result;
+}
+
+bool Platform::isSemaphoreInitialised( const NATIVE_SEMAPHORE& nativeSemaphore )
+{
+	return nativeSemaphore.initialised;
+}
+
+bool Platform::destroySemaphore( NATIVE_SEMAPHORE& nativeSemaphore )
+{
+	assert( Platform::isSemaphoreInitialised(nativeSemaphore) );
+
+	bool result = false;
+	if ( Platform::isSemaphoreInitialised(nativeSemaphore) )
+	{
+		__atomic_store_n( &nativeSemaphore.initialised, false, __ATOMIC_SEQ_CST );
+
+		// Release anyone still blocked (they will return WR_ABANDONED), and hang around until
+		// they, and any release still in progress, have stopped touching the semaphore
+		__atomic_add_fetch( &nativeSemaphore.sequence, 1, __ATOMIC_SEQ_CST );
+		while( __atomic_load_n(&nativeSemaphore.waiters, __ATOMIC_ACQUIRE) > 0 )
+		{
+			wakeWord( &nativeSemaphore.sequence, INT_MAX );
+			Platform::yieldThread();
+		}
+
+		while( __atomic_load_n(&nativeSemaphore.releasers, __ATOMIC_ACQUIRE) > 0 )
+			Platform::yieldThread();
+
+		result = true;
+	}
+
+	return result;
+}
+
+bool Platform::tryAcquireSemaphore( NATIVE_SEMAPHORE& nativeSemaphore, unsigned int permits )
+{
+	int wanted = (int)permits;
+	int available = __atomic_load_n( &nativeSemaphore.permits, __ATOMIC_RELAXED );
+	while( available >= wanted )
+	{
+		if( __atomic_compare_exchange_n(&nativeSemaphore.permits,
+										&available,
+										available - wanted,
+										true,
+										__ATOMIC_ACQUIRE,
+										__ATOMIC_RELAXED) )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+unsigned int Platform::drainSemaphore( NATIVE_SEMAPHORE& nativeSemaphore, unsigned int maxPermits )
+{
+	int available = __atomic_load_n( &nativeSemaphore.permits, __ATOMIC_RELAXED );
+	while( available > 0 && maxPermits > 0 )
+	{
+		int wanted = (unsigned int)available < maxPermits ? available : (int)maxPermits;
+		if( __atomic_compare_exchange_n(&nativeSemaphore.permits,
+										&available,
+										available - wanted,
+										true,
+										__ATOMIC_ACQUIRE,
+										__ATOMIC_RELAXED) )
+		{
+			return (unsigned int)wanted;
+		}
+	}
+
+	return 0;
+}
+
+WaitResult Platform::waitOnSemaphore( NATIVE_SEMAPHORE& nativeSemaphore,
+									  unsigned int permits,
+									  NATIVE_INTERRUPT& threadInterrupt,
+									  unsigned long timeout )
+{
+	assert( Platform::isSemaphoreInitialised(nativeSemaphore) );
+	assert( Platform::isThreadInterruptInitialised(threadInterrupt) );
+
+	if( !Platform::isSemaphoreInitialised(nativeSemaphore) ||
+		!Platform::isThreadInterruptInitialised(threadInterrupt) )
+	{
+		return WR_FAILED;
+	}
+
+	if( Platform::tryAcquireSemaphore(nativeSemaphore, permits) )
+		return WR_SUCCEEDED;
+
+	timespec deadline;
+	if( timeout != NATIVE_INFINITE_WAIT )
+		computeDeadline( timeout, deadline );
+
+	// Register as a waiter and let signalInterrupt() know where to find us, before looking at
+	// anything that would decide whether we sleep
+	__atomic_add_fetch( &nativeSemaphore.waiters, 1, __ATOMIC_SEQ_CST );
+	::pthread_mutex_lock( &threadInterrupt.blockedLock );
+	threadInterrupt.blockedOn = &nativeSemaphore.sequence;
+	::pthread_mutex_unlock( &threadInterrupt.blockedLock );
+
+	WaitResult result = WR_FAILED;
+	while( result == WR_FAILED )
+	{
+		int sequence = __atomic_load_n( &nativeSemaphore.sequence, __ATOMIC_SEQ_CST );
+		if( !__atomic_load_n(&nativeSemaphore.initialised, __ATOMIC_SEQ_CST) )
+		{
+			result = WR_ABANDONED;
+		}
+		else if( Platform::tryAcquireSemaphore(nativeSemaphore, permits) )
+		{
+			result = WR_SUCCEEDED;
+		}
+		else if( Platform::clearInterrupt(threadInterrupt) )
+		{
+			// Consumed, as with the auto-reset interrupt event used on Windows
+			result = WR_INTERRUPTED;
+		}
+		else
+		{
+			bool woken = waitOnWord( &nativeSemaphore.sequence,
+									 sequence,
+									 timeout == NATIVE_INFINITE_WAIT ? NULL : &deadline );
+			if( !woken )
+			{
+				if( Platform::tryAcquireSemaphore(nativeSemaphore, permits) )
+					result = WR_SUCCEEDED;
+				else
+					result = WR_TIMEOUT;
+			}
+		}
+	}
+
+	::pthread_mutex_lock( &threadInterrupt.blockedLock );
+	threadInterrupt.blockedOn = NULL;
+	::pthread_mutex_unlock( &threadInterrupt.blockedLock );
+	// Must be our last access to the semaphore, as destroySemaphore() waits for this to reach zero
+	__atomic_sub_fetch( &nativeSemaphore.waiters, 1, __ATOMIC_RELEASE );
+
+	return result;
+}
+
+bool Platform::releaseSemaphore( NATIVE_SEMAPHORE& nativeSemaphore, unsigned int permits )
+{
+	assert( Platform::isSemaphoreInitialised(nativeSemaphore) );
+
+	// Announce ourselves before looking at the semaphore, as we still touch it after an acquirer
+	// may have taken the permits and let it be destroyed
+	__atomic_add_fetch( &nativeSemaphore.releasers, 1, __ATOMIC_SEQ_CST );
+
+	bool result = false;
+	if ( __atomic_load_n(&nativeSemaphore.initialised, __ATOMIC_SEQ_CST) )
+	{
+		__atomic_add_fetch( &nativeSemaphore.permits, (int)permits, __ATOMIC_SEQ_CST );
+
+		// Everyone is woken, as a waiter that wants more permits than were released cannot
+		// pass its wakeup on to one that wants fewer
+		if( __atomic_load_n(&nativeSemaphore.waiters, __ATOMIC_SEQ_CST) > 0 )
+		{
+			__atomic_add_fetch( &nativeSemaphore.sequence, 1, __ATOMIC_SEQ_CST );
+			wakeWord( &nativeSemaphore.sequence, INT_MAX );
+		}
+
+		result = true;
+	}
+
+	// Must be our last access to the semaphore, as destroySemaphore() waits for this to reach zero
+	__atomic_sub_fetch( &nativeSemaphore.releasers, 1, __ATOMIC_RELEASE );
+
+	return result;
+}
+
+void Platform::initialiseCriticalSection( NATIVE_CRITICALSECTION& nativeCriticalSection )
+{
+	Platform::initialiseCriticalSection( nativeCriticalSection, LP_RECURSIVE );
+}
+
+void Platform::initialiseCriticalSection( NATIVE_CRITICALSECTION& nativeCriticalSection,
+										  LockPolicy policy )
+{
+	nativeCriticalSection.policy = policy;
+	nativeCriticalSection.state = 0;
+	nativeCriticalSection.nextTicket = 0;
+	nativeCriticalSection.nowServing = 0;
+	nativeCriticalSection.waiters = 0;
+
+	if( policy == LP_RECURSIVE || policy == LP_PLAIN )
+	{
+		pthread_mutexattr_t attributes;
+		::pthread_mutexattr_init( &attributes );
+		::pthread_mutexattr_settype( &attributes,
+									 policy == LP_RECURSIVE ? PTHREAD_MUTEX_RECURSIVE
+															: PTHREAD_MUTEX_NORMAL );
+
+		int initResult = ::pthread_mutex_init( &nativeCriticalSection.mutex, &attributes );
+		assert( initResult == 0 );
+
+		::pthread_mutexattr_destroy( &attributes );
+	}
+}
+
+void Platform::destroyCriticalSection( NATIVE_CRITICALSECTION& nativeCriticalSection )
+{
+	if( nativeCriticalSection.policy == LP_RECURSIVE || nativeCriticalSection.policy == LP_PLAIN )
+		::pthread_mutex_destroy( &nativeCriticalSection.mutex );
+}
+
+void Platform::enterCriticalSection( NATIVE_CRITICALSECTION& nativeCriticalSection )
+{
+	switch( nativeCriticalSection.policy )
+	{
+		case LP_ADAPTIVE:
+			enterAdaptiveLock( nativeCriticalSection.state );
+			break;
+		case LP_QUEUED:
+			enterTicketLock( nativeCriticalSection );
+			break;
+		default:
+			::pthread_mutex_lock( &nativeCriticalSection.mutex );
+			break;
+	}
+}
+
+void Platform::leaveCriticalSection( NATIVE_CRITICALSECTION& nativeCriticalSection )
+{
+	switch( nativeCriticalSection.policy )
+	{
+		case LP_ADAPTIVE:
+			leaveAdaptiveLock( nativeCriticalSection.state );
+			break;
+		case LP_QUEUED:
+			leaveTicketLock( nativeCriticalSection );
+			break;
+		default:
+			::pthread_mutex_unlock( &nativeCriticalSection.mutex );
+			break;
+	}
+}
+
+void Platform::initialiseReadWriteLock( NATIVE_RWLOCK& nativeLock )
+{
+	nativeLock.state = 0;
+	nativeLock.readersWaiting = 0;
+	nativeLock.writersWaiting = 0;
+	nativeLock.readerSequence = 0;
+	nativeLock.writerSequence = 0;
+}
+
+void Platform::destroyReadWriteLock( NATIVE_RWLOCK& nativeLock )
+{
+	// Nothing to free
+}
+
+bool Platform::acquireReadLock( NATIVE_RWLOCK& nativeLock, unsigned long timeout )
+{
+	if( tryEnterReadLock(nativeLock) )
+		return true;
+	else if( timeout == 0 )
+		return false;
+
+	timespec deadline;
+	if( timeout != NATIVE_INFINITE_WAIT )
+		computeDeadline( timeout, deadline );
+
+	__atomic_add_fetch( &nativeLock.readersWaiting, 1, __ATOMIC_SEQ_CST );
+
+	bool acquired = false;
+	bool timedOut = false;
+	while( !acquired && !timedOut )
+	{
+		int sequence = __atomic_load_n( &nativeLock.readerSequence, __ATOMIC_SEQ_CST );
+		acquired = tryEnterReadLock( nativeLock );
+		if( !acquired )
+		{
+			bool woken = waitOnWord( &nativeLock.readerSequence,
+									 sequence,
+									 timeout == NATIVE_INFINITE_WAIT ? NULL : &deadline );
+			if( !woken )
+			{
+				acquired = tryEnterReadLock( nativeLock );
+				timedOut = !acquired;
+			}
+		}
+	}
+
+	__atomic_sub_fetch( &nativeLock.readersWaiting, 1, __ATOMIC_SEQ_CST );
+	return acquired;
+}
+
+void Platform::releaseReadLock( NATIVE_RWLOCK& nativeLock )
+{
+	int state = __atomic_sub_fetch( &nativeLock.state, 1, __ATOMIC_SEQ_CST );
+	if( state == 0 && __atomic_load_n(&nativeLock.writersWaiting, __ATOMIC_SEQ_CST) > 0 )
+		wakeSleepers( nativeLock.writerSequence );
+}
+
+bool Platform::acquireWriteLock( NATIVE_RWLOCK& nativeLock, unsigned long timeout )
+{
+	if( tryEnterWriteLock(nativeLock) )
+		return true;
+	else if( timeout == 0 )
+		return false;
+
+	timespec deadline;
+	if( timeout != NATIVE_INFINITE_WAIT )
+		computeDeadline( timeout, deadline );
+
+	// A waiting writer holds back new readers from here on
+	__atomic_add_fetch( &nativeLock.writersWaiting, 1, __ATOMIC_SEQ_CST );
+
+	bool acquired = false;
+	bool timedOut = false;
+	while( !acquired && !timedOut )
+	{
+		int sequence = __atomic_load_n( &nativeLock.writerSequence, __ATOMIC_SEQ_CST );
+		acquired = tryEnterWriteLock( nativeLock );
+		if( !acquired )
+		{
+			bool woken = waitOnWord( &nativeLock.writerSequence,
+									 sequence,
+									 timeout == NATIVE_INFINITE_WAIT ? NULL : &deadline );
+			if( !woken )
+			{
+				acquired = tryEnterWriteLock( nativeLock );
+				timedOut = !acquired;
+			}
+		}
+	}
+
+	int writersWaiting = __atomic_sub_fetch( &nativeLock.writersWaiting, 1, __ATOMIC_SEQ_CST );
+
+	// If we gave up and were the last writer in line, readers we were holding back may now go
+	if( timedOut && writersWaiting == 0 &&
+		__atomic_load_n(&nativeLock.readersWaiting, __ATOMIC_SEQ_CST) > 0 )
+	{
+		wakeSleepers( nativeLock.readerSequence );
+	}
+
+	return acquired;
+}
+
+void Platform::releaseWriteLock( NATIVE_RWLOCK& nativeLock )
+{
+	__atomic_store_n( &nativeLock.state, 0, __ATOMIC_SEQ_CST );
+
+	// Writers go first
+	if( __atomic_load_n(&nativeLock.writersWaiting, __ATOMIC_SEQ_CST) > 0 )
+		wakeSleepers( nativeLock.writerSequence );
+	else if( __atomic_load_n(&nativeLock.readersWaiting, __ATOMIC_SEQ_CST) > 0 )
+		wakeSleepers( nativeLock.readerSequence );
+}
+
+NATIVE_THREAD Platform::createUninitialisedThread()
+{
+	NATIVE_THREAD thread;
+	thread.initialised = false;
+
+	return thread;
+}
+
+bool Platform::initialiseThread( NATIVE_THREAD& nativeThread,
+								 void* thisPointer )
+{
+	return Platform::initialiseThread( nativeThread, thisPointer, ThreadOptions() );
+}
+
+bool Platform::initialiseThread( NATIVE_THREAD& nativeThread,
+								 void* thisPointer,
+								 const ThreadOptions& options )
+{
+	assert( !Platform::isThreadInitialised(nativeThread) );
+	assert( thisPointer );
+
+	bool result = false;
+	pthread_attr_t attributes;
+	if( !Platform::isThreadInitialised(nativeThread) && thisPointer &&
+		::pthread_attr_init(&attributes) == 0 )
+	{
+		if( setThreadAttributes(attributes, options) )
+		{
+			nativeThread.resumeEvent.initialised = false;
+			Platform::initialiseEvent( nativeThread.resumeEvent, false, TEXT("ThreadResume") );
+
+			// This will be freed in the thread entry routine
+			ThreadEntryData* entryData = (ThreadEntryData*)::malloc( sizeof(ThreadEntryData) );
+			entryData->nativeThread = &nativeThread;
+			entryData->argument = thisPointer;
+			entryData->niceValue = isRealTimePolicy(options.schedulingPolicy) ? 0 : options.priority;
+			entryData->numaNode = options.numaNode;
+			entryData->abandoned = false;
+
+			int createResult = ::pthread_create( &nativeThread.thread,
+												 &attributes,
+												 Platform::threadEntry,
+												 entryData );
+			if( createResult == 0 )
+			{
+				nativeThread.initialised = true;
+				result = true;
+
+				// The thread is waiting to be resumed, so it runs no user code before its
+				// scheduling is in place. If that cannot be done, let it exit straight away.
+				if( options.schedulingPolicy != SP_DEFAULT &&
+					!setThreadScheduling(nativeThread.thread, options) )
+				{
+					entryData->abandoned = true;
+					Platform::signalEvent( nativeThread.resumeEvent );
+					::pthread_join( nativeThread.thread, NULL );
+					Platform::destroyThread( nativeThread );
+					result = false;
+				}
+			}
+			else
+			{
+				::free( entryData );
+				Platform::destroyEvent( nativeThread.resumeEvent );
+			}
+		}
+
+		::pthread_attr_destroy( &attributes );
+	}
+
+	return result;
+}
+
+bool Platform::isThreadInitialised( const NATIVE_THREAD& nativeThread )
+{
+	return nativeThread.initialised;
+}
+
+bool Platform::destroyThread( NATIVE_THREAD& nativeThread )
+{
+	assert( Platform::isThreadInitialised(nativeThread) );
+	bool result = false;
+	if( Platform::isThreadInitialised(nativeThread) )
+	{
+		nativeThread.initialised = false;
+		Platform::destroyEvent( nativeThread.resumeEvent );
+		result = true;
+	}
+
+	return result;
+}
+
+bool Platform::resumeThread( NATIVE_THREAD& nativeThread )
+{
+	assert( Platform::isThreadInitialised(nativeThread) );
+	bool result = false;
+	if( Platform::isThreadInitialised(nativeThread) )
+	{
+		result = Platform::signalEvent( nativeThread.resumeEvent );
+	}
+
+	return result;
+}
+
+WaitResult Platform::joinThread( NATIVE_THREAD& nativeThread,
+								 NATIVE_INTERRUPT& threadInterrupt,
+								 unsigned long timeout )
+{
+	assert( Platform::isThreadInitialised(nativeThread) );
+	assert( Platform::isThreadInterruptInitialised(threadInterrupt) );
+
+	WaitResult result = WR_FAILED;
+	if( Platform::isThreadInitialised(nativeThread) &&
+			Platform::isThreadInterruptInitialised(threadInterrupt) )
+	{
+		int joinResult = ::pthread_join( nativeThread.thread, NULL );
+		if( joinResult == 0 )
+			result = WR_SUCCEEDED;
+	}
+
+	return result;
+}
+
+NATIVE_THREAD Platform::getCurrentThreadHandle()
+{
+	NATIVE_THREAD self;
+	self.initialised = true;
+	self.thread = ::pthread_self();
+	self.resumeEvent = Platform::createUninitialisedEvent();
+
+	return self;
+}
+
+bool Platform::threadHandlesEqual( NATIVE_THREAD handleOne, NATIVE_THREAD handleTwo )
+{
+	return ::pthread_equal( handleOne.thread, handleTwo.thread ) != 0;
+}
+
+void Platform::yieldThread()
+{
+	::sched_yield();
+}
+
+void Platform::spinPause()
+{
+#if defined(__i386__) || defined(__x86_64__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+	__asm__ __volatile__( "yield" );
+#endif
+}
+
+unsigned int Platform::getProcessorCount()
+{
+	long processors = ::sysconf( _SC_NPROCESSORS_ONLN );
+	return processors > 0 ? (unsigned int)processors : 1;
+}
+
+unsigned int Platform::getCurrentProcessor()
+{
+#ifdef __linux__
+	int processor = ::sched_getcpu();
+	return processor >= 0 ? (unsigned int)processor : 0;
+#else
+	return 0;
+#endif
+}
+
+const CpuTopology& Platform::getTopology()
+{
+	// Initialised on first use, which the compiler makes safe to race on
+	static CpuTopology topology = Platform::discoverTopology();
+	return topology;
+}
+
+CpuTopology Platform::discoverTopology()
+{
+	CpuTopology topology;
+
+	std::vector<unsigned int> online;
+	if( !readProcessorList("/sys/devices/system/cpu/online", online) || online.empty() )
+	{
+		online.clear();
+		for( unsigned int i = 0; i < Platform::getProcessorCount(); ++i )
+			online.push_back( i );
+	}
+
+	std::sort( online.begin(), online.end() );
+	online.erase( std::unique(online.begin(), online.end()), online.end() );
+
+	// The kernel's core ids are only unique within a package and may have gaps, so cores and
+	// packages are renumbered densely in the order they are first seen
+	std::map<long,unsigned int> packageIndexes;
+	std::map<std::pair<unsigned int,long>,unsigned int> coreIndexes;
+	char path[128];
+	for( size_t i = 0; i < online.size(); ++i )
+	{
+		unsigned int id = online[i];
+		::snprintf( path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/physical_package_id", id );
+		long packageId = readNumber( path, 0 );
+		::snprintf( path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/core_id", id );
+		long coreId = readNumber( path, -1 - (long)id );
+
+		if( packageIndexes.find(packageId) == packageIndexes.end() )
+			packageIndexes[packageId] = (unsigned int)packageIndexes.size();
+
+		ProcessorInfo info;
+		info.id = id;
+		info.package = packageIndexes[packageId];
+		info.node = 0;
+
+		std::pair<unsigned int,long> coreKey( info.package, coreId );
+		if( coreIndexes.find(coreKey) == coreIndexes.end() )
+			coreIndexes[coreKey] = (unsigned int)coreIndexes.size();
+
+		info.core = coreIndexes[coreKey];
+		topology.processors.push_back( info );
+	}
+
+	topology.packageCount = (unsigned int)packageIndexes.size();
+	topology.coreCount = (unsigned int)coreIndexes.size();
+
+	// Without NUMA support in the kernel, everything is on node 0
+	std::vector<unsigned int> nodeIds;
+	readProcessorList( "/sys/devices/system/node/online", nodeIds );
+	for( size_t i = 0; i < nodeIds.size(); ++i )
+	{
+		std::vector<unsigned int> nodeProcessors;
+		::snprintf( path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", nodeIds[i] );
+		readProcessorList( path, nodeProcessors );
+		for( size_t j = 0; j < nodeProcessors.size(); ++j )
+		{
+			ProcessorInfo* info = topology.findProcessor( nodeProcessors[j] );
+			if( info )
+				info->node = (int)nodeIds[i];
+		}
+	}
+
+	std::set<int> nodes;
+	for( size_t i = 0; i < topology.processors.size(); ++i )
+		nodes.insert( topology.processors[i].node );
+
+	topology.nodes.assign( nodes.begin(), nodes.end() );
+
+	// Every processor lists the caches it uses, so a shared cache is only recorded for the first
+	// processor that shares it
+	for( size_t i = 0; i < online.size(); ++i )
+	{
+		for( unsigned int index = 0; ; ++index )
+		{
+			char prefix[96];
+			::snprintf( prefix, sizeof(prefix), "/sys/devices/system/cpu/cpu%u/cache/index%u", online[i], index );
+
+			::snprintf( path, sizeof(path), "%s/level", prefix );
+			long level = readNumber( path, -1 );
+			if( level < 0 )
+				break;
+
+			CacheInfo cache;
+			cache.level = (unsigned int)level;
+			cache.type = CT_UNIFIED;
+
+			char type[32];
+			::snprintf( path, sizeof(path), "%s/type", prefix );
+			if( readFirstLine(path, type, sizeof(type)) )
+			{
+				if( ::strcmp(type, "Data") == 0 )
+					cache.type = CT_DATA;
+				else if( ::strcmp(type, "Instruction") == 0 )
+					cache.type = CT_INSTRUCTION;
+			}
+
+			::snprintf( path, sizeof(path), "%s/size", prefix );
+			cache.size = readSize( path );
+			::snprintf( path, sizeof(path), "%s/coherency_line_size", prefix );
+			cache.lineSize = (unsigned int)readNumber( path, 0 );
+			::snprintf( path, sizeof(path), "%s/ways_of_associativity", prefix );
+			cache.associativity = (unsigned int)readNumber( path, 0 );
+			::snprintf( path, sizeof(path), "%s/shared_cpu_list", prefix );
+			if( !readProcessorList(path, cache.processors) || cache.processors.empty() )
+				cache.processors.assign( 1, online[i] );
+
+			bool alreadySeen = false;
+			for( size_t j = 0; j < topology.caches.size() && !alreadySeen; ++j )
+			{
+				const CacheInfo& other = topology.caches[j];
+				alreadySeen = other.level == cache.level && other.type == cache.type &&
+				              std::find(other.processors.begin(), other.processors.end(), online[i]) != other.processors.end();
+			}
+
+			if( !alreadySeen )
+				topology.caches.push_back( cache );
+		}
+	}
+
+	return topology;
+}
+
+NATIVE_INTERRUPT Platform::createUninitialisedInterrupt()
+{
+	NATIVE_INTERRUPT nativeInterrupt;
+	nativeInterrupt.event = Platform::createUninitialisedEvent();
+	nativeInterrupt.blockedOn = NULL;
+	return nativeInterrupt;
+}
+
+bool Platform::initialiseThreadInterrupt( NATIVE_INTERRUPT& nativeInterrupt, const String& name )
+{
+	assert( !Platform::isThreadInterruptInitialised(nativeInterrupt) );
+
+	bool result = false;
+	if( !Platform::isThreadInterruptInitialised(nativeInterrupt) )
+	{
+		::pthread_mutex_init( &nativeInterrupt.blockedLock, NULL );
+		nativeInterrupt.blockedOn = NULL;
+		result = Platform::initialiseEvent( nativeInterrupt.event, false, name );
+	}
+
+	return result;
+}
+
+bool Platform::isThreadInterruptInitialised( const NATIVE_INTERRUPT& nativeInterrupt )
+{
+	return Platform::isEventInitialised( nativeInterrupt.event );
+}
+
+bool Platform::destroyThreadInterrupt( NATIVE_INTERRUPT& nativeInterrupt )
+{
+	bool result = false;
+	if( Platform::isThreadInterruptInitialised(nativeInterrupt) )
+	{
+		result = Platform::destroyEvent( nativeInterrupt.event );
+		::pthread_mutex_destroy( &nativeInterrupt.blockedLock );
+	}
+
+	return result;
+}
+
+WaitResult Platform::performInterruptableSleep( NATIVE_INTERRUPT& threadInterrupt,
+												unsigned long timeout )
+{
+	assert( Platform::isThreadInterruptInitialised(threadInterrupt) );
+	WaitResult result = WR_FAILED;
+
+	if( Platform::isThreadInterruptInitialised(threadInterrupt) )
+	{
+		result = Platform::waitOnEvent( threadInterrupt.event, timeout );
+
+		// If waitInEvent was returned a success, then the interrupt was called. Consume it so
+		// that the interrupt behaves like the auto-reset event used on Windows
+		if( result == WR_SUCCEEDED )
+		{
+			Platform::clearInterrupt( threadInterrupt );
+			result = WR_INTERRUPTED;
+		}
+	}
+
+	return result;
+}
+
+bool Platform::signalInterrupt( NATIVE_INTERRUPT& nativeInterrupt )
+{
+	bool result = Platform::signalEvent( nativeInterrupt.event );
+
+	// If the thread is asleep in a semaphore, it is waiting on the semaphore's word rather than
+	// the interrupt event, so move that word on as well to wake it up
+	::pthread_mutex_lock( &nativeInterrupt.blockedLock );
+	if( nativeInterrupt.blockedOn )
+	{
+		__atomic_add_fetch( nativeInterrupt.blockedOn, 1, __ATOMIC_SEQ_CST );
+		wakeWord( nativeInterrupt.blockedOn, INT_MAX );
+	}
+	::pthread_mutex_unlock( &nativeInterrupt.blockedLock );
+
+	return result;
+}
+
+bool Platform::clearInterrupt( NATIVE_INTERRUPT& nativeInterrupt )
+{
+	assert( nativeInterrupt.event.initialised );
+
+	bool wasSignaled = false;
+	if( nativeInterrupt.event.initialised )
+		wasSignaled = resetSequence( &nativeInterrupt.event.sequence );
+
+	return wasSignaled;
+}
+
+NATIVE_EVENT Platform::createUninitialisedEvent()
+{
+	NATIVE_EVENT event;
+	event.initialised = false;
+	event.sequence = 0;
+	event.waiters = 0;
+	event.signalers = 0;
+	return event;
+}
+
+bool Platform::initialiseEvent( NATIVE_EVENT& event, bool initialState, const String& name )
+{
+	assert( !event.initialised );
+	if( !event.initialised )
+	{
+		event.sequence = initialState ? 1 : 0;
+		event.waiters = 0;
+		event.signalers = 0;
+		__atomic_store_n( &event.initialised, true, __ATOMIC_RELEASE );
+	}
+
+	return event.initialised;
+}
+
+bool Platform::isEventInitialised( const NATIVE_EVENT& event )
+{
+	return event.initialised;
+}
+
+bool Platform::signalEvent( NATIVE_EVENT& event )
+{
+	bool signaled = false;
+
+	// Announce ourselves before looking at the event, as we still read it after the waiters
+	// may have seen the signal and let it be destroyed
+	__atomic_add_fetch( &event.signalers, 1, __ATOMIC_SEQ_CST );
+
+	assert( event.initialised );
+	if( __atomic_load_n(&event.initialised, __ATOMIC_SEQ_CST) )
+	{
+		signaled = true;
+
+		int sequence = __atomic_load_n( &event.sequence, __ATOMIC_RELAXED );
+		while( (sequence & 1) == 0 )
+		{
+			if( __atomic_compare_exchange_n(&event.sequence,
+											&sequence,
+											nextSequence(sequence),
+											true,
+											__ATOMIC_SEQ_CST,
+											__ATOMIC_RELAXED) )
+			{
+				// Waiters register before they look at the sequence, so if there are none
+				// registered now, any that turn up later will see the new value
+				if( __atomic_load_n(&event.waiters, __ATOMIC_SEQ_CST) > 0 )
+					wakeWord( &event.sequence, INT_MAX );
+
+				break;
+			}
+		}
+	}
+
+	// Must be our last access to the event, as destroyEvent() waits for this to reach zero
+	__atomic_sub_fetch( &event.signalers, 1, __ATOMIC_RELEASE );
+
+	return signaled;
+}
+
+void Platform::clearEvent( NATIVE_EVENT& event )
+{
+	assert( event.initialised );
+	resetSequence( &event.sequence );
+}
+
+WaitResult Platform::waitOnEvent( NATIVE_EVENT& event, unsigned long timeout )
+{
+	if( !__atomic_load_n(&event.initialised, __ATOMIC_ACQUIRE) )
+		return WR_ABANDONED;
+
+	// Fast path, the event is already signaled
+	int sequence = __atomic_load_n( &event.sequence, __ATOMIC_ACQUIRE );
+	if( sequence & 1 )
+		return WR_SUCCEEDED;
+
+	timespec deadline;
+	if( timeout != NATIVE_INFINITE_WAIT )
+		computeDeadline( timeout, deadline );
+
+	// The sequence is even, and only a signal can move it on from here. Any change we see from
+	// now on therefore means the event was signaled, even if it has been cleared again since.
+	__atomic_add_fetch( &event.waiters, 1, __ATOMIC_SEQ_CST );
+
+	WaitResult result = WR_FAILED;
+	while( result == WR_FAILED )
+	{
+		if( !__atomic_load_n(&event.initialised, __ATOMIC_SEQ_CST) )
+		{
+			result = WR_ABANDONED;
+		}
+		else if( __atomic_load_n(&event.sequence, __ATOMIC_SEQ_CST) != sequence )
+		{
+			result = WR_SUCCEEDED;
+		}
+		else
+		{
+			bool woken = waitOnWord( &event.sequence,
+									 sequence,
+									 timeout == NATIVE_INFINITE_WAIT ? NULL : &deadline );
+			if( !woken && __atomic_load_n(&event.sequence, __ATOMIC_SEQ_CST) == sequence )
+				result = WR_TIMEOUT;
+		}
+	}
+
+	// Must be our last access to the event, as destroyEvent() waits for this to reach zero
+	__atomic_sub_fetch( &event.waiters, 1, __ATOMIC_RELEASE );
+
+	return result;
+}
+
+bool Platform::destroyEvent( NATIVE_EVENT& event )
+{
+	bool destroyed = false;
+	if( event.initialised )
+	{
+		__atomic_store_n( &event.initialised, false, __ATOMIC_SEQ_CST );
+
+		// Release anyone still waiting (they will return WR_ABANDONED), and hang around until
+		// they have stopped touching the event. Moving the sequence on by two leaves the
+		// signaled state as it was.
+		__atomic_add_fetch( &event.sequence, 2, __ATOMIC_SEQ_CST );
+		while( __atomic_load_n(&event.waiters, __ATOMIC_ACQUIRE) > 0 )
+		{
+			wakeWord( &event.sequence, INT_MAX );
+			Platform::yieldThread();
+		}
+
+		// A signal that released the last waiter may still be on its way out
+		while( __atomic_load_n(&event.signalers, __ATOMIC_ACQUIRE) > 0 )
+			Platform::yieldThread();
+
+		destroyed = true;
+	}
+
+	return destroyed;
+}
+
+bool Platform::initialiseSocketFramework()
+{
+	// Nothing to do on Posix
+	return true;
+}
+
+void Platform::cleanupSocketFramework()
+{
+	// Nothing to do on Posix
+}
+
+void Platform::setMulticastSocketOptions( NATIVE_SOCKET& socket )
+{
+	// Set SO_REUSEADDR so that other processes can bind to it
+	int intTrue = 1;
+	::setsockopt( socket,
+				  SOL_SOCKET, 
+				  SO_REUSEADDR, 
+				  (char*)&intTrue,
+				  sizeof(intTrue) );
+
+#ifdef __APPLE__
+	// MacOSX also requires us to set SO_REUSEPORT
+	::setsockopt( socket,
+				  SOL_SOCKET,
+				  SO_REUSEPORT,
+				  (char*)&intTrue,
+				  sizeof(intTrue) );
+#endif
+}
+
+NATIVE_IP_ADDRESS Platform::lookupHost( const tchar* hostName )
+{
+	NATIVE_IP_ADDRESS result = INADDR_NONE;
+
+	std::string narrowHostName = Platform::toAnsiString( hostName );
+	if( !narrowHostName.empty() )
+	{
+		const char* narrowHostNameCStr = narrowHostName.c_str();
+
+		hostent* hostEntry = ::gethostbyname( narrowHostNameCStr );
+		if ( hostEntry != NULL )
+			result = ntohl( *((NATIVE_IP_ADDRESS*)hostEntry->h_addr) );
+	}
+
+	return result;
+
+}
+
+#include <arpa/inet.h>
+
+int Platform::lookupHostName( NATIVE_IP_ADDRESS address,
+							  int addressType,
+							  tchar* outBuffer,
+							  int outBufferSize )
+{
+	int returnSize = 0;
+
+	in_addr addressRequest;
+	addressRequest.s_addr = htonl( address );
+	hostent* host = ::gethostbyaddr( (const char*)&addressRequest,
+									 sizeof(in_addr),
+									 addressType );
+	if( host )
+	{
+		const char* name = host->h_name;
+		returnSize = Platform::toPlatformChars( name, strlen(name), outBuffer, outBufferSize );
+	}
+
+	return returnSize;
+}
+
+int Platform::getHostAddress( NATIVE_IP_ADDRESS address,
+							  int addressType,
+							  tchar* outBuffer,
+							  int outBufferSize )
+{
+	int returnSize = 0;
+
+	in_addr addressRequest;
+	addressRequest.s_addr = htonl( address );
+	char* ansiAddress = ::inet_ntoa( addressRequest );
+
+	if( ansiAddress )
+	{
+		returnSize = Platform::toPlatformChars( ansiAddress,
+												strlen(ansiAddress),
+												outBuffer,
+												outBufferSize );
+	}
+
+	return returnSize;
+}
+
+int Platform::setNonBlockingMode( NATIVE_SOCKET socket, bool enable )
+{
+	long mode = ::fcntl( socket, F_GETFL, NULL );
+	if( enable )
+		mode |= O_NONBLOCK;
+	else
+		mode &= ~O_NONBLOCK;
+
+	return ::fcntl( socket, F_SETFL, mode );
+		
+}
+
+const int Platform::closeSocket( NATIVE_SOCKET socket )
+{
+	return ::close( socket );
+}
+
+const tchar* Platform::describeLastSocketError()
+{
+	return Platform::describeSocketError( errno );
+}
+
+const tchar* Platform::describeSocketError( int errorCode )
+{
+	const tchar* error = TEXT("Unknown Error");
+
+	switch( errorCode )
+	{
+		case EADDRINUSE:
+			error = TEXT("Address already in use");
+			break;
+		case EADDRNOTAVAIL:
+			error = TEXT("Address not available");
+			break;
+		case EAFNOSUPPORT:
+			error = TEXT("Address family not supported");
+			break;
+		case EAGAIN:
+			error = TEXT("Resource temporarily unavailable");
+			break;
+		case EALREADY:
+			error = TEXT("Connection already in progress");
+			break;
+		case EBADF:
+			error = TEXT("Bad file descriptor");
+			break;
+		case EBUSY:
+			error = TEXT("Device or resource busy");
+			break;
+		case ECANCELED:
+			error = TEXT("Operation cancelled");
+			break;
+		case ECONNABORTED:
+			error = TEXT("Connection aborted");
+			break;
+		case ECONNREFUSED:
+			error = TEXT("Connection refused");
+			break;
+		case ECONNRESET:
+			error = TEXT("Connection reset");
+			break;
+		case EFAULT:
+			error = TEXT("Bad address");
+			break;
+		case EHOSTDOWN:
+			error = TEXT("Host is down");
+			break;
+		case EHOSTUNREACH:
+			error = TEXT("Host is unreachable");
+			break;
+		case EINVAL:
+			error = TEXT("Invalid argument");
+			break;
+		case EISCONN:
+			error = TEXT("Socket is connected");
+			break;
+		case ENETDOWN:
+			error = TEXT("Network is down");
+			break;
+		case ENETRESET:
+			error = TEXT("Connection aborted by network");
+			break;
+		case ENETUNREACH:
+			error = TEXT("Network unreachable");
+			break;
+		case ENOBUFS:
+			error = TEXT("No buffer space available");
+			break;
+		case ENOPROTOOPT:
+			error = TEXT("Protocol is not available");
+			break;
+		case ENOTCONN:
+			error = TEXT("The socket is not connected");
+			break;
+		case ENOTSOCK:
+			error = TEXT("Not a socket");
+			break;
+		case EPFNOSUPPORT:
+			error = TEXT("Protocol not supported");
+			break;
+		case EPIPE:
+			error = TEXT("Broken pipe");
+			break;
+		case EPROTO:
+			error = TEXT("Protocol error");
+			break;
+		case EPROTONOSUPPORT:
+			error = TEXT("Protocol not supported");
+			break;
+		case EPROTOTYPE:
+			error = TEXT("Protocol wrong type for socket");
+			break;
+		case ESHUTDOWN:
+			error = TEXT("Cannot send after transport endpoint shutdown");
+			break;
+		case ESOCKTNOSUPPORT:
+			error = TEXT("Socket type not supported");
+			break;
+		case ETIMEDOUT:
+			error = TEXT("Connection timed out");
+			break;
+	}
+
+	return error;
+}
+
+bool Platform::isLastSocketErrorSocketConnecting()
+{
+	return errno == EINPROGRESS;
+}
+
+bool Platform::isLastSocketErrorWouldBlock()
+{
+	return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+bool Platform::setReusePort( NATIVE_SOCKET socket, bool enable )
+{
+#ifdef SO_REUSEPORT
+	int flag = enable ? 1 : 0;
+	return ::setsockopt( socket, SOL_SOCKET, SO_REUSEPORT, (char*)&flag, sizeof(flag) ) == 0;
+#else
+	return !enable;
+#endif
+}
+
+/*
+ * Sets an integer socket option, for Platform::applySocketOptions()
+ */
+static bool setIntegerOption( NATIVE_SOCKET socket, int level, int name, int value )
+{
+	return ::setsockopt( socket, level, name, (char*)&value, sizeof(value) ) == 0;
+}
+
+bool Platform::applySocketOptions( NATIVE_SOCKET socket, const SocketOptions& options )
+{
+	if( options.noDelay >= 0 && !setIntegerOption(socket, IPPROTO_TCP, TCP_NODELAY, options.noDelay) )
+		return false;
+
+#ifdef TCP_QUICKACK
+	if( options.quickAck >= 0 && !setIntegerOption(socket, IPPROTO_TCP, TCP_QUICKACK, options.quickAck) )
+		return false;
+#endif
+
+	if( options.sendBufferSize > 0 &&
+	    !setIntegerOption(socket, SOL_SOCKET, SO_SNDBUF, options.sendBufferSize) )
+		return false;
+
+	if( options.receiveBufferSize > 0 &&
+	    !setIntegerOption(socket, SOL_SOCKET, SO_RCVBUF, options.receiveBufferSize) )
+		return false;
+
+#ifdef SO_BUSY_POLL
+	// Unprivileged processes may only lower it, and busy polling is only ever a bonus
+	if( options.busyPoll > 0 &&
+	    !setIntegerOption(socket, SOL_SOCKET, SO_BUSY_POLL, options.busyPoll) &&
+	    errno != EPERM )
+		return false;
+#endif
+
+#ifdef TCP_USER_TIMEOUT
+	if( options.userTimeout > 0 &&
+	    !setIntegerOption(socket, IPPROTO_TCP, TCP_USER_TIMEOUT, (int)options.userTimeout) )
+		return false;
+#endif
+
+	if( options.keepAlive >= 0 &&
+	    !setIntegerOption(socket, SOL_SOCKET, SO_KEEPALIVE, options.keepAlive) )
+		return false;
+
+	// macOS calls the idle time TCP_KEEPALIVE
+#if defined(TCP_KEEPIDLE)
+	if( options.keepAliveIdle > 0 &&
+	    !setIntegerOption(socket, IPPROTO_TCP, TCP_KEEPIDLE, options.keepAliveIdle) )
+		return false;
+#elif defined(TCP_KEEPALIVE)
+	if( options.keepAliveIdle > 0 &&
+	    !setIntegerOption(socket, IPPROTO_TCP, TCP_KEEPALIVE, options.keepAliveIdle) )
+		return false;
+#endif
+
+#ifdef TCP_KEEPINTVL
+	if( options.keepAliveInterval > 0 &&
+	    !setIntegerOption(socket, IPPROTO_TCP, TCP_KEEPINTVL, options.keepAliveInterval) )
+		return false;
+#endif
+
+#ifdef TCP_KEEPCNT
+	if( options.keepAliveCount > 0 &&
+	    !setIntegerOption(socket, IPPROTO_TCP, TCP_KEEPCNT, options.keepAliveCount) )
+		return false;
+#endif
+
+	if( options.linger >= 0 )
+	{
+		linger lingerOption;
+		lingerOption.l_onoff = 1;
+		lingerOption.l_linger = options.linger;
+		if( ::setsockopt(socket, SOL_SOCKET, SO_LINGER, (char*)&lingerOption, sizeof(lingerOption)) != 0 )
+			return false;
+	}
+
+	return true;
+}
+
+void Platform::rearmQuickAck( NATIVE_SOCKET socket )
+{
+#ifdef TCP_QUICKACK
+	setIntegerOption( socket, IPPROTO_TCP, TCP_QUICKACK, 1 );
+#endif
+}
+
+bool Platform::setReusePortSteering( NATIVE_SOCKET socket,
+                                     const std::vector<unsigned int>& processors )
+{
+#ifdef __linux__
+	// Load the processor, compare it against each socket's in turn, and otherwise return it
+	// modulo the number of sockets
+	if( processors.empty() || processors.size() * 2 + 3 > BPF_MAXINSNS )
+		return false;
+
+	std::vector<sock_filter> program;
+	sock_filter loadProcessor = BPF_STMT( BPF_LD | BPF_W | BPF_ABS,
+	                                      (unsigned int)(SKF_AD_OFF + SKF_AD_CPU) );
+	program.push_back( loadProcessor );
+	for( size_t i = 0; i < processors.size(); ++i )
+	{
+		sock_filter compare = BPF_JUMP( BPF_JMP | BPF_JEQ | BPF_K, processors[i], 0, 1 );
+		sock_filter choose = BPF_STMT( BPF_RET | BPF_K, (unsigned int)i );
+		program.push_back( compare );
+		program.push_back( choose );
+	}
+
+	sock_filter spread = BPF_STMT( BPF_ALU | BPF_MOD | BPF_K, (unsigned int)processors.size() );
+	sock_filter chooseSpread = BPF_STMT( BPF_RET | BPF_A, 0 );
+	program.push_back( spread );
+	program.push_back( chooseSpread );
+
+	sock_fprog attached;
+	attached.len = (unsigned short)program.size();
+	attached.filter = &program[0];
+	return ::setsockopt( socket,
+	                     SOL_SOCKET,
+	                     SO_ATTACH_REUSEPORT_CBPF,
+	                     (char*)&attached,
+	                     sizeof(attached) ) == 0;
+#else
+	return false;
+#endif
+}
+
+bool Platform::setIncomingProcessor( NATIVE_SOCKET socket, int processor )
+{
+#ifdef SO_INCOMING_CPU
+	return ::setsockopt( socket, SOL_SOCKET, SO_INCOMING_CPU, (char*)&processor, sizeof(processor) ) == 0;
+#else
+	return false;
+#endif
+}
+
+int Platform::getIncomingProcessor( NATIVE_SOCKET socket )
+{
+	int processor = -1;
+#ifdef SO_INCOMING_CPU
+	NATIVE_SOCKET_LEN length = sizeof( processor );
+	if( ::getsockopt(socket, SOL_SOCKET, SO_INCOMING_CPU, (char*)&processor, &length) != 0 )
+		processor = -1;
+#endif
+
+	return processor;
+}
+
+int Platform::pollSockets( SocketPoll* sockets, size_t count, unsigned long timeout )
+{
+	std::vector<pollfd> descriptors( count );
+	for( size_t i = 0; i < count; ++i )
+	{
+		descriptors[i].fd = sockets[i].socket;
+		descriptors[i].events = 0;
+		descriptors[i].revents = 0;
+		if( sockets[i].interest & SE_READ )
+			descriptors[i].events |= POLLIN;
+		if( sockets[i].interest & SE_WRITE )
+			descriptors[i].events |= POLLOUT;
+	}
+
+	int pollTimeout = timeout == NATIVE_INFINITE_WAIT ? -1 :
+	                  timeout > (unsigned long)INT_MAX ? INT_MAX : (int)timeout;
+
+	// A signal cuts the wait short, which callers treat the same as a timeout
+	int result = ::poll( count > 0 ? &descriptors[0] : NULL, (nfds_t)count, pollTimeout );
+	if( result < 0 && errno == EINTR )
+		result = 0;
+
+	for( size_t i = 0; i < count; ++i )
+	{
+		int ready = 0;
+		if( descriptors[i].revents & (POLLIN | POLLHUP) )
+			ready |= SE_READ;
+		if( descriptors[i].revents & POLLOUT )
+			ready |= SE_WRITE;
+		if( descriptors[i].revents & (POLLERR | POLLNVAL) )
+			ready |= SE_ERROR;
+
+		sockets[i].ready = ready;
+	}
+
+	return result;
+}
+
+#ifdef __linux__
+// Room for the one control message that carries a segment size, aligned as cmsghdr requires
+union SegmentControl
+{
+	char buffer[CMSG_SPACE(sizeof(int))];
+	cmsghdr alignment;
+};
+
+int Platform::receiveDatagrams( NATIVE_SOCKET socket,
+                                DatagramMessage* messages,
+                                int count,
+                                bool wait )
+{
+	mmsghdr headers[DatagramMessage::MAX_BATCH];
+	iovec vectors[DatagramMessage::MAX_BATCH];
+	sockaddr_in senders[DatagramMessage::MAX_BATCH];
+	SegmentControl controls[DatagramMessage::MAX_BATCH];
+	if( count > DatagramMessage::MAX_BATCH )
+		count = DatagramMessage::MAX_BATCH;
+
+	::memset( headers, 0, sizeof(mmsghdr) * count );
+	for( int i = 0; i < count; ++i )
+	{
+		vectors[i].iov_base = messages[i].buffer;
+		vectors[i].iov_len = messages[i].length;
+		headers[i].msg_hdr.msg_iov = &vectors[i];
+		headers[i].msg_hdr.msg_iovlen = 1;
+		headers[i].msg_hdr.msg_name = &senders[i];
+		headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+		headers[i].msg_hdr.msg_control = controls[i].buffer;
+		headers[i].msg_hdr.msg_controllen = sizeof(controls[i].buffer);
+	}
+
+	// recvmmsg() only looks at its own timeout between datagrams, so waiting is left to the
+	// socket, and only for the first
+	int received = ::recvmmsg( socket, headers, count, wait ? MSG_WAITFORONE : MSG_DONTWAIT, NULL );
+	if( received < 0 )
+		return Platform::isLastSocketErrorWouldBlock() ? 0 : -1;
+
+	for( int i = 0; i < received; ++i )
+	{
+		messages[i].length = (int)headers[i].msg_len;
+		messages[i].address = ntohl( senders[i].sin_addr.s_addr );
+		messages[i].port = ntohs( senders[i].sin_port );
+		messages[i].segmentSize = 0;
+
+		// Only present when receive offload is on and the kernel coalesced several datagrams
+		cmsghdr* control = CMSG_FIRSTHDR( &headers[i].msg_hdr );
+		for( ; control; control = CMSG_NXTHDR(&headers[i].msg_hdr, control) )
+		{
+			if( control->cmsg_level == SOL_UDP && control->cmsg_type == UDP_GRO )
+			{
+				int segmentSize = 0;
+				::memcpy( &segmentSize, CMSG_DATA(control), sizeof(segmentSize) );
+				messages[i].segmentSize = segmentSize;
+			}
+		}
+	}
+
+	return received;
+}
+
+int Platform::sendDatagrams( NATIVE_SOCKET socket, DatagramMessage* messages, int count )
+{
+	mmsghdr headers[DatagramMessage::MAX_BATCH];
+	iovec vectors[DatagramMessage::MAX_BATCH];
+	sockaddr_in destinations[DatagramMessage::MAX_BATCH];
+	SegmentControl controls[DatagramMessage::MAX_BATCH];
+	if( count > DatagramMessage::MAX_BATCH )
+		count = DatagramMessage::MAX_BATCH;
+
+	::memset( headers, 0, sizeof(mmsghdr) * count );
+	::memset( destinations, 0, sizeof(sockaddr_in) * count );
+	for( int i = 0; i < count; ++i )
+	{
+		vectors[i].iov_base = messages[i].buffer;
+		vectors[i].iov_len = messages[i].length;
+		destinations[i].sin_family = AF_INET;
+		destinations[i].sin_addr.s_addr = htonl( messages[i].address );
+		destinations[i].sin_port = htons( messages[i].port );
+		headers[i].msg_hdr.msg_iov = &vectors[i];
+		headers[i].msg_hdr.msg_iovlen = 1;
+		headers[i].msg_hdr.msg_name = &destinations[i];
+		headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+
+		// The kernel splits the buffer into datagrams of the segment size on its way out, so
+		// that the whole run costs one pass through the stack
+		if( messages[i].segmentSize > 0 && messages[i].segmentSize < messages[i].length )
+		{
+			headers[i].msg_hdr.msg_control = controls[i].buffer;
+			headers[i].msg_hdr.msg_controllen = CMSG_SPACE( sizeof(uint16_t) );
+
+			cmsghdr* control = CMSG_FIRSTHDR( &headers[i].msg_hdr );
+			control->cmsg_level = SOL_UDP;
+			control->cmsg_type = UDP_SEGMENT;
+			control->cmsg_len = CMSG_LEN( sizeof(uint16_t) );
+			uint16_t segmentSize = (uint16_t)messages[i].segmentSize;
+			::memcpy( CMSG_DATA(control), &segmentSize, sizeof(segmentSize) );
+		}
+	}
+
+	// Stops at the first datagram that fails, reporting those before it as sent
+	int sent = ::sendmmsg( socket, headers, count, 0 );
+	if( sent < 0 )
+		return Platform::isLastSocketErrorWouldBlock() ? 0 : -1;
+
+	return sent;
+}
+#else
+int Platform::receiveDatagrams( NATIVE_SOCKET socket,
+                                DatagramMessage* messages,
+                                int count,
+                                bool wait )
+{
+	// One datagram per call, taking the ones after the first only if they have already arrived
+	int received = 0;
+	while( received < count )
+	{
+		if( received > 0 || !wait )
+		{
+			SocketPoll readable;
+			readable.socket = socket;
+			readable.interest = SE_READ;
+			readable.ready = 0;
+			if( Platform::pollSockets(&readable, 1, 0) <= 0 || !(readable.ready & SE_READ) )
+				break;
+		}
+
+		DatagramMessage& message = messages[received];
+		sockaddr_in from;
+		NATIVE_SOCKET_LEN fromSize = sizeof( from );
+		int result = ::recvfrom( socket,
+		                         message.buffer,
+		                         message.length,
+		                         0,
+		                         (sockaddr*)&from,
+		                         &fromSize );
+		if( result < 0 )
+		{
+			if( received == 0 && !Platform::isLastSocketErrorWouldBlock() )
+				return -1;
+
+			break;
+		}
+
+		message.length = result;
+		message.address = ntohl( from.sin_addr.s_addr );
+		message.port = ntohs( from.sin_port );
+		message.segmentSize = 0;
+		++received;
+	}
+
+	return received;
+}
+
+int Platform::sendDatagrams( NATIVE_SOCKET socket, DatagramMessage* messages, int count )
+{
+	int sent = 0;
+	while( sent < count )
+	{
+		const DatagramMessage& message = messages[sent];
+		sockaddr_in to;
+		::memset( &to, 0, sizeof(to) );
+		to.sin_family = AF_INET;
+		to.sin_addr.s_addr = htonl( message.address );
+		to.sin_port = htons( message.port );
+
+		// Without offload each segment goes out on its own, and the message only counts as sent
+		// once all of them have
+		int segmentSize = message.segmentSize > 0 ? message.segmentSize : message.length;
+		int offset = 0;
+		bool failed = false;
+		do
+		{
+			int segmentLength = message.length - offset;
+			if( segmentLength > segmentSize )
+				segmentLength = segmentSize;
+
+			if( ::sendto(socket,
+			             message.buffer + offset,
+			             segmentLength,
+			             0,
+			             (sockaddr*)&to,
+			             sizeof(to)) < 0 )
+			{
+				failed = true;
+				break;
+			}
+
+			offset += segmentLength;
+		}
+		while( offset < message.length );
 
-		if( result == WR_INTERRUPTED )
-			::ResetEvent( interruptHandle );
+		if( failed )
+		{
+			if( sent == 0 && !Platform::isLastSocketErrorWouldBlock() )
+				return -1;
+
+			break;
+		}
+
+		++sent;
 	}
 
-	return result;
+	return sent;
 }
+#endif
 
+bool Platform::setReceiveOffload( NATIVE_SOCKET socket, bool enable )
+{
+#ifdef UDP_GRO
+	int flag = enable ? 1 : 0;
+	return ::setsockopt( socket, IPPROTO_UDP, UDP_GRO, (char*)&flag, sizeof(flag) ) == 0;
 #else
+	return !enable;
+#endif
+}
 
-#include <sys/time.h>
-#include <sys/socket.h>
-#include <sys/stat.h>
-#include <netdb.h>
-#include <unistd.h>
-#include <sys/ioctl.h>
-#include <net/if.h>
-#include <arpa/inet.h>
-#include <limits.h>
-#include <fcntl.h>
-#include <cstdio>
-#include <cstring>
+int Platform::sendSegments( NATIVE_SOCKET socket, const BufferSegment* segments, int count )
+{
+	iovec vectors[BufferSegment::MAX_BATCH];
+	if( count > BufferSegment::MAX_BATCH )
+		count = BufferSegment::MAX_BATCH;
 
-const tchar* Platform::DIRECTORY_SEPARATOR = TEXT("/");
-const tchar* Platform::PATH_SEPARATOR = TEXT(":");
+	for( int i = 0; i < count; ++i )
+	{
+		vectors[i].iov_base = segments[i].buffer;
+		vectors[i].iov_len = segments[i].length;
+	}
 
-//----------------------------------------------------------
-//                     STATIC METHODS
-//----------------------------------------------------------
-NATIVE_SEMAPHORE Platform::createUninitialisedSemaphore()
-{
-	return NULL;
+	// sendmsg() rather than writev(), so that a closed peer is reported without a SIGPIPE
+	msghdr header;
+	::memset( &header, 0, sizeof(header) );
+	header.msg_iov = vectors;
+	header.msg_iovlen = count;
+	return (int)::sendmsg( socket, &header, NATIVE_SOCKET_SEND_FLAGS );
 }
 
-bool Platform::initialiseSemaphore( NATIVE_SEMAPHORE& nativeSemaphore, 
-								    unsigned int maximumCount, 
-									const String &name )
+int Platform::receiveSegments( NATIVE_SOCKET socket, BufferSegment* segments, int count )
 {
-	assert( !Platform::isSemaphoreInitialised(nativeSemaphore) );
+	iovec vectors[BufferSegment::MAX_BATCH];
+	if( count > BufferSegment::MAX_BATCH )
+		count = BufferSegment::MAX_BATCH;
 
-	bool result = false;
-	if ( !Platform::isSemaphoreInitialised(nativeSemaphore) )
+	for( int i = 0; i < count; ++i )
 	{
-		// MacOSX doesn't support in-process semaphores created by sem_init(), so we need to create
-		// a 'grownup' semaphore instead with sem_open()
-		std::string ansiName = Platform::toAnsiString( name.c_str() );
-
-		// Semaphore path
-		char semName[PATH_MAX];
-		semName[0] = 0;
-		sprintf( semName, "/tmp/sem_pid%ld_%s", (long)getpid(), ansiName.c_str() );
-
-		// Create the semaphore
-		sem_t* createdSemaphore = ::sem_open( semName,
-											  O_CREAT | O_EXCL,
-											  S_IWUSR | S_IRUSR,
-											  maximumCount );
-		if( createdSemaphore != SEM_FAILED )
-		{
-			nativeSemaphore = createdSemaphore;
-			result = true;
-		}
+		vectors[i].iov_base = segments[i].buffer;
+		vectors[i].iov_len = segments[i].length;
 	}
 
-	return result;
+	return (int)::readv( socket, vectors, count );
 }
 
-bool Platform::isSemaphoreInitialised( const NATIVE_SEMAPHORE nativeSemaphore )
+#ifdef __linux__
+bool Platform::setZeroCopy( NATIVE_SOCKET socket, bool enable )
 {
-	return nativeSemaphore != NULL;
+	int flag = enable ? 1 : 0;
+	return ::setsockopt( socket, SOL_SOCKET, SO_ZEROCOPY, (char*)&flag, sizeof(flag) ) == 0;
 }
 
-bool Platform::destroySemaphore( NATIVE_SEMAPHORE& nativeSemaphore )
+int Platform::sendZeroCopy( NATIVE_SOCKET socket, const char* buffer, int length, bool& copied )
 {
-	assert( Platform::isSemaphoreInitialised(nativeSemaphore) );
+	copied = false;
+	int result = (int)::send( socket, buffer, length, MSG_ZEROCOPY | NATIVE_SOCKET_SEND_FLAGS );
 
-	bool result = false;
-	if ( Platform::isSemaphoreInitialised(nativeSemaphore) )
+	// Each zero-copy send holds some of the socket's option memory until it completes, and
+	// once that runs out the kernel refuses more rather than copying
+	if( result < 0 && errno == ENOBUFS )
 	{
-		int destroyResult = ::sem_close( nativeSemaphore );
-		if ( destroyResult != -1 )
-		{
-			nativeSemaphore = NULL;
-			result = true;
-		}
+		copied = true;
+		result = (int)::send( socket, buffer, length, NATIVE_SOCKET_SEND_FLAGS );
 	}
 
 	return result;
 }
 
-WaitResult Platform::waitOnSemaphore( NATIVE_SEMAPHORE& nativeSemaphore,
-									  NATIVE_INTERRUPT& threadInterrupt,
-									  unsigned long timeout )
+int Platform::readZeroCopyCompletions( NATIVE_SOCKET socket, ZeroCopyRange* ranges, int count )
 {
-	assert( Platform::isSemaphoreInitialised(nativeSemaphore) );
-	assert( Platform::isThreadInterruptInitialised(threadInterrupt) );
+	int read = 0;
+	while( read < count )
+	{
+		// Room for the extended error and the address that comes with it, aligned as cmsghdr
+		// requires
+		union
+		{
+			char buffer[CMSG_SPACE(sizeof(sock_extended_err) + sizeof(sockaddr_in6))];
+			cmsghdr alignment;
+		} control;
+
+		msghdr header;
+		::memset( &header, 0, sizeof(header) );
+		header.msg_control = control.buffer;
+		header.msg_controllen = sizeof( control.buffer );
+		if( ::recvmsg(socket, &header, MSG_ERRQUEUE | MSG_DONTWAIT) < 0 )
+		{
+			if( errno == EAGAIN || errno == EWOULDBLOCK )
+				break;
 
-	WaitResult result = WR_FAILED;
-	if ( Platform::isSemaphoreInitialised(nativeSemaphore) /*&&
-		 Platform::isThreadInterruptInitialised(threadInterrupt)*/ )
-	{
-		// Interruptable/timed wait on semaphores don't work for posix at the moment :( The docco
-		// says however: "The sem_wait() function is interruptible by the delivery of a signal."
-		//
-		// Just need to work out how to implement that - don't have the time or the need at the
-		// moment though.
-		// TODO Looks like http://www.aao.gov.au/local/www/ks/uploads/sem_timedwait.c could be
-		// a possible implementation
-		int waitResult = ::sem_wait( nativeSemaphore );
-		if( waitResult != -1 )
-			result = WR_SUCCEEDED;
+			return read > 0 ? read : -1;
+		}
+
+		// The error queue carries other errors too, which are of no interest here
+		for( cmsghdr* message = CMSG_FIRSTHDR(&header);
+		     message;
+		     message = CMSG_NXTHDR(&header, message) )
+		{
+			bool ipError = (message->cmsg_level == SOL_IP && message->cmsg_type == IP_RECVERR) ||
+			               (message->cmsg_level == SOL_IPV6 && message->cmsg_type == IPV6_RECVERR);
+			if( !ipError )
+				continue;
+
+			sock_extended_err error;
+			::memcpy( &error, CMSG_DATA(message), sizeof(error) );
+			if( error.ee_errno != 0 || error.ee_origin != SO_EE_ORIGIN_ZEROCOPY )
+				continue;
+
+			ranges[read].first = error.ee_info;
+			ranges[read].last = error.ee_data;
+			ranges[read].copied = (error.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0;
+			++read;
+		}
 	}
 
-	return result;
+	return read;
 }
 
-bool Platform::releaseSemaphore( NATIVE_SEMAPHORE& nativeSemaphore )
+long long Platform::sendFile( NATIVE_SOCKET socket,
+                              NATIVE_FILE file,
+                              long long offset,
+                              long long length )
 {
-	assert( Platform::isSemaphoreInitialised(nativeSemaphore) );
+	// The most that sendfile() and splice() move in one call
+	const long long maxChunk = 0x7ffff000;
+	size_t chunk = (size_t)( length < maxChunk ? length : maxChunk );
 
-	bool result = false;
-	if ( Platform::isSemaphoreInitialised(nativeSemaphore) )
+	off_t position = (off_t)offset;
+	ssize_t result = ::sendfile( socket, file, &position, chunk );
+	if( result < 0 && (errno == EINVAL || errno == ESPIPE) )
 	{
-		int postResult = ::sem_post( nativeSemaphore );
-		result = postResult != -1;
+		// A pipe has no offset to send from, but can be spliced straight into the socket
+		result = ::splice( file, NULL, socket, NULL, chunk, SPLICE_F_MOVE | SPLICE_F_MORE );
 	}
 
 	return result;
 }
 
-void Platform::initialiseCriticalSection( NATIVE_CRITICALSECTION& nativeCriticalSection )
+bool Platform::createRelay( NATIVE_FILE& readEnd, NATIVE_FILE& writeEnd )
 {
-	pthread_mutexattr_t attributes;
-	::pthread_mutexattr_init( &attributes );
-	::pthread_mutexattr_settype( &attributes, PTHREAD_MUTEX_RECURSIVE );
+	int ends[2];
+	if( ::pipe2(ends, O_CLOEXEC) != 0 )
+		return false;
 
-	int initResult = ::pthread_mutex_init( &nativeCriticalSection, &attributes );
-	assert( initResult == 0 );
+	// A larger pipe lets each splice take more from the source, where the limits allow it
+	::fcntl( ends[1], F_SETPIPE_SZ, 1024 * 1024 );
 
-	::pthread_mutexattr_destroy( &attributes );
+	readEnd = ends[0];
+	writeEnd = ends[1];
+	return true;
 }
 
-void Platform::destroyCriticalSection( NATIVE_CRITICALSECTION& nativeCriticalSection )
+long long Platform::relaySocket( NATIVE_SOCKET from,
+                                 NATIVE_SOCKET to,
+                                 NATIVE_FILE readEnd,
+                                 NATIVE_FILE writeEnd,
+                                 long long length )
 {
-	::pthread_mutex_destroy( &nativeCriticalSection );
-}
+	const long long maxChunk = 0x7ffff000;
+	size_t chunk = (size_t)( length < maxChunk ? length : maxChunk );
 
-void Platform::enterCriticalSection( NATIVE_CRITICALSECTION& nativeCriticalSection )
-{
-	::pthread_mutex_lock( &nativeCriticalSection );
-}
+	ssize_t moved = ::splice( from, NULL, writeEnd, NULL, chunk, SPLICE_F_MOVE | SPLICE_F_MORE );
+	if( moved <= 0 )
+		return moved;
 
-void Platform::leaveCriticalSection( NATIVE_CRITICALSECTION& nativeCriticalSection )
+	// Whatever was taken from the source has to be passed on before returning, so that the pipe
+	// is empty between calls
+	ssize_t drained = 0;
+	while( drained < moved )
+	{
+		ssize_t result = ::splice( readEnd,
+		                           NULL,
+		                           to,
+		                           NULL,
+		                           moved - drained,
+		                           SPLICE_F_MOVE | SPLICE_F_MORE );
+		if( result < 0 )
+		{
+			if( errno != EAGAIN )
+				return -1;
+
+			pollfd writable;
+			writable.fd = to;
+			writable.events = POLLOUT;
+			writable.revents = 0;
+			::poll( &writable, 1, -1 );
+			continue;
+		}
+
+		drained += result;
+	}
+
+	return moved;
+}
+#else
+bool Platform::setZeroCopy( NATIVE_SOCKET socket, bool enable )
 {
-	::pthread_mutex_unlock( &nativeCriticalSection );
+	return !enable;
 }
 
-NATIVE_THREAD Platform::createUninitialisedThread()
+int Platform::sendZeroCopy( NATIVE_SOCKET socket, const char* buffer, int length, bool& copied )
 {
-	NATIVE_THREAD thread;
-	thread.initialised = false;
-
-	return thread;
+	copied = true;
+	return (int)::send( socket, buffer, length, NATIVE_SOCKET_SEND_FLAGS );
 }
 
-bool Platform::initialiseThread( NATIVE_THREAD& nativeThread,
-								 void* thisPointer )
+int Platform::readZeroCopyCompletions( NATIVE_SOCKET socket, ZeroCopyRange* ranges, int count )
 {
-	assert( !Platform::isThreadInitialised(nativeThread) );
-	assert( thisPointer );
+	return 0;
+}
 
-	bool result = false;
-	if( !Platform::isThreadInitialised(nativeThread) && thisPointer )
+/*
+ * Reads a chunk of the file and sends it, for where the file cannot be sent from directly. A
+ * pipe has no offset and cannot be read again, so all that is read goes out before returning.
+ */
+static long long sendFileBuffered( NATIVE_SOCKET socket,
+                                   NATIVE_FILE file,
+                                   long long offset,
+                                   long long length )
+{
+	char buffer[65536];
+	size_t toRead = length < (long long)sizeof(buffer) ? (size_t)length : sizeof(buffer);
+	ssize_t bytesRead = ::pread( file, buffer, toRead, (off_t)offset );
+	if( bytesRead < 0 && errno == ESPIPE )
+		bytesRead = ::read( file, buffer, toRead );
+
+	if( bytesRead <= 0 )
+		return bytesRead;
+
+	ssize_t sent = 0;
+	while( sent < bytesRead )
 	{
-		nativeThread.resumeEvent.initialised = false;
-		Platform::initialiseEvent( nativeThread.resumeEvent, false, TEXT("ThreadResume") );
-
-		// This will be freed in the thread entry routine
-		ThreadEntryData* entryData = (ThreadEntryData*)::malloc( sizeof(ThreadEntryData) );
-		entryData->nativeThread = &nativeThread;
-		entryData->argument = thisPointer;
-
-		int createResult = ::pthread_create( &nativeThread.thread,
-											 NULL,
-											 Platform::threadEntry,
-											 entryData );
-		if( createResult == 0 )
+		ssize_t result = ::send( socket, buffer + sent, bytesRead - sent, NATIVE_SOCKET_SEND_FLAGS );
+		if( result < 0 )
 		{
-			nativeThread.initialised = true;
-			result = true;
+			if( errno != EAGAIN && errno != EWOULDBLOCK )
+				return sent > 0 ? sent : -1;
+
+			pollfd writable;
+			writable.fd = socket;
+			writable.events = POLLOUT;
+			writable.revents = 0;
+			::poll( &writable, 1, -1 );
+			continue;
 		}
+
+		sent += result;
 	}
 
-	return result;
+	return sent;
 }
 
-bool Platform::isThreadInitialised( const NATIVE_THREAD& nativeThread )
+long long Platform::sendFile( NATIVE_SOCKET socket,
+                              NATIVE_FILE file,
+                              long long offset,
+                              long long length )
 {
-	return nativeThread.initialised;
+#ifdef __APPLE__
+	// Only regular files can be sent from directly. The length is updated with what was sent,
+	// even when the call fails part way.
+	off_t sent = (off_t)length;
+	if( ::sendfile(file, socket, (off_t)offset, &sent, NULL, 0) == 0 || sent > 0 )
+		return sent;
+
+	if( errno != ENOTSOCK && errno != EINVAL && errno != ENOTSUP )
+		return -1;
+#endif
+
+	return sendFileBuffered( socket, file, offset, length );
 }
 
-bool Platform::destroyThread( NATIVE_THREAD& nativeThread )
+bool Platform::createRelay( NATIVE_FILE& readEnd, NATIVE_FILE& writeEnd )
 {
-	assert( Platform::isThreadInitialised(nativeThread) );
-	bool result = false;
-	if( Platform::isThreadInitialised(nativeThread) )
-	{
-		nativeThread.initialised = false;
-		Platform::destroyEvent( nativeThread.resumeEvent );
-		result = true;
-	}
-
-	return result;
+	return false;
 }
 
-bool Platform::resumeThread( NATIVE_THREAD& nativeThread )
+long long Platform::relaySocket( NATIVE_SOCKET from,
+                                 NATIVE_SOCKET to,
+                                 NATIVE_FILE readEnd,
+                                 NATIVE_FILE writeEnd,
+                                 long long length )
 {
-	assert( Platform::isThreadInitialised(nativeThread) );
-	bool result = false;
-	if( Platform::isThreadInitialised(nativeThread) )
-	{
-		result = Platform::signalEvent( nativeThread.resumeEvent );
-	}
+	return -1;
+}
+#endif
 
-	return result;
+#ifdef __linux__
+NATIVE_SOCKET Platform::createWakeupSocket()
+{
+	return ::eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
 }
 
-WaitResult Platform::joinThread( NATIVE_THREAD& nativeThread,
-								 NATIVE_INTERRUPT& threadInterrupt,
-								 unsigned long timeout )
+void Platform::signalWakeupSocket( NATIVE_SOCKET wakeup )
 {
-	assert( Platform::isThreadInitialised(nativeThread) );
-	assert( Platform::isThreadInterruptInitialised(threadInterrupt) );
+	uint64_t increment = 1;
+	ssize_t written = ::write( wakeup, &increment, sizeof(increment) );
+	(void)written;
+}
 
-	WaitResult result = WR_FAILED;
-	if( Platform::isThreadInitialised(nativeThread) &&
-			Platform::isThreadInterruptInitialised(threadInterrupt) )
+void Platform::clearWakeupSocket( NATIVE_SOCKET wakeup )
+{
+	uint64_t count = 0;
+	ssize_t readCount = ::read( wakeup, &count, sizeof(count) );
+	(void)readCount;
+}
+#else
+NATIVE_SOCKET Platform::createWakeupSocket()
+{
+	// A loopback datagram socket connected to itself, so that anything sent on it can be read
+	// back from it
+	NATIVE_SOCKET wakeup = ::socket( AF_INET, SOCK_DGRAM, 0 );
+	if( wakeup == NATIVE_SOCKET_UNINIT )
+		return wakeup;
+
+	sockaddr_in address;
+	::memset( &address, 0, sizeof(address) );
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+	NATIVE_SOCKET_LEN length = sizeof( address );
+
+	if( ::bind(wakeup, (sockaddr*)&address, length) != 0 ||
+		::getsockname(wakeup, (sockaddr*)&address, &length) != 0 ||
+		::connect(wakeup, (sockaddr*)&address, length) != 0 ||
+		Platform::setNonBlockingMode(wakeup, true) != 0 )
 	{
-		int joinResult = ::pthread_join( nativeThread.thread, NULL );
-		if( joinResult == 0 )
-			result = WR_SUCCEEDED;
+		Platform::closeSocket( wakeup );
+		return NATIVE_SOCKET_UNINIT;
 	}
 
-	return result;
+	return wakeup;
 }
 
-NATIVE_THREAD Platform::getCurrentThreadHandle()
+void Platform::signalWakeupSocket( NATIVE_SOCKET wakeup )
 {
-	NATIVE_THREAD self;
-	self.initialised = true;
-	self.thread = ::pthread_self();
+	char signal = 0;
+	::send( wakeup, &signal, 1, 0 );
+}
 
-	return self;
+void Platform::clearWakeupSocket( NATIVE_SOCKET wakeup )
+{
+	char buffer[64];
+	while( ::recv(wakeup, buffer, sizeof(buffer), 0) > 0 )
+		;
+}
+#endif
+
+#ifdef __linux__
+static unsigned int toEpollEvents( int interest, bool edgeTriggered )
+{
+	unsigned int events = 0;
+	if( interest & SE_READ )
+		events |= EPOLLIN | EPOLLRDHUP;
+	if( interest & SE_WRITE )
+		events |= EPOLLOUT;
+	if( edgeTriggered )
+		events |= EPOLLET;
+
+	return events;
 }
 
-bool Platform::threadHandlesEqual( NATIVE_THREAD handleOne, NATIVE_THREAD handleTwo )
+NATIVE_POLLER Platform::createPoller()
 {
-	return ::pthread_equal( handleOne.thread, handleTwo.thread ) != 0;
+	return ::epoll_create1( EPOLL_CLOEXEC );
 }
 
-NATIVE_INTERRUPT Platform::createUninitialisedInterrupt()
+void Platform::closePoller( NATIVE_POLLER poller )
 {
-	return Platform::createUninitialisedEvent();
+	::close( poller );
 }
 
-bool Platform::initialiseThreadInterrupt( NATIVE_INTERRUPT& nativeInterrupt, const String& name )
+bool Platform::addToPoller( NATIVE_POLLER poller,
+                            NATIVE_SOCKET socket,
+                            int interest,
+                            bool edgeTriggered,
+                            void* context )
 {
-	return Platform::initialiseEvent( nativeInterrupt, false, name );
+	epoll_event event;
+	event.events = toEpollEvents( interest, edgeTriggered );
+	event.data.ptr = context;
+	return ::epoll_ctl( poller, EPOLL_CTL_ADD, socket, &event ) == 0;
 }
 
-bool Platform::isThreadInterruptInitialised( const NATIVE_INTERRUPT& nativeInterrupt )
+bool Platform::modifyInPoller( NATIVE_POLLER poller,
+                               NATIVE_SOCKET socket,
+                               int interest,
+                               bool edgeTriggered,
+                               void* context )
 {
-	return Platform::isEventInitialised( nativeInterrupt );
+	epoll_event event;
+	event.events = toEpollEvents( interest, edgeTriggered );
+	event.data.ptr = context;
+	return ::epoll_ctl( poller, EPOLL_CTL_MOD, socket, &event ) == 0;
 }
 
-bool Platform::destroyThreadInterrupt( NATIVE_INTERRUPT& nativeInterrupt )
+bool Platform::removeFromPoller( NATIVE_POLLER poller, NATIVE_SOCKET socket )
 {
-	return Platform::destroyEvent( nativeInterrupt );
+	// Kernels before 2.6.9 insist on an event, even though it is ignored
+	epoll_event event;
+	::memset( &event, 0, sizeof(event) );
+	return ::epoll_ctl( poller, EPOLL_CTL_DEL, socket, &event ) == 0;
 }
 
-WaitResult Platform::performInterruptableSleep( NATIVE_INTERRUPT& threadInterrupt,
-												unsigned long timeout )
+int Platform::waitOnPoller( NATIVE_POLLER poller,
+                            PollerEvent* events,
+                            size_t maxEvents,
+                            unsigned long timeout )
 {
-	assert( Platform::isThreadInterruptInitialised(threadInterrupt) );
-	WaitResult result = WR_FAILED;
+	const size_t BATCH_SIZE = 256;
+	epoll_event ready[BATCH_SIZE];
+	if( maxEvents > BATCH_SIZE )
+		maxEvents = BATCH_SIZE;
 
-	if( Platform::isThreadInterruptInitialised(threadInterrupt) )
-	{
-		result = Platform::waitOnEvent( threadInterrupt, timeout );
+	int waitTimeout = timeout == NATIVE_INFINITE_WAIT ? -1 :
+	                  timeout > (unsigned long)INT_MAX ? INT_MAX : (int)timeout;
 
-		// If waitInEvent was returned a success, then the interrupt was called
-		if( result == WR_SUCCEEDED )
-			result = WR_INTERRUPTED;
+	// A signal cuts the wait short, which callers treat the same as a timeout
+	int result = ::epoll_wait( poller, ready, (int)maxEvents, waitTimeout );
+	if( result < 0 )
+		return errno == EINTR ? 0 : -1;
+
+	for( int i = 0; i < result; ++i )
+	{
+		int flags = 0;
+		if( ready[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP) )
+			flags |= SE_READ;
+		if( ready[i].events & (EPOLLOUT | EPOLLHUP) )
+			flags |= SE_WRITE;
+		if( ready[i].events & EPOLLERR )
+			flags |= SE_ERROR;
+
+		events[i].context = ready[i].data.ptr;
+		events[i].ready = flags;
 	}
 
 	return result;
 }
+#else
+NATIVE_POLLER Platform::createPoller()
+{
+	// kqueue would do, but until then Selectors poll their sockets
+	return NATIVE_POLLER_UNINIT;
+}
 
-bool Platform::signalInterrupt( NATIVE_INTERRUPT& nativeInterrupt )
+void Platform::closePoller( NATIVE_POLLER poller )
 {
-	return Platform::signalEvent( nativeInterrupt );
+
 }
 
-NATIVE_EVENT Platform::createUninitialisedEvent()
+bool Platform::addToPoller( NATIVE_POLLER poller,
+                            NATIVE_SOCKET socket,
+                            int interest,
+                            bool edgeTriggered,
+                            void* context )
 {
-	NATIVE_EVENT event;
-	event.initialised = false;
-	return event;
+	return false;
 }
 
-bool Platform::initialiseEvent( NATIVE_EVENT& event, bool initialState, const String& name )
+bool Platform::modifyInPoller( NATIVE_POLLER poller,
+                               NATIVE_SOCKET socket,
+                               int interest,
+                               bool edgeTriggered,
+                               void* context )
 {
-	assert( !event.initialised );
-	if( !event.initialised )
-	{
-		::pthread_mutex_init( &event.mutex, NULL );
-		::pthread_cond_init( &event.noMoreListenersEvent, NULL );
+	return false;
+}
 
-		event.state = initialState;
-		event.initialised = true;
-	}
+bool Platform::removeFromPoller( NATIVE_POLLER poller, NATIVE_SOCKET socket )
+{
+	return false;
+}
 
-	return event.initialised;
+int Platform::waitOnPoller( NATIVE_POLLER poller,
+                            PollerEvent* events,
+                            size_t maxEvents,
+                            unsigned long timeout )
+{
+	return -1;
 }
+#endif
 
-bool Platform::isEventInitialised( const NATIVE_EVENT& event )
+//
+// Completion rings. liburing is not available everywhere we build, so the ring is driven through
+// the raw system calls. Only the thread that owns a ring queues on it and reaps from it, so the
+// only ordering needed is with the kernel on the other side of the shared queues.
+//
+#ifdef IORING_ACCEPT_MULTISHOT
+// The message handed to the kernel for RO_RECEIVE_FROM and RO_SEND_TO, laid out in the header
+// space the caller keeps alive for the operation
+struct RingMessage
 {
-	return event.initialised;
+	msghdr message;
+	iovec vector;
+	sockaddr_in address;
+};
+
+static NATIVE_RING emptyRing()
+{
+	NATIVE_RING ring;
+	::memset( &ring, 0, sizeof(ring) );
+	ring.descriptor = -1;
+	return ring;
 }
 
-bool Platform::signalEvent( NATIVE_EVENT& event )
+NATIVE_RING Platform::createUninitialisedRing()
 {
-	bool signaled = false;
+	return emptyRing();
+}
 
-	assert( event.initialised );
-	if( event.initialised )
-	{
-		::pthread_mutex_lock( &event.mutex );
-		event.state = true;
-		signaled = true;
+bool Platform::initialiseRing( NATIVE_RING& ring, unsigned int entries )
+{
+	assert( !Platform::isRingInitialised(ring) );
 
-		std::list<EventListener*>::iterator listenerIterator = event.listenerList.begin();
-		while( listenerIterator != event.listenerList.end() )
-		{
-			EventListener* listener = *listenerIterator;
-			::pthread_mutex_lock( &listener->mutex );
-			::pthread_cond_broadcast( &listener->condition );
-			::pthread_mutex_unlock( &listener->mutex );
+	io_uring_params parameters;
+	::memset( &parameters, 0, sizeof(parameters) );
+	int descriptor = (int)::syscall( __NR_io_uring_setup, entries, &parameters );
+	if( descriptor < 0 )
+		return false;
 
-			++listenerIterator;
-		}
+	// Kernels that could drop completions, or that cannot time out a wait, are treated as
+	// having no ring at all (both arrived by 5.11)
+	const unsigned int REQUIRED = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+	if( (parameters.features & REQUIRED) != REQUIRED )
+	{
+		::close( descriptor );
+		return false;
+	}
 
-		::pthread_mutex_unlock( &event.mutex );
+	// Both queues share one mapping, with the submission entries in another
+	size_t submitSize = parameters.sq_off.array + parameters.sq_entries * sizeof(unsigned int);
+	size_t completeSize = parameters.cq_off.cqes + parameters.cq_entries * sizeof(io_uring_cqe);
+	size_t ringSize = std::max( submitSize, completeSize );
+	void* ringMemory = ::mmap( NULL,
+	                           ringSize,
+	                           PROT_READ | PROT_WRITE,
+	                           MAP_SHARED | MAP_POPULATE,
+	                           descriptor,
+	                           IORING_OFF_SQ_RING );
+	if( ringMemory == MAP_FAILED )
+	{
+		::close( descriptor );
+		return false;
 	}
 
-	return signaled;
+	size_t entrySize = parameters.sq_entries * sizeof(io_uring_sqe);
+	void* entryMemory = ::mmap( NULL,
+	                            entrySize,
+	                            PROT_READ | PROT_WRITE,
+	                            MAP_SHARED | MAP_POPULATE,
+	                            descriptor,
+	                            IORING_OFF_SQES );
+	if( entryMemory == MAP_FAILED )
+	{
+		::munmap( ringMemory, ringSize );
+		::close( descriptor );
+		return false;
+	}
+
+	char* base = (char*)ringMemory;
+	ring.descriptor = descriptor;
+	ring.entries = parameters.sq_entries;
+	ring.submitHead = (unsigned int*)(base + parameters.sq_off.head);
+	ring.submitTail = (unsigned int*)(base + parameters.sq_off.tail);
+	ring.submitArray = (unsigned int*)(base + parameters.sq_off.array);
+	ring.submitMask = *(unsigned int*)(base + parameters.sq_off.ring_mask);
+	ring.submitEntries = entryMemory;
+	ring.completeHead = (unsigned int*)(base + parameters.cq_off.head);
+	ring.completeTail = (unsigned int*)(base + parameters.cq_off.tail);
+	ring.completeMask = *(unsigned int*)(base + parameters.cq_off.ring_mask);
+	ring.completeEntries = base + parameters.cq_off.cqes;
+	ring.ringMemory = ringMemory;
+	ring.ringSize = ringSize;
+	ring.entryMemory = entryMemory;
+	ring.entrySize = entrySize;
+	return true;
 }
 
-void Platform::clearEvent( NATIVE_EVENT& event )
+bool Platform::isRingInitialised( const NATIVE_RING& ring )
 {
-	assert( event.initialised );
+	return ring.descriptor != -1;
+}
+
+void Platform::destroyRing( NATIVE_RING& ring )
+{
+	if( !Platform::isRingInitialised(ring) )
+		return;
 
-	::pthread_mutex_lock( &event.mutex );
-	event.state = false;
-	::pthread_mutex_unlock( &event.mutex );
+	// Closing the descriptor cancels anything still in flight
+	::munmap( ring.entryMemory, ring.entrySize );
+	::munmap( ring.ringMemory, ring.ringSize );
+	::close( ring.descriptor );
+	ring = emptyRing();
 }
 
-WaitResult Platform::waitOnEvent( NATIVE_EVENT& event, unsigned long timeout )
+bool Platform::registerRingBuffers( NATIVE_RING& ring,
+                                    char* base,
+                                    size_t bufferSize,
+                                    unsigned int count )
 {
-	if( !event.initialised )
-		return WR_ABANDONED;
+	std::vector<iovec> vectors( count );
+	for( unsigned int i = 0; i < count; ++i )
+	{
+		vectors[i].iov_base = base + i * bufferSize;
+		vectors[i].iov_len = bufferSize;
+	}
 
-	bool eventInitiallySignaled = false;
-	timeval time;
-	timespec timeoutSpec;
-	int nativeWaitResult = -1;
-	WaitResult result = WR_FAILED;
+	// Only one set can be registered at a time
+	::syscall( __NR_io_uring_register, ring.descriptor, IORING_UNREGISTER_BUFFERS, NULL, 0 );
+	return ::syscall( __NR_io_uring_register,
+	                  ring.descriptor,
+	                  IORING_REGISTER_BUFFERS,
+	                  count ? &vectors[0] : NULL,
+	                  count ) == 0;
+}
 
-	// Lock the event object so that changes can be made to it while we modify the listener list
-	::pthread_mutex_lock( &event.mutex );
+bool Platform::queueRingOperation( NATIVE_RING& ring, const RingOperation& operation )
+{
+	unsigned int tail = *ring.submitTail;
+	unsigned int head = __atomic_load_n( ring.submitHead, __ATOMIC_ACQUIRE );
+	if( tail - head >= ring.entries )
+		return false;
 
-	// Initialise an EventListener instance for this thread
-	EventListener listener;
-	::pthread_mutex_init( &listener.mutex, NULL );
-	::pthread_cond_init( &listener.condition, NULL );
+	unsigned int index = tail & ring.submitMask;
+	io_uring_sqe* entry = (io_uring_sqe*)ring.submitEntries + index;
+	::memset( entry, 0, sizeof(io_uring_sqe) );
+	entry->fd = operation.socket;
+	entry->user_data = (uint64_t)(uintptr_t)operation.context;
 
-	// Add this thread to the listener list, and do an initial check to see if it has been signaled
-	event.listenerList.push_back( &listener );
-	if( event.state )
+	switch( operation.type )
 	{
-		eventInitiallySignaled = true;
-	}
+		case RO_ACCEPT:
+			entry->opcode = IORING_OP_ACCEPT;
+			entry->accept_flags = SOCK_CLOEXEC;
+			if( operation.multishot )
+				entry->ioprio |= IORING_ACCEPT_MULTISHOT;
+			break;
 
-	// Event has not been signaled yet, so wait for it
-	if( !eventInitiallySignaled )
-	{
-		::pthread_mutex_lock( &listener.mutex );
-		if( timeout != NATIVE_INFINITE_WAIT )
+		case RO_RECEIVE:
+		case RO_SEND:
+			entry->opcode = operation.type == RO_RECEIVE ? IORING_OP_RECV : IORING_OP_SEND;
+			entry->msg_flags = operation.type == RO_SEND ? NATIVE_SOCKET_SEND_FLAGS : 0;
+			entry->addr = (uint64_t)(uintptr_t)operation.buffer;
+			entry->len = operation.length;
+			break;
+
+		case RO_READ:
+			entry->opcode = IORING_OP_READ;
+			entry->addr = (uint64_t)(uintptr_t)operation.buffer;
+			entry->len = operation.length;
+			entry->off = (uint64_t)-1;
+			break;
+
+		case RO_READ_FIXED:
+		case RO_WRITE_FIXED:
+			// Sockets have no position, so the offset is the current one
+			entry->opcode = operation.type == RO_READ_FIXED ? IORING_OP_READ_FIXED :
+			                                                  IORING_OP_WRITE_FIXED;
+			entry->addr = (uint64_t)(uintptr_t)operation.buffer;
+			entry->len = operation.length;
+			entry->off = (uint64_t)-1;
+			entry->buf_index = operation.bufferIndex;
+			break;
+
+		case RO_RECEIVE_FROM:
+		case RO_SEND_TO:
 		{
-			::gettimeofday( &time, NULL );
-			timeoutSpec.tv_nsec = time.tv_usec * 1000 + ((long)timeout) * 1000000L;
-			timeoutSpec.tv_sec = time.tv_sec;
-			// If the wait is over 1 second, then increase the second count
-			if( timeoutSpec.tv_nsec >= 1000000000L )
+			assert( sizeof(RingMessage) <= RingOperation::HEADER_SIZE );
+			RingMessage* message = (RingMessage*)operation.header;
+			::memset( message, 0, sizeof(RingMessage) );
+			message->vector.iov_base = operation.buffer;
+			message->vector.iov_len = operation.length;
+			message->message.msg_iov = &message->vector;
+			message->message.msg_iovlen = 1;
+			message->message.msg_name = &message->address;
+			message->message.msg_namelen = sizeof(sockaddr_in);
+			if( operation.type == RO_SEND_TO )
 			{
-				timeoutSpec.tv_sec += timeoutSpec.tv_nsec / 1000000000L;
-				timeoutSpec.tv_nsec %= 1000000000L;
+				message->address.sin_family = AF_INET;
+				message->address.sin_addr.s_addr = htonl( operation.address );
+				message->address.sin_port = htons( operation.port );
 			}
-		}
 
-		// Unlock the event mutex and wait for the signal
-		::pthread_mutex_unlock( &event.mutex );
-		if( timeout == NATIVE_INFINITE_WAIT )
-		{
-			nativeWaitResult = ::pthread_cond_wait( &listener.condition, &listener.mutex );
+			entry->opcode = operation.type == RO_SEND_TO ? IORING_OP_SENDMSG : IORING_OP_RECVMSG;
+			entry->msg_flags = operation.type == RO_SEND_TO ? NATIVE_SOCKET_SEND_FLAGS : 0;
+			entry->addr = (uint64_t)(uintptr_t)&message->message;
+			entry->len = 1;
+			break;
 		}
-		else
+
+		case RO_PROVIDE_BUFFERS:
+			entry->opcode = IORING_OP_PROVIDE_BUFFERS;
+			entry->fd = (int)operation.count;
+			entry->addr = (uint64_t)(uintptr_t)operation.buffer;
+			entry->len = operation.length;
+			entry->off = operation.bufferId;
+			entry->buf_group = operation.bufferIndex;
+			break;
+
+		case RO_CANCEL:
+			entry->opcode = IORING_OP_ASYNC_CANCEL;
+			entry->fd = -1;
+			entry->addr = (uint64_t)(uintptr_t)operation.context;
+			entry->user_data = 0;
+			break;
+	}
+
+	if( operation.selectBuffer )
+	{
+		// The kernel picks a buffer from the group once there is data, so none is given here
+		entry->flags |= IOSQE_BUFFER_SELECT;
+		entry->buf_group = operation.bufferIndex;
+		entry->addr = 0;
+		if( operation.multishot )
 		{
-			nativeWaitResult = ::pthread_cond_timedwait( &listener.condition,
-														 &listener.mutex,
-														 &timeoutSpec );
+			entry->ioprio |= IORING_RECV_MULTISHOT;
+			entry->len = 0;
 		}
-
-		// Translate the native wait result
-		if( nativeWaitResult == ETIMEDOUT )
-			result = WR_TIMEOUT;
-
-		// Unlock listener
-		::pthread_mutex_unlock( &listener.mutex );
-
-		// Relock event
-		::pthread_mutex_lock( &event.mutex );
 	}
 
-	event.listenerList.remove( &listener );
-	if( event.listenerList.size() == 0 )
-		::pthread_cond_broadcast( &event.noMoreListenersEvent );
+	ring.submitArray[index] = index;
+	__atomic_store_n( ring.submitTail, tail + 1, __ATOMIC_RELEASE );
+	return true;
+}
+
+int Platform::submitRing( NATIVE_RING& ring, bool wait, unsigned long timeout )
+{
+	unsigned int queued = *ring.submitTail - __atomic_load_n( ring.submitHead, __ATOMIC_ACQUIRE );
+	if( queued == 0 && !wait )
+		return 0;
 
-	if( eventInitiallySignaled )
+	unsigned int flags = 0;
+	unsigned int waitFor = 0;
+	if( wait )
 	{
-		result = WR_SUCCEEDED;
+		flags |= IORING_ENTER_GETEVENTS;
+		waitFor = 1;
 	}
-	else
+
+	io_uring_getevents_arg argument;
+	timespec interval;
+	void* extra = NULL;
+	size_t extraSize = 0;
+	if( wait && timeout != NATIVE_INFINITE_WAIT )
 	{
-		if( result != WR_TIMEOUT )
-		{
-			if( event.state )
-				result = WR_SUCCEEDED;
-			else
-				result = WR_ABANDONED;
-		}
+		interval.tv_sec = timeout / 1000;
+		interval.tv_nsec = (timeout % 1000) * 1000000;
+		::memset( &argument, 0, sizeof(argument) );
+		argument.ts = (uint64_t)(uintptr_t)&interval;
+		flags |= IORING_ENTER_EXT_ARG;
+		extra = &argument;
+		extraSize = sizeof(argument);
 	}
 
-	// Unlock event
-	::pthread_mutex_unlock( &event.mutex );
-
-	// Clean up the listener
-	::pthread_mutex_destroy( &listener.mutex );
-	::pthread_cond_destroy( &listener.condition );
+	// The kernel takes everything queued before it starts waiting, so a timeout or a signal
+	// still leaves the operations submitted
+	int result = (int)::syscall( __NR_io_uring_enter,
+	                             ring.descriptor,
+	                             queued,
+	                             waitFor,
+	                             flags,
+	                             extra,
+	                             extraSize );
+	if( result < 0 && (errno == ETIME || errno == EINTR || errno == EBUSY) )
+		return (int)(queued - (*ring.submitTail - __atomic_load_n(ring.submitHead, __ATOMIC_ACQUIRE)));
 
 	return result;
 }
 
-bool Platform::destroyEvent( NATIVE_EVENT& event )
+size_t Platform::reapRing( NATIVE_RING& ring, RingCompletion* completions, size_t maxCompletions )
 {
-	bool destroyed = false;
-	if( event.initialised )
+	unsigned int head = *ring.completeHead;
+	unsigned int tail = __atomic_load_n( ring.completeTail, __ATOMIC_ACQUIRE );
+	size_t count = 0;
+	while( head != tail && count < maxCompletions )
 	{
-		event.initialised = false;
-
-		::pthread_mutex_lock( &event.mutex );
-		if( event.listenerList.size() > 0 )
-		{
-			std::list<EventListener*>::iterator listenerIterator = event.listenerList.begin();
-			while( listenerIterator != event.listenerList.end() )
-			{
-				EventListener* listener = *listenerIterator;
-				::pthread_mutex_lock( &listener->mutex );
-				::pthread_cond_broadcast( &listener->condition );
-				::pthread_mutex_unlock( &listener->mutex );
-
-				++listenerIterator;
-			}
-
-			::pthread_cond_wait( &event.noMoreListenersEvent, &event.mutex );
-		}
-		::pthread_mutex_unlock( &event.mutex );
-		::pthread_mutex_destroy( &event.mutex );
+		io_uring_cqe* entry = (io_uring_cqe*)ring.completeEntries + (head & ring.completeMask);
+		RingCompletion& completion = completions[count++];
+		completion.context = (void*)(uintptr_t)entry->user_data;
+		completion.result = entry->res;
+		completion.more = (entry->flags & IORING_CQE_F_MORE) != 0;
+		completion.bufferId = (entry->flags & IORING_CQE_F_BUFFER) ?
+		                      (int)(entry->flags >> IORING_CQE_BUFFER_SHIFT) : -1;
+		++head;
 	}
 
-	return destroyed;
+	// Hands the slots back to the kernel
+	__atomic_store_n( ring.completeHead, head, __ATOMIC_RELEASE );
+	return count;
 }
 
-bool Platform::initialiseSocketFramework()
+void Platform::getRingSender( const void* header, NATIVE_IP_ADDRESS& address, unsigned short& port )
 {
-	// Nothing to do on Posix
-	return true;
+	const RingMessage* message = (const RingMessage*)header;
+	address = ntohl( message->address.sin_addr.s_addr );
+	port = ntohs( message->address.sin_port );
 }
-
-void Platform::cleanupSocketFramework()
+#else
+NATIVE_RING Platform::createUninitialisedRing()
 {
-	// Nothing to do on Posix
+	NATIVE_RING ring;
+	ring.descriptor = -1;
+	return ring;
 }
 
-void Platform::setMulticastSocketOptions( NATIVE_SOCKET& socket )
+bool Platform::initialiseRing( NATIVE_RING& ring, unsigned int entries )
 {
-	// Set SO_REUSEADDR so that other processes can bind to it
-	int intTrue = 1;
-	::setsockopt( socket,
-				  SOL_SOCKET, 
-				  SO_REUSEADDR, 
-				  (char*)&intTrue,
-				  sizeof(intTrue) );
-
-#ifdef __APPLE__
-	// MacOSX also requires us to set SO_REUSEPORT
-	::setsockopt( socket,
-				  SOL_SOCKET,
-				  SO_REUSEPORT,
-				  (char*)&intTrue,
-				  sizeof(intTrue) );
-#endif
+	return false;
 }
 
-NATIVE_IP_ADDRESS Platform::lookupHost( const tchar* hostName )
+bool Platform::isRingInitialised( const NATIVE_RING& ring )
 {
-	NATIVE_IP_ADDRESS result = INADDR_NONE;
-
-	std::string narrowHostName = Platform::toAnsiString( hostName );
-	if( !narrowHostName.empty() )
-	{
-		const char* narrowHostNameCStr = narrowHostName.c_str();
-
-		hostent* hostEntry = ::gethostbyname( narrowHostNameCStr );
-		if ( hostEntry != NULL )
-			result = ntohl( *((NATIVE_IP_ADDRESS*)hostEntry->h_addr) );
-	}
-
-	return result;
-
+	return ring.descriptor != -1;
 }
 
-#include <arpa/inet.h>
-
-int Platform::lookupHostName( NATIVE_IP_ADDRESS address,
-							  int addressType,
-							  tchar* outBuffer,
-							  int outBufferSize )
+void Platform::destroyRing( NATIVE_RING& ring )
 {
-	int returnSize = 0;
-
-	in_addr addressRequest;
-	addressRequest.s_addr = htonl( address );
-	hostent* host = ::gethostbyaddr( (const char*)&addressRequest,
-									 sizeof(in_addr),
-									 addressType );
-	if( host )
-	{
-		const char* name = host->h_name;
-		returnSize = Platform::toPlatformChars( name, strlen(name), outBuffer, outBufferSize );
-	}
 
-	return returnSize;
 }
 
-int Platform::getHostAddress( NATIVE_IP_ADDRESS address,
-							  int addressType,
-							  tchar* outBuffer,
-							  int outBufferSize )
+bool Platform::registerRingBuffers( NATIVE_RING& ring,
+                                    char* base,
+                                    size_t bufferSize,
+                                    unsigned int count )
 {
-	int returnSize = 0;
-
-	in_addr addressRequest;
-	addressRequest.s_addr = htonl( address );
-	char* ansiAddress = ::inet_ntoa( addressRequest );
-
-	if( ansiAddress )
-	{
-		returnSize = Platform::toPlatformChars( ansiAddress,
-												strlen(ansiAddress),
-												outBuffer,
-												outBufferSize );
-	}
-
-	return returnSize;
+	return false;
 }
 
-int Platform::setNonBlockingMode( NATIVE_SOCKET socket, bool enable )
+bool Platform::queueRingOperation( NATIVE_RING& ring, const RingOperation& operation )
 {
-	long mode = ::fcntl( socket, F_GETFL, NULL );
-	if( enable )
-		mode |= O_NONBLOCK;
-	else
-		mode &= ~O_NONBLOCK;
-
-	return ::fcntl( socket, F_SETFL, mode );
-		
+	return false;
 }
 
-const int Platform::closeSocket( NATIVE_SOCKET socket )
+int Platform::submitRing( NATIVE_RING& ring, bool wait, unsigned long timeout )
 {
-	return ::close( socket );
+	return -1;
 }
 
-const tchar* Platform::describeLastSocketError()
+size_t Platform::reapRing( NATIVE_RING& ring, RingCompletion* completions, size_t maxCompletions )
 {
-	const tchar* error = TEXT("Unknown Error");
-
-	switch( errno )
-	{
-		case EADDRINUSE:
-			error = TEXT("Address already in use");
-			break;
-		case EADDRNOTAVAIL:
-			error = TEXT("Address not available");
-			break;
-		case EAFNOSUPPORT:
-			error = TEXT("Address family not supported");
-			break;
-		case EAGAIN:
-			error = TEXT("Resource temporarily unavailable");
-			break;
-		case EALREADY:
-			error = TEXT("Connection already in progress");
-			break;
-		case EBADF:
-			error = TEXT("Bad file descriptor");
-			break;
-		case EBUSY:
-			error = TEXT("Device or resource busy");
-			break;
-		case ECONNABORTED:
-			error = TEXT("Connection aborted");
-			break;
-		case ECONNREFUSED:
-			error = TEXT("Connection refused");
-			break;
-		case ECONNRESET:
-			error = TEXT("Connection reset");
-			break;
-		case EFAULT:
-			error = TEXT("Bad address");
-			break;
-		case EHOSTDOWN:
-			error = TEXT("Host is down");
-			break;
-		case EHOSTUNREACH:
-			error = TEXT("Host is unreachable");
-			break;
-		case EINVAL:
-			error = TEXT("Invalid argument");
-			break;
-		case EISCONN:
-			error = TEXT("Socket is connected");
-			break;
-		case ENETDOWN:
-			error = TEXT("Network is down");
-			break;
-		case ENETRESET:
-			error = TEXT("Connection aborted by network");
-			break;
-		case ENETUNREACH:
-			error = TEXT("Network unreachable");
-			break;
-		case ENOPROTOOPT:
-			error = TEXT("Protocol is not available");
-			break;
-		case ENOTCONN:
-			error = TEXT("The socket is not connected");
-			break;
-		case ENOTSOCK:
-			error = TEXT("Not a socket");
-			break;
-		case EPFNOSUPPORT:
-			error = TEXT("Protocol not supported");
-			break;
-		case EPROTO:
-			error = TEXT("Protocol error");
-			break;
-		case EPROTONOSUPPORT:
-			error = TEXT("Protocol not supported");
-			break;
-		case EPROTOTYPE:
-			error = TEXT("Protocol wrong type for socket");
-			break;
-		case ESHUTDOWN:
-			error = TEXT("Cannot send after transport endpoint shutdown");
-			break;
-		case ESOCKTNOSUPPORT:
-			error = TEXT("Socket type not supported");
-			break;
-	}
+	return 0;
+}
 
-	return error;
+void Platform::getRingSender( const void* header, NATIVE_IP_ADDRESS& address, unsigned short& port )
+{
+	address = 0;
+	port = 0;
 }
+#endif
 
-bool Platform::isLastSocketErrorSocketConnecting()
+bool Platform::getPeerAddress( NATIVE_SOCKET socket, NATIVE_IP_ADDRESS& address, unsigned short& port )
 {
-	return errno == EINPROGRESS;
+	sockaddr_in peer;
+	NATIVE_SOCKET_LEN length = sizeof(peer);
+	if( ::getpeername(socket, (sockaddr*)&peer, &length) != 0 || peer.sin_family != AF_INET )
+		return false;
+
+	address = ntohl( peer.sin_addr.s_addr );
+	port = ntohs( peer.sin_port );
+	return true;
 }
 
 std::set<NATIVE_IP_ADDRESS> Platform::getAvailableNetworkInterfaceAddresses()
@@ -1909,6 +5187,26 @@ bool Platform::fileExists( const tchar* fileName )
 	return result == 0;
 }
 
+NATIVE_FILE Platform::openFile( const tchar* fileName )
+{
+	std::string ansiName = Platform::toAnsiString( fileName );
+	return ::open( ansiName.c_str(), O_RDONLY | O_CLOEXEC );
+}
+
+void Platform::closeFile( NATIVE_FILE file )
+{
+	::close( file );
+}
+
+long long Platform::getFileSize( NATIVE_FILE file )
+{
+	struct stat status;
+	if( ::fstat(file, &status) != 0 || !S_ISREG(status.st_mode) )
+		return -1;
+
+	return (long long)status.st_size;
+}
+
 String Platform::getCurrentDirectoryString()
 {
 	char ansiPath[PATH_MAX + 1];
@@ -1926,6 +5224,90 @@ unsigned long Platform::getCurrentTimeMilliseconds()
 	return (time.tv_sec * 1000) + (time.tv_usec / 1000L);
 }
 
+#if defined(SYSCOMMON_USE_TSC) && defined(__x86_64__)
+/**
+ * Maps TSC readings onto the CLOCK_MONOTONIC timeline
+ */
+struct TscCalibration
+{
+	bool usable;
+	unsigned long long baseTicks;
+	long long baseNanos;
+	unsigned long long nanosPerTick;    // 32.32 fixed point
+};
+
+static long long readMonotonicNanos()
+{
+	timespec now;
+	::clock_gettime( CLOCK_MONOTONIC, &now );
+	return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * Reads the monotonic clock along with the TSC value at the midpoint of the read, so that the
+ * cost of clock_gettime() does not skew the calibration
+ */
+static long long readMonotonicNanos( unsigned long long& ticks )
+{
+	unsigned long long before = __rdtsc();
+	long long nanos = readMonotonicNanos();
+	unsigned long long after = __rdtsc();
+
+	ticks = before + (after - before) / 2;
+	return nanos;
+}
+
+static TscCalibration calibrateTsc()
+{
+	TscCalibration calibration;
+	calibration.usable = false;
+
+	// Only an invariant TSC ticks at a constant rate through frequency and power state changes
+	unsigned int eax, ebx, ecx, edx;
+	if( !__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1 << 8)) )
+		return calibration;
+
+	// Measure the tick rate against the monotonic clock. Calibrating for longer would be more
+	// accurate, but this runs on the first call to nanoTime()
+	unsigned long long startTicks;
+	long long startNanos = readMonotonicNanos( startTicks );
+	unsigned long long endTicks;
+	long long endNanos;
+	do
+	{
+		endNanos = readMonotonicNanos( endTicks );
+	}
+	while( endNanos - startNanos < 10000000LL );
+
+	if( endTicks > startTicks )
+	{
+		calibration.usable = true;
+		calibration.baseTicks = startTicks;
+		calibration.baseNanos = startNanos;
+		calibration.nanosPerTick = ((unsigned long long)(endNanos - startNanos) << 32) /
+		                           (endTicks - startTicks);
+	}
+
+	return calibration;
+}
+#endif
+
+long long Platform::nanoTime()
+{
+#if defined(SYSCOMMON_USE_TSC) && defined(__x86_64__)
+	static const TscCalibration tsc = calibrateTsc();
+	if( tsc.usable )
+	{
+		unsigned __int128 ticks = __rdtsc() - tsc.baseTicks;
+		return tsc.baseNanos + (long long)((ticks * tsc.nanosPerTick) >> 32);
+	}
+#endif
+
+	timespec now;
+	::clock_gettime( CLOCK_MONOTONIC, &now );
+	return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
 tm* Platform::toLocalTime( const time_t& time )
 {
 	return ::localtime( &time );
@@ -1952,13 +5334,19 @@ void* Platform::threadEntry( void* argument )
 {
 	ThreadEntryData* data = (ThreadEntryData*)argument;
 	WrappedThread* nativeThread = data->nativeThread;
-	void* threadArgument = data->argument;
-	::free( data );
 
 	// Wait for the resume event to be signaled, and then start the execution
 	Platform::waitOnEvent( nativeThread->resumeEvent, NATIVE_INFINITE_WAIT );
 	Platform::clearEvent( nativeThread->resumeEvent );
-	Thread::threadEntry( threadArgument );
+
+	ThreadEntryData entryData = *data;
+	::free( data );
+
+	if( !entryData.abandoned )
+	{
+		applyThreadPreferences( entryData.niceValue, entryData.numaNode );
+		Thread::threadEntry( entryData.argument );
+	}
 
 	return NULL;
 }
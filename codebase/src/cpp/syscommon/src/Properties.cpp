@@ -48,11 +48,29 @@ Properties::~Properties()
 
 }
 
+Properties& Properties::operator=( const Properties& other )
+{
+	if( this != &other )
+	{
+		std::map<String,String> copy;
+		other.lock.readLock();
+		copy = other.properties;
+		other.lock.readUnlock();
+
+		this->lock.writeLock();
+		this->properties.swap( copy );
+		this->lock.writeUnlock();
+	}
+
+	return *this;
+}
+
 //----------------------------------------------------------
 //                    INSTANCE METHODS
 //----------------------------------------------------------
 bool Properties::containsKey( const tchar* key ) const
 {
+	ReadLockGuard guard( this->lock );
 	std::map<String,String>::const_iterator found = properties.find( key );
 	return found != properties.end();
 }
@@ -66,6 +84,7 @@ const tchar* Properties::getProperty( const tchar* key, const tchar* defaultValu
 {
 	const tchar* result = defaultValue;
 
+	ReadLockGuard guard( this->lock );
 	std::map<String,String>::const_iterator found = properties.find( key );
 	if( found != properties.end() )
 		result = (*found).second.c_str();
@@ -75,14 +94,23 @@ const tchar* Properties::getProperty( const tchar* key, const tchar* defaultValu
 
 void Properties::setProperty( const tchar* key, const tchar* value )
 {
+	WriteLockGuard guard( this->lock );
 	properties[key] = value;
 }
 
 void Properties::putAll( const Properties& other )
 {
+	// Take a copy first rather than holding both locks at once, which could deadlock against a
+	// putAll() going the other way
+	std::map<String,String> otherProperties;
+	other.lock.readLock();
+	otherProperties = other.properties;
+	other.lock.readUnlock();
+
 	// Iterate over all key/values in other and copy them into our properties
-	std::map<String,String>::const_iterator otherIt = other.properties.begin();
-	while( otherIt != other.properties.end() )
+	WriteLockGuard guard( this->lock );
+	std::map<String,String>::const_iterator otherIt = otherProperties.begin();
+	while( otherIt != otherProperties.end() )
 	{
 		const String& key = (*otherIt).first;
 		const String& value = (*otherIt).second;
@@ -139,7 +167,7 @@ void Properties::loadFromFile( const tchar* filename, Logger* logger )
 						logger->trace( TEXT("Parsed property KEY=[%s], VALUE=[%s]"), key.c_str(), value.c_str() );
 
 					// Set the property
-					properties[key] = value;
+					this->setProperty( key.c_str(), value.c_str() );
 				}
 				else
 				{
@@ -168,6 +196,7 @@ std::set<const tchar*> Properties::getPropertyNames() const
 void Properties::getPropertyNames( std::set<const tchar*>& outNames ) const
 {
 	// Iterate over all entries and populate the provided set with the names
+	ReadLockGuard guard( this->lock );
 	std::map<String,String>::const_iterator propertiesIt = properties.begin();
 	while( propertiesIt != properties.end() )
 	{
@@ -180,5 +209,6 @@ void Properties::getPropertyNames( std::set<const tchar*>& outNames ) const
 
 void Properties::clear()
 {
+	WriteLockGuard guard( this->lock );
 	properties.clear();
 }
@@ -0,0 +1,69 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "syscommon/concurrent/ReadWriteLock.h"
+
+#include <limits.h>
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+ReadWriteLock::ReadWriteLock()
+{
+	Platform::initialiseReadWriteLock( this->nativeLock );
+}
+
+ReadWriteLock::~ReadWriteLock()
+{
+	Platform::destroyReadWriteLock( this->nativeLock );
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+void ReadWriteLock::readLock()
+{
+	Platform::acquireReadLock( this->nativeLock, NATIVE_INFINITE_WAIT );
+}
+
+bool ReadWriteLock::tryReadLock( unsigned long timeoutMillis )
+{
+	return Platform::acquireReadLock( this->nativeLock, timeoutMillis );
+}
+
+void ReadWriteLock::readUnlock()
+{
+	Platform::releaseReadLock( this->nativeLock );
+}
+
+void ReadWriteLock::writeLock()
+{
+	Platform::acquireWriteLock( this->nativeLock, NATIVE_INFINITE_WAIT );
+}
+
+bool ReadWriteLock::tryWriteLock( unsigned long timeoutMillis )
+{
+	return Platform::acquireWriteLock( this->nativeLock, timeoutMillis );
+}
+
+void ReadWriteLock::writeUnlock()
+{
+	Platform::releaseWriteLock( this->nativeLock );
+}
@@ -0,0 +1,606 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "syscommon/concurrent/ScheduledExecutor.h"
+
+#include <limits.h>
+#include "syscommon/util/Deadline.h"
+#include "syscommon/util/StringUtils.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+static const unsigned long long MAX_DELAY_MILLIS = LLONG_MAX / 4000000LL;
+
+// The furthest ahead, in ticks, that the top level of the wheel can place a timer
+static const long long WHEEL_RANGE = 1LL << ( ScheduledExecutor::WHEEL_BITS *
+                                              ScheduledExecutor::WHEEL_LEVELS );
+
+static long long millisToNanos( unsigned long millis )
+{
+	// Anything too long to represent in nanoseconds (a few hundred years) might as well be never
+	if( (unsigned long long)millis > MAX_DELAY_MILLIS )
+		millis = (unsigned long)MAX_DELAY_MILLIS;
+
+	return (long long)millis * 1000000LL;
+}
+
+//----------------------------------------------------------
+//                    STATIC VARIABLES
+//----------------------------------------------------------
+unsigned long ScheduledExecutor::EXECUTOR_ID_COUNTER = 0;
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+ScheduledExecutor::ScheduledExecutor( unsigned int poolSize ) :
+	wheelLock( LP_ADAPTIVE ),
+	tickEvent( false, TEXT("SchedulerTick") ),
+	workAvailableEvent( false, TEXT("SchedulerWorkAvailable") )
+{
+	this->_ScheduledExecutor( poolSize, DEFAULT_TICK_MILLIS );
+}
+
+ScheduledExecutor::ScheduledExecutor( unsigned int poolSize, unsigned long tickMillis ) :
+	wheelLock( LP_ADAPTIVE ),
+	tickEvent( false, TEXT("SchedulerTick") ),
+	workAvailableEvent( false, TEXT("SchedulerWorkAvailable") )
+{
+	this->_ScheduledExecutor( poolSize, tickMillis );
+}
+
+ScheduledExecutor::~ScheduledExecutor()
+{
+	// Delayed tasks may not be due for hours, so rather than waiting for them as an orderly
+	// shutdown would, cancel everything that has not started
+	std::list<IRunnable*> cancelled;
+	this->wheelLock.lock();
+	this->state = ES_STOPPED;
+	this->cancelPending( false, cancelled );
+	this->wheelLock.unlock();
+
+	this->awaitTermination( NATIVE_INFINITE_WAIT );
+
+	std::vector<Thread*>::iterator it = this->workers.begin();
+	for( ; it != this->workers.end(); ++it )
+		delete *it;
+
+	this->workers.clear();
+}
+
+void ScheduledExecutor::_ScheduledExecutor( unsigned int poolSize, unsigned long tickMillis )
+{
+	if( poolSize == 0 )
+		throw IllegalArgumentException( TEXT("Pool size must be greater than zero") );
+	if( tickMillis == 0 )
+		throw IllegalArgumentException( TEXT("Tick length must be greater than zero") );
+
+	this->state = ES_RUNNING;
+	this->epoch = Platform::nanoTime();
+	this->tickNanos = millisToNanos( tickMillis );
+	this->currentTick = 0;
+	this->pendingCount = 0;
+	this->readyCount = 0;
+	this->ticking = false;
+	this->wakeTick = LLONG_MAX;
+	this->activeCount = 0;
+	this->idleCount = 0;
+
+	String namePrefix = TEXT("Scheduler-");
+	namePrefix.append( StringUtils::longToString(EXECUTOR_ID_COUNTER++) );
+	namePrefix.append( TEXT("-Worker-") );
+
+	for( unsigned int i = 0 ; i < poolSize ; ++i )
+	{
+		String workerName = namePrefix + StringUtils::longToString( i );
+		Thread* worker = new Thread( this, workerName.c_str() );
+		this->workers.push_back( worker );
+	}
+
+	// Only start the workers once the vector is complete, as they never touch it
+	std::vector<Thread*>::iterator it = this->workers.begin();
+	for( ; it != this->workers.end(); ++it )
+		(*it)->start();
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+ScheduledFuture* ScheduledExecutor::schedule( IRunnable* task, unsigned long delay )
+{
+	return this->enqueue( task, delay, 0 );
+}
+
+ScheduledFuture* ScheduledExecutor::scheduleAtFixedRate( IRunnable* task,
+														 unsigned long initialDelay,
+														 unsigned long period )
+{
+	if( period == 0 )
+		throw IllegalArgumentException( TEXT("Period must be greater than zero") );
+
+	return this->enqueue( task, initialDelay, millisToNanos(period) );
+}
+
+ScheduledFuture* ScheduledExecutor::scheduleWithFixedDelay( IRunnable* task,
+															unsigned long initialDelay,
+															unsigned long delay )
+{
+	if( delay == 0 )
+		throw IllegalArgumentException( TEXT("Delay must be greater than zero") );
+
+	return this->enqueue( task, initialDelay, -millisToNanos(delay) );
+}
+
+void ScheduledExecutor::shutdown()
+{
+	std::list<IRunnable*> cancelled;
+
+	this->wheelLock.lock();
+	if( this->state == ES_RUNNING )
+	{
+		this->state = ES_SHUTDOWN;
+		this->cancelPending( true, cancelled );
+	}
+	this->wheelLock.unlock();
+}
+
+std::list<IRunnable*> ScheduledExecutor::shutdownNow()
+{
+	std::list<IRunnable*> cancelled;
+
+	this->wheelLock.lock();
+	this->state = ES_STOPPED;
+	this->cancelPending( false, cancelled );
+
+	std::vector<Thread*>::iterator it = this->workers.begin();
+	for( ; it != this->workers.end(); ++it )
+		(*it)->interrupt();
+	this->wheelLock.unlock();
+
+	return cancelled;
+}
+
+bool ScheduledExecutor::awaitTermination( unsigned long timeout )
+{
+	Deadline deadline( timeout );
+
+	std::vector<Thread*>::iterator it = this->workers.begin();
+	for( ; it != this->workers.end(); ++it )
+	{
+		if( !(*it)->join(deadline.getRemainingMillis()) )
+			return false;
+	}
+
+	return true;
+}
+
+bool ScheduledExecutor::isShutdown() const
+{
+	return this->state != ES_RUNNING;
+}
+
+unsigned int ScheduledExecutor::getPoolSize() const
+{
+	return (unsigned int)this->workers.size();
+}
+
+unsigned int ScheduledExecutor::getActiveCount()
+{
+	LockGuard guard( this->wheelLock );
+	return this->activeCount;
+}
+
+size_t ScheduledExecutor::getQueueSize()
+{
+	LockGuard guard( this->wheelLock );
+	return this->pendingCount + this->readyCount;
+}
+
+ScheduledFuture* ScheduledExecutor::enqueue( IRunnable* task,
+											 unsigned long delay,
+											 long long period )
+{
+	this->wheelLock.lock();
+	if( this->state != ES_RUNNING )
+	{
+		this->wheelLock.unlock();
+		throw RejectedExecutionException( TEXT("Executor has been shut down") );
+	}
+
+	long long time = this->elapsedNanos() + millisToNanos( delay );
+	ScheduledFuture* future = new ScheduledFuture( task, this, time, period );
+	this->addTimer( future );
+	this->wheelLock.unlock();
+
+	return future;
+}
+
+void ScheduledExecutor::cancelPending( bool periodicOnly, std::list<IRunnable*>& cancelled )
+{
+	for( unsigned int level = 0 ; level <= WHEEL_LEVELS ; ++level )
+	{
+		// The ready list is treated as one more level, below the bottom of the wheel
+		unsigned int slotCount = level < WHEEL_LEVELS ? WHEEL_SLOTS : 1;
+		for( unsigned int slot = 0 ; slot < slotCount ; ++slot )
+		{
+			TimerNode* list = level < WHEEL_LEVELS ? &this->wheel[level][slot] : &this->readyList;
+			TimerNode* node = list->next;
+			while( node != list )
+			{
+				ScheduledFuture* future = static_cast<ScheduledFuture*>( node );
+				node = node->next;
+				if( periodicOnly && future->period == 0 )
+					continue;
+
+				if( future->state == ScheduledFuture::FS_QUEUED )
+					--this->readyCount;
+				else
+					--this->pendingCount;
+
+				future->unlink();
+				future->state = ScheduledFuture::FS_CANCELLED;
+				future->signalDone();
+				cancelled.push_back( future->task );
+			}
+		}
+	}
+
+	// Wake the workers so that they re-examine the state of the executor
+	this->tickEvent.signal();
+	this->workAvailableEvent.signal();
+}
+
+bool ScheduledExecutor::cancel( ScheduledFuture* future, bool mayInterruptIfRunning )
+{
+	bool cancelled = true;
+
+	this->wheelLock.lock();
+	if( future->state == ScheduledFuture::FS_PENDING )
+	{
+		// The wheel finds due timers by the slot they are in, so nothing else refers to them
+		future->unlink();
+		--this->pendingCount;
+	}
+	else if( future->state == ScheduledFuture::FS_QUEUED )
+	{
+		future->unlink();
+		--this->readyCount;
+	}
+	else if( future->state == ScheduledFuture::FS_RUNNING )
+	{
+		// The worker takes the wheel lock before leaving FS_RUNNING, so the runner is guaranteed
+		// to still be executing this task while we hold it
+		if( mayInterruptIfRunning && future->runner )
+			future->runner->interrupt();
+	}
+	else
+	{
+		cancelled = false;
+	}
+
+	if( cancelled )
+	{
+		future->state = ScheduledFuture::FS_CANCELLED;
+		future->signalDone();
+	}
+	this->wheelLock.unlock();
+
+	return cancelled;
+}
+
+bool ScheduledExecutor::waitForDone( ScheduledFuture* future,
+									 bool waitForRun,
+									 unsigned long timeout )
+{
+	Deadline deadline( timeout );
+	bool done = true;
+
+	this->wheelLock.lock();
+	while( !future->isDone() || (waitForRun && future->running) )
+	{
+		if( deadline.hasExpired() )
+		{
+			done = false;
+			break;
+		}
+
+		if( !future->doneEvent )
+			future->doneEvent = new Event( false, TEXT("ScheduledFutureDone") );
+
+		// The event was signaled when the future was cancelled, but the run it is waiting out
+		// signals it again when it finishes
+		Event* doneEvent = future->doneEvent;
+		if( future->isDone() )
+			doneEvent->clear();
+
+		this->wheelLock.unlock();
+		doneEvent->waitFor( deadline.getRemainingMillis() );
+		this->wheelLock.lock();
+	}
+	this->wheelLock.unlock();
+
+	return done;
+}
+
+long long ScheduledExecutor::elapsedNanos() const
+{
+	return Platform::nanoTime() - this->epoch;
+}
+
+void ScheduledExecutor::addTimer( ScheduledFuture* future )
+{
+	long long tick = this->placeTimer( future );
+	++this->pendingCount;
+
+	// Make sure somebody is awake to run the task when it falls due
+	if( this->ticking )
+	{
+		if( tick < this->wakeTick )
+			this->tickEvent.signal();
+	}
+	else if( this->idleCount > 0 )
+	{
+		this->workAvailableEvent.signal();
+	}
+}
+
+long long ScheduledExecutor::placeTimer( ScheduledFuture* future )
+{
+	// Round up, so that the task does not run before its time
+	long long tick = ( future->time + this->tickNanos - 1 ) / this->tickNanos;
+	if( tick < this->currentTick )
+		tick = this->currentTick;
+
+	long long distance = tick - this->currentTick;
+	long long slotTick = tick;
+	if( distance >= WHEEL_RANGE )
+	{
+		// Park the timer in the furthest slot. It is placed again, using its real time, when
+		// that slot is cascaded.
+		slotTick = this->currentTick + WHEEL_RANGE - 1;
+		distance = WHEEL_RANGE - 1;
+	}
+
+	unsigned int level = 0;
+	while( distance >= (1LL << (WHEEL_BITS * (level + 1))) )
+		++level;
+
+	unsigned int slot = (unsigned int)( (slotTick >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1) );
+	future->state = ScheduledFuture::FS_PENDING;
+	this->wheel[level][slot].append( future );
+
+	return tick;
+}
+
+void ScheduledExecutor::advance()
+{
+	long long nowTick = this->elapsedNanos() / this->tickNanos;
+	while( this->currentTick <= nowTick )
+	{
+		// With nothing in the wheel there is no need to step through the empty slots
+		if( this->pendingCount == 0 )
+		{
+			this->currentTick = nowTick + 1;
+			break;
+		}
+
+		unsigned int slot = (unsigned int)( this->currentTick & (WHEEL_SLOTS - 1) );
+		if( slot == 0 )
+		{
+			// The bottom level has come full circle, so bring the next range of ticks down from
+			// the level above, and so on up while those levels come full circle too
+			for( unsigned int level = 1 ; level < WHEEL_LEVELS ; ++level )
+			{
+				unsigned int levelSlot =
+					(unsigned int)( (this->currentTick >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1) );
+				this->cascade( level, levelSlot );
+				if( levelSlot != 0 )
+					break;
+			}
+		}
+
+		this->cascade( 0, slot );
+		++this->currentTick;
+	}
+}
+
+void ScheduledExecutor::cascade( unsigned int level, unsigned int slot )
+{
+	TimerNode& list = this->wheel[level][slot];
+	while( !list.isEmpty() )
+	{
+		ScheduledFuture* future = static_cast<ScheduledFuture*>( list.next );
+		future->unlink();
+
+		if( level == 0 )
+		{
+			--this->pendingCount;
+			++this->readyCount;
+			future->state = ScheduledFuture::FS_QUEUED;
+			this->readyList.append( future );
+		}
+		else
+		{
+			this->placeTimer( future );
+		}
+	}
+}
+
+long long ScheduledExecutor::findNextTick() const
+{
+	if( this->pendingCount == 0 )
+		return LLONG_MAX;
+
+	// The levels above are cascaded when the bottom level comes full circle
+	unsigned int first = (unsigned int)( this->currentTick & (WHEEL_SLOTS - 1) );
+	if( first == 0 )
+		return this->currentTick;
+
+	for( unsigned int slot = first ; slot < WHEEL_SLOTS ; ++slot )
+	{
+		if( !this->wheel[0][slot].isEmpty() )
+			return this->currentTick + ( slot - first );
+	}
+
+	return this->currentTick + ( WHEEL_SLOTS - first );
+}
+
+ScheduledFuture* ScheduledExecutor::takeTask( Thread* worker )
+{
+	ScheduledFuture* started = NULL;
+
+	this->wheelLock.lock();
+	while( !started && this->state != ES_STOPPED )
+	{
+		this->advance();
+
+		if( this->readyCount > 0 )
+		{
+			started = static_cast<ScheduledFuture*>( this->readyList.next );
+			started->unlink();
+			--this->readyCount;
+
+			// Discard any interrupt aimed at the previous task before this one can be cancelled
+			Thread::interrupted();
+			started->state = ScheduledFuture::FS_RUNNING;
+			started->running = true;
+			started->runner = worker;
+			++this->activeCount;
+
+			// Wake another worker to run the rest of the ready tasks, or to turn the wheel now
+			// that we are no longer doing so
+			if( this->idleCount > 0 &&
+				(this->readyCount > 0 || (!this->ticking && this->pendingCount > 0)) )
+			{
+				this->workAvailableEvent.signal();
+			}
+		}
+		else if( this->state == ES_SHUTDOWN && this->pendingCount == 0 )
+		{
+			// The last delayed task has run, let the other workers see that too
+			this->tickEvent.signal();
+			this->workAvailableEvent.signal();
+			break;
+		}
+		else if( !this->ticking )
+		{
+			// Turn the wheel until the next tick that has any work in it
+			long long nextTick = this->findNextTick();
+			unsigned long timeout = NATIVE_INFINITE_WAIT;
+			if( nextTick != LLONG_MAX )
+			{
+				long long remaining = nextTick * this->tickNanos - this->elapsedNanos();
+				if( remaining <= 0 )
+					continue;
+
+				timeout = Deadline::fromNanos( remaining ).getRemainingMillis();
+			}
+
+			this->ticking = true;
+			this->wakeTick = nextTick;
+			this->tickEvent.clear();
+			this->wheelLock.unlock();
+			this->tickEvent.waitFor( timeout );
+			this->wheelLock.lock();
+			this->ticking = false;
+		}
+		else
+		{
+			++this->idleCount;
+			this->workAvailableEvent.clear();
+			this->wheelLock.unlock();
+			this->workAvailableEvent.waitFor();
+			this->wheelLock.lock();
+			--this->idleCount;
+		}
+	}
+	this->wheelLock.unlock();
+
+	return started;
+}
+
+void ScheduledExecutor::execute( ScheduledFuture* future )
+{
+	bool failed = false;
+	String failure;
+	try
+	{
+		if( future->task )
+			future->task->run();
+	}
+	catch( std::exception& e )
+	{
+		failure = Platform::toPlatformString( e.what() );
+		failed = true;
+	}
+	catch( ... )
+	{
+		failure = TEXT("Task threw an unknown exception");
+		failed = true;
+	}
+
+	this->wheelLock.lock();
+	--this->activeCount;
+	future->runner = NULL;
+
+	// A task cancelled while running stays cancelled, and is not run again
+	if( future->state == ScheduledFuture::FS_RUNNING )
+	{
+		if( failed )
+		{
+			future->failure = new String( failure );
+			future->state = ScheduledFuture::FS_FAILED;
+		}
+		else if( future->period == 0 )
+		{
+			future->state = ScheduledFuture::FS_COMPLETED;
+		}
+		else if( this->state != ES_RUNNING )
+		{
+			future->state = ScheduledFuture::FS_CANCELLED;
+		}
+		else
+		{
+			if( future->period > 0 )
+				future->time += future->period;
+			else
+				future->time = this->elapsedNanos() - future->period;
+
+			this->addTimer( future );
+		}
+	}
+
+	if( future->isDone() )
+		future->signalDone();
+
+	// This must be the last thing we do with the future, as its owner may delete it as soon as it
+	// is no longer running
+	future->running = false;
+	this->wheelLock.unlock();
+}
+
+void ScheduledExecutor::run()
+{
+	Thread* worker = Thread::currentThread();
+
+	ScheduledFuture* future = this->takeTask( worker );
+	while( future )
+	{
+		this->execute( future );
+		future = this->takeTask( worker );
+	}
+}
@@ -0,0 +1,110 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "syscommon/concurrent/ScheduledFuture.h"
+
+#include <limits.h>
+#include "syscommon/concurrent/ScheduledExecutor.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+ScheduledFuture::ScheduledFuture( IRunnable* task,
+								  ScheduledExecutor* executor,
+								  long long time,
+								  long long period )
+{
+	this->executor = executor;
+	this->task = task;
+	this->time = time;
+	this->period = period;
+	this->state = FS_PENDING;
+	this->running = false;
+	this->runner = NULL;
+	this->doneEvent = NULL;
+	this->failure = NULL;
+}
+
+ScheduledFuture::~ScheduledFuture()
+{
+	// A future that is done and not running is no longer known to the executor, which may
+	// already have been destroyed
+	if( !this->isDone() || this->running )
+	{
+		this->cancel( false );
+		this->executor->waitForDone( this, true, NATIVE_INFINITE_WAIT );
+	}
+
+	delete this->doneEvent;
+	delete this->failure;
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+bool ScheduledFuture::cancel( bool mayInterruptIfRunning )
+{
+	if( this->isDone() )
+		return false;
+
+	return this->executor->cancel( this, mayInterruptIfRunning );
+}
+
+bool ScheduledFuture::isCancelled() const
+{
+	return this->state == FS_CANCELLED;
+}
+
+bool ScheduledFuture::isDone() const
+{
+	FutureState currentState = this->state;
+	return currentState != FS_PENDING && currentState != FS_QUEUED && currentState != FS_RUNNING;
+}
+
+bool ScheduledFuture::isPeriodic() const
+{
+	return this->period != 0;
+}
+
+void ScheduledFuture::get()
+{
+	this->get( NATIVE_INFINITE_WAIT );
+}
+
+bool ScheduledFuture::get( unsigned long timeout )
+{
+	// A task cancelled while running is already done, so there is nothing to wait for
+	if( !this->isDone() && !this->executor->waitForDone(this, false, timeout) )
+		return false;
+
+	FutureState finalState = this->state;
+	if( finalState == FS_CANCELLED )
+		throw CancellationException( TEXT("Task was cancelled") );
+	else if( finalState == FS_FAILED )
+		throw ExecutionException( this->failure->c_str() );
+
+	return true;
+}
+
+void ScheduledFuture::signalDone()
+{
+	if( this->doneEvent )
+		this->doneEvent->signal();
+}
@@ -0,0 +1,301 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "syscommon/net/SelectionKey.h"
+
+#include <limits.h>
+#include <string.h>
+#include "syscommon/net/Selector.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+//----------------------------------------------------------
+//                    STATIC VARIABLES
+//----------------------------------------------------------
+const int SelectionKey::OP_READ;
+const int SelectionKey::OP_WRITE;
+const int SelectionKey::OP_ACCEPT;
+const size_t SelectionKey::DEFAULT_WRITE_QUEUE_LIMIT;
+
+// Sent data is only dropped from the front of the queue once this much has built up, so that a
+// queue that is drained a little at a time is not shuffled along on every send
+static const size_t WRITE_QUEUE_COMPACT_SIZE = 64 * 1024;
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+SelectionKey::SelectionKey( Selector* selector,
+                            NATIVE_SOCKET nativeSocket,
+                            int interestOps,
+                            void* attachment )
+{
+	this->selector = selector;
+	this->nativeSocket = nativeSocket;
+	this->socket = NULL;
+	this->serverSocket = NULL;
+	this->multicastSocket = NULL;
+	this->interestOps = interestOps;
+	this->readyOps = 0;
+	this->edgeTriggered = false;
+	this->valid = true;
+	this->attachment = attachment;
+	this->writeOffset = 0;
+	this->writeQueueLimit = DEFAULT_WRITE_QUEUE_LIMIT;
+	this->registeredEvents = 0;
+	this->registeredEdgeTriggered = false;
+}
+
+SelectionKey::~SelectionKey()
+{
+
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+Selector& SelectionKey::getSelector() const
+{
+	return *this->selector;
+}
+
+Socket* SelectionKey::getSocket() const
+{
+	return this->socket;
+}
+
+ServerSocket* SelectionKey::getServerSocket() const
+{
+	return this->serverSocket;
+}
+
+MulticastSocket* SelectionKey::getMulticastSocket() const
+{
+	return this->multicastSocket;
+}
+
+int SelectionKey::getInterestOps() const
+{
+	return this->interestOps;
+}
+
+void SelectionKey::setInterestOps( int ops )
+{
+	this->checkValid();
+
+	int supported = this->serverSocket ? OP_ACCEPT : OP_READ | OP_WRITE;
+	if( (ops & ~supported) != 0 )
+		throw IllegalArgumentException( TEXT("Operations are not supported by the socket") );
+
+	this->interestOps = ops;
+	this->selector->updateKey( this );
+}
+
+int SelectionKey::getReadyOps() const
+{
+	return this->readyOps;
+}
+
+bool SelectionKey::isReadable() const
+{
+	return (this->readyOps & OP_READ) != 0;
+}
+
+bool SelectionKey::isWritable() const
+{
+	return (this->readyOps & OP_WRITE) != 0;
+}
+
+bool SelectionKey::isAcceptable() const
+{
+	return (this->readyOps & OP_ACCEPT) != 0;
+}
+
+bool SelectionKey::isEdgeTriggered() const
+{
+	return this->edgeTriggered;
+}
+
+void SelectionKey::setEdgeTriggered( bool edgeTriggered )
+{
+	this->checkValid();
+	this->edgeTriggered = edgeTriggered;
+	this->selector->updateKey( this );
+}
+
+void* SelectionKey::getAttachment() const
+{
+	return this->attachment;
+}
+
+void* SelectionKey::attach( void* attachment )
+{
+	void* previous = this->attachment;
+	this->attachment = attachment;
+	return previous;
+}
+
+bool SelectionKey::isValid() const
+{
+	return this->valid;
+}
+
+void SelectionKey::cancel()
+{
+	if( !this->valid )
+		return;
+
+	this->selector->cancelKey( this );
+}
+
+bool SelectionKey::write( const char* buffer, size_t length )
+{
+	this->checkValid();
+	if( !this->socket )
+		throw IllegalStateException( TEXT("Only keys for connected sockets have a write queue") );
+
+	size_t queued = this->getQueuedBytes();
+	if( queued > 0 && queued + length > this->writeQueueLimit )
+		return false;
+
+	// Nothing to wait for, so skip the queue
+	size_t sent = 0;
+	while( queued == 0 && sent < length )
+	{
+		size_t chunk = length - sent;
+		if( chunk > (size_t)INT_MAX )
+			chunk = (size_t)INT_MAX;
+
+		int result = this->socket->send( buffer + sent, (int)chunk );
+		if( result <= 0 )
+			break;
+
+		sent += (size_t)result;
+	}
+
+	if( sent < length )
+	{
+		this->writeQueue.insert( this->writeQueue.end(), buffer + sent, buffer + length );
+		if( queued == 0 )
+			this->selector->updateKey( this );
+	}
+
+	return true;
+}
+
+bool SelectionKey::flush()
+{
+	while( this->writeOffset < this->writeQueue.size() )
+	{
+		size_t chunk = this->writeQueue.size() - this->writeOffset;
+		if( chunk > (size_t)INT_MAX )
+			chunk = (size_t)INT_MAX;
+
+		int result = this->socket->send( &this->writeQueue[this->writeOffset], (int)chunk );
+		if( result <= 0 )
+			break;
+
+		this->writeOffset += (size_t)result;
+	}
+
+	if( this->writeOffset == this->writeQueue.size() )
+	{
+		this->writeQueue.clear();
+		this->writeOffset = 0;
+		if( this->valid )
+			this->selector->updateKey( this );
+
+		return true;
+	}
+
+	if( this->writeOffset >= WRITE_QUEUE_COMPACT_SIZE &&
+	    this->writeOffset >= this->writeQueue.size() / 2 )
+	{
+		this->writeQueue.erase( this->writeQueue.begin(),
+		                        this->writeQueue.begin() + this->writeOffset );
+		this->writeOffset = 0;
+	}
+
+	return false;
+}
+
+size_t SelectionKey::getQueuedBytes() const
+{
+	return this->writeQueue.size() - this->writeOffset;
+}
+
+size_t SelectionKey::getWriteQueueLimit() const
+{
+	return this->writeQueueLimit;
+}
+
+void SelectionKey::setWriteQueueLimit( size_t limit )
+{
+	this->writeQueueLimit = limit;
+}
+
+int SelectionKey::getPollEvents() const
+{
+	int events = 0;
+	if( this->interestOps & (OP_READ | OP_ACCEPT) )
+		events |= SE_READ;
+	if( (this->interestOps & OP_WRITE) || this->getQueuedBytes() > 0 )
+		events |= SE_WRITE;
+
+	return events;
+}
+
+void SelectionKey::setReady( int events )
+{
+	int ready = 0;
+	if( events & SE_READ )
+		ready |= this->interestOps & (OP_READ | OP_ACCEPT);
+
+	if( (events & (SE_WRITE | SE_ERROR)) && this->getQueuedBytes() > 0 )
+	{
+		try
+		{
+			this->flush();
+		}
+		catch( SocketException& )
+		{
+			// The connection has failed. Drop what we could not send and select the key, so
+			// that the application finds out from its own next operation.
+			this->writeQueue.clear();
+			this->writeOffset = 0;
+			this->selector->updateKey( this );
+			events |= SE_ERROR;
+		}
+	}
+
+	// Writable means that the application may write again, which it may not while its earlier
+	// writes are still queued
+	if( (events & SE_WRITE) && this->getQueuedBytes() == 0 )
+		ready |= this->interestOps & OP_WRITE;
+
+	// An error is reported through whichever operation the application tries next
+	if( events & SE_ERROR )
+		ready |= this->interestOps;
+
+	this->readyOps = ready;
+}
+
+void SelectionKey::checkValid() const
+{
+	if( !this->valid )
+		throw IllegalStateException( TEXT("Selection key has been cancelled") );
+}
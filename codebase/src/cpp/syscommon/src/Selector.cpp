@@ -0,0 +1,337 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "syscommon/net/Selector.h"
+
+#include <limits.h>
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+//----------------------------------------------------------
+//                    STATIC VARIABLES
+//----------------------------------------------------------
+const size_t Selector::MAX_SELECTED_KEYS;
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+Selector::Selector()
+{
+	// Uninitialised in ~Selector
+	Platform::initialiseSocketFramework();
+
+	this->open = false;
+	this->wakeupSocket = Platform::createWakeupSocket();
+	if( this->wakeupSocket == NATIVE_SOCKET_UNINIT )
+	{
+		Platform::cleanupSocketFramework();
+		throw IOException( Platform::describeLastSocketError() );
+	}
+
+	// Without a readiness queue every select() polls the registered sockets instead
+	this->poller = Platform::createPoller();
+	if( this->poller != NATIVE_POLLER_UNINIT &&
+	    !Platform::addToPoller(this->poller, this->wakeupSocket, SE_READ, false, NULL) )
+	{
+		Platform::closePoller( this->poller );
+		this->poller = NATIVE_POLLER_UNINIT;
+	}
+
+	this->events.resize( MAX_SELECTED_KEYS );
+	this->open = true;
+}
+
+Selector::~Selector()
+{
+	this->close();
+
+	// Initialised in Selector()
+	Platform::cleanupSocketFramework();
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+SelectionKey* Selector::registerSocket( Socket* socket, int ops, void* attachment )
+{
+	this->checkOpen();
+	if( socket->isClosed() )
+		throw SocketException( TEXT("Socket is closed") );
+	if( !socket->isConnected() )
+		throw SocketException( TEXT("Socket is not connected") );
+	if( (ops & ~(SelectionKey::OP_READ | SelectionKey::OP_WRITE)) != 0 )
+		throw IllegalArgumentException( TEXT("Sockets only support OP_READ and OP_WRITE") );
+
+	SelectionKey* key = new SelectionKey( this, socket->nativeSocket, ops, attachment );
+	key->socket = socket;
+	return this->registerKey( key );
+}
+
+SelectionKey* Selector::registerSocket( ServerSocket* socket, int ops, void* attachment )
+{
+	this->checkOpen();
+	if( socket->isClosed() )
+		throw SocketException( TEXT("Socket is closed") );
+	if( (ops & ~SelectionKey::OP_ACCEPT) != 0 )
+		throw IllegalArgumentException( TEXT("Server sockets only support OP_ACCEPT") );
+
+	SelectionKey* key = new SelectionKey( this, socket->getImpl(), ops, attachment );
+	key->serverSocket = socket;
+	return this->registerKey( key );
+}
+
+SelectionKey* Selector::registerSocket( MulticastSocket* socket, int ops, void* attachment )
+{
+	this->checkOpen();
+	if( !socket->isCreated() )
+		throw SocketException( TEXT("Socket is closed") );
+	if( (ops & ~(SelectionKey::OP_READ | SelectionKey::OP_WRITE)) != 0 )
+		throw IllegalArgumentException( TEXT("Multicast sockets only support OP_READ and OP_WRITE") );
+
+	SelectionKey* key = new SelectionKey( this, socket->nativeSocket, ops, attachment );
+	key->multicastSocket = socket;
+	return this->registerKey( key );
+}
+
+int Selector::select()
+{
+	return this->doSelect( NATIVE_INFINITE_WAIT );
+}
+
+int Selector::select( unsigned long timeout )
+{
+	return this->doSelect( timeout );
+}
+
+int Selector::selectNow()
+{
+	return this->doSelect( 0 );
+}
+
+const std::vector<SelectionKey*>& Selector::getSelectedKeys() const
+{
+	return this->selectedKeys;
+}
+
+size_t Selector::getKeyCount() const
+{
+	return this->keys.size();
+}
+
+void Selector::wakeup()
+{
+	Platform::signalWakeupSocket( this->wakeupSocket );
+}
+
+void Selector::close()
+{
+	if( !this->open )
+		return;
+
+	std::map<NATIVE_SOCKET,SelectionKey*>::iterator iterator;
+	for( iterator = this->keys.begin(); iterator != this->keys.end(); ++iterator )
+		delete iterator->second;
+
+	for( size_t i = 0; i < this->cancelledKeys.size(); ++i )
+		delete this->cancelledKeys[i];
+
+	this->keys.clear();
+	this->cancelledKeys.clear();
+	this->selectedKeys.clear();
+
+	if( this->poller != NATIVE_POLLER_UNINIT )
+		Platform::closePoller( this->poller );
+
+	Platform::closeSocket( this->wakeupSocket );
+	this->open = false;
+}
+
+bool Selector::isOpen() const
+{
+	return this->open;
+}
+
+SelectionKey* Selector::registerKey( SelectionKey* key )
+{
+	if( this->keys.find(key->nativeSocket) != this->keys.end() )
+	{
+		delete key;
+		throw IllegalArgumentException( TEXT("Socket is already registered with this selector") );
+	}
+
+	try
+	{
+		this->updateKey( key );
+	}
+	catch( SocketException& )
+	{
+		delete key;
+		throw;
+	}
+
+	this->keys[key->nativeSocket] = key;
+	return key;
+}
+
+void Selector::updateKey( SelectionKey* key )
+{
+	if( !key->valid )
+		return;
+
+	int events = key->getPollEvents();
+	if( events == key->registeredEvents &&
+	    (events == 0 || key->edgeTriggered == key->registeredEdgeTriggered) )
+	{
+		return;
+	}
+
+	// Polled keys are picked up by the next select() as they are
+	if( this->poller != NATIVE_POLLER_UNINIT )
+	{
+		// A socket is taken out of the poller while it has no events, as hang-ups are always
+		// reported and would otherwise wake every select() for a socket nobody is watching
+		bool updated = false;
+		if( events == 0 )
+			updated = Platform::removeFromPoller( this->poller, key->nativeSocket );
+		else if( key->registeredEvents == 0 )
+			updated = Platform::addToPoller( this->poller, key->nativeSocket, events, key->edgeTriggered, key );
+		else
+			updated = Platform::modifyInPoller( this->poller, key->nativeSocket, events, key->edgeTriggered, key );
+
+		if( !updated )
+			throw SocketException( Platform::describeLastSocketError() );
+	}
+
+	key->registeredEvents = events;
+	key->registeredEdgeTriggered = key->edgeTriggered;
+}
+
+void Selector::cancelKey( SelectionKey* key )
+{
+	// The socket may already have been closed, which takes it out of the poller anyway
+	if( this->poller != NATIVE_POLLER_UNINIT && key->registeredEvents != 0 )
+		Platform::removeFromPoller( this->poller, key->nativeSocket );
+
+	key->valid = false;
+	key->registeredEvents = 0;
+	key->writeQueue.clear();
+	key->writeOffset = 0;
+
+	this->keys.erase( key->nativeSocket );
+	this->cancelledKeys.push_back( key );
+}
+
+int Selector::doSelect( unsigned long timeout )
+{
+	this->checkOpen();
+
+	// Keys that were not selected this time round are not ready
+	for( size_t i = 0; i < this->selectedKeys.size(); ++i )
+		this->selectedKeys[i]->readyOps = 0;
+
+	this->selectedKeys.clear();
+
+	for( size_t i = 0; i < this->cancelledKeys.size(); ++i )
+		delete this->cancelledKeys[i];
+
+	this->cancelledKeys.clear();
+
+	if( this->poller != NATIVE_POLLER_UNINIT )
+		return this->selectNative( timeout );
+	else
+		return this->selectPolled( timeout );
+}
+
+int Selector::selectNative( unsigned long timeout )
+{
+	int count = Platform::waitOnPoller( this->poller,
+	                                    &this->events[0],
+	                                    this->events.size(),
+	                                    timeout );
+	if( count < 0 )
+		throw IOException( Platform::describeLastSocketError() );
+
+	for( int i = 0; i < count; ++i )
+	{
+		SelectionKey* key = (SelectionKey*)this->events[i].context;
+		if( !key )
+		{
+			Platform::clearWakeupSocket( this->wakeupSocket );
+			continue;
+		}
+
+		key->setReady( this->events[i].ready );
+		if( key->readyOps != 0 )
+			this->selectedKeys.push_back( key );
+	}
+
+	return (int)this->selectedKeys.size();
+}
+
+int Selector::selectPolled( unsigned long timeout )
+{
+	SocketPoll poll;
+	poll.ready = 0;
+
+	this->polls.clear();
+	this->polledKeys.clear();
+
+	poll.socket = this->wakeupSocket;
+	poll.interest = SE_READ;
+	this->polls.push_back( poll );
+
+	std::map<NATIVE_SOCKET,SelectionKey*>::iterator iterator;
+	for( iterator = this->keys.begin(); iterator != this->keys.end(); ++iterator )
+	{
+		SelectionKey* key = iterator->second;
+		poll.socket = key->nativeSocket;
+		poll.interest = key->getPollEvents();
+		if( poll.interest != 0 )
+		{
+			this->polls.push_back( poll );
+			this->polledKeys.push_back( key );
+		}
+	}
+
+	int count = Platform::pollSockets( &this->polls[0], this->polls.size(), timeout );
+	if( count < 0 )
+		throw IOException( Platform::describeLastSocketError() );
+
+	if( this->polls[0].ready )
+		Platform::clearWakeupSocket( this->wakeupSocket );
+
+	for( size_t i = 0; i < this->polledKeys.size(); ++i )
+	{
+		int ready = this->polls[i + 1].ready;
+		if( ready == 0 )
+			continue;
+
+		SelectionKey* key = this->polledKeys[i];
+		key->setReady( ready );
+		if( key->readyOps != 0 )
+			this->selectedKeys.push_back( key );
+	}
+
+	return (int)this->selectedKeys.size();
+}
+
+void Selector::checkOpen() const
+{
+	if( !this->open )
+		throw IllegalStateException( TEXT("Selector is closed") );
+}
@@ -32,6 +32,32 @@ using namespace syscommon;
 //----------------------------------------------------------
 unsigned long Semaphore::SEMAPHORE_ID_COUNTER = 0;
 
+/**
+ * Visitor for acquiring a number of permits at once. Semaphore::visit() can only ask for a single
+ * permit, as the visitor interface has no room for a count.
+ */
+class PermitRequest : public IInterruptable
+{
+	private:
+		NATIVE_SEMAPHORE& nativeSemaphore;
+		unsigned int permits;
+
+	public:
+		PermitRequest( NATIVE_SEMAPHORE& nativeSemaphore, unsigned int permits ) :
+			nativeSemaphore( nativeSemaphore ), permits( permits )
+		{
+
+		}
+
+		virtual WaitResult visit( NATIVE_INTERRUPT& threadInterrupt, unsigned long timeout )
+		{
+			return Platform::waitOnSemaphore( this->nativeSemaphore,
+											  this->permits,
+											  threadInterrupt,
+											  timeout );
+		}
+};
+
 //----------------------------------------------------------
 //                      CONSTRUCTORS
 //----------------------------------------------------------
@@ -63,20 +89,44 @@ void Semaphore::_Semaphore( unsigned int permits, const String& name )
 
 void Semaphore::acquire()
 {
-	this->tryAcquire( NATIVE_INFINITE_WAIT );
+	this->tryAcquire( 1U, NATIVE_INFINITE_WAIT );
+}
+
+void Semaphore::acquire( unsigned int permits )
+{
+	this->tryAcquire( permits, NATIVE_INFINITE_WAIT );
+}
+
+bool Semaphore::tryAcquire()
+{
+	bool acquired = false;
+	if ( this->initialised )
+		acquired = Platform::tryAcquireSemaphore( this->nativeSemaphore, 1 );
+
+	return acquired;
 }
 
 bool Semaphore::tryAcquire( unsigned long timeoutMillis )
+{
+	return this->tryAcquire( 1U, timeoutMillis );
+}
+
+bool Semaphore::tryAcquire( unsigned int permits, unsigned long timeoutMillis )
 {
 	bool acquired = false;
 	if ( this->initialised )
 	{
+		// Uncontended case, which doesn't need to go near the thread at all
+		if( Platform::tryAcquireSemaphore(this->nativeSemaphore, permits) )
+			return true;
+
 		Thread* pCurrentThread = Thread::currentThread();
 
 		assert( pCurrentThread );
 		if ( pCurrentThread )
 		{
-			WaitResult result = pCurrentThread->acceptInterruptable( this, timeoutMillis );
+			PermitRequest request( this->nativeSemaphore, permits );
+			WaitResult result = pCurrentThread->acceptInterruptable( &request, timeoutMillis );
 			if( result == WR_INTERRUPTED )
 				throw InterruptedException( TEXT("Thread Interrupted") );
 			else if( result == WR_SUCCEEDED )
@@ -87,19 +137,33 @@ bool Semaphore::tryAcquire( unsigned long timeoutMillis )
 	return acquired;
 }
 
+unsigned int Semaphore::drainPermits( unsigned int maxPermits )
+{
+	unsigned int acquired = 0;
+	if ( this->initialised )
+		acquired = Platform::drainSemaphore( this->nativeSemaphore, maxPermits );
+
+	return acquired;
+}
+
 bool Semaphore::release()
+{
+	return this->release( 1U );
+}
+
+bool Semaphore::release( unsigned int permits )
 {
 	bool result = false;
 
 	if ( this->initialised )
-		result = Platform::releaseSemaphore( this->nativeSemaphore );
+		result = Platform::releaseSemaphore( this->nativeSemaphore, permits );
 
 	return result;
 }
 
 WaitResult Semaphore::visit( NATIVE_INTERRUPT& threadInterrupt, unsigned long timeoutMillis )
 {
-	return Platform::waitOnSemaphore( this->nativeSemaphore, threadInterrupt, timeoutMillis );
+	return Platform::waitOnSemaphore( this->nativeSemaphore, 1, threadInterrupt, timeoutMillis );
 }
 
 String Semaphore::generateAnonymousSemaphoreName( unsigned long syntheticID )
@@ -15,6 +15,7 @@
 #include "syscommon/net/ServerSocket.h"
 
 #include <assert.h>
+#include "syscommon/net/CompletionEngine.h"
 
 #ifdef DEBUG
 #include "debug.h"
@@ -65,6 +66,7 @@ void ServerSocket::_ServerSocket()
 	this->nativeSocket = NATIVE_SOCKET_UNINIT;
 	this->boundTo = INADDR_NONE;
 	this->closed = false;
+	this->blocking = true;
 }
 
 //----------------------------------------------------------
@@ -152,9 +154,28 @@ Socket* ServerSocket::accept()
 	NATIVE_SOCKET acceptResult = ::accept( impl, (sockaddr*)&clientAddress, &addrLen );
 	if( acceptResult != NATIVE_SOCKET_ERROR )
 	{
+		// Accepted sockets do not inherit non-blocking mode everywhere, so they always start out
+		// blocking like any other Socket
+		if( !this->blocking )
+			Platform::setNonBlockingMode( acceptResult, false );
+
+		// Nor do they inherit every option, so apply them all again
+		if( !Platform::applySocketOptions(acceptResult, this->options) )
+		{
+			SocketException refused( Platform::describeLastSocketError() );
+			Platform::closeSocket( acceptResult );
+			throw refused;
+		}
+
 		NATIVE_IP_ADDRESS clientIp = ntohl( clientAddress.sin_addr.s_addr );
 		unsigned short clientPort = ntohs( clientAddress.sin_port );
-		return Socket::createFromAccept( acceptResult, InetSocketAddress(clientIp, clientPort) );
+		return Socket::createFromAccept( acceptResult,
+		                                 InetSocketAddress(clientIp, clientPort),
+		                                 this->options );
+	}
+	else if( !this->blocking && Platform::isLastSocketErrorWouldBlock() )
+	{
+		return NULL;
 	}
 	else
 	{
@@ -162,6 +183,75 @@ Socket* ServerSocket::accept()
 	}
 }
 
+void ServerSocket::configureBlocking( bool block )
+{
+	if( isClosed() )
+		throw SocketException( TEXT("Socket is closed") );
+
+	if( Platform::setNonBlockingMode(getImpl(), !block) == NATIVE_SOCKET_ERROR )
+		throw SocketException( Platform::describeLastSocketError() );
+
+	this->blocking = block;
+}
+
+bool ServerSocket::isBlocking() const
+{
+	return this->blocking;
+}
+
+AsyncOperation* ServerSocket::acceptAsync( CompletionEngine& engine,
+                                           ICompletionHandler* handler,
+                                           void* attachment )
+{
+	return engine.accept( this, handler, attachment );
+}
+
+void ServerSocket::setReusePort( bool enable )
+{
+	if( isClosed() )
+		throw SocketException( TEXT("Socket is closed") );
+	if( isBound() )
+		throw SocketException( TEXT("Socket is already bound") );
+
+	if( !Platform::setReusePort(getImpl(), enable) )
+		throw SocketException( TEXT("SO_REUSEPORT is not supported") );
+}
+
+void ServerSocket::setIncomingProcessor( int processor )
+{
+	if( isClosed() )
+		throw SocketException( TEXT("Socket is closed") );
+
+	Platform::setIncomingProcessor( getImpl(), processor );
+}
+
+void ServerSocket::setReusePortSteering( const std::vector<unsigned int>& processors )
+{
+	if( isClosed() )
+		throw SocketException( TEXT("Socket is closed") );
+	if( !isBound() )
+		throw SocketException( TEXT("Socket is not bound yet") );
+
+	if( !Platform::setReusePortSteering(getImpl(), processors) )
+		throw SocketException( TEXT("SO_REUSEPORT steering is not supported") );
+}
+
+void ServerSocket::setOptions( const SocketOptions& options )
+{
+	if( isClosed() )
+		throw SocketException( TEXT("Socket is closed") );
+
+	if( !Platform::applySocketOptions(getImpl(), options) )
+		throw SocketException( Platform::describeLastSocketError() );
+
+	this->options = options;
+}
+
+const SocketOptions& ServerSocket::getOptions() const
+{
+	return this->options;
+}
+
 void ServerSocket::close()
 {
 	NATIVE_SOCKET impl = getImpl();
@@ -0,0 +1,336 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "syscommon/net/Shard.h"
+
+#include <limits.h>
+#include "syscommon/net/ShardedServer.h"
+#include "syscommon/util/StringUtils.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+//----------------------------------------------------------
+//                    STATIC VARIABLES
+//----------------------------------------------------------
+static thread_local Shard* currentShard = NULL;
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+Shard::Shard( ShardedServer* server,
+              IShardHandler* handler,
+              unsigned int index,
+              unsigned int processor,
+              size_t inboxCapacity ) : inbox( inboxCapacity, WP_YIELD )
+{
+	this->server = server;
+	this->handler = handler;
+	this->index = index;
+	this->processor = processor;
+	this->thread = NULL;
+	this->running = false;
+	this->listener = NULL;
+	this->nextHandoff = 0;
+	this->sleeping = false;
+	this->acceptedCount = 0;
+	this->steeredCount = 0;
+	this->failureCount = 0;
+}
+
+Shard::~Shard()
+{
+	delete this->thread;
+
+	if( this->listener )
+	{
+		if( !this->listener->isClosed() )
+			this->listener->close();
+
+		delete this->listener;
+	}
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+unsigned int Shard::getIndex() const
+{
+	return this->index;
+}
+
+unsigned int Shard::getProcessor() const
+{
+	return this->processor;
+}
+
+ShardedServer& Shard::getServer() const
+{
+	return *this->server;
+}
+
+bool Shard::post( IRunnable* task )
+{
+	if( !this->inbox.offer(task) )
+		return false;
+
+	// Pairs with the fence in run(), so that either we see that the shard is going to sleep, or
+	// the shard sees the task before it does
+	std::atomic_thread_fence( std::memory_order_seq_cst );
+	if( this->sleeping.exchange(false) )
+		this->selector.wakeup();
+
+	return true;
+}
+
+void Shard::watch( Socket* socket )
+{
+	if( this->watched.find(socket) == this->watched.end() )
+		this->watched[socket] = this->selector.registerSocket( socket, SelectionKey::OP_READ, NULL );
+}
+
+void Shard::unwatch( Socket* socket )
+{
+	std::map<Socket*,SelectionKey*>::iterator found = this->watched.find( socket );
+	if( found != this->watched.end() )
+	{
+		found->second->cancel();
+		this->watched.erase( found );
+	}
+}
+
+unsigned long long Shard::getAcceptedCount() const
+{
+	return this->acceptedCount;
+}
+
+unsigned long long Shard::getSteeredCount() const
+{
+	return this->steeredCount;
+}
+
+unsigned long long Shard::getFailureCount() const
+{
+	return this->failureCount;
+}
+
+void Shard::start()
+{
+	// Pinned before it runs anything, so that everything the shard allocates for itself is
+	// allocated close to its processor
+	ThreadOptions options;
+	options.processors.push_back( this->processor );
+
+	String name( TEXT("Shard-") );
+	name.append( StringUtils::longToString((long)this->index) );
+
+	this->running = true;
+	this->thread = new Thread( this, name.c_str(), options );
+	this->thread->start();
+}
+
+void Shard::stop()
+{
+	this->running = false;
+	this->sleeping = false;
+	this->selector.wakeup();
+}
+
+void Shard::join()
+{
+	if( this->thread )
+		this->thread->join();
+}
+
+void Shard::acceptConnections()
+{
+	while( this->running )
+	{
+		Socket* socket = NULL;
+		try
+		{
+			socket = this->listener->accept();
+		}
+		catch( SocketException& )
+		{
+			// The connection was reset before we got to it, or we are out of descriptors. Either
+			// way there is nothing to do but try again when the listener is next ready.
+			++this->failureCount;
+		}
+
+		if( !socket )
+			return;
+
+		if( Platform::getIncomingProcessor(socket->nativeSocket) == (int)this->processor )
+			++this->steeredCount;
+
+		// Without SO_REUSEPORT we are the only shard listening, so share the connections out
+		Shard* target = this;
+		if( !this->server->isReusePortEnabled() )
+		{
+			target = &this->server->getShard( this->nextHandoff );
+			this->nextHandoff = (this->nextHandoff + 1) % this->server->getShardCount();
+		}
+
+		Handoff* handoff = NULL;
+		if( target != this )
+		{
+			handoff = new Handoff( target, socket );
+			if( !target->post(handoff) )
+			{
+				delete handoff;
+				handoff = NULL;
+			}
+		}
+
+		if( !handoff )
+			this->deliver( socket );
+	}
+}
+
+void Shard::deliver( Socket* socket )
+{
+	++this->acceptedCount;
+	try
+	{
+		this->handler->onAccept( *this, socket );
+	}
+	catch( ... )
+	{
+		++this->failureCount;
+	}
+}
+
+void Shard::runTasks( std::vector<IRunnable*>& tasks )
+{
+	while( this->inbox.drainTo(tasks, 256) > 0 )
+	{
+		for( size_t i = 0; i < tasks.size(); ++i )
+		{
+			try
+			{
+				tasks[i]->run();
+			}
+			catch( ... )
+			{
+				++this->failureCount;
+			}
+		}
+
+		tasks.clear();
+	}
+}
+
+void Shard::run()
+{
+	currentShard = this;
+
+	try
+	{
+		if( this->listener )
+			this->selector.registerSocket( this->listener, SelectionKey::OP_ACCEPT, NULL );
+
+		this->handler->onStart( *this );
+	}
+	catch( ... )
+	{
+		++this->failureCount;
+	}
+
+	std::vector<IRunnable*> tasks;
+	while( this->running )
+	{
+		this->runTasks( tasks );
+
+		// Say that we are going to sleep before the last look at the inbox. A post() that comes
+		// after the look will see the flag and wake us.
+		this->sleeping = true;
+		std::atomic_thread_fence( std::memory_order_seq_cst );
+		if( !this->inbox.isEmpty() || !this->running )
+		{
+			this->sleeping = false;
+			continue;
+		}
+
+		try
+		{
+			this->selector.select();
+		}
+		catch( IOException& )
+		{
+			// The selector itself has failed, so there is no serving anything more
+			++this->failureCount;
+			break;
+		}
+
+		this->sleeping = false;
+
+		const std::vector<SelectionKey*>& ready = this->selector.getSelectedKeys();
+		for( size_t i = 0; i < ready.size() && this->running; ++i )
+		{
+			SelectionKey* key = ready[i];
+			if( key->isAcceptable() )
+			{
+				this->acceptConnections();
+				continue;
+			}
+
+			// An earlier callback may have stopped watching this socket
+			if( !key->isValid() || !key->isReadable() )
+				continue;
+
+			try
+			{
+				this->handler->onReadable( *this, key->getSocket() );
+			}
+			catch( ... )
+			{
+				++this->failureCount;
+			}
+		}
+	}
+
+	// Run anything posted before the server stopped, which includes connections handed over by
+	// the first shard, so that the handler gets to clean them up
+	this->runTasks( tasks );
+
+	try
+	{
+		this->handler->onStop( *this );
+	}
+	catch( ... )
+	{
+		++this->failureCount;
+	}
+
+	this->watched.clear();
+	currentShard = NULL;
+}
+
+void Shard::Handoff::run()
+{
+	this->shard->deliver( this->socket );
+	delete this;
+}
+
+//----------------------------------------------------------
+//                     STATIC METHODS
+//----------------------------------------------------------
+Shard* Shard::current()
+{
+	return currentShard;
+}
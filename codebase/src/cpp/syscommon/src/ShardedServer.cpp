@@ -0,0 +1,237 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "syscommon/net/ShardedServer.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+//----------------------------------------------------------
+//                    STATIC VARIABLES
+//----------------------------------------------------------
+const size_t ShardedServer::DEFAULT_INBOX_CAPACITY;
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+ShardedServer::ShardedServer( IShardHandler* handler )
+{
+	this->_ShardedServer( handler,
+	                      Platform::getTopology().getOnePerCore(),
+	                      DEFAULT_INBOX_CAPACITY );
+}
+
+ShardedServer::ShardedServer( IShardHandler* handler,
+                              const std::vector<unsigned int>& processors,
+                              size_t inboxCapacity )
+{
+	if( processors.empty() )
+		throw IllegalArgumentException( TEXT("A sharded server needs at least one processor") );
+
+	this->_ShardedServer( handler, processors, inboxCapacity );
+}
+
+void ShardedServer::_ShardedServer( IShardHandler* handler,
+                                    const std::vector<unsigned int>& processors,
+                                    size_t inboxCapacity )
+{
+	this->handler = handler;
+	this->processors = processors;
+	this->inboxCapacity = inboxCapacity;
+	this->reusePort = false;
+	this->cpuSteering = false;
+	this->cpuSteeringActive = false;
+	this->port = 0;
+	this->running = false;
+
+	// A topology that could not be read still has to give us somewhere to run
+	if( this->processors.empty() )
+		this->processors.push_back( Platform::getCurrentProcessor() );
+}
+
+ShardedServer::~ShardedServer()
+{
+	this->stop();
+	this->destroyShards();
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+void ShardedServer::start( const InetSocketAddress& endpoint )
+{
+	this->start( endpoint, 50 );
+}
+
+void ShardedServer::start( const InetSocketAddress& endpoint, int backlog )
+{
+	if( this->running )
+		throw IllegalStateException( TEXT("Sharded server has already been started") );
+
+	this->destroyShards();
+	this->createShards( endpoint, backlog );
+
+	size_t started = 0;
+	try
+	{
+		for( ; started < this->shards.size(); ++started )
+			this->shards[started]->start();
+	}
+	catch( Exception& )
+	{
+		for( size_t i = 0; i < started; ++i )
+			this->shards[i]->stop();
+		for( size_t i = 0; i < started; ++i )
+			this->shards[i]->join();
+
+		this->destroyShards();
+		throw;
+	}
+
+	this->running = true;
+}
+
+void ShardedServer::stop()
+{
+	if( !this->running )
+		return;
+
+	for( size_t i = 0; i < this->shards.size(); ++i )
+		this->shards[i]->stop();
+
+	for( size_t i = 0; i < this->shards.size(); ++i )
+	{
+		Shard* shard = this->shards[i];
+		shard->join();
+
+		// Close the port now rather than when the shard is destroyed, so that the server can be
+		// started on it again straight away
+		if( shard->listener && !shard->listener->isClosed() )
+			shard->listener->close();
+	}
+
+	this->running = false;
+}
+
+bool ShardedServer::isRunning() const
+{
+	return this->running;
+}
+
+unsigned short ShardedServer::getLocalPort() const
+{
+	return this->running ? this->port : 0;
+}
+
+size_t ShardedServer::getShardCount() const
+{
+	return this->processors.size();
+}
+
+Shard& ShardedServer::getShard( size_t index )
+{
+	if( index >= this->shards.size() )
+		throw IllegalArgumentException( TEXT("No shard at that index") );
+
+	return *this->shards[index];
+}
+
+void ShardedServer::setCpuSteering( bool enable )
+{
+	if( this->running )
+		throw IllegalStateException( TEXT("Sharded server is running") );
+
+	this->cpuSteering = enable;
+}
+
+bool ShardedServer::isCpuSteeringActive() const
+{
+	return this->running && this->cpuSteeringActive;
+}
+
+bool ShardedServer::isReusePortEnabled() const
+{
+	return this->reusePort;
+}
+
+void ShardedServer::createShards( const InetSocketAddress& endpoint, int backlog )
+{
+	this->reusePort = true;
+	this->port = endpoint.getPort();
+
+	try
+	{
+		for( size_t i = 0; i < this->processors.size(); ++i )
+		{
+			Shard* shard = new Shard( this,
+			                          this->handler,
+			                          (unsigned int)i,
+			                          this->processors[i],
+			                          this->inboxCapacity );
+			this->shards.push_back( shard );
+
+			if( i > 0 && !this->reusePort )
+				continue;
+
+			shard->listener = new ServerSocket();
+			try
+			{
+				shard->listener->setReusePort( true );
+			}
+			catch( SocketException& )
+			{
+				// Only the first shard will listen
+				this->reusePort = false;
+			}
+
+			shard->listener->setIncomingProcessor( (int)shard->processor );
+
+			// The first shard settles which port we are on, if we were asked for any free one
+			shard->listener->bind( InetSocketAddress(endpoint.getAddress(), this->port), backlog );
+			this->port = shard->listener->getLocalPort();
+			shard->listener->configureBlocking( false );
+		}
+
+		// The shards were bound in order, so shard i is the i-th socket in the group
+		this->cpuSteeringActive = false;
+		if( this->cpuSteering && this->reusePort )
+		{
+			try
+			{
+				this->shards[0]->listener->setReusePortSteering( this->processors );
+				this->cpuSteeringActive = true;
+			}
+			catch( SocketException& )
+			{
+				// Left to the SO_INCOMING_CPU hint
+			}
+		}
+	}
+	catch( Exception& )
+	{
+		this->destroyShards();
+		throw;
+	}
+}
+
+void ShardedServer::destroyShards()
+{
+	for( size_t i = 0; i < this->shards.size(); ++i )
+		delete this->shards[i];
+
+	this->shards.clear();
+}
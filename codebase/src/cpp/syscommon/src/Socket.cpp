@@ -15,7 +15,11 @@
 #include "syscommon/net/Socket.h"
 
 #include <assert.h>
+#include <limits.h>
 #include <math.h>
+#include <vector>
+#include "syscommon/net/CompletionEngine.h"
+#include "syscommon/net/ITransferListener.h"
 
 #ifdef DEBUG
 #include "debug.h"
@@ -26,6 +30,7 @@ using namespace syscommon;
 //----------------------------------------------------------
 //                    STATIC VARIABLES
 //----------------------------------------------------------
+const int Socket::DEFAULT_ZERO_COPY_THRESHOLD;
 
 //----------------------------------------------------------
 //                      CONSTRUCTORS
@@ -58,6 +63,11 @@ void Socket::_Socket()
 	this->closed = false;
 	this->inputShutdown = true;
 	this->outputShutdown = true;
+	this->blocking = true;
+
+	this->zeroCopy = false;
+	this->zeroCopyThreshold = DEFAULT_ZERO_COPY_THRESHOLD;
+	this->zeroCopySequence = 0;
 
 	this->remoteAddress = INADDR_NONE;
 	this->remotePort = 0;
@@ -71,6 +81,161 @@ bool Socket::isCreated() const
 	return this->created;
 }
 
+void Socket::checkUsable( bool output ) const
+{
+	if( isClosed() )
+		throw SocketException( TEXT("Socket is closed") );
+
+	if( !isConnected() )
+		throw SocketException( TEXT("Socket is not connected") );
+
+	if( output && isOutputShutdown() )
+		throw SocketException( TEXT("Socket output has been shutdown") );
+
+	if( !output && isInputShutdown() )
+		throw SocketException( TEXT("Socket input has been shutdown") );
+}
+
+int Socket::transferAll( const BufferSegment* segments, int count, bool output )
+{
+	if( !segments || count < 0 )
+		throw IllegalArgumentException( TEXT("Segments cannot be NULL and count cannot be negative") );
+
+	BufferSegment window[BufferSegment::MAX_BATCH];
+	int index = 0;
+	int offset = 0;
+	int total = 0;
+	while( true )
+	{
+		// Step over the segments that are done, along with any that are empty
+		while( index < count && offset == segments[index].length )
+		{
+			++index;
+			offset = 0;
+		}
+
+		if( index == count )
+			break;
+
+		// The window starts part way into the first segment if it was only partly moved
+		int windowSize = count - index;
+		if( windowSize > BufferSegment::MAX_BATCH )
+			windowSize = BufferSegment::MAX_BATCH;
+
+		for( int i = 0; i < windowSize; ++i )
+			window[i] = segments[index + i];
+
+		window[0].buffer += offset;
+		window[0].length -= offset;
+
+		int result = output ? this->sendv( window, windowSize ) : this->receivev( window, windowSize );
+		if( result == 0 && !output )
+			break;
+
+		if( result <= 0 )
+		{
+			// Only a non-blocking socket comes back without moving anything
+			this->waitUntilReady( output );
+			continue;
+		}
+
+		total += result;
+		while( result > 0 )
+		{
+			int left = segments[index].length - offset;
+			if( result < left )
+			{
+				offset += result;
+				result = 0;
+			}
+			else
+			{
+				result -= left;
+				++index;
+				offset = 0;
+			}
+		}
+	}
+
+	return total;
+}
+
+void Socket::waitUntilReady( bool output )
+{
+	SocketPoll ready;
+	ready.socket = this->nativeSocket;
+	ready.interest = output ? SE_WRITE : SE_READ;
+	ready.ready = 0;
+	if( Platform::pollSockets(&ready, 1, NATIVE_INFINITE_WAIT) < 0 )
+		throw SocketException( Platform::describeLastSocketError() );
+}
+
+void Socket::collectZeroCopy()
+{
+	ZeroCopyRange ranges[16];
+	int count;
+	do
+	{
+		count = Platform::readZeroCopyCompletions( this->nativeSocket, ranges, 16 );
+		if( count < 0 )
+			throw SocketException( Platform::describeLastSocketError() );
+
+		for( int i = 0; i < count; ++i )
+		{
+			// The range can wrap when the sequence does, so step through it rather than
+			// comparing its ends
+			unsigned int sequence = ranges[i].first;
+			while( true )
+			{
+				std::map<unsigned int,void*>::iterator found = this->zeroCopyPending.find( sequence );
+				if( found != this->zeroCopyPending.end() )
+				{
+					ZeroCopyCompletion completion;
+					completion.context = found->second;
+					completion.copied = ranges[i].copied;
+					this->zeroCopyCompleted.push_back( completion );
+					this->zeroCopyPending.erase( found );
+				}
+
+				if( sequence == ranges[i].last )
+					break;
+
+				++sequence;
+			}
+		}
+	}
+	while( count == 16 );
+}
+
+long long Socket::relayBuffered( Socket& source, long long length, ITransferListener* listener )
+{
+	std::vector<char> buffer( 65536 );
+	long long total = 0;
+	while( length < 0 || total < length )
+	{
+		int chunk = (int)buffer.size();
+		if( length >= 0 && length - total < chunk )
+			chunk = (int)(length - total);
+
+		int received = source.receive( &buffer[0], chunk );
+		if( received == 0 )
+			break;
+
+		if( received < 0 )
+		{
+			source.waitUntilReady( false );
+			continue;
+		}
+
+		this->sendAll( &buffer[0], received );
+		total += received;
+		if( listener && !listener->transferred(total, length) )
+			break;
+	}
+
+	return total;
+}
+
 void Socket::create()
 {
 	if( isCreated() )
@@ -83,6 +248,12 @@ void Socket::create()
 	else
 		throw SocketException( Platform::describeLastSocketError() );
 
+	// Asked for before there was a socket to set them on
+	if( !Platform::applySocketOptions(this->nativeSocket, this->options) )
+		throw SocketException( Platform::describeLastSocketError() );
+
+	if( this->zeroCopy && !Platform::setZeroCopy(this->nativeSocket, true) )
+		throw SocketException( TEXT("Zero-copy sends are not supported on this platform") );
 }
 
 bool Socket::isConnected() const
@@ -119,6 +290,9 @@ void Socket::connect( const InetSocketAddress& endpoint )
 								  sizeof(sockaddr_in) );
 	if( connectResult != NATIVE_SOCKET_ERROR )
 	{
+		if( !this->blocking )
+			Platform::setNonBlockingMode( this->nativeSocket, true );
+
 		this->remoteAddress = endpoint.getAddress();
 		this->remotePort = endpoint.getPort();
 		this->inputShutdown = false;
@@ -203,8 +377,8 @@ void Socket::connect( const InetSocketAddress& endpoint, int timeout )
 		}
 	}
 
-	// If we get to here we are connected! Set the socket back to non-blocking
-	Platform::setNonBlockingMode( this->nativeSocket, false );
+	// If we get to here we are connected! Put the socket back into the mode it was asked for
+	Platform::setNonBlockingMode( this->nativeSocket, !this->blocking );
 
 	this->remoteAddress = endpoint.getAddress();
 	this->remotePort = endpoint.getPort();
@@ -248,50 +422,426 @@ void Socket::close()
 
 int Socket::send( const char* buffer, int length )
 {
-	if( isClosed() )
-		throw SocketException( TEXT("Socket is closed") );
+	this->checkUsable( true );
+	if( length < 0 )
+		throw SocketException( TEXT("Negative length provided to send") );
 
-	if( !isConnected() )
-		throw SocketException( TEXT("Socket is not connected") );
+	assert( this->nativeSocket != NATIVE_SOCKET_UNINIT );
 
-	if( isOutputShutdown() )
-		throw SocketException( TEXT("Socket output has been shutdown") );
+	int result = ::send( this->nativeSocket, buffer, length, NATIVE_SOCKET_SEND_FLAGS );
+	if( result == NATIVE_SOCKET_ERROR )
+	{
+		if( !this->blocking && Platform::isLastSocketErrorWouldBlock() )
+			return 0;
 
+		throw SocketException( Platform::describeLastSocketError() );
+	}
+	
+	return result;
+}
+
+int Socket::receive( char* buffer, int length )
+{
+	this->checkUsable( false );
 	if( length < 0 )
-		throw SocketException( TEXT("Negative length provided to send") );
+		throw SocketException( TEXT("Negative length") );
 
 	assert( this->nativeSocket != NATIVE_SOCKET_UNINIT );
 
-	int result = ::send( this->nativeSocket, buffer, length, 0 );
+	int result = ::recv( this->nativeSocket, buffer, length, 0 );
 	if( result == NATIVE_SOCKET_ERROR )
+	{
+		if( !this->blocking && Platform::isLastSocketErrorWouldBlock() )
+			return -1;
+
 		throw SocketException( Platform::describeLastSocketError() );
+	}
 	
+	if( result > 0 && this->options.quickAck == 1 )
+		Platform::rearmQuickAck( this->nativeSocket );
+
 	return result;
 }
 
-int Socket::receive( char* buffer, int length )
+int Socket::sendv( const BufferSegment* segments, int count )
+{
+	if( !segments || count < 0 )
+		throw IllegalArgumentException( TEXT("Segments cannot be NULL and count cannot be negative") );
+
+	this->checkUsable( true );
+	for( int i = 0; i < count && i < BufferSegment::MAX_BATCH; ++i )
+	{
+		if( segments[i].length < 0 )
+			throw SocketException( TEXT("Negative length provided to send") );
+	}
+
+	assert( this->nativeSocket != NATIVE_SOCKET_UNINIT );
+
+	int result = Platform::sendSegments( this->nativeSocket, segments, count );
+	if( result == NATIVE_SOCKET_ERROR )
+	{
+		if( !this->blocking && Platform::isLastSocketErrorWouldBlock() )
+			return 0;
+
+		throw SocketException( Platform::describeLastSocketError() );
+	}
+
+	return result;
+}
+
+int Socket::receivev( BufferSegment* segments, int count )
+{
+	if( !segments || count < 0 )
+		throw IllegalArgumentException( TEXT("Segments cannot be NULL and count cannot be negative") );
+
+	this->checkUsable( false );
+	for( int i = 0; i < count && i < BufferSegment::MAX_BATCH; ++i )
+	{
+		if( segments[i].length < 0 )
+			throw SocketException( TEXT("Negative length") );
+	}
+
+	assert( this->nativeSocket != NATIVE_SOCKET_UNINIT );
+
+	int result = Platform::receiveSegments( this->nativeSocket, segments, count );
+	if( result == NATIVE_SOCKET_ERROR )
+	{
+		if( !this->blocking && Platform::isLastSocketErrorWouldBlock() )
+			return -1;
+
+		throw SocketException( Platform::describeLastSocketError() );
+	}
+
+	if( result > 0 && this->options.quickAck == 1 )
+		Platform::rearmQuickAck( this->nativeSocket );
+
+	return result;
+}
+
+void Socket::sendAll( const char* buffer, int length )
+{
+	BufferSegment segment;
+	segment.buffer = const_cast<char*>( buffer );
+	segment.length = length;
+	this->transferAll( &segment, 1, true );
+}
+
+void Socket::sendAll( const BufferSegment* segments, int count )
+{
+	this->transferAll( segments, count, true );
+}
+
+int Socket::receiveFully( char* buffer, int length )
+{
+	BufferSegment segment;
+	segment.buffer = buffer;
+	segment.length = length;
+	return this->transferAll( &segment, 1, false );
+}
+
+int Socket::receiveFully( BufferSegment* segments, int count )
+{
+	return this->transferAll( segments, count, false );
+}
+
+long long Socket::transferFrom( NATIVE_FILE file, long long offset, long long length )
+{
+	this->checkUsable( true );
+	if( file == NATIVE_FILE_UNINIT || offset < 0 || length < 0 )
+		throw IllegalArgumentException( TEXT("File must be open, and offset and length cannot be negative") );
+
+	assert( this->nativeSocket != NATIVE_SOCKET_UNINIT );
+
+	long long result = Platform::sendFile( this->nativeSocket, file, offset, length );
+	if( result < 0 )
+	{
+		if( !this->blocking && Platform::isLastSocketErrorWouldBlock() )
+			return -1;
+
+		throw IOException( Platform::describeLastSocketError() );
+	}
+
+	return result;
+}
+
+long long Socket::transferFrom( NATIVE_FILE file,
+                                long long offset,
+                                long long length,
+                                ITransferListener* listener )
+{
+	// The rest of the file, if it has an end to find
+	long long expected = length;
+	if( length < 0 )
+	{
+		long long size = Platform::getFileSize( file );
+		expected = size < 0 ? -1 : (size > offset ? size - offset : 0);
+	}
+
+	long long total = 0;
+	while( length < 0 || total < length )
+	{
+		long long chunk = length < 0 ? LLONG_MAX : length - total;
+		long long result = this->transferFrom( file, offset + total, chunk );
+		if( result == 0 )
+			break;
+
+		if( result < 0 )
+		{
+			this->waitUntilReady( true );
+			continue;
+		}
+
+		total += result;
+		if( listener && !listener->transferred(total, expected) )
+			break;
+	}
+
+	return total;
+}
+
+long long Socket::transferFrom( const tchar* fileName,
+                                long long offset,
+                                long long length,
+                                ITransferListener* listener )
+{
+	NATIVE_FILE file = Platform::openFile( fileName );
+	if( file == NATIVE_FILE_UNINIT )
+		throw FileNotFoundException( TEXT("File could not be opened") );
+
+	long long total = 0;
+	try
+	{
+		total = this->transferFrom( file, offset, length, listener );
+	}
+	catch( ... )
+	{
+		Platform::closeFile( file );
+		throw;
+	}
+
+	Platform::closeFile( file );
+	return total;
+}
+
+long long Socket::transferFrom( Socket& source, long long length, ITransferListener* listener )
+{
+	this->checkUsable( true );
+	source.checkUsable( false );
+
+	NATIVE_FILE readEnd = NATIVE_FILE_UNINIT;
+	NATIVE_FILE writeEnd = NATIVE_FILE_UNINIT;
+	if( !Platform::createRelay(readEnd, writeEnd) )
+		return this->relayBuffered( source, length, listener );
+
+	long long total = 0;
+	try
+	{
+		while( length < 0 || total < length )
+		{
+			long long chunk = length < 0 ? LLONG_MAX : length - total;
+			long long result = Platform::relaySocket( source.nativeSocket,
+			                                          this->nativeSocket,
+			                                          readEnd,
+			                                          writeEnd,
+			                                          chunk );
+			if( result == 0 )
+				break;
+
+			if( result < 0 )
+			{
+				// Only a non-blocking source comes back without anything to relay
+				if( !Platform::isLastSocketErrorWouldBlock() )
+					throw SocketException( Platform::describeLastSocketError() );
+
+				source.waitUntilReady( false );
+				continue;
+			}
+
+			total += result;
+			if( listener && !listener->transferred(total, length) )
+				break;
+		}
+	}
+	catch( ... )
+	{
+		Platform::closeFile( readEnd );
+		Platform::closeFile( writeEnd );
+		throw;
+	}
+
+	Platform::closeFile( readEnd );
+	Platform::closeFile( writeEnd );
+	return total;
+}
+
+void Socket::setOptions( const SocketOptions& options )
 {
 	if( isClosed() )
 		throw SocketException( TEXT("Socket is closed") );
 
-	if( !isConnected() )
-		throw SocketException( TEXT("Socket is not connected") );
+	// A socket that has not connected yet has nothing to apply them to, and create() applies
+	// them instead
+	if( isCreated() && !Platform::applySocketOptions(this->nativeSocket, options) )
+		throw SocketException( Platform::describeLastSocketError() );
 
-	if( isInputShutdown() )
-		throw SocketException( TEXT("Socket input has been shutdown") );
+	this->options = options;
+}
 
-	if( length < 0 )
-		throw SocketException( TEXT("Negative length") );
+const SocketOptions& Socket::getOptions() const
+{
+	return this->options;
+}
+
+void Socket::setZeroCopy( bool enable )
+{
+	if( isClosed() )
+		throw SocketException( TEXT("Socket is closed") );
+
+	// A socket that has not connected yet has nothing to set the option on, and create() sets
+	// it instead
+	if( isCreated() && !Platform::setZeroCopy(this->nativeSocket, enable) )
+		throw SocketException( TEXT("Zero-copy sends are not supported on this platform") );
+
+	this->zeroCopy = enable;
+}
+
+bool Socket::isZeroCopy() const
+{
+	return this->zeroCopy;
+}
+
+void Socket::setZeroCopyThreshold( int threshold )
+{
+	this->zeroCopyThreshold = threshold;
+}
+
+int Socket::getZeroCopyThreshold() const
+{
+	return this->zeroCopyThreshold;
+}
+
+int Socket::sendZeroCopy( const char* buffer, int length, void* context )
+{
+	if( !this->zeroCopy || length < this->zeroCopyThreshold )
+	{
+		// Copied now, so the buffer is free as soon as this returns
+		int sent = this->send( buffer, length );
+		if( sent > 0 )
+		{
+			ZeroCopyCompletion completion;
+			completion.context = context;
+			completion.copied = true;
+			this->zeroCopyCompleted.push_back( completion );
+		}
+
+		return sent;
+	}
+
+	this->checkUsable( true );
 
 	assert( this->nativeSocket != NATIVE_SOCKET_UNINIT );
 
-	int result = ::recv( this->nativeSocket, buffer, length, 0 );
+	bool copied = false;
+	int result = Platform::sendZeroCopy( this->nativeSocket, buffer, length, copied );
 	if( result == NATIVE_SOCKET_ERROR )
+	{
+		if( !this->blocking && Platform::isLastSocketErrorWouldBlock() )
+			return 0;
+
 		throw SocketException( Platform::describeLastSocketError() );
-	
+	}
+
+	if( result > 0 && copied )
+	{
+		ZeroCopyCompletion completion;
+		completion.context = context;
+		completion.copied = true;
+		this->zeroCopyCompleted.push_back( completion );
+	}
+	else if( result > 0 )
+	{
+		// The kernel numbers each zero-copy send in turn, and completes them by that number
+		this->zeroCopyPending[this->zeroCopySequence++] = context;
+	}
+
 	return result;
 }
 
+int Socket::pollZeroCopy( ZeroCopyCompletion* completions, int count, unsigned long timeout )
+{
+	if( isClosed() )
+		throw SocketException( TEXT("Socket is closed") );
+
+	if( !completions || count < 0 )
+		throw IllegalArgumentException( TEXT("Completions cannot be NULL and count cannot be negative") );
+
+	if( !this->zeroCopyPending.empty() )
+		this->collectZeroCopy();
+
+	if( this->zeroCopyCompleted.empty() && !this->zeroCopyPending.empty() && timeout != 0 )
+	{
+		// Completions arrive on the error queue, which poll() reports as an error whatever
+		// else it is asked to wait for
+		SocketPoll ready;
+		ready.socket = this->nativeSocket;
+		ready.interest = 0;
+		ready.ready = 0;
+		if( Platform::pollSockets(&ready, 1, timeout) < 0 )
+			throw SocketException( Platform::describeLastSocketError() );
+
+		this->collectZeroCopy();
+	}
+
+	int collected = 0;
+	while( collected < count && !this->zeroCopyCompleted.empty() )
+	{
+		completions[collected++] = this->zeroCopyCompleted.front();
+		this->zeroCopyCompleted.pop_front();
+	}
+
+	return collected;
+}
+
+int Socket::getZeroCopyPendingCount() const
+{
+	return (int)this->zeroCopyPending.size();
+}
+
+void Socket::configureBlocking( bool block )
+{
+	if( isClosed() )
+		throw SocketException( TEXT("Socket is closed") );
+
+	// An unconnected socket picks the mode up once it has connected
+	if( isConnected() && Platform::setNonBlockingMode(this->nativeSocket, !block) == NATIVE_SOCKET_ERROR )
+		throw SocketException( Platform::describeLastSocketError() );
+
+	this->blocking = block;
+}
+
+bool Socket::isBlocking() const
+{
+	return this->blocking;
+}
+
+AsyncOperation* Socket::sendAsync( CompletionEngine& engine,
+                                   const char* buffer,
+                                   int length,
+                                   ICompletionHandler* handler,
+                                   void* attachment )
+{
+	return engine.send( this, buffer, length, handler, attachment );
+}
+
+AsyncOperation* Socket::receiveAsync( CompletionEngine& engine,
+                                      char* buffer,
+                                      int length,
+                                      ICompletionHandler* handler,
+                                      void* attachment )
+{
+	return engine.receive( this, buffer, length, handler, attachment );
+}
+
 NATIVE_IP_ADDRESS Socket::getInetAddress() const
 {
 	return this->remoteAddress;
@@ -375,3 +925,12 @@ Socket* Socket::createFromAccept( NATIVE_SOCKET client, const InetSocketAddress&
 
 	return clientSocket;
 }
+
+Socket* Socket::createFromAccept( NATIVE_SOCKET client,
+                                  const InetSocketAddress& clientAddress,
+                                  const SocketOptions& options )
+{
+	Socket* clientSocket = createFromAccept( client, clientAddress );
+	clientSocket->options = options;
+	return clientSocket;
+}
@@ -0,0 +1,97 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "syscommon/util/Stopwatch.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+Stopwatch::Stopwatch()
+{
+	this->running = false;
+	this->startNanos = 0;
+	this->accumulatedNanos = 0;
+}
+
+Stopwatch::~Stopwatch()
+{
+
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+void Stopwatch::start()
+{
+	if( !this->running )
+	{
+		this->running = true;
+		this->startNanos = Platform::nanoTime();
+	}
+}
+
+void Stopwatch::stop()
+{
+	if( this->running )
+	{
+		this->accumulatedNanos += Platform::nanoTime() - this->startNanos;
+		this->running = false;
+	}
+}
+
+void Stopwatch::reset()
+{
+	this->running = false;
+	this->accumulatedNanos = 0;
+}
+
+bool Stopwatch::isRunning() const
+{
+	return this->running;
+}
+
+long long Stopwatch::getElapsedNanos() const
+{
+	long long elapsed = this->accumulatedNanos;
+	if( this->running )
+		elapsed += Platform::nanoTime() - this->startNanos;
+
+	return elapsed;
+}
+
+long long Stopwatch::getElapsedMicros() const
+{
+	return this->getElapsedNanos() / 1000LL;
+}
+
+long long Stopwatch::getElapsedMillis() const
+{
+	return this->getElapsedNanos() / 1000000LL;
+}
+
+//----------------------------------------------------------
+//                     STATIC METHODS
+//----------------------------------------------------------
+Stopwatch Stopwatch::createStarted()
+{
+	Stopwatch stopwatch;
+	stopwatch.start();
+	return stopwatch;
+}
@@ -29,11 +29,36 @@ using namespace syscommon;
 //----------------------------------------------------------
 unsigned long Thread::THREAD_ID_COUNTER = 0;
 std::map<unsigned long, Thread*> Thread::threadMap;
-std::map<NATIVE_THREAD, Thread*> Thread::nativeThreadMap;
-Lock Thread::managementLock;
+Lock Thread::managementLock( LP_PLAIN );
 Thread Thread::mainThread( NULL, TEXT("Main") );
 NATIVE_THREAD Thread::mainThreadHandle = Platform::getCurrentThreadHandle();
 
+// The Thread instance for the calling thread. Set when a Thread starts running and cleared when
+// it finishes, so that currentThread() does not need to take any locks
+static thread_local Thread* currentThreadInstance = NULL;
+
+/**
+ * Owns the Thread instance that currentThread() creates for a thread that was not started by
+ * the Thread class, and deletes it when that thread exits
+ */
+struct ForeignThreadHolder
+{
+	Thread* thread;
+
+	ForeignThreadHolder() : thread( NULL )
+	{
+
+	}
+
+	~ForeignThreadHolder()
+	{
+		currentThreadInstance = NULL;
+		delete this->thread;
+	}
+};
+
+static thread_local ForeignThreadHolder foreignThread;
+
 //----------------------------------------------------------
 //                      CONSTRUCTORS
 //----------------------------------------------------------
@@ -73,6 +98,21 @@ Thread::Thread( IRunnable* runnable, const tchar* name ) : joinEvent( false, TEX
 	this->_Thread( runnable, String(name) );
 }
 
+/**
+ * Constructor for type Thread with provided IRunnable, name and options. The options are
+ * applied to the new thread of execution when it is started, before the runnable is executed.
+ *
+ * @param runnable This thread's unit of execution
+ * @param name The name of the thread
+ * @param options The affinity, scheduling, stack and NUMA settings for the thread
+ */
+Thread::Thread( IRunnable* runnable, const tchar* name, const ThreadOptions& options )
+	: joinEvent( false, TEXT("ThreadJoin") )
+{
+	this->_Thread( runnable, String(name) );
+	this->options = options;
+}
+
 /**
  * Common thread initialiser method
  */
@@ -81,9 +121,10 @@ void Thread::_Thread( IRunnable* runnable, const String& name )
 	this->state = TS_STOPPED;
 	this->runner = runnable;
 	this->name = name;
-	this->syntheticHandle = THREAD_ID_COUNTER++;
-	
+
+	// Threads may be constructed concurrently, so the counter is guarded along with the map
 	Thread::managementLock.lock();
+	this->syntheticHandle = THREAD_ID_COUNTER++;
 	Thread::threadMap[this->syntheticHandle] = this;
 	Thread::managementLock.unlock();
 
@@ -118,6 +159,24 @@ const tchar* Thread::getName() const
 	return this->name.c_str();
 }
 
+/**
+ * Returns the options that this thread is, or will be, started with
+ */
+const ThreadOptions& Thread::getOptions() const
+{
+	return this->options;
+}
+
+/**
+ * Sets the options that this thread will be started with
+ *
+ * @param options The affinity, scheduling, stack and NUMA settings for the thread
+ */
+void Thread::setOptions( const ThreadOptions& options )
+{
+	this->options = options;
+}
+
 /**
  * Interrupts this thread. Any operations within this thread's unit of execution that
  * are blocking will return with a WaitResult of WR_INTERRUPTED and the thread's unit
@@ -229,20 +288,29 @@ void Thread::run()
 
 /**
  * Executes this thread's run method in a new thread of execution.
+ *
+ * @throw IllegalStateException if the thread could not be created with its options
  */
 void Thread::start()
 {
 	if ( this->state == TS_STOPPED )
 	{
-		// Create the thread in suspended mode
+		// Create the thread in suspended mode, with its options already applied
 		bool threadInitialised = Platform::initialiseThread( this->sysThreadHandle, 
-															 (void*)this );
+															 (void*)this,
+															 this->options );
 
 		if ( threadInitialised )
 		{
 			// Resume the thread
 			Platform::resumeThread( this->sysThreadHandle );
 		}
+		else
+		{
+			String message( TEXT("Could not start thread ") );
+			message.append( this->name );
+			throw IllegalStateException( message.c_str() );
+		}
 	}
 }
 
@@ -256,37 +324,39 @@ void Thread::start()
  */
 Thread* Thread::currentThread()
 {
-	Thread* asThread = NULL;
-
-	// Lock the managementLock. Threads being created and destroyed while we are in
-	// this function can mess with the results!
-	Thread::managementLock.lock();
-
-	// Get the current thread's ID from the OS
-	NATIVE_THREAD sysHandle = Platform::getCurrentThreadHandle();
-
-	// If the ID was not the main thread's ID
-	if( !Platform::threadHandlesEqual(sysHandle, Thread::mainThreadHandle) )
-	{
-		// Lookup the ID in the map
-		std::map<NATIVE_THREAD, Thread*>::iterator threadPos = Thread::nativeThreadMap.find( sysHandle );
-		if ( threadPos != Thread::nativeThreadMap.end() )
-		{
-			// Found the thread, so return it
-			asThread = (*threadPos).second;
-		}
-	}
-	else
+	Thread* asThread = currentThreadInstance;
+	if( !asThread )
 	{
-		// This thread is the main thread, so return it
-		asThread = &Thread::mainThread;
+		// First call on this thread. Threads started by us set the cache before running, so
+		// this is either the main thread or one that was created outside of this class
+		NATIVE_THREAD sysHandle = Platform::getCurrentThreadHandle();
+		if( Platform::threadHandlesEqual(sysHandle, Thread::mainThreadHandle) )
+			asThread = &Thread::mainThread;
+		else
+			asThread = Thread::attachForeignThread();
+
+		currentThreadInstance = asThread;
 	}
-	
-	// Unlock the management lock now we are all done.
-	Thread::managementLock.unlock();
+
 	return asThread;
 }
 
+/**
+ * Tests whether the current thread has a pending interrupt and clears it.
+ *
+ * @return true if the current thread had a pending interrupt, otherwise false
+ */
+bool Thread::interrupted()
+{
+	bool wasInterrupted = false;
+
+	Thread* thisThread = Thread::currentThread();
+	if ( thisThread && thisThread->interruptInitialised )
+		wasInterrupted = Platform::clearInterrupt( thisThread->interruptEvent );
+
+	return wasInterrupted;
+}
+
 /**
  * Suspends this thread for the specified time period.
  *
@@ -320,6 +390,23 @@ String Thread::generateAnonymousThreadName()
 	return result;
 }
 
+/**
+ * Creates the Thread instance representing a thread that was not started by this class. The
+ * instance is owned by the calling thread's ForeignThreadHolder, and is deleted when the thread
+ * exits.
+ *
+ * @return The Thread instance for the calling thread
+ */
+Thread* Thread::attachForeignThread()
+{
+	Thread* attached = new Thread();
+	attached->sysThreadHandle = Platform::getCurrentThreadHandle();
+	attached->state = TS_ALIVE;
+
+	foreignThread.thread = attached;
+	return attached;
+}
+
 /**
  * Entry point for platform threads.
  *
@@ -333,11 +420,8 @@ void Thread::threadEntry( void* threadInstance )
 		assert( asThread );
 		if ( asThread )
 		{
-			// Put the thread in the native thread map
-			NATIVE_THREAD sysHandle = asThread->sysThreadHandle;
-			Thread::managementLock.lock();
-			Thread::nativeThreadMap.insert( std::pair<NATIVE_THREAD,Thread*>(sysHandle, asThread) );
-			Thread::managementLock.unlock();
+			// Make the thread visible to currentThread()
+			currentThreadInstance = asThread;
 
 			// Switch into TS_ALIVE state
 			asThread->state = TS_ALIVE;
@@ -348,12 +432,10 @@ void Thread::threadEntry( void* threadInstance )
 			// Switch back to TS_STOPPED state
 			asThread->state = TS_STOPPED;
 
-			// Clean up and close handles
-			Thread::managementLock.lock();
-			Thread::nativeThreadMap.erase( sysHandle );
-			Thread::managementLock.unlock();
-			
-			Platform::destroyThread( sysHandle );
+			// Clean up and close handles. The handle itself rather than a copy, so that
+			// destroying its resume event waits for start() to finish signaling it.
+			currentThreadInstance = NULL;
+			Platform::destroyThread( asThread->sysThreadHandle );
 
 			asThread->joinEvent.signal();
 		}
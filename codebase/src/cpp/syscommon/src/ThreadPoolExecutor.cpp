@@ -0,0 +1,382 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "syscommon/concurrent/ThreadPoolExecutor.h"
+
+#include <algorithm>
+#include <limits.h>
+#include "syscommon/util/Deadline.h"
+#include "syscommon/util/StringUtils.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+//----------------------------------------------------------
+//                    STATIC VARIABLES
+//----------------------------------------------------------
+unsigned long ThreadPoolExecutor::POOL_ID_COUNTER = 0;
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+ThreadPoolExecutor::ThreadPoolExecutor( unsigned int poolSize ) :
+	workAvailableEvent( false, TEXT("PoolWorkAvailable") ),
+	spaceAvailableEvent( false, TEXT("PoolSpaceAvailable") )
+{
+	this->_ThreadPoolExecutor( poolSize, DEFAULT_QUEUE_CAPACITY, RP_ABORT );
+}
+
+ThreadPoolExecutor::ThreadPoolExecutor( unsigned int poolSize, size_t queueCapacity ) :
+	workAvailableEvent( false, TEXT("PoolWorkAvailable") ),
+	spaceAvailableEvent( false, TEXT("PoolSpaceAvailable") )
+{
+	this->_ThreadPoolExecutor( poolSize, queueCapacity, RP_ABORT );
+}
+
+ThreadPoolExecutor::ThreadPoolExecutor( unsigned int poolSize,
+										size_t queueCapacity,
+										RejectionPolicy rejectionPolicy ) :
+	workAvailableEvent( false, TEXT("PoolWorkAvailable") ),
+	spaceAvailableEvent( false, TEXT("PoolSpaceAvailable") )
+{
+	this->_ThreadPoolExecutor( poolSize, queueCapacity, rejectionPolicy );
+}
+
+ThreadPoolExecutor::~ThreadPoolExecutor()
+{
+	this->shutdown();
+	this->awaitTermination( NATIVE_INFINITE_WAIT );
+
+	std::vector<Thread*>::iterator it = this->workers.begin();
+	for( ; it != this->workers.end(); ++it )
+		delete *it;
+
+	this->workers.clear();
+}
+
+void ThreadPoolExecutor::_ThreadPoolExecutor( unsigned int poolSize,
+											  size_t queueCapacity,
+											  RejectionPolicy rejectionPolicy )
+{
+	if( poolSize == 0 )
+		throw IllegalArgumentException( TEXT("Pool size must be greater than zero") );
+	if( queueCapacity == 0 )
+		throw IllegalArgumentException( TEXT("Queue capacity must be greater than zero") );
+
+	this->queueCapacity = queueCapacity;
+	this->rejectionPolicy = rejectionPolicy;
+	this->state = PS_RUNNING;
+	this->activeCount = 0;
+	this->idleCount = 0;
+	this->blockedCount = 0;
+	this->completedCount = 0;
+
+	String namePrefix = TEXT("Pool-");
+	namePrefix.append( StringUtils::longToString(POOL_ID_COUNTER++) );
+	namePrefix.append( TEXT("-Worker-") );
+
+	for( unsigned int i = 0 ; i < poolSize ; ++i )
+	{
+		String workerName = namePrefix + StringUtils::longToString( i );
+		Thread* worker = new Thread( this, workerName.c_str() );
+		this->workers.push_back( worker );
+	}
+
+	// Only start the workers once the vector is complete, as they never touch it
+	std::vector<Thread*>::iterator it = this->workers.begin();
+	for( ; it != this->workers.end(); ++it )
+		(*it)->start();
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+void ThreadPoolExecutor::execute( IRunnable* task )
+{
+	Future* future = new Future( task, this, true );
+	try
+	{
+		this->enqueue( future );
+	}
+	catch( RejectedExecutionException& )
+	{
+		delete future;
+		throw;
+	}
+}
+
+Future* ThreadPoolExecutor::submit( IRunnable* task )
+{
+	Future* future = new Future( task, this, false );
+	try
+	{
+		this->enqueue( future );
+	}
+	catch( RejectedExecutionException& )
+	{
+		delete future;
+		throw;
+	}
+
+	return future;
+}
+
+void ThreadPoolExecutor::shutdown()
+{
+	this->queueLock.lock();
+	if( this->state == PS_RUNNING )
+		this->state = PS_SHUTDOWN;
+
+	// Wake idle workers so they can drain the queue and exit, and any blocked submitters so they
+	// can be rejected
+	this->workAvailableEvent.signal();
+	this->spaceAvailableEvent.signal();
+	this->queueLock.unlock();
+}
+
+std::list<IRunnable*> ThreadPoolExecutor::shutdownNow()
+{
+	std::list<IRunnable*> pendingTasks;
+	std::deque<Future*> pendingFutures;
+
+	this->queueLock.lock();
+	this->state = PS_STOPPED;
+	pendingFutures.swap( this->workQueue );
+
+	this->workAvailableEvent.signal();
+	this->spaceAvailableEvent.signal();
+
+	std::vector<Thread*>::iterator it = this->workers.begin();
+	for( ; it != this->workers.end(); ++it )
+		(*it)->interrupt();
+	this->queueLock.unlock();
+
+	std::deque<Future*>::iterator futureIt = pendingFutures.begin();
+	for( ; futureIt != pendingFutures.end(); ++futureIt )
+	{
+		pendingTasks.push_back( (*futureIt)->task );
+		this->discard( *futureIt );
+	}
+
+	return pendingTasks;
+}
+
+bool ThreadPoolExecutor::awaitTermination( unsigned long timeout )
+{
+	Deadline deadline( timeout );
+
+	std::vector<Thread*>::iterator it = this->workers.begin();
+	for( ; it != this->workers.end(); ++it )
+	{
+		if( !(*it)->join(deadline.getRemainingMillis()) )
+			return false;
+	}
+
+	return true;
+}
+
+bool ThreadPoolExecutor::isShutdown() const
+{
+	return this->state != PS_RUNNING;
+}
+
+unsigned int ThreadPoolExecutor::getPoolSize() const
+{
+	return (unsigned int)this->workers.size();
+}
+
+unsigned int ThreadPoolExecutor::getActiveCount()
+{
+	this->queueLock.lock();
+	unsigned int count = this->activeCount;
+	this->queueLock.unlock();
+
+	return count;
+}
+
+size_t ThreadPoolExecutor::getQueueSize()
+{
+	this->queueLock.lock();
+	size_t size = this->workQueue.size();
+	this->queueLock.unlock();
+
+	return size;
+}
+
+unsigned long ThreadPoolExecutor::getCompletedTaskCount()
+{
+	this->queueLock.lock();
+	unsigned long count = this->completedCount;
+	this->queueLock.unlock();
+
+	return count;
+}
+
+void ThreadPoolExecutor::enqueue( Future* future )
+{
+	this->queueLock.lock();
+
+	while( this->state == PS_RUNNING && this->workQueue.size() >= this->queueCapacity )
+	{
+		if( this->rejectionPolicy == RP_CALLER_RUNS )
+		{
+			this->queueLock.unlock();
+
+			// Run the task here, which also throttles the submitting thread
+			bool detached = future->detached;
+			future->start( Thread::currentThread() );
+			future->execute();
+			if( detached )
+				delete future;
+
+			return;
+		}
+		else if( this->rejectionPolicy == RP_DISCARD )
+		{
+			this->queueLock.unlock();
+			this->discard( future );
+			return;
+		}
+		else if( this->rejectionPolicy == RP_DISCARD_OLDEST )
+		{
+			Future* oldest = this->workQueue.front();
+			this->workQueue.pop_front();
+
+			// Cancel outside the queue lock, as the future takes its own lock
+			this->queueLock.unlock();
+			this->discard( oldest );
+			this->queueLock.lock();
+		}
+		else if( this->rejectionPolicy == RP_BLOCK )
+		{
+			// Clearing under the lock means a worker cannot free a slot between our check and
+			// our wait without us seeing the signal
+			++this->blockedCount;
+			this->spaceAvailableEvent.clear();
+			this->queueLock.unlock();
+			this->spaceAvailableEvent.waitFor();
+			this->queueLock.lock();
+			--this->blockedCount;
+		}
+		else
+		{
+			this->queueLock.unlock();
+			throw RejectedExecutionException( TEXT("Work queue is full") );
+		}
+	}
+
+	if( this->state != PS_RUNNING )
+	{
+		this->queueLock.unlock();
+		throw RejectedExecutionException( TEXT("Executor has been shut down") );
+	}
+
+	this->workQueue.push_back( future );
+	if( this->idleCount > 0 )
+		this->workAvailableEvent.signal();
+
+	this->queueLock.unlock();
+}
+
+void ThreadPoolExecutor::remove( Future* future )
+{
+	this->queueLock.lock();
+	std::deque<Future*>::iterator it = std::find( this->workQueue.begin(),
+												  this->workQueue.end(),
+												  future );
+	if( it != this->workQueue.end() )
+	{
+		this->workQueue.erase( it );
+		if( this->blockedCount > 0 )
+			this->spaceAvailableEvent.signal();
+	}
+	this->queueLock.unlock();
+}
+
+Future* ThreadPoolExecutor::takeTask( Thread* worker )
+{
+	Future* started = NULL;
+
+	this->queueLock.lock();
+	while( !started && this->state != PS_STOPPED )
+	{
+		if( !this->workQueue.empty() )
+		{
+			Future* next = this->workQueue.front();
+			this->workQueue.pop_front();
+
+			if( this->blockedCount > 0 )
+				this->spaceAvailableEvent.signal();
+
+			// Discard any interrupt aimed at the previous task before this one can be cancelled.
+			// Futures that were cancelled while queued fail to start and are simply dropped.
+			Thread::interrupted();
+			if( next->start(worker) )
+			{
+				++this->activeCount;
+				started = next;
+			}
+		}
+		else if( this->state == PS_SHUTDOWN )
+		{
+			break;
+		}
+		else
+		{
+			++this->idleCount;
+			this->workAvailableEvent.clear();
+			this->queueLock.unlock();
+			this->workAvailableEvent.waitFor();
+			this->queueLock.lock();
+			--this->idleCount;
+		}
+	}
+	this->queueLock.unlock();
+
+	return started;
+}
+
+void ThreadPoolExecutor::discard( Future* future )
+{
+	bool detached = future->detached;
+	future->cancel( false );
+	if( detached )
+		delete future;
+}
+
+void ThreadPoolExecutor::run()
+{
+	Thread* worker = Thread::currentThread();
+
+	Future* future = this->takeTask( worker );
+	while( future )
+	{
+		// The submitter may delete the future as soon as it has finished, so take what we need
+		// from it up front
+		bool detached = future->detached;
+		future->execute();
+		if( detached )
+			delete future;
+
+		this->queueLock.lock();
+		--this->activeCount;
+		++this->completedCount;
+		this->queueLock.unlock();
+
+		future = this->takeTask( worker );
+	}
+}
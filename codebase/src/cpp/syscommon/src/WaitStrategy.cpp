@@ -0,0 +1,114 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "syscommon/concurrent/WaitStrategy.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+using namespace syscommon;
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+WaitStrategy::WaitStrategy( WaitPolicy policy ) :
+	parked( 0 ),
+	generation( 0 ),
+	parkEvent( false, TEXT("WaitStrategy") )
+{
+	this->policy = policy;
+}
+
+WaitStrategy::~WaitStrategy()
+{
+
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+WaitPolicy WaitStrategy::getPolicy() const
+{
+	return this->policy;
+}
+
+void WaitStrategy::signalParked()
+{
+	// Pairs with the fence in Waiter::park(). Either the waiter sees the change that the caller
+	// has just made when it checks its condition, or we see that it has registered.
+	std::atomic_thread_fence( std::memory_order_seq_cst );
+	if( this->parked.load(std::memory_order_relaxed) > 0 )
+	{
+		this->generation.fetch_add( 1, std::memory_order_seq_cst );
+		this->parkEvent.signal();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////  Waiter  ///////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+WaitStrategy::Waiter::Waiter( WaitStrategy& strategy ) : strategy( strategy )
+{
+	this->attempts = 0;
+	this->registered = false;
+	this->generation = 0;
+}
+
+WaitStrategy::Waiter::~Waiter()
+{
+	if( this->registered )
+		this->strategy.parked.fetch_sub( 1, std::memory_order_relaxed );
+}
+
+void WaitStrategy::Waiter::idle()
+{
+	unsigned int attempt = this->attempts;
+	if( attempt < SPIN_TRIES + YIELD_TRIES )
+		++this->attempts;
+
+	WaitPolicy policy = this->strategy.policy;
+	if( policy == WP_SPIN || attempt < SPIN_TRIES )
+		Platform::spinPause();
+	else if( policy == WP_YIELD || attempt < SPIN_TRIES + YIELD_TRIES )
+		Platform::yieldThread();
+	else
+		this->park();
+}
+
+void WaitStrategy::Waiter::park()
+{
+	if( !this->registered )
+	{
+		// Register, and return so that the caller checks its condition once more before we
+		// actually go to sleep
+		this->generation = this->strategy.generation.load( std::memory_order_relaxed );
+		this->strategy.parked.fetch_add( 1, std::memory_order_relaxed );
+		std::atomic_thread_fence( std::memory_order_seq_cst );
+		this->registered = true;
+		return;
+	}
+
+	// Once the event has been cleared, any signal() that we have not seen yet either shows up in
+	// the generation or leaves the event signaled for us
+	this->strategy.parkEvent.clear();
+	unsigned int current = this->strategy.generation.load( std::memory_order_seq_cst );
+	if( current != this->generation )
+	{
+		this->generation = current;
+		return;
+	}
+
+	this->strategy.parkEvent.waitFor( MAX_PARK_MILLIS );
+}
@@ -0,0 +1,391 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development
+ * and Distribution License (the "License"). You may not use this file except in
+ * compliance with the License. You can obtain a copy of the license at
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License
+ * for the specific language governing permissions and limitations under the
+ * License.
+ *
+ * When distributing Covered Code, include this CDDL HEADER in each file and
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields
+ * enclosed by brackets "[]" replaced with your own identifying information:
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "BlockingQueueTest.h"
+
+#include <limits.h>
+#include <algorithm>
+#include "syscommon/Platform.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+CPPUNIT_TEST_SUITE_REGISTRATION( BlockingQueueTest );
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+BlockingQueueTest::BlockingQueueTest()
+{
+
+}
+
+BlockingQueueTest::~BlockingQueueTest()
+{
+
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+void BlockingQueueTest::setUp()
+{
+
+}
+
+void BlockingQueueTest::tearDown()
+{
+
+}
+
+void BlockingQueueTest::testFifoOrder()
+{
+	syscommon::BlockingQueue<int> queue( 4 );
+
+	// Go round the ring a few times so that the head wraps
+	for( int round = 0 ; round < 3 ; ++round )
+	{
+		for( int i = 0 ; i < 3 ; ++i )
+			queue.put( round * 10 + i );
+
+		CPPUNIT_ASSERT_EQUAL( (size_t)3, queue.size() );
+		for( int i = 0 ; i < 3 ; ++i )
+			CPPUNIT_ASSERT_EQUAL( round * 10 + i, queue.take() );
+	}
+
+	CPPUNIT_ASSERT( queue.isEmpty() );
+}
+
+void BlockingQueueTest::testCapacity()
+{
+	try
+	{
+		syscommon::BlockingQueue<int> queue( 0 );
+		failTestMissingException( "IllegalArgumentException", "creating a queue with no capacity" );
+	}
+	catch( syscommon::IllegalArgumentException& )
+	{
+		// Expected
+	}
+
+	syscommon::BlockingQueue<int> queue( 2 );
+	CPPUNIT_ASSERT_EQUAL( (size_t)2, queue.getCapacity() );
+	CPPUNIT_ASSERT_EQUAL( (size_t)2, queue.remainingCapacity() );
+
+	CPPUNIT_ASSERT( queue.offer(1) );
+	CPPUNIT_ASSERT( queue.offer(2) );
+	CPPUNIT_ASSERT( !queue.offer(3) );
+	CPPUNIT_ASSERT_EQUAL( (size_t)0, queue.remainingCapacity() );
+
+	int value = 0;
+	CPPUNIT_ASSERT( queue.poll(value) );
+	CPPUNIT_ASSERT_EQUAL( 1, value );
+	CPPUNIT_ASSERT( queue.offer(3) );
+	CPPUNIT_ASSERT( queue.poll(value) );
+	CPPUNIT_ASSERT_EQUAL( 2, value );
+	CPPUNIT_ASSERT( queue.poll(value) );
+	CPPUNIT_ASSERT_EQUAL( 3, value );
+	CPPUNIT_ASSERT( !queue.poll(value) );
+}
+
+void BlockingQueueTest::testTimedOfferAndPoll()
+{
+	syscommon::BlockingQueue<int> queue( 1 );
+	int value = 0;
+
+	unsigned long start = syscommon::Platform::getCurrentTimeMilliseconds();
+	CPPUNIT_ASSERT( !queue.poll(value, 150UL) );
+	unsigned long elapsed = syscommon::Platform::getCurrentTimeMilliseconds() - start;
+	if( elapsed < 140 )
+		failTest( "poll() gave up after %lums, expected at least 150ms", elapsed );
+
+	CPPUNIT_ASSERT( queue.offer(1, 0UL) );
+
+	start = syscommon::Platform::getCurrentTimeMilliseconds();
+	CPPUNIT_ASSERT( !queue.offer(2, 150UL) );
+	elapsed = syscommon::Platform::getCurrentTimeMilliseconds() - start;
+	if( elapsed < 140 )
+		failTest( "offer() gave up after %lums, expected at least 150ms", elapsed );
+
+	CPPUNIT_ASSERT( queue.poll(value, 0UL) );
+	CPPUNIT_ASSERT_EQUAL( 1, value );
+}
+
+void BlockingQueueTest::testBlockingPutAndTake()
+{
+	syscommon::BlockingQueue<int> queue( 1 );
+
+	// A taker on an empty queue blocks until something is put
+	QueueOperationRunnable taker( &queue, false, 0 );
+	syscommon::Thread takeThread( &taker );
+	takeThread.start();
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_TIMEOUT, taker.waitForFinished(100) );
+	queue.put( 42 );
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_SUCCEEDED, taker.waitForFinished(5000) );
+	takeThread.join();
+	CPPUNIT_ASSERT( taker.completed );
+	CPPUNIT_ASSERT_EQUAL( 42, taker.value );
+
+	// A putter on a full queue blocks until something is taken
+	queue.put( 1 );
+	QueueOperationRunnable putter( &queue, true, 2 );
+	syscommon::Thread putThread( &putter );
+	putThread.start();
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_TIMEOUT, putter.waitForFinished(100) );
+	CPPUNIT_ASSERT_EQUAL( 1, queue.take() );
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_SUCCEEDED, putter.waitForFinished(5000) );
+	putThread.join();
+	CPPUNIT_ASSERT( putter.completed );
+	CPPUNIT_ASSERT_EQUAL( 2, queue.take() );
+}
+
+void BlockingQueueTest::testInterruptedTake()
+{
+	syscommon::BlockingQueue<int> queue( 1 );
+	QueueOperationRunnable taker( &queue, false, 0 );
+	syscommon::Thread thread( &taker );
+	thread.start();
+
+	// Let the thread block in take(), then interrupt it
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_TIMEOUT, taker.waitForFinished(100) );
+	thread.interrupt();
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_SUCCEEDED, taker.waitForFinished(5000) );
+	thread.join();
+
+	CPPUNIT_ASSERT( taker.interrupted );
+	CPPUNIT_ASSERT( !taker.completed );
+
+	// The interrupted take should not have consumed anything
+	queue.put( 7 );
+	CPPUNIT_ASSERT_EQUAL( (size_t)1, queue.size() );
+	CPPUNIT_ASSERT_EQUAL( 7, queue.take() );
+}
+
+void BlockingQueueTest::testInterruptedPut()
+{
+	syscommon::BlockingQueue<int> queue( 1 );
+	queue.put( 1 );
+
+	QueueOperationRunnable putter( &queue, true, 2 );
+	syscommon::Thread thread( &putter );
+	thread.start();
+
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_TIMEOUT, putter.waitForFinished(100) );
+	thread.interrupt();
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_SUCCEEDED, putter.waitForFinished(5000) );
+	thread.join();
+
+	CPPUNIT_ASSERT( putter.interrupted );
+	CPPUNIT_ASSERT( !putter.completed );
+
+	// The queue should still hold only the original element, and have room once it is taken
+	CPPUNIT_ASSERT_EQUAL( 1, queue.take() );
+	CPPUNIT_ASSERT( queue.isEmpty() );
+	CPPUNIT_ASSERT( queue.offer(3) );
+}
+
+void BlockingQueueTest::testDrainTo()
+{
+	syscommon::BlockingQueue<int> queue( 8 );
+	std::vector<int> batch;
+
+	CPPUNIT_ASSERT_EQUAL( (size_t)0, queue.drainTo(batch, 4) );
+	CPPUNIT_ASSERT_EQUAL( (size_t)0, queue.drainTo(batch, 4, 50UL) );
+	CPPUNIT_ASSERT( batch.empty() );
+
+	for( int i = 0 ; i < 6 ; ++i )
+		queue.put( i );
+
+	// Drained elements are appended in order, up to the maximum requested
+	batch.push_back( -1 );
+	CPPUNIT_ASSERT_EQUAL( (size_t)4, queue.drainTo(batch, 4) );
+	CPPUNIT_ASSERT_EQUAL( (size_t)5, batch.size() );
+	CPPUNIT_ASSERT_EQUAL( -1, batch[0] );
+	for( int i = 0 ; i < 4 ; ++i )
+		CPPUNIT_ASSERT_EQUAL( i, batch[i + 1] );
+
+	// The space freed by the drain is available to producers again
+	CPPUNIT_ASSERT_EQUAL( (size_t)6, queue.remainingCapacity() );
+	for( int i = 6 ; i < 12 ; ++i )
+		CPPUNIT_ASSERT( queue.offer(i) );
+	CPPUNIT_ASSERT( !queue.offer(12) );
+
+	batch.clear();
+	CPPUNIT_ASSERT_EQUAL( (size_t)8, queue.drainTo(batch, 100, NATIVE_INFINITE_WAIT) );
+	for( int i = 0 ; i < 8 ; ++i )
+		CPPUNIT_ASSERT_EQUAL( i + 4, batch[i] );
+	CPPUNIT_ASSERT( queue.isEmpty() );
+}
+
+void BlockingQueueTest::testMultipleProducersAndConsumers()
+{
+	const int PRODUCERS = 4;
+	const int CONSUMERS = 2;
+	const int PER_PRODUCER = 20000;
+
+	syscommon::BlockingQueue<int> queue( 64 );
+
+	std::vector<QueueProducerRunnable*> producers;
+	std::vector<QueueConsumerRunnable*> consumers;
+	std::vector<syscommon::Thread*> producerThreads;
+	std::vector<syscommon::Thread*> consumerThreads;
+
+	for( int i = 0 ; i < CONSUMERS ; ++i )
+	{
+		consumers.push_back( new QueueConsumerRunnable(&queue) );
+		consumerThreads.push_back( new syscommon::Thread(consumers[i]) );
+		consumerThreads[i]->start();
+	}
+
+	for( int i = 0 ; i < PRODUCERS ; ++i )
+	{
+		producers.push_back( new QueueProducerRunnable(&queue, i * PER_PRODUCER, PER_PRODUCER) );
+		producerThreads.push_back( new syscommon::Thread(producers[i]) );
+		producerThreads[i]->start();
+	}
+
+	for( int i = 0 ; i < PRODUCERS ; ++i )
+		producerThreads[i]->join();
+
+	// One stop marker per consumer
+	for( int i = 0 ; i < CONSUMERS ; ++i )
+		queue.put( -1 );
+
+	for( int i = 0 ; i < CONSUMERS ; ++i )
+		consumerThreads[i]->join();
+
+	// Every value should have been consumed exactly once, and each consumer should have seen
+	// each producer's values in the order they were put
+	std::vector<int> all;
+	for( int i = 0 ; i < CONSUMERS ; ++i )
+	{
+		std::vector<int> lastSeen( PRODUCERS, -1 );
+		const std::vector<int>& consumed = consumers[i]->consumed;
+		for( size_t j = 0 ; j < consumed.size() ; ++j )
+		{
+			int producer = consumed[j] / PER_PRODUCER;
+			CPPUNIT_ASSERT( consumed[j] > lastSeen[producer] );
+			lastSeen[producer] = consumed[j];
+		}
+
+		all.insert( all.end(), consumed.begin(), consumed.end() );
+	}
+
+	std::sort( all.begin(), all.end() );
+	CPPUNIT_ASSERT_EQUAL( (size_t)(PRODUCERS * PER_PRODUCER), all.size() );
+	for( size_t i = 0 ; i < all.size() ; ++i )
+		CPPUNIT_ASSERT_EQUAL( (int)i, all[i] );
+	CPPUNIT_ASSERT( queue.isEmpty() );
+
+	for( int i = 0 ; i < PRODUCERS ; ++i )
+	{
+		delete producerThreads[i];
+		delete producers[i];
+	}
+
+	for( int i = 0 ; i < CONSUMERS ; ++i )
+	{
+		delete consumerThreads[i];
+		delete consumers[i];
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////  QueueOperationRunnable  //////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+QueueOperationRunnable::QueueOperationRunnable( syscommon::BlockingQueue<int>* queue,
+                                                bool putting,
+                                                int value ) :
+		finishedEvent(false, TEXT("finished"))
+{
+	this->queue = queue;
+	this->putting = putting;
+	this->value = value;
+	this->completed = false;
+	this->interrupted = false;
+}
+
+void QueueOperationRunnable::run()
+{
+	try
+	{
+		if( this->putting )
+			this->queue->put( this->value );
+		else
+			this->value = this->queue->take();
+
+		this->completed = true;
+	}
+	catch( syscommon::InterruptedException& )
+	{
+		this->interrupted = true;
+	}
+
+	this->finishedEvent.signal();
+}
+
+syscommon::WaitResult QueueOperationRunnable::waitForFinished( unsigned long timeout )
+{
+	return this->finishedEvent.waitFor( timeout );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////  QueueProducerRunnable  ///////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+QueueProducerRunnable::QueueProducerRunnable( syscommon::BlockingQueue<int>* queue,
+                                              int first,
+                                              int count )
+{
+	this->queue = queue;
+	this->first = first;
+	this->count = count;
+}
+
+void QueueProducerRunnable::run()
+{
+	for( int i = 0 ; i < this->count ; ++i )
+		this->queue->put( this->first + i );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////  QueueConsumerRunnable  ///////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+QueueConsumerRunnable::QueueConsumerRunnable( syscommon::BlockingQueue<int>* queue )
+{
+	this->queue = queue;
+}
+
+void QueueConsumerRunnable::run()
+{
+	std::vector<int> batch;
+	while( true )
+	{
+		batch.clear();
+		this->queue->drainTo( batch, 32, NATIVE_INFINITE_WAIT );
+
+		for( size_t i = 0 ; i < batch.size() ; ++i )
+		{
+			if( batch[i] < 0 )
+			{
+				// Hand back anything behind the stop marker for the other consumers
+				for( size_t j = i + 1 ; j < batch.size() ; ++j )
+					this->queue->put( batch[j] );
+				return;
+			}
+
+			this->consumed.push_back( batch[i] );
+		}
+	}
+}
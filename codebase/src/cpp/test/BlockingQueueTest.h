@@ -0,0 +1,117 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development
+ * and Distribution License (the "License"). You may not use this file except in
+ * compliance with the License. You can obtain a copy of the license at
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License
+ * for the specific language governing permissions and limitations under the
+ * License.
+ *
+ * When distributing Covered Code, include this CDDL HEADER in each file and
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields
+ * enclosed by brackets "[]" replaced with your own identifying information:
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <vector>
+
+#include "Common.h"
+#include "syscommon/concurrent/BlockingQueue.h"
+#include "syscommon/concurrent/Event.h"
+#include "syscommon/concurrent/Thread.h"
+
+class BlockingQueueTest: public CppUnit::TestFixture
+{
+	//----------------------------------------------------------
+	//                    STATIC VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                   INSTANCE VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                      CONSTRUCTORS
+	//----------------------------------------------------------
+	public:
+		BlockingQueueTest();
+		virtual ~BlockingQueueTest();
+
+	//----------------------------------------------------------
+	//                    INSTANCE METHODS
+	//----------------------------------------------------------
+	public:
+		void setUp();
+		void tearDown();
+
+	protected:
+		void testFifoOrder();
+		void testCapacity();
+		void testTimedOfferAndPoll();
+		void testBlockingPutAndTake();
+		void testInterruptedTake();
+		void testInterruptedPut();
+		void testDrainTo();
+		void testMultipleProducersAndConsumers();
+
+	//----------------------------------------------------------
+	//                     STATIC METHODS
+	//----------------------------------------------------------
+	CPPUNIT_TEST_SUITE( BlockingQueueTest );
+		CPPUNIT_TEST( testFifoOrder );
+		CPPUNIT_TEST( testCapacity );
+		CPPUNIT_TEST( testTimedOfferAndPoll );
+		CPPUNIT_TEST( testBlockingPutAndTake );
+		CPPUNIT_TEST( testInterruptedTake );
+		CPPUNIT_TEST( testInterruptedPut );
+		CPPUNIT_TEST( testDrainTo );
+		CPPUNIT_TEST( testMultipleProducersAndConsumers );
+	CPPUNIT_TEST_SUITE_END();
+};
+
+// QueueOperationRunnable helper class, makes a single blocking put() or take() and records how
+// it ended
+class QueueOperationRunnable : public syscommon::IRunnable
+{
+	private:
+		syscommon::BlockingQueue<int>* queue;
+		bool putting;
+		syscommon::Event finishedEvent;
+
+	public:
+		int value;
+		volatile bool completed;
+		volatile bool interrupted;
+
+		QueueOperationRunnable( syscommon::BlockingQueue<int>* queue, bool putting, int value );
+		virtual void run();
+		syscommon::WaitResult waitForFinished( unsigned long timeout );
+};
+
+// QueueProducerRunnable helper class, puts a range of values on a queue
+class QueueProducerRunnable : public syscommon::IRunnable
+{
+	private:
+		syscommon::BlockingQueue<int>* queue;
+		int first;
+		int count;
+
+	public:
+		QueueProducerRunnable( syscommon::BlockingQueue<int>* queue, int first, int count );
+		virtual void run();
+};
+
+// QueueConsumerRunnable helper class, drains a queue in batches until it takes a negative value
+class QueueConsumerRunnable : public syscommon::IRunnable
+{
+	private:
+		syscommon::BlockingQueue<int>* queue;
+
+	public:
+		std::vector<int> consumed;
+
+		QueueConsumerRunnable( syscommon::BlockingQueue<int>* queue );
+		virtual void run();
+};
@@ -0,0 +1,536 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development
+ * and Distribution License (the "License"). You may not use this file except in
+ * compliance with the License. You can obtain a copy of the license at
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License
+ * for the specific language governing permissions and limitations under the
+ * License.
+ *
+ * When distributing Covered Code, include this CDDL HEADER in each file and
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields
+ * enclosed by brackets "[]" replaced with your own identifying information:
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "CompletionEngineTest.h"
+
+#include <string.h>
+#include "syscommon/util/Stopwatch.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+CPPUNIT_TEST_SUITE_REGISTRATION( CompletionEngineTest );
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+CompletionEngineTest::CompletionEngineTest()
+{
+	this->server = NULL;
+	this->client = NULL;
+	this->accepted = NULL;
+	this->engine = NULL;
+}
+
+CompletionEngineTest::~CompletionEngineTest()
+{
+
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+void CompletionEngineTest::setUp()
+{
+	this->server = new syscommon::ServerSocket();
+	this->server->bind( syscommon::InetSocketAddress(INADDR_LOOPBACK, 0) );
+	this->engine = new syscommon::CompletionEngine();
+}
+
+void CompletionEngineTest::tearDown()
+{
+	delete this->engine;
+	delete this->accepted;
+	delete this->client;
+	delete this->server;
+
+	this->engine = NULL;
+	this->accepted = NULL;
+	this->client = NULL;
+	this->server = NULL;
+}
+
+void CompletionEngineTest::connectClient()
+{
+	this->client = new syscommon::Socket( INADDR_LOOPBACK, this->server->getLocalPort() );
+	this->accepted = this->server->accept();
+}
+
+void CompletionEngineTest::testAcceptSendReceive()
+{
+	// The connection is waiting before anything is submitted, so that the blocking fallback
+	// does not block
+	this->client = new syscommon::Socket( INADDR_LOOPBACK, this->server->getLocalPort() );
+
+	int marker = 0;
+	syscommon::AsyncOperation* acceptOperation =
+		this->server->acceptAsync( *this->engine, NULL, &marker );
+	CPPUNIT_ASSERT( acceptOperation->getType() == syscommon::AO_ACCEPT );
+	CPPUNIT_ASSERT( acceptOperation->getServerSocket() == this->server );
+	CPPUNIT_ASSERT( acceptOperation->getAttachment() == &marker );
+	CPPUNIT_ASSERT( !acceptOperation->isDone() );
+	CPPUNIT_ASSERT( this->engine->getPendingCount() == 1 );
+
+	CPPUNIT_ASSERT( this->engine->waitFor(acceptOperation, 5000) );
+	CPPUNIT_ASSERT( acceptOperation->isDone() );
+	if( acceptOperation->isFailed() )
+		failTest( "Accept failed: %s", acceptOperation->getError() );
+
+	this->accepted = acceptOperation->takeAcceptedSocket();
+	CPPUNIT_ASSERT( this->accepted != NULL );
+	CPPUNIT_ASSERT( acceptOperation->takeAcceptedSocket() == NULL );
+	CPPUNIT_ASSERT( this->accepted->isConnected() );
+	CPPUNIT_ASSERT( this->accepted->getInetAddress() == INADDR_LOOPBACK );
+	delete acceptOperation;
+
+	// Send from the accepted socket
+	syscommon::AsyncOperation* sendOperation =
+		this->accepted->sendAsync( *this->engine, "ping", 4, NULL, NULL );
+	CPPUNIT_ASSERT( this->engine->waitFor(sendOperation, 5000) );
+	CPPUNIT_ASSERT( !sendOperation->isFailed() );
+	CPPUNIT_ASSERT( sendOperation->getResult() == 4 );
+	delete sendOperation;
+
+	char buffer[64];
+	CPPUNIT_ASSERT( this->client->receive(buffer, sizeof(buffer)) == 4 );
+	CPPUNIT_ASSERT( ::memcmp(buffer, "ping", 4) == 0 );
+
+	// And receive on it
+	this->client->send( "pong", 4 );
+	::memset( buffer, 0, sizeof(buffer) );
+	syscommon::AsyncOperation* receiveOperation =
+		this->accepted->receiveAsync( *this->engine, buffer, sizeof(buffer), NULL, NULL );
+	CPPUNIT_ASSERT( this->engine->waitFor(receiveOperation, 5000) );
+	CPPUNIT_ASSERT( !receiveOperation->isFailed() );
+	CPPUNIT_ASSERT( receiveOperation->getResult() == 4 );
+	CPPUNIT_ASSERT( receiveOperation->getBuffer() == buffer );
+	CPPUNIT_ASSERT( ::memcmp(buffer, "pong", 4) == 0 );
+	delete receiveOperation;
+
+	// A closed connection receives nothing
+	this->client->close();
+	receiveOperation = this->accepted->receiveAsync( *this->engine, buffer, sizeof(buffer), NULL, NULL );
+	CPPUNIT_ASSERT( this->engine->waitFor(receiveOperation, 5000) );
+	CPPUNIT_ASSERT( !receiveOperation->isFailed() );
+	CPPUNIT_ASSERT( receiveOperation->getResult() == 0 );
+	delete receiveOperation;
+
+	CPPUNIT_ASSERT( this->engine->getPendingCount() == 0 );
+}
+
+void CompletionEngineTest::testCompletionHandler()
+{
+	this->connectClient();
+	RecordingCompletionHandler handler( this->engine, 0 );
+
+	// A batch of sends, submitted together
+	for( int i = 0; i < 8; ++i )
+		this->engine->send( this->accepted, "12345678", 8, &handler, NULL );
+
+	CPPUNIT_ASSERT( this->engine->getPendingCount() == 8 );
+	CPPUNIT_ASSERT( this->engine->submit() == 8 );
+	for( int i = 0; i < 100 && handler.calls < 8; ++i )
+		this->engine->poll( 50 );
+
+	CPPUNIT_ASSERT( handler.calls == 8 );
+	CPPUNIT_ASSERT( handler.failures == 0 );
+	CPPUNIT_ASSERT( handler.sent == 64 );
+	CPPUNIT_ASSERT( this->engine->getPendingCount() == 0 );
+
+	// With nothing in progress, only a wakeup ends the wait early
+	this->engine->wakeup();
+	syscommon::Stopwatch stopwatch;
+	stopwatch.start();
+	CPPUNIT_ASSERT( this->engine->poll(5000) == 0 );
+	CPPUNIT_ASSERT( stopwatch.getElapsedNanos() < 1000000000LL );
+
+	char buffer[64];
+	int received = 0;
+	while( received < 64 )
+		received += this->client->receive( buffer + received, sizeof(buffer) - received );
+	CPPUNIT_ASSERT( ::memcmp(buffer, "1234567812345678", 16) == 0 );
+}
+
+void CompletionEngineTest::testFixedBuffers()
+{
+	this->connectClient();
+	this->engine->registerBuffers( 64, 4 );
+	CPPUNIT_ASSERT( this->engine->getFixedBufferSize() == 64 );
+	CPPUNIT_ASSERT( this->engine->getFixedBufferCount() == 4 );
+	CPPUNIT_ASSERT( this->engine->getFixedBuffer(1) == this->engine->getFixedBuffer(0) + 64 );
+
+	::memcpy( this->engine->getFixedBuffer(1), "fixed", 5 );
+	syscommon::AsyncOperation* sendOperation =
+		this->engine->sendFixed( this->client, 1, 5, NULL, NULL );
+	CPPUNIT_ASSERT( this->engine->waitFor(sendOperation, 5000) );
+	if( sendOperation->isFailed() )
+		failTest( "Fixed send failed: %s", sendOperation->getError() );
+	CPPUNIT_ASSERT( sendOperation->getResult() == 5 );
+	delete sendOperation;
+
+	char buffer[64];
+	CPPUNIT_ASSERT( this->accepted->receive(buffer, sizeof(buffer)) == 5 );
+	CPPUNIT_ASSERT( ::memcmp(buffer, "fixed", 5) == 0 );
+
+	this->accepted->send( "registered", 10 );
+	syscommon::AsyncOperation* receiveOperation =
+		this->engine->receiveFixed( this->client, 2, 64, NULL, NULL );
+	CPPUNIT_ASSERT( this->engine->waitFor(receiveOperation, 5000) );
+	if( receiveOperation->isFailed() )
+		failTest( "Fixed receive failed: %s", receiveOperation->getError() );
+	CPPUNIT_ASSERT( receiveOperation->getResult() == 10 );
+	CPPUNIT_ASSERT( receiveOperation->getBuffer() == this->engine->getFixedBuffer(2) );
+	CPPUNIT_ASSERT( ::memcmp(this->engine->getFixedBuffer(2), "registered", 10) == 0 );
+	delete receiveOperation;
+
+	try
+	{
+		this->engine->receiveFixed( this->client, 4, 64, NULL, NULL );
+		failTestMissingException( "IllegalArgumentException", "receiving into a missing buffer" );
+	}
+	catch( syscommon::IllegalArgumentException& )
+	{
+		// Expected
+	}
+
+	try
+	{
+		this->engine->sendFixed( this->client, 0, 65, NULL, NULL );
+		failTestMissingException( "IllegalArgumentException", "sending more than a buffer holds" );
+	}
+	catch( syscommon::IllegalArgumentException& )
+	{
+		// Expected
+	}
+
+	try
+	{
+		this->engine->registerBuffers( 64, 4 );
+		failTestMissingException( "IllegalStateException", "registering buffers twice" );
+	}
+	catch( syscommon::IllegalStateException& )
+	{
+		// Expected
+	}
+}
+
+void CompletionEngineTest::testMultishotAccept()
+{
+	syscommon::Socket* clients[3];
+	for( int i = 0; i < 3; ++i )
+		clients[i] = new syscommon::Socket( INADDR_LOOPBACK, this->server->getLocalPort() );
+
+	RecordingCompletionHandler handler( this->engine, 3 );
+	syscommon::AsyncOperation* operation = this->engine->acceptMultishot( this->server, &handler, NULL );
+	CPPUNIT_ASSERT( operation->isMultishot() );
+	for( int i = 0; i < 100 && handler.accepted.size() < 3; ++i )
+		this->engine->poll( 50 );
+
+	CPPUNIT_ASSERT( handler.accepted.size() == 3 );
+	CPPUNIT_ASSERT( handler.failures == 0 );
+	for( size_t i = 0; i < handler.accepted.size(); ++i )
+		CPPUNIT_ASSERT( handler.accepted[i]->isConnected() );
+
+	// One connection for each of the clients
+	CPPUNIT_ASSERT( handler.accepted[0]->getPort() != handler.accepted[1]->getPort() );
+	CPPUNIT_ASSERT( handler.accepted[1]->getPort() != handler.accepted[2]->getPort() );
+	CPPUNIT_ASSERT( handler.accepted[0]->getPort() != handler.accepted[2]->getPort() );
+
+	for( int i = 0; i < 3; ++i )
+		delete clients[i];
+}
+
+void CompletionEngineTest::testMultishotReceive()
+{
+	this->connectClient();
+	char data[200];
+	RecordingCompletionHandler handler( this->engine, sizeof(data) );
+	try
+	{
+		this->engine->receiveMultishot( this->accepted, &handler, NULL );
+		failTestMissingException( "IllegalStateException", "receiving without provided buffers" );
+	}
+	catch( syscommon::IllegalStateException& )
+	{
+		// Expected
+	}
+
+	// Far less buffer space than the data needs, so buffers have to be handed back and reused
+	this->engine->provideBuffers( 16, 4 );
+
+	for( size_t i = 0; i < sizeof(data); ++i )
+		data[i] = (char)('a' + i % 26);
+
+	int sent = 0;
+	while( sent < (int)sizeof(data) )
+		sent += this->client->send( data + sent, sizeof(data) - sent );
+
+	this->engine->receiveMultishot( this->accepted, &handler, NULL );
+	for( int i = 0; i < 100 && handler.received.size() < sizeof(data); ++i )
+		this->engine->poll( 50 );
+
+	CPPUNIT_ASSERT( handler.received.size() == sizeof(data) );
+	CPPUNIT_ASSERT( ::memcmp(handler.received.data(), data, sizeof(data)) == 0 );
+	CPPUNIT_ASSERT( handler.calls >= (int)(sizeof(data) / 16) );
+
+	// A multishot receive keeps going until the connection closes, where the kernel supports it
+	if( this->engine->isNative() )
+	{
+		this->client->send( "more", 4 );
+		for( int i = 0; i < 100 && handler.received.size() < sizeof(data) + 4; ++i )
+			this->engine->poll( 50 );
+
+		CPPUNIT_ASSERT( handler.received.size() == sizeof(data) + 4 );
+		this->client->close();
+		for( int i = 0; i < 100 && !handler.closed; ++i )
+			this->engine->poll( 50 );
+
+		CPPUNIT_ASSERT( handler.closed );
+		CPPUNIT_ASSERT( this->engine->getPendingCount() == 0 );
+	}
+}
+
+void CompletionEngineTest::testMulticastSocket()
+{
+	syscommon::MulticastSocket receiver( syscommon::InetSocketAddress(INADDR_ANY, 3036) );
+	syscommon::MulticastSocket sender( syscommon::InetSocketAddress(INADDR_ANY, 0) );
+
+	char sendBuffer[] = "datagram";
+	syscommon::InetSocketAddress destination( INADDR_LOOPBACK, 3036 );
+	syscommon::DatagramPacket sendPacket( sendBuffer, 0, sizeof(sendBuffer), destination );
+	syscommon::AsyncOperation* sendOperation =
+		sender.sendAsync( *this->engine, sendPacket, NULL, NULL );
+	CPPUNIT_ASSERT( sendOperation->getPacket() == &sendPacket );
+	CPPUNIT_ASSERT( this->engine->waitFor(sendOperation, 5000) );
+	if( sendOperation->isFailed() )
+		failTest( "Datagram send failed: %s", sendOperation->getError() );
+	delete sendOperation;
+
+	char receiveBuffer[64];
+	syscommon::DatagramPacket receivePacket( receiveBuffer, sizeof(receiveBuffer) );
+	syscommon::AsyncOperation* receiveOperation =
+		receiver.receiveAsync( *this->engine, receivePacket, NULL, NULL );
+	CPPUNIT_ASSERT( this->engine->waitFor(receiveOperation, 5000) );
+	if( receiveOperation->isFailed() )
+		failTest( "Datagram receive failed: %s", receiveOperation->getError() );
+	CPPUNIT_ASSERT( receiveOperation->getResult() == (int)sizeof(sendBuffer) );
+	CPPUNIT_ASSERT( receivePacket.getLength() == (int)sizeof(sendBuffer) );
+	CPPUNIT_ASSERT( receivePacket.getAddress() == INADDR_LOOPBACK );
+	CPPUNIT_ASSERT( ::memcmp(sendBuffer, receiveBuffer, sizeof(sendBuffer)) == 0 );
+	delete receiveOperation;
+
+	receiver.close();
+	sender.close();
+}
+
+void CompletionEngineTest::testCancel()
+{
+	this->connectClient();
+
+	// Nothing is ever sent, so only cancelling it can end the receive
+	char buffer[64];
+	syscommon::AsyncOperation* operation =
+		this->engine->receive( this->accepted, buffer, sizeof(buffer), NULL, NULL );
+	CPPUNIT_ASSERT( this->engine->cancel(operation) );
+	CPPUNIT_ASSERT( this->engine->waitFor(operation, 5000) );
+	CPPUNIT_ASSERT( operation->isFailed() );
+	CPPUNIT_ASSERT( operation->isCancelled() );
+	CPPUNIT_ASSERT( ::strlen(operation->getError()) > 0 );
+	CPPUNIT_ASSERT( !this->engine->cancel(operation) );
+	CPPUNIT_ASSERT( this->engine->getPendingCount() == 0 );
+	delete operation;
+
+	// The connection is still usable
+	this->client->send( "after", 5 );
+	operation = this->engine->receive( this->accepted, buffer, sizeof(buffer), NULL, NULL );
+	CPPUNIT_ASSERT( this->engine->waitFor(operation, 5000) );
+	CPPUNIT_ASSERT( !operation->isCancelled() );
+	CPPUNIT_ASSERT( operation->getResult() == 5 );
+	delete operation;
+}
+
+void CompletionEngineTest::testClose()
+{
+	this->connectClient();
+	RecordingCompletionHandler handler( this->engine, 0 );
+
+	char buffer[64];
+	char otherBuffer[64];
+	syscommon::AsyncOperation* operation =
+		this->engine->receive( this->accepted, buffer, sizeof(buffer), NULL, NULL );
+	this->engine->receive( this->accepted, otherBuffer, sizeof(otherBuffer), &handler, NULL );
+	CPPUNIT_ASSERT( this->engine->getPendingCount() == 2 );
+
+	// The handler is not told, and the caller's operation is given up on
+	this->engine->close();
+	CPPUNIT_ASSERT( !this->engine->isOpen() );
+	CPPUNIT_ASSERT( this->engine->getPendingCount() == 0 );
+	CPPUNIT_ASSERT( handler.calls == 0 );
+	CPPUNIT_ASSERT( operation->isDone() );
+	CPPUNIT_ASSERT( operation->isFailed() );
+	delete operation;
+
+	try
+	{
+		this->engine->receive( this->accepted, buffer, sizeof(buffer), NULL, NULL );
+		failTestMissingException( "IllegalStateException", "receiving through a closed engine" );
+	}
+	catch( syscommon::IllegalStateException& )
+	{
+		// Expected
+	}
+
+	// Closing twice has no effect
+	this->engine->close();
+}
+
+void CompletionEngineTest::testInvalidArguments()
+{
+	syscommon::Socket unconnected;
+	char buffer[64];
+	try
+	{
+		this->engine->receive( &unconnected, buffer, sizeof(buffer), NULL, NULL );
+		failTestMissingException( "SocketException", "receiving on an unconnected socket" );
+	}
+	catch( syscommon::SocketException& )
+	{
+		// Expected
+	}
+
+	try
+	{
+		this->engine->receive( (syscommon::Socket*)NULL, buffer, sizeof(buffer), NULL, NULL );
+		failTestMissingException( "IllegalArgumentException", "receiving on a NULL socket" );
+	}
+	catch( syscommon::IllegalArgumentException& )
+	{
+		// Expected
+	}
+
+	try
+	{
+		this->engine->acceptMultishot( this->server, NULL, NULL );
+		failTestMissingException( "IllegalArgumentException", "a multishot accept without a handler" );
+	}
+	catch( syscommon::IllegalArgumentException& )
+	{
+		// Expected
+	}
+
+	syscommon::ServerSocket unbound;
+	try
+	{
+		this->engine->accept( &unbound, NULL, NULL );
+		failTestMissingException( "SocketException", "accepting on an unbound socket" );
+	}
+	catch( syscommon::SocketException& )
+	{
+		// Expected
+	}
+
+	// Operations with a handler belong to the engine, so cannot be waited for
+	this->connectClient();
+	RecordingCompletionHandler handler( this->engine, 0 );
+	syscommon::AsyncOperation* operation = this->engine->send( this->accepted, "x", 1, &handler, NULL );
+	try
+	{
+		this->engine->waitFor( operation, 5000 );
+		failTestMissingException( "IllegalArgumentException", "waiting for a handled operation" );
+	}
+	catch( syscommon::IllegalArgumentException& )
+	{
+		// Expected
+	}
+
+	for( int i = 0; i < 100 && handler.calls < 1; ++i )
+		this->engine->poll( 50 );
+
+	CPPUNIT_ASSERT( handler.calls == 1 );
+	CPPUNIT_ASSERT( this->engine->getPendingCount() == 0 );
+
+	try
+	{
+		syscommon::CompletionEngine( 0 );
+		failTestMissingException( "IllegalArgumentException", "creating an engine with no queue" );
+	}
+	catch( syscommon::IllegalArgumentException& )
+	{
+		// Expected
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+////////////////////////  RecordingCompletionHandler  /////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+RecordingCompletionHandler::RecordingCompletionHandler( syscommon::CompletionEngine* engine,
+                                                        size_t expected )
+{
+	this->engine = engine;
+	this->expected = expected;
+	this->calls = 0;
+	this->failures = 0;
+	this->sent = 0;
+	this->closed = false;
+}
+
+RecordingCompletionHandler::~RecordingCompletionHandler()
+{
+	for( size_t i = 0; i < this->accepted.size(); ++i )
+		delete this->accepted[i];
+}
+
+void RecordingCompletionHandler::completed( syscommon::AsyncOperation& operation )
+{
+	++this->calls;
+	if( operation.isFailed() )
+		++this->failures;
+
+	switch( operation.getType() )
+	{
+		case syscommon::AO_ACCEPT:
+		{
+			syscommon::Socket* socket = operation.takeAcceptedSocket();
+			if( socket )
+				this->accepted.push_back( socket );
+
+			if( !operation.hasMore() && this->accepted.size() < this->expected )
+				this->engine->acceptMultishot( operation.getServerSocket(), this, NULL );
+			break;
+		}
+
+		case syscommon::AO_RECEIVE:
+		{
+			if( !operation.isFailed() && operation.getResult() == 0 )
+				this->closed = true;
+			else if( !operation.isFailed() )
+				this->received.append( operation.getBuffer(), operation.getResult() );
+
+			// Multishot receives end early when the provided buffers run out
+			if( operation.isMultishot() &&
+			    !operation.hasMore() &&
+			    !this->closed &&
+			    this->received.size() < this->expected )
+			{
+				this->engine->receiveMultishot( operation.getSocket(), this, NULL );
+			}
+			break;
+		}
+
+		default:
+			this->sent += operation.getResult();
+			break;
+	}
+}
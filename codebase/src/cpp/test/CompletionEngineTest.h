@@ -0,0 +1,103 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development
+ * and Distribution License (the "License"). You may not use this file except in
+ * compliance with the License. You can obtain a copy of the license at
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License
+ * for the specific language governing permissions and limitations under the
+ * License.
+ *
+ * When distributing Covered Code, include this CDDL HEADER in each file and
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields
+ * enclosed by brackets "[]" replaced with your own identifying information:
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+
+#include <string>
+#include <vector>
+
+#include "Common.h"
+#include "syscommon/Platform.h"
+#include "syscommon/net/CompletionEngine.h"
+
+class CompletionEngineTest: public CppUnit::TestFixture
+{
+	//----------------------------------------------------------
+	//                    STATIC VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                   INSTANCE VARIABLES
+	//----------------------------------------------------------
+	private:
+		syscommon::ServerSocket* server;
+		syscommon::Socket* client;
+		syscommon::Socket* accepted;
+		syscommon::CompletionEngine* engine;
+
+	//----------------------------------------------------------
+	//                      CONSTRUCTORS
+	//----------------------------------------------------------
+	public:
+		CompletionEngineTest();
+		virtual ~CompletionEngineTest();
+
+	//----------------------------------------------------------
+	//                    INSTANCE METHODS
+	//----------------------------------------------------------
+	public:
+		void setUp();
+		void tearDown();
+
+	protected:
+		void testAcceptSendReceive();
+		void testCompletionHandler();
+		void testFixedBuffers();
+		void testMultishotAccept();
+		void testMultishotReceive();
+		void testMulticastSocket();
+		void testCancel();
+		void testClose();
+		void testInvalidArguments();
+
+	private:
+		void connectClient();
+
+	//----------------------------------------------------------
+	//                     STATIC METHODS
+	//----------------------------------------------------------
+	CPPUNIT_TEST_SUITE( CompletionEngineTest );
+		CPPUNIT_TEST( testAcceptSendReceive );
+		CPPUNIT_TEST( testCompletionHandler );
+		CPPUNIT_TEST( testFixedBuffers );
+		CPPUNIT_TEST( testMultishotAccept );
+		CPPUNIT_TEST( testMultishotReceive );
+		CPPUNIT_TEST( testMulticastSocket );
+		CPPUNIT_TEST( testCancel );
+		CPPUNIT_TEST( testClose );
+		CPPUNIT_TEST( testInvalidArguments );
+	CPPUNIT_TEST_SUITE_END();
+};
+
+// Records what it is told about, restarting multishot operations that end before the expected
+// number of connections or bytes has arrived
+class RecordingCompletionHandler : public syscommon::ICompletionHandler
+{
+	public:
+		syscommon::CompletionEngine* engine;
+		size_t expected;
+		int calls;
+		int failures;
+		int sent;
+		bool closed;
+		std::string received;
+		std::vector<syscommon::Socket*> accepted;
+
+	public:
+		RecordingCompletionHandler( syscommon::CompletionEngine* engine, size_t expected );
+		virtual ~RecordingCompletionHandler();
+		virtual void completed( syscommon::AsyncOperation& operation );
+};
@@ -0,0 +1,191 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development
+ * and Distribution License (the "License"). You may not use this file except in
+ * compliance with the License. You can obtain a copy of the license at
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License
+ * for the specific language governing permissions and limitations under the
+ * License.
+ *
+ * When distributing Covered Code, include this CDDL HEADER in each file and
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields
+ * enclosed by brackets "[]" replaced with your own identifying information:
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "CpuTopologyTest.h"
+
+#include <algorithm>
+#include <limits.h>
+#include <set>
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+CPPUNIT_TEST_SUITE_REGISTRATION( CpuTopologyTest );
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+CpuTopologyTest::CpuTopologyTest()
+{
+
+}
+
+CpuTopologyTest::~CpuTopologyTest()
+{
+
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+void CpuTopologyTest::setUp()
+{
+
+}
+
+void CpuTopologyTest::tearDown()
+{
+
+}
+
+void CpuTopologyTest::testCached()
+{
+	const syscommon::CpuTopology& first = syscommon::Platform::getTopology();
+	const syscommon::CpuTopology& second = syscommon::Platform::getTopology();
+	CPPUNIT_ASSERT( &first == &second );
+}
+
+void CpuTopologyTest::testCounts()
+{
+	const syscommon::CpuTopology& topology = syscommon::Platform::getTopology();
+
+	unsigned int processors = topology.getProcessorCount();
+	if( processors != syscommon::Platform::getProcessorCount() )
+	{
+		failTest( "Topology has %u processors, but %u are online",
+		          processors,
+		          syscommon::Platform::getProcessorCount() );
+	}
+
+	CPPUNIT_ASSERT( topology.getPackageCount() >= 1 );
+	CPPUNIT_ASSERT( topology.getCoreCount() >= topology.getPackageCount() );
+	CPPUNIT_ASSERT( topology.getCoreCount() <= processors );
+	CPPUNIT_ASSERT( topology.getThreadsPerCore() >= 1 );
+	CPPUNIT_ASSERT( topology.getCoreCount() * topology.getThreadsPerCore() >= processors );
+
+	// Processors are sorted, and the one we are running on is among them
+	const std::vector<syscommon::ProcessorInfo>& all = topology.getProcessors();
+	for( size_t i = 1; i < all.size(); ++i )
+		CPPUNIT_ASSERT( all[i - 1].id < all[i].id );
+
+	CPPUNIT_ASSERT( topology.getNodeOf(syscommon::Platform::getCurrentProcessor()) >= 0 );
+}
+
+void CpuTopologyTest::testOnePerCore()
+{
+	const syscommon::CpuTopology& topology = syscommon::Platform::getTopology();
+	std::vector<unsigned int> onePerCore = topology.getOnePerCore();
+	CPPUNIT_ASSERT_EQUAL( (size_t)topology.getCoreCount(), onePerCore.size() );
+
+	// Every processor is the sibling of exactly one of the chosen processors
+	std::set<unsigned int> covered;
+	for( size_t i = 0; i < onePerCore.size(); ++i )
+	{
+		std::vector<unsigned int> siblings = topology.getSiblings( onePerCore[i] );
+		CPPUNIT_ASSERT( std::find(siblings.begin(), siblings.end(), onePerCore[i]) != siblings.end() );
+		CPPUNIT_ASSERT( siblings.size() <= topology.getThreadsPerCore() );
+
+		for( size_t j = 0; j < siblings.size(); ++j )
+		{
+			if( !covered.insert(siblings[j]).second )
+				failTest( "Processor %u is on more than one core", siblings[j] );
+		}
+	}
+
+	CPPUNIT_ASSERT_EQUAL( (size_t)topology.getProcessorCount(), covered.size() );
+	CPPUNIT_ASSERT( topology.getSiblings(UINT_MAX).empty() );
+}
+
+void CpuTopologyTest::testNodes()
+{
+	const syscommon::CpuTopology& topology = syscommon::Platform::getTopology();
+	const std::vector<int>& nodes = topology.getNodes();
+	CPPUNIT_ASSERT( !nodes.empty() );
+
+	size_t processors = 0;
+	size_t cores = 0;
+	for( size_t i = 0; i < nodes.size(); ++i )
+	{
+		std::vector<unsigned int> nodeProcessors = topology.getNodeProcessors( nodes[i] );
+		CPPUNIT_ASSERT( !nodeProcessors.empty() );
+		for( size_t j = 0; j < nodeProcessors.size(); ++j )
+			CPPUNIT_ASSERT_EQUAL( nodes[i], topology.getNodeOf(nodeProcessors[j]) );
+
+		processors += nodeProcessors.size();
+		cores += topology.getOnePerCore( nodes[i] ).size();
+	}
+
+	CPPUNIT_ASSERT_EQUAL( (size_t)topology.getProcessorCount(), processors );
+	CPPUNIT_ASSERT_EQUAL( (size_t)topology.getCoreCount(), cores );
+	CPPUNIT_ASSERT_EQUAL( -1, topology.getNodeOf(UINT_MAX) );
+}
+
+void CpuTopologyTest::testCaches()
+{
+	const syscommon::CpuTopology& topology = syscommon::Platform::getTopology();
+
+	// A power of two, and no smaller than any line size in use
+	unsigned int lineSize = topology.getCacheLineSize();
+	CPPUNIT_ASSERT( lineSize >= 16 );
+	CPPUNIT_ASSERT( (lineSize & (lineSize - 1)) == 0 );
+
+	// Caches grow further from the core, where the levels are reported at all
+	for( unsigned int level = 2; level <= 3; ++level )
+	{
+		size_t outer = topology.getCacheSize( level );
+		size_t inner = topology.getCacheSize( level - 1 );
+		if( outer > 0 && inner > outer )
+			failTest( "L%u cache of %lu bytes is larger than the L%u of %lu", level - 1, (unsigned long)inner, level, (unsigned long)outer );
+	}
+
+	const std::vector<syscommon::CacheInfo>& caches = topology.getCaches();
+	for( size_t i = 0; i < caches.size(); ++i )
+	{
+		CPPUNIT_ASSERT( caches[i].level >= 1 );
+		CPPUNIT_ASSERT( !caches[i].processors.empty() );
+	}
+
+	CPPUNIT_ASSERT_EQUAL( (size_t)0, topology.getCacheSize(99) );
+}
+
+void CpuTopologyTest::testNumaThreadOption()
+{
+	const syscommon::CpuTopology& topology = syscommon::Platform::getTopology();
+	int node = topology.getNodes().back();
+
+	syscommon::ThreadOptions options;
+	options.numaNode = node;
+
+	ProcessorRecordingRunnable runnable;
+	syscommon::Thread testThread( &runnable, TEXT("NodeBound"), options );
+	testThread.start();
+	testThread.join();
+
+	if( topology.getNodeOf(runnable.processor) != node )
+		failTest( "Thread for node %d ran on processor %u of node %d", node, runnable.processor, topology.getNodeOf(runnable.processor) );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/////////////////////////  ProcessorRecordingRunnable  ////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+ProcessorRecordingRunnable::ProcessorRecordingRunnable()
+{
+	this->processor = UINT_MAX;
+}
+
+void ProcessorRecordingRunnable::run()
+{
+	this->processor = syscommon::Platform::getCurrentProcessor();
+}
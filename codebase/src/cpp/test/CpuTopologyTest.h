@@ -0,0 +1,76 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development
+ * and Distribution License (the "License"). You may not use this file except in
+ * compliance with the License. You can obtain a copy of the license at
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License
+ * for the specific language governing permissions and limitations under the
+ * License.
+ *
+ * When distributing Covered Code, include this CDDL HEADER in each file and
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields
+ * enclosed by brackets "[]" replaced with your own identifying information:
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include "Common.h"
+#include "syscommon/Platform.h"
+#include "syscommon/concurrent/Thread.h"
+
+class CpuTopologyTest: public CppUnit::TestFixture
+{
+	//----------------------------------------------------------
+	//                    STATIC VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                   INSTANCE VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                      CONSTRUCTORS
+	//----------------------------------------------------------
+	public:
+		CpuTopologyTest();
+		virtual ~CpuTopologyTest();
+
+	//----------------------------------------------------------
+	//                    INSTANCE METHODS
+	//----------------------------------------------------------
+	public:
+		void setUp();
+		void tearDown();
+
+	protected:
+		void testCached();
+		void testCounts();
+		void testOnePerCore();
+		void testNodes();
+		void testCaches();
+		void testNumaThreadOption();
+
+	//----------------------------------------------------------
+	//                     STATIC METHODS
+	//----------------------------------------------------------
+	CPPUNIT_TEST_SUITE( CpuTopologyTest );
+		CPPUNIT_TEST( testCached );
+		CPPUNIT_TEST( testCounts );
+		CPPUNIT_TEST( testOnePerCore );
+		CPPUNIT_TEST( testNodes );
+		CPPUNIT_TEST( testCaches );
+		CPPUNIT_TEST( testNumaThreadOption );
+	CPPUNIT_TEST_SUITE_END();
+};
+
+// Records which processor a thread started on
+class ProcessorRecordingRunnable : public syscommon::IRunnable
+{
+	public:
+		unsigned int processor;
+
+	public:
+		ProcessorRecordingRunnable();
+		virtual void run();
+};
@@ -0,0 +1,102 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "DeadlineTest.h"
+
+#include <limits.h>
+#include "syscommon/Platform.h"
+#include "syscommon/concurrent/Event.h"
+#include "syscommon/concurrent/Thread.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+CPPUNIT_TEST_SUITE_REGISTRATION( DeadlineTest );
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+DeadlineTest::DeadlineTest()
+{
+
+}
+
+DeadlineTest::~DeadlineTest()
+{
+
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+void DeadlineTest::setUp()
+{
+
+}
+
+void DeadlineTest::tearDown()
+{
+
+}
+
+void DeadlineTest::testInfinite()
+{
+	syscommon::Deadline deadline( NATIVE_INFINITE_WAIT );
+	CPPUNIT_ASSERT( deadline.isInfinite() );
+	CPPUNIT_ASSERT( !deadline.hasExpired() );
+	CPPUNIT_ASSERT( deadline.getRemainingMillis() == NATIVE_INFINITE_WAIT );
+	CPPUNIT_ASSERT_EQUAL( LLONG_MAX, deadline.getRemainingNanos() );
+}
+
+void DeadlineTest::testExpiry()
+{
+	syscommon::Deadline immediate( 0 );
+	CPPUNIT_ASSERT( !immediate.isInfinite() );
+	CPPUNIT_ASSERT( immediate.hasExpired() );
+	CPPUNIT_ASSERT_EQUAL( 0UL, immediate.getRemainingMillis() );
+
+	syscommon::Deadline deadline( 50 );
+	CPPUNIT_ASSERT( !deadline.hasExpired() );
+	CPPUNIT_ASSERT( deadline.getRemainingMillis() <= 50UL );
+
+	syscommon::Thread::sleep( 60L );
+	CPPUNIT_ASSERT( deadline.hasExpired() );
+	CPPUNIT_ASSERT_EQUAL( 0LL, deadline.getRemainingNanos() );
+}
+
+void DeadlineTest::testRemainingRoundsUp()
+{
+	// Less than a millisecond left must not be reported as zero, or a wait on it would return
+	// before the deadline
+	syscommon::Deadline deadline = syscommon::Deadline::fromNanos( 500000LL );
+	if( !deadline.hasExpired() )
+		CPPUNIT_ASSERT_EQUAL( 1UL, deadline.getRemainingMillis() );
+}
+
+void DeadlineTest::testSharedAcrossWaits()
+{
+	// Several waits against one deadline take no longer than the deadline in total
+	syscommon::Event neverSignalled( false, TEXT("Never") );
+	syscommon::Deadline deadline( 100 );
+
+	long long start = syscommon::Platform::nanoTime();
+	for( int i = 0 ; i < 5 ; ++i )
+		neverSignalled.waitFor( deadline.getRemainingMillis() );
+	long long elapsedMillis = (syscommon::Platform::nanoTime() - start) / 1000000LL;
+
+	CPPUNIT_ASSERT( deadline.hasExpired() );
+	if( elapsedMillis < 100 || elapsedMillis > 250 )
+		failTest( "Expected the waits to take about 100ms, took %lldms", elapsedMillis );
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include "Common.h"
+#include "syscommon/util/Deadline.h"
+
+class DeadlineTest: public CppUnit::TestFixture
+{
+	//----------------------------------------------------------
+	//                    STATIC VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                   INSTANCE VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                      CONSTRUCTORS
+	//----------------------------------------------------------
+	public:
+		DeadlineTest();
+		virtual ~DeadlineTest();
+
+	//----------------------------------------------------------
+	//                    INSTANCE METHODS
+	//----------------------------------------------------------
+	public:
+		void setUp();
+		void tearDown();
+
+	protected:
+		void testInfinite();
+		void testExpiry();
+		void testRemainingRoundsUp();
+		void testSharedAcrossWaits();
+
+	//----------------------------------------------------------
+	//                     STATIC METHODS
+	//----------------------------------------------------------
+	CPPUNIT_TEST_SUITE( DeadlineTest );
+		CPPUNIT_TEST( testInfinite );
+		CPPUNIT_TEST( testExpiry );
+		CPPUNIT_TEST( testRemainingRoundsUp );
+		CPPUNIT_TEST( testSharedAcrossWaits );
+	CPPUNIT_TEST_SUITE_END();
+};
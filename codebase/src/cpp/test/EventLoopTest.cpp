@@ -0,0 +1,401 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development
+ * and Distribution License (the "License"). You may not use this file except in
+ * compliance with the License. You can obtain a copy of the license at
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License
+ * for the specific language governing permissions and limitations under the
+ * License.
+ *
+ * When distributing Covered Code, include this CDDL HEADER in each file and
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields
+ * enclosed by brackets "[]" replaced with your own identifying information:
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "EventLoopTest.h"
+
+#include <string.h>
+#include <string>
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+CPPUNIT_TEST_SUITE_REGISTRATION( EventLoopTest );
+
+#ifdef SYSCOMMON_HAS_COROUTINES
+//----------------------------------------------------------
+//                       COROUTINES
+//----------------------------------------------------------
+static syscommon::Task<void> echoConnection( syscommon::Socket* client )
+{
+	char buffer[64];
+	int received;
+	while( (received = co_await client->receiveAsync(buffer, sizeof(buffer))) > 0 )
+		co_await client->sendAsync( buffer, received );
+
+	delete client;
+}
+
+static syscommon::Task<void> acceptOne( syscommon::ServerSocket* server, std::atomic<int>* accepted )
+{
+	syscommon::Socket* client = co_await server->acceptAsync();
+	++*accepted;
+	syscommon::EventLoop::current()->spawn( echoConnection(client) );
+}
+
+static syscommon::Task<void> sleepThenCount( unsigned long milliseconds, std::atomic<int>* counter )
+{
+	co_await syscommon::EventLoop::sleepFor( milliseconds );
+	++*counter;
+}
+
+static syscommon::Task<int> addSlowly( int a, int b )
+{
+	co_await syscommon::EventLoop::sleepFor( 1 );
+	co_return a + b;
+}
+
+static syscommon::Task<int> addNow( int a, int b )
+{
+	co_return a + b;
+}
+
+static syscommon::Task<int> failSlowly()
+{
+	co_await syscommon::EventLoop::sleepFor( 1 );
+	throw syscommon::IllegalArgumentException( TEXT("Failing on purpose") );
+}
+
+static syscommon::Task<void> failThrough()
+{
+	co_await failSlowly();
+}
+
+static syscommon::Task<void> sumAll( int* slowTotal,
+                                     long long* fastTotal,
+                                     bool* caught,
+                                     std::atomic<int>* done )
+{
+	for( int i = 0; i < 10; ++i )
+		*slowTotal += co_await addSlowly( i, 1 );
+
+	// Tasks that finish without suspending hand straight back to their caller, so however
+	// many there are, the stack does not grow
+	for( int i = 0; i < 100000; ++i )
+		*fastTotal += co_await addNow( i, 1 );
+
+	try
+	{
+		co_await failSlowly();
+	}
+	catch( syscommon::IllegalArgumentException& )
+	{
+		*caught = true;
+	}
+
+	++*done;
+}
+
+static syscommon::Task<void> waitAndCount( syscommon::AsyncEvent* event, std::atomic<int>* counter )
+{
+	co_await event->waitAsync();
+	++*counter;
+}
+#endif
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+EventLoopTest::EventLoopTest()
+{
+	this->loop = NULL;
+	this->thread = NULL;
+}
+
+EventLoopTest::~EventLoopTest()
+{
+
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+void EventLoopTest::setUp()
+{
+	this->loop = new syscommon::EventLoop();
+}
+
+void EventLoopTest::tearDown()
+{
+	if( this->thread )
+	{
+		this->loop->stop();
+		this->thread->join();
+	}
+
+	delete this->thread;
+	delete this->loop;
+
+	this->thread = NULL;
+	this->loop = NULL;
+}
+
+void EventLoopTest::startLoop()
+{
+	this->thread = new syscommon::Thread( this->loop, TEXT("EventLoop") );
+	this->thread->start();
+}
+
+bool EventLoopTest::waitForCount( std::atomic<int>& counter, int expected )
+{
+	for( int i = 0; i < 10000 && counter != expected; ++i )
+		syscommon::Thread::sleep( 1 );
+
+	return counter == expected;
+}
+
+void EventLoopTest::testPost()
+{
+	this->startLoop();
+
+	LoopRunnable runnable;
+	for( int i = 0; i < 3; ++i )
+		this->loop->post( &runnable );
+
+	if( !this->waitForCount(runnable.count, 3) )
+		failTest( "Posted task ran %d times, expected 3", (int)runnable.count );
+
+	CPPUNIT_ASSERT_EQUAL( (unsigned long long)0, this->loop->getFailureCount() );
+}
+
+void EventLoopTest::testSchedule()
+{
+	this->startLoop();
+
+	// Timers belong to the loop's thread, so schedule from a posted task
+	LoopRunnable scheduled;
+	LoopRunnable scheduler;
+	scheduler.loop = this->loop;
+	scheduler.followUp = &scheduled;
+	scheduler.delay = 100;
+
+	long long posted = syscommon::Platform::nanoTime();
+	this->loop->post( &scheduler );
+	if( !this->waitForCount(scheduled.count, 1) )
+		failTest( "Scheduled task did not run" );
+
+	long long elapsed = (scheduled.ranAt - posted) / 1000000;
+	if( elapsed < 95 )
+		failTest( "Scheduled task ran after %lldms, expected at least 100ms", elapsed );
+}
+
+void EventLoopTest::testStopBeforeRun()
+{
+	// Run on this thread, which must come straight back
+	this->loop->stop();
+	this->loop->run();
+
+	CPPUNIT_ASSERT( this->loop->isStopped() );
+	CPPUNIT_ASSERT( syscommon::EventLoop::current() == NULL );
+}
+
+#ifdef SYSCOMMON_HAS_COROUTINES
+void EventLoopTest::testEcho()
+{
+	syscommon::ServerSocket server;
+	server.bind( syscommon::InetSocketAddress(INADDR_LOOPBACK, 0) );
+
+	std::atomic<int> accepted( 0 );
+	this->loop->spawn( acceptOne(&server, &accepted) );
+	this->startLoop();
+
+	syscommon::Socket client( INADDR_LOOPBACK, server.getLocalPort() );
+	client.send( "hello", 5 );
+
+	char reply[16];
+	memset( reply, 0, sizeof(reply) );
+	int received = 0;
+	while( received < 5 )
+	{
+		int result = client.receive( reply + received, sizeof(reply) - 1 - received );
+		if( result <= 0 )
+			failTest( "Connection closed after %d bytes of the echo", received );
+
+		received += result;
+	}
+
+	CPPUNIT_ASSERT_EQUAL( 1, (int)accepted );
+	CPPUNIT_ASSERT_EQUAL( std::string("hello"), std::string(reply) );
+
+	// The echo finishes once it sees the connection closed
+	client.close();
+	for( int i = 0; i < 5000 && this->loop->getTaskCount() > 0; ++i )
+		syscommon::Thread::sleep( 1 );
+
+	CPPUNIT_ASSERT_EQUAL( (size_t)0, this->loop->getTaskCount() );
+	CPPUNIT_ASSERT_EQUAL( (unsigned long long)0, this->loop->getFailureCount() );
+}
+
+void EventLoopTest::testSleep()
+{
+	std::atomic<int> counter( 0 );
+	long long started = syscommon::Platform::nanoTime();
+	this->loop->spawn( sleepThenCount(100, &counter) );
+	this->loop->spawn( sleepThenCount(0, &counter) );
+	this->startLoop();
+
+	if( !this->waitForCount(counter, 2) )
+		failTest( "Sleeping tasks did not finish" );
+
+	long long elapsed = (syscommon::Platform::nanoTime() - started) / 1000000;
+	if( elapsed < 95 )
+		failTest( "Sleep finished after %lldms, expected at least 100ms", elapsed );
+}
+
+void EventLoopTest::testNestedTasks()
+{
+	int slowTotal = 0;
+	long long fastTotal = 0;
+	bool caught = false;
+	std::atomic<int> done( 0 );
+	this->loop->spawn( sumAll(&slowTotal, &fastTotal, &caught, &done) );
+	this->loop->spawn( failThrough() );
+	this->startLoop();
+
+	if( !this->waitForCount(done, 1) )
+		failTest( "Nested tasks did not finish" );
+
+	CPPUNIT_ASSERT_EQUAL( 55, slowTotal );
+	CPPUNIT_ASSERT_EQUAL( 5000050000LL, fastTotal );
+	CPPUNIT_ASSERT( caught );
+
+	// The exception that escaped the other task is counted against the loop
+	for( int i = 0; i < 5000 && this->loop->getTaskCount() > 0; ++i )
+		syscommon::Thread::sleep( 1 );
+
+	CPPUNIT_ASSERT_EQUAL( (unsigned long long)1, this->loop->getFailureCount() );
+}
+
+void EventLoopTest::testAsyncEvent()
+{
+	syscommon::AsyncEvent event( false );
+	std::atomic<int> counter( 0 );
+	for( int i = 0; i < 10; ++i )
+		this->loop->spawn( waitAndCount(&event, &counter) );
+
+	this->startLoop();
+	for( int i = 0; i < 5000 && event.getWaiterCount() < 10; ++i )
+		syscommon::Thread::sleep( 1 );
+
+	CPPUNIT_ASSERT_EQUAL( (size_t)10, event.getWaiterCount() );
+	CPPUNIT_ASSERT_EQUAL( 0, (int)counter );
+
+	// Signalled from this thread, which has no loop of its own
+	event.signal();
+	if( !this->waitForCount(counter, 10) )
+		failTest( "Only %d of 10 waiting tasks were resumed", (int)counter );
+
+	// A signalled event does not suspend
+	this->loop->spawn( waitAndCount(&event, &counter) );
+	if( !this->waitForCount(counter, 11) )
+		failTest( "Task waiting on a signalled event did not carry on" );
+
+	event.clear();
+	this->loop->spawn( waitAndCount(&event, &counter) );
+	for( int i = 0; i < 5000 && event.getWaiterCount() < 1; ++i )
+		syscommon::Thread::sleep( 1 );
+
+	CPPUNIT_ASSERT_EQUAL( 11, (int)counter );
+	event.signal();
+	if( !this->waitForCount(counter, 12) )
+		failTest( "Task waiting on a cleared event was not resumed" );
+}
+
+void EventLoopTest::testManySuspendedTasks()
+{
+	const int sessions = 100000;
+
+	syscommon::AsyncEvent event( false );
+	std::atomic<int> counter( 0 );
+	for( int i = 0; i < sessions; ++i )
+		this->loop->spawn( waitAndCount(&event, &counter) );
+
+	this->startLoop();
+	for( int i = 0; i < 10000 && event.getWaiterCount() < (size_t)sessions; ++i )
+		syscommon::Thread::sleep( 1 );
+
+	CPPUNIT_ASSERT_EQUAL( (size_t)sessions, event.getWaiterCount() );
+	CPPUNIT_ASSERT_EQUAL( (size_t)sessions, this->loop->getTaskCount() );
+
+	event.signal();
+	if( !this->waitForCount(counter, sessions) )
+		failTest( "Only %d of %d suspended tasks were resumed", (int)counter, sessions );
+
+	for( int i = 0; i < 5000 && this->loop->getTaskCount() > 0; ++i )
+		syscommon::Thread::sleep( 1 );
+
+	CPPUNIT_ASSERT_EQUAL( (size_t)0, this->loop->getTaskCount() );
+}
+
+void EventLoopTest::testNoLoop()
+{
+	syscommon::Socket socket;
+	char buffer[16];
+	try
+	{
+		socket.receiveAsync( buffer, sizeof(buffer) );
+		failTestMissingException( "IllegalStateException", "receiving without a loop" );
+	}
+	catch( syscommon::IllegalStateException& )
+	{
+		// Expected
+	}
+
+	try
+	{
+		syscommon::EventLoop::sleepFor( 1 );
+		failTestMissingException( "IllegalStateException", "sleeping without a loop" );
+	}
+	catch( syscommon::IllegalStateException& )
+	{
+		// Expected
+	}
+
+	syscommon::AsyncEvent event( false );
+	try
+	{
+		event.waitAsync();
+		failTestMissingException( "IllegalStateException", "waiting on an event without a loop" );
+	}
+	catch( syscommon::IllegalStateException& )
+	{
+		// Expected
+	}
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////  LoopRunnable  ////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+LoopRunnable::LoopRunnable() : count( 0 )
+{
+	this->loop = NULL;
+	this->followUp = NULL;
+	this->delay = 0;
+	this->ranAt = 0;
+}
+
+LoopRunnable::~LoopRunnable()
+{
+
+}
+
+void LoopRunnable::run()
+{
+	this->ranAt = syscommon::Platform::nanoTime();
+	if( this->loop && this->followUp )
+		this->loop->schedule( this->delay, this->followUp );
+
+	++this->count;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development
+ * and Distribution License (the "License"). You may not use this file except in
+ * compliance with the License. You can obtain a copy of the license at
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License
+ * for the specific language governing permissions and limitations under the
+ * License.
+ *
+ * When distributing Covered Code, include this CDDL HEADER in each file and
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields
+ * enclosed by brackets "[]" replaced with your own identifying information:
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+
+#include <atomic>
+
+#include "Common.h"
+#include "syscommon/Platform.h"
+#include "syscommon/concurrent/AsyncEvent.h"
+#include "syscommon/concurrent/Event.h"
+#include "syscommon/concurrent/Thread.h"
+#include "syscommon/net/EventLoop.h"
+
+class EventLoopTest: public CppUnit::TestFixture
+{
+	//----------------------------------------------------------
+	//                    STATIC VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                   INSTANCE VARIABLES
+	//----------------------------------------------------------
+	private:
+		syscommon::EventLoop* loop;
+		syscommon::Thread* thread;
+
+	//----------------------------------------------------------
+	//                      CONSTRUCTORS
+	//----------------------------------------------------------
+	public:
+		EventLoopTest();
+		virtual ~EventLoopTest();
+
+	//----------------------------------------------------------
+	//                    INSTANCE METHODS
+	//----------------------------------------------------------
+	public:
+		void setUp();
+		void tearDown();
+
+	protected:
+		void testPost();
+		void testSchedule();
+		void testStopBeforeRun();
+#ifdef SYSCOMMON_HAS_COROUTINES
+		void testEcho();
+		void testSleep();
+		void testNestedTasks();
+		void testAsyncEvent();
+		void testManySuspendedTasks();
+		void testNoLoop();
+#endif
+
+	private:
+		void startLoop();
+
+		/**
+		 * Waits up to a few seconds for the counter to reach the given value
+		 */
+		bool waitForCount( std::atomic<int>& counter, int expected );
+
+	//----------------------------------------------------------
+	//                     STATIC METHODS
+	//----------------------------------------------------------
+	CPPUNIT_TEST_SUITE( EventLoopTest );
+		CPPUNIT_TEST( testPost );
+		CPPUNIT_TEST( testSchedule );
+		CPPUNIT_TEST( testStopBeforeRun );
+#ifdef SYSCOMMON_HAS_COROUTINES
+		CPPUNIT_TEST( testEcho );
+		CPPUNIT_TEST( testSleep );
+		CPPUNIT_TEST( testNestedTasks );
+		CPPUNIT_TEST( testAsyncEvent );
+		CPPUNIT_TEST( testManySuspendedTasks );
+		CPPUNIT_TEST( testNoLoop );
+#endif
+	CPPUNIT_TEST_SUITE_END();
+};
+
+// Counts how many times it has run, and optionally schedules a follow up on the loop it runs on
+class LoopRunnable : public syscommon::IRunnable
+{
+	public:
+		std::atomic<int> count;
+		syscommon::EventLoop* loop;
+		syscommon::IRunnable* followUp;
+		unsigned long delay;
+		long long ranAt;
+
+	public:
+		LoopRunnable();
+		virtual ~LoopRunnable();
+		virtual void run();
+};
@@ -0,0 +1,136 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "EventTest.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+CPPUNIT_TEST_SUITE_REGISTRATION( EventTest );
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+EventTest::EventTest()
+{
+
+}
+
+EventTest::~EventTest()
+{
+
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+void EventTest::setUp()
+{
+
+}
+
+void EventTest::tearDown()
+{
+
+}
+
+void EventTest::testInitialState()
+{
+	syscommon::Event signaled( true, TEXT("Signaled") );
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_SUCCEEDED, signaled.waitFor(0) );
+
+	// Stays signaled until cleared
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_SUCCEEDED, signaled.waitFor(0) );
+	signaled.clear();
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_TIMEOUT, signaled.waitFor(0) );
+
+	syscommon::Event cleared( false, TEXT("Cleared") );
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_TIMEOUT, cleared.waitFor(0) );
+	cleared.signal();
+	cleared.signal();
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_SUCCEEDED, cleared.waitFor(0) );
+}
+
+void EventTest::testTimeout()
+{
+	syscommon::Event event( false, TEXT("Timeout") );
+
+	unsigned long start = syscommon::Platform::getCurrentTimeMilliseconds();
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_TIMEOUT, event.waitFor(200) );
+	unsigned long elapsed = syscommon::Platform::getCurrentTimeMilliseconds() - start;
+
+	if( elapsed < 190 )
+		failTest( "Wait returned after %lums, expected at least 200ms", elapsed );
+}
+
+void EventTest::testSignalWakesAllWaiters()
+{
+	const int waiterCount = 8;
+	syscommon::Event event( false, TEXT("WakeAll") );
+
+	EventWaiter* waiters[waiterCount];
+	syscommon::Thread* threads[waiterCount];
+	for( int i = 0 ; i < waiterCount ; ++i )
+	{
+		waiters[i] = new EventWaiter( &event, 10000 );
+		threads[i] = new syscommon::Thread( waiters[i] );
+		threads[i]->start();
+	}
+
+	syscommon::Thread::sleep( 100 );
+	event.signal();
+
+	for( int i = 0 ; i < waiterCount ; ++i )
+	{
+		threads[i]->join();
+		CPPUNIT_ASSERT_EQUAL( syscommon::WR_SUCCEEDED, (syscommon::WaitResult)waiters[i]->result );
+
+		delete threads[i];
+		delete waiters[i];
+	}
+}
+
+void EventTest::testSignalThenClearReleasesWaiters()
+{
+	// Threads already waiting when the event is signaled must be released, even if the event is
+	// cleared again before they get to run
+	syscommon::Event event( false, TEXT("Pulse") );
+	EventWaiter waiter( &event, 10000 );
+	syscommon::Thread thread( &waiter );
+	thread.start();
+
+	syscommon::Thread::sleep( 100 );
+	event.signal();
+	event.clear();
+
+	thread.join();
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_SUCCEEDED, (syscommon::WaitResult)waiter.result );
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_TIMEOUT, event.waitFor(0) );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+////////////////////////////////  EventWaiter  ////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+EventWaiter::EventWaiter( syscommon::Event* event, unsigned long timeout )
+{
+	this->event = event;
+	this->timeout = timeout;
+	this->result = syscommon::WR_FAILED;
+}
+
+void EventWaiter::run()
+{
+	this->result = this->event->waitFor( this->timeout );
+}
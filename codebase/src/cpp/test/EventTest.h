@@ -0,0 +1,75 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include "Common.h"
+#include "syscommon/concurrent/Event.h"
+#include "syscommon/concurrent/Thread.h"
+
+class EventTest: public CppUnit::TestFixture
+{
+	//----------------------------------------------------------
+	//                    STATIC VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                   INSTANCE VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                      CONSTRUCTORS
+	//----------------------------------------------------------
+	public:
+		EventTest();
+		virtual ~EventTest();
+
+	//----------------------------------------------------------
+	//                    INSTANCE METHODS
+	//----------------------------------------------------------
+	public:
+		void setUp();
+		void tearDown();
+
+	protected:
+		void testInitialState();
+		void testTimeout();
+		void testSignalWakesAllWaiters();
+		void testSignalThenClearReleasesWaiters();
+
+	//----------------------------------------------------------
+	//                     STATIC METHODS
+	//----------------------------------------------------------
+	CPPUNIT_TEST_SUITE( EventTest );
+		CPPUNIT_TEST( testInitialState );
+		CPPUNIT_TEST( testTimeout );
+		CPPUNIT_TEST( testSignalWakesAllWaiters );
+		CPPUNIT_TEST( testSignalThenClearReleasesWaiters );
+	CPPUNIT_TEST_SUITE_END();
+};
+
+// EventWaiter helper class, waits on an event and records the result
+class EventWaiter : public syscommon::IRunnable
+{
+	private:
+		syscommon::Event* event;
+		unsigned long timeout;
+
+	public:
+		volatile syscommon::WaitResult result;
+
+		EventWaiter( syscommon::Event* event, unsigned long timeout );
+		virtual void run();
+};
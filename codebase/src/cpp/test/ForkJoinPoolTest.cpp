@@ -0,0 +1,311 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "ForkJoinPoolTest.h"
+
+#include <stdexcept>
+#include "syscommon/concurrent/Thread.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+CPPUNIT_TEST_SUITE_REGISTRATION( ForkJoinPoolTest );
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+ForkJoinPoolTest::ForkJoinPoolTest()
+{
+
+}
+
+ForkJoinPoolTest::~ForkJoinPoolTest()
+{
+
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+void ForkJoinPoolTest::setUp()
+{
+
+}
+
+void ForkJoinPoolTest::tearDown()
+{
+
+}
+
+void ForkJoinPoolTest::testDequeOrdering()
+{
+	int values[3] = { 1, 2, 3 };
+	syscommon::WorkStealingDeque<int> deque;
+
+	for( int i = 0 ; i < 3 ; ++i )
+		deque.push( &values[i] );
+
+	CPPUNIT_ASSERT_EQUAL( 3L, deque.size() );
+
+	// Thieves take the oldest, the owner takes the newest
+	CPPUNIT_ASSERT( deque.steal() == &values[0] );
+	CPPUNIT_ASSERT( deque.take() == &values[2] );
+	CPPUNIT_ASSERT( deque.take() == &values[1] );
+
+	CPPUNIT_ASSERT( deque.take() == NULL );
+	CPPUNIT_ASSERT( deque.steal() == NULL );
+	CPPUNIT_ASSERT( deque.isEmpty() );
+}
+
+void ForkJoinPoolTest::testDequeGrowth()
+{
+	std::vector<int> values( 1000 );
+	syscommon::WorkStealingDeque<int> deque( 4 );
+
+	for( size_t i = 0 ; i < values.size() ; ++i )
+		deque.push( &values[i] );
+
+	CPPUNIT_ASSERT_EQUAL( 1000L, deque.size() );
+
+	for( size_t i = values.size() ; i > 0 ; --i )
+		CPPUNIT_ASSERT( deque.take() == &values[i - 1] );
+
+	CPPUNIT_ASSERT( deque.take() == NULL );
+}
+
+void ForkJoinPoolTest::testDequeConcurrentSteal()
+{
+	const int count = 100000;
+	std::vector<int> values( count );
+	std::vector<int> seen( count, 0 );
+	syscommon::WorkStealingDeque<int> deque( 16 );
+
+	volatile bool stop = false;
+	StealingRunnable thiefOne( &deque, &stop );
+	StealingRunnable thiefTwo( &deque, &stop );
+	syscommon::Thread threadOne( &thiefOne );
+	syscommon::Thread threadTwo( &thiefTwo );
+	threadOne.start();
+	threadTwo.start();
+
+	// Interleave pushes and takes while the thieves run, so that the deque grows and the owner
+	// races the thieves for the last element
+	std::vector<int*> taken;
+	for( int i = 0 ; i < count ; ++i )
+	{
+		deque.push( &values[i] );
+		if( i % 3 == 0 )
+		{
+			int* element = deque.take();
+			if( element )
+				taken.push_back( element );
+		}
+	}
+
+	int* element = deque.take();
+	while( element )
+	{
+		taken.push_back( element );
+		element = deque.take();
+	}
+
+	stop = true;
+	threadOne.join();
+	threadTwo.join();
+
+	// Every element must have been removed exactly once
+	const std::vector<int*>* results[3] = { &taken, &thiefOne.getStolen(), &thiefTwo.getStolen() };
+	for( int r = 0 ; r < 3 ; ++r )
+	{
+		std::vector<int*>::const_iterator it = results[r]->begin();
+		for( ; it != results[r]->end(); ++it )
+			++seen[*it - &values[0]];
+	}
+
+	for( int i = 0 ; i < count ; ++i )
+	{
+		if( seen[i] != 1 )
+			failTest( "Element %d was removed %d times", i, seen[i] );
+	}
+}
+
+void ForkJoinPoolTest::testForkJoin()
+{
+	syscommon::ForkJoinPool pool( 4 );
+	CPPUNIT_ASSERT_EQUAL( 4U, pool.getParallelism() );
+
+	FibonacciTask task( 20 );
+	pool.invoke( &task );
+
+	CPPUNIT_ASSERT( task.isDone() );
+	CPPUNIT_ASSERT_EQUAL( 6765L, task.result );
+}
+
+void ForkJoinPoolTest::testParallelFor()
+{
+	const long count = 100000;
+	std::vector<std::atomic<int> > visits( count );
+	for( long i = 0 ; i < count ; ++i )
+		visits[i].store( 0 );
+
+	syscommon::ForkJoinPool pool( 4 );
+	pool.parallelFor( 0, count, 64, RangeCounter(&visits) );
+
+	for( long i = 0 ; i < count ; ++i )
+	{
+		if( visits[i].load() != 1 )
+			failTest( "Index %ld was visited %d times", i, visits[i].load() );
+	}
+
+	// An empty range is a no-op
+	pool.parallelFor( 10, 10, 64, RangeCounter(&visits) );
+	CPPUNIT_ASSERT_EQUAL( 1, visits[10].load() );
+}
+
+void ForkJoinPoolTest::testCurrentThreadIntegration()
+{
+	CPPUNIT_ASSERT( !syscommon::ForkJoinPool::inForkJoinPool() );
+	CPPUNIT_ASSERT( syscommon::ForkJoinPool::getCurrentPool() == NULL );
+
+	syscommon::ForkJoinPool pool( 2 );
+	PoolMembershipTask task;
+	pool.invoke( &task );
+
+	CPPUNIT_ASSERT( task.inPool );
+	CPPUNIT_ASSERT( task.currentPool == &pool );
+	CPPUNIT_ASSERT( dynamic_cast<syscommon::ForkJoinWorkerThread*>(task.currentThread) != NULL );
+}
+
+void ForkJoinPoolTest::testTaskFailure()
+{
+	syscommon::ForkJoinPool pool( 2 );
+	FailingTask task;
+
+	try
+	{
+		pool.invoke( &task );
+		failTestMissingException( "ExecutionException", "invoking a failing task" );
+	}
+	catch( syscommon::ExecutionException& )
+	{
+		// Success
+	}
+	catch( std::exception& e )
+	{
+		failTestWrongException( "ExecutionException", e, "invoking a failing task" );
+	}
+
+	CPPUNIT_ASSERT( task.isCompletedAbnormally() );
+}
+
+void ForkJoinPoolTest::testForkOutsidePool()
+{
+	// With no pool to queue on, the task simply runs on the calling thread
+	FibonacciTask task( 10 );
+	task.fork();
+	CPPUNIT_ASSERT( task.isDone() );
+
+	task.join();
+	CPPUNIT_ASSERT_EQUAL( 55L, task.result );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////  FibonacciTask  ///////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+FibonacciTask::FibonacciTask( int n )
+{
+	this->n = n;
+	this->result = 0;
+}
+
+void FibonacciTask::run()
+{
+	if( this->n < 2 )
+	{
+		this->result = this->n;
+	}
+	else
+	{
+		FibonacciTask first( this->n - 1 );
+		FibonacciTask second( this->n - 2 );
+		first.fork();
+		second.invoke();
+		first.join();
+		this->result = first.result + second.result;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+////////////////////////////////  RangeCounter  ///////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+RangeCounter::RangeCounter( std::vector<std::atomic<int> >* visits )
+{
+	this->visits = visits;
+}
+
+void RangeCounter::operator()( long begin, long end )
+{
+	for( long i = begin ; i < end ; ++i )
+		(*this->visits)[i].fetch_add( 1 );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/////////////////////////////  PoolMembershipTask  ////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+PoolMembershipTask::PoolMembershipTask()
+{
+	this->inPool = false;
+	this->currentPool = NULL;
+	this->currentThread = NULL;
+}
+
+void PoolMembershipTask::run()
+{
+	this->inPool = syscommon::ForkJoinPool::inForkJoinPool();
+	this->currentPool = syscommon::ForkJoinPool::getCurrentPool();
+	this->currentThread = syscommon::Thread::currentThread();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+////////////////////////////////  FailingTask  ////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+void FailingTask::run()
+{
+	throw std::runtime_error( "task failed" );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/////////////////////////////  StealingRunnable  //////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+StealingRunnable::StealingRunnable( syscommon::WorkStealingDeque<int>* deque, volatile bool* stop )
+{
+	this->deque = deque;
+	this->stop = stop;
+}
+
+void StealingRunnable::run()
+{
+	while( !*this->stop || !this->deque->isEmpty() )
+	{
+		int* element = this->deque->steal();
+		if( element )
+			this->stolen.push_back( element );
+	}
+}
+
+const std::vector<int*>& StealingRunnable::getStolen() const
+{
+	return this->stolen;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <atomic>
+#include <vector>
+
+#include "Common.h"
+#include "syscommon/concurrent/ForkJoinPool.h"
+#include "syscommon/concurrent/ForkJoinTask.h"
+#include "syscommon/concurrent/WorkStealingDeque.h"
+
+class ForkJoinPoolTest: public CppUnit::TestFixture
+{
+	//----------------------------------------------------------
+	//                    STATIC VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                   INSTANCE VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                      CONSTRUCTORS
+	//----------------------------------------------------------
+	public:
+		ForkJoinPoolTest();
+		virtual ~ForkJoinPoolTest();
+
+	//----------------------------------------------------------
+	//                    INSTANCE METHODS
+	//----------------------------------------------------------
+	public:
+		void setUp();
+		void tearDown();
+
+	protected:
+		void testDequeOrdering();
+		void testDequeGrowth();
+		void testDequeConcurrentSteal();
+		void testForkJoin();
+		void testParallelFor();
+		void testCurrentThreadIntegration();
+		void testTaskFailure();
+		void testForkOutsidePool();
+
+	//----------------------------------------------------------
+	//                     STATIC METHODS
+	//----------------------------------------------------------
+	CPPUNIT_TEST_SUITE( ForkJoinPoolTest );
+		CPPUNIT_TEST( testDequeOrdering );
+		CPPUNIT_TEST( testDequeGrowth );
+		CPPUNIT_TEST( testDequeConcurrentSteal );
+		CPPUNIT_TEST( testForkJoin );
+		CPPUNIT_TEST( testParallelFor );
+		CPPUNIT_TEST( testCurrentThreadIntegration );
+		CPPUNIT_TEST( testTaskFailure );
+		CPPUNIT_TEST( testForkOutsidePool );
+	CPPUNIT_TEST_SUITE_END();
+};
+
+// FibonacciTask helper class, computes fibonacci numbers by recursive forking
+class FibonacciTask : public syscommon::ForkJoinTask
+{
+	private:
+		int n;
+
+	public:
+		long result;
+
+		FibonacciTask( int n );
+		virtual void run();
+};
+
+// RangeCounter helper function object, counts the number of times each index is visited
+class RangeCounter
+{
+	private:
+		std::vector<std::atomic<int> >* visits;
+
+	public:
+		RangeCounter( std::vector<std::atomic<int> >* visits );
+		void operator()( long begin, long end );
+};
+
+// PoolMembershipTask helper class, records what the running thread knows about its pool
+class PoolMembershipTask : public syscommon::ForkJoinTask
+{
+	public:
+		bool inPool;
+		syscommon::ForkJoinPool* currentPool;
+		syscommon::Thread* currentThread;
+
+		PoolMembershipTask();
+		virtual void run();
+};
+
+// FailingTask helper class, always throws
+class FailingTask : public syscommon::ForkJoinTask
+{
+	public:
+		virtual void run();
+};
+
+// StealingRunnable helper class, steals from a deque until told to stop
+class StealingRunnable : public syscommon::IRunnable
+{
+	private:
+		syscommon::WorkStealingDeque<int>* deque;
+		std::vector<int*> stolen;
+		volatile bool* stop;
+
+	public:
+		StealingRunnable( syscommon::WorkStealingDeque<int>* deque, volatile bool* stop );
+		virtual void run();
+		const std::vector<int*>& getStolen() const;
+};
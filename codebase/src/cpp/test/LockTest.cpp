@@ -92,6 +92,65 @@ void LockTest::testLock()
 	threadThree.join();
 }
 
+void LockTest::testRecursiveLock()
+{
+	syscommon::Lock lock;
+	CPPUNIT_ASSERT_EQUAL( syscommon::LP_RECURSIVE, lock.getPolicy() );
+
+	// The owner can take the lock again, and must release it as many times
+	lock.lock();
+	lock.lock();
+	lock.unlock();
+
+	LockRunnable runnable( &lock );
+	syscommon::Thread thread( &runnable, "ThreadOne" );
+	thread.start();
+	runnable.signalLock();
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_TIMEOUT, runnable.waitForLocked(100L) );
+
+	lock.unlock();
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_SUCCEEDED, runnable.waitForLocked(5000L) );
+	runnable.signalUnlock();
+	thread.join();
+}
+
+void LockTest::testLockPolicies()
+{
+	const syscommon::LockPolicy policies[] = { syscommon::LP_RECURSIVE,
+	                                           syscommon::LP_PLAIN,
+	                                           syscommon::LP_ADAPTIVE,
+	                                           syscommon::LP_QUEUED };
+	const int threadCount = 4;
+	const long increments = 20000;
+
+	for( int p = 0 ; p < 4 ; ++p )
+	{
+		syscommon::Lock lock( policies[p] );
+		CPPUNIT_ASSERT_EQUAL( policies[p], lock.getPolicy() );
+
+		// Unguarded read-modify-write cycles would lose updates if the lock let two threads in
+		volatile long counter = 0;
+		GuardedCounter* counters[threadCount];
+		syscommon::Thread* threads[threadCount];
+		for( int i = 0 ; i < threadCount ; ++i )
+		{
+			counters[i] = new GuardedCounter( &lock, &counter, increments );
+			threads[i] = new syscommon::Thread( counters[i] );
+			threads[i]->start();
+		}
+
+		for( int i = 0 ; i < threadCount ; ++i )
+		{
+			threads[i]->join();
+			delete threads[i];
+			delete counters[i];
+		}
+
+		if( counter != threadCount * increments )
+			failTest( "Policy %d: expected a count of %ld, got %ld", p, threadCount * increments, counter );
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /////////////////////////////  SyncPointRunnable  /////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -145,3 +204,24 @@ bool LockRunnable::isHoldingLock()
 {
 	return this->holdingLock;
 }
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////  GuardedCounter  //////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+GuardedCounter::GuardedCounter( syscommon::Lock* lock, volatile long* counter, long increments )
+{
+	this->lock = lock;
+	this->counter = counter;
+	this->increments = increments;
+}
+
+void GuardedCounter::run()
+{
+	for( long i = 0 ; i < this->increments ; ++i )
+	{
+		syscommon::LockGuard guard( *this->lock );
+		long value = *this->counter;
+		syscommon::Platform::yieldThread();
+		*this->counter = value + 1;
+	}
+}
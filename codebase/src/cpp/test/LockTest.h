@@ -46,12 +46,16 @@ class LockTest: public CppUnit::TestFixture
 
 	protected:
 		void testLock();
+		void testRecursiveLock();
+		void testLockPolicies();
 
 	//----------------------------------------------------------
 	//                     STATIC METHODS
 	//----------------------------------------------------------
 	CPPUNIT_TEST_SUITE( LockTest );
 		CPPUNIT_TEST( testLock );
+		CPPUNIT_TEST( testRecursiveLock );
+		CPPUNIT_TEST( testLockPolicies );
 	CPPUNIT_TEST_SUITE_END();
 };
 
@@ -95,3 +99,15 @@ class LockRunnable : public syscommon::IRunnable
 	//----------------------------------------------------------
 };
 
+// GuardedCounter helper class, increments a shared counter under a LockGuard
+class GuardedCounter : public syscommon::IRunnable
+{
+	private:
+		syscommon::Lock* lock;
+		volatile long* counter;
+		long increments;
+
+	public:
+		GuardedCounter( syscommon::Lock* lock, volatile long* counter, long increments );
+		virtual void run();
+};
@@ -15,6 +15,8 @@
 #include "MulticastSocketTest.h"
 
 #include <cstring>
+#include <limits.h>
+#include <vector>
 #include "syscommon/Platform.h"
 #include "syscommon/net/MulticastSocket.h"
 
@@ -348,3 +350,230 @@ void MulticastSocketTest::testReceiveWhileClosed()
 		failTestWrongException( "SocketException", e, "receiving on a closed socket" );
 	}
 }
+
+void MulticastSocketTest::testSendReceiveBatch()
+{
+	syscommon::MulticastSocket sender( syscommon::InetSocketAddress(INADDR_LOOPBACK, 3040) );
+	syscommon::MulticastSocket receiver( syscommon::InetSocketAddress(INADDR_LOOPBACK, 3041) );
+
+	// More than one batch's worth, so that the packets are split across several calls
+	const int count = syscommon::DatagramMessage::MAX_BATCH * 2 + 5;
+	std::vector<char> sendBuffer( count * 16 );
+	std::vector<syscommon::DatagramPacket> sendPackets;
+	for( int i = 0; i < count; ++i )
+	{
+		char* data = &sendBuffer[i * 16];
+		int length = ::sprintf( data, "packet %d", i );
+		sendPackets.push_back( syscommon::DatagramPacket(data, 0, length, INADDR_LOOPBACK, 3041) );
+	}
+
+	CPPUNIT_ASSERT_EQUAL( count, sender.sendBatch(&sendPackets[0], count) );
+
+	std::vector<char> receiveBuffer( count * 32 );
+	std::vector<syscommon::DatagramPacket> receivePackets;
+	for( int i = 0; i < count; ++i )
+		receivePackets.push_back( syscommon::DatagramPacket(&receiveBuffer[i * 32], 32) );
+
+	// Everything has already arrived over loopback, but allow for it coming in several goes
+	int received = 0;
+	while( received < count )
+	{
+		int result = receiver.receiveBatch( &receivePackets[received], count - received, 1000 );
+		if( result == 0 )
+			failTest( "Only received %d of %d datagrams", received, count );
+
+		received += result;
+	}
+
+	for( int i = 0; i < count; ++i )
+	{
+		syscommon::DatagramPacket& packet = receivePackets[i];
+		CPPUNIT_ASSERT_EQUAL( sendPackets[i].getLength(), packet.getLength() );
+		CPPUNIT_ASSERT( ::memcmp(&sendBuffer[i * 16], packet.getData(), packet.getLength()) == 0 );
+		CPPUNIT_ASSERT( packet.getAddress() == INADDR_LOOPBACK );
+		CPPUNIT_ASSERT_EQUAL( (unsigned short)3040, packet.getPort() );
+	}
+
+	// A packet without a destination fails the batch before anything is sent
+	sendPackets.push_back( syscommon::DatagramPacket(&sendBuffer[0], 4) );
+	try
+	{
+		sender.sendBatch( &sendPackets[count - 1], 2 );
+		failTestMissingException( "SocketException", "sending a batch without a destination address" );
+	}
+	catch( syscommon::SocketException& )
+	{
+		// SUCCESS!
+	}
+
+	sender.close();
+	receiver.close();
+}
+
+void MulticastSocketTest::testSendBatchToDestinations()
+{
+	syscommon::MulticastSocket sender( syscommon::InetSocketAddress(INADDR_LOOPBACK, 3042) );
+	syscommon::MulticastSocket first( syscommon::InetSocketAddress(INADDR_LOOPBACK, 3043) );
+	syscommon::MulticastSocket second( syscommon::InetSocketAddress(INADDR_LOOPBACK, 3044) );
+	syscommon::MulticastSocket third( syscommon::InetSocketAddress(INADDR_LOOPBACK, 3045) );
+
+	std::vector<syscommon::InetSocketAddress> destinations;
+	destinations.push_back( syscommon::InetSocketAddress(INADDR_LOOPBACK, 3043) );
+	destinations.push_back( syscommon::InetSocketAddress(INADDR_LOOPBACK, 3044) );
+	destinations.push_back( syscommon::InetSocketAddress(INADDR_LOOPBACK, 3045) );
+
+	const char* message = "Hello subscribers";
+	int length = (int)::strlen( message );
+	CPPUNIT_ASSERT_EQUAL( 3, sender.sendBatch(message, length, &destinations[0], 3) );
+
+	syscommon::MulticastSocket* receivers[] = { &first, &second, &third };
+	for( int i = 0; i < 3; ++i )
+	{
+		char receiveBuffer[64];
+		::memset( receiveBuffer, 0, sizeof(receiveBuffer) );
+		syscommon::DatagramPacket packet( receiveBuffer, sizeof(receiveBuffer) );
+		if( receivers[i]->receiveBatch(&packet, 1, 1000) != 1 )
+			failTest( "Destination %d did not receive the datagram", i );
+
+		CPPUNIT_ASSERT_EQUAL( length, packet.getLength() );
+		CPPUNIT_ASSERT( ::strcmp(message, receiveBuffer) == 0 );
+	}
+
+	sender.close();
+	first.close();
+	second.close();
+	third.close();
+}
+
+void MulticastSocketTest::testReceiveBatchTimeout()
+{
+	syscommon::MulticastSocket receiver( syscommon::InetSocketAddress(INADDR_LOOPBACK, 3046) );
+
+	char receiveBuffer[64];
+	syscommon::DatagramPacket packet( receiveBuffer, sizeof(receiveBuffer) );
+
+	long long started = syscommon::Platform::nanoTime();
+	CPPUNIT_ASSERT_EQUAL( 0, receiver.receiveBatch(&packet, 1, 100) );
+	long long elapsed = (syscommon::Platform::nanoTime() - started) / 1000000;
+	if( elapsed < 90 )
+		failTest( "Receive gave up after %lldms, expected 100ms", elapsed );
+
+	CPPUNIT_ASSERT_EQUAL( 0, receiver.receiveBatch(&packet, 1, 0) );
+
+	// Non-blocking sockets never wait
+	receiver.configureBlocking( false );
+	CPPUNIT_ASSERT_EQUAL( 0, receiver.receiveBatch(&packet, 1, NATIVE_INFINITE_WAIT) );
+
+	receiver.close();
+	try
+	{
+		receiver.receiveBatch( &packet, 1, 0 );
+		failTestMissingException( "SocketException", "receiving a batch on a closed socket" );
+	}
+	catch( syscommon::SocketException& )
+	{
+		// SUCCESS!
+	}
+}
+
+void MulticastSocketTest::testSendSegmented()
+{
+	syscommon::MulticastSocket sender( syscommon::InetSocketAddress(INADDR_LOOPBACK, 3047) );
+	syscommon::MulticastSocket receiver( syscommon::InetSocketAddress(INADDR_LOOPBACK, 3048) );
+
+	// Ten full segments and a short one to finish
+	std::vector<char> sendBuffer( 10500 );
+	for( size_t i = 0; i < sendBuffer.size(); ++i )
+		sendBuffer[i] = (char)(i % 251);
+
+	syscommon::DatagramPacket sendPacket( &sendBuffer[0],
+	                                      0,
+	                                      (int)sendBuffer.size(),
+	                                      INADDR_LOOPBACK,
+	                                      3048 );
+	sendPacket.setSegmentSize( 1000 );
+	CPPUNIT_ASSERT( sender.send(sendPacket) );
+
+	// Without receive offload each segment arrives as a datagram of its own
+	std::vector<char> receiveBuffer( 2048 );
+	syscommon::DatagramPacket receivePacket( &receiveBuffer[0], (int)receiveBuffer.size() );
+	for( int i = 0; i < 11; ++i )
+	{
+		if( receiver.receiveBatch(&receivePacket, 1, 1000) != 1 )
+			failTest( "Only received %d of 11 segments", i );
+
+		int expectedLength = i < 10 ? 1000 : 500;
+		CPPUNIT_ASSERT_EQUAL( expectedLength, receivePacket.getLength() );
+		CPPUNIT_ASSERT_EQUAL( 0, receivePacket.getSegmentSize() );
+		CPPUNIT_ASSERT( ::memcmp(&sendBuffer[i * 1000], &receiveBuffer[0], expectedLength) == 0 );
+	}
+
+	// There is a limit on how many segments one packet can be split into
+	sendPacket.setSegmentSize( 10 );
+	try
+	{
+		sender.send( sendPacket );
+		failTestMissingException( "IllegalArgumentException", "sending too many segments" );
+	}
+	catch( syscommon::IllegalArgumentException& )
+	{
+		// SUCCESS!
+	}
+
+	sender.close();
+	receiver.close();
+}
+
+void MulticastSocketTest::testReceiveOffload()
+{
+	syscommon::MulticastSocket sender( syscommon::InetSocketAddress(INADDR_LOOPBACK, 3049) );
+	syscommon::MulticastSocket receiver( syscommon::InetSocketAddress(INADDR_LOOPBACK, 3050) );
+	CPPUNIT_ASSERT( !receiver.isReceiveOffload() );
+
+	try
+	{
+		receiver.setReceiveOffload( true );
+	}
+	catch( syscommon::SocketException& )
+	{
+		// Nothing more to test where the platform cannot coalesce datagrams
+		return;
+	}
+
+	CPPUNIT_ASSERT( receiver.isReceiveOffload() );
+
+	std::vector<char> sendBuffer( 8000 );
+	for( size_t i = 0; i < sendBuffer.size(); ++i )
+		sendBuffer[i] = (char)(i % 251);
+
+	syscommon::DatagramPacket sendPacket( &sendBuffer[0],
+	                                      0,
+	                                      (int)sendBuffer.size(),
+	                                      INADDR_LOOPBACK,
+	                                      3050 );
+	sendPacket.setSegmentSize( 1000 );
+	CPPUNIT_ASSERT( sender.send(sendPacket) );
+
+	// The kernel is free to hand the segments over in runs of any length, but whatever comes
+	// back in one receive must carry the size it was made up of
+	std::vector<char> receiveBuffer( 65536 );
+	int total = 0;
+	while( total < (int)sendBuffer.size() )
+	{
+		syscommon::DatagramPacket receivePacket( &receiveBuffer[total],
+		                                         (int)receiveBuffer.size() - total );
+		if( receiver.receiveBatch(&receivePacket, 1, 1000) != 1 )
+			failTest( "Only received %d of %d bytes", total, (int)sendBuffer.size() );
+
+		if( receivePacket.getLength() > 1000 )
+			CPPUNIT_ASSERT_EQUAL( 1000, receivePacket.getSegmentSize() );
+
+		total += receivePacket.getLength();
+	}
+
+	CPPUNIT_ASSERT_EQUAL( (int)sendBuffer.size(), total );
+	CPPUNIT_ASSERT( ::memcmp(&sendBuffer[0], &receiveBuffer[0], total) == 0 );
+
+	sender.close();
+	receiver.close();
+}
@@ -53,6 +53,11 @@ class MulticastSocketTest: public CppUnit::TestFixture
 		void testSendWhileClosed();
 		void testSendNoAddress();
 		void testReceiveWhileClosed();
+		void testSendReceiveBatch();
+		void testSendBatchToDestinations();
+		void testReceiveBatchTimeout();
+		void testSendSegmented();
+		void testReceiveOffload();
 
 	//----------------------------------------------------------
 	//                     STATIC METHODS
@@ -69,6 +74,11 @@ class MulticastSocketTest: public CppUnit::TestFixture
 		CPPUNIT_TEST( testSendWhileClosed );
 		CPPUNIT_TEST( testSendNoAddress );
 		CPPUNIT_TEST( testReceiveWhileClosed );
+		CPPUNIT_TEST( testSendReceiveBatch );
+		CPPUNIT_TEST( testSendBatchToDestinations );
+		CPPUNIT_TEST( testReceiveBatchTimeout );
+		CPPUNIT_TEST( testSendSegmented );
+		CPPUNIT_TEST( testReceiveOffload );
 	CPPUNIT_TEST_SUITE_END();
 };
 
@@ -0,0 +1,331 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development
+ * and Distribution License (the "License"). You may not use this file except in
+ * compliance with the License. You can obtain a copy of the license at
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License
+ * for the specific language governing permissions and limitations under the
+ * License.
+ *
+ * When distributing Covered Code, include this CDDL HEADER in each file and
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields
+ * enclosed by brackets "[]" replaced with your own identifying information:
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "PipelineTest.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+CPPUNIT_TEST_SUITE_REGISTRATION( PipelineTest );
+
+using namespace syscommon;
+
+/*
+ * Publishes count slots one at a time, numbering them from zero
+ */
+static void publishSlots( Pipeline<PipelineSlot>& pipeline, long long count )
+{
+	for( long long i = 0 ; i < count ; ++i )
+	{
+		long long sequence = pipeline.next();
+		PipelineSlot& slot = pipeline.get( sequence );
+		slot.value = i;
+		slot.derived = -1;
+		slot.marks = 0;
+		pipeline.publish( sequence );
+	}
+}
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+PipelineTest::PipelineTest()
+{
+
+}
+
+PipelineTest::~PipelineTest()
+{
+
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+void PipelineTest::setUp()
+{
+
+}
+
+void PipelineTest::tearDown()
+{
+
+}
+
+void PipelineTest::testSingleStage()
+{
+	const long long COUNT = 50000;
+
+	// A small ring, so that the producer has to wait for the stage to release slots
+	Pipeline<PipelineSlot> pipeline( 8, WP_YIELD );
+	RecordingHandler handler( 1, 0, false );
+	pipeline.addStage( TEXT("record"), &handler );
+	pipeline.start();
+
+	publishSlots( pipeline, COUNT );
+	pipeline.stop();
+
+	CPPUNIT_ASSERT_EQUAL( (size_t)COUNT, handler.sequences.size() );
+	for( long long i = 0 ; i < COUNT ; ++i )
+		CPPUNIT_ASSERT_EQUAL( i, handler.sequences[(size_t)i] );
+
+	CPPUNIT_ASSERT( handler.endOfBatchCount > 0 );
+	CPPUNIT_ASSERT_EQUAL( 0UL, handler.errors );
+}
+
+void PipelineTest::testDependencies()
+{
+	const long long COUNT = 20000;
+
+	// decode -> ( journal, replicate ) -> business
+	Pipeline<PipelineSlot> pipeline( 16, WP_PARK );
+	RecordingHandler decode( 1, 0, true );
+	RecordingHandler journal( 2, 1, false );
+	RecordingHandler replicate( 4, 1, false );
+	RecordingHandler business( 8, 1 | 2 | 4, false );
+
+	size_t decodeStage = pipeline.addStage( TEXT("decode"), &decode );
+	size_t journalStage = pipeline.addStage( TEXT("journal"), &journal, decodeStage );
+	size_t replicateStage = pipeline.addStage( TEXT("replicate"), &replicate, decodeStage );
+
+	std::vector<size_t> after;
+	after.push_back( journalStage );
+	after.push_back( replicateStage );
+	pipeline.addStage( TEXT("business"), std::vector<IEventHandler<PipelineSlot>*>(1, &business), after );
+	CPPUNIT_ASSERT_EQUAL( (size_t)4, pipeline.getStageCount() );
+
+	pipeline.start();
+	publishSlots( pipeline, COUNT );
+	pipeline.stop();
+
+	RecordingHandler* handlers[] = { &decode, &journal, &replicate, &business };
+	for( int i = 0 ; i < 4 ; ++i )
+	{
+		CPPUNIT_ASSERT_EQUAL( (size_t)COUNT, handlers[i]->sequences.size() );
+		CPPUNIT_ASSERT_EQUAL( 0UL, handlers[i]->errors );
+	}
+}
+
+void PipelineTest::testParallelHandlers()
+{
+	const long long COUNT = 30000;
+	const size_t HANDLERS = 3;
+
+	Pipeline<PipelineSlot> pipeline( 64, WP_YIELD );
+	RecordingHandler decode( 1, 0, true );
+	std::vector<RecordingHandler*> workers;
+	std::vector<IEventHandler<PipelineSlot>*> handlers;
+	for( size_t i = 0 ; i < HANDLERS ; ++i )
+	{
+		workers.push_back( new RecordingHandler(2, 1, false) );
+		handlers.push_back( workers[i] );
+	}
+
+	size_t decodeStage = pipeline.addStage( TEXT("decode"), &decode );
+	pipeline.addStage( TEXT("worker"), handlers, std::vector<size_t>(1, decodeStage) );
+	pipeline.start();
+	publishSlots( pipeline, COUNT );
+	pipeline.stop();
+
+	// Each worker should have been given every HANDLERS'th slot, in order, and between them
+	// they should have seen every slot exactly once
+	size_t total = 0;
+	for( size_t i = 0 ; i < HANDLERS ; ++i )
+	{
+		RecordingHandler* worker = workers[i];
+		CPPUNIT_ASSERT_EQUAL( 0UL, worker->errors );
+		for( size_t j = 0 ; j < worker->sequences.size() ; ++j )
+			CPPUNIT_ASSERT_EQUAL( (long long)(j * HANDLERS + i), worker->sequences[j] );
+
+		total += worker->sequences.size();
+		CPPUNIT_ASSERT( worker->endOfBatchCount > 0 );
+		delete worker;
+	}
+
+	CPPUNIT_ASSERT_EQUAL( (size_t)COUNT, total );
+}
+
+void PipelineTest::testBatchClaim()
+{
+	Pipeline<PipelineSlot> pipeline( 16, WP_YIELD );
+	RecordingHandler handler( 1, 0, false );
+	pipeline.addStage( TEXT("record"), &handler );
+	pipeline.start();
+
+	long long value = 0;
+	for( int batch = 0 ; batch < 1000 ; ++batch )
+	{
+		size_t size = 1 + batch % 16;
+		long long last = pipeline.next( size );
+		for( long long sequence = last - (long long)size + 1 ; sequence <= last ; ++sequence )
+		{
+			pipeline.get( sequence ).value = value++;
+			pipeline.get( sequence ).marks = 0;
+		}
+
+		pipeline.publish( last );
+	}
+
+	pipeline.stop();
+	CPPUNIT_ASSERT_EQUAL( value - 1, pipeline.getCursor() );
+	CPPUNIT_ASSERT_EQUAL( (size_t)value, handler.sequences.size() );
+	CPPUNIT_ASSERT_EQUAL( 0UL, handler.errors );
+}
+
+void PipelineTest::testStatistics()
+{
+	const long long COUNT = 1000;
+
+	Pipeline<PipelineSlot> pipeline( 32, WP_YIELD );
+	RecordingHandler decode( 1, 0, true );
+	ThrowingHandler thrower;
+	size_t decodeStage = pipeline.addStage( TEXT("decode"), &decode );
+	pipeline.addStage( TEXT("thrower"), &thrower, decodeStage );
+	pipeline.start();
+	publishSlots( pipeline, COUNT );
+	pipeline.stop();
+
+	std::vector<Pipeline<PipelineSlot>::StageStatistics> statistics = pipeline.getStatistics();
+	CPPUNIT_ASSERT_EQUAL( (size_t)2, statistics.size() );
+	CPPUNIT_ASSERT( statistics[0].name == TEXT("decode") );
+	CPPUNIT_ASSERT( statistics[1].name == TEXT("thrower") );
+
+	for( size_t i = 0 ; i < statistics.size() ; ++i )
+	{
+		CPPUNIT_ASSERT_EQUAL( (size_t)1, statistics[i].handlerCount );
+		CPPUNIT_ASSERT_EQUAL( COUNT - 1, statistics[i].sequence );
+		CPPUNIT_ASSERT_EQUAL( 0LL, statistics[i].lag );
+		CPPUNIT_ASSERT_EQUAL( (unsigned long long)COUNT, statistics[i].processed );
+		CPPUNIT_ASSERT( statistics[i].batches > 0 );
+		CPPUNIT_ASSERT( statistics[i].batches <= (unsigned long long)COUNT );
+		CPPUNIT_ASSERT( statistics[i].throughput > 0.0 );
+	}
+
+	// Every odd value threw, and the stage carried on regardless
+	CPPUNIT_ASSERT_EQUAL( 0ULL, statistics[0].failures );
+	CPPUNIT_ASSERT_EQUAL( (unsigned long long)(COUNT / 2), statistics[1].failures );
+}
+
+void PipelineTest::testIllegalUsage()
+{
+	try
+	{
+		Pipeline<PipelineSlot> pipeline( 0, WP_YIELD );
+		failTestMissingException( "IllegalArgumentException", "creating a pipeline with no capacity" );
+	}
+	catch( IllegalArgumentException& )
+	{
+		// Expected
+	}
+
+	Pipeline<PipelineSlot> pipeline( 8, WP_YIELD );
+	RecordingHandler handler( 1, 0, false );
+
+	try
+	{
+		pipeline.start();
+		failTestMissingException( "IllegalStateException", "starting a pipeline with no stages" );
+	}
+	catch( IllegalStateException& )
+	{
+		// Expected
+	}
+
+	try
+	{
+		pipeline.addStage( TEXT("record"), &handler, 3 );
+		failTestMissingException( "IllegalArgumentException", "depending on a missing stage" );
+	}
+	catch( IllegalArgumentException& )
+	{
+		// Expected
+	}
+
+	pipeline.addStage( TEXT("record"), &handler );
+
+	try
+	{
+		pipeline.next();
+		failTestMissingException( "IllegalStateException", "claiming a slot before start()" );
+	}
+	catch( IllegalStateException& )
+	{
+		// Expected
+	}
+
+	pipeline.start();
+
+	try
+	{
+		pipeline.addStage( TEXT("late"), &handler );
+		failTestMissingException( "IllegalStateException", "adding a stage after start()" );
+	}
+	catch( IllegalStateException& )
+	{
+		// Expected
+	}
+
+	try
+	{
+		pipeline.next( 9 );
+		failTestMissingException( "IllegalArgumentException", "claiming more slots than the capacity" );
+	}
+	catch( IllegalArgumentException& )
+	{
+		// Expected
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//////////////////////////////  RecordingHandler  /////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+RecordingHandler::RecordingHandler( unsigned int mark, unsigned int requiredMarks, bool derive )
+{
+	this->mark = mark;
+	this->requiredMarks = requiredMarks;
+	this->derive = derive;
+	this->endOfBatchCount = 0;
+	this->errors = 0;
+}
+
+void RecordingHandler::onEvent( PipelineSlot& event, long long sequence, bool endOfBatch )
+{
+	this->sequences.push_back( sequence );
+	if( endOfBatch )
+		++this->endOfBatchCount;
+
+	// Every stage we depend on should have finished with the slot, and none of the stages that
+	// depend on us should have started on it
+	bool dependenciesDone = ( event.marks & this->requiredMarks ) == this->requiredMarks;
+	if( !dependenciesDone || event.value != sequence )
+		++this->errors;
+
+	if( this->derive )
+		event.derived = event.value * 2;
+	else if( event.derived != event.value * 2 && this->requiredMarks != 0 )
+		++this->errors;
+
+	// Stages that run in parallel each set their own bit
+	event.marks.fetch_or( this->mark );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//////////////////////////////  ThrowingHandler  //////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+void ThrowingHandler::onEvent( PipelineSlot& event, long long sequence, bool endOfBatch )
+{
+	if( event.value % 2 == 1 )
+		throw Exception( TEXT("Odd value") );
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development
+ * and Distribution License (the "License"). You may not use this file except in
+ * compliance with the License. You can obtain a copy of the license at
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License
+ * for the specific language governing permissions and limitations under the
+ * License.
+ *
+ * When distributing Covered Code, include this CDDL HEADER in each file and
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields
+ * enclosed by brackets "[]" replaced with your own identifying information:
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <atomic>
+#include <vector>
+
+#include "Common.h"
+#include "syscommon/concurrent/Pipeline.h"
+
+class PipelineTest: public CppUnit::TestFixture
+{
+	//----------------------------------------------------------
+	//                    STATIC VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                   INSTANCE VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                      CONSTRUCTORS
+	//----------------------------------------------------------
+	public:
+		PipelineTest();
+		virtual ~PipelineTest();
+
+	//----------------------------------------------------------
+	//                    INSTANCE METHODS
+	//----------------------------------------------------------
+	public:
+		void setUp();
+		void tearDown();
+
+	protected:
+		void testSingleStage();
+		void testDependencies();
+		void testParallelHandlers();
+		void testBatchClaim();
+		void testStatistics();
+		void testIllegalUsage();
+
+	//----------------------------------------------------------
+	//                     STATIC METHODS
+	//----------------------------------------------------------
+	CPPUNIT_TEST_SUITE( PipelineTest );
+		CPPUNIT_TEST( testSingleStage );
+		CPPUNIT_TEST( testDependencies );
+		CPPUNIT_TEST( testParallelHandlers );
+		CPPUNIT_TEST( testBatchClaim );
+		CPPUNIT_TEST( testStatistics );
+		CPPUNIT_TEST( testIllegalUsage );
+	CPPUNIT_TEST_SUITE_END();
+};
+
+// The slot type used by the pipeline tests. Each stage sets its own bit in marks.
+struct PipelineSlot
+{
+	long long value;
+	long long derived;
+	std::atomic<unsigned int> marks;
+
+	PipelineSlot() : value( -1 ), derived( -1 ), marks( 0 ) {}
+};
+
+// RecordingHandler helper class, records the sequences it is given and checks that the stages it
+// depends on have already seen each slot
+class RecordingHandler : public syscommon::IEventHandler<PipelineSlot>
+{
+	private:
+		unsigned int mark;
+		unsigned int requiredMarks;
+		bool derive;
+
+	public:
+		std::vector<long long> sequences;
+		unsigned long endOfBatchCount;
+		unsigned long errors;
+
+		RecordingHandler( unsigned int mark, unsigned int requiredMarks, bool derive );
+		virtual void onEvent( PipelineSlot& event, long long sequence, bool endOfBatch );
+};
+
+// ThrowingHandler helper class, throws for every slot with an odd value
+class ThrowingHandler : public syscommon::IEventHandler<PipelineSlot>
+{
+	public:
+		virtual void onEvent( PipelineSlot& event, long long sequence, bool endOfBatch );
+};
@@ -0,0 +1,319 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "ReadWriteLockTest.h"
+
+#include <limits.h>
+#include "syscommon/Platform.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+CPPUNIT_TEST_SUITE_REGISTRATION( ReadWriteLockTest );
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+ReadWriteLockTest::ReadWriteLockTest()
+{
+
+}
+
+ReadWriteLockTest::~ReadWriteLockTest()
+{
+
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+void ReadWriteLockTest::setUp()
+{
+
+}
+
+void ReadWriteLockTest::tearDown()
+{
+
+}
+
+void ReadWriteLockTest::testConcurrentReaders()
+{
+	syscommon::ReadWriteLock lock;
+	ReadWriteLockRunnable readerOne( &lock, false );
+	ReadWriteLockRunnable readerTwo( &lock, false );
+	syscommon::Thread threadOne( &readerOne, "ReaderOne" );
+	syscommon::Thread threadTwo( &readerTwo, "ReaderTwo" );
+	threadOne.start();
+	threadTwo.start();
+
+	// Both readers should get in together
+	readerOne.signalLock();
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_SUCCEEDED, readerOne.waitForLocked(5000L) );
+	readerTwo.signalLock();
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_SUCCEEDED, readerTwo.waitForLocked(5000L) );
+
+	// And so should a third, on this thread
+	CPPUNIT_ASSERT( lock.tryReadLock(0) );
+	lock.readUnlock();
+
+	// But not a writer
+	CPPUNIT_ASSERT( !lock.tryWriteLock(0) );
+
+	readerOne.signalUnlock();
+	readerTwo.signalUnlock();
+	threadOne.join();
+	threadTwo.join();
+
+	CPPUNIT_ASSERT( lock.tryWriteLock(0) );
+	lock.writeUnlock();
+}
+
+void ReadWriteLockTest::testWriterExcludesReaders()
+{
+	syscommon::ReadWriteLock lock;
+	ReadWriteLockRunnable writer( &lock, true );
+	ReadWriteLockRunnable reader( &lock, false );
+	syscommon::Thread writerThread( &writer, "Writer" );
+	syscommon::Thread readerThread( &reader, "Reader" );
+	writerThread.start();
+	readerThread.start();
+
+	writer.signalLock();
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_SUCCEEDED, writer.waitForLocked(5000L) );
+
+	// The reader must wait for the writer to finish
+	reader.signalLock();
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_TIMEOUT, reader.waitForLocked(100L) );
+	CPPUNIT_ASSERT( !reader.isHoldingLock() );
+
+	writer.signalUnlock();
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_SUCCEEDED, reader.waitForLocked(5000L) );
+	CPPUNIT_ASSERT( reader.isHoldingLock() );
+
+	reader.signalUnlock();
+	writerThread.join();
+	readerThread.join();
+}
+
+void ReadWriteLockTest::testTryLockTimeout()
+{
+	syscommon::ReadWriteLock lock;
+	ReadWriteLockRunnable writer( &lock, true );
+	syscommon::Thread writerThread( &writer, "Writer" );
+	writerThread.start();
+
+	writer.signalLock();
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_SUCCEEDED, writer.waitForLocked(5000L) );
+
+	unsigned long start = syscommon::Platform::getCurrentTimeMilliseconds();
+	CPPUNIT_ASSERT( !lock.tryReadLock(100) );
+	CPPUNIT_ASSERT( !lock.tryWriteLock(100) );
+	unsigned long elapsed = syscommon::Platform::getCurrentTimeMilliseconds() - start;
+	if( elapsed < 180 )
+		failTest( "Timed acquires returned after %lums, expected at least 200ms", elapsed );
+
+	writer.signalUnlock();
+	writerThread.join();
+
+	// A writer that gives up must not leave readers queued behind it
+	ReadWriteLockRunnable reader( &lock, false );
+	syscommon::Thread readerThread( &reader, "Reader" );
+	readerThread.start();
+	reader.signalLock();
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_SUCCEEDED, reader.waitForLocked(5000L) );
+
+	CPPUNIT_ASSERT( !lock.tryWriteLock(50) );
+	CPPUNIT_ASSERT( lock.tryReadLock(0) );
+	lock.readUnlock();
+
+	reader.signalUnlock();
+	readerThread.join();
+}
+
+void ReadWriteLockTest::testWriterPreference()
+{
+	syscommon::ReadWriteLock lock;
+	ReadWriteLockRunnable firstReader( &lock, false );
+	ReadWriteLockRunnable writer( &lock, true );
+	ReadWriteLockRunnable lateReader( &lock, false );
+	syscommon::Thread firstThread( &firstReader, "FirstReader" );
+	syscommon::Thread writerThread( &writer, "Writer" );
+	syscommon::Thread lateThread( &lateReader, "LateReader" );
+	firstThread.start();
+	writerThread.start();
+	lateThread.start();
+
+	firstReader.signalLock();
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_SUCCEEDED, firstReader.waitForLocked(5000L) );
+
+	// The writer queues behind the reader that holds the lock
+	writer.signalLock();
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_TIMEOUT, writer.waitForLocked(100L) );
+
+	// A reader that arrives now must queue behind the writer, even though the lock is only
+	// held for reading
+	lateReader.signalLock();
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_TIMEOUT, lateReader.waitForLocked(100L) );
+
+	// Once the first reader leaves, the writer goes next
+	firstReader.signalUnlock();
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_SUCCEEDED, writer.waitForLocked(5000L) );
+	CPPUNIT_ASSERT( !lateReader.isHoldingLock() );
+
+	writer.signalUnlock();
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_SUCCEEDED, lateReader.waitForLocked(5000L) );
+	lateReader.signalUnlock();
+
+	firstThread.join();
+	writerThread.join();
+	lateThread.join();
+}
+
+void ReadWriteLockTest::testGuards()
+{
+	const int writerCount = 2;
+	const int readerCount = 4;
+	const long iterations = 20000;
+
+	syscommon::ReadWriteLock lock;
+	volatile long first = 0;
+	volatile long second = 0;
+	volatile long mismatches = 0;
+
+	GuardedPair* runnables[writerCount + readerCount];
+	syscommon::Thread* threads[writerCount + readerCount];
+	for( int i = 0 ; i < writerCount + readerCount ; ++i )
+	{
+		bool writer = i < writerCount;
+		runnables[i] = new GuardedPair( &lock, &first, &second, iterations, writer, &mismatches );
+		threads[i] = new syscommon::Thread( runnables[i] );
+		threads[i]->start();
+	}
+
+	for( int i = 0 ; i < writerCount + readerCount ; ++i )
+	{
+		threads[i]->join();
+		delete threads[i];
+		delete runnables[i];
+	}
+
+	CPPUNIT_ASSERT_EQUAL( 0L, (long)mismatches );
+	if( first != writerCount * iterations || second != writerCount * iterations )
+		failTest( "Expected both values to be %ld, got %ld and %ld", writerCount * iterations, first, second );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////  ReadWriteLockRunnable  ///////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+ReadWriteLockRunnable::ReadWriteLockRunnable( syscommon::ReadWriteLock* lock, bool writer ) :
+		lockEvent(false, TEXT("lock")),
+		lockedEvent(false, TEXT("locked")),
+		unlockEvent(false, TEXT("unlock"))
+{
+	this->holdingLock = false;
+	this->lock = lock;
+	this->writer = writer;
+}
+
+ReadWriteLockRunnable::~ReadWriteLockRunnable()
+{
+
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+void ReadWriteLockRunnable::run()
+{
+	lockEvent.waitFor();
+	if( this->writer )
+		this->lock->writeLock();
+	else
+		this->lock->readLock();
+
+	this->holdingLock = true;
+	lockedEvent.signal();
+	unlockEvent.waitFor();
+	this->holdingLock = false;
+
+	if( this->writer )
+		this->lock->writeUnlock();
+	else
+		this->lock->readUnlock();
+}
+
+void ReadWriteLockRunnable::signalLock()
+{
+	lockEvent.signal();
+}
+
+syscommon::WaitResult ReadWriteLockRunnable::waitForLocked( unsigned long timeout )
+{
+	return lockedEvent.waitFor( timeout );
+}
+
+void ReadWriteLockRunnable::signalUnlock()
+{
+	unlockEvent.signal();
+}
+
+bool ReadWriteLockRunnable::isHoldingLock()
+{
+	return this->holdingLock;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+////////////////////////////////  GuardedPair  ////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+GuardedPair::GuardedPair( syscommon::ReadWriteLock* lock,
+                          volatile long* first,
+                          volatile long* second,
+                          long iterations,
+                          bool writer,
+                          volatile long* mismatches )
+{
+	this->lock = lock;
+	this->first = first;
+	this->second = second;
+	this->iterations = iterations;
+	this->writer = writer;
+	this->mismatches = mismatches;
+}
+
+void GuardedPair::run()
+{
+	for( long i = 0 ; i < this->iterations ; ++i )
+	{
+		if( this->writer )
+		{
+			syscommon::WriteLockGuard guard( *this->lock );
+			*this->first = *this->first + 1;
+			syscommon::Platform::yieldThread();
+			*this->second = *this->second + 1;
+		}
+		else
+		{
+			syscommon::ReadLockGuard guard( *this->lock );
+			long firstValue = *this->first;
+			syscommon::Platform::yieldThread();
+			if( firstValue != *this->second )
+				*this->mismatches = *this->mismatches + 1;
+		}
+	}
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include "Common.h"
+#include "syscommon/concurrent/Thread.h"
+#include "syscommon/concurrent/Event.h"
+#include "syscommon/concurrent/ReadWriteLock.h"
+
+class ReadWriteLockTest: public CppUnit::TestFixture
+{
+	//----------------------------------------------------------
+	//                    STATIC VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                   INSTANCE VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                      CONSTRUCTORS
+	//----------------------------------------------------------
+	public:
+		ReadWriteLockTest();
+		virtual ~ReadWriteLockTest();
+
+	//----------------------------------------------------------
+	//                    INSTANCE METHODS
+	//----------------------------------------------------------
+	public:
+		void setUp();
+		void tearDown();
+
+	protected:
+		void testConcurrentReaders();
+		void testWriterExcludesReaders();
+		void testTryLockTimeout();
+		void testWriterPreference();
+		void testGuards();
+
+	//----------------------------------------------------------
+	//                     STATIC METHODS
+	//----------------------------------------------------------
+	CPPUNIT_TEST_SUITE( ReadWriteLockTest );
+		CPPUNIT_TEST( testConcurrentReaders );
+		CPPUNIT_TEST( testWriterExcludesReaders );
+		CPPUNIT_TEST( testTryLockTimeout );
+		CPPUNIT_TEST( testWriterPreference );
+		CPPUNIT_TEST( testGuards );
+	CPPUNIT_TEST_SUITE_END();
+};
+
+// ReadWriteLockRunnable helper class, takes the read or write side of the lock on request
+class ReadWriteLockRunnable : public syscommon::IRunnable
+{
+	//----------------------------------------------------------
+	//                    STATIC VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                   INSTANCE VARIABLES
+	//----------------------------------------------------------
+	private:
+		syscommon::Event lockEvent;
+		syscommon::Event lockedEvent;
+		syscommon::Event unlockEvent;
+		volatile bool holdingLock;
+
+		syscommon::ReadWriteLock* lock;
+		bool writer;
+
+	//----------------------------------------------------------
+	//                      CONSTRUCTORS
+	//----------------------------------------------------------
+	public:
+		ReadWriteLockRunnable( syscommon::ReadWriteLock* lock, bool writer );
+		virtual ~ReadWriteLockRunnable();
+
+	//----------------------------------------------------------
+	//                    INSTANCE METHODS
+	//----------------------------------------------------------
+	public:
+		virtual void run();
+		void signalLock();
+		syscommon::WaitResult waitForLocked( unsigned long timeout );
+		void signalUnlock();
+		bool isHoldingLock();
+
+	//----------------------------------------------------------
+	//                     STATIC METHODS
+	//----------------------------------------------------------
+};
+
+// GuardedPair helper class, writers keep both values equal and readers check that they are
+class GuardedPair : public syscommon::IRunnable
+{
+	private:
+		syscommon::ReadWriteLock* lock;
+		volatile long* first;
+		volatile long* second;
+		long iterations;
+		bool writer;
+		volatile long* mismatches;
+
+	public:
+		GuardedPair( syscommon::ReadWriteLock* lock,
+		             volatile long* first,
+		             volatile long* second,
+		             long iterations,
+		             bool writer,
+		             volatile long* mismatches );
+		virtual void run();
+};
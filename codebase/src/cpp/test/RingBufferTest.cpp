@@ -0,0 +1,299 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development
+ * and Distribution License (the "License"). You may not use this file except in
+ * compliance with the License. You can obtain a copy of the license at
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License
+ * for the specific language governing permissions and limitations under the
+ * License.
+ *
+ * When distributing Covered Code, include this CDDL HEADER in each file and
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields
+ * enclosed by brackets "[]" replaced with your own identifying information:
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "RingBufferTest.h"
+
+#include <limits.h>
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+CPPUNIT_TEST_SUITE_REGISTRATION( RingBufferTest );
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+RingBufferTest::RingBufferTest()
+{
+
+}
+
+RingBufferTest::~RingBufferTest()
+{
+
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+void RingBufferTest::setUp()
+{
+
+}
+
+void RingBufferTest::tearDown()
+{
+
+}
+
+void RingBufferTest::testCapacity()
+{
+	try
+	{
+		syscommon::SpscRingBuffer<int> ring( 0, syscommon::WP_SPIN );
+		failTestMissingException( "IllegalArgumentException", "creating a ring buffer with no capacity" );
+	}
+	catch( syscommon::IllegalArgumentException& )
+	{
+		// Expected
+	}
+
+	try
+	{
+		syscommon::MpscRingBuffer<int> ring( 0, syscommon::WP_SPIN );
+		failTestMissingException( "IllegalArgumentException", "creating a ring buffer with no capacity" );
+	}
+	catch( syscommon::IllegalArgumentException& )
+	{
+		// Expected
+	}
+
+	// Capacities are rounded up to a power of two
+	syscommon::SpscRingBuffer<int> spsc( 5, syscommon::WP_SPIN );
+	CPPUNIT_ASSERT_EQUAL( (size_t)8, spsc.getCapacity() );
+	syscommon::MpscRingBuffer<int> mpsc( 16, syscommon::WP_SPIN );
+	CPPUNIT_ASSERT_EQUAL( (size_t)16, mpsc.getCapacity() );
+}
+
+void RingBufferTest::testSpscOfferAndPoll()
+{
+	syscommon::SpscRingBuffer<int> ring( 4, syscommon::WP_SPIN );
+	int value = 0;
+	CPPUNIT_ASSERT( !ring.poll(value) );
+
+	// Go round the ring a few times so that the indices wrap
+	for( int round = 0 ; round < 5 ; ++round )
+	{
+		for( int i = 0 ; i < 4 ; ++i )
+			CPPUNIT_ASSERT( ring.offer(round * 10 + i) );
+
+		CPPUNIT_ASSERT( !ring.offer(99) );
+		CPPUNIT_ASSERT_EQUAL( (size_t)4, ring.size() );
+
+		for( int i = 0 ; i < 4 ; ++i )
+		{
+			CPPUNIT_ASSERT( ring.poll(value) );
+			CPPUNIT_ASSERT_EQUAL( round * 10 + i, value );
+		}
+
+		CPPUNIT_ASSERT( !ring.poll(value) );
+	}
+
+	CPPUNIT_ASSERT( ring.isEmpty() );
+}
+
+void RingBufferTest::testSpscBatch()
+{
+	syscommon::SpscRingBuffer<int> ring( 8, syscommon::WP_SPIN );
+	int values[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+	std::vector<int> batch;
+
+	CPPUNIT_ASSERT_EQUAL( (size_t)0, ring.drainTo(batch, 4) );
+
+	// Only as many as fit are published
+	CPPUNIT_ASSERT_EQUAL( (size_t)6, ring.offer(values, 6) );
+	CPPUNIT_ASSERT_EQUAL( (size_t)2, ring.offer(values + 6, 4) );
+	CPPUNIT_ASSERT_EQUAL( (size_t)0, ring.offer(values + 8, 2) );
+
+	batch.push_back( -1 );
+	CPPUNIT_ASSERT_EQUAL( (size_t)5, ring.drainTo(batch, 5) );
+	CPPUNIT_ASSERT_EQUAL( (size_t)6, batch.size() );
+	for( int i = 0 ; i < 5 ; ++i )
+		CPPUNIT_ASSERT_EQUAL( i, batch[i + 1] );
+
+	// The freed space is available again, across the end of the ring
+	CPPUNIT_ASSERT_EQUAL( (size_t)2, ring.offer(values + 8, 2) );
+
+	batch.clear();
+	CPPUNIT_ASSERT_EQUAL( (size_t)5, ring.take(batch, 100) );
+	for( int i = 0 ; i < 5 ; ++i )
+		CPPUNIT_ASSERT_EQUAL( i + 5, batch[i] );
+	CPPUNIT_ASSERT( ring.isEmpty() );
+}
+
+void RingBufferTest::testSpscThreaded()
+{
+	// WP_SPIN is left out, as it needs a core for each side to make progress
+	this->runSpscThreaded( syscommon::WP_YIELD );
+	this->runSpscThreaded( syscommon::WP_PARK );
+}
+
+void RingBufferTest::runSpscThreaded( syscommon::WaitPolicy policy )
+{
+	const int COUNT = 200000;
+
+	// A small ring, so that both sides have to wait for each other
+	syscommon::SpscRingBuffer<int> ring( 16, policy );
+	RingProducerRunnable<syscommon::SpscRingBuffer<int> > producer( &ring, 0, COUNT );
+	syscommon::Thread thread( &producer );
+	thread.start();
+
+	std::vector<int> batch;
+	int expected = 0;
+	while( expected < COUNT )
+	{
+		if( expected % 2 == 0 )
+		{
+			CPPUNIT_ASSERT_EQUAL( expected, ring.take() );
+			++expected;
+		}
+		else
+		{
+			batch.clear();
+			ring.take( batch, 5 );
+			for( size_t i = 0 ; i < batch.size() ; ++i )
+				CPPUNIT_ASSERT_EQUAL( expected++, batch[i] );
+		}
+	}
+
+	thread.join();
+	CPPUNIT_ASSERT( ring.isEmpty() );
+}
+
+void RingBufferTest::testMpscOfferAndPoll()
+{
+	syscommon::MpscRingBuffer<int> ring( 4, syscommon::WP_SPIN );
+	int value = 0;
+	CPPUNIT_ASSERT( !ring.poll(value) );
+
+	for( int round = 0 ; round < 5 ; ++round )
+	{
+		for( int i = 0 ; i < 4 ; ++i )
+			CPPUNIT_ASSERT( ring.offer(round * 10 + i) );
+
+		CPPUNIT_ASSERT( !ring.offer(99) );
+		CPPUNIT_ASSERT_EQUAL( (size_t)4, ring.size() );
+
+		for( int i = 0 ; i < 4 ; ++i )
+		{
+			CPPUNIT_ASSERT( ring.poll(value) );
+			CPPUNIT_ASSERT_EQUAL( round * 10 + i, value );
+		}
+
+		CPPUNIT_ASSERT( !ring.poll(value) );
+	}
+
+	CPPUNIT_ASSERT( ring.isEmpty() );
+}
+
+void RingBufferTest::testMpscBatch()
+{
+	syscommon::MpscRingBuffer<int> ring( 8, syscommon::WP_SPIN );
+	int values[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+	std::vector<int> batch;
+
+	CPPUNIT_ASSERT_EQUAL( (size_t)0, ring.drainTo(batch, 4) );
+
+	// Single and batch offers share the same slots
+	CPPUNIT_ASSERT( ring.offer(values[0]) );
+	CPPUNIT_ASSERT_EQUAL( (size_t)5, ring.offer(values + 1, 5) );
+	CPPUNIT_ASSERT_EQUAL( (size_t)2, ring.offer(values + 6, 4) );
+	CPPUNIT_ASSERT_EQUAL( (size_t)0, ring.offer(values + 8, 2) );
+	CPPUNIT_ASSERT( !ring.offer(values[8]) );
+
+	CPPUNIT_ASSERT_EQUAL( (size_t)5, ring.drainTo(batch, 5) );
+	for( int i = 0 ; i < 5 ; ++i )
+		CPPUNIT_ASSERT_EQUAL( i, batch[i] );
+
+	CPPUNIT_ASSERT( ring.offer(values[8]) );
+	CPPUNIT_ASSERT_EQUAL( (size_t)1, ring.offer(values + 9, 1) );
+
+	batch.clear();
+	CPPUNIT_ASSERT_EQUAL( (size_t)5, ring.take(batch, 100) );
+	for( int i = 0 ; i < 5 ; ++i )
+		CPPUNIT_ASSERT_EQUAL( i + 5, batch[i] );
+	CPPUNIT_ASSERT( ring.isEmpty() );
+}
+
+void RingBufferTest::testMpscThreaded()
+{
+	this->runMpscThreaded( syscommon::WP_YIELD );
+	this->runMpscThreaded( syscommon::WP_PARK );
+}
+
+void RingBufferTest::runMpscThreaded( syscommon::WaitPolicy policy )
+{
+	typedef syscommon::MpscRingBuffer<int> Ring;
+	const int PRODUCERS = 4;
+	const int PER_PRODUCER = 50000;
+
+	Ring ring( 64, policy );
+	std::vector<RingProducerRunnable<Ring>*> producers;
+	std::vector<syscommon::Thread*> threads;
+	for( int i = 0 ; i < PRODUCERS ; ++i )
+	{
+		producers.push_back( new RingProducerRunnable<Ring>(&ring, i * PER_PRODUCER, PER_PRODUCER) );
+		threads.push_back( new syscommon::Thread(producers[i]) );
+		threads[i]->start();
+	}
+
+	// Each producer's values should arrive in the order they were put, and every value should
+	// arrive exactly once
+	std::vector<int> next( PRODUCERS );
+	for( int i = 0 ; i < PRODUCERS ; ++i )
+		next[i] = i * PER_PRODUCER;
+
+	std::vector<int> batch;
+	int received = 0;
+	while( received < PRODUCERS * PER_PRODUCER )
+	{
+		batch.clear();
+		ring.take( batch, 32 );
+		for( size_t i = 0 ; i < batch.size() ; ++i )
+		{
+			int producer = batch[i] / PER_PRODUCER;
+			CPPUNIT_ASSERT_EQUAL( next[producer], batch[i] );
+			++next[producer];
+		}
+
+		received += (int)batch.size();
+	}
+
+	for( int i = 0 ; i < PRODUCERS ; ++i )
+	{
+		threads[i]->join();
+		CPPUNIT_ASSERT_EQUAL( (i + 1) * PER_PRODUCER, next[i] );
+		delete threads[i];
+		delete producers[i];
+	}
+
+	CPPUNIT_ASSERT( ring.isEmpty() );
+}
+
+void RingBufferTest::testParkedConsumerWakes()
+{
+	typedef syscommon::SpscRingBuffer<int> Ring;
+	Ring ring( 4, syscommon::WP_PARK );
+	RingTakeRunnable<Ring> taker( &ring );
+	syscommon::Thread thread( &taker );
+	thread.start();
+
+	// Give the consumer time to spin, yield and park, then wake it with a single element
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_TIMEOUT, taker.waitForFinished(200) );
+	CPPUNIT_ASSERT( ring.offer(42) );
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_SUCCEEDED, taker.waitForFinished(5000) );
+	thread.join();
+	CPPUNIT_ASSERT_EQUAL( 42, taker.value );
+}
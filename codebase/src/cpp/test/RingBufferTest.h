@@ -0,0 +1,142 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development
+ * and Distribution License (the "License"). You may not use this file except in
+ * compliance with the License. You can obtain a copy of the license at
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License
+ * for the specific language governing permissions and limitations under the
+ * License.
+ *
+ * When distributing Covered Code, include this CDDL HEADER in each file and
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields
+ * enclosed by brackets "[]" replaced with your own identifying information:
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <vector>
+
+#include "Common.h"
+#include "syscommon/concurrent/SpscRingBuffer.h"
+#include "syscommon/concurrent/MpscRingBuffer.h"
+#include "syscommon/concurrent/Event.h"
+#include "syscommon/concurrent/Thread.h"
+
+class RingBufferTest: public CppUnit::TestFixture
+{
+	//----------------------------------------------------------
+	//                    STATIC VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                   INSTANCE VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                      CONSTRUCTORS
+	//----------------------------------------------------------
+	public:
+		RingBufferTest();
+		virtual ~RingBufferTest();
+
+	//----------------------------------------------------------
+	//                    INSTANCE METHODS
+	//----------------------------------------------------------
+	public:
+		void setUp();
+		void tearDown();
+
+	protected:
+		void testCapacity();
+		void testSpscOfferAndPoll();
+		void testSpscBatch();
+		void testSpscThreaded();
+		void testMpscOfferAndPoll();
+		void testMpscBatch();
+		void testMpscThreaded();
+		void testParkedConsumerWakes();
+
+	private:
+		void runSpscThreaded( syscommon::WaitPolicy policy );
+		void runMpscThreaded( syscommon::WaitPolicy policy );
+
+	//----------------------------------------------------------
+	//                     STATIC METHODS
+	//----------------------------------------------------------
+	CPPUNIT_TEST_SUITE( RingBufferTest );
+		CPPUNIT_TEST( testCapacity );
+		CPPUNIT_TEST( testSpscOfferAndPoll );
+		CPPUNIT_TEST( testSpscBatch );
+		CPPUNIT_TEST( testSpscThreaded );
+		CPPUNIT_TEST( testMpscOfferAndPoll );
+		CPPUNIT_TEST( testMpscBatch );
+		CPPUNIT_TEST( testMpscThreaded );
+		CPPUNIT_TEST( testParkedConsumerWakes );
+	CPPUNIT_TEST_SUITE_END();
+};
+
+// RingProducerRunnable helper class, puts a range of values on a ring buffer, alternating between
+// single elements and batches
+template<typename Ring>
+class RingProducerRunnable : public syscommon::IRunnable
+{
+	private:
+		Ring* ring;
+		int first;
+		int count;
+
+	public:
+		RingProducerRunnable( Ring* ring, int first, int count )
+		{
+			this->ring = ring;
+			this->first = first;
+			this->count = count;
+		}
+
+		virtual void run()
+		{
+			int batch[7];
+			int next = this->first;
+			int end = this->first + this->count;
+			while( next < end )
+			{
+				this->ring->put( next++ );
+
+				int batchSize = 0;
+				while( batchSize < 7 && next < end )
+					batch[batchSize++] = next++;
+
+				this->ring->put( batch, batchSize );
+			}
+		}
+};
+
+// RingTakeRunnable helper class, makes a single blocking take() and records what it got
+template<typename Ring>
+class RingTakeRunnable : public syscommon::IRunnable
+{
+	private:
+		Ring* ring;
+		syscommon::Event finishedEvent;
+
+	public:
+		int value;
+
+		RingTakeRunnable( Ring* ring ) : finishedEvent(false, TEXT("finished"))
+		{
+			this->ring = ring;
+			this->value = -1;
+		}
+
+		virtual void run()
+		{
+			this->value = this->ring->take();
+			this->finishedEvent.signal();
+		}
+
+		syscommon::WaitResult waitForFinished( unsigned long timeout )
+		{
+			return this->finishedEvent.waitFor( timeout );
+		}
+};
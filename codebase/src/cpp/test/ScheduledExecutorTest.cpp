@@ -0,0 +1,310 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "ScheduledExecutorTest.h"
+
+#include <limits.h>
+#include <string>
+#include <vector>
+#include "syscommon/Platform.h"
+#include "ThreadPoolExecutorTest.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+CPPUNIT_TEST_SUITE_REGISTRATION( ScheduledExecutorTest );
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+ScheduledExecutorTest::ScheduledExecutorTest()
+{
+
+}
+
+ScheduledExecutorTest::~ScheduledExecutorTest()
+{
+
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+void ScheduledExecutorTest::setUp()
+{
+
+}
+
+void ScheduledExecutorTest::tearDown()
+{
+
+}
+
+void ScheduledExecutorTest::testSchedule()
+{
+	CountingRunnable counter;
+	syscommon::ScheduledExecutor executor( 2 );
+	CPPUNIT_ASSERT_EQUAL( 2U, executor.getPoolSize() );
+
+	long long start = syscommon::Platform::nanoTime();
+	syscommon::ScheduledFuture* future = executor.schedule( &counter, 50 );
+	CPPUNIT_ASSERT( !future->isPeriodic() );
+	CPPUNIT_ASSERT( future->get(5000) );
+
+	// The task must not run early, and must have run on one of the pool's workers
+	long long elapsedMillis = ( syscommon::Platform::nanoTime() - start ) / 1000000LL;
+	CPPUNIT_ASSERT( elapsedMillis >= 50 );
+	CPPUNIT_ASSERT_EQUAL( 1, counter.getCount() );
+	CPPUNIT_ASSERT( counter.getLastThread() != syscommon::Thread::currentThread() );
+	CPPUNIT_ASSERT( future->isDone() );
+	CPPUNIT_ASSERT( !future->isCancelled() );
+	CPPUNIT_ASSERT_EQUAL( (size_t)0, executor.getQueueSize() );
+
+	delete future;
+}
+
+void ScheduledExecutorTest::testScheduleBeyondBottomLevel()
+{
+	CountingRunnable counter;
+	syscommon::ScheduledExecutor executor( 1 );
+
+	// Far enough ahead to start out in the second level of the wheel and be cascaded down
+	unsigned long delay = syscommon::ScheduledExecutor::WHEEL_SLOTS + 150;
+	long long start = syscommon::Platform::nanoTime();
+	syscommon::ScheduledFuture* future = executor.schedule( &counter, delay );
+	CPPUNIT_ASSERT( future->get(5000) );
+
+	long long elapsedMillis = ( syscommon::Platform::nanoTime() - start ) / 1000000LL;
+	CPPUNIT_ASSERT( elapsedMillis >= (long long)delay );
+	CPPUNIT_ASSERT_EQUAL( 1, counter.getCount() );
+
+	delete future;
+}
+
+void ScheduledExecutorTest::testFixedRate()
+{
+	CountingRunnable counter;
+	syscommon::ScheduledExecutor executor( 2 );
+
+	syscommon::ScheduledFuture* future = executor.scheduleAtFixedRate( &counter, 0, 20 );
+	CPPUNIT_ASSERT( future->isPeriodic() );
+	syscommon::Thread::sleep( 300 );
+
+	// A periodic task is never done until it is cancelled
+	CPPUNIT_ASSERT( !future->get(0) );
+	CPPUNIT_ASSERT( future->cancel(false) );
+	int runs = counter.getCount();
+	CPPUNIT_ASSERT( runs >= 5 );
+	CPPUNIT_ASSERT( runs <= 16 );
+
+	// Once cancelled it must not run again
+	syscommon::Thread::sleep( 100 );
+	CPPUNIT_ASSERT_EQUAL( runs, counter.getCount() );
+
+	delete future;
+}
+
+void ScheduledExecutorTest::testFixedDelay()
+{
+	SleepingRunnable sleeper( 40 );
+	syscommon::ScheduledExecutor executor( 1 );
+
+	// Each run takes 40ms and is followed by a 40ms pause, so runs start at most every 80ms
+	long long start = syscommon::Platform::nanoTime();
+	syscommon::ScheduledFuture* future = executor.scheduleWithFixedDelay( &sleeper, 0, 40 );
+	CPPUNIT_ASSERT( sleeper.waitForStarted(5000) == syscommon::WR_SUCCEEDED );
+	syscommon::Thread::sleep( 400 );
+	future->cancel( false );
+	delete future;
+
+	long long elapsedMillis = ( syscommon::Platform::nanoTime() - start ) / 1000000LL;
+	CPPUNIT_ASSERT( elapsedMillis >= 400 );
+	CPPUNIT_ASSERT( !sleeper.wasInterrupted() );
+}
+
+void ScheduledExecutorTest::testCancelPending()
+{
+	CountingRunnable counter;
+	syscommon::ScheduledExecutor executor( 1 );
+
+	syscommon::ScheduledFuture* future = executor.schedule( &counter, 100000 );
+	CPPUNIT_ASSERT_EQUAL( (size_t)1, executor.getQueueSize() );
+
+	CPPUNIT_ASSERT( future->cancel(false) );
+	CPPUNIT_ASSERT( future->isCancelled() );
+	CPPUNIT_ASSERT( future->isDone() );
+	CPPUNIT_ASSERT_EQUAL( (size_t)0, executor.getQueueSize() );
+
+	// It can only be cancelled once
+	CPPUNIT_ASSERT( !future->cancel(false) );
+
+	try
+	{
+		future->get();
+		failTestMissingException( "CancellationException", "getting a cancelled task" );
+	}
+	catch( syscommon::CancellationException& )
+	{
+		// Success
+	}
+	catch( std::exception& e )
+	{
+		failTestWrongException( "CancellationException", e, "getting a cancelled task" );
+	}
+
+	CPPUNIT_ASSERT_EQUAL( 0, counter.getCount() );
+	delete future;
+}
+
+void ScheduledExecutorTest::testCancelRunningInterrupts()
+{
+	SleepingRunnable sleeper( 10000 );
+	syscommon::ScheduledExecutor executor( 1 );
+
+	syscommon::ScheduledFuture* future = executor.schedule( &sleeper, 0 );
+	CPPUNIT_ASSERT( sleeper.waitForStarted(5000) == syscommon::WR_SUCCEEDED );
+	CPPUNIT_ASSERT_EQUAL( 1U, executor.getActiveCount() );
+
+	CPPUNIT_ASSERT( future->cancel(true) );
+	CPPUNIT_ASSERT( future->isCancelled() );
+
+	// Deleting the future waits for the interrupted task to finish
+	delete future;
+	CPPUNIT_ASSERT( sleeper.wasInterrupted() );
+	CPPUNIT_ASSERT_EQUAL( 0U, executor.getActiveCount() );
+}
+
+void ScheduledExecutorTest::testPeriodicFailure()
+{
+	ThrowingRunnable thrower;
+	syscommon::ScheduledExecutor executor( 1 );
+
+	// A run that throws stops the repetition, and completes the future with the failure
+	syscommon::ScheduledFuture* future = executor.scheduleAtFixedRate( &thrower, 0, 10 );
+	try
+	{
+		future->get( 5000 );
+		failTestMissingException( "ExecutionException", "getting a failed periodic task" );
+	}
+	catch( syscommon::ExecutionException& e )
+	{
+		// The task's own message is passed on
+		CPPUNIT_ASSERT_EQUAL( std::string("task failed"), std::string(e.what()) );
+	}
+	catch( std::exception& e )
+	{
+		failTestWrongException( "ExecutionException", e, "getting a failed periodic task" );
+	}
+
+	CPPUNIT_ASSERT_EQUAL( (size_t)0, executor.getQueueSize() );
+	delete future;
+}
+
+void ScheduledExecutorTest::testManyTimers()
+{
+	const int timerCount = 200000;
+	CountingRunnable counter;
+	syscommon::ScheduledExecutor executor( 2 );
+
+	// Spread the timers across every level of the wheel
+	std::vector<syscommon::ScheduledFuture*> futures;
+	futures.reserve( timerCount );
+	for( int i = 0 ; i < timerCount ; ++i )
+	{
+		unsigned long delay = 60000UL + (unsigned long)i * 7919UL % 100000000UL;
+		futures.push_back( executor.schedule(&counter, delay) );
+	}
+
+	CPPUNIT_ASSERT_EQUAL( (size_t)timerCount, executor.getQueueSize() );
+
+	// Cancel every other one up front, and leave the rest to be cancelled as they are deleted
+	for( int i = 0 ; i < timerCount ; i += 2 )
+		CPPUNIT_ASSERT( futures[i]->cancel(false) );
+
+	CPPUNIT_ASSERT_EQUAL( (size_t)timerCount / 2, executor.getQueueSize() );
+
+	std::vector<syscommon::ScheduledFuture*>::iterator it = futures.begin();
+	for( ; it != futures.end(); ++it )
+		delete *it;
+
+	CPPUNIT_ASSERT_EQUAL( (size_t)0, executor.getQueueSize() );
+	CPPUNIT_ASSERT_EQUAL( 0, counter.getCount() );
+}
+
+void ScheduledExecutorTest::testShutdown()
+{
+	CountingRunnable delayedCounter;
+	CountingRunnable periodicCounter;
+	syscommon::ScheduledExecutor executor( 1 );
+
+	syscommon::ScheduledFuture* delayed = executor.schedule( &delayedCounter, 100 );
+	syscommon::ScheduledFuture* periodic = executor.scheduleAtFixedRate( &periodicCounter,
+	                                                                     100000,
+	                                                                     100 );
+
+	// Periodic tasks are cancelled, but delayed ones still run
+	executor.shutdown();
+	CPPUNIT_ASSERT( executor.isShutdown() );
+	CPPUNIT_ASSERT( periodic->isCancelled() );
+	CPPUNIT_ASSERT( !delayed->isDone() );
+
+	try
+	{
+		executor.schedule( &delayedCounter, 0 );
+		failTestMissingException( "RejectedExecutionException", "scheduling after shutdown" );
+	}
+	catch( syscommon::RejectedExecutionException& )
+	{
+		// Success
+	}
+	catch( std::exception& e )
+	{
+		failTestWrongException( "RejectedExecutionException", e, "scheduling after shutdown" );
+	}
+
+	CPPUNIT_ASSERT( executor.awaitTermination(5000) );
+	CPPUNIT_ASSERT( delayed->isDone() );
+	CPPUNIT_ASSERT( !delayed->isCancelled() );
+	CPPUNIT_ASSERT_EQUAL( 1, delayedCounter.getCount() );
+	CPPUNIT_ASSERT_EQUAL( 0, periodicCounter.getCount() );
+
+	delete periodic;
+	delete delayed;
+}
+
+void ScheduledExecutorTest::testShutdownNow()
+{
+	SleepingRunnable sleeper( 10000 );
+	CountingRunnable counter;
+	syscommon::ScheduledExecutor executor( 1 );
+
+	syscommon::ScheduledFuture* running = executor.schedule( &sleeper, 0 );
+	CPPUNIT_ASSERT( sleeper.waitForStarted(5000) == syscommon::WR_SUCCEEDED );
+
+	syscommon::ScheduledFuture* delayed = executor.schedule( &counter, 100000 );
+
+	// Pending tasks are handed back, and the running one is interrupted
+	std::list<syscommon::IRunnable*> pending = executor.shutdownNow();
+	CPPUNIT_ASSERT_EQUAL( (size_t)1, pending.size() );
+	CPPUNIT_ASSERT( pending.front() == &counter );
+	CPPUNIT_ASSERT( executor.awaitTermination(5000) );
+
+	CPPUNIT_ASSERT( sleeper.wasInterrupted() );
+	CPPUNIT_ASSERT( delayed->isCancelled() );
+	CPPUNIT_ASSERT( running->isDone() );
+
+	delete delayed;
+	delete running;
+}
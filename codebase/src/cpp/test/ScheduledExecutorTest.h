@@ -0,0 +1,72 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include "Common.h"
+#include "syscommon/concurrent/ScheduledExecutor.h"
+
+class ScheduledExecutorTest: public CppUnit::TestFixture
+{
+	//----------------------------------------------------------
+	//                    STATIC VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                   INSTANCE VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                      CONSTRUCTORS
+	//----------------------------------------------------------
+	public:
+		ScheduledExecutorTest();
+		virtual ~ScheduledExecutorTest();
+
+	//----------------------------------------------------------
+	//                    INSTANCE METHODS
+	//----------------------------------------------------------
+	public:
+		void setUp();
+		void tearDown();
+
+	protected:
+		void testSchedule();
+		void testScheduleBeyondBottomLevel();
+		void testFixedRate();
+		void testFixedDelay();
+		void testCancelPending();
+		void testCancelRunningInterrupts();
+		void testPeriodicFailure();
+		void testManyTimers();
+		void testShutdown();
+		void testShutdownNow();
+
+	//----------------------------------------------------------
+	//                     STATIC METHODS
+	//----------------------------------------------------------
+	CPPUNIT_TEST_SUITE( ScheduledExecutorTest );
+		CPPUNIT_TEST( testSchedule );
+		CPPUNIT_TEST( testScheduleBeyondBottomLevel );
+		CPPUNIT_TEST( testFixedRate );
+		CPPUNIT_TEST( testFixedDelay );
+		CPPUNIT_TEST( testCancelPending );
+		CPPUNIT_TEST( testCancelRunningInterrupts );
+		CPPUNIT_TEST( testPeriodicFailure );
+		CPPUNIT_TEST( testManyTimers );
+		CPPUNIT_TEST( testShutdown );
+		CPPUNIT_TEST( testShutdownNow );
+	CPPUNIT_TEST_SUITE_END();
+};
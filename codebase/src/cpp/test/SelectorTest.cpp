@@ -0,0 +1,375 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development
+ * and Distribution License (the "License"). You may not use this file except in
+ * compliance with the License. You can obtain a copy of the license at
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License
+ * for the specific language governing permissions and limitations under the
+ * License.
+ *
+ * When distributing Covered Code, include this CDDL HEADER in each file and
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields
+ * enclosed by brackets "[]" replaced with your own identifying information:
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "SelectorTest.h"
+
+#include <string.h>
+#include "syscommon/util/Stopwatch.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+CPPUNIT_TEST_SUITE_REGISTRATION( SelectorTest );
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+SelectorTest::SelectorTest()
+{
+	this->server = NULL;
+	this->client = NULL;
+	this->accepted = NULL;
+	this->selector = NULL;
+}
+
+SelectorTest::~SelectorTest()
+{
+
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+void SelectorTest::setUp()
+{
+	this->server = new syscommon::ServerSocket();
+	this->server->bind( syscommon::InetSocketAddress(INADDR_LOOPBACK, 0) );
+	this->selector = new syscommon::Selector();
+}
+
+void SelectorTest::tearDown()
+{
+	delete this->selector;
+	delete this->accepted;
+	delete this->client;
+	delete this->server;
+
+	this->selector = NULL;
+	this->accepted = NULL;
+	this->client = NULL;
+	this->server = NULL;
+}
+
+void SelectorTest::connectClient()
+{
+	this->client = new syscommon::Socket( INADDR_LOOPBACK, this->server->getLocalPort() );
+	this->accepted = this->server->accept();
+	this->accepted->configureBlocking( false );
+}
+
+void SelectorTest::testAccept()
+{
+	this->server->configureBlocking( false );
+	CPPUNIT_ASSERT( this->server->accept() == NULL );
+
+	int marker = 0;
+	syscommon::SelectionKey* key =
+		this->selector->registerSocket( this->server, syscommon::SelectionKey::OP_ACCEPT, &marker );
+	CPPUNIT_ASSERT( key->getServerSocket() == this->server );
+	CPPUNIT_ASSERT( key->getSocket() == NULL );
+	CPPUNIT_ASSERT( key->getAttachment() == &marker );
+	CPPUNIT_ASSERT( this->selector->getKeyCount() == 1 );
+	CPPUNIT_ASSERT( this->selector->selectNow() == 0 );
+
+	this->client = new syscommon::Socket( INADDR_LOOPBACK, this->server->getLocalPort() );
+	CPPUNIT_ASSERT( this->selector->select(5000) == 1 );
+	CPPUNIT_ASSERT( this->selector->getSelectedKeys()[0] == key );
+	CPPUNIT_ASSERT( key->isAcceptable() );
+	CPPUNIT_ASSERT( !key->isReadable() );
+
+	this->accepted = this->server->accept();
+	CPPUNIT_ASSERT( this->accepted != NULL );
+	CPPUNIT_ASSERT( this->accepted->isBlocking() );
+	CPPUNIT_ASSERT( this->selector->selectNow() == 0 );
+	CPPUNIT_ASSERT( key->getReadyOps() == 0 );
+}
+
+void SelectorTest::testLevelTriggered()
+{
+	this->connectClient();
+	syscommon::SelectionKey* key =
+		this->selector->registerSocket( this->accepted, syscommon::SelectionKey::OP_READ, NULL );
+	CPPUNIT_ASSERT( !key->isEdgeTriggered() );
+	CPPUNIT_ASSERT( this->selector->selectNow() == 0 );
+
+	char buffer[64];
+	CPPUNIT_ASSERT( this->accepted->receive(buffer, sizeof(buffer)) == -1 );
+
+	this->client->send( "ping", 4 );
+	CPPUNIT_ASSERT( this->selector->select(5000) == 1 );
+	CPPUNIT_ASSERT( key->isReadable() );
+
+	// Still readable until the data has been received
+	CPPUNIT_ASSERT( this->selector->selectNow() == 1 );
+	CPPUNIT_ASSERT( this->accepted->receive(buffer, sizeof(buffer)) == 4 );
+	CPPUNIT_ASSERT( this->selector->selectNow() == 0 );
+
+	// A closed connection is readable, and receives nothing
+	this->client->close();
+	CPPUNIT_ASSERT( this->selector->select(5000) == 1 );
+	CPPUNIT_ASSERT( this->accepted->receive(buffer, sizeof(buffer)) == 0 );
+}
+
+void SelectorTest::testEdgeTriggered()
+{
+	this->connectClient();
+	syscommon::SelectionKey* key =
+		this->selector->registerSocket( this->accepted, syscommon::SelectionKey::OP_READ, NULL );
+	key->setEdgeTriggered( true );
+	CPPUNIT_ASSERT( key->isEdgeTriggered() );
+
+	this->client->send( "ping", 4 );
+	CPPUNIT_ASSERT( this->selector->select(5000) == 1 );
+	CPPUNIT_ASSERT( key->isReadable() );
+
+	// Edge triggering is only a saving, so the socket may or may not be selected again until it
+	// has been drained. Once it has been, new data always selects it.
+	this->selector->selectNow();
+	char buffer[64];
+	CPPUNIT_ASSERT( this->accepted->receive(buffer, sizeof(buffer)) == 4 );
+	CPPUNIT_ASSERT( this->accepted->receive(buffer, sizeof(buffer)) == -1 );
+	CPPUNIT_ASSERT( this->selector->selectNow() == 0 );
+
+	this->client->send( "pong", 4 );
+	CPPUNIT_ASSERT( this->selector->select(5000) == 1 );
+	CPPUNIT_ASSERT( key->isReadable() );
+}
+
+void SelectorTest::testWakeup()
+{
+	// A wakeup before the select makes it return straight away
+	this->selector->wakeup();
+	CPPUNIT_ASSERT( this->selector->select(5000) == 0 );
+
+	SelectingRunnable runnable( this->selector );
+	syscommon::Thread selectingThread( &runnable, TEXT("Selecting") );
+	selectingThread.start();
+	syscommon::Thread::sleep( 100 );
+	this->selector->wakeup();
+	selectingThread.join();
+
+	CPPUNIT_ASSERT( runnable.selected == 0 );
+	if( runnable.elapsed > 4000LL * 1000 * 1000 )
+		failTest( "Woken select took %lld ms", runnable.elapsed / 1000000 );
+}
+
+void SelectorTest::testWriteQueue()
+{
+	this->connectClient();
+	this->client->configureBlocking( false );
+
+	syscommon::SelectionKey* key =
+		this->selector->registerSocket( this->accepted, syscommon::SelectionKey::OP_WRITE, NULL );
+	key->setWriteQueueLimit( 256 * 1024 );
+
+	// Nobody is receiving, so eventually the queue fills up and refuses more. Each byte holds
+	// its position in the stream, so that the order can be checked at the other end.
+	std::vector<char> chunk( 64 * 1024 );
+	size_t written = 0;
+	while( true )
+	{
+		for( size_t i = 0; i < chunk.size(); ++i )
+			chunk[i] = (char)(written + i);
+
+		if( !key->write(&chunk[0], chunk.size()) )
+			break;
+
+		written += chunk.size();
+		if( written > 1024 * 1024 * 1024 )
+			failTest( "Write queue never filled up" );
+	}
+
+	CPPUNIT_ASSERT( key->getQueuedBytes() > 0 );
+	CPPUNIT_ASSERT( key->getQueuedBytes() <= key->getWriteQueueLimit() );
+
+	// Not writable while the queue has data, however much room the socket has
+	this->selector->selectNow();
+	CPPUNIT_ASSERT( !key->isWritable() );
+
+	// Everything arrives, in order, as the selector sends the queue
+	std::vector<char> received( chunk.size() );
+	size_t total = 0;
+	bool drained = false;
+	while( total < written || !drained )
+	{
+		int count = this->client->receive( &received[0], (int)received.size() );
+		if( count == 0 )
+			failTest( "Connection closed after %u of %u bytes", (unsigned int)total, (unsigned int)written );
+
+		for( int i = 0; i < count; ++i )
+		{
+			if( received[i] != (char)(total + i) )
+				failTest( "Byte %u is out of order", (unsigned int)(total + i) );
+		}
+
+		if( count > 0 )
+			total += (size_t)count;
+
+		if( this->selector->select(10) == 1 && key->isWritable() )
+			drained = true;
+	}
+
+	CPPUNIT_ASSERT( total == written );
+	CPPUNIT_ASSERT( key->getQueuedBytes() == 0 );
+}
+
+void SelectorTest::testCancel()
+{
+	this->connectClient();
+	syscommon::SelectionKey* key =
+		this->selector->registerSocket( this->accepted, syscommon::SelectionKey::OP_READ, NULL );
+	this->client->send( "ping", 4 );
+	CPPUNIT_ASSERT( this->selector->select(5000) == 1 );
+
+	// A cancelled key stays usable until the next select
+	key->cancel();
+	CPPUNIT_ASSERT( !key->isValid() );
+	CPPUNIT_ASSERT( key->isReadable() );
+	CPPUNIT_ASSERT( this->selector->getKeyCount() == 0 );
+	CPPUNIT_ASSERT( this->selector->selectNow() == 0 );
+
+	try
+	{
+		key = this->selector->registerSocket( this->accepted, syscommon::SelectionKey::OP_READ, NULL );
+		CPPUNIT_ASSERT( this->selector->selectNow() == 1 );
+	}
+	catch( syscommon::Exception& e )
+	{
+		failTest( "Could not register a socket again after cancelling it: %s", e.what() );
+	}
+
+	// Closing the selector cancels everything, and leaves the sockets open
+	this->selector->close();
+	CPPUNIT_ASSERT( !this->selector->isOpen() );
+	CPPUNIT_ASSERT( this->selector->getKeyCount() == 0 );
+	CPPUNIT_ASSERT( !this->accepted->isClosed() );
+	try
+	{
+		this->selector->selectNow();
+		failTestMissingException( "IllegalStateException", "selecting on a closed selector" );
+	}
+	catch( syscommon::IllegalStateException& )
+	{
+		// Expected
+	}
+}
+
+void SelectorTest::testInvalidRegistration()
+{
+	syscommon::Socket unconnected;
+	try
+	{
+		this->selector->registerSocket( &unconnected, syscommon::SelectionKey::OP_READ, NULL );
+		failTestMissingException( "SocketException", "registering an unconnected socket" );
+	}
+	catch( syscommon::SocketException& )
+	{
+		// Expected
+	}
+
+	try
+	{
+		this->selector->registerSocket( this->server, syscommon::SelectionKey::OP_READ, NULL );
+		failTestMissingException( "IllegalArgumentException", "registering a server socket for OP_READ" );
+	}
+	catch( syscommon::IllegalArgumentException& )
+	{
+		// Expected
+	}
+
+	this->connectClient();
+	syscommon::SelectionKey* key =
+		this->selector->registerSocket( this->accepted, syscommon::SelectionKey::OP_READ, NULL );
+	try
+	{
+		this->selector->registerSocket( this->accepted, syscommon::SelectionKey::OP_WRITE, NULL );
+		failTestMissingException( "IllegalArgumentException", "registering a socket twice" );
+	}
+	catch( syscommon::IllegalArgumentException& )
+	{
+		// Expected
+	}
+
+	try
+	{
+		key->setInterestOps( syscommon::SelectionKey::OP_ACCEPT );
+		failTestMissingException( "IllegalArgumentException", "setting OP_ACCEPT on a socket" );
+	}
+	catch( syscommon::IllegalArgumentException& )
+	{
+		// Expected
+	}
+
+	key->cancel();
+	try
+	{
+		key->write( "ping", 4 );
+		failTestMissingException( "IllegalStateException", "writing to a cancelled key" );
+	}
+	catch( syscommon::IllegalStateException& )
+	{
+		// Expected
+	}
+}
+
+void SelectorTest::testMulticastSocket()
+{
+	syscommon::MulticastSocket receiver( syscommon::InetSocketAddress(INADDR_ANY, 3035) );
+	syscommon::MulticastSocket sender( syscommon::InetSocketAddress(INADDR_ANY, 0) );
+	receiver.configureBlocking( false );
+
+	char receiveBuffer[64];
+	syscommon::DatagramPacket receivePacket( receiveBuffer, sizeof(receiveBuffer) );
+	CPPUNIT_ASSERT( !receiver.receive(receivePacket) );
+
+	syscommon::SelectionKey* key =
+		this->selector->registerSocket( &receiver, syscommon::SelectionKey::OP_READ, NULL );
+	CPPUNIT_ASSERT( key->getMulticastSocket() == &receiver );
+	CPPUNIT_ASSERT( this->selector->selectNow() == 0 );
+
+	char sendBuffer[] = "datagram";
+	syscommon::InetSocketAddress destination( INADDR_LOOPBACK, 3035 );
+	syscommon::DatagramPacket sendPacket( sendBuffer, 0, sizeof(sendBuffer), destination );
+	CPPUNIT_ASSERT( sender.send(sendPacket) );
+
+	CPPUNIT_ASSERT( this->selector->select(5000) == 1 );
+	CPPUNIT_ASSERT( key->isReadable() );
+	CPPUNIT_ASSERT( receiver.receive(receivePacket) );
+	CPPUNIT_ASSERT( receivePacket.getLength() == (int)sizeof(sendBuffer) );
+	CPPUNIT_ASSERT( ::memcmp(sendBuffer, receiveBuffer, sizeof(sendBuffer)) == 0 );
+	CPPUNIT_ASSERT( !receiver.receive(receivePacket) );
+
+	key->cancel();
+	receiver.close();
+	sender.close();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+////////////////////////////  SelectingRunnable  //////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+SelectingRunnable::SelectingRunnable( syscommon::Selector* selector )
+{
+	this->selector = selector;
+	this->selected = -1;
+	this->elapsed = 0;
+}
+
+void SelectingRunnable::run()
+{
+	syscommon::Stopwatch stopwatch;
+	stopwatch.start();
+	this->selected = this->selector->select( 5000 );
+	this->elapsed = stopwatch.getElapsedNanos();
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development
+ * and Distribution License (the "License"). You may not use this file except in
+ * compliance with the License. You can obtain a copy of the license at
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License
+ * for the specific language governing permissions and limitations under the
+ * License.
+ *
+ * When distributing Covered Code, include this CDDL HEADER in each file and
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields
+ * enclosed by brackets "[]" replaced with your own identifying information:
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include "Common.h"
+#include "syscommon/Platform.h"
+#include "syscommon/concurrent/Thread.h"
+#include "syscommon/net/Selector.h"
+
+class SelectorTest: public CppUnit::TestFixture
+{
+	//----------------------------------------------------------
+	//                    STATIC VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                   INSTANCE VARIABLES
+	//----------------------------------------------------------
+	private:
+		syscommon::ServerSocket* server;
+		syscommon::Socket* client;
+		syscommon::Socket* accepted;
+		syscommon::Selector* selector;
+
+	//----------------------------------------------------------
+	//                      CONSTRUCTORS
+	//----------------------------------------------------------
+	public:
+		SelectorTest();
+		virtual ~SelectorTest();
+
+	//----------------------------------------------------------
+	//                    INSTANCE METHODS
+	//----------------------------------------------------------
+	public:
+		void setUp();
+		void tearDown();
+
+	protected:
+		void testAccept();
+		void testLevelTriggered();
+		void testEdgeTriggered();
+		void testWakeup();
+		void testWriteQueue();
+		void testCancel();
+		void testInvalidRegistration();
+		void testMulticastSocket();
+
+	private:
+		void connectClient();
+
+	//----------------------------------------------------------
+	//                     STATIC METHODS
+	//----------------------------------------------------------
+	CPPUNIT_TEST_SUITE( SelectorTest );
+		CPPUNIT_TEST( testAccept );
+		CPPUNIT_TEST( testLevelTriggered );
+		CPPUNIT_TEST( testEdgeTriggered );
+		CPPUNIT_TEST( testWakeup );
+		CPPUNIT_TEST( testWriteQueue );
+		CPPUNIT_TEST( testCancel );
+		CPPUNIT_TEST( testInvalidRegistration );
+		CPPUNIT_TEST( testMulticastSocket );
+	CPPUNIT_TEST_SUITE_END();
+};
+
+// Selects once, recording how long it took and how many keys were selected
+class SelectingRunnable : public syscommon::IRunnable
+{
+	public:
+		syscommon::Selector* selector;
+		int selected;
+		long long elapsed;
+
+	public:
+		SelectingRunnable( syscommon::Selector* selector );
+		virtual void run();
+};
@@ -79,16 +79,12 @@ void SemaphoreTest::testSemaphore()
 	CPPUNIT_ASSERT( runnableOne.isHoldingPermit() );
 	CPPUNIT_ASSERT( runnableTwo.isHoldingPermit() );
 
-#ifdef _WIN32
 	// Have another runnable attempt to acquire the permit, it should timeout as both permits are
 	// taken
 	runnableThree.signalAcquire();
 	syscommon::WaitResult blockedAcquire = runnableThree.waitForAcquired( 100L );
 	CPPUNIT_ASSERT( blockedAcquire == syscommon::WR_TIMEOUT );
 	CPPUNIT_ASSERT( !runnableThree.isHoldingPermit() );
-#else
-	runnableThree.signalAcquire();
-#endif
 
 	// Have one of the original runnables release its permit, the waiting runnable should wake up
 	// and acquire the released permit
@@ -104,6 +100,102 @@ void SemaphoreTest::testSemaphore()
 	threadThree.join();
 }
 
+void SemaphoreTest::testTimedAcquire()
+{
+	syscommon::Semaphore semaphore( 0 );
+
+	unsigned long start = syscommon::Platform::getCurrentTimeMilliseconds();
+	CPPUNIT_ASSERT( !semaphore.tryAcquire(150UL) );
+	unsigned long elapsed = syscommon::Platform::getCurrentTimeMilliseconds() - start;
+	if( elapsed < 140 )
+		failTest( "tryAcquire() gave up after %lums, expected at least 150ms", elapsed );
+
+	CPPUNIT_ASSERT( !semaphore.tryAcquire() );
+	semaphore.release();
+	CPPUNIT_ASSERT( semaphore.tryAcquire(0UL) );
+}
+
+void SemaphoreTest::testInterruptedAcquire()
+{
+	syscommon::Semaphore semaphore( 0 );
+	AcquireRunnable runnable( &semaphore, 1 );
+	syscommon::Thread thread( &runnable );
+	thread.start();
+
+	// Let the thread block in acquire(), then interrupt it
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_TIMEOUT, runnable.waitForFinished(100) );
+	thread.interrupt();
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_SUCCEEDED, runnable.waitForFinished(5000) );
+	thread.join();
+
+	CPPUNIT_ASSERT( runnable.interrupted );
+	CPPUNIT_ASSERT( !runnable.acquired );
+
+	// The interrupt is consumed by the exception, so the permit is still there for the next taker
+	semaphore.release();
+	CPPUNIT_ASSERT( semaphore.tryAcquire() );
+}
+
+void SemaphoreTest::testBulkPermits()
+{
+	syscommon::Semaphore semaphore( 3 );
+
+	// All or nothing
+	CPPUNIT_ASSERT( !semaphore.tryAcquire(4U, 0UL) );
+	CPPUNIT_ASSERT( semaphore.tryAcquire(3U, 0UL) );
+	CPPUNIT_ASSERT( !semaphore.tryAcquire() );
+
+	// A waiter for two permits should stay blocked until both have been released
+	AcquireRunnable runnable( &semaphore, 2 );
+	syscommon::Thread thread( &runnable );
+	thread.start();
+
+	semaphore.release();
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_TIMEOUT, runnable.waitForFinished(100) );
+	CPPUNIT_ASSERT( !runnable.acquired );
+
+	semaphore.release( 2 );
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_SUCCEEDED, runnable.waitForFinished(5000) );
+	thread.join();
+	CPPUNIT_ASSERT( runnable.acquired );
+
+	// One permit should be left over
+	CPPUNIT_ASSERT( semaphore.tryAcquire() );
+	CPPUNIT_ASSERT( !semaphore.tryAcquire() );
+}
+
+void SemaphoreTest::testDestroyReleasesWaiters()
+{
+	syscommon::Semaphore* semaphore = new syscommon::Semaphore( 0 );
+	AcquireRunnable runnable( semaphore, 1 );
+	syscommon::Thread thread( &runnable );
+	thread.start();
+
+	// Let the thread block in acquire(), then destroy the semaphore from under it. The destructor
+	// should wake it and wait for it to leave, rather than leave it blocked on freed memory.
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_TIMEOUT, runnable.waitForFinished(100) );
+	delete semaphore;
+	CPPUNIT_ASSERT_EQUAL( syscommon::WR_SUCCEEDED, runnable.waitForFinished(5000) );
+	thread.join();
+
+	CPPUNIT_ASSERT( !runnable.interrupted );
+}
+
+void SemaphoreTest::testDrainPermits()
+{
+	syscommon::Semaphore semaphore( 5 );
+
+	// Takes what it can, up to the limit, and never blocks
+	CPPUNIT_ASSERT_EQUAL( 3U, semaphore.drainPermits(3) );
+	CPPUNIT_ASSERT_EQUAL( 2U, semaphore.drainPermits(10) );
+	CPPUNIT_ASSERT_EQUAL( 0U, semaphore.drainPermits(10) );
+
+	semaphore.release( 2 );
+	CPPUNIT_ASSERT_EQUAL( 0U, semaphore.drainPermits(0) );
+	CPPUNIT_ASSERT_EQUAL( 2U, semaphore.drainPermits(2) );
+	CPPUNIT_ASSERT( !semaphore.tryAcquire() );
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /////////////////////////////  SyncPointRunnable  /////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -155,3 +247,35 @@ bool SemaphoreRunnable::isHoldingPermit()
 {
 	return this->holdingPermit;
 }
+
+///////////////////////////////////////////////////////////////////////////////
+//////////////////////////////  AcquireRunnable  //////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+AcquireRunnable::AcquireRunnable( syscommon::Semaphore* semaphore, unsigned int permits ) :
+		finishedEvent(false, TEXT("finished"))
+{
+	this->semaphore = semaphore;
+	this->permits = permits;
+	this->acquired = false;
+	this->interrupted = false;
+}
+
+void AcquireRunnable::run()
+{
+	try
+	{
+		this->semaphore->acquire( this->permits );
+		this->acquired = true;
+	}
+	catch( syscommon::InterruptedException& )
+	{
+		this->interrupted = true;
+	}
+
+	this->finishedEvent.signal();
+}
+
+syscommon::WaitResult AcquireRunnable::waitForFinished( unsigned long timeout )
+{
+	return this->finishedEvent.waitFor( timeout );
+}
@@ -46,12 +46,22 @@ class SemaphoreTest: public CppUnit::TestFixture
 
 	protected:
 		void testSemaphore();
+		void testTimedAcquire();
+		void testInterruptedAcquire();
+		void testBulkPermits();
+		void testDestroyReleasesWaiters();
+		void testDrainPermits();
 
 	//----------------------------------------------------------
 	//                     STATIC METHODS
 	//----------------------------------------------------------
 	CPPUNIT_TEST_SUITE( SemaphoreTest );
 		CPPUNIT_TEST( testSemaphore );
+		CPPUNIT_TEST( testTimedAcquire );
+		CPPUNIT_TEST( testInterruptedAcquire );
+		CPPUNIT_TEST( testBulkPermits );
+		CPPUNIT_TEST( testDestroyReleasesWaiters );
+		CPPUNIT_TEST( testDrainPermits );
 	CPPUNIT_TEST_SUITE_END();
 };
 
@@ -95,3 +105,19 @@ class SemaphoreRunnable : public syscommon::IRunnable
 	//----------------------------------------------------------
 };
 
+// AcquireRunnable helper class, makes a single blocking acquire() and records how it ended
+class AcquireRunnable : public syscommon::IRunnable
+{
+	private:
+		syscommon::Semaphore* semaphore;
+		unsigned int permits;
+		syscommon::Event finishedEvent;
+
+	public:
+		volatile bool acquired;
+		volatile bool interrupted;
+
+		AcquireRunnable( syscommon::Semaphore* semaphore, unsigned int permits );
+		virtual void run();
+		syscommon::WaitResult waitForFinished( unsigned long timeout );
+};
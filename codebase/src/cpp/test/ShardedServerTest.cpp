@@ -0,0 +1,338 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development
+ * and Distribution License (the "License"). You may not use this file except in
+ * compliance with the License. You can obtain a copy of the license at
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License
+ * for the specific language governing permissions and limitations under the
+ * License.
+ *
+ * When distributing Covered Code, include this CDDL HEADER in each file and
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields
+ * enclosed by brackets "[]" replaced with your own identifying information:
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "ShardedServerTest.h"
+
+#include <string.h>
+#include "syscommon/concurrent/Thread.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+CPPUNIT_TEST_SUITE_REGISTRATION( ShardedServerTest );
+
+// Every shard runs on the processor we are on, so that the tests behave the same on machines
+// with a single processor
+static std::vector<unsigned int> getTestProcessors( size_t count )
+{
+	return std::vector<unsigned int>( count, syscommon::Platform::getCurrentProcessor() );
+}
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+ShardedServerTest::ShardedServerTest()
+{
+
+}
+
+ShardedServerTest::~ShardedServerTest()
+{
+
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+void ShardedServerTest::setUp()
+{
+
+}
+
+void ShardedServerTest::tearDown()
+{
+
+}
+
+void ShardedServerTest::testStartStop()
+{
+	EchoShardHandler handler( 3 );
+	syscommon::ShardedServer server( &handler, getTestProcessors(3), 16 );
+	CPPUNIT_ASSERT( !server.isRunning() );
+	CPPUNIT_ASSERT( server.getLocalPort() == 0 );
+	CPPUNIT_ASSERT( server.getShardCount() == 3 );
+
+	server.start( syscommon::InetSocketAddress(INADDR_LOOPBACK, 0) );
+	CPPUNIT_ASSERT( server.isRunning() );
+	CPPUNIT_ASSERT( server.getLocalPort() != 0 );
+	for( size_t i = 0; i < 3; ++i )
+	{
+		CPPUNIT_ASSERT( server.getShard(i).getIndex() == i );
+		CPPUNIT_ASSERT( &server.getShard(i).getServer() == &server );
+	}
+
+	try
+	{
+		server.start( syscommon::InetSocketAddress(INADDR_LOOPBACK, 0) );
+		failTestMissingException( "IllegalStateException", "starting a running sharded server" );
+	}
+	catch( syscommon::IllegalStateException& )
+	{
+		// Expected
+	}
+
+	server.stop();
+	CPPUNIT_ASSERT( !server.isRunning() );
+	CPPUNIT_ASSERT( handler.started == 3 );
+	CPPUNIT_ASSERT( handler.stopped == 3 );
+	CPPUNIT_ASSERT( handler.wrongThread == 0 );
+
+	// And again, now that the shards have released the port
+	server.start( syscommon::InetSocketAddress(INADDR_LOOPBACK, 0) );
+	server.stop();
+	CPPUNIT_ASSERT( handler.stopped == 6 );
+}
+
+void ShardedServerTest::testEcho()
+{
+	const size_t clientCount = 12;
+	EchoShardHandler handler( 3 );
+	syscommon::ShardedServer server( &handler, getTestProcessors(3), 16 );
+	server.start( syscommon::InetSocketAddress(INADDR_LOOPBACK, 0) );
+
+	std::vector<syscommon::Socket*> clients;
+	for( size_t i = 0; i < clientCount; ++i )
+	{
+		syscommon::Socket* client = new syscommon::Socket( INADDR_LOOPBACK, server.getLocalPort() );
+		clients.push_back( client );
+	}
+
+	// Each client is served by whichever shard accepted it
+	for( size_t i = 0; i < clientCount; ++i )
+	{
+		char message[16];
+		::sprintf( message, "message %u", (unsigned int)i );
+		int length = (int)::strlen( message );
+		clients[i]->send( message, length );
+
+		char echo[16];
+		int received = 0;
+		while( received < length )
+		{
+			int count = clients[i]->receive( echo + received, length - received );
+			if( count <= 0 )
+				failTest( "Connection %u closed after %d bytes", (unsigned int)i, received );
+
+			received += count;
+		}
+
+		if( ::memcmp(message, echo, length) != 0 )
+			failTest( "Connection %u echoed the wrong message", (unsigned int)i );
+	}
+
+	unsigned long long accepted = 0;
+	for( size_t i = 0; i < server.getShardCount(); ++i )
+	{
+		syscommon::Shard& shard = server.getShard( i );
+		accepted += shard.getAcceptedCount();
+		CPPUNIT_ASSERT( shard.getFailureCount() == 0 );
+		CPPUNIT_ASSERT( shard.getSteeredCount() <= shard.getAcceptedCount() );
+	}
+
+	if( accepted != clientCount )
+		failTest( "Shards accepted %llu connections, expected %u", accepted, (unsigned int)clientCount );
+
+	server.stop();
+	CPPUNIT_ASSERT( handler.wrongThread == 0 );
+
+	// The handler closed the connections when the shards stopped
+	for( size_t i = 0; i < clientCount; ++i )
+	{
+		char buffer[1];
+		CPPUNIT_ASSERT( clients[i]->receive(buffer, 1) <= 0 );
+		delete clients[i];
+	}
+}
+
+void ShardedServerTest::testPost()
+{
+	EchoShardHandler handler( 2 );
+	syscommon::ShardedServer server( &handler, getTestProcessors(2), 16 );
+	server.start( syscommon::InetSocketAddress(INADDR_LOOPBACK, 0) );
+	syscommon::Shard& target = server.getShard( 1 );
+
+	// The shard is asleep waiting for its sockets, and has to be woken to run the task
+	syscommon::Thread::sleep( 50 );
+	ShardRecordingRunnable task;
+	CPPUNIT_ASSERT( target.post(&task) );
+	for( int i = 0; i < 500 && !task.ran; ++i )
+		syscommon::Thread::sleep( 10 );
+
+	CPPUNIT_ASSERT( task.ran );
+	CPPUNIT_ASSERT( task.shard == &target );
+	CPPUNIT_ASSERT( syscommon::Shard::current() == NULL );
+
+	// Tasks posted before stopping still run
+	ShardRecordingRunnable late;
+	CPPUNIT_ASSERT( server.getShard(0).post(&late) );
+	server.stop();
+	CPPUNIT_ASSERT( late.ran );
+	CPPUNIT_ASSERT( late.shard == &server.getShard(0) );
+}
+
+void ShardedServerTest::testCpuSteering()
+{
+	const size_t clientCount = 12;
+	EchoShardHandler handler( 3 );
+	syscommon::ShardedServer server( &handler, getTestProcessors(3), 16 );
+	server.setCpuSteering( true );
+	server.start( syscommon::InetSocketAddress(INADDR_LOOPBACK, 0) );
+	if( !server.isReusePortEnabled() || !server.isCpuSteeringActive() )
+	{
+		// Nothing to test where the platform cannot steer
+		server.stop();
+		return;
+	}
+
+	try
+	{
+		server.setCpuSteering( false );
+		failTestMissingException( "IllegalStateException", "changing steering while running" );
+	}
+	catch( syscommon::IllegalStateException& )
+	{
+		// Expected
+	}
+
+	std::vector<syscommon::Socket*> clients;
+	for( size_t i = 0; i < clientCount; ++i )
+	{
+		syscommon::Socket* client = new syscommon::Socket( INADDR_LOOPBACK, server.getLocalPort() );
+		clients.push_back( client );
+
+		// A round trip makes sure the connection has been accepted
+		char ping = 'p';
+		char echo = 0;
+		client->sendAll( &ping, 1 );
+		if( client->receiveFully(&echo, 1) != 1 || echo != ping )
+			failTest( "Connection %u was not echoed", (unsigned int)i );
+	}
+
+	// Every shard is on the same processor, so whatever arrived on it went to the first of them.
+	// With only the hint to go on, any of them could have been chosen.
+	unsigned long long accepted = 0;
+	for( size_t i = 0; i < server.getShardCount(); ++i )
+	{
+		syscommon::Shard& shard = server.getShard( i );
+		accepted += shard.getAcceptedCount();
+		if( i > 0 && shard.getSteeredCount() != 0 )
+			failTest( "Shard %u took connections meant for shard 0", (unsigned int)i );
+	}
+
+	CPPUNIT_ASSERT( accepted == clientCount );
+
+	server.stop();
+	CPPUNIT_ASSERT( !server.isCpuSteeringActive() );
+	for( size_t i = 0; i < clientCount; ++i )
+		delete clients[i];
+}
+
+void ShardedServerTest::testInvalidArguments()
+{
+	EchoShardHandler handler( 1 );
+	try
+	{
+		syscommon::ShardedServer server( &handler, std::vector<unsigned int>(), 16 );
+		failTestMissingException( "IllegalArgumentException", "creating a server without shards" );
+	}
+	catch( syscommon::IllegalArgumentException& )
+	{
+		// Expected
+	}
+
+	syscommon::ShardedServer server( &handler, getTestProcessors(1), 16 );
+	server.start( syscommon::InetSocketAddress(INADDR_LOOPBACK, 0) );
+	try
+	{
+		server.getShard( 1 );
+		failTestMissingException( "IllegalArgumentException", "getting a shard that does not exist" );
+	}
+	catch( syscommon::IllegalArgumentException& )
+	{
+		// Expected
+	}
+
+	server.stop();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/////////////////////////////  EchoShardHandler  //////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+EchoShardHandler::EchoShardHandler( size_t shardCount ) :
+	connections( shardCount ),
+	started( 0 ),
+	stopped( 0 ),
+	wrongThread( 0 )
+{
+
+}
+
+void EchoShardHandler::onStart( syscommon::Shard& shard )
+{
+	if( syscommon::Shard::current() != &shard )
+		++this->wrongThread;
+
+	++this->started;
+}
+
+void EchoShardHandler::onAccept( syscommon::Shard& shard, syscommon::Socket* socket )
+{
+	if( syscommon::Shard::current() != &shard )
+		++this->wrongThread;
+
+	this->connections[shard.getIndex()].push_back( socket );
+	shard.watch( socket );
+}
+
+void EchoShardHandler::onReadable( syscommon::Shard& shard, syscommon::Socket* socket )
+{
+	if( syscommon::Shard::current() != &shard )
+		++this->wrongThread;
+
+	char buffer[256];
+	int count = socket->receive( buffer, sizeof(buffer) );
+	if( count > 0 )
+		socket->send( buffer, count );
+	else
+		shard.unwatch( socket );
+}
+
+void EchoShardHandler::onStop( syscommon::Shard& shard )
+{
+	std::vector<syscommon::Socket*>& owned = this->connections[shard.getIndex()];
+	for( size_t i = 0; i < owned.size(); ++i )
+	{
+		shard.unwatch( owned[i] );
+		owned[i]->close();
+		delete owned[i];
+	}
+
+	owned.clear();
+	++this->stopped;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//////////////////////////  ShardRecordingRunnable  ///////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+ShardRecordingRunnable::ShardRecordingRunnable() : shard( NULL ), ran( false )
+{
+
+}
+
+void ShardRecordingRunnable::run()
+{
+	this->shard = syscommon::Shard::current();
+	this->ran = true;
+}
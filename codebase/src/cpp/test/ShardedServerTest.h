@@ -0,0 +1,97 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development
+ * and Distribution License (the "License"). You may not use this file except in
+ * compliance with the License. You can obtain a copy of the license at
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License
+ * for the specific language governing permissions and limitations under the
+ * License.
+ *
+ * When distributing Covered Code, include this CDDL HEADER in each file and
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields
+ * enclosed by brackets "[]" replaced with your own identifying information:
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include <atomic>
+#include <vector>
+
+#include "Common.h"
+#include "syscommon/Platform.h"
+#include "syscommon/net/IShardHandler.h"
+#include "syscommon/net/Shard.h"
+#include "syscommon/net/ShardedServer.h"
+
+class ShardedServerTest: public CppUnit::TestFixture
+{
+	//----------------------------------------------------------
+	//                    STATIC VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                   INSTANCE VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                      CONSTRUCTORS
+	//----------------------------------------------------------
+	public:
+		ShardedServerTest();
+		virtual ~ShardedServerTest();
+
+	//----------------------------------------------------------
+	//                    INSTANCE METHODS
+	//----------------------------------------------------------
+	public:
+		void setUp();
+		void tearDown();
+
+	protected:
+		void testStartStop();
+		void testEcho();
+		void testPost();
+		void testCpuSteering();
+		void testInvalidArguments();
+
+	//----------------------------------------------------------
+	//                     STATIC METHODS
+	//----------------------------------------------------------
+	CPPUNIT_TEST_SUITE( ShardedServerTest );
+		CPPUNIT_TEST( testStartStop );
+		CPPUNIT_TEST( testEcho );
+		CPPUNIT_TEST( testPost );
+		CPPUNIT_TEST( testCpuSteering );
+		CPPUNIT_TEST( testInvalidArguments );
+	CPPUNIT_TEST_SUITE_END();
+};
+
+// Echoes everything it receives, keeping each shard's connections to that shard
+class EchoShardHandler : public syscommon::IShardHandler
+{
+	public:
+		std::vector< std::vector<syscommon::Socket*> > connections;
+		std::atomic<int> started;
+		std::atomic<int> stopped;
+		std::atomic<int> wrongThread;
+
+	public:
+		EchoShardHandler( size_t shardCount );
+		virtual void onStart( syscommon::Shard& shard );
+		virtual void onAccept( syscommon::Shard& shard, syscommon::Socket* socket );
+		virtual void onReadable( syscommon::Shard& shard, syscommon::Socket* socket );
+		virtual void onStop( syscommon::Shard& shard );
+};
+
+// Records the shard it was run on
+class ShardRecordingRunnable : public syscommon::IRunnable
+{
+	public:
+		std::atomic<syscommon::Shard*> shard;
+		std::atomic<bool> ran;
+
+	public:
+		ShardRecordingRunnable();
+		virtual void run();
+};
@@ -13,8 +13,15 @@
  * Portions Copyright [yyyy] [name of copyright owner]
  */
 #include "SocketTest.h"
+
+#include <vector>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 #include "StringServer.h"
 #include "syscommon/Platform.h"
+#include "syscommon/io/OutputBuffer.h"
+#include "syscommon/net/ServerSocket.h"
 #include "syscommon/net/Socket.h"
 
 #ifdef DEBUG
@@ -699,6 +706,378 @@ void SocketTest::testReceiveNegativeSize()
 	CPPUNIT_ASSERT( receivedMessage == sentMessage );
 }
 
+void SocketTest::testSendv()
+{
+	this->socket = new Socket( INADDR_LOOPBACK, 1234 );
+
+	// The length prefix comes out of an OutputBuffer and the payload from the string, in one send
+	string data = "Hello World!";
+	OutputBuffer header( sizeof(size_t), true );
+	if( sizeof(size_t) == 8 )
+		header.writeUInt64( data.length() );
+	else
+		header.writeUInt32( (unsigned int)data.length() );
+
+	BufferSegment segments[2];
+	segments[0] = header.toSegment();
+	segments[1].buffer = (char*)data.data();
+	segments[1].length = (int)data.length();
+	CPPUNIT_ASSERT( segments[0].buffer == header.getData() );
+	CPPUNIT_ASSERT_EQUAL( (int)sizeof(size_t), segments[0].length );
+
+	this->server->registerForNextReceive();
+	int sent = this->socket->sendv( segments, 2 );
+	CPPUNIT_ASSERT_EQUAL( (int)(sizeof(size_t) + data.length()), sent );
+
+	CPPUNIT_ASSERT( this->server->waitForNextReceive(1000) );
+	CPPUNIT_ASSERT( this->server->getLastReceivedMessage() == data );
+}
+
+void SocketTest::testSendvNullSegments()
+{
+	this->socket = new Socket( INADDR_LOOPBACK, 1234 );
+
+	try
+	{
+		this->socket->sendv( NULL, 1 );
+		failTestMissingException( "IllegalArgumentException", "sending NULL segments" );
+	}
+	catch( IllegalArgumentException& )
+	{
+		// SUCCESS!
+	}
+
+	BufferSegment segment;
+	segment.buffer = NULL;
+	segment.length = -1;
+	try
+	{
+		this->socket->receivev( &segment, 1 );
+		failTestMissingException( "SocketException", "receiving into a negative length segment" );
+	}
+	catch( SocketException& )
+	{
+		// SUCCESS!
+	}
+}
+
+void SocketTest::testSendAllSegments()
+{
+	this->socket = new Socket( INADDR_LOOPBACK, 1234 );
+
+	// More segments than one call takes, so that sendAll() has to carry on in another
+	string data;
+	for( int i = 0; i < BufferSegment::MAX_BATCH * 2 + 3; ++i )
+		data.push_back( (char)('a' + i % 26) );
+
+	size_t length = data.length();
+	vector<BufferSegment> segments( data.length() + 1 );
+	segments[0].buffer = (char*)&length;
+	segments[0].length = sizeof( size_t );
+	for( size_t i = 0; i < data.length(); ++i )
+	{
+		segments[i + 1].buffer = &data[i];
+		segments[i + 1].length = 1;
+	}
+
+	this->server->registerForNextReceive();
+	this->socket->sendAll( &segments[0], (int)segments.size() );
+
+	CPPUNIT_ASSERT( this->server->waitForNextReceive(1000) );
+	CPPUNIT_ASSERT( this->server->getLastReceivedMessage() == data );
+}
+
+void SocketTest::testReceiveFully()
+{
+	this->socket = new Socket( INADDR_LOOPBACK, 1234 );
+
+	// Send a message so that the server echoes it back
+	string sentMessage = "Hello World!";
+	this->quickStringSend( sentMessage );
+
+	size_t length = 0;
+	int received = this->socket->receiveFully( (char*)&length, sizeof(size_t) );
+	CPPUNIT_ASSERT_EQUAL( (int)sizeof(size_t), received );
+	CPPUNIT_ASSERT( length == sentMessage.length() );
+
+	// Scatter the message across two buffers
+	char first[5];
+	char second[32];
+	BufferSegment segments[2];
+	segments[0].buffer = first;
+	segments[0].length = sizeof( first );
+	segments[1].buffer = second;
+	segments[1].length = (int)length - sizeof( first );
+	received = this->socket->receiveFully( segments, 2 );
+	CPPUNIT_ASSERT_EQUAL( (int)length, received );
+	CPPUNIT_ASSERT( string(first, sizeof(first)) + string(second, segments[1].length) == sentMessage );
+}
+
+void SocketTest::testTransferFromFile()
+{
+	this->socket = new Socket( INADDR_LOOPBACK, 1234 );
+
+	// Large enough to take more than one step on most systems
+	string data;
+	for( int i = 0; i < 300000; ++i )
+		data.push_back( (char)('a' + i % 26) );
+
+	string frame = this->quickFrame( data );
+	this->quickWriteFile( "SocketTest.transfer.tmp", frame );
+
+	TransferRecorder recorder;
+	this->server->registerForNextReceive();
+	long long sent = this->socket->transferFrom( TEXT("SocketTest.transfer.tmp"), 0, -1, &recorder );
+	::remove( "SocketTest.transfer.tmp" );
+
+	CPPUNIT_ASSERT_EQUAL( (long long)frame.size(), sent );
+	CPPUNIT_ASSERT( recorder.calls > 0 );
+	CPPUNIT_ASSERT_EQUAL( sent, recorder.lastTransferred );
+	CPPUNIT_ASSERT_EQUAL( (long long)frame.size(), recorder.lastExpected );
+
+	CPPUNIT_ASSERT( this->server->waitForNextReceive(1000) );
+	CPPUNIT_ASSERT( this->server->getLastReceivedMessage() == data );
+}
+
+void SocketTest::testTransferFromResume()
+{
+	this->socket = new Socket( INADDR_LOOPBACK, 1234 );
+
+	string data = "Sent in more than one go";
+	string frame = this->quickFrame( data );
+	this->quickWriteFile( "SocketTest.resume.tmp", frame );
+
+	// A listener can stop a transfer after its first step
+	TransferRecorder recorder;
+	recorder.stopAfter = 1;
+	this->server->registerForNextReceive();
+	long long sent = this->socket->transferFrom( TEXT("SocketTest.resume.tmp"), 0, 10, &recorder );
+	CPPUNIT_ASSERT_EQUAL( 10LL, sent );
+	CPPUNIT_ASSERT_EQUAL( 1, recorder.calls );
+
+	// Then the rest is sent a step at a time from where it got to
+	NATIVE_FILE file = Platform::openFile( TEXT("SocketTest.resume.tmp") );
+	CPPUNIT_ASSERT( file != NATIVE_FILE_UNINIT );
+	long long offset = sent;
+	while( offset < (long long)frame.size() )
+	{
+		long long result = this->socket->transferFrom( file, offset, (long long)frame.size() - offset );
+		CPPUNIT_ASSERT( result > 0 );
+		offset += result;
+	}
+
+	CPPUNIT_ASSERT_EQUAL( 0LL, this->socket->transferFrom(file, offset, 100) );
+	Platform::closeFile( file );
+	::remove( "SocketTest.resume.tmp" );
+
+	CPPUNIT_ASSERT( this->server->waitForNextReceive(1000) );
+	CPPUNIT_ASSERT( this->server->getLastReceivedMessage() == data );
+}
+
+void SocketTest::testTransferFromMissingFile()
+{
+	this->socket = new Socket( INADDR_LOOPBACK, 1234 );
+
+	try
+	{
+		this->socket->transferFrom( TEXT("SocketTest.missing.tmp"), 0, -1, NULL );
+		failTestMissingException( "FileNotFoundException", "transferring from a missing file" );
+	}
+	catch( FileNotFoundException& )
+	{
+		// SUCCESS!
+	}
+}
+
+void SocketTest::testTransferFromPipe()
+{
+#ifndef _WIN32
+	this->socket = new Socket( INADDR_LOOPBACK, 1234 );
+
+	// A pipe has no size or offset, so it is sent until its writer closes
+	int ends[2];
+	CPPUNIT_ASSERT( ::pipe(ends) == 0 );
+
+	string data = "Through a pipe";
+	string frame = this->quickFrame( data );
+	CPPUNIT_ASSERT( ::write(ends[1], frame.data(), frame.size()) == (ssize_t)frame.size() );
+	::close( ends[1] );
+
+	TransferRecorder recorder;
+	this->server->registerForNextReceive();
+	long long sent = this->socket->transferFrom( ends[0], 0, -1, &recorder );
+	::close( ends[0] );
+
+	CPPUNIT_ASSERT_EQUAL( (long long)frame.size(), sent );
+	CPPUNIT_ASSERT_EQUAL( -1LL, recorder.lastExpected );
+
+	CPPUNIT_ASSERT( this->server->waitForNextReceive(1000) );
+	CPPUNIT_ASSERT( this->server->getLastReceivedMessage() == data );
+#endif
+}
+
+void SocketTest::testTransferFromSocket()
+{
+	this->socket = new Socket( INADDR_LOOPBACK, 1234 );
+
+	ServerSocket relayServer;
+	relayServer.bind( InetSocketAddress(INADDR_LOOPBACK, 0) );
+	Socket upstream( INADDR_LOOPBACK, relayServer.getLocalPort() );
+	Socket* accepted = relayServer.accept();
+
+	string data = "Relayed from one socket to another";
+	string frame = this->quickFrame( data );
+	upstream.sendAll( frame.data(), (int)frame.size() );
+
+	TransferRecorder recorder;
+	this->server->registerForNextReceive();
+	long long relayed = this->socket->transferFrom( *accepted, (long long)frame.size(), &recorder );
+	CPPUNIT_ASSERT_EQUAL( (long long)frame.size(), relayed );
+	CPPUNIT_ASSERT_EQUAL( relayed, recorder.lastTransferred );
+
+	CPPUNIT_ASSERT( this->server->waitForNextReceive(1000) );
+	CPPUNIT_ASSERT( this->server->getLastReceivedMessage() == data );
+
+	// Once the source closes, a relay without a length ends
+	upstream.close();
+	CPPUNIT_ASSERT_EQUAL( 0LL, this->socket->transferFrom(*accepted, -1, NULL) );
+	delete accepted;
+}
+
+void SocketTest::testSendZeroCopy()
+{
+	ServerSocket zeroCopyServer;
+	zeroCopyServer.bind( InetSocketAddress(INADDR_LOOPBACK, 0) );
+	this->socket = new Socket( INADDR_LOOPBACK, zeroCopyServer.getLocalPort() );
+	Socket* accepted = zeroCopyServer.accept();
+
+	// A send below the threshold is copied, and so complete as soon as it returns
+	int small = 42;
+	char greeting[] = "Copied rather than pinned";
+	CPPUNIT_ASSERT_EQUAL( (int)sizeof(greeting),
+	                      this->socket->sendZeroCopy(greeting, (int)sizeof(greeting), &small) );
+	CPPUNIT_ASSERT_EQUAL( 0, this->socket->getZeroCopyPendingCount() );
+
+	ZeroCopyCompletion completions[8];
+	CPPUNIT_ASSERT_EQUAL( 1, this->socket->pollZeroCopy(completions, 8, 0) );
+	CPPUNIT_ASSERT( completions[0].context == &small );
+	CPPUNIT_ASSERT( completions[0].copied );
+
+	char received[sizeof(greeting)];
+	CPPUNIT_ASSERT_EQUAL( (int)sizeof(greeting),
+	                      accepted->receiveFully(received, (int)sizeof(received)) );
+
+	try
+	{
+		this->socket->setZeroCopy( true );
+	}
+	catch( SocketException& )
+	{
+		// Nothing more to test where the platform copies every send
+		delete accepted;
+		return;
+	}
+
+	CPPUNIT_ASSERT( this->socket->isZeroCopy() );
+
+	// Large sends stay with the socket until the kernel hands them back, whether or not it had
+	// to copy them in the end (it always does over loopback)
+	int contexts[3];
+	vector<char> payload( Socket::DEFAULT_ZERO_COPY_THRESHOLD * 2, 'z' );
+	vector<char> drained( payload.size() );
+	int outstanding = 0;
+	for( int i = 0; i < 3; ++i )
+	{
+		int sent = this->socket->sendZeroCopy( &payload[0], (int)payload.size(), &contexts[i] );
+		CPPUNIT_ASSERT( sent > 0 );
+		CPPUNIT_ASSERT_EQUAL( sent, accepted->receiveFully(&drained[0], sent) );
+		++outstanding;
+	}
+
+	bool seen[3] = { false, false, false };
+	int attempts = 0;
+	while( outstanding > 0 && attempts++ < 10 )
+	{
+		int count = this->socket->pollZeroCopy( completions, 8, 1000 );
+		for( int i = 0; i < count; ++i )
+		{
+			int index = (int)((int*)completions[i].context - contexts);
+			CPPUNIT_ASSERT( index >= 0 && index < 3 );
+			CPPUNIT_ASSERT( !seen[index] );
+			seen[index] = true;
+			--outstanding;
+		}
+	}
+
+	CPPUNIT_ASSERT_EQUAL( 0, outstanding );
+	CPPUNIT_ASSERT_EQUAL( 0, this->socket->getZeroCopyPendingCount() );
+	delete accepted;
+}
+
+void SocketTest::testSetOptions()
+{
+	// Options given before connecting are applied when the connection is made
+	this->socket = new Socket();
+	this->socket->setOptions( SocketOptions(TP_LOW_LATENCY) );
+	this->socket->connect( InetSocketAddress(INADDR_LOOPBACK, 1234) );
+	CPPUNIT_ASSERT_EQUAL( 1, this->socket->getOptions().noDelay );
+	CPPUNIT_ASSERT_EQUAL( 1, this->socket->getOptions().quickAck );
+
+	string data = "Sent without waiting for Nagle";
+	string frame = this->quickFrame( data );
+	this->server->registerForNextReceive();
+	this->socket->sendAll( frame.data(), (int)frame.size() );
+	CPPUNIT_ASSERT( this->server->waitForNextReceive(1000) );
+	CPPUNIT_ASSERT( this->server->getLastReceivedMessage() == data );
+
+	// And ones given afterwards replace them straight away
+	SocketOptions options( TP_BULK_THROUGHPUT );
+	options.keepAlive = 1;
+	options.keepAliveIdle = 30;
+	options.linger = 1;
+	this->socket->setOptions( options );
+	CPPUNIT_ASSERT_EQUAL( 0, this->socket->getOptions().noDelay );
+	CPPUNIT_ASSERT_EQUAL( 4 * 1024 * 1024, this->socket->getOptions().sendBufferSize );
+	CPPUNIT_ASSERT_EQUAL( 30, this->socket->getOptions().keepAliveIdle );
+}
+
+void SocketTest::testSetOptionsClosed()
+{
+	this->socket = new Socket( INADDR_LOOPBACK, 1234 );
+	this->socket->close();
+
+	try
+	{
+		this->socket->setOptions( SocketOptions(TP_LOW_LATENCY) );
+		failTestMissingException( "SocketException", "setting options on a closed socket" );
+	}
+	catch( SocketException& )
+	{
+		// PASS
+	}
+}
+
+void SocketTest::testAcceptInheritsOptions()
+{
+	ServerSocket optionServer;
+	optionServer.setOptions( SocketOptions(TP_LOW_LATENCY) );
+	optionServer.bind( InetSocketAddress(INADDR_LOOPBACK, 0) );
+	CPPUNIT_ASSERT_EQUAL( 1, optionServer.getOptions().noDelay );
+
+	this->socket = new Socket( INADDR_LOOPBACK, optionServer.getLocalPort() );
+	Socket* accepted = optionServer.accept();
+	CPPUNIT_ASSERT_EQUAL( 1, accepted->getOptions().noDelay );
+	CPPUNIT_ASSERT_EQUAL( 1, accepted->getOptions().quickAck );
+
+	// Receiving turns quick acknowledgements back on as it goes
+	char data[] = "Acknowledged straight away";
+	char received[sizeof(data)];
+	this->socket->sendAll( data, (int)sizeof(data) );
+	CPPUNIT_ASSERT_EQUAL( (int)sizeof(data), accepted->receiveFully(received, (int)sizeof(received)) );
+	CPPUNIT_ASSERT( string(data) == string(received) );
+	delete accepted;
+}
+
 void SocketTest::testGetInetAddress()
 {
 	this->socket = new Socket( INADDR_LOOPBACK, 1234 );
@@ -983,3 +1362,41 @@ string SocketTest::quickStringReceive()
 
 	return receivedMessage;
 }
+
+string SocketTest::quickFrame( const string& message )
+{
+	size_t length = message.length();
+	return string( (char*)&length, sizeof(size_t) ) + message;
+}
+
+void SocketTest::quickWriteFile( const char* fileName, const string& contents )
+{
+	FILE* file = ::fopen( fileName, "wb" );
+	CPPUNIT_ASSERT( file );
+	CPPUNIT_ASSERT( ::fwrite(contents.data(), 1, contents.size(), file) == contents.size() );
+	::fclose( file );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/////////////////////////////  TransferRecorder  //////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+TransferRecorder::TransferRecorder()
+{
+	this->calls = 0;
+	this->stopAfter = 0;
+	this->lastTransferred = 0;
+	this->lastExpected = 0;
+}
+
+TransferRecorder::~TransferRecorder()
+{
+
+}
+
+bool TransferRecorder::transferred( long long transferred, long long expected )
+{
+	++this->calls;
+	this->lastTransferred = transferred;
+	this->lastExpected = expected;
+	return this->stopAfter == 0 || this->calls < this->stopAfter;
+}
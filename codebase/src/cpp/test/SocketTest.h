@@ -16,6 +16,7 @@
  */
 
 #include "Common.h"
+#include "syscommon/net/ITransferListener.h"
 
 class SocketTest: public CppUnit::TestFixture
 {
@@ -68,6 +69,19 @@ class SocketTest: public CppUnit::TestFixture
 		void testReceiveInputShutdown();
 		void testReceiveNullBuffer();
 		void testReceiveNegativeSize();
+		void testSendv();
+		void testSendvNullSegments();
+		void testSendAllSegments();
+		void testReceiveFully();
+		void testTransferFromFile();
+		void testTransferFromResume();
+		void testTransferFromMissingFile();
+		void testTransferFromPipe();
+		void testTransferFromSocket();
+		void testSendZeroCopy();
+		void testSetOptions();
+		void testSetOptionsClosed();
+		void testAcceptInheritsOptions();
 		void testGetInetAddress();
 		void testGetInetAddressNotConnected();
 		void testGetInetAddressDisconnected();
@@ -96,6 +110,10 @@ class SocketTest: public CppUnit::TestFixture
 		 */
 		string quickStringReceive() noexcept( false );
 
+		// Returns the message with the length prefix the StringServer expects in front of it
+		string quickFrame( const string& message );
+		void quickWriteFile( const char* fileName, const string& contents );
+
 	//----------------------------------------------------------
 	//                     STATIC METHODS
 	//----------------------------------------------------------
@@ -123,6 +141,19 @@ class SocketTest: public CppUnit::TestFixture
 		CPPUNIT_TEST( testReceiveInputShutdown );
 		CPPUNIT_TEST( testReceiveNullBuffer );
 		CPPUNIT_TEST( testReceiveNegativeSize );
+		CPPUNIT_TEST( testSendv );
+		CPPUNIT_TEST( testSendvNullSegments );
+		CPPUNIT_TEST( testSendAllSegments );
+		CPPUNIT_TEST( testReceiveFully );
+		CPPUNIT_TEST( testTransferFromFile );
+		CPPUNIT_TEST( testTransferFromResume );
+		CPPUNIT_TEST( testTransferFromMissingFile );
+		CPPUNIT_TEST( testTransferFromPipe );
+		CPPUNIT_TEST( testTransferFromSocket );
+		CPPUNIT_TEST( testSendZeroCopy );
+		CPPUNIT_TEST( testSetOptions );
+		CPPUNIT_TEST( testSetOptionsClosed );
+		CPPUNIT_TEST( testAcceptInheritsOptions );
 		CPPUNIT_TEST( testGetInetAddress );
 		CPPUNIT_TEST( testGetInetAddressNotConnected );
 		CPPUNIT_TEST( testGetInetAddressDisconnected );
@@ -143,3 +174,17 @@ class SocketTest: public CppUnit::TestFixture
 	CPPUNIT_TEST_SUITE_END();
 };
 
+// Records the progress reported by a transfer, and stops it once told to
+class TransferRecorder : public ITransferListener
+{
+	public:
+		int calls;
+		int stopAfter;
+		long long lastTransferred;
+		long long lastExpected;
+
+	public:
+		TransferRecorder();
+		virtual ~TransferRecorder();
+		virtual bool transferred( long long transferred, long long expected );
+};
@@ -0,0 +1,119 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "StopwatchTest.h"
+
+#include <limits.h>
+#include "syscommon/Platform.h"
+#include "syscommon/concurrent/Thread.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+CPPUNIT_TEST_SUITE_REGISTRATION( StopwatchTest );
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+StopwatchTest::StopwatchTest()
+{
+
+}
+
+StopwatchTest::~StopwatchTest()
+{
+
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+void StopwatchTest::setUp()
+{
+
+}
+
+void StopwatchTest::tearDown()
+{
+
+}
+
+void StopwatchTest::testNanoTime()
+{
+	// The clock must never go backwards, and must resolve well below a millisecond
+	long long previous = syscommon::Platform::nanoTime();
+	long long smallestStep = LLONG_MAX;
+	for( int i = 0 ; i < 100000 ; ++i )
+	{
+		long long now = syscommon::Platform::nanoTime();
+		if( now < previous )
+			failTest( "nanoTime() went backwards by %lldns", previous - now );
+
+		if( now > previous && now - previous < smallestStep )
+			smallestStep = now - previous;
+
+		previous = now;
+	}
+
+	if( smallestStep >= 1000000LL )
+		failTest( "nanoTime() resolution is %lldns, expected sub-millisecond", smallestStep );
+}
+
+void StopwatchTest::testStopwatch()
+{
+	syscommon::Stopwatch stopwatch;
+	CPPUNIT_ASSERT( !stopwatch.isRunning() );
+	CPPUNIT_ASSERT_EQUAL( 0LL, stopwatch.getElapsedNanos() );
+
+	stopwatch.start();
+	CPPUNIT_ASSERT( stopwatch.isRunning() );
+	syscommon::Thread::sleep( 50L );
+
+	// Elapsed time can be read while running
+	long long running = stopwatch.getElapsedMillis();
+	if( running < 50 )
+		failTest( "Expected at least 50ms while running, got %lldms", running );
+
+	stopwatch.stop();
+	CPPUNIT_ASSERT( !stopwatch.isRunning() );
+
+	// Once stopped, the elapsed time no longer changes
+	long long stopped = stopwatch.getElapsedNanos();
+	syscommon::Thread::sleep( 20L );
+	CPPUNIT_ASSERT_EQUAL( stopped, stopwatch.getElapsedNanos() );
+	CPPUNIT_ASSERT_EQUAL( stopped / 1000LL, stopwatch.getElapsedMicros() );
+
+	stopwatch.reset();
+	CPPUNIT_ASSERT_EQUAL( 0LL, stopwatch.getElapsedNanos() );
+}
+
+void StopwatchTest::testAccumulate()
+{
+	syscommon::Stopwatch stopwatch = syscommon::Stopwatch::createStarted();
+	CPPUNIT_ASSERT( stopwatch.isRunning() );
+	syscommon::Thread::sleep( 30L );
+	stopwatch.stop();
+
+	// Time spent stopped does not count
+	syscommon::Thread::sleep( 100L );
+
+	stopwatch.start();
+	syscommon::Thread::sleep( 30L );
+	stopwatch.stop();
+
+	long long elapsed = stopwatch.getElapsedMillis();
+	if( elapsed < 60 || elapsed >= 130 )
+		failTest( "Expected between 60ms and 130ms, got %lldms", elapsed );
+}
@@ -149,7 +149,7 @@ void StringServer::run()
 void StringServer::consume( const string& data, StringConnection* connection )
 {
 	receiveLock.lock();
-	++this->receiveCount;
+	this->receiveCount = this->receiveCount + 1;
 	this->lastMessage = data;
 	this->receiveEvent.signal();
 
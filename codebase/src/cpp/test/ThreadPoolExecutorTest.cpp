@@ -0,0 +1,436 @@
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+#include "ThreadPoolExecutorTest.h"
+
+#include <limits.h>
+#include <stdexcept>
+#include "syscommon/Platform.h"
+
+#ifdef DEBUG
+#include "debug.h"
+#endif
+
+CPPUNIT_TEST_SUITE_REGISTRATION( ThreadPoolExecutorTest );
+
+//----------------------------------------------------------
+//                      CONSTRUCTORS
+//----------------------------------------------------------
+ThreadPoolExecutorTest::ThreadPoolExecutorTest()
+{
+
+}
+
+ThreadPoolExecutorTest::~ThreadPoolExecutorTest()
+{
+
+}
+
+//----------------------------------------------------------
+//                    INSTANCE METHODS
+//----------------------------------------------------------
+void ThreadPoolExecutorTest::setUp()
+{
+
+}
+
+void ThreadPoolExecutorTest::tearDown()
+{
+
+}
+
+void ThreadPoolExecutorTest::testExecute()
+{
+	CountingRunnable counter;
+
+	syscommon::ThreadPoolExecutor executor( 4 );
+	CPPUNIT_ASSERT_EQUAL( 4U, executor.getPoolSize() );
+
+	for( int i = 0 ; i < 100 ; ++i )
+		executor.execute( &counter );
+
+	// Orderly shutdown runs everything that was queued
+	executor.shutdown();
+	CPPUNIT_ASSERT( executor.awaitTermination(5000) );
+	CPPUNIT_ASSERT_EQUAL( 100, counter.getCount() );
+	CPPUNIT_ASSERT_EQUAL( 100UL, executor.getCompletedTaskCount() );
+}
+
+void ThreadPoolExecutorTest::testSubmitAndGet()
+{
+	CountingRunnable counter;
+	syscommon::ThreadPoolExecutor executor( 2 );
+
+	syscommon::Future* future = executor.submit( &counter );
+	future->get();
+
+	CPPUNIT_ASSERT( future->isDone() );
+	CPPUNIT_ASSERT( !future->isCancelled() );
+	CPPUNIT_ASSERT_EQUAL( 1, counter.getCount() );
+
+	// The task must have run on one of the pool's workers
+	CPPUNIT_ASSERT( counter.getLastThread() != NULL );
+	CPPUNIT_ASSERT( counter.getLastThread() != syscommon::Thread::currentThread() );
+
+	delete future;
+}
+
+void ThreadPoolExecutorTest::testGetTimeout()
+{
+	BlockingRunnable blocker;
+	syscommon::ThreadPoolExecutor executor( 1 );
+
+	syscommon::Future* future = executor.submit( &blocker );
+	CPPUNIT_ASSERT( blocker.waitForStarted(5000) == syscommon::WR_SUCCEEDED );
+
+	// The task is held, so a timed get should give up
+	CPPUNIT_ASSERT( !future->get(50) );
+	CPPUNIT_ASSERT( !future->isDone() );
+
+	blocker.release();
+	CPPUNIT_ASSERT( future->get(5000) );
+	CPPUNIT_ASSERT( future->isDone() );
+
+	delete future;
+}
+
+void ThreadPoolExecutorTest::testTaskFailure()
+{
+	ThrowingRunnable thrower;
+	syscommon::ThreadPoolExecutor executor( 1 );
+
+	syscommon::Future* future = executor.submit( &thrower );
+	try
+	{
+		future->get();
+		failTestMissingException( "ExecutionException", "getting the result of a failed task" );
+	}
+	catch( syscommon::ExecutionException& )
+	{
+		// Success
+	}
+	catch( std::exception& e )
+	{
+		failTestWrongException( "ExecutionException", e, "getting the result of a failed task" );
+	}
+
+	delete future;
+}
+
+void ThreadPoolExecutorTest::testCancelPending()
+{
+	BlockingRunnable blocker;
+	CountingRunnable counter;
+	syscommon::ThreadPoolExecutor executor( 1 );
+
+	// Occupy the only worker so the next task has to wait in the queue
+	syscommon::Future* blockingFuture = executor.submit( &blocker );
+	CPPUNIT_ASSERT( blocker.waitForStarted(5000) == syscommon::WR_SUCCEEDED );
+
+	syscommon::Future* pendingFuture = executor.submit( &counter );
+	CPPUNIT_ASSERT_EQUAL( (size_t)1, executor.getQueueSize() );
+
+	CPPUNIT_ASSERT( pendingFuture->cancel(false) );
+	CPPUNIT_ASSERT( pendingFuture->isCancelled() );
+	CPPUNIT_ASSERT( pendingFuture->isDone() );
+	CPPUNIT_ASSERT_EQUAL( (size_t)0, executor.getQueueSize() );
+
+	try
+	{
+		pendingFuture->get();
+		failTestMissingException( "CancellationException", "getting a cancelled task" );
+	}
+	catch( syscommon::CancellationException& )
+	{
+		// Success
+	}
+	catch( std::exception& e )
+	{
+		failTestWrongException( "CancellationException", e, "getting a cancelled task" );
+	}
+
+	blocker.release();
+	blockingFuture->get();
+
+	executor.shutdown();
+	CPPUNIT_ASSERT( executor.awaitTermination(5000) );
+	CPPUNIT_ASSERT_EQUAL( 0, counter.getCount() );
+
+	delete blockingFuture;
+	delete pendingFuture;
+}
+
+void ThreadPoolExecutorTest::testCancelRunningInterrupts()
+{
+	SleepingRunnable longSleeper( 10000 );
+	SleepingRunnable shortSleeper( 50 );
+	syscommon::ThreadPoolExecutor executor( 1 );
+
+	syscommon::Future* longFuture = executor.submit( &longSleeper );
+	CPPUNIT_ASSERT( longSleeper.waitForStarted(5000) == syscommon::WR_SUCCEEDED );
+
+	// Cancelling with interruption should wake the worker out of its sleep
+	CPPUNIT_ASSERT( longFuture->cancel(true) );
+	CPPUNIT_ASSERT( longFuture->isCancelled() );
+
+	// The same worker runs the next task, which must not see the stale interrupt
+	syscommon::Future* shortFuture = executor.submit( &shortSleeper );
+	CPPUNIT_ASSERT( shortFuture->get(5000) );
+
+	CPPUNIT_ASSERT( longSleeper.wasInterrupted() );
+	CPPUNIT_ASSERT( !shortSleeper.wasInterrupted() );
+
+	delete longFuture;
+	delete shortFuture;
+}
+
+void ThreadPoolExecutorTest::testRejectAbort()
+{
+	BlockingRunnable blocker;
+	CountingRunnable counter;
+	syscommon::ThreadPoolExecutor executor( 1, 1, syscommon::ThreadPoolExecutor::RP_ABORT );
+
+	executor.execute( &blocker );
+	CPPUNIT_ASSERT( blocker.waitForStarted(5000) == syscommon::WR_SUCCEEDED );
+	executor.execute( &counter );
+
+	try
+	{
+		executor.execute( &counter );
+		failTestMissingException( "RejectedExecutionException", "executing on a full queue" );
+	}
+	catch( syscommon::RejectedExecutionException& )
+	{
+		// Success
+	}
+	catch( std::exception& e )
+	{
+		failTestWrongException( "RejectedExecutionException", e, "executing on a full queue" );
+	}
+
+	blocker.release();
+	executor.shutdown();
+	CPPUNIT_ASSERT( executor.awaitTermination(5000) );
+	CPPUNIT_ASSERT_EQUAL( 1, counter.getCount() );
+}
+
+void ThreadPoolExecutorTest::testRejectCallerRuns()
+{
+	BlockingRunnable blocker;
+	CountingRunnable queuedCounter;
+	CountingRunnable callerCounter;
+	syscommon::ThreadPoolExecutor executor( 1, 1, syscommon::ThreadPoolExecutor::RP_CALLER_RUNS );
+
+	executor.execute( &blocker );
+	CPPUNIT_ASSERT( blocker.waitForStarted(5000) == syscommon::WR_SUCCEEDED );
+	executor.execute( &queuedCounter );
+
+	// The queue is full, so this one runs right here
+	syscommon::Future* future = executor.submit( &callerCounter );
+	CPPUNIT_ASSERT( future->isDone() );
+	CPPUNIT_ASSERT_EQUAL( 1, callerCounter.getCount() );
+	CPPUNIT_ASSERT( callerCounter.getLastThread() == syscommon::Thread::currentThread() );
+
+	blocker.release();
+	delete future;
+}
+
+void ThreadPoolExecutorTest::testRejectDiscardOldest()
+{
+	BlockingRunnable blocker;
+	CountingRunnable oldCounter;
+	CountingRunnable newCounter;
+	syscommon::ThreadPoolExecutor executor( 1, 1, syscommon::ThreadPoolExecutor::RP_DISCARD_OLDEST );
+
+	executor.execute( &blocker );
+	CPPUNIT_ASSERT( blocker.waitForStarted(5000) == syscommon::WR_SUCCEEDED );
+
+	syscommon::Future* oldFuture = executor.submit( &oldCounter );
+	syscommon::Future* newFuture = executor.submit( &newCounter );
+
+	// The old task was pushed out of the queue to make room
+	CPPUNIT_ASSERT( oldFuture->isCancelled() );
+
+	blocker.release();
+	CPPUNIT_ASSERT( newFuture->get(5000) );
+	CPPUNIT_ASSERT_EQUAL( 0, oldCounter.getCount() );
+	CPPUNIT_ASSERT_EQUAL( 1, newCounter.getCount() );
+
+	delete oldFuture;
+	delete newFuture;
+}
+
+void ThreadPoolExecutorTest::testShutdown()
+{
+	CountingRunnable counter;
+	syscommon::ThreadPoolExecutor executor( 2 );
+
+	executor.execute( &counter );
+	executor.shutdown();
+	CPPUNIT_ASSERT( executor.isShutdown() );
+
+	try
+	{
+		executor.execute( &counter );
+		failTestMissingException( "RejectedExecutionException", "executing after shutdown" );
+	}
+	catch( syscommon::RejectedExecutionException& )
+	{
+		// Success
+	}
+	catch( std::exception& e )
+	{
+		failTestWrongException( "RejectedExecutionException", e, "executing after shutdown" );
+	}
+
+	CPPUNIT_ASSERT( executor.awaitTermination(5000) );
+	CPPUNIT_ASSERT_EQUAL( 1, counter.getCount() );
+}
+
+void ThreadPoolExecutorTest::testShutdownNow()
+{
+	SleepingRunnable sleeper( 10000 );
+	CountingRunnable counter;
+	syscommon::ThreadPoolExecutor executor( 1 );
+
+	executor.execute( &sleeper );
+	CPPUNIT_ASSERT( sleeper.waitForStarted(5000) == syscommon::WR_SUCCEEDED );
+
+	for( int i = 0 ; i < 5 ; ++i )
+		executor.execute( &counter );
+
+	// Queued tasks are handed back, and the running one is interrupted
+	std::list<syscommon::IRunnable*> pending = executor.shutdownNow();
+	CPPUNIT_ASSERT_EQUAL( (size_t)5, pending.size() );
+	CPPUNIT_ASSERT( executor.awaitTermination(5000) );
+
+	CPPUNIT_ASSERT( sleeper.wasInterrupted() );
+	CPPUNIT_ASSERT_EQUAL( 0, counter.getCount() );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/////////////////////////////  CountingRunnable  //////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+CountingRunnable::CountingRunnable()
+{
+	this->count = 0;
+	this->lastThread = NULL;
+}
+
+CountingRunnable::~CountingRunnable()
+{
+
+}
+
+void CountingRunnable::run()
+{
+	this->countLock.lock();
+	++this->count;
+	this->lastThread = syscommon::Thread::currentThread();
+	this->countLock.unlock();
+}
+
+int CountingRunnable::getCount()
+{
+	this->countLock.lock();
+	int result = this->count;
+	this->countLock.unlock();
+
+	return result;
+}
+
+syscommon::Thread* CountingRunnable::getLastThread()
+{
+	this->countLock.lock();
+	syscommon::Thread* result = this->lastThread;
+	this->countLock.unlock();
+
+	return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/////////////////////////////  BlockingRunnable  //////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+BlockingRunnable::BlockingRunnable() :
+	startedEvent( false, TEXT("started") ), releaseEvent( false, TEXT("release") )
+{
+
+}
+
+BlockingRunnable::~BlockingRunnable()
+{
+
+}
+
+void BlockingRunnable::run()
+{
+	this->startedEvent.signal();
+	this->releaseEvent.waitFor();
+}
+
+syscommon::WaitResult BlockingRunnable::waitForStarted( unsigned long timeout )
+{
+	return this->startedEvent.waitFor( timeout );
+}
+
+void BlockingRunnable::release()
+{
+	this->releaseEvent.signal();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/////////////////////////////  SleepingRunnable  //////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+SleepingRunnable::SleepingRunnable( unsigned long sleepMillis ) :
+	startedEvent( false, TEXT("started") )
+{
+	this->sleepMillis = sleepMillis;
+	this->interrupted = false;
+}
+
+SleepingRunnable::~SleepingRunnable()
+{
+
+}
+
+void SleepingRunnable::run()
+{
+	this->startedEvent.signal();
+	try
+	{
+		syscommon::Thread::sleep( this->sleepMillis );
+	}
+	catch( syscommon::InterruptedException& )
+	{
+		this->interrupted = true;
+	}
+}
+
+syscommon::WaitResult SleepingRunnable::waitForStarted( unsigned long timeout )
+{
+	return this->startedEvent.waitFor( timeout );
+}
+
+bool SleepingRunnable::wasInterrupted()
+{
+	return this->interrupted;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/////////////////////////////  ThrowingRunnable  //////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+void ThrowingRunnable::run()
+{
+	throw std::runtime_error( "task failed" );
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+/*
+ * The contents of this file are subject to the terms of the Common Development 
+ * and Distribution License (the "License"). You may not use this file except in 
+ * compliance with the License. You can obtain a copy of the license at 
+ * SysCommon/license.html or http://www.sun.com/cddl/cddl.html. See the License 
+ * for the specific language governing permissions and limitations under the 
+ * License.
+ * 
+ * When distributing Covered Code, include this CDDL HEADER in each file and 
+ * include the License file at SysCommon/license.html.
+ * If applicable, add the following below this CDDL HEADER, with the fields 
+ * enclosed by brackets "[]" replaced with your own identifying information: 
+ * Portions Copyright [yyyy] [name of copyright owner]
+ */
+
+#include "Common.h"
+#include "syscommon/concurrent/Thread.h"
+#include "syscommon/concurrent/Event.h"
+#include "syscommon/concurrent/Lock.h"
+#include "syscommon/concurrent/ThreadPoolExecutor.h"
+
+class ThreadPoolExecutorTest: public CppUnit::TestFixture
+{
+	//----------------------------------------------------------
+	//                    STATIC VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                   INSTANCE VARIABLES
+	//----------------------------------------------------------
+
+	//----------------------------------------------------------
+	//                      CONSTRUCTORS
+	//----------------------------------------------------------
+	public:
+		ThreadPoolExecutorTest();
+		virtual ~ThreadPoolExecutorTest();
+
+	//----------------------------------------------------------
+	//                    INSTANCE METHODS
+	//----------------------------------------------------------
+	public:
+		void setUp();
+		void tearDown();
+
+	protected:
+		void testExecute();
+		void testSubmitAndGet();
+		void testGetTimeout();
+		void testTaskFailure();
+		void testCancelPending();
+		void testCancelRunningInterrupts();
+		void testRejectAbort();
+		void testRejectCallerRuns();
+		void testRejectDiscardOldest();
+		void testShutdown();
+		void testShutdownNow();
+
+	//----------------------------------------------------------
+	//                     STATIC METHODS
+	//----------------------------------------------------------
+	CPPUNIT_TEST_SUITE( ThreadPoolExecutorTest );
+		CPPUNIT_TEST( testExecute );
+		CPPUNIT_TEST( testSubmitAndGet );
+		CPPUNIT_TEST( testGetTimeout );
+		CPPUNIT_TEST( testTaskFailure );
+		CPPUNIT_TEST( testCancelPending );
+		CPPUNIT_TEST( testCancelRunningInterrupts );
+		CPPUNIT_TEST( testRejectAbort );
+		CPPUNIT_TEST( testRejectCallerRuns );
+		CPPUNIT_TEST( testRejectDiscardOldest );
+		CPPUNIT_TEST( testShutdown );
+		CPPUNIT_TEST( testShutdownNow );
+	CPPUNIT_TEST_SUITE_END();
+};
+
+// CountingRunnable helper class, records how many times it was run and on which thread
+class CountingRunnable : public syscommon::IRunnable
+{
+	//----------------------------------------------------------
+	//                   INSTANCE VARIABLES
+	//----------------------------------------------------------
+	private:
+		syscommon::Lock countLock;
+		int count;
+		syscommon::Thread* lastThread;
+
+	//----------------------------------------------------------
+	//                      CONSTRUCTORS
+	//----------------------------------------------------------
+	public:
+		CountingRunnable();
+		virtual ~CountingRunnable();
+
+	//----------------------------------------------------------
+	//                    INSTANCE METHODS
+	//----------------------------------------------------------
+	public:
+		virtual void run();
+		int getCount();
+		syscommon::Thread* getLastThread();
+};
+
+// BlockingRunnable helper class, holds its worker until released
+class BlockingRunnable : public syscommon::IRunnable
+{
+	//----------------------------------------------------------
+	//                   INSTANCE VARIABLES
+	//----------------------------------------------------------
+	private:
+		syscommon::Event startedEvent;
+		syscommon::Event releaseEvent;
+
+	//----------------------------------------------------------
+	//                      CONSTRUCTORS
+	//----------------------------------------------------------
+	public:
+		BlockingRunnable();
+		virtual ~BlockingRunnable();
+
+	//----------------------------------------------------------
+	//                    INSTANCE METHODS
+	//----------------------------------------------------------
+	public:
+		virtual void run();
+		syscommon::WaitResult waitForStarted( unsigned long timeout );
+		void release();
+};
+
+// SleepingRunnable helper class, sleeps and records whether the sleep was interrupted
+class SleepingRunnable : public syscommon::IRunnable
+{
+	//----------------------------------------------------------
+	//                   INSTANCE VARIABLES
+	//----------------------------------------------------------
+	private:
+		unsigned long sleepMillis;
+		syscommon::Event startedEvent;
+		volatile bool interrupted;
+
+	//----------------------------------------------------------
+	//                      CONSTRUCTORS
+	//----------------------------------------------------------
+	public:
+		SleepingRunnable( unsigned long sleepMillis );
+		virtual ~SleepingRunnable();
+
+	//----------------------------------------------------------
+	//                    INSTANCE METHODS
+	//----------------------------------------------------------
+	public:
+		virtual void run();
+		syscommon::WaitResult waitForStarted( unsigned long timeout );
+		bool wasInterrupted();
+};
+
+// ThrowingRunnable helper class, always fails
+class ThrowingRunnable : public syscommon::IRunnable
+{
+	public:
+		virtual void run();
+};
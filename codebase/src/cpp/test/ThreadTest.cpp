@@ -15,6 +15,7 @@
 #include "ThreadTest.h"
 
 #include <limits.h>
+#include <thread>
 #include "syscommon/Platform.h"
 #include "syscommon/concurrent/Thread.h"
 
@@ -113,6 +114,125 @@ void ThreadTest::testInterruptSleep()
 	CPPUNIT_ASSERT( result == IndefiniteWaitRunnable::FR_SUCCESS );
 }
 
+void ThreadTest::testCurrentThread()
+{
+	CurrentThreadRunnable runnable;
+	syscommon::Thread testThread( &runnable );
+	testThread.start();
+	testThread.join();
+
+	CPPUNIT_ASSERT( runnable.firstLookup == &testThread );
+	CPPUNIT_ASSERT( runnable.secondLookup == &testThread );
+	CPPUNIT_ASSERT( syscommon::Thread::currentThread() != &testThread );
+}
+
+void ThreadTest::testForeignThread()
+{
+	// A thread that was not started through syscommon::Thread should still get a Thread of its
+	// own, and be able to use it for interruptable operations such as sleep
+	CurrentThreadRunnable runnable;
+	std::thread foreignThread( &CurrentThreadRunnable::run, &runnable );
+	foreignThread.join();
+
+	CPPUNIT_ASSERT( runnable.firstLookup != NULL );
+	CPPUNIT_ASSERT( runnable.firstLookup == runnable.secondLookup );
+	CPPUNIT_ASSERT( runnable.firstLookup != syscommon::Thread::currentThread() );
+	CPPUNIT_ASSERT( runnable.wasAlive );
+	if( runnable.sleptMillis < 50 )
+		failTest( "Foreign thread slept for %lums, expected at least 50ms", runnable.sleptMillis );
+}
+
+void ThreadTest::testAffinity()
+{
+	// Pin to whichever processor we are on now, as that one is certainly available to us
+	syscommon::ThreadOptions options;
+	options.processors.push_back( syscommon::Platform::getCurrentProcessor() );
+
+	OptionsRunnable runnable;
+	syscommon::Thread testThread( &runnable, TEXT("Pinned"), options );
+	CPPUNIT_ASSERT( testThread.getOptions().processors == options.processors );
+
+	testThread.start();
+	testThread.join();
+
+	CPPUNIT_ASSERT( runnable.ran );
+	if( runnable.firstProcessor != options.processors[0] || !runnable.stayedOnProcessor )
+	{
+		failTest( "Pinned thread ran on processor %u, expected %u",
+		          runnable.firstProcessor,
+		          options.processors[0] );
+	}
+}
+
+void ThreadTest::testInvalidAffinity()
+{
+	syscommon::ThreadOptions options;
+	options.processors.push_back( 100000 );
+
+	OptionsRunnable runnable;
+	syscommon::Thread testThread( &runnable );
+	testThread.setOptions( options );
+
+	try
+	{
+		testThread.start();
+		failTestMissingException( "IllegalStateException", "starting on a missing processor" );
+	}
+	catch( syscommon::IllegalStateException& )
+	{
+		// Expected
+	}
+
+	CPPUNIT_ASSERT( !runnable.ran );
+	CPPUNIT_ASSERT( !testThread.isAlive() );
+}
+
+void ThreadTest::testStackSize()
+{
+	// More stack than any platform gives a thread by default
+	syscommon::ThreadOptions options;
+	options.stackSize = 32 * 1024 * 1024;
+
+	OptionsRunnable runnable;
+	runnable.stackToUse = 16 * 1024 * 1024;
+	syscommon::Thread testThread( &runnable, TEXT("BigStack"), options );
+	testThread.start();
+	testThread.join();
+
+	CPPUNIT_ASSERT( runnable.ran );
+}
+
+void ThreadTest::testSchedulingPolicy()
+{
+	// The time sharing policies need no privileges
+	syscommon::ThreadOptions options;
+	options.schedulingPolicy = syscommon::SP_BATCH;
+	options.priority = 5;
+
+	OptionsRunnable batchRunnable;
+	syscommon::Thread batchThread( &batchRunnable, TEXT("Batch"), options );
+	batchThread.start();
+	batchThread.join();
+	CPPUNIT_ASSERT( batchRunnable.ran );
+
+	// Real time may be refused, but then the thread must not run at all
+	options.schedulingPolicy = syscommon::SP_FIFO;
+	options.priority = 1;
+
+	OptionsRunnable realTimeRunnable;
+	syscommon::Thread realTimeThread( &realTimeRunnable, TEXT("RealTime"), options );
+	try
+	{
+		realTimeThread.start();
+		realTimeThread.join();
+		CPPUNIT_ASSERT( realTimeRunnable.ran );
+	}
+	catch( syscommon::IllegalStateException& )
+	{
+		CPPUNIT_ASSERT( !realTimeRunnable.ran );
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /////////////////////////////  SyncPointRunnable  /////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -195,3 +315,68 @@ IndefiniteWaitRunnable::FinishResult IndefiniteWaitRunnable::getResult()
 	return this->result;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////  CurrentThreadRunnable  ///////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+CurrentThreadRunnable::CurrentThreadRunnable()
+{
+	this->firstLookup = NULL;
+	this->secondLookup = NULL;
+	this->wasAlive = false;
+	this->sleptMillis = 0;
+}
+
+void CurrentThreadRunnable::run()
+{
+	this->firstLookup = syscommon::Thread::currentThread();
+	this->secondLookup = syscommon::Thread::currentThread();
+	if( !this->firstLookup )
+		return;
+
+	this->wasAlive = this->firstLookup->isAlive();
+
+	unsigned long before = syscommon::Platform::getCurrentTimeMilliseconds();
+	syscommon::Thread::sleep( 50L );
+	this->sleptMillis = syscommon::Platform::getCurrentTimeMilliseconds() - before;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//////////////////////////////  OptionsRunnable  //////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+OptionsRunnable::OptionsRunnable()
+{
+	this->ran = false;
+	this->stayedOnProcessor = true;
+	this->firstProcessor = 0;
+	this->stackToUse = 0;
+}
+
+void OptionsRunnable::run()
+{
+	this->firstProcessor = syscommon::Platform::getCurrentProcessor();
+	for( int i = 0; i < 100; ++i )
+	{
+		syscommon::Platform::yieldThread();
+		if( syscommon::Platform::getCurrentProcessor() != this->firstProcessor )
+			this->stayedOnProcessor = false;
+	}
+
+	if( this->stackToUse > 0 )
+		this->useStack( this->stackToUse );
+
+	this->ran = true;
+}
+
+int OptionsRunnable::useStack( size_t remaining )
+{
+	// Touch every frame, so that the stack really is used rather than optimised away
+	volatile char frame[64 * 1024];
+	frame[0] = (char)remaining;
+	frame[sizeof(frame) - 1] = frame[0];
+
+	int result = frame[sizeof(frame) - 1];
+	if( remaining > sizeof(frame) )
+		result += this->useStack( remaining - sizeof(frame) );
+
+	return result;
+}
@@ -48,6 +48,12 @@ class ThreadTest: public CppUnit::TestFixture
 		void testIsAlive();
 		void testSleep();
 		void testInterruptSleep();
+		void testCurrentThread();
+		void testForeignThread();
+		void testAffinity();
+		void testInvalidAffinity();
+		void testStackSize();
+		void testSchedulingPolicy();
 
 	//----------------------------------------------------------
 	//                     STATIC METHODS
@@ -57,6 +63,12 @@ class ThreadTest: public CppUnit::TestFixture
 		CPPUNIT_TEST( testIsAlive );
 		CPPUNIT_TEST( testSleep );
 		CPPUNIT_TEST( testInterruptSleep );
+		CPPUNIT_TEST( testCurrentThread );
+		CPPUNIT_TEST( testForeignThread );
+		CPPUNIT_TEST( testAffinity );
+		CPPUNIT_TEST( testInvalidAffinity );
+		CPPUNIT_TEST( testStackSize );
+		CPPUNIT_TEST( testSchedulingPolicy );
 	CPPUNIT_TEST_SUITE_END();
 };
 
@@ -129,3 +141,34 @@ class IndefiniteWaitRunnable : public syscommon::IRunnable
 	//----------------------------------------------------------
 };
 
+// CurrentThread runnable helper class, records what Thread::currentThread() returns
+class CurrentThreadRunnable : public syscommon::IRunnable
+{
+	public:
+		syscommon::Thread* firstLookup;
+		syscommon::Thread* secondLookup;
+		bool wasAlive;
+		unsigned long sleptMillis;
+
+	public:
+		CurrentThreadRunnable();
+		virtual void run();
+};
+
+// ThreadOptions runnable helper class, records where the thread ran and optionally uses a given
+// amount of stack
+class OptionsRunnable : public syscommon::IRunnable
+{
+	public:
+		bool ran;
+		bool stayedOnProcessor;
+		unsigned int firstProcessor;
+		size_t stackToUse;
+
+	public:
+		OptionsRunnable();
+		virtual void run();
+
+	private:
+		int useStack( size_t remaining );
+};